@@ -3,10 +3,12 @@
 #endif()
 
 include(CheckCSourceRuns)
+include(CheckCSourceCompiles)
 
 option(ENABLE_SSE "Enable compile-time SSE4.1 support." ON)
 option(ENABLE_AVX "Enable compile-time AVX support."  ON)
 option(ENABLE_AVX2 "Enable compile-time AVX2 support."  ON)
+option(ENABLE_AVX512 "Build the AVX512 kernels, selected at runtime."  ON)
 
 if (ENABLE_SSE)
     #
@@ -99,6 +101,42 @@ if (ENABLE_SSE)
       endif()
   endif()
 
+    if (ENABLE_AVX512)
+
+      #
+      # Check compiler for AVX512 intrinsics. Only the files that need them are built with them, so 
+      # the build machine does not need to support AVX512
+      #
+      if (CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_CLANG )
+          set(CMAKE_REQUIRED_FLAGS "-mavx512f -mavx512bw")
+          check_c_source_compiles("
+          #include <immintrin.h>
+          int main()
+          {
+            __m512i a, b, c;
+            const short src[32] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+                                    17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32 };
+            short dst[32];
+            a =  _mm512_loadu_si512( (__m512i*)src );
+            b =  _mm512_loadu_si512( (__m512i*)src );
+            c = _mm512_add_epi16( a, b );
+            _mm512_storeu_si512( (__m512i*)dst, c );
+            int i = 0;
+            for( i = 0; i < 32; i++ ){
+              if( ( src[i] + src[i] ) != dst[i] ){
+                return -1;
+              }
+            }
+            return 0;
+          }"
+          HAVE_AVX512)
+      endif()
+
+      if (HAVE_AVX512)
+          message(STATUS "AVX512 kernels are enabled - selected at runtime if the CPU supports them")
+      endif()
+  endif()
+
 endif()
 
-mark_as_advanced(HAVE_SSE, HAVE_AVX, HAVE_AVX2)
+mark_as_advanced(HAVE_SSE, HAVE_AVX, HAVE_AVX2, HAVE_AVX512)
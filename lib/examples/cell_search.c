@@ -73,6 +73,7 @@ struct cells results[1024];
 
 float rf_gain = 70.0;
 char *rf_args=""; 
+float pss_search_threshold = SRSLTE_CS_PSS_SEARCH_THRESHOLD;
 
 void usage(char *prog) {
   printf("Usage: %s [agsendtvb] -b band\n", prog);
@@ -81,12 +82,13 @@ void usage(char *prog) {
   printf("\t-s earfcn_start [Default All]\n");
   printf("\t-e earfcn_end [Default All]\n");
   printf("\t-n nof_frames_total [Default 100]\n");
+  printf("\t-t PSS search PSR threshold, 0 scans all N_id_2 [Default %.1f]\n", pss_search_threshold);
   printf("\t-v [set srslte_verbose to debug, default none]\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "agsendvb")) != -1) {
+  while ((opt = getopt(argc, argv, "agsendtvb")) != -1) {
     switch(opt) {
     case 'a':
       rf_args = argv[optind];
@@ -106,6 +108,9 @@ void parse_args(int argc, char **argv) {
     case 'g':
       rf_gain = atof(argv[optind]);
       break;
+    case 't':
+      pss_search_threshold = atof(argv[optind]);
+      break;
     case 'v':
       srslte_verbose++;
       break;
@@ -212,6 +217,7 @@ int main(int argc, char **argv) {
     if (cell_detect_config.max_frames_pss) {
       srslte_ue_cellsearch_set_nof_valid_frames(&cs, cell_detect_config.nof_valid_pss_frames);
     }
+    srslte_ue_cellsearch_set_pss_search_threshold(&cs, pss_search_threshold);
     if (cell_detect_config.init_agc) {
       srslte_ue_sync_start_agc(&cs.ue_sync, srslte_rf_set_rx_gain_wrapper, cell_detect_config.init_agc);    
     }
@@ -88,7 +88,7 @@ public:
 
 private:
   std::queue<myobj> q; 
-  pthread_mutex_t mutex;
+  mutable pthread_mutex_t mutex;
   pthread_cond_t  cvar;
 };
 
@@ -0,0 +1,147 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef BUFFER_CHAIN_H
+#define BUFFER_CHAIN_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "srslte/common/common.h"
+#include "srslte/common/buffer_pool.h"
+
+namespace srslte {
+
+/******************************************************************************
+ * Buffer chain
+ *
+ * Ordered list of byte slices that together form one PDU. Lower layers append
+ * references to the buffers that already hold the data (RLC SDUs, MAC
+ * headers) instead of copying them into a contiguous PDU, and the PHY gathers
+ * the slices once while computing the transport block CRC.
+ *
+ * A slice may own the byte_buffer_t it points into. Owned buffers are returned
+ * to the byte_buffer_pool by release(), which must be called once the chain
+ * has been consumed.
+ *****************************************************************************/
+
+class buffer_chain
+{
+public:
+  static const uint32_t MAX_SLICES = 64;
+
+  buffer_chain() {
+    reset();
+  }
+
+  // Forgets all slices without releasing the buffers they own
+  void reset() {
+    nof_slices = 0;
+    nof_bytes  = 0;
+  }
+
+  bool append(uint8_t *ptr, uint32_t len, byte_buffer_t *owner = NULL) {
+    if (nof_slices >= MAX_SLICES) {
+      return false;
+    }
+    slices[nof_slices].ptr   = ptr;
+    slices[nof_slices].len   = len;
+    slices[nof_slices].owner = owner;
+    nof_slices++;
+    nof_bytes += len;
+    return true;
+  }
+
+  // Replaces a slice, typically a header that was reserved with append(NULL, 0)
+  void set(uint32_t idx, uint8_t *ptr, uint32_t len, byte_buffer_t *owner = NULL) {
+    if (idx < nof_slices) {
+      nof_bytes -= slices[idx].len;
+      slices[idx].ptr   = ptr;
+      slices[idx].len   = len;
+      slices[idx].owner = owner;
+      nof_bytes += len;
+    }
+  }
+
+  uint32_t size()        { return nof_slices; }
+  uint32_t free_slices() { return MAX_SLICES - nof_slices; }
+  uint32_t length()      { return nof_bytes; }
+  uint8_t* get_ptr(uint32_t idx) { return slices[idx].ptr; }
+  uint32_t get_len(uint32_t idx) { return slices[idx].len; }
+
+  // Copies the slices starting at first into dst and returns the number of bytes
+  uint32_t gather(uint8_t *dst, uint32_t first = 0) {
+    uint32_t n = 0;
+    for (uint32_t i=first;i<nof_slices;i++) {
+      // A slice may already sit at its destination
+      memmove(&dst[n], slices[i].ptr, slices[i].len);
+      n += slices[i].len;
+    }
+    return n;
+  }
+
+  // Copies the slices starting at first into dst, returns the buffers they own
+  // and replaces them by a single slice pointing to dst
+  void collapse(uint8_t *dst, uint32_t first = 0) {
+    if (first < nof_slices) {
+      uint32_t n = gather(dst, first);
+      release_owners(first);
+      nof_bytes -= n;
+      nof_slices = first;
+      append(dst, n);
+    }
+  }
+
+  // Returns all owned buffers to the pool and empties the chain
+  void release() {
+    release_owners(0);
+    reset();
+  }
+
+private:
+  typedef struct {
+    uint8_t       *ptr;
+    uint32_t       len;
+    byte_buffer_t *owner;
+  } slice_t;
+
+  void release_owners(uint32_t first) {
+    for (uint32_t i=first;i<nof_slices;i++) {
+      if (slices[i].owner) {
+        byte_buffer_pool::get_instance()->deallocate(slices[i].owner);
+        slices[i].owner = NULL;
+      }
+    }
+  }
+
+  slice_t  slices[MAX_SLICES];
+  uint32_t nof_slices;
+  uint32_t nof_bytes;
+};
+
+} // namespace srslte
+
+#endif // BUFFER_CHAIN_H
@@ -28,6 +28,11 @@
 #define BUFFER_POOL_H
 
 #include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
 #include <vector>
 #include <stack>
 #include <algorithm>
@@ -47,96 +52,400 @@ namespace srslte {
  * deallocate functions. Provides quick object creation and deletion as well
  * as object reuse. 
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
+ *
+ * All buffers live in a single contiguous array. Each buffer is preceded by a
+ * small header that records its owning pool, its index and whether it is in
+ * use, so deallocate() validates and releases a buffer in O(1).
+ * Free buffers are kept in a lock-free stack (the depot) indexed by buffer
+ * number and protected against ABA with a 32-bit tag. Every thread keeps a
+ * small cache (magazine) of free buffer indices in front of the depot, which
+ * is refilled or flushed in batches, so most allocate/deallocate calls touch
+ * no shared state other than the usage counters. When the depot runs dry, the
+ * caches of all threads are flushed into it before the pool reports that it
+ * is exhausted, and a cache goes back to the depot when its thread exits.
+ * The caches are found through buffer_pool_caches, and a pool without them
+ * works on the depot alone.
+ * Optionally, payload_len bytes of storage are placed after each buffer and
+ * handed to it on construction through buffer_pool_init().
+ *****************************************************************************/
+
+/******************************************************************************
+ * Thread caches of all buffer pools
+ *
+ * Every pool gets a small id, and each thread keeps a table of its caches
+ * indexed by that id. All tables hang from a single process-wide pthread key,
+ * so the number of pools (e.g. one per UE) is not bounded by PTHREAD_KEYS_MAX.
+ * A cache outlives its pool only as an orphan (pool NULL), which is released
+ * when its thread exits or when the id is reused.
  *****************************************************************************/
 
+class buffer_pool_caches {
+public:
+  typedef struct cache_hdr_s {
+    void                *pool;
+    void               (*release)(struct cache_hdr_s *c); // returns c to its pool, if any, and frees it
+    struct cache_hdr_s  *prev;
+    struct cache_hdr_s  *next;
+  } cache_hdr_t;
+
+  // False if the key could not be created, pools then skip the caches
+  static bool         enabled();
+  static uint32_t     new_pool_id();
+  static void         free_pool_id(uint32_t pool_id);
+  // Cache of the calling thread registered for pool_id, NULL if none
+  static cache_hdr_t* get(uint32_t pool_id);
+  static bool         set(uint32_t pool_id, cache_hdr_t *c);
+  // Guards cache_hdr_t::pool and the cache lists of all pools
+  static void         lock();
+  static void         unlock();
+
+private:
+  static void         init();
+  static void         thread_exit(void *arg);
+};
+
+template <class buffer_t>
+inline void buffer_pool_init(buffer_t *b, uint8_t *payload, uint32_t payload_len)
+{
+  new (b) buffer_t;
+}
+
+inline void buffer_pool_init(byte_buffer_t *b, uint8_t *payload, uint32_t payload_len)
+{
+  if (payload_len) {
+    new (b) byte_buffer_t(payload, payload_len);
+  } else {
+    new (b) byte_buffer_t;
+  }
+}
+
 template <class buffer_t>
 class buffer_pool{
 public:
   
   // non-static methods
-  buffer_pool(uint32_t nof_buffers = POOL_SIZE)
+  buffer_pool(uint32_t nof_buffers = POOL_SIZE, uint32_t payload_len = 0)
   {
-    pthread_mutex_init(&mutex, NULL);
-    for(uint32_t i=0;i<nof_buffers;i++) {
-      buffer_t *b = new buffer_t;
-      available.push(b);
+    capacity   = nof_buffers; 
+    stride     = ((HDR_LEN + sizeof(buffer_t) + payload_len + HDR_LEN - 1)/HDR_LEN)*HDR_LEN;
+    cache_len  = std::min((uint32_t) MAX_CACHE_LEN, nof_buffers/16);
+    if (cache_len < 2 || !buffer_pool_caches::enabled()) {
+      cache_len = 0;
+    }
+    pool_id    = cache_len ? buffer_pool_caches::new_pool_id() : 0;
+    caches     = NULL;
+    depot      = ((uint64_t) 0 << 32) | NIL;
+    nof_used   = 0;
+    max_used   = 0;
+    nof_exhausted = 0;
+
+    if (posix_memalign((void**) &storage, HDR_LEN, (size_t) stride*nof_buffers)) {
+      perror("posix_memalign");
+      storage  = NULL;
+      capacity = 0;
+    }
+    // Build the free stack in reverse so that buffer 0 is served first
+    for(uint32_t i=0;i<capacity;i++) {
+      uint32_t   idx = capacity-1-i;
+      node_hdr_t *h  = hdr(idx);
+      h->owner  = this;
+      h->idx    = idx;
+      h->in_use = 0;
+      buffer_pool_init(obj(idx), (uint8_t*) obj(idx) + sizeof(buffer_t), payload_len);
+      depot_push(idx, idx);
     }
-    capacity = nof_buffers; 
   }
 
   ~buffer_pool() { 
-    // this destructor assumes all buffers have been properly deallocated 
-    while(available.size()) {
-      delete available.top();
-      available.pop();
+    if (cache_len) {
+      // Caches of other threads are left as orphans, the one of this thread is freed now
+      buffer_pool_caches::lock();
+      for (buffer_pool_caches::cache_hdr_t *c = caches; c; c = c->next) {
+        c->pool = NULL;
+      }
+      caches = NULL;
+      buffer_pool_caches::unlock();
+      buffer_pool_caches::cache_hdr_t *c = buffer_pool_caches::get(pool_id);
+      if (c && !c->pool) {
+        buffer_pool_caches::set(pool_id, NULL);
+        c->release(c);
+      }
+      buffer_pool_caches::free_pool_id(pool_id);
+    }
+    for(uint32_t i=0;i<capacity;i++) {
+      obj(i)->~buffer_t();
     }
+    free(storage);
   }
   
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", (int) used.size());
-    for (uint32_t i=0;i<used.size();i++) {
-      printf("%s\n", strlen(used[i]->debug_name)?used[i]->debug_name:"Undefined");
+    printf("%d buffers in queue\n", (int) nof_used);
+    for (uint32_t i=0;i<capacity;i++) {
+      if (hdr(i)->in_use) {
+        printf("%s\n", strlen(obj(i)->debug_name)?obj(i)->debug_name:"Undefined");
+      }
     }
   }
   
 
   buffer_t* allocate(const char *debug_name = NULL)
   {
-    pthread_mutex_lock(&mutex);
-    buffer_t* b = NULL;
-
-    if(available.size() > 0)
-    {
-      b = available.top();
-      used.push_back(b);
-      available.pop();
+    buffer_t *b = try_allocate(debug_name);
+    if (!b) {
+      printf("Error - buffer pool is empty\n");
       
-      if (available.size() < capacity/20) {
-        printf("Warning buffer pool capacity is %f %%\n", (float) available.size()/capacity);
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+      print_all_buffers();
+#endif
+    }
+    return b;
+  }
+
+  // Same as allocate() but returns NULL silently when the pool is empty
+  buffer_t* try_allocate(const char *debug_name = NULL)
+  {
+    uint32_t idx = NIL;
+    cache_t *c   = cache_len ? get_cache() : NULL;
+    if (c) {
+      cache_lock(c);
+      if (c->count == 0) {
+        // Refill half the magazine from the depot
+        uint32_t i;
+        while(c->count < cache_len/2 && (i = depot_pop()) != NIL) {
+          c->idx[c->count++] = i;
+        }
       }
+      if (c->count > 0) {
+        idx = c->idx[--c->count];
+      }
+      cache_unlock(c);
+    } else {
+      idx = depot_pop();
+    }
+
+    // Free buffers may still sit in the caches of other threads
+    if (idx == NIL && cache_len && steal()) {
+      idx = depot_pop();
+    }
+
+    if (idx == NIL) {
+      __sync_add_and_fetch(&nof_exhausted, 1);
+      return NULL;
+    }
+
+    hdr(idx)->in_use = 1;
+    uint32_t used = __sync_add_and_fetch(&nof_used, 1);
+    uint32_t max  = max_used;
+    while (used > max && !__sync_bool_compare_and_swap(&max_used, max, used)) {
+      max = max_used;
+    }
+    if (capacity - used < capacity/20) {
+      printf("Warning buffer pool capacity is %f %%\n", (float) (capacity - used)/capacity);
+    }
+
+    buffer_t *b = obj(idx);
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     if (debug_name) {
       strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
       b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN-1] = 0;
     }
 #endif
-      
-    } else {
-      printf("Error - buffer pool is empty\n");
-      
-#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
-      print_all_buffers();
-#endif
-    }
-
-    pthread_mutex_unlock(&mutex);
     return b;
   }
   
+  // Checks in O(1) whether b was allocated from this pool 
+  bool owns(buffer_t *b)
+  {
+    uintptr_t off = (uintptr_t) b - (uintptr_t) storage; 
+    return b != NULL && (uintptr_t) b >= (uintptr_t) storage && off < (uintptr_t) stride*capacity &&
+           off % stride == HDR_LEN && hdr(off/stride)->owner == this;
+  }
+
   bool deallocate(buffer_t *b)
   {
-    bool ret = false; 
-    pthread_mutex_lock(&mutex);
-    typename std::vector<buffer_t*>::iterator elem = std::find(used.begin(), used.end(), b);
-    if (elem != used.end()) {
-      used.erase(elem); 
-      available.push(b);
-      ret = true; 
-    } else {
+    if (!owns(b)) {
       printf("Error deallocating from buffer pool: buffer not created in this pool.\n");
+      return false; 
     }
-    pthread_mutex_unlock(&mutex);
-    return ret; 
+    node_hdr_t *h = hdr(((uintptr_t) b - (uintptr_t) storage)/stride);
+    if (!__sync_bool_compare_and_swap(&h->in_use, 1, 0)) {
+      printf("Error deallocating from buffer pool: buffer is not allocated.\n");
+      return false; 
+    }
+    __sync_sub_and_fetch(&nof_used, 1);
+
+    cache_t *c = cache_len ? get_cache() : NULL;
+    if (c) {
+      cache_lock(c);
+      if (c->count == cache_len) {
+        // Flush the older half of the magazine as a single chain
+        flush(c, cache_len/2);
+      }
+      c->idx[c->count++] = h->idx;
+      cache_unlock(c);
+    } else {
+      depot_push(h->idx, h->idx);
+    }
+    return true; 
   }
 
+  uint32_t get_capacity()      { return capacity; }
+  uint32_t get_nof_used()      { return nof_used; }
+  uint32_t get_high_water()    { return max_used; }
+  uint32_t get_nof_exhausted() { return nof_exhausted; }
+  size_t   get_memory()        { return (size_t) stride*capacity; }
   
 private:  
-  static const int       POOL_SIZE = 2048;
-  std::stack<buffer_t*>  available;
-  std::vector<buffer_t*> used; 
-  pthread_mutex_t        mutex;  
+  static const int       POOL_SIZE     = 2048;
+  static const uint32_t  MAX_CACHE_LEN = 32;
+  static const uint32_t  HDR_LEN       = 64; // one cache line in front of each buffer
+  static const uint32_t  NIL           = 0xffffffff;
+
+  typedef struct {
+    buffer_pool       *owner;
+    uint32_t           idx;
+    uint32_t           next;   // next free buffer in the depot
+    volatile uint32_t  in_use;
+  } node_hdr_t;
+
+  typedef struct {
+    buffer_pool_caches::cache_hdr_t hdr;  // must be first
+    volatile uint32_t  lock;              // held by the owner thread while using it, or by steal()
+    uint32_t           count;
+    uint32_t           idx[MAX_CACHE_LEN];
+  } cache_t;
+
+  node_hdr_t* hdr(uint32_t idx) {
+    return (node_hdr_t*) (storage + (size_t) idx*stride);
+  }
+  buffer_t* obj(uint32_t idx) {
+    return (buffer_t*) (storage + (size_t) idx*stride + HDR_LEN);
+  }
+
+  // Pushes the chain first..last, already linked through next, onto the depot 
+  void depot_push(uint32_t first, uint32_t last) {
+    uint64_t old, val;
+    do {
+      old = depot;
+      hdr(last)->next = (uint32_t) old;
+      val = (((old >> 32) + 1) << 32) | first;
+    } while(!__sync_bool_compare_and_swap(&depot, old, val));
+  }
+
+  uint32_t depot_pop() {
+    uint64_t old, val;
+    uint32_t idx;
+    do {
+      old = depot;
+      idx = (uint32_t) old;
+      if (idx == NIL) {
+        return NIL;
+      }
+      // next may be stale if idx was popped meanwhile, but then the tag differs 
+      val = (((old >> 32) + 1) << 32) | hdr(idx)->next;
+    } while(!__sync_bool_compare_and_swap(&depot, old, val));
+    return idx;
+  }
+
+  void flush(cache_t *c, uint32_t n) {
+    if (n == 0) {
+      return;
+    }
+    for (uint32_t i=0;i<n-1;i++) {
+      hdr(c->idx[i])->next = c->idx[i+1];
+    }
+    depot_push(c->idx[0], c->idx[n-1]);
+    c->count -= n;
+    memmove(c->idx, &c->idx[n], c->count*sizeof(uint32_t));
+  }
+
+  // Uncontended except while another thread steals from the cache
+  static void cache_lock(cache_t *c) {
+    while (__sync_lock_test_and_set(&c->lock, 1)) {
+      while (c->lock) {}
+    }
+  }
+  static void cache_unlock(cache_t *c) {
+    __sync_lock_release(&c->lock);
+  }
+
+  // Flushes the caches of all threads to the depot, returns the number of buffers moved 
+  uint32_t steal() {
+    uint32_t n = 0;
+    buffer_pool_caches::lock();
+    for (buffer_pool_caches::cache_hdr_t *h = caches; h; h = h->next) {
+      cache_t *c = (cache_t*) h;
+      cache_lock(c);
+      n += c->count;
+      flush(c, c->count);
+      cache_unlock(c);
+    }
+    buffer_pool_caches::unlock();
+    return n;
+  }
+
+  // Cache of the calling thread, NULL if it cannot be registered 
+  cache_t* get_cache() {
+    buffer_pool_caches::cache_hdr_t *h = buffer_pool_caches::get(pool_id);
+    if (h && h->pool == this) {
+      return (cache_t*) h;
+    }
+    if (h) {
+      // Orphan of a destroyed pool that had the same id
+      buffer_pool_caches::set(pool_id, NULL);
+      h->release(h);
+    }
+    cache_t *c = new cache_t;
+    c->hdr.pool    = this;
+    c->hdr.release = cache_release;
+    c->hdr.prev    = NULL;
+    c->lock        = 0;
+    c->count       = 0;
+    if (!buffer_pool_caches::set(pool_id, &c->hdr)) {
+      delete c;
+      return NULL;
+    }
+    buffer_pool_caches::lock();
+    c->hdr.next = caches;
+    if (caches) {
+      caches->prev = &c->hdr;
+    }
+    caches = &c->hdr;
+    buffer_pool_caches::unlock();
+    return c;
+  }
+
+  // Called on thread exit or for orphans: returns the cached buffers to the depot
+  static void cache_release(buffer_pool_caches::cache_hdr_t *h) {
+    cache_t *c = (cache_t*) h;
+    buffer_pool_caches::lock();
+    buffer_pool *pool = (buffer_pool*) h->pool;
+    if (pool) {
+      pool->flush(c, c->count);
+      if (h->prev) {
+        h->prev->next = h->next;
+      } else {
+        pool->caches = h->next;
+      }
+      if (h->next) {
+        h->next->prev = h->prev;
+      }
+    }
+    buffer_pool_caches::unlock();
+    delete c;
+  }
+
+  uint8_t               *storage;
+  uint32_t               stride;
+  uint32_t               cache_len;
+  volatile uint64_t      depot;
+  uint32_t               pool_id;
+  buffer_pool_caches::cache_hdr_t *caches;
   uint32_t capacity;
+  volatile uint32_t      nof_used;
+  volatile uint32_t      max_used;
+  volatile uint32_t      nof_exhausted;
 };
 
 
@@ -147,20 +456,114 @@ public:
   static byte_buffer_pool*   get_instance(void);
   static void                cleanup(void); 
   byte_buffer_pool() {
-    pool = new buffer_pool<byte_buffer_t>;
+    pool[SMALL]  = new buffer_pool<byte_buffer_t>(SMALL_POOL_SIZE,  SRSLTE_BUFFER_SMALL_SIZE_BYTES);
+    pool[MEDIUM] = new buffer_pool<byte_buffer_t>(MEDIUM_POOL_SIZE, SRSLTE_BUFFER_MEDIUM_SIZE_BYTES);
+    pool[LARGE]  = new buffer_pool<byte_buffer_t>(LARGE_POOL_SIZE,  SRSLTE_MAX_BUFFER_SIZE_BYTES);
   }
   ~byte_buffer_pool() {
-    delete pool; 
+    for (uint32_t i=0;i<NOF_CLASSES;i++) {
+      delete pool[i]; 
+    }
   }
+  // Buffers of unknown size come from the largest class 
   byte_buffer_t* allocate(const char *debug_name = NULL) {
-    return pool->allocate(debug_name);
+    return pool[LARGE]->allocate(debug_name);
+  }
+  // Returns a buffer with at least size_hint bytes after msg, taken from the 
+  // smallest size class that fits or from a larger one if that is empty
+  byte_buffer_t* allocate(uint32_t size_hint, const char *debug_name = NULL) {
+    for (uint32_t i=0;i<LARGE;i++) {
+      if (size_hint <= class_size[i] - byte_buffer_t::header_offset_for(class_size[i])) {
+        byte_buffer_t *b = pool[i]->try_allocate(debug_name);
+        if (b) {
+          return b;
+        }
+      }
+    }
+    return pool[LARGE]->allocate(debug_name);
+  }
+  // Returns a buffer of the smallest size class that holds the payload of b,
+  // with the payload copied into it. Returns b itself if it already is of that
+  // class or no smaller buffer is free, otherwise b is left to the caller
+  byte_buffer_t* fit(byte_buffer_t *b, const char *debug_name = NULL) {
+    for (uint32_t i=0;i<LARGE && class_size[i] < b->get_buffer_size();i++) {
+      if (b->N_bytes <= class_size[i] - byte_buffer_t::header_offset_for(class_size[i])) {
+        byte_buffer_t *f = pool[i]->try_allocate(debug_name);
+        if (f) {
+          memcpy(f->msg, b->msg, b->N_bytes);
+          f->N_bytes = b->N_bytes;
+          return f;
+        }
+      }
+    }
+    return b;
+  }
+  // Makes room for len more bytes after the payload of *b, moving the payload
+  // to a buffer of a larger size class if it does not fit. Returns false if
+  // no buffer large enough is available
+  bool reserve(byte_buffer_t **b, uint32_t len, const char *debug_name = NULL) {
+    uint32_t n = (*b)->N_bytes + len;
+    if (n <= (*b)->get_tailroom()) {
+      return true;
+    }
+    byte_buffer_t *g = allocate(n, debug_name);
+    if (!g) {
+      return false;
+    }
+    if (n > g->get_tailroom()) {
+      deallocate(g);
+      return false;
+    }
+    memcpy(g->msg, (*b)->msg, (*b)->N_bytes);
+    g->N_bytes = (*b)->N_bytes;
+    deallocate(*b);
+    *b = g;
+    return true;
   }
   void deallocate(byte_buffer_t *b) {
     b->reset();
-    pool->deallocate(b);
+    for (uint32_t i=0;i<LARGE;i++) {
+      if (pool[i]->owns(b)) {
+        pool[i]->deallocate(b);
+        return;
+      }
+    }
+    pool[LARGE]->deallocate(b);
+  }
+  uint32_t get_capacity()      { return sum(&buffer_pool<byte_buffer_t>::get_capacity); }
+  uint32_t get_nof_used()      { return sum(&buffer_pool<byte_buffer_t>::get_nof_used); }
+  uint32_t get_high_water()    { return sum(&buffer_pool<byte_buffer_t>::get_high_water); }
+  uint32_t get_nof_exhausted() { return sum(&buffer_pool<byte_buffer_t>::get_nof_exhausted); }
+  size_t   get_memory() {
+    size_t mem = 0;
+    for (uint32_t i=0;i<NOF_CLASSES;i++) {
+      mem += pool[i]->get_memory();
+    }
+    return mem;
+  }
+  void print_stats() {
+    for (uint32_t i=0;i<NOF_CLASSES;i++) {
+      printf("%5d B buffers: %4d/%4d used, high water %4d, exhausted %d times, %.1f MB\n",
+             class_size[i], pool[i]->get_nof_used(), pool[i]->get_capacity(), pool[i]->get_high_water(),
+             pool[i]->get_nof_exhausted(), (float) pool[i]->get_memory()/1e6);
+    }
   }
 private:
-  buffer_pool<byte_buffer_t> *pool; 
+  enum {SMALL = 0, MEDIUM, LARGE, NOF_CLASSES};
+  static const uint32_t SMALL_POOL_SIZE  = 1024;
+  static const uint32_t MEDIUM_POOL_SIZE = 2048;
+  static const uint32_t LARGE_POOL_SIZE  = 512;  // MAC-sized PDUs, large SDUs and unsized control messages
+  static const uint32_t class_size[NOF_CLASSES];
+
+  uint32_t sum(uint32_t (buffer_pool<byte_buffer_t>::*get)()) {
+    uint32_t n = 0;
+    for (uint32_t i=0;i<NOF_CLASSES;i++) {
+      n += (pool[i]->*get)();
+    }
+    return n;
+  }
+
+  buffer_pool<byte_buffer_t> *pool[NOF_CLASSES]; 
 };
 
 
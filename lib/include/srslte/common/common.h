@@ -32,6 +32,8 @@
 *******************************************************************************/
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /*******************************************************************************
@@ -50,13 +52,24 @@
 #define SRSLTE_MAX_BUFFER_SIZE_BYTES 12756
 #define SRSLTE_BUFFER_HEADER_OFFSET  1024
 
+// Smaller byte buffer size classes served by byte_buffer_pool, with a
+// reduced headroom that still fits the PDCP and GTP-U headers
+#define SRSLTE_BUFFER_SMALL_SIZE_BYTES    256
+#define SRSLTE_BUFFER_MEDIUM_SIZE_BYTES   2048
+#define SRSLTE_BUFFER_SMALL_HEADER_OFFSET 64
+
+// IP packets read from TUN or GTP-U sockets with the default 1500 B MTU
+#define SRSLTE_MAX_IP_PACKET_BYTES        1500
+
 #define SRSLTE_BUFFER_POOL_LOG_ENABLED
 
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
 #define pool_allocate (pool->allocate(__FUNCTION__))
+#define pool_allocate_size(len) (pool->allocate(len, __FUNCTION__))
 #define SRSLTE_BUFFER_POOL_LOG_NAME_LEN 128
 #else
 #define pool_allocate (pool->allocate())
+#define pool_allocate_size(len) (pool->allocate(len))
 #endif
 
 #include "srslte/srslte.h"
@@ -115,11 +128,15 @@ static const char rb_id_text[RB_ID_N_ITEMS][20] = { "SRB0",
  * Generic buffers with headroom to accommodate packet headers and custom
  * copy constructors & assignment operators for quick copying. Byte buffer
  * holds a next pointer to support linked lists.
+ *
+ * The byte buffer storage is not embedded: buffers created directly own a
+ * full SRSLTE_MAX_BUFFER_SIZE_BYTES array, while buffers from byte_buffer_pool
+ * point to storage of the size class they were allocated from.
  *****************************************************************************/
 class byte_buffer_t{
 public:
     uint32_t    N_bytes;
-    uint8_t     buffer[SRSLTE_MAX_BUFFER_SIZE_BYTES];
+    uint8_t    *buffer;
     uint8_t    *msg;
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     char        debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN];
@@ -127,30 +144,44 @@ public:
 
     byte_buffer_t():N_bytes(0)
     {
-      timestamp_is_set = false; 
-      msg  = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
-      next = NULL; 
-#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
-      debug_name[0] = 0;
-#endif
+      init(new uint8_t[SRSLTE_MAX_BUFFER_SIZE_BYTES], SRSLTE_MAX_BUFFER_SIZE_BYTES, true);
+    }
+    // Uses external storage of size bytes, e.g. from a buffer pool
+    byte_buffer_t(uint8_t *storage, uint32_t size):N_bytes(0)
+    {
+      init(storage, size, false);
     }
     byte_buffer_t(const byte_buffer_t& buf)
     {
+      init(new uint8_t[SRSLTE_MAX_BUFFER_SIZE_BYTES], SRSLTE_MAX_BUFFER_SIZE_BYTES, true);
       N_bytes = buf.N_bytes;
       memcpy(msg, buf.msg, N_bytes);
     }
+    ~byte_buffer_t()
+    {
+      if (own_buffer) {
+        delete [] buffer;
+      }
+    }
     byte_buffer_t & operator= (const byte_buffer_t & buf)
     {
       // avoid self assignment
       if (&buf == this)
         return *this;
+      // A truncated copy would be a corrupted PDU, the destination must be
+      // allocated with a size class that holds buf
+      if (buf.N_bytes > get_tailroom()) {
+        fprintf(stderr, "Fatal error copying byte buffer: %d bytes do not fit in %d\n", 
+                buf.N_bytes, get_tailroom());
+        exit(-1);
+      }
       N_bytes = buf.N_bytes;
       memcpy(msg, buf.msg, N_bytes);
       return *this;
     }
     void reset()
     {
-      msg       = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
+      msg       = &buffer[header_offset];
       N_bytes   = 0;
       timestamp_is_set = false; 
     }
@@ -158,6 +189,20 @@ public:
     {
       return msg-buffer;
     }
+    // Number of bytes that fit from msg to the end of the buffer
+    uint32_t get_tailroom()
+    {
+      return buffer_size - get_headroom();
+    }
+    uint32_t get_buffer_size()
+    {
+      return buffer_size;
+    }
+    // Headroom reserved in front of msg for buffers of the given size
+    static uint32_t header_offset_for(uint32_t size)
+    {
+      return size < SRSLTE_MAX_BUFFER_SIZE_BYTES ? SRSLTE_BUFFER_SMALL_HEADER_OFFSET : SRSLTE_BUFFER_HEADER_OFFSET;
+    }
     long get_latency_us()
     {
       if(!timestamp_is_set)
@@ -175,6 +220,19 @@ public:
 
 private:
   
+  void init(uint8_t *storage, uint32_t size, bool own)
+  {
+    buffer           = storage;
+    buffer_size      = size;
+    header_offset    = header_offset_for(size);
+    own_buffer       = own;
+    timestamp_is_set = false; 
+    msg  = &buffer[header_offset];
+    next = NULL; 
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+    debug_name[0] = 0;
+#endif
+  }
   
   void get_time_interval(struct timeval * tdata) {
 
@@ -190,6 +248,9 @@ private:
     struct timeval timestamp[3];
     bool           timestamp_is_set; 
     byte_buffer_t *next;
+    uint32_t       buffer_size;
+    uint32_t       header_offset;
+    bool           own_buffer;
 };
 
 struct bit_buffer_t{
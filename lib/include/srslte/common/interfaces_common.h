@@ -28,6 +28,7 @@
 #define INTERFACE_COMMON_H
 
 #include "srslte/common/timers.h"
+#include "srslte/common/buffer_chain.h"
 
 namespace srslte {
 
@@ -45,6 +46,11 @@ class read_pdu_interface
 {
 public:
   virtual int read_pdu(uint32_t lcid, uint8_t *payload, uint32_t requested_bytes) = 0; 
+  /* Appends the PDU to chain as references to the buffered SDUs instead of 
+   * copying it. Returns -1 if the bearer can not build chains, in which case 
+   * the caller falls back to read_pdu() 
+   */
+  virtual int read_pdu_chain(uint32_t lcid, buffer_chain *chain, uint32_t requested_bytes) { return -1; }
 };
 
 }
@@ -27,9 +27,9 @@
 /******************************************************************************
  * File:        log_filter.h
  * Description: Log filter for a specific layer or element.
- *              Performs filtering based on log level, generates
- *              timestamped log strings and passes them to the
- *              common logger object.
+ *              Performs filtering based on log level and passes the
+ *              format string and its arguments to the common logger
+ *              object, which timestamps and formats them.
  *****************************************************************************/
 
 #ifndef LOG_FILTER_H
@@ -71,11 +71,8 @@ private:
   logger *logger_h;
   bool    do_tti;
 
-  void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, char *msg);
-  void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, char *msg, uint8_t *hex, int size);
-  void all_log_line(srslte::LOG_LEVEL_ENUM level, uint32_t tti, std::string file, int line, char *msg);
-  std::string now_time();
-  std::string hex_string(uint8_t *hex, int size);
+  void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, const char *msg, va_list args);
+  void all_log(srslte::LOG_LEVEL_ENUM level, uint32_t tti, const char *msg, va_list args, uint8_t *hex, int size);
 };
 
 } // namespace srsue
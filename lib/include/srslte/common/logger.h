@@ -26,24 +26,35 @@
 
 /******************************************************************************
  * File:        logger.h
- * Description: Common log object. Maintains a queue of log messages
- *              and runs a thread to read messages and write to file.
- *              Multiple producers, single consumer. If full, producers
- *              increase queue size. If empty, consumer blocks.
+ * Description: Common log object. Each producer thread writes binary log
+ *              records into its own lock-free ring: a timestamp counter
+ *              value, the format string and the raw printf arguments,
+ *              including hex payloads. A background thread merges the
+ *              rings in timestamp order, formats the records and writes
+ *              them to file. If its ring is full, a producer drops the
+ *              message and the logger thread reports how many were
+ *              dropped once it drains the ring. Waiting for room instead
+ *              is enabled with set_block_when_full().
  *****************************************************************************/
 
 #ifndef LOGGER_H
 #define LOGGER_H
 
 #include <stdio.h>
-#include <deque>
+#include <stdarg.h>
+#include <pthread.h>
 #include <string>
+#include <vector>
+#include "srslte/common/log.h"
+#include "srslte/common/ring_queue.h"
 #include "srslte/common/threads.h"
 
 namespace srslte {
 
 typedef std::string* str_ptr;
 
+class log_ring;
+
 class logger : public thread
 {
 public:
@@ -54,19 +65,51 @@ public:
   void log(const char *msg);
   void log(str_ptr msg);
 
+  /* If enabled, a producer whose ring is full waits for the logger thread to
+   * drain it instead of dropping the message. Disabled by default so that
+   * logging never stalls a real-time thread */
+  void set_block_when_full(bool block);
+
+  /* Logs a message prefixed with the time, service name, level and
+   * optionally the TTI. Only the arguments are captured here, the message is
+   * formatted by the logger thread. A hex dump of the first hex_len bytes of
+   * hex follows the message if hex_len >= 0 */
+  void log_fmt(const std::string &service, LOG_LEVEL_ENUM level, bool do_tti, uint32_t tti,
+               const char *fmt, va_list args, const uint8_t *hex = NULL, int hex_len = -1);
+
 private:
-  void run_thread(); 
-  void flush();
-
-  FILE*                 logfile;
-  bool                  inited;
-  bool                  not_done;
-  std::string           filename;
-  pthread_cond_t        not_empty;
-  pthread_cond_t        not_full;
-  pthread_mutex_t       mutex;
-  pthread_t             thread;
-  std::deque<str_ptr> buffer;
+  void run_thread();
+  bool drain();
+  void write_record(uint8_t *rec);
+  void report_dropped(log_ring *ring);
+  log_ring* get_ring();
+  void push(log_ring *ring, uint8_t *rec, uint32_t len);
+  void calibrate();
+  uint64_t to_wall_ns(uint64_t ts);
+
+  static void ring_orphan(void *ring);
+
+  FILE*                  logfile;
+  bool                   inited;
+  bool                   not_done;
+  bool                   block_when_full;
+  std::string            filename;
+  pthread_key_t          ring_key;
+  pthread_mutex_t        mutex;
+  std::vector<log_ring*> rings;
+  ring_event             wakeup;
+
+  // Conversion of the timestamps to wall clock, through CLOCK_MONOTONIC
+  bool                   use_tsc;
+  uint64_t               ref_ts;
+  uint64_t               ref_mono_ns;
+  uint64_t               cal_mono_ns;
+  int64_t                realtime_offset_ns;
+  double                 ns_per_tick;
+
+  std::string            line;
+  time_t                 line_sec;
+  char                   line_hms[16];
 };
 
 } // namespace srsue
@@ -27,6 +27,8 @@
 /******************************************************************************
  *  File:         msg_queue.h
  *  Description:  Thread-safe bounded circular buffer of srsue_byte_buffer pointers.
+ *                Lock-free: write() and read() only sleep while the queue is
+ *                full or empty.
  *  Reference:
  *****************************************************************************/
 
@@ -34,7 +36,7 @@
 #define MSG_QUEUE_H
 
 #include "srslte/common/common.h"
-#include <pthread.h>
+#include "srslte/common/ring_queue.h"
 
 namespace srslte {
 
@@ -42,108 +44,55 @@ class msg_queue
 {
 public:
   msg_queue(uint32_t capacity_ = 128)
-    :head(0)
-    ,tail(0)
-    ,unread(0)
+    :ring(capacity_, true)
     ,unread_bytes(0)
-    ,capacity(capacity_)
   {
-    buf = new byte_buffer_t*[capacity];
-    pthread_mutex_init(&mutex, NULL);
-    pthread_cond_init(&not_empty, NULL);
-    pthread_cond_init(&not_full, NULL);
-  }
-
-  ~msg_queue()
-  {
-    delete [] buf;
   }
 
   void write(byte_buffer_t *msg)
   {
-    pthread_mutex_lock(&mutex);
-    while(is_full()) {
-      pthread_cond_wait(&not_full, &mutex);
-    }
-    buf[head] = msg;
-    head = (head+1)%capacity;
-    unread++;
-    unread_bytes += msg->N_bytes;
-    
-    pthread_cond_signal(&not_empty);
-    pthread_mutex_unlock(&mutex);
+    // msg may already be consumed once pushed, so its size is taken before. The bytes are only 
+    // counted once the push went through, a reader may thus briefly take the count below zero
+    int32_t n_bytes = msg->N_bytes; 
+    ring.push(msg);
+    __atomic_fetch_add(&unread_bytes, n_bytes, __ATOMIC_RELAXED);
   }
 
   void read(byte_buffer_t **msg)
   {
-    pthread_mutex_lock(&mutex);
-    while(is_empty()) {
-      pthread_cond_wait(&not_empty, &mutex);
-    }
-    *msg = buf[tail];
-    tail = (tail+1)%capacity;
-    unread--;
-    unread_bytes -= (*msg)->N_bytes;
-
-    pthread_cond_signal(&not_full);
-    pthread_mutex_unlock(&mutex);
+    *msg = ring.wait_pop();
+    __atomic_fetch_sub(&unread_bytes, (*msg)->N_bytes, __ATOMIC_RELAXED);
   }
 
   bool try_read(byte_buffer_t **msg)
   {
-    pthread_mutex_lock(&mutex);
-    if(is_empty())
-    {
-      pthread_mutex_unlock(&mutex);
+    if(!ring.try_pop(msg)) {
       return false;
-    }else{
-      *msg = buf[tail];
-      tail = (tail+1)%capacity;
-      unread--;
-      unread_bytes -= (*msg)->N_bytes;
-      pthread_cond_signal(&not_full);
-      pthread_mutex_unlock(&mutex);
-      return true;
     }
+    __atomic_fetch_sub(&unread_bytes, (*msg)->N_bytes, __ATOMIC_RELAXED);
+    return true;
   }
 
   uint32_t size()
   {
-    pthread_mutex_lock(&mutex);
-    uint32_t r = unread;
-    pthread_mutex_unlock(&mutex);
-    return r; 
+    return ring.size();
   }
 
   uint32_t size_bytes()
   {
-    pthread_mutex_lock(&mutex);
-    uint32_t r = unread_bytes;
-    pthread_mutex_unlock(&mutex);
-    return r; 
+    int32_t n = __atomic_load_n(&unread_bytes, __ATOMIC_RELAXED);
+    return n > 0 ? n : 0;
   }
 
   uint32_t size_tail_bytes()
   {
-    pthread_mutex_lock(&mutex);
-    uint32_t r = buf[tail]->N_bytes;
-    pthread_mutex_unlock(&mutex);
-    return r; 
+    byte_buffer_t *msg;
+    return ring.front(&msg) ? msg->N_bytes : 0;
   }
 
 private:
-  bool     is_empty() const { return unread == 0; }
-  bool     is_full() const { return unread == capacity; }
-
-  pthread_cond_t        not_empty;
-  pthread_cond_t        not_full;
-  pthread_mutex_t       mutex;
-  byte_buffer_t **buf;
-  uint32_t              capacity;
-  uint32_t              unread;
-  uint32_t              unread_bytes;
-  uint32_t              head;
-  uint32_t              tail;
+  mpsc_ring<byte_buffer_t*> ring;
+  int32_t                   unread_bytes;
 };
 
 } // namespace srsue
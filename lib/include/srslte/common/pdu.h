@@ -267,7 +267,15 @@ class sch_pdu : public pdu<sch_subh>
 {
 public:
   
-  sch_pdu(uint32_t max_subh) : pdu(max_subh) {}
+  sch_pdu(uint32_t max_subh) : pdu(max_subh), chain(NULL) {}
+
+  void      init_tx(uint8_t *payload, uint32_t pdu_len_bytes, bool is_ulsch = false);
+  /* Writes headers, CEs and padding to payload but only references the SDUs. 
+   * After write_packet() the chain holds the whole PDU in order 
+   */
+  void      init_tx_chain(uint8_t *payload, uint32_t pdu_len_bytes, buffer_chain *chain);
+  buffer_chain* get_chain();
+  void      reserve_slices(uint32_t nof_slices);
 
   void      parse_packet(uint8_t *ptr);
   uint8_t*  write_packet();
@@ -282,6 +290,9 @@ public:
   bool      update_space_ce(uint32_t nbytes);  
   bool      update_space_sdu(uint32_t nbytes);  
   void      fprint(FILE *stream);
+
+private:
+  buffer_chain *chain;
 };
 
 class rar_subh : public subh<rar_subh>
@@ -28,7 +28,7 @@
 #define PDUPROC_H
 
 #include "srslte/common/log.h"
-#include "srslte/common/block_queue.h"
+#include "srslte/common/ring_queue.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/timers.h"
 #include "srslte/common/pdu.h"
@@ -47,7 +47,7 @@ public:
       virtual void process_pdu(uint8_t *buff, uint32_t len, uint32_t tstamp) = 0;
   };
 
-  pdu_queue(uint32_t pool_size = DEFAULT_POOL_SIZE) : pool(pool_size), callback(NULL), log_h(NULL) {}
+  pdu_queue(uint32_t pool_size = DEFAULT_POOL_SIZE) : pdu_q(pool_size), pool(pool_size), callback(NULL), log_h(NULL) {}
   void init(process_callback *callback, log* log_h_);
 
   uint8_t* request(uint32_t len);  
@@ -70,7 +70,8 @@ private:
 
   } pdu_t; 
   
-  block_queue<pdu_t*> pdu_q; 
+  // Pushed by the PHY workers, popped by the MAC. Holds every buffer of the pool
+  mpsc_ring<pdu_t*>   pdu_q; 
   buffer_pool<pdu_t>  pool;
   
   process_callback   *callback;   
@@ -0,0 +1,437 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace srslte {
+
+/******************************************************************************
+ * Bounded lock-free rings
+ *
+ * spsc_ring: one producer and one consumer thread. Each side owns its index
+ * and keeps a cached copy of the other one, so a push or pop only touches the
+ * other side's cache line when the ring looks full or empty.
+ *
+ * mpsc_ring: any number of producers. Cells carry a sequence number that
+ * tells whether they are free or filled (D. Vyukov's bounded queue). Slots
+ * are claimed with a CAS, also on the consumer side, so an occasional second
+ * consumer such as a queue flush on reset is safe.
+ *
+ * Capacities are rounded up to a power of two. Both rings may be created
+ * blocking, which adds push() and wait_pop() that sleep on a futex while the
+ * ring is full or empty. A producer waiting for space is woken once the ring
+ * is half empty, so that it refills it in one go. The non-blocking try_
+ * functions never sleep.
+ *****************************************************************************/
+
+#define SRSLTE_RING_CACHE_LINE 64
+
+// Polls before sleeping, a handoff is usually faster than a futex wake up.
+// Spinning only delays the other side on a single core
+#define SRSLTE_RING_SPIN_COUNT 256
+
+static inline uint32_t ring_spin_count() {
+  static uint32_t n = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SRSLTE_RING_SPIN_COUNT : 0;
+  return n;
+}
+
+static inline void ring_cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause");
+#endif
+}
+
+/* Futex based event. A waiter arms the event before re-checking its
+ * condition, so notify() only makes a system call when a thread may be
+ * sleeping, and only once for all the threads waiting at that time */
+class ring_event
+{
+public:
+  ring_event() : seq(0), armed(0) {}
+
+  int32_t prepare_wait() {
+    __atomic_store_n(&armed, 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&seq, __ATOMIC_SEQ_CST);
+  }
+  // Returns after a notify() or, if given, once the relative timeout expires
+  void wait(int32_t key, const struct timespec *timeout = NULL) {
+    syscall(SYS_futex, &seq, FUTEX_WAIT_PRIVATE, key, timeout, NULL, 0);
+  }
+  void notify() {
+    // Orders the caller's publication before reading armed
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&armed, __ATOMIC_RELAXED) && __atomic_exchange_n(&armed, 0, __ATOMIC_SEQ_CST)) {
+      __atomic_fetch_add(&seq, 1, __ATOMIC_SEQ_CST);
+      syscall(SYS_futex, &seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+  }
+
+private:
+  int32_t seq;
+  int32_t armed;
+};
+
+static inline uint32_t ring_capacity(uint32_t n) {
+  uint32_t c = 1;
+  while (c < n) {
+    c <<= 1;
+  }
+  return c;
+}
+
+template<typename T>
+class spsc_ring
+{
+public:
+  spsc_ring(uint32_t capacity_, bool blocking_ = false) {
+    capacity    = ring_capacity(capacity_);
+    mask        = capacity - 1;
+    buf         = new T[capacity];
+    blocking    = blocking_;
+    head        = 0;
+    cached_tail = 0;
+    tail        = 0;
+    cached_head = 0;
+  }
+  ~spsc_ring() {
+    delete [] buf;
+  }
+
+  /* Producer side */
+  bool try_push(const T& value) {
+    return try_push(&value, 1) == 1;
+  }
+  // Pushes up to n values and publishes them at once. Returns the number pushed
+  uint32_t try_push(const T *values, uint32_t n) {
+    uint32_t h = head;
+    if (capacity - (h - cached_tail) < n) {
+      cached_tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+      uint32_t space = capacity - (h - cached_tail);
+      n = n < space ? n : space;
+    }
+    if (n == 0) {
+      return 0;
+    }
+    for (uint32_t i=0;i<n;i++) {
+      buf[(h+i)&mask] = values[i];
+    }
+    __atomic_store_n(&head, h+n, __ATOMIC_RELEASE);
+    if (blocking) {
+      not_empty.notify();
+    }
+    return n;
+  }
+  // Waits while the ring is full. Only for blocking rings
+  void push(const T& value) {
+    for (uint32_t i=0;i<ring_spin_count();i++) {
+      if (try_push(value)) {
+        return;
+      }
+      ring_cpu_relax();
+    }
+    while (!try_push(value)) {
+      int32_t key = not_full.prepare_wait();
+      if (try_push(value)) {
+        return;
+      }
+      not_full.wait(key);
+    }
+  }
+
+  /* Consumer side */
+  bool try_pop(T *value) {
+    return try_pop(value, 1) == 1;
+  }
+  // Pops up to max_n values and releases their slots at once
+  uint32_t try_pop(T *values, uint32_t max_n) {
+    uint32_t t = tail;
+    uint32_t n = cached_head - t;
+    if (n < max_n) {
+      cached_head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+      n = cached_head - t;
+    }
+    n = n < max_n ? n : max_n;
+    if (n == 0) {
+      return 0;
+    }
+    for (uint32_t i=0;i<n;i++) {
+      values[i] = buf[(t+i)&mask];
+    }
+    __atomic_store_n(&tail, t+n, __ATOMIC_RELEASE);
+    if (blocking && size() <= capacity/2) {
+      not_full.notify();
+    }
+    return n;
+  }
+  // Waits while the ring is empty. Only for blocking rings
+  T wait_pop() {
+    T value;
+    for (uint32_t i=0;i<ring_spin_count();i++) {
+      if (try_pop(&value)) {
+        return value;
+      }
+      ring_cpu_relax();
+    }
+    while (!try_pop(&value)) {
+      int32_t key = not_empty.prepare_wait();
+      if (try_pop(&value)) {
+        break;
+      }
+      not_empty.wait(key);
+    }
+    return value;
+  }
+  bool front(T *value) {
+    uint32_t t = tail;
+    if (t == __atomic_load_n(&head, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    *value = buf[t&mask];
+    return true;
+  }
+
+  uint32_t size() {
+    uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&head, __ATOMIC_ACQUIRE) - t;
+  }
+  bool empty() {
+    return size() == 0;
+  }
+  uint32_t get_capacity() {
+    return capacity;
+  }
+
+private:
+  uint8_t    pad0[SRSLTE_RING_CACHE_LINE];
+  // Written by the producer
+  uint32_t   head;
+  uint32_t   cached_tail;
+  uint8_t    pad1[SRSLTE_RING_CACHE_LINE - 2*sizeof(uint32_t)];
+  // Written by the consumer
+  uint32_t   tail;
+  uint32_t   cached_head;
+  uint8_t    pad2[SRSLTE_RING_CACHE_LINE - 2*sizeof(uint32_t)];
+  // Read only
+  T         *buf;
+  uint32_t   capacity;
+  uint32_t   mask;
+  bool       blocking;
+  ring_event not_empty;
+  ring_event not_full;
+};
+
+template<typename T>
+class mpsc_ring
+{
+public:
+  mpsc_ring(uint32_t capacity_, bool blocking_ = false) {
+    capacity    = ring_capacity(capacity_);
+    mask        = capacity - 1;
+    cells       = new cell_t[capacity];
+    blocking    = blocking_;
+    enqueue_pos = 0;
+    dequeue_pos = 0;
+    for (uint32_t i=0;i<capacity;i++) {
+      cells[i].seq = i;
+    }
+  }
+  ~mpsc_ring() {
+    delete [] cells;
+  }
+
+  /* Producer side, any thread */
+  bool try_push(const T& value) {
+    if (!push_one(value)) {
+      return false;
+    }
+    if (blocking) {
+      not_empty.notify();
+    }
+    return true;
+  }
+  // Pushes up to n values in order and wakes the consumer once
+  uint32_t try_push(const T *values, uint32_t n) {
+    uint32_t i = 0;
+    while (i < n && push_one(values[i])) {
+      i++;
+    }
+    if (blocking && i > 0) {
+      not_empty.notify();
+    }
+    return i;
+  }
+  // Waits while the ring is full. Only for blocking rings
+  void push(const T& value) {
+    for (uint32_t i=0;i<ring_spin_count();i++) {
+      if (try_push(value)) {
+        return;
+      }
+      ring_cpu_relax();
+    }
+    while (!try_push(value)) {
+      int32_t key = not_full.prepare_wait();
+      if (try_push(value)) {
+        return;
+      }
+      not_full.wait(key);
+    }
+  }
+
+  /* Consumer side */
+  bool try_pop(T *value) {
+    if (!pop_one(value)) {
+      return false;
+    }
+    if (blocking && size() <= capacity/2) {
+      not_full.notify();
+    }
+    return true;
+  }
+  uint32_t try_pop(T *values, uint32_t max_n) {
+    uint32_t i = 0;
+    while (i < max_n && pop_one(&values[i])) {
+      i++;
+    }
+    if (blocking && i > 0 && size() <= capacity/2) {
+      not_full.notify();
+    }
+    return i;
+  }
+  // Waits while the ring is empty. Only for blocking rings
+  T wait_pop() {
+    T value;
+    for (uint32_t i=0;i<ring_spin_count();i++) {
+      if (try_pop(&value)) {
+        return value;
+      }
+      ring_cpu_relax();
+    }
+    while (!try_pop(&value)) {
+      int32_t key = not_empty.prepare_wait();
+      if (try_pop(&value)) {
+        break;
+      }
+      not_empty.wait(key);
+    }
+    return value;
+  }
+  // Oldest value, if any. Meaningful only while no other thread pops
+  bool front(T *value) {
+    uint32_t pos  = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    cell_t  *cell = &cells[pos&mask];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos+1) {
+      return false;
+    }
+    *value = cell->data;
+    return true;
+  }
+
+  uint32_t size() {
+    uint32_t d = __atomic_load_n(&dequeue_pos, __ATOMIC_ACQUIRE);
+    uint32_t e = __atomic_load_n(&enqueue_pos, __ATOMIC_ACQUIRE);
+    int32_t  n = (int32_t) (e - d);
+    return n > 0 ? (uint32_t) n : 0;
+  }
+  bool empty() {
+    return size() == 0;
+  }
+  uint32_t get_capacity() {
+    return capacity;
+  }
+
+private:
+  typedef struct {
+    uint32_t seq;
+    T        data;
+  } cell_t;
+
+  bool push_one(const T& value) {
+    uint32_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    cell_t  *cell;
+    while (true) {
+      cell = &cells[pos&mask];
+      int32_t dif = (int32_t) (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+      if (dif == 0) {
+        if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false; // full
+      } else {
+        pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+      }
+    }
+    cell->data = value;
+    __atomic_store_n(&cell->seq, pos+1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  bool pop_one(T *value) {
+    uint32_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    cell_t  *cell;
+    while (true) {
+      cell = &cells[pos&mask];
+      int32_t dif = (int32_t) (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos+1));
+      if (dif == 0) {
+        if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false; // empty
+      } else {
+        pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+      }
+    }
+    *value = cell->data;
+    // Free the cell for the producer one lap ahead
+    __atomic_store_n(&cell->seq, pos+capacity, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  uint8_t    pad0[SRSLTE_RING_CACHE_LINE];
+  uint32_t   enqueue_pos;
+  uint8_t    pad1[SRSLTE_RING_CACHE_LINE - sizeof(uint32_t)];
+  uint32_t   dequeue_pos;
+  uint8_t    pad2[SRSLTE_RING_CACHE_LINE - sizeof(uint32_t)];
+  cell_t    *cells;
+  uint32_t   capacity;
+  uint32_t   mask;
+  bool       blocking;
+  ring_event not_empty;
+  ring_event not_full;
+};
+
+} // namespace srslte
+
+#endif // RING_QUEUE_H
@@ -27,6 +27,7 @@
 #include "srslte/srslte.h"
 
 #include "srslte/common/common.h"
+#include "srslte/common/buffer_chain.h"
 #include "srslte/common/security.h"
 #include "srslte/interfaces/sched_interface.h"
 #include "srslte/asn1/liblte_rrc.h"
@@ -47,6 +48,7 @@ public:
   
   typedef struct {
     srslte_enb_dl_pdsch_t sched_grants[MAX_GRANTS];
+    srslte::buffer_chain *chains[MAX_GRANTS]; // PDU of each grant as a chain of slices, or NULL if in data
     uint32_t nof_grants; 
     uint32_t cfi; 
   } dl_sched_t; 
@@ -127,6 +129,9 @@ public:
   /* MAC calls RLC to get RLC segment of nof_bytes length.
    * Segmentation happens in this function. RLC PDU is stored in payload. */
   virtual int  read_pdu(uint16_t rnti, uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) = 0;
+  /* As read_pdu() but appends references to the RLC buffers to chain. Returns -1 
+   * if the bearer can not build chains. */
+  virtual int  read_pdu_chain(uint16_t rnti, uint32_t lcid, srslte::buffer_chain *chain, uint32_t nof_bytes) { return -1; }
 
   virtual void read_pdu_bcch_dlsch(uint32_t sib_index, uint8_t *payload) = 0;
   virtual void read_pdu_pcch(uint8_t* payload, uint32_t buffer_size) = 0; 
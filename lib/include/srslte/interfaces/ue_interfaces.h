@@ -371,6 +371,8 @@ typedef struct {
   bool ul_pwr_ctrl_en; 
   float prach_gain;
   int pdsch_max_its;
+  int pdsch_dec_threads;
+  int pdsch_min_its;
   bool attach_enable_64qam; 
   int nof_phy_threads;
   
@@ -389,6 +391,8 @@ typedef struct {
   bool sfo_correct_disable; 
   std::string sss_algorithm; 
   float estimator_fil_w;   
+  std::string estimator_interp; 
+  bool estimator_lazy; 
   bool rssi_sensor_enabled;
 } phy_args_t; 
   
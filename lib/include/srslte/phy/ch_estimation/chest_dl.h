@@ -58,6 +58,33 @@ typedef enum {
   SRSLTE_NOISE_ALG_EMPTY,
 } srslte_chest_dl_noise_alg_t; 
 
+/* Interpolation of the pilot estimates to the resource grid:
+ *  LINEAR: smoothing, frequency and time interpolation as separate passes over the subframe
+ *  FUSED:  same estimates computed in a single pass per group of SRSLTE_CHEST_DL_GROUP_PRB PRB
+ *  WIENER: low-rank 2-D Wiener interpolation of each PRB from the pilots of its neighbouring PRB
+ */
+typedef enum {
+  SRSLTE_CHEST_DL_INTERP_LINEAR = 0, 
+  SRSLTE_CHEST_DL_INTERP_FUSED, 
+  SRSLTE_CHEST_DL_INTERP_WIENER, 
+} srslte_chest_dl_interp_t; 
+
+#define SRSLTE_CHEST_DL_GROUP_PRB           8
+#define SRSLTE_CHEST_DL_WIENER_PRB          3
+#define SRSLTE_CHEST_DL_WIENER_MAX_PILOTS   (SRSLTE_CHEST_DL_WIENER_PRB*2*4)
+#define SRSLTE_CHEST_DL_WIENER_MAX_RANK     16
+#define SRSLTE_CHEST_DL_WIENER_NOF_BINS     8
+
+/* Wiener interpolator of one PRB: h = interp*diag(gain[snr_bin])*proj*pilots, where proj holds the 
+ * dominant eigenvectors of the pilot correlation matrix */
+typedef struct {
+  uint32_t nof_pilots; 
+  uint32_t rank; 
+  float *proj;    // rank x nof_pilots
+  float *interp;  // nof_symbols x rank x SRSLTE_NRE
+  float gain[SRSLTE_CHEST_DL_WIENER_NOF_BINS][SRSLTE_CHEST_DL_WIENER_MAX_RANK];
+} srslte_chest_dl_wiener_t;
+
 typedef struct {
   srslte_cell_t cell; 
   srslte_refsignal_cs_t csr_signal;
@@ -88,6 +115,25 @@ typedef struct {
   srslte_chest_dl_noise_alg_t noise_alg; 
   int last_nof_antennas;
 
+  srslte_chest_dl_interp_t interp; 
+  cf_t *block;  // Frequency-interpolated pilot symbols of one PRB group
+
+  /* Time interpolation of each symbol: copy of pilot symbol time_pilot[] or linear between pilot 
+   * symbols time_seg[] and time_seg[]+1 with weight time_w[]. Index 0 for ports 0/1, 1 for ports 2/3 */
+  int time_pilot[2][2*SRSLTE_CP_NORM_NSYMB];
+  uint32_t time_seg[2][2*SRSLTE_CP_NORM_NSYMB];
+  float time_w[2][2*SRSLTE_CP_NORM_NSYMB];
+
+  float wiener_delay_us; 
+  float wiener_doppler_hz; 
+  bool wiener_ready; 
+  srslte_chest_dl_wiener_t wiener[SRSLTE_MAX_PORTS][SRSLTE_CHEST_DL_WIENER_PRB];
+  uint32_t wiener_bin[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
+
+  /* In lazy mode only pilots are estimated and srslte_chest_dl_interpolate() fills the grid on demand */
+  bool lazy; 
+  cf_t *lazy_pilots[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
+
 } srslte_chest_dl_t;
 
 
@@ -106,6 +152,30 @@ SRSLTE_API void srslte_chest_dl_set_smooth_filter3_coeff(srslte_chest_dl_t* q,
 SRSLTE_API void srslte_chest_dl_set_noise_alg(srslte_chest_dl_t *q, 
                                               srslte_chest_dl_noise_alg_t noise_estimation_alg); 
 
+SRSLTE_API int srslte_chest_dl_set_interp(srslte_chest_dl_t *q, 
+                                          srslte_chest_dl_interp_t interp); 
+
+SRSLTE_API int srslte_chest_dl_set_wiener_model(srslte_chest_dl_t *q, 
+                                                float delay_spread_us, 
+                                                float doppler_hz); 
+
+SRSLTE_API int srslte_chest_dl_set_lazy(srslte_chest_dl_t *q, 
+                                        bool enable); 
+
+SRSLTE_API int srslte_chest_dl_interpolate(srslte_chest_dl_t *q, 
+                                           cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                           uint32_t first_symbol, 
+                                           uint32_t nof_symbols, 
+                                           bool *prb_mask);
+
+SRSLTE_API int srslte_chest_dl_interpolate_port(srslte_chest_dl_t *q, 
+                                                cf_t *ce, 
+                                                uint32_t port_id, 
+                                                uint32_t rxant_id, 
+                                                uint32_t first_symbol, 
+                                                uint32_t nof_symbols, 
+                                                bool *prb_mask);
+
 SRSLTE_API int srslte_chest_dl_estimate_multi(srslte_chest_dl_t *q, 
                                               cf_t *input[SRSLTE_MAX_PORTS],
                                               cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
@@ -52,7 +52,6 @@ typedef struct {
   srslte_cell_t cell; 
   
   srslte_refsignal_ul_t             dmrs_signal;
-  srslte_refsignal_ul_dmrs_pregen_t dmrs_pregen; 
   bool dmrs_signal_configured; 
   
   cf_t *pilot_estimates;
@@ -44,6 +44,8 @@
 #define SRSLTE_NOF_DELTA_SS    30
 #define SRSLTE_NOF_CSHIFT      8
 
+#define SRSLTE_REFSIGNAL_UL_CACHE_SIZE 32  // Base sequences kept by each srslte_refsignal_ul_t
+
 #define SRSLTE_REFSIGNAL_UL_L(ns_idx, cp) ((ns_idx+1)*SRSLTE_CP_NSYMB(cp)-4)
 
 /* PUSCH DMRS common configuration (received in SIB2) */
@@ -70,6 +72,26 @@ typedef struct SRSLTE_API {
   bool configured; 
 }srslte_refsignal_srs_cfg_t;
 
+/* Base sequence r_uv for a (u, v, nof_prb) tuple */
+typedef struct SRSLTE_API {
+  uint32_t u; 
+  uint32_t v; 
+  uint32_t nof_prb; 
+  uint32_t last_used;   // 0 if the entry is empty
+  cf_t *r_uv; 
+}srslte_refsignal_ul_cache_entry_t;
+
+/* Least-recently-used cache of base sequences. The cyclic shifts are applied on top 
+ * of the cached sequence, so its size does not depend on the number of UE */
+typedef struct SRSLTE_API {
+  srslte_refsignal_ul_cache_entry_t *entries; 
+  uint32_t nof_entries; 
+  uint32_t max_prb; 
+  uint32_t clock; 
+  uint32_t nof_hits; 
+  uint32_t nof_misses; 
+}srslte_refsignal_ul_cache_t;
+
 /** Uplink DeModulation Reference Signal (DMRS) */
 typedef struct SRSLTE_API {
   srslte_cell_t cell; 
@@ -83,6 +105,9 @@ typedef struct SRSLTE_API {
   uint32_t f_gh[SRSLTE_NSLOTS_X_FRAME];
   uint32_t u_pucch[SRSLTE_NSLOTS_X_FRAME];
   uint32_t v_pusch[SRSLTE_NSLOTS_X_FRAME][SRSLTE_NOF_DELTA_SS];
+  
+  srslte_refsignal_ul_cache_t cache; 
+  cf_t cshift_ramp[SRSLTE_NRE][SRSLTE_NRE]; // exp(j*2*pi*n_cs*n/12) for each n_cs
 } srslte_refsignal_ul_t;
 
 typedef struct {
@@ -106,6 +131,22 @@ SRSLTE_API void srslte_refsignal_ul_set_cfg(srslte_refsignal_ul_t *q,
 SRSLTE_API void srslte_refsignal_r_uv_arg_1prb(float *arg, 
                                                uint32_t u); 
 
+SRSLTE_API void srslte_refsignal_r_uv_gen(cf_t *r_uv, 
+                                          uint32_t nof_prb, 
+                                          uint32_t u, 
+                                          uint32_t v); 
+
+SRSLTE_API int srslte_refsignal_ul_cache_init(srslte_refsignal_ul_cache_t *q, 
+                                              uint32_t max_prb, 
+                                              uint32_t nof_entries); 
+
+SRSLTE_API void srslte_refsignal_ul_cache_free(srslte_refsignal_ul_cache_t *q); 
+
+SRSLTE_API cf_t* srslte_refsignal_ul_cache_get(srslte_refsignal_ul_cache_t *q, 
+                                               uint32_t nof_prb, 
+                                               uint32_t u, 
+                                               uint32_t v); 
+
 SRSLTE_API uint32_t srslte_refsignal_dmrs_N_rs(srslte_pucch_format_t format, 
                                                srslte_cp_t cp); 
 
@@ -113,6 +154,11 @@ SRSLTE_API uint32_t srslte_refsignal_dmrs_pucch_symbol(uint32_t m,
                                                        srslte_pucch_format_t format, 
                                                        srslte_cp_t cp); 
 
+SRSLTE_API float srslte_refsignal_dmrs_pucch_w_arg(uint32_t m, 
+                                                   uint32_t n_oc, 
+                                                   srslte_pucch_format_t format, 
+                                                   srslte_cp_t cp); 
+
 SRSLTE_API bool srslte_refsignal_dmrs_pusch_cfg_isvalid(srslte_refsignal_ul_t *q, 
                                                         srslte_refsignal_dmrs_pusch_cfg_t *cfg, 
                                                         uint32_t nof_prb); 
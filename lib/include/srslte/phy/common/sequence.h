@@ -47,6 +47,13 @@ typedef struct SRSLTE_API {
   uint32_t len;
 } srslte_sequence_t;
 
+/* Word-parallel Gold sequence generator. Holds 62 bits of each m-sequence, so a sequence can be 
+ * produced on demand with O(1) memory */
+typedef struct SRSLTE_API {
+  uint64_t x1;
+  uint64_t x2;
+} srslte_sequence_gen_t;
+
 SRSLTE_API int srslte_sequence_init(srslte_sequence_t *q, uint32_t len);
 
 SRSLTE_API void srslte_sequence_free(srslte_sequence_t *q);
@@ -58,6 +65,19 @@ SRSLTE_API int srslte_sequence_LTE_pr(srslte_sequence_t *q,
 SRSLTE_API void srslte_sequence_set_LTE_pr(srslte_sequence_t *q, 
                                            uint32_t seed); 
 
+SRSLTE_API void srslte_sequence_gen_init(srslte_sequence_gen_t *g, 
+                                         uint32_t seed); 
+
+SRSLTE_API uint32_t srslte_sequence_gen_next(srslte_sequence_gen_t *g); 
+
+SRSLTE_API void srslte_sequence_gen_words(srslte_sequence_gen_t *g, 
+                                          uint32_t *c, 
+                                          uint32_t nof_words); 
+
+SRSLTE_API void srslte_sequence_LTE_pr_bytes(uint8_t *c_bytes, 
+                                             uint32_t len, 
+                                             uint32_t seed); 
+
 SRSLTE_API int srslte_sequence_pbch(srslte_sequence_t *seq, 
                                     srslte_cp_t cp, 
                                     uint32_t cell_id);
@@ -75,6 +95,15 @@ SRSLTE_API int srslte_sequence_pdcch(srslte_sequence_t *seq,
                                      uint32_t cell_id, 
                                      uint32_t len);
 
+SRSLTE_API uint32_t srslte_sequence_pdsch_seed(uint16_t rnti, 
+                                               int q,
+                                               uint32_t nslot, 
+                                               uint32_t cell_id);
+
+SRSLTE_API uint32_t srslte_sequence_pusch_seed(uint16_t rnti, 
+                                               uint32_t nslot, 
+                                               uint32_t cell_id);
+
 SRSLTE_API int srslte_sequence_pdsch(srslte_sequence_t *seq, 
                                      uint16_t rnti, 
                                      int q,
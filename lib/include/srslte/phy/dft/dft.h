@@ -69,6 +69,9 @@ typedef struct SRSLTE_API {
   bool dc;            // Handle insertion/removal of null DC carrier internally?
   srslte_dft_dir_t dir;     // Forward/Backward
   srslte_dft_mode_t mode;   // Complex/Real
+  bool batch;         // Batched plan running on caller buffers?
+  int in_align;       // Alignment of the buffers used to create a batched plan
+  int out_align;
 }srslte_dft_plan_t;
 
 /* Create DFT plans */
@@ -86,6 +89,15 @@ SRSLTE_API int srslte_dft_plan_r(srslte_dft_plan_t *plan,
                                  int dft_points, 
                                  srslte_dft_dir_t dir);
 
+SRSLTE_API int srslte_dft_plan_batch_c(srslte_dft_plan_t *plan, 
+                                       int dft_points, 
+                                       srslte_dft_dir_t dir, 
+                                       int nof_dft, 
+                                       int in_dist, 
+                                       int out_dist, 
+                                       cf_t *in, 
+                                       cf_t *out);
+
 SRSLTE_API void srslte_dft_plan_free(srslte_dft_plan_t *plan);
 
 /* Set options */
@@ -116,6 +128,10 @@ SRSLTE_API void srslte_dft_run_c(srslte_dft_plan_t *plan,
                                  cf_t *in, 
                                  cf_t *out);
 
+SRSLTE_API int srslte_dft_run_batch_c(srslte_dft_plan_t *plan, 
+                                      cf_t *in, 
+                                      cf_t *out);
+
 SRSLTE_API void srslte_dft_run_r(srslte_dft_plan_t *plan, 
                                  float *in, 
                                  float *out);
@@ -40,12 +40,21 @@
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/dft/dft.h"
 
+/* Batched inverse plans kept for each number of PRB. A PUSCH transmission spans 2 numbers of 
+ * symbols (with and without the SRS symbol) */
+#define SRSLTE_DFT_PRECODING_NOF_BATCH 2
+
 /* DFT-based Transform Precoding object */
 typedef struct SRSLTE_API {
 
   uint32_t max_prb;  
   srslte_dft_plan_t dft_plan[SRSLTE_MAX_PRB+1];
   srslte_dft_plan_t idft_plan[SRSLTE_MAX_PRB+1];
+  
+  srslte_dft_plan_t idft_batch[SRSLTE_MAX_PRB+1][SRSLTE_DFT_PRECODING_NOF_BATCH];
+  uint32_t idft_batch_nsymb[SRSLTE_MAX_PRB+1][SRSLTE_DFT_PRECODING_NOF_BATCH]; // 0 if not created
+  cf_t *batch_in;   // Planning buffers of the batched plans
+  cf_t *batch_out; 
     
 }srslte_dft_precoding_t;
 
@@ -68,4 +77,10 @@ SRSLTE_API int srslte_dft_predecoding(srslte_dft_precoding_t *q,
                                       uint32_t nof_prb, 
                                       uint32_t nof_symbols);
 
+SRSLTE_API int srslte_dft_predecoding_batch(srslte_dft_precoding_t *q, 
+                                            cf_t *input, 
+                                            cf_t *output, 
+                                            uint32_t nof_prb, 
+                                            uint32_t nof_symbols);
+
 #endif
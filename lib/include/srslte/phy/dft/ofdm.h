@@ -57,6 +57,14 @@ typedef struct SRSLTE_API{
   
   bool freq_shift;
   cf_t *shift_buffer; 
+  
+  /* Subframe engine: all the symbols of a subframe in one batched transform */
+  bool sf_enabled;
+  srslte_dft_plan_t sf_plan;
+  uint32_t sf_nof_runs; // 1 if all the symbols are equally spaced, 2 if the plan covers a slot
+  cf_t *sf_buffer; // nof_symbols*2 transformed symbols, without CP
+  uint32_t cp0_len;
+  uint32_t cp_len;
 }srslte_ofdm_t;
 
 SRSLTE_API int srslte_ofdm_init_(srslte_ofdm_t *q, 
@@ -101,4 +109,7 @@ SRSLTE_API int srslte_ofdm_set_freq_shift(srslte_ofdm_t *q,
 SRSLTE_API void srslte_ofdm_set_normalize(srslte_ofdm_t *q, 
                                          bool normalize_enable); 
 
+SRSLTE_API void srslte_ofdm_set_sf_engine(srslte_ofdm_t *q, 
+                                          bool enable); 
+
 #endif
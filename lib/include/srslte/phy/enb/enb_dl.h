@@ -158,6 +158,14 @@ SRSLTE_API int srslte_enb_dl_put_pdsch(srslte_enb_dl_t *q,
                                        uint32_t sf_idx, 
                                        uint8_t *data); 
 
+SRSLTE_API int srslte_enb_dl_put_pdsch_iov(srslte_enb_dl_t *q, 
+                                           srslte_ra_dl_grant_t *grant, 
+                                           srslte_softbuffer_tx_t *softbuffer,
+                                           uint16_t rnti,
+                                           uint32_t rv_idx, 
+                                           uint32_t sf_idx, 
+                                           srslte_tb_iov_t *tb); 
+
 SRSLTE_API int srslte_enb_dl_put_pdcch_dl(srslte_enb_dl_t *q, 
                                           srslte_ra_dl_dci_t *grant, 
                                           srslte_dci_format_t format, 
@@ -86,8 +86,52 @@ typedef struct SRSLTE_API {
   // Configuration for each user
   srslte_enb_ul_user_t **users; 
   
+  // Multiple PUSCH receiver, one entry per grant (up to nof_prb)
+  srslte_pusch_cfg_t *batch_cfg; 
+  uint32_t           *batch_offset; 
+  float              *batch_noise; 
+  int                *batch_tb;     // Transport block of each grant in the decoding batch, or -1
+  cf_t               *batch_symbols; 
+  cf_t               *batch_ce; 
+  
+  // Joint PUCCH detector, 2 hypotheses per user
+  srslte_pucch_rx_t  *pucch_rx; 
+  uint32_t            max_pucch_rx; 
+  
 } srslte_enb_ul_t;
 
+/* PUSCH transmission received with srslte_enb_ul_get_pusch_multi() */
+typedef struct SRSLTE_API {
+  // Inputs
+  uint16_t                rnti; 
+  srslte_ra_ul_grant_t   *grant; 
+  srslte_softbuffer_rx_t *softbuffer; 
+  uint32_t                rv_idx; 
+  uint32_t                current_tx_nb; 
+  uint8_t                *data; 
+  srslte_uci_data_t      *uci_data; 
+  
+  // Outputs
+  int                     ret;           // Same as the return value of srslte_enb_ul_get_pusch()
+  float                   snr;           // Linear SNR of the DMRS
+  uint32_t                nof_iterations; 
+  uint32_t                n_prb_lowest;  // Lowest PRB in the first slot, after hopping
+} srslte_enb_ul_pusch_rx_t; 
+
+/* PUCCH reception of one user with srslte_enb_ul_get_pucch_multi() */
+typedef struct SRSLTE_API {
+  // Inputs
+  uint16_t                rnti; 
+  uint32_t                pdcch_n_cce; 
+  srslte_uci_data_t      *uci_data;    // Same as in srslte_enb_ul_get_pucch(), updated with the decoded UCI
+  
+  // Outputs
+  int                     ret;         // Same as the return value of srslte_enb_ul_get_pucch()
+  float                   corr; 
+  uint32_t                n_pucch; 
+  uint32_t                n_prb; 
+} srslte_enb_ul_pucch_rx_t; 
+
 typedef struct {
   uint16_t                rnti; 
   srslte_ra_ul_dci_t      grant;
@@ -130,6 +174,11 @@ SRSLTE_API int srslte_enb_ul_get_pucch(srslte_enb_ul_t *q,
                                        uint32_t sf_rx, 
                                        srslte_uci_data_t *uci_data); 
 
+SRSLTE_API int srslte_enb_ul_get_pucch_multi(srslte_enb_ul_t *q, 
+                                             srslte_enb_ul_pucch_rx_t *rx, 
+                                             uint32_t nof_rx, 
+                                             uint32_t sf_rx); 
+
 SRSLTE_API int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, 
                                        srslte_ra_ul_grant_t *grant, 
                                        srslte_softbuffer_rx_t *softbuffer,
@@ -140,6 +189,11 @@ SRSLTE_API int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q,
                                        srslte_uci_data_t *uci_data,
                                        uint32_t tti); 
 
+SRSLTE_API int srslte_enb_ul_get_pusch_multi(srslte_enb_ul_t *q, 
+                                             srslte_enb_ul_pusch_rx_t *rx, 
+                                             uint32_t nof_rx, 
+                                             uint32_t tti); 
+
 SRSLTE_API int srslte_enb_ul_detect_prach(srslte_enb_ul_t *q, 
                                           uint32_t tti, 
                                           uint32_t freq_offset, 
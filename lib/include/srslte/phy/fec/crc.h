@@ -39,6 +39,14 @@
 
 #include "srslte/config.h"
 #include <stdint.h>
+#include <stdbool.h>
+
+typedef enum SRSLTE_API {
+  SRSLTE_CRC_AUTO = 0,
+  SRSLTE_CRC_TABLE,
+  SRSLTE_CRC_SLICE8,
+  SRSLTE_CRC_PCLMUL,
+} srslte_crc_impl_t;
 
 typedef struct SRSLTE_API {
   uint64_t table[256];
@@ -48,6 +56,12 @@ typedef struct SRSLTE_API {
   uint64_t crcmask;
   uint64_t crchighbit;
   uint32_t srslte_crc_out;
+
+  // Slicing-by-8 tables and PCLMUL folding constants. Both work on the CRC
+  // register left-aligned to 32 bits, i.e. the polynomial multiplied by x^(32-order)
+  uint32_t table8[8][256];
+  uint64_t fold_k[4];
+  srslte_crc_impl_t impl;
 } srslte_crc_t;
 
 SRSLTE_API int srslte_crc_init(srslte_crc_t *h, 
@@ -73,4 +87,19 @@ SRSLTE_API uint32_t srslte_crc_checksum(srslte_crc_t *h,
                                         uint8_t *data, 
                                         int len);
 
+SRSLTE_API uint32_t srslte_crc_update_byte(srslte_crc_t *h, 
+                                           uint32_t crc, 
+                                           uint8_t *data, 
+                                           int nbytes); 
+
+SRSLTE_API uint32_t srslte_crc_final(srslte_crc_t *h, 
+                                     uint32_t crc); 
+
+SRSLTE_API int srslte_crc_set_impl(srslte_crc_t *h, 
+                                   srslte_crc_impl_t impl); 
+
+SRSLTE_API bool srslte_crc_impl_available(srslte_crc_impl_t impl); 
+
+SRSLTE_API const char* srslte_crc_impl_string(srslte_crc_impl_t impl); 
+
 #endif
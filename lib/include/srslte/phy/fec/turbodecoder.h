@@ -39,9 +39,12 @@
 #ifndef TURBODECODER_
 #define TURBODECODER_
 
+#include <stdbool.h>
+
 #include "srslte/config.h"
 #include "srslte/phy/fec/tc_interl.h"
 #include "srslte/phy/fec/cbsegm.h"
+#include "srslte/phy/fec/turbodecoder_batch.h"
 
 #define SRSLTE_TCOD_RATE 3
 #define SRSLTE_TCOD_TOTALTAIL 12
@@ -55,18 +58,42 @@
 #include "srslte/phy/fec/turbodecoder_sse.h"
 #endif
 
+#ifdef LV_HAVE_AVX2
+#include "srslte/phy/fec/turbodecoder_avx.h"
+#endif
+
+typedef enum SRSLTE_API {
+  SRSLTE_TDEC_AUTO = 0,
+  SRSLTE_TDEC_GEN,
+  SRSLTE_TDEC_SSE,
+  SRSLTE_TDEC_AVX2,
+  SRSLTE_TDEC_AVX512,
+} srslte_tdec_impl_t;
+
 typedef struct SRSLTE_API {
+  srslte_tdec_impl_t impl;
 #ifdef LV_HAVE_SSE
   srslte_tdec_sse_t tdec_sse;
 #else
   float *input_conv; 
   srslte_tdec_gen_t tdec_gen;
 #endif  
+#ifdef LV_HAVE_AVX2
+  srslte_tdec_avx_t tdec_avx;
+#endif
 } srslte_tdec_t;
 
 SRSLTE_API int srslte_tdec_init(srslte_tdec_t * h, 
                                 uint32_t max_long_cb);
 
+SRSLTE_API int srslte_tdec_init_impl(srslte_tdec_t * h, 
+                                     uint32_t max_long_cb, 
+                                     srslte_tdec_impl_t impl);
+
+SRSLTE_API bool srslte_tdec_impl_available(srslte_tdec_impl_t impl);
+
+SRSLTE_API const char* srslte_tdec_impl_string(srslte_tdec_impl_t impl);
+
 SRSLTE_API void srslte_tdec_free(srslte_tdec_t * h);
 
 SRSLTE_API int srslte_tdec_reset(srslte_tdec_t * h, uint32_t long_cb);
@@ -83,10 +110,23 @@ SRSLTE_API void srslte_tdec_decision_byte(srslte_tdec_t * h,
                                           uint8_t *output, 
                                           uint32_t long_cb); 
 
+SRSLTE_API uint32_t srslte_tdec_decision_crc(srslte_tdec_t * h, 
+                                             uint8_t *output, 
+                                             uint32_t long_cb, 
+                                             srslte_crc_t *crc, 
+                                             uint32_t len_crc, 
+                                             uint32_t *nof_changes); 
+
 SRSLTE_API int srslte_tdec_run_all(srslte_tdec_t * h, 
                                    int16_t * input, 
                                    uint8_t *output,
                                    uint32_t nof_iterations, 
                                    uint32_t long_cb);
 
+SRSLTE_API int srslte_tdec_run_batch(srslte_tdec_t * h, 
+                                     srslte_tdec_cb_t *cb, 
+                                     uint32_t nof_cb, 
+                                     uint32_t max_iterations, 
+                                     bool stop_on_error);
+
 #endif
@@ -0,0 +1,151 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/**********************************************************************************************
+ *  File:         turbodecoder_avx.h
+ *
+ *  Description:  Turbo Decoder.
+ *                MAX-LOG-MAP decoder with parallel sliding windows. The code block is split in
+ *                up to 2 (AVX2) or 4 (AVX-512) windows and each window runs its alpha/beta
+ *                recursion in one 128-bit lane of a 256-bit or 512-bit register, so 16 or 32
+ *                int16 state metrics are updated per instruction. Window boundaries are
+ *                initialized with the state metrics of the previous iteration. Code blocks too
+ *                short to be split fall back to the SSE decoder.
+ *                In batch mode, code blocks too short to fill all lanes with windows are decoded
+ *                one per lane instead. Shorter code blocks are aligned to the end of the longest
+ *                one and a lane is refilled with the next code block as soon as its CRC is correct.
+ *
+ *  Reference:    3GPP TS 36.212 version 10.0.0 Release 10 Sec. 5.1.3.2
+ *********************************************************************************************/
+
+#ifndef TURBODECODER_AVX_
+#define TURBODECODER_AVX_
+
+#include "srslte/config.h"
+#include "srslte/phy/fec/tc_interl.h"
+#include "srslte/phy/fec/cbsegm.h"
+#include "srslte/phy/fec/turbodecoder_sse.h"
+#include "srslte/phy/fec/turbodecoder_batch.h"
+
+/* Maximum number of windows (128-bit lanes) per register */
+#define SRSLTE_TDEC_AVX_MAX_WINDOWS   4
+
+/* Windows shorter than this degrade BER too much, the code block is split in fewer windows */
+#define SRSLTE_TDEC_AVX_MIN_WINLEN    256
+
+typedef struct SRSLTE_API {
+  int max_long_cb;
+  int16_t *alpha;
+  int16_t *branch;
+
+  /* Window boundary state metrics for each constituent decoder */
+  int16_t alpha_init[2][8*SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t beta_init[2][8*SRSLTE_TDEC_AVX_MAX_WINDOWS];
+
+  /* Code blocks with a single window run the SSE decoder on the same buffers */
+  map_gen_t sse;
+} map_avx_t;
+
+/* Code block decoded in one lane in batch mode */
+typedef struct SRSLTE_API {
+  int16_t *app1;
+  int16_t *app2;
+  int16_t *ext1;
+  int16_t *ext2;
+  int16_t *syst;
+  int16_t *parity0;
+  int16_t *parity1;
+
+  srslte_tdec_cb_t *cb;
+  int cbidx;
+  uint32_t n_iter;
+  uint32_t n_stall;
+  bool done;
+} srslte_tdec_avx_lane_t;
+
+typedef struct SRSLTE_API {
+  int max_long_cb;
+  uint32_t nof_lanes;
+  uint32_t nof_windows;
+
+  map_avx_t dec;
+
+  int16_t *app1;
+  int16_t *app2;
+  int16_t *ext1;
+  int16_t *ext2;
+  int16_t *syst;
+  int16_t *parity0;
+  int16_t *parity1;
+
+  int current_cbidx;
+  srslte_tc_interl_t interleaver[SRSLTE_NOF_TC_CB_SIZES];
+  int n_iter;
+
+  /* Batch mode */
+  srslte_tdec_avx_lane_t lane[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t *llr;
+} srslte_tdec_avx_t;
+
+SRSLTE_API int srslte_tdec_avx_init(srslte_tdec_avx_t * h,
+                                    uint32_t max_long_cb,
+                                    uint32_t nof_lanes);
+
+SRSLTE_API void srslte_tdec_avx_free(srslte_tdec_avx_t * h);
+
+SRSLTE_API int srslte_tdec_avx_reset(srslte_tdec_avx_t * h,
+                                     uint32_t long_cb);
+
+SRSLTE_API void srslte_tdec_avx_iteration(srslte_tdec_avx_t * h,
+                                          int16_t * input,
+                                          uint32_t long_cb);
+
+SRSLTE_API void srslte_tdec_avx_decision(srslte_tdec_avx_t * h,
+                                         uint8_t *output,
+                                         uint32_t long_cb);
+
+SRSLTE_API void srslte_tdec_avx_decision_byte(srslte_tdec_avx_t * h,
+                                              uint8_t *output,
+                                              uint32_t long_cb);
+
+SRSLTE_API uint32_t srslte_tdec_avx_decision_byte_diff(srslte_tdec_avx_t * h,
+                                                      uint8_t *output,
+                                                      uint32_t first,
+                                                      uint32_t nbytes);
+
+SRSLTE_API int srslte_tdec_avx_run_all(srslte_tdec_avx_t * h,
+                                       int16_t * input,
+                                       uint8_t *output,
+                                       uint32_t nof_iterations,
+                                       uint32_t long_cb);
+
+SRSLTE_API int srslte_tdec_avx_run_batch(srslte_tdec_avx_t * h,
+                                         srslte_tdec_cb_t *cb,
+                                         uint32_t nof_cb,
+                                         uint32_t max_iterations,
+                                         bool stop_on_error);
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/**********************************************************************************************
+ *  File:         turbodecoder_batch.h
+ *
+ *  Description:  Code block descriptor for batched turbo decoding. A batch collects the code
+ *                blocks of several transport blocks (possibly of different UEs) in one TTI so
+ *                that the decoder can run them in parallel SIMD lanes. Each code block carries
+ *                its own CRC check used for early stopping and returns its own status.
+ *
+ *  Reference:    3GPP TS 36.212 version 10.0.0 Release 10 Sec. 5.1.3.2
+ *********************************************************************************************/
+
+#ifndef TURBODECODER_BATCH_
+#define TURBODECODER_BATCH_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srslte/config.h"
+#include "srslte/phy/fec/crc.h"
+
+/* Maximum number of code blocks in a batch */
+#define SRSLTE_TDEC_MAX_BATCH   256
+
+/* Bytes decided before the CRC is updated over them, while they are still in L1. A 6144-bit code 
+ * block (768 bytes) is checked in 12 chunks */
+#define SRSLTE_TDEC_CRC_CHUNK   64
+
+/* Suggested stall limit for callers that opt in to stopping on stalled decisions: a code block whose 
+ * hard decisions did not change during this many consecutive iterations has likely converged to a 
+ * wrong codeword. Off by default since the BLER impact has not been measured */
+#define SRSLTE_TDEC_STALL_ITERATIONS 2
+
+typedef struct SRSLTE_API {
+  /* Inputs */
+  int16_t *input;       // Rate-unmatched LLRs (3*long_cb+12), 16-byte aligned
+  uint8_t *output;      // Decoded bits packed in bytes (long_cb/8)
+  uint32_t long_cb;
+  srslte_crc_t *crc;    // CRC checked after each iteration (NULL runs all iterations)
+  uint32_t len_crc;     // Number of bits covered by the CRC, including the CRC itself
+  uint32_t max_stall;   // Stop after this many iterations without decision changes (0 disables it)
+  uint32_t max_iterations; // Iteration cap of this code block, 0 uses the one of the batch
+  uint32_t tb_idx;      // Transport block of the code block, below SRSLTE_TDEC_MAX_BATCH
+
+  /* Outputs */
+  bool crc_ok;
+  uint32_t nof_iterations;
+  uint32_t nof_changes;   // Hard decisions that changed sign in the last iteration
+} srslte_tdec_cb_t;
+
+/* Sets bytes [first, first+nbytes) of output to the hard decisions held by h and returns the
+ * number of bits that changed */
+typedef uint32_t (*srslte_tdec_byte_diff_t)(void *h, uint8_t *output, uint32_t first, uint32_t nbytes);
+
+/* Hard decision and CRC check in one pass, shared by all decoder implementations */
+SRSLTE_API uint32_t srslte_tdec_decision_crc_chunks(srslte_tdec_byte_diff_t byte_diff,
+                                                    void *h,
+                                                    uint8_t *output,
+                                                    uint32_t long_cb,
+                                                    srslte_crc_t *crc,
+                                                    uint32_t len_crc,
+                                                    uint32_t *nof_changes);
+
+#endif
@@ -88,6 +88,11 @@ SRSLTE_API void srslte_tdec_gen_decision_byte(srslte_tdec_gen_t * h,
                                           uint8_t *output, 
                                           uint32_t long_cb); 
 
+SRSLTE_API uint32_t srslte_tdec_gen_decision_byte_diff(srslte_tdec_gen_t * h, 
+                                                      uint8_t *output, 
+                                                      uint32_t first, 
+                                                      uint32_t nbytes); 
+
 SRSLTE_API int srslte_tdec_gen_run_all(srslte_tdec_gen_t * h, 
                                    float * input, 
                                    uint8_t *output,
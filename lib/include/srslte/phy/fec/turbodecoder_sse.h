@@ -49,6 +49,11 @@
 #define SRSLTE_TCOD_MAX_LEN_CB     6144
 #define SRSLTE_TCOD_MAX_LEN_CODED  (SRSLTE_TCOD_RATE*SRSLTE_TCOD_MAX_LEN_CB+SRSLTE_TCOD_TOTALTAIL)
 
+/* Largest magnitudes of the soft bits and of the extrinsic information given to the int16 
+ * constituent decoders, so that their branch and state metrics never wrap around */
+#define SRSLTE_TDEC_SSE_INPUT_MAX  1024
+#define SRSLTE_TDEC_SSE_EXT_MAX    2048
+
 typedef struct SRSLTE_API {
   int max_long_cb;
   int16_t *alpha;
@@ -73,6 +78,22 @@ typedef struct SRSLTE_API {
   int n_iter;
 } srslte_tdec_sse_t;
 
+SRSLTE_API void srslte_tdec_sse_map_dec(map_gen_t * h, 
+                                        int16_t * input, 
+                                        int16_t *app, 
+                                        int16_t * parity, 
+                                        int16_t * output, 
+                                        uint32_t long_cb);
+
+SRSLTE_API void srslte_tdec_sse_normalize_input(int16_t *syst, 
+                                                int16_t *parity0, 
+                                                int16_t *parity1, 
+                                                int16_t *app2, 
+                                                uint32_t long_cb);
+
+SRSLTE_API void srslte_tdec_sse_scale_extrinsic(int16_t *ext, 
+                                                uint32_t long_cb);
+
 SRSLTE_API int srslte_tdec_sse_init(srslte_tdec_sse_t * h, 
                                 uint32_t max_long_cb);
 
@@ -92,6 +113,18 @@ SRSLTE_API void srslte_tdec_sse_decision_byte(srslte_tdec_sse_t * h,
                                           uint8_t *output, 
                                           uint32_t long_cb); 
 
+SRSLTE_API uint32_t srslte_tdec_sse_decision_byte_diff(srslte_tdec_sse_t * h, 
+                                                      uint8_t *output, 
+                                                      uint32_t first, 
+                                                      uint32_t nbytes); 
+
+SRSLTE_API void srslte_tdec_sse_deinterleave_input(int16_t *input, 
+                                                   int16_t *syst, 
+                                                   int16_t *parity0, 
+                                                   int16_t *parity1, 
+                                                   int16_t *app2, 
+                                                   uint32_t long_cb);
+
 SRSLTE_API int srslte_tdec_sse_run_all(srslte_tdec_sse_t * h, 
                                    int16_t * input, 
                                    uint8_t *output,
@@ -37,8 +37,11 @@
 #define VITERBI_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "srslte/config.h"
 
+/* Number of codewords decoded in parallel by the batched decoder */
+#define SRSLTE_VITERBI_MAX_BATCH 16
 
 
 typedef enum {
@@ -61,6 +64,11 @@ typedef struct SRSLTE_API{
   void (*free) (void*);
   uint8_t *tmp;
   uint8_t *symbols_uc;
+  void (*update_batch) (uint16_t*, uint8_t*, uint8_t*, uint32_t*, uint32_t);
+  uint8_t batch_branch[32];
+  uint8_t *batch_symbols;
+  uint32_t *batch_decisions;
+  float reject_threshold;
 }srslte_viterbi_t;
 
 SRSLTE_API int srslte_viterbi_init(srslte_viterbi_t *q, 
@@ -75,6 +83,9 @@ SRSLTE_API void srslte_viterbi_set_gain_quant(srslte_viterbi_t *q,
 SRSLTE_API void srslte_viterbi_set_gain_quant_s(srslte_viterbi_t *q, 
                                                 int16_t gain_quant); 
 
+SRSLTE_API void srslte_viterbi_set_reject_threshold(srslte_viterbi_t *q, 
+                                                   float threshold); 
+
 SRSLTE_API void srslte_viterbi_free(srslte_viterbi_t *q);
 
 SRSLTE_API int srslte_viterbi_decode_f(srslte_viterbi_t *q, 
@@ -93,6 +104,24 @@ SRSLTE_API int srslte_viterbi_decode_uc(srslte_viterbi_t *q,
                                         uint32_t frame_length);
 
 
+/* Batched decoding: runs nof_cw codewords of the same length through the trellis in parallel lanes. 
+ * Codewords whose best path metric exceeds the rejection threshold are not traced back and 
+ * return valid[i]=false. Returns the number of valid codewords or -1 on error. 
+ */
+SRSLTE_API int srslte_viterbi_decode_f_batch(srslte_viterbi_t *q, 
+                                             float **symbols, 
+                                             uint8_t **data, 
+                                             bool *valid, 
+                                             uint32_t nof_cw, 
+                                             uint32_t frame_length);
+
+SRSLTE_API int srslte_viterbi_decode_uc_batch(srslte_viterbi_t *q, 
+                                              uint8_t **symbols, 
+                                              uint8_t **data, 
+                                              bool *valid, 
+                                              uint32_t nof_cw, 
+                                              uint32_t frame_length);
+
 
 SRSLTE_API int srslte_viterbi_init_sse(srslte_viterbi_t *q, 
                                    srslte_viterbi_type_t type, 
@@ -62,13 +62,36 @@ SRSLTE_API int srslte_precoding_cdd(cf_t *x[SRSLTE_MAX_LAYERS],
                                     int nof_ports, 
                                     int nof_symbols);
 
+SRSLTE_API int srslte_precoding_multiplex(cf_t *x[SRSLTE_MAX_LAYERS], 
+                                          cf_t *y[SRSLTE_MAX_PORTS], 
+                                          int nof_layers, 
+                                          int nof_ports, 
+                                          uint32_t codebook_idx, 
+                                          int nof_symbols);
+
 SRSLTE_API int srslte_precoding_type(cf_t *x[SRSLTE_MAX_LAYERS], 
                                      cf_t *y[SRSLTE_MAX_PORTS], 
                                      int nof_layers,
                                      int nof_ports, 
+                                     uint32_t codebook_idx, 
                                      int nof_symbols, 
                                      srslte_mimo_type_t type);
 
+SRSLTE_API int srslte_precoding_codebook(int nof_ports, 
+                                         int nof_layers, 
+                                         uint32_t codebook_idx, 
+                                         cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]);
+
+SRSLTE_API int srslte_precoding_ri_pmi_select(cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                              int nof_rxant, 
+                                              int nof_ports, 
+                                              int max_layers, 
+                                              int nof_symbols, 
+                                              float noise_estimate, 
+                                              uint32_t *ri, 
+                                              uint32_t *pmi, 
+                                              float *capacity);
+
 /* Estimates the vector "x" based on the received signal "y" and the channel estimates "h"
  */
 SRSLTE_API int srslte_predecoding_single(cf_t *y, 
@@ -77,6 +100,13 @@ SRSLTE_API int srslte_predecoding_single(cf_t *y,
                                          int nof_symbols, 
                                          float noise_estimate);
 
+SRSLTE_API int srslte_predecoding_single_scale(cf_t *y, 
+                                               cf_t *h, 
+                                               cf_t *x, 
+                                               int nof_symbols, 
+                                               float noise_estimate, 
+                                               float scale);
+
 SRSLTE_API int srslte_predecoding_single_multi(cf_t *y[SRSLTE_MAX_PORTS], 
                                                cf_t *h[SRSLTE_MAX_PORTS], 
                                                cf_t *x, 
@@ -97,11 +127,33 @@ SRSLTE_API int srslte_predecoding_diversity_multi(cf_t *y[SRSLTE_MAX_PORTS],
                                                   int nof_ports, 
                                                   int nof_symbols);
 
+/* Spatial multiplexing receivers. The layers are estimated with the MMSE solution, or with ZF if 
+ * noise_estimate is 0.0 */
+SRSLTE_API int srslte_predecoding_multiplex_multi(cf_t *y[SRSLTE_MAX_PORTS], 
+                                                  cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                                  cf_t *x[SRSLTE_MAX_LAYERS],    
+                                                  int nof_rxant,
+                                                  int nof_ports, 
+                                                  int nof_layers, 
+                                                  uint32_t codebook_idx, 
+                                                  int nof_symbols, 
+                                                  float noise_estimate);
+
+SRSLTE_API int srslte_predecoding_cdd_multi(cf_t *y[SRSLTE_MAX_PORTS], 
+                                            cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                            cf_t *x[SRSLTE_MAX_LAYERS],    
+                                            int nof_rxant,
+                                            int nof_ports, 
+                                            int nof_layers, 
+                                            int nof_symbols, 
+                                            float noise_estimate);
+
 SRSLTE_API int srslte_predecoding_type(cf_t *y, 
                                        cf_t *h[SRSLTE_MAX_PORTS], 
                                        cf_t *x[SRSLTE_MAX_LAYERS],
                                        int nof_ports, 
                                        int nof_layers, 
+                                       uint32_t codebook_idx, 
                                        int nof_symbols, 
                                        srslte_mimo_type_t type, 
                                        float noise_estimate);
@@ -112,6 +164,7 @@ SRSLTE_API int srslte_predecoding_type_multi(cf_t *y[SRSLTE_MAX_PORTS],
                                              int nof_rxant,
                                              int nof_ports, 
                                              int nof_layers, 
+                                             uint32_t codebook_idx, 
                                              int nof_symbols, 
                                              srslte_mimo_type_t type, 
                                              float noise_estimate);
@@ -38,10 +38,17 @@
 
 #include <complex.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "srslte/config.h"
 #include "modem_table.h"
 
+typedef enum SRSLTE_API {
+  SRSLTE_DEMOD_SOFT_AUTO = 0,
+  SRSLTE_DEMOD_SOFT_GEN,
+  SRSLTE_DEMOD_SOFT_SSE,
+  SRSLTE_DEMOD_SOFT_AVX2,
+} srslte_demod_soft_impl_t;
 
 SRSLTE_API int srslte_demod_soft_demodulate(srslte_mod_t modulation, 
                                             const cf_t* symbols, 
@@ -53,4 +60,23 @@ SRSLTE_API int srslte_demod_soft_demodulate_s(srslte_mod_t modulation,
                                               short* llr, 
                                               int nsymbols); 
 
+/* Same as srslte_demod_soft_demodulate_s() with the LLRs multiplied by scale (e.g. derived from the 
+ * noise estimate) in the same pass. The int16 output saturates. */
+SRSLTE_API int srslte_demod_soft_demodulate_s_scale(srslte_mod_t modulation, 
+                                                    const cf_t* symbols, 
+                                                    short* llr, 
+                                                    int nsymbols, 
+                                                    float scale); 
+
+SRSLTE_API int srslte_demod_soft_demodulate_s_impl(srslte_mod_t modulation, 
+                                                   const cf_t* symbols, 
+                                                   short* llr, 
+                                                   int nsymbols, 
+                                                   float scale, 
+                                                   srslte_demod_soft_impl_t impl); 
+
+SRSLTE_API bool srslte_demod_soft_impl_available(srslte_demod_soft_impl_t impl);
+
+SRSLTE_API const char* srslte_demod_soft_impl_string(srslte_demod_soft_impl_t impl);
+
 #endif // DEMOD_SOFT_
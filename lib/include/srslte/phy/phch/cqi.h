@@ -45,6 +45,8 @@
 typedef struct {
   bool     configured; 
   uint32_t pmi_idx; 
+  bool     ri_idx_present; 
+  uint32_t ri_idx; 
   bool     simul_cqi_ack; 
   bool     format_is_subband; 
   uint32_t subband_size; 
@@ -74,10 +76,16 @@ typedef struct SRSLTE_API {
 /* Table 5.2.3.3.1-1: Fields for channel quality information feedback for wideband CQI reports
 (transmission mode 1, transmission mode 2, transmission mode 3, transmission mode 7 and
 transmission mode 8 configured without PMI/RI reporting). 
+With pmi_present, Table 5.2.3.3.1-2: Fields for PUCCH wideband reports with PMI (transmission mode 4). 
 This is for PUCCH Format 2 reports
 */
 typedef struct SRSLTE_API {
   uint8_t  wideband_cqi; // 4-bit width
+  bool     pmi_present; 
+  bool     four_antenna_ports; // If cell has 4 antenna ports
+  bool     rank_is_not_one; // If rank > 1
+  uint8_t  spatial_diff_cqi; // 3-bit width, only if rank_is_not_one
+  uint8_t  pmi; // 4-bit width with 4 ports, 2-bit width (rank 1) or 1-bit width (rank 2) with 2 ports
 } srslte_cqi_format2_wideband_t;
 
 typedef struct SRSLTE_API {
@@ -136,9 +144,25 @@ SRSLTE_API int srslte_cqi_format2_wideband_unpack(uint8_t buff[SRSLTE_CQI_MAX_BI
 SRSLTE_API int srslte_cqi_format2_subband_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], 
                                                  srslte_cqi_format2_subband_t *msg);
 
+SRSLTE_API int srslte_cqi_ri_pack(uint32_t ri, 
+                                  uint32_t max_layers, 
+                                  uint8_t buff[SRSLTE_CQI_MAX_BITS]);
+
+SRSLTE_API int srslte_cqi_ri_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], 
+                                    uint32_t max_layers, 
+                                    uint32_t *ri);
+
+SRSLTE_API uint32_t srslte_cqi_pmi_from_codebook(uint32_t nof_ports, 
+                                                 uint32_t nof_layers, 
+                                                 uint32_t codebook_idx); 
+
 SRSLTE_API bool srslte_cqi_send(uint32_t I_cqi_pmi, 
                                 uint32_t tti); 
 
+SRSLTE_API bool srslte_ri_send(uint32_t I_cqi_pmi, 
+                               uint32_t I_ri, 
+                               uint32_t tti); 
+
 SRSLTE_API uint8_t srslte_cqi_from_snr(float snr);
 
 SRSLTE_API float srslte_cqi_to_coderate(uint32_t cqi); 
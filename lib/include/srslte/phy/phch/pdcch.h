@@ -74,6 +74,7 @@ typedef struct SRSLTE_API {
   cf_t *d;
   uint8_t *e;
   float rm_f[3 * (SRSLTE_DCI_MAX_BITS + 16)];
+  float *rm_f_batch;
   float *llr;
 
   /* tx & rx objects */
@@ -133,6 +134,15 @@ SRSLTE_API int srslte_pdcch_decode_msg(srslte_pdcch_t *q,
                                        srslte_dci_format_t format,
                                        uint16_t *crc_rem);
 
+/* Same as calling srslte_pdcch_decode_msg() for each location, but all candidates go through 
+ * a single batched Viterbi pass. Candidates skipped or rejected by the decoder return crc_rem[i]=0 */
+SRSLTE_API int srslte_pdcch_decode_msg_batch(srslte_pdcch_t *q, 
+                                             srslte_dci_msg_t *msg, 
+                                             srslte_dci_location_t *locations,
+                                             uint32_t nof_locations,
+                                             srslte_dci_format_t format,
+                                             uint16_t *crc_rem);
+
 SRSLTE_API int srslte_pdcch_dci_decode(srslte_pdcch_t *q, 
                                  float *e, 
                                  uint8_t *data, 
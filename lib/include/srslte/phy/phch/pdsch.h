@@ -47,10 +47,20 @@
 #include "srslte/phy/phch/sch.h"
 #include "srslte/phy/phch/pdsch_cfg.h"
 
-typedef struct {
-  srslte_sequence_t seq[SRSLTE_NSUBFRAMES_X_FRAME];
-  bool sequence_generated;
-} srslte_pdsch_user_t;
+/* Number of first PDSCH symbols (0 to 4) and of subframe types (0, 5 and the rest) with a precomputed RE map */
+#define SRSLTE_PDSCH_NOF_LSTART        5
+#define SRSLTE_PDSCH_NOF_SF_TYPES      3
+
+#define SRSLTE_PDSCH_MAX_RE_SPANS      6
+#define SRSLTE_PDSCH_MAX_RE_PATTERNS   16
+
+/* PDSCH REs of one PRB in one OFDM symbol, as runs of contiguous subcarriers */
+typedef struct SRSLTE_API {
+  uint16_t mask; 
+  uint8_t  nof_spans; 
+  uint8_t  start[SRSLTE_PDSCH_MAX_RE_SPANS];
+  uint8_t  len[SRSLTE_PDSCH_MAX_RE_SPANS];
+} srslte_pdsch_re_pattern_t;
 
 /* PDSCH object */
 typedef struct SRSLTE_API {
@@ -65,17 +75,26 @@ typedef struct SRSLTE_API {
   cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
   cf_t *symbols[SRSLTE_MAX_PORTS];
   cf_t *x[SRSLTE_MAX_PORTS];
-  cf_t *d;
-  void *e;
+  cf_t *d[SRSLTE_MAX_CODEWORDS];
+  void *e[SRSLTE_MAX_CODEWORDS];
 
   /* tx & rx objects */
   srslte_modem_table_t mod[4];
   
-  // This is to generate the scrambling seq for multiple CRNTIs
-  srslte_pdsch_user_t **users;
-  
   srslte_sch_t dl_sch;
   
+  /* RI/PMI selected from the channel estimates of the last decoded subframe */
+  bool ri_pmi_enabled; 
+  uint32_t max_ri; 
+  uint32_t last_ri; 
+  uint32_t last_pmi; 
+  
+  /* Pattern of each PRB and OFDM symbol for each first PDSCH symbol and subframe type, precomputed 
+   * for the cell so that put/get only copy spans of contiguous REs */
+  srslte_pdsch_re_pattern_t re_patterns[SRSLTE_PDSCH_MAX_RE_PATTERNS];
+  uint32_t nof_re_patterns; 
+  uint8_t *re_map; 
+  
 } srslte_pdsch_t;
 
 SRSLTE_API int srslte_pdsch_init(srslte_pdsch_t *q, 
@@ -96,6 +115,28 @@ SRSLTE_API void srslte_pdsch_free_rnti(srslte_pdsch_t *q,
 SRSLTE_API float srslte_pdsch_coderate(uint32_t tbs, 
                                        uint32_t nof_re); 
 
+SRSLTE_API int srslte_pdsch_cp(srslte_pdsch_t *q, 
+                               cf_t *input, 
+                               cf_t *output, 
+                               srslte_ra_dl_grant_t *grant, 
+                               uint32_t lstart_grant, 
+                               uint32_t nsubframe, 
+                               bool put); 
+
+SRSLTE_API int srslte_pdsch_put(srslte_pdsch_t *q, 
+                                cf_t *symbols, 
+                                cf_t *sf_symbols,
+                                srslte_ra_dl_grant_t *grant, 
+                                uint32_t lstart, 
+                                uint32_t subframe); 
+
+SRSLTE_API int srslte_pdsch_get(srslte_pdsch_t *q, 
+                                cf_t *sf_symbols, 
+                                cf_t *symbols,
+                                srslte_ra_dl_grant_t *grant, 
+                                uint32_t lstart, 
+                                uint32_t subframe); 
+
 SRSLTE_API int srslte_pdsch_cfg(srslte_pdsch_cfg_t *cfg, 
                                 srslte_cell_t cell, 
                                 srslte_ra_dl_grant_t *grant, 
@@ -103,6 +144,19 @@ SRSLTE_API int srslte_pdsch_cfg(srslte_pdsch_cfg_t *cfg,
                                 uint32_t sf_idx, 
                                 uint32_t rvidx); 
 
+SRSLTE_API int srslte_pdsch_cfg_mimo(srslte_pdsch_cfg_t *cfg, 
+                                     srslte_cell_t cell, 
+                                     srslte_mimo_type_t mimo_type, 
+                                     uint32_t nof_layers, 
+                                     uint32_t codebook_idx, 
+                                     uint32_t rvidx2); 
+
+SRSLTE_API int srslte_pdsch_cfg_mimo_dci(srslte_pdsch_cfg_t *cfg, 
+                                         srslte_cell_t cell, 
+                                         srslte_dci_format_t format, 
+                                         srslte_ra_dl_dci_t *dci, 
+                                         uint32_t pmi); 
+
 SRSLTE_API int srslte_pdsch_encode(srslte_pdsch_t *q,
                                    srslte_pdsch_cfg_t *cfg,
                                    srslte_softbuffer_tx_t *softbuffer,
@@ -110,6 +164,27 @@ SRSLTE_API int srslte_pdsch_encode(srslte_pdsch_t *q,
                                    uint16_t rnti,
                                    cf_t *sf_symbols[SRSLTE_MAX_PORTS]);
 
+SRSLTE_API int srslte_pdsch_encode_multi(srslte_pdsch_t *q,
+                                         srslte_pdsch_cfg_t *cfg,
+                                         srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                                         uint8_t *data[SRSLTE_MAX_CODEWORDS], 
+                                         uint16_t rnti,
+                                         cf_t *sf_symbols[SRSLTE_MAX_PORTS]);
+
+SRSLTE_API int srslte_pdsch_encode_iov(srslte_pdsch_t *q,
+                                       srslte_pdsch_cfg_t *cfg,
+                                       srslte_softbuffer_tx_t *softbuffer,
+                                       srslte_tb_iov_t *tb, 
+                                       uint16_t rnti,
+                                       cf_t *sf_symbols[SRSLTE_MAX_PORTS]);
+
+SRSLTE_API int srslte_pdsch_encode_iov_multi(srslte_pdsch_t *q,
+                                             srslte_pdsch_cfg_t *cfg,
+                                             srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                                             srslte_tb_iov_t *tb[SRSLTE_MAX_CODEWORDS], 
+                                             uint16_t rnti,
+                                             cf_t *sf_symbols[SRSLTE_MAX_PORTS]);
+
 SRSLTE_API int srslte_pdsch_decode(srslte_pdsch_t *q, 
                                    srslte_pdsch_cfg_t *cfg, 
                                    srslte_softbuffer_rx_t *softbuffer,
@@ -128,6 +203,24 @@ SRSLTE_API int srslte_pdsch_decode_multi(srslte_pdsch_t *q,
                                          uint16_t rnti,
                                          uint8_t *data);
 
+SRSLTE_API int srslte_pdsch_decode_multi_cw(srslte_pdsch_t *q, 
+                                            srslte_pdsch_cfg_t *cfg, 
+                                            srslte_softbuffer_rx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                                            cf_t *sf_symbols[SRSLTE_MAX_PORTS], 
+                                            cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
+                                            float noise_estimate, 
+                                            uint16_t rnti,
+                                            uint8_t *data[SRSLTE_MAX_CODEWORDS], 
+                                            bool acks[SRSLTE_MAX_CODEWORDS]);
+
+SRSLTE_API void srslte_pdsch_set_ri_pmi_report(srslte_pdsch_t *q, 
+                                               bool enabled, 
+                                               uint32_t max_ri); 
+
+SRSLTE_API int srslte_pdsch_last_ri_pmi(srslte_pdsch_t *q, 
+                                        uint32_t *ri, 
+                                        uint32_t *pmi); 
+
 SRSLTE_API float srslte_pdsch_average_noi(srslte_pdsch_t *q); 
 
 SRSLTE_API uint32_t srslte_pdsch_last_noi(srslte_pdsch_t *q); 
@@ -45,6 +45,15 @@ typedef struct SRSLTE_API {
   srslte_ra_nbits_t nbits; 
   uint32_t rv; 
   uint32_t sf_idx;  
+  
+  /* MIMO configuration, set by srslte_pdsch_cfg_mimo(). The second codeword uses grant.mcs2 */
+  srslte_mimo_type_t mimo_type; 
+  uint32_t nof_layers; 
+  uint32_t codebook_idx; 
+  uint32_t nof_cw; 
+  srslte_cbsegm_t cb_segm2; 
+  srslte_ra_nbits_t nbits2; 
+  uint32_t rv2; 
 } srslte_pdsch_cfg_t;
 
 #endif
@@ -44,6 +44,23 @@
 #include "srslte/phy/common/phy_common.h"
 
 
+#define SRSLTE_PRACH_DEC_MAX_STAGES 8
+#define SRSLTE_PRACH_DEC_MAX_TAPS   32
+
+/* Decimation stage of the PRACH detection front-end. A symmetric lowpass FIR is evaluated every 
+ * factor samples, only its non-zero taps are stored (half of them are zero in decimation by 2). 
+ */
+typedef struct SRSLTE_API {
+  uint32_t factor;    // Decimation factor
+  uint32_t half_len;  // Taps at each side of the center
+  uint32_t nof_taps;  // Non-zero taps at each side of the center
+  uint32_t offset[SRSLTE_PRACH_DEC_MAX_TAPS];
+  float    tap[SRSLTE_PRACH_DEC_MAX_TAPS];
+  float    center; 
+  uint32_t input_len; 
+  cf_t    *input;     // Stage input with half_len samples of circular padding at each side
+} srslte_prach_dec_stage_t;
+
 /** Generation and detection of RACH signals for uplink.
  *  Currently only supports preamble formats 0-3.
  *  Does not currently support high speed flag.
@@ -78,7 +95,6 @@ typedef struct SRSLTE_API {
   cf_t *ifft_in;
   cf_t *ifft_out;
   cf_t *prach_bins;
-  cf_t *corr_spec;
   float *corr;
 
   // PRACH IFFT
@@ -96,6 +112,24 @@ typedef struct SRSLTE_API {
   float    peak_values[65];
   uint32_t peak_offsets[65];
   
+  // Decimating detection front-end: the PRACH band is shifted to baseband, filtered and 
+  // decimated before a N_dec point FFT
+  bool     dec_enabled; 
+  bool     dec_available; 
+  uint32_t N_dec; 
+  uint32_t dec_nof_stages; 
+  srslte_prach_dec_stage_t dec_stages[SRSLTE_PRACH_DEC_MAX_STAGES];
+  srslte_dft_plan_t *dec_fft;
+  cf_t    *dec_fft_in; 
+  cf_t    *dec_fft_out; 
+  cf_t    *dec_phasor;
+  int      dec_phasor_shift; 
+  
+  // Root correlations of all the roots transformed with a single batched IFFT
+  cf_t    *corr_specs; 
+  srslte_dft_plan_t corr_ifft; 
+  bool     corr_batch; 
+  
 } srslte_prach_t;
 
 typedef struct SRSLTE_API {
@@ -163,6 +197,9 @@ SRSLTE_API int srslte_prach_detect_offset(srslte_prach_t *p,
 SRSLTE_API void srslte_prach_set_detect_factor(srslte_prach_t *p, 
                                                float factor); 
 
+SRSLTE_API void srslte_prach_set_frontend(srslte_prach_t *p, 
+                                          bool enabled); 
+
 SRSLTE_API int srslte_prach_free(srslte_prach_t *p);
 
 SRSLTE_API int srslte_prach_print_seqs(srslte_prach_t *p);
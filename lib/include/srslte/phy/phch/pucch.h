@@ -38,6 +38,7 @@
 #include "srslte/config.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/common/sequence.h"
+#include "srslte/phy/dft/dft.h"
 #include "srslte/phy/modem/mod.h"
 #include "srslte/phy/phch/cqi.h"
 #include "srslte/phy/phch/uci.h"
@@ -84,6 +85,20 @@ typedef struct  {
   bool sequence_generated;
 } srslte_pucch_user_t; 
 
+/* PUCCH transmission expected in a subframe, see srslte_pucch_decode_multi() */
+typedef struct SRSLTE_API {
+  // Inputs
+  srslte_pucch_format_t format; 
+  uint32_t n_pucch;     // n_pucch_1 or n_pucch_2 depending on format
+  uint16_t rnti;        // Only used by formats 2, 2a and 2b
+  
+  // Outputs
+  int      ret;         // Same as the return value of srslte_pucch_decode()
+  float    corr; 
+  uint32_t n_prb;       // PRB of the first slot 
+  uint8_t  bits[SRSLTE_PUCCH_MAX_BITS]; // Format 2a/2b HARQ-ACK bits are at index 20 and 21
+} srslte_pucch_rx_t; 
+
 /* PUCCH object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -104,6 +119,11 @@ typedef struct SRSLTE_API {
   cf_t *z_tmp;
   cf_t *ce;
   
+  // Cyclic shift correlation of one PRB pair, one 12 point DFT per symbol 
+  srslte_dft_plan_t cs_plan; 
+  cf_t *cs_in; 
+  cf_t *cs_corr; 
+  
   bool shortened; 
   bool group_hopping_en;
 
@@ -159,6 +179,13 @@ SRSLTE_API int srslte_pucch_decode(srslte_pucch_t *q,
                                    float noise_estimate,
                                    uint8_t bits[SRSLTE_PUCCH_MAX_BITS]); 
 
+SRSLTE_API int srslte_pucch_decode_multi(srslte_pucch_t *q, 
+                                         srslte_pucch_rx_t *rx, 
+                                         uint32_t nof_rx, 
+                                         uint32_t sf_idx, 
+                                         cf_t *sf_symbols, 
+                                         float noise_estimate); 
+
 SRSLTE_API float srslte_pucch_alpha_format1(uint32_t n_cs_cell[SRSLTE_NSLOTS_X_FRAME][SRSLTE_CP_NORM_NSYMB], 
                                             srslte_pucch_cfg_t *cfg, 
                                             uint32_t n_pucch, 
@@ -60,11 +60,6 @@ typedef struct {
   uint32_t n_sb;
 } srslte_pusch_hopping_cfg_t;
 
-typedef struct {
-  srslte_sequence_t seq[SRSLTE_NSUBFRAMES_X_FRAME];
-  bool sequences_generated;
-} srslte_pusch_user_t; 
-
 /* PUSCH object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -85,10 +80,7 @@ typedef struct SRSLTE_API {
   /* tx & rx objects */
   srslte_modem_table_t mod[4];
   srslte_sequence_t seq_type2_fo; 
-  
-  // This is to generate the scrambling seq for multiple CRNTIs
-  srslte_pusch_user_t **users;
-  srslte_sequence_t tmp_seq;
+  uint8_t *seq_bytes;
 
   srslte_sch_t ul_sch;
   bool shortened;
@@ -135,6 +127,16 @@ SRSLTE_API int srslte_pusch_decode(srslte_pusch_t *q,
                                    uint8_t *data, 
                                    srslte_uci_data_t *uci_data);
 
+SRSLTE_API int srslte_pusch_decode_symbols(srslte_pusch_t *q, 
+                                           srslte_pusch_cfg_t *cfg,
+                                           srslte_softbuffer_rx_t *softbuffer,
+                                           cf_t *symbols, 
+                                           cf_t *ce,
+                                           float noise_estimate, 
+                                           uint16_t rnti,
+                                           uint8_t *data, 
+                                           srslte_uci_data_t *uci_data);
+
 SRSLTE_API float srslte_pusch_average_noi(srslte_pusch_t *q); 
 
 SRSLTE_API uint32_t srslte_pusch_last_noi(srslte_pusch_t *q); 
@@ -35,6 +35,10 @@
 #ifndef SCH_
 #define SCH_
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
 #include "srslte/config.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/fec/rm_turbo.h"
@@ -53,10 +57,91 @@
 #define SRSLTE_TX_NULL 100
 #endif
 
+/* Default SINR margin of the adaptive iteration policy, in dB */
+#define SRSLTE_SCH_ADAPT_DEFAULT_MARGIN_DB  3.0
+
+/* Maximum number of helper threads decoding code blocks of the same transport block */
+#define SRSLTE_SCH_MAX_DEC_THREADS  8
+
+/* Maximum number of code blocks tracked in the CB CRC bitmap */
+#define SRSLTE_SCH_MAX_CB           64
+
+/* Maximum number of transport blocks decoded in one batch */
+#define SRSLTE_SCH_MAX_BATCH_TB     32
+
+/* Maximum number of segments of a scattered transport block */
+#define SRSLTE_TB_IOV_MAX_SEGMENTS  64
+
+/* Transport block made of the concatenation of nof_segments byte segments, e.g. MAC headers 
+ * and the SDU slices they describe. The encoder gathers the segments into the code blocks 
+ * while computing the transport block CRC, so the TB never needs to be contiguous */
+typedef struct SRSLTE_API {
+  uint8_t  *ptr[SRSLTE_TB_IOV_MAX_SEGMENTS];
+  uint32_t  len[SRSLTE_TB_IOV_MAX_SEGMENTS];
+  uint32_t  nof_segments;
+} srslte_tb_iov_t;
+
+/* Counters of the adaptive iteration policy, accumulated since the last reset */
+typedef struct SRSLTE_API {
+  uint64_t nof_cb;                  // Code blocks scheduled for decoding
+  uint64_t nof_iterations;          // Turbo iterations spent on them
+  uint64_t nof_cb_capped_sinr;      // Code blocks limited to min_iterations because of low SINR
+  uint64_t nof_cb_capped_deadline;  // Code blocks given fewer iterations to meet the deadline
+  uint64_t nof_cb_abandoned;        // Code blocks not decoded because the deadline had passed
+} srslte_sch_adapt_stats_t;
+
+/* Time source of the deadline and of the decoding cost measurement, CLOCK_MONOTONIC by default */
+typedef void (*srslte_sch_clock_t)(struct timespec *now);
+
+/* Adaptive maximum number of turbo iterations per code block. Code blocks whose SINR is far below 
+ * what the code rate requires get min_iterations, and when a deadline is set the iterations are 
+ * limited to what fits in the remaining time, using the decoding cost measured on previous 
+ * transport blocks */
+typedef struct SRSLTE_API {
+  bool enabled;
+  uint32_t min_iterations;
+  float sinr_margin_db;
+  float sinr_db;
+  bool has_deadline;
+  struct timespec deadline;
+  srslte_sch_clock_t clock;
+  float usec_per_kbit;              // Measured cost of one iteration over 1000 bits
+  srslte_sch_adapt_stats_t stats;
+} srslte_sch_adapt_t;
+
+/* Read/write parameters of a code block inside the transport block */
+typedef struct SRSLTE_API {
+  uint32_t cb_len;
+  uint32_t cblen_idx;
+  uint32_t rlen;
+  uint32_t n_e;
+  uint32_t rp;
+  uint32_t wp;
+} srslte_sch_cb_t;
+
+/* Transport block whose code blocks wait in the decoding batch */
+typedef struct SRSLTE_API {
+  srslte_cbsegm_t cb_segm;
+  uint8_t *data;
+  uint32_t first_cb;
+} srslte_sch_batch_tb_t;
+
+/* Helper thread with its own turbo decoder. CRC objects keep state while computing the checksum
+ * so each thread has its own copy */
+typedef struct SRSLTE_API {
+  srslte_tdec_t decoder;
+  srslte_crc_t crc_tb;
+  srslte_crc_t crc_cb;
+  uint8_t *cb_in;
+  pthread_t thread;
+  void *sch;
+} srslte_sch_dec_worker_t;
+
 /* DL-SCH AND UL-SCH common functions */
 typedef struct SRSLTE_API {
   
   uint32_t max_iterations; 
+  uint32_t max_stall; 
   uint32_t nof_iterations; 
   float average_nof_iterations; 
   
@@ -75,6 +160,46 @@ typedef struct SRSLTE_API {
   srslte_crc_t crc_cb;
   
   srslte_uci_cqi_pusch_t uci_cqi;
+
+  /* Inter-code-block parallel decoding */
+  uint32_t nof_dec_threads;
+  srslte_sch_dec_worker_t dec_workers[SRSLTE_SCH_MAX_DEC_THREADS];
+  pthread_mutex_t dec_mutex;
+  pthread_cond_t dec_cvar_start;
+  pthread_cond_t dec_cvar_done;
+  bool dec_exit;
+  uint32_t dec_generation;
+  uint32_t dec_pending;
+  uint32_t dec_next_cb;
+  bool dec_cancel;
+
+  /* Current transport block being decoded in parallel */
+  srslte_softbuffer_rx_t *dec_softbuffer;
+  int16_t *dec_e_bits;
+  uint8_t *dec_data;
+  uint32_t dec_rv;
+  srslte_cbsegm_t *dec_cb_segm;
+  srslte_sch_cb_t dec_cb[SRSLTE_SCH_MAX_CB];
+  uint32_t dec_cb_iterations[SRSLTE_SCH_MAX_CB];
+  uint8_t dec_parity[3];
+
+  /* Code blocks decoded as one batch: those of the current transport block or, between 
+   * srslte_sch_batch_start() and srslte_sch_batch_run(), those of several transport blocks */
+  bool batch_enabled;
+  int batch_ret;
+  uint32_t batch_nof_cb;
+  uint32_t batch_nof_tb;
+  srslte_tdec_cb_t dec_batch[SRSLTE_TDEC_MAX_BATCH];
+  srslte_sch_cb_t batch_cb[SRSLTE_TDEC_MAX_BATCH];
+  srslte_sch_batch_tb_t batch_tb[SRSLTE_SCH_MAX_BATCH_TB];
+  uint8_t *dec_batch_out;
+
+  /* Bit i is set if the CRC of code block i was correct in the last decoded transport block */
+  uint64_t cb_crc;
+
+  /* Adaptive iteration policy and, for the current transport block, cap due to the SINR */
+  srslte_sch_adapt_t adapt;
+  uint32_t dec_max_iterations;
   
 } srslte_sch_t;
 
@@ -86,10 +211,60 @@ SRSLTE_API void srslte_sch_free(srslte_sch_t *q);
 SRSLTE_API void srslte_sch_set_max_noi(srslte_sch_t *q, 
                                        uint32_t max_iterations); 
 
+SRSLTE_API void srslte_sch_set_stall_iterations(srslte_sch_t *q, 
+                                               uint32_t max_stall); 
+
+SRSLTE_API void srslte_sch_set_adaptive_noi(srslte_sch_t *q, 
+                                            bool enabled, 
+                                            uint32_t min_iterations, 
+                                            float sinr_margin_db); 
+
+SRSLTE_API void srslte_sch_set_sinr(srslte_sch_t *q, 
+                                    float sinr_db); 
+
+SRSLTE_API void srslte_sch_set_snr(srslte_sch_t *q, 
+                                   float snr); 
+
+SRSLTE_API void srslte_sch_set_deadline(srslte_sch_t *q, 
+                                        struct timespec *deadline); 
+
+SRSLTE_API void srslte_sch_set_adaptive_clock(srslte_sch_t *q, 
+                                              srslte_sch_clock_t clock); 
+
+SRSLTE_API void srslte_sch_adaptive_stats(srslte_sch_t *q, 
+                                          srslte_sch_adapt_stats_t *stats); 
+
+SRSLTE_API void srslte_sch_reset_adaptive_stats(srslte_sch_t *q); 
+
 SRSLTE_API float srslte_sch_average_noi(srslte_sch_t *q);
 
 SRSLTE_API uint32_t srslte_sch_last_noi(srslte_sch_t *q);
 
+SRSLTE_API int srslte_sch_set_decoder_threads(srslte_sch_t *q,
+                                              uint32_t nof_threads);
+
+SRSLTE_API uint64_t srslte_sch_last_cb_crc(srslte_sch_t *q);
+
+SRSLTE_API void srslte_sch_batch_start(srslte_sch_t *q);
+
+SRSLTE_API uint32_t srslte_sch_batch_nof_tb(srslte_sch_t *q);
+
+SRSLTE_API int srslte_sch_batch_run(srslte_sch_t *q);
+
+SRSLTE_API int srslte_sch_batch_result(srslte_sch_t *q, 
+                                       uint32_t tb_idx);
+
+SRSLTE_API void srslte_tb_iov_reset(srslte_tb_iov_t *tb);
+
+SRSLTE_API int srslte_tb_iov_add(srslte_tb_iov_t *tb, 
+                                 uint8_t *ptr, 
+                                 uint32_t len);
+
+SRSLTE_API uint32_t srslte_tb_iov_len(srslte_tb_iov_t *tb);
+
+SRSLTE_API void srslte_tb_iov_gather(srslte_tb_iov_t *tb, 
+                                     uint8_t *data);
+
 SRSLTE_API int srslte_dlsch_encode(srslte_sch_t *q, 
                                    srslte_pdsch_cfg_t *cfg,
                                    srslte_softbuffer_tx_t *softbuffer,
@@ -102,6 +277,27 @@ SRSLTE_API int srslte_dlsch_decode(srslte_sch_t *q,
                                    int16_t *e_bits, 
                                    uint8_t *data);
 
+SRSLTE_API int srslte_dlsch_encode_cw(srslte_sch_t *q, 
+                                      srslte_pdsch_cfg_t *cfg,
+                                      srslte_softbuffer_tx_t *softbuffer,
+                                      uint8_t *data, 
+                                      uint8_t *e_bits, 
+                                      uint32_t cw_idx);
+
+SRSLTE_API int srslte_dlsch_encode_iov(srslte_sch_t *q, 
+                                       srslte_pdsch_cfg_t *cfg,
+                                       srslte_softbuffer_tx_t *softbuffer,
+                                       srslte_tb_iov_t *tb, 
+                                       uint8_t *e_bits, 
+                                       uint32_t cw_idx);
+
+SRSLTE_API int srslte_dlsch_decode_cw(srslte_sch_t *q, 
+                                      srslte_pdsch_cfg_t *cfg,
+                                      srslte_softbuffer_rx_t *softbuffer,
+                                      int16_t *e_bits, 
+                                      uint8_t *data, 
+                                      uint32_t cw_idx);
+
 SRSLTE_API int srslte_ulsch_encode(srslte_sch_t *q, 
                                    srslte_pusch_cfg_t *cfg,
                                    srslte_softbuffer_tx_t *softbuffer,
@@ -136,7 +332,7 @@ SRSLTE_API int srslte_ulsch_uci_decode_ri_ack(srslte_sch_t *q,
                                               srslte_pusch_cfg_t *cfg, 
                                               srslte_softbuffer_rx_t *softbuffer,
                                               int16_t *q_bits, 
-                                              uint8_t *c_seq,
+                                              uint8_t *c_bytes,
                                               srslte_uci_data_t *uci_data); 
 
 SRSLTE_API float srslte_sch_beta_cqi(uint32_t I_cqi); 
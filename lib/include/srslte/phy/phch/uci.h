@@ -125,7 +125,7 @@ SRSLTE_API int srslte_uci_encode_ack(srslte_pusch_cfg_t *cfg,
 
 SRSLTE_API int srslte_uci_decode_ack(srslte_pusch_cfg_t *cfg,
                                      int16_t *q_bits,
-                                     uint8_t *c_seq, 
+                                     uint8_t *c_bytes, 
                                      float beta, 
                                      uint32_t H_prime_total, 
                                      uint32_t O_cqi,
@@ -141,7 +141,7 @@ SRSLTE_API int srslte_uci_encode_ri(srslte_pusch_cfg_t *cfg,
 
 SRSLTE_API int srslte_uci_decode_ri(srslte_pusch_cfg_t *cfg,
                                     int16_t *q_bits, 
-                                    uint8_t *c_seq, 
+                                    uint8_t *c_bytes, 
                                     float beta, 
                                     uint32_t H_prime_total, 
                                     uint32_t O_cqi, 
@@ -76,4 +76,19 @@ SRSLTE_API void srslte_scrambling_c_offset(srslte_sequence_t *s,
                                            int offset, 
                                            int len);
 
+/* The functions below generate the sequence of the given seed (cinit) while scrambling, 
+ * so no srslte_sequence_t needs to be stored */
+SRSLTE_API void srslte_scrambling_bytes_seed(uint32_t seed, 
+                                             uint8_t *data, 
+                                             int len); 
+
+SRSLTE_API void srslte_scrambling_s_seed(uint32_t seed, 
+                                         short *data, 
+                                         int len); 
+
+/* Scrambles LLRs with a sequence packed in bytes (see srslte_sequence_LTE_pr_bytes()) */
+SRSLTE_API void srslte_scrambling_s_bytes(uint8_t *c_bytes, 
+                                          short *data, 
+                                          int len); 
+
 #endif // SCRAMBLING_
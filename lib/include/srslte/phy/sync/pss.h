@@ -120,6 +120,12 @@ SRSLTE_API void srslte_pss_synch_free(srslte_pss_synch_t *q);
 
 SRSLTE_API void srslte_pss_synch_reset(srslte_pss_synch_t *q); 
 
+SRSLTE_API int srslte_pss_synch_init_N_id_2(cf_t *pss_signal_freq, 
+                                            cf_t *pss_signal_time,
+                                            uint32_t N_id_2, 
+                                            uint32_t fft_size, 
+                                            int cfo_i);
+
 SRSLTE_API int srslte_pss_generate(cf_t *signal, 
                                    uint32_t N_id_2);
 
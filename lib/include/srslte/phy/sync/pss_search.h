@@ -0,0 +1,98 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         pss_search.h
+ *
+ *  Description:  Streaming PSS search for UE cell search.
+ *
+ *                The srslte_pss_search_t object correlates the input against
+ *                the three PSS sequences using overlap-save FFT convolution.
+ *                Each input block is transformed once and the spectrum is
+ *                shared by the three N_id_2 correlators. The correlation
+ *                power is accumulated per position modulo the PSS period
+ *                (5 ms), so samples can be pushed in chunks of any size and
+ *                the peak statistics improve with every period received.
+ *
+ *  Reference:    3GPP TS 36.211 version 10.0.0 Release 10 Sec. 6.11.1
+ *****************************************************************************/
+
+#ifndef PSS_SEARCH_
+#define PSS_SEARCH_
+
+#include <stdint.h>
+
+#include "srslte/config.h"
+#include "srslte/phy/common/phy_common.h"
+#include "srslte/phy/dft/dft.h"
+
+#define SRSLTE_PSS_SEARCH_BLOCK_FACTOR  8   // Block FFT size in multiples of the OFDM symbol size
+
+typedef struct SRSLTE_API {
+  uint32_t fft_size;
+  uint32_t period;
+  uint32_t block_size;              // FFT size of each overlap-save block
+  uint32_t block_step;              // New samples consumed by each block
+
+  srslte_dft_plan_t dftp_fwd;
+  srslte_dft_plan_t dftp_bwd;
+
+  cf_t *pss_freq[3];                // Conjugate spectrum of each PSS, scaled by 1/block_size
+  cf_t *block;                      // History followed by the new samples
+  cf_t *block_freq;
+  cf_t *corr_freq;
+  cf_t *corr;
+  float *corr_pow;
+  float *acc[3];                    // Accumulated correlation power modulo the period
+
+  uint32_t block_fill;              // Samples stored in block beyond the history
+  uint64_t nof_samples;             // Stream position of the first new sample in block
+  uint32_t peak_pos[3];
+  float peak_value[3];
+} srslte_pss_search_t;
+
+SRSLTE_API int srslte_pss_search_init(srslte_pss_search_t *q,
+                                      uint32_t fft_size,
+                                      uint32_t period);
+
+SRSLTE_API void srslte_pss_search_free(srslte_pss_search_t *q);
+
+SRSLTE_API void srslte_pss_search_reset(srslte_pss_search_t *q);
+
+SRSLTE_API int srslte_pss_search_run(srslte_pss_search_t *q,
+                                     cf_t *input,
+                                     uint32_t nof_samples);
+
+SRSLTE_API uint32_t srslte_pss_search_nof_periods(srslte_pss_search_t *q);
+
+SRSLTE_API int srslte_pss_search_result(srslte_pss_search_t *q,
+                                        uint32_t N_id_2,
+                                        uint32_t *peak_pos,
+                                        float *peak_value,
+                                        float *psr);
+
+#endif // PSS_SEARCH_
+
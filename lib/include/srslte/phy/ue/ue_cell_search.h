@@ -49,6 +49,7 @@
 #include "srslte/phy/ue/ue_sync.h"
 #include "srslte/phy/ue/ue_mib.h"
 #include "srslte/phy/sync/cfo.h"
+#include "srslte/phy/sync/pss_search.h"
 #include "srslte/phy/ch_estimation/chest_dl.h"
 #include "srslte/phy/phch/pbch.h"
 #include "srslte/phy/dft/ofdm.h"
@@ -56,6 +57,8 @@
 #define SRSLTE_CS_NOF_PRB      6
 #define SRSLTE_CS_SAMP_FREQ    1920000.0
 
+#define SRSLTE_CS_PSS_SEARCH_THRESHOLD 1.5   // Default minimum accumulated PSR to scan an N_id_2. 0 scans all of them
+
 typedef struct SRSLTE_API {
   uint32_t cell_id;
   srslte_cp_t cp; 
@@ -74,6 +77,9 @@ typedef struct SRSLTE_API {
   
   uint32_t max_frames;
   uint32_t nof_valid_frames;  // number of 5 ms frames to scan 
+  
+  srslte_pss_search_t pss_search; 
+  float pss_search_threshold; 
     
   uint32_t *mode_ntimes;
   uint8_t *mode_counted; 
@@ -105,6 +111,9 @@ SRSLTE_API int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t * q,
 SRSLTE_API int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t *q, 
                                                          uint32_t nof_frames);
 
+SRSLTE_API void srslte_ue_cellsearch_set_pss_search_threshold(srslte_ue_cellsearch_t *q, 
+                                                              float threshold);
+
 
 
 
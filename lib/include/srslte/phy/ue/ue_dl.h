@@ -89,6 +89,7 @@ typedef struct SRSLTE_API {
   srslte_cell_t cell;
 
   uint32_t nof_rx_antennas;
+  uint32_t tm; 
   
   cf_t *sf_symbols;  // this is for backwards compatibility
   cf_t *sf_symbols_m[SRSLTE_MAX_PORTS]; 
@@ -142,6 +143,10 @@ SRSLTE_API int srslte_ue_dl_cfg_grant(srslte_ue_dl_t *q,
                                       uint32_t sf_idx, 
                                       uint32_t rvidx); 
 
+SRSLTE_API int srslte_ue_dl_cfg_grant_mimo(srslte_ue_dl_t *q, 
+                                           srslte_dci_format_t format, 
+                                           srslte_ra_dl_dci_t *dci); 
+
 SRSLTE_API int srslte_ue_dl_find_ul_dci(srslte_ue_dl_t *q, 
                                         uint32_t cfi, 
                                         uint32_t sf_idx, 
@@ -166,6 +171,9 @@ SRSLTE_API uint32_t srslte_ue_dl_get_ncce(srslte_ue_dl_t *q);
 SRSLTE_API void srslte_ue_dl_set_sample_offset(srslte_ue_dl_t * q, 
                                                float sample_offset); 
 
+SRSLTE_API int srslte_ue_dl_set_tm(srslte_ue_dl_t *q, 
+                                   uint32_t tm); 
+
 SRSLTE_API int srslte_ue_dl_decode(srslte_ue_dl_t * q, 
                                    cf_t *input, 
                                    uint8_t *data,
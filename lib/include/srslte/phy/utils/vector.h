@@ -41,6 +41,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "srslte/config.h"
 
 
@@ -53,6 +54,27 @@ extern "C" {
 // Exponential moving average
 #define SRSLTE_VEC_EMA(data, average, alpha) ((alpha)*(data)+(1-alpha)*(average))
 
+/* Instruction sets the vector kernels can run with. The best one supported by the CPU 
+ * is selected at startup using CPUID. 
+ */
+typedef enum SRSLTE_API {
+  SRSLTE_VEC_ISA_GENERIC = 0, 
+  SRSLTE_VEC_ISA_SSE,
+  SRSLTE_VEC_ISA_AVX2,
+  SRSLTE_VEC_ISA_AVX512,
+  SRSLTE_VEC_NOF_ISA
+} srslte_vec_isa_t; 
+
+/* Returns true if the kernels for isa were built and the CPU supports them */
+SRSLTE_API bool srslte_vec_isa_supported(srslte_vec_isa_t isa);
+
+/* Forces the kernels of a given instruction set. Must not be called while other threads use the vector functions */
+SRSLTE_API int srslte_vec_set_isa(srslte_vec_isa_t isa);
+
+SRSLTE_API srslte_vec_isa_t srslte_vec_get_isa();
+
+SRSLTE_API const char *srslte_vec_isa_string(srslte_vec_isa_t isa);
+
 /** Return the sum of all the elements */
 SRSLTE_API int srslte_vec_acc_ii(int *x, uint32_t len);
 SRSLTE_API float srslte_vec_acc_ff(float *x, uint32_t len);
@@ -75,6 +75,74 @@ SRSLTE_API void srslte_vec_convert_fi_sse(float *x, int16_t *z, float scale, uin
 
 
 SRSLTE_API void srslte_vec_mult_scalar_cf_f_avx( cf_t *z,const cf_t *x,const float h,const uint32_t len);
+
+/* Portable implementations of the kernels selected at runtime by srslte_vec_set_isa() */
+SRSLTE_API float srslte_vec_acc_ff_gen(float *x, uint32_t len);
+SRSLTE_API cf_t srslte_vec_acc_cc_gen(cf_t *x, uint32_t len);
+SRSLTE_API void srslte_vec_sum_fff_gen(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sub_fff_gen(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sum_sss_gen(short *x, short *y, short *z, uint32_t len);
+SRSLTE_API void srslte_vec_sub_sss_gen(short *x, short *y, short *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_sss_gen(short *x, short *y, short *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_div2_sss_gen(short *x, int n_rightshift, short *z, uint32_t len);
+SRSLTE_API int32_t srslte_vec_dot_prod_sss_gen(int16_t *x, int16_t *y, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_fff_gen(float *x, float h, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_cfc_gen(cf_t *x, float h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_ccc_gen(cf_t *x, cf_t h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_convert_fi_gen(float *x, int16_t *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_convert_if_gen(int16_t *x, float *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_prod_fff_gen(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_cfc_gen(cf_t *x, float *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_ccc_gen(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_conj_ccc_gen(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_ccc_gen(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_cfc_gen(cf_t *x, float *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_conj_ccc_gen(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API float srslte_vec_dot_prod_fff_gen(float *x, float *y, uint32_t len);
+SRSLTE_API void srslte_vec_abs_cf_gen(cf_t *x, float *abs, uint32_t len);
+SRSLTE_API void srslte_vec_abs_square_cf_gen(cf_t *x, float *abs_square, uint32_t len);
+
+/* AVX2+FMA kernels, only built if the compiler supports them. Do not call them on CPUs without AVX2 */
+SRSLTE_API float srslte_vec_acc_ff_avx2(float *x, uint32_t len);
+SRSLTE_API cf_t srslte_vec_acc_cc_avx2(cf_t *x, uint32_t len);
+SRSLTE_API void srslte_vec_sum_fff_avx2(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sub_fff_avx2(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_fff_avx2(float *x, float h, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_cfc_avx2(cf_t *x, float h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_ccc_avx2(cf_t *x, cf_t h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_convert_fi_avx2(float *x, int16_t *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_convert_if_avx2(int16_t *x, float *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_prod_fff_avx2(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_cfc_avx2(cf_t *x, float *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_ccc_avx2(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_conj_ccc_avx2(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_ccc_avx2(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_cfc_avx2(cf_t *x, float *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_conj_ccc_avx2(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API float srslte_vec_dot_prod_fff_avx2(float *x, float *y, uint32_t len);
+SRSLTE_API void srslte_vec_abs_cf_avx2(cf_t *x, float *abs, uint32_t len);
+SRSLTE_API void srslte_vec_abs_square_cf_avx2(cf_t *x, float *abs_square, uint32_t len);
+
+/* AVX-512F kernels, only built if the compiler supports them. Do not call them on CPUs without AVX-512F */
+SRSLTE_API float srslte_vec_acc_ff_avx512(float *x, uint32_t len);
+SRSLTE_API cf_t srslte_vec_acc_cc_avx512(cf_t *x, uint32_t len);
+SRSLTE_API void srslte_vec_sum_fff_avx512(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sub_fff_avx512(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_fff_avx512(float *x, float h, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_cfc_avx512(cf_t *x, float h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_sc_prod_ccc_avx512(cf_t *x, cf_t h, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_convert_fi_avx512(float *x, int16_t *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_convert_if_avx512(int16_t *x, float *z, float scale, uint32_t len);
+SRSLTE_API void srslte_vec_prod_fff_avx512(float *x, float *y, float *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_cfc_avx512(cf_t *x, float *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_ccc_avx512(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API void srslte_vec_prod_conj_ccc_avx512(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_ccc_avx512(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_cfc_avx512(cf_t *x, float *y, uint32_t len);
+SRSLTE_API cf_t srslte_vec_dot_prod_conj_ccc_avx512(cf_t *x, cf_t *y, uint32_t len);
+SRSLTE_API float srslte_vec_dot_prod_fff_avx512(float *x, float *y, uint32_t len);
+SRSLTE_API void srslte_vec_abs_cf_avx512(cf_t *x, float *abs, uint32_t len);
+SRSLTE_API void srslte_vec_abs_square_cf_avx512(cf_t *x, float *abs_square, uint32_t len);
 #ifdef __cplusplus
 }
 #endif
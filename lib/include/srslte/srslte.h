@@ -115,6 +115,7 @@
 #include "srslte/phy/scrambling/scrambling.h"
 
 #include "srslte/phy/sync/pss.h"
+#include "srslte/phy/sync/pss_search.h"
 #include "srslte/phy/sync/sfo.h"
 #include "srslte/phy/sync/sss.h"
 #include "srslte/phy/sync/sync.h"
@@ -67,6 +67,7 @@ public:
   uint32_t get_buffer_state(uint32_t lcid);
   uint32_t get_total_buffer_state(uint32_t lcid);
   int      read_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
+  int      read_pdu_chain(uint32_t lcid, buffer_chain *chain, uint32_t nof_bytes);
   void     write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes);
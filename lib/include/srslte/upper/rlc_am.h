@@ -189,6 +189,7 @@ private:
   void handle_control_pdu(uint8_t *payload, uint32_t nof_bytes);
 
   void reassemble_rx_sdus();
+  void reserve_rx_sdu(uint32_t nof_bytes);
 
   bool inside_tx_window(uint16_t sn);
   bool inside_rx_window(uint16_t sn);
@@ -176,6 +176,7 @@ public:
   virtual uint32_t get_buffer_state() = 0;
   virtual uint32_t get_total_buffer_state() = 0;
   virtual int      read_pdu(uint8_t *payload, uint32_t nof_bytes) = 0;
+  virtual int      read_pdu_chain(buffer_chain *chain, uint32_t nof_bytes) { return -1; }
   virtual void     write_pdu(uint8_t *payload, uint32_t nof_bytes) = 0;
 };
 
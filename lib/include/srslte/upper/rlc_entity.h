@@ -68,6 +68,7 @@ public:
   uint32_t get_buffer_state();
   uint32_t get_total_buffer_state();
   int      read_pdu(uint8_t *payload, uint32_t nof_bytes);
+  int      read_pdu_chain(buffer_chain *chain, uint32_t nof_bytes);
   void     write_pdu(uint8_t *payload, uint32_t nof_bytes);
   
 
@@ -70,6 +70,7 @@ public:
   uint32_t get_buffer_state();
   uint32_t get_total_buffer_state();
   int      read_pdu(uint8_t *payload, uint32_t nof_bytes);
+  int      read_pdu_chain(buffer_chain *chain, uint32_t nof_bytes);
   void     write_pdu(uint8_t *payload, uint32_t nof_bytes);
 
   // Timeout callback interface
@@ -133,9 +134,11 @@ private:
 
   bool     pdu_lost;
 
-  int  build_data_pdu(uint8_t *payload, uint32_t nof_bytes);
+  int  build_data_pdu(uint8_t *payload, uint32_t nof_bytes, buffer_chain *chain = NULL);
+  void add_sdu_segment(byte_buffer_t *pdu, uint32_t to_move, buffer_chain *chain);
   void handle_data_pdu(uint8_t *payload, uint32_t nof_bytes);
   void reassemble_rx_sdus();
+  void reserve_rx_sdu(uint32_t nof_bytes);
   bool inside_reordering_window(uint16_t sn);
   void debug_state();
 };
@@ -29,12 +29,111 @@
 #include "srslte/common/buffer_pool.h"
 #include <stdio.h>
 #include <string>
+#include <vector>
 
 namespace srslte{
 
 byte_buffer_pool *byte_buffer_pool::instance = NULL;
+const uint32_t byte_buffer_pool::class_size[NOF_CLASSES] = {SRSLTE_BUFFER_SMALL_SIZE_BYTES,
+                                                            SRSLTE_BUFFER_MEDIUM_SIZE_BYTES,
+                                                            SRSLTE_MAX_BUFFER_SIZE_BYTES};
 pthread_mutex_t instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+typedef std::vector<buffer_pool_caches::cache_hdr_t*> cache_table_t;
+
+static pthread_once_t        caches_once   = PTHREAD_ONCE_INIT;
+static pthread_key_t         caches_key;
+static bool                  caches_key_ok = false;
+static pthread_mutex_t       caches_mutex  = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t              nof_pool_ids  = 0;
+static std::vector<uint32_t> *free_pool_ids = NULL; // never freed, pools may outlive static objects
+
+void buffer_pool_caches::init()
+{
+  if (pthread_key_create(&caches_key, thread_exit)) {
+    perror("pthread_key_create");
+    fprintf(stderr, "Buffer pools will run without thread caches\n");
+    return;
+  }
+  free_pool_ids = new std::vector<uint32_t>;
+  caches_key_ok = true;
+}
+
+bool buffer_pool_caches::enabled()
+{
+  pthread_once(&caches_once, init);
+  return caches_key_ok;
+}
+
+uint32_t buffer_pool_caches::new_pool_id()
+{
+  uint32_t id;
+  pthread_mutex_lock(&caches_mutex);
+  if (free_pool_ids->empty()) {
+    id = nof_pool_ids++;
+  } else {
+    id = free_pool_ids->back();
+    free_pool_ids->pop_back();
+  }
+  pthread_mutex_unlock(&caches_mutex);
+  return id;
+}
+
+void buffer_pool_caches::free_pool_id(uint32_t pool_id)
+{
+  pthread_mutex_lock(&caches_mutex);
+  free_pool_ids->push_back(pool_id);
+  pthread_mutex_unlock(&caches_mutex);
+}
+
+buffer_pool_caches::cache_hdr_t* buffer_pool_caches::get(uint32_t pool_id)
+{
+  cache_table_t *table = (cache_table_t*) pthread_getspecific(caches_key);
+  if (!table || pool_id >= table->size()) {
+    return NULL;
+  }
+  return (*table)[pool_id];
+}
+
+bool buffer_pool_caches::set(uint32_t pool_id, cache_hdr_t *c)
+{
+  cache_table_t *table = (cache_table_t*) pthread_getspecific(caches_key);
+  if (!table) {
+    table = new cache_table_t;
+    if (pthread_setspecific(caches_key, table)) {
+      delete table;
+      return false;
+    }
+  }
+  if (pool_id >= table->size()) {
+    table->resize(pool_id+1, NULL);
+  }
+  (*table)[pool_id] = c;
+  return true;
+}
+
+void buffer_pool_caches::lock()
+{
+  pthread_mutex_lock(&caches_mutex);
+}
+
+void buffer_pool_caches::unlock()
+{
+  pthread_mutex_unlock(&caches_mutex);
+}
+
+// Returns the caches of an exiting thread to their pools
+void buffer_pool_caches::thread_exit(void *arg)
+{
+  cache_table_t *table = (cache_table_t*) arg;
+  for (uint32_t i=0;i<table->size();i++) {
+    if ((*table)[i]) {
+      (*table)[i]->release((*table)[i]);
+    }
+  }
+  delete table;
+}
+
 byte_buffer_pool* byte_buffer_pool::get_instance(void)
 {
   pthread_mutex_lock(&instance_mutex);
@@ -25,7 +25,23 @@
  */
 
 
-#define LOG_BUFFER_SIZE 1024*32
+#define LOG_RING_SIZE      (256*1024)   // per producer thread, power of two
+#define LOG_MAX_RECORD     (16*1024)
+#define LOG_MAX_SERVICE    32
+#define LOG_POLL_US        5000
+#define LOG_FULL_WAIT_US   100
+#define LOG_CALIBRATION_US 10000
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 #include "srslte/common/logger.h"
 
@@ -33,71 +49,739 @@ using namespace std;
 
 namespace srslte{
 
+/******************************************************************************
+ * Binary log records
+ *
+ * A record starts with rec_hdr_t, followed by the service name, the format
+ * string (or the text) with its terminating NUL, the captured arguments and
+ * the hex payload. Records are 8-byte aligned so that one always fits in the
+ * tail of the ring, or a PAD record does.
+ *
+ * Arguments are stored in format string order as a type byte and the value.
+ * Strings are copied, since the caller's buffer may be gone by the time the
+ * record is formatted. Formats the logger thread can not rebuild (%n, %m,
+ * wide characters, positional arguments) or records too large for the
+ * scratch buffer are formatted by the producer instead.
+ *****************************************************************************/
+
+typedef enum {
+  REC_PAD = 0,
+  REC_RAW,    // text passed to logger::log(), written as is
+  REC_TEXT,   // message already formatted by the producer
+  REC_FMT     // format string and raw arguments
+} rec_kind_t;
+
+typedef struct {
+  uint32_t len;
+  uint8_t  kind;
+  uint8_t  level;
+  uint8_t  do_tti;
+  uint8_t  service_len;
+  uint64_t ts;
+  uint32_t tti;
+  uint32_t text_len;
+  int32_t  hex_len;
+  uint32_t hex_off;
+} rec_hdr_t;
+
+typedef enum {
+  ARG_INT = 0,
+  ARG_LONG,
+  ARG_LLONG,
+  ARG_INTMAX,
+  ARG_SIZE,
+  ARG_PTRDIFF,
+  ARG_DOUBLE,
+  ARG_LDOUBLE,
+  ARG_PTR,
+  ARG_STR
+} arg_type_t;
+
+static inline uint32_t rec_align(uint32_t len) {
+  return (len + 7) & ~7;
+}
+
+static inline uint64_t clock_ns(clockid_t clk) {
+  struct timespec t;
+  clock_gettime(clk, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+// True if the time stamp counter runs at a constant rate in all power states (CPUID invariant TSC)
+static bool tsc_is_invariant() {
+#if defined(__i386__) || defined(__x86_64__)
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0x80000000, NULL) >= 0x80000007) {
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx >> 8) & 1;
+  }
+#endif
+  return false;
+}
+
+// Time stamp counter if invariant, CLOCK_MONOTONIC otherwise. Converted to wall clock by the logger thread
+static inline uint64_t log_timestamp(bool use_tsc) {
+#if defined(__i386__) || defined(__x86_64__)
+  if (use_tsc) {
+    return __builtin_ia32_rdtsc();
+  }
+#endif
+  return clock_ns(CLOCK_MONOTONIC);
+}
+
+class rec_writer
+{
+public:
+  rec_writer(uint8_t *buf_, uint32_t cap_) : buf(buf_), cap(cap_), n(0), overflow(false) {}
+
+  void put(const void *ptr, uint32_t len) {
+    if (n + len > cap) {
+      overflow = true;
+    } else {
+      memcpy(&buf[n], ptr, len);
+      n += len;
+    }
+  }
+  template<typename T>
+  void put_arg(uint8_t type, T value) {
+    put(&type, 1);
+    put(&value, sizeof(T));
+  }
+
+  uint8_t *buf;
+  uint32_t cap;
+  uint32_t n;
+  bool     overflow;
+};
+
+template<typename T>
+static inline T get_arg(const uint8_t **args) {
+  T value;
+  memcpy(&value, *args, sizeof(T));
+  *args += sizeof(T);
+  return value;
+}
+
+static inline bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/* Copies the arguments consumed by fmt. Returns false if fmt has a
+ * conversion that can not be formatted later */
+static bool capture_args(rec_writer *w, const char *fmt, va_list args)
+{
+  const char *p = fmt;
+  while ((p = strchr(p, '%')) != NULL) {
+    p++;
+    if (*p == '%') {
+      p++;
+      continue;
+    }
+    while (*p && strchr("-+ #0'", *p)) {
+      p++;
+    }
+    if (*p == '*') {
+      w->put_arg(ARG_INT, va_arg(args, int));
+      p++;
+    } else {
+      while (is_digit(*p)) {
+        p++;
+      }
+      if (*p == '$') {
+        return false;
+      }
+    }
+    int prec = -1;
+    if (*p == '.') {
+      p++;
+      if (*p == '*') {
+        prec = va_arg(args, int);
+        w->put_arg(ARG_INT, prec);
+        p++;
+      } else {
+        prec = 0;
+        while (is_digit(*p)) {
+          prec = prec*10 + *p++ - '0';
+        }
+      }
+    }
+    int  nof_l = 0;
+    char mod   = 0;
+    switch (*p) {
+      case 'h':
+        p++;
+        if (*p == 'h') {
+          p++;
+        }
+        break;
+      case 'l':
+        p++;
+        nof_l = 1;
+        if (*p == 'l') {
+          p++;
+          nof_l = 2;
+        }
+        break;
+      case 'q':
+      case 'L':
+      case 'j':
+      case 'z':
+      case 't':
+        mod = *p++;
+        break;
+      default:
+        break;
+    }
+    switch (*p) {
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        if (mod == 'j') {
+          w->put_arg(ARG_INTMAX, va_arg(args, intmax_t));
+        } else if (mod == 'z') {
+          w->put_arg(ARG_SIZE, va_arg(args, size_t));
+        } else if (mod == 't') {
+          w->put_arg(ARG_PTRDIFF, va_arg(args, ptrdiff_t));
+        } else if (nof_l == 2 || mod == 'q' || mod == 'L') {
+          w->put_arg(ARG_LLONG, va_arg(args, long long));
+        } else if (nof_l == 1) {
+          w->put_arg(ARG_LONG, va_arg(args, long));
+        } else {
+          w->put_arg(ARG_INT, va_arg(args, int));
+        }
+        break;
+      case 'c':
+        if (nof_l) {
+          return false;
+        }
+        w->put_arg(ARG_INT, va_arg(args, int));
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        if (mod == 'L') {
+          w->put_arg(ARG_LDOUBLE, va_arg(args, long double));
+        } else {
+          w->put_arg(ARG_DOUBLE, va_arg(args, double));
+        }
+        break;
+      case 's': {
+        if (nof_l) {
+          return false;
+        }
+        const char *str = va_arg(args, const char*);
+        if (str == NULL) {
+          str = "(null)";
+        }
+        uint32_t len  = (prec >= 0) ? strnlen(str, prec) : strlen(str);
+        uint8_t  type = ARG_STR;
+        w->put(&type, 1);
+        w->put(&len, sizeof(len));
+        w->put(str, len);
+        w->put("", 1);
+        break;
+      }
+      case 'p':
+        w->put_arg(ARG_PTR, va_arg(args, void*));
+        break;
+      default:
+        return false;
+    }
+    p++;
+  }
+  return true;
+}
+
+template<typename T>
+static void append_arg(std::string *out, const char *spec, T value)
+{
+  char tmp[256];
+  int  n = snprintf(tmp, sizeof(tmp), spec, value);
+  if (n < 0) {
+    return;
+  }
+  if ((uint32_t) n < sizeof(tmp)) {
+    out->append(tmp, n);
+  } else {
+    std::vector<char> big(n + 1);
+    snprintf(&big[0], n + 1, spec, value);
+    out->append(&big[0], n);
+  }
+}
+
+// Formats a REC_FMT message, conversion by conversion, from the captured arguments
+static void format_args(std::string *out, const char *fmt, const uint8_t *args)
+{
+  const char *p = fmt;
+  char        spec[64];
+
+  while (*p) {
+    const char *pct = strchr(p, '%');
+    if (pct == NULL) {
+      out->append(p);
+      break;
+    }
+    out->append(p, pct - p);
+    p = pct + 1;
+    if (*p == '%') {
+      out->push_back('%');
+      p++;
+      continue;
+    }
+    // Rebuilds the conversion with the captured '*' width and precision
+    uint32_t n = 0;
+    spec[n++] = '%';
+    while (!strchr("diouxXceEfFgGaAsp", *p)) {
+      if (*p == '*') {
+        p++;
+        get_arg<uint8_t>(&args);
+        int v = get_arg<int>(&args);
+        if (spec[n-1] == '.' && v < 0) {
+          n--;
+        } else if (n < sizeof(spec) - 16) {
+          n += snprintf(&spec[n], 16, "%d", v);
+        }
+      } else if (n < sizeof(spec) - 16) {
+        spec[n++] = *p++;
+      } else {
+        p++;
+      }
+    }
+    spec[n++] = *p++;
+    spec[n]   = '\0';
+
+    switch (get_arg<uint8_t>(&args)) {
+      case ARG_INT:     append_arg(out, spec, get_arg<int>(&args));         break;
+      case ARG_LONG:    append_arg(out, spec, get_arg<long>(&args));        break;
+      case ARG_LLONG:   append_arg(out, spec, get_arg<long long>(&args));   break;
+      case ARG_INTMAX:  append_arg(out, spec, get_arg<intmax_t>(&args));    break;
+      case ARG_SIZE:    append_arg(out, spec, get_arg<size_t>(&args));      break;
+      case ARG_PTRDIFF: append_arg(out, spec, get_arg<ptrdiff_t>(&args));   break;
+      case ARG_DOUBLE:  append_arg(out, spec, get_arg<double>(&args));      break;
+      case ARG_LDOUBLE: append_arg(out, spec, get_arg<long double>(&args)); break;
+      case ARG_PTR:     append_arg(out, spec, get_arg<void*>(&args));       break;
+      case ARG_STR: {
+        uint32_t len = get_arg<uint32_t>(&args);
+        append_arg(out, spec, (const char*) args);
+        args += len + 1;
+        break;
+      }
+      default:
+        return;
+    }
+  }
+}
+
+static void hex_string(std::string *out, const uint8_t *hex, int size)
+{
+  static const char digits[] = "0123456789abcdef";
+  char tmp[32];
+  int  c = 0;
+
+  while (c < size) {
+    snprintf(tmp, sizeof(tmp), "             %04x: ", c);
+    out->append(tmp);
+    int n = (size-c < 16) ? size-c : 16;
+    for (int i=0;i<n;i++) {
+      out->push_back(digits[hex[c] >> 4]);
+      out->push_back(digits[hex[c] & 0xf]);
+      out->push_back(' ');
+      c++;
+    }
+    out->push_back('\n');
+  }
+}
+
+/******************************************************************************
+ * Per-thread ring of records
+ *
+ * Single producer (the owning thread) and single consumer (the logger
+ * thread). Records are copied in whole and published with one store of the
+ * head index. Records that did not fit are counted in dropped. When the
+ * owning thread exits, the ring is marked as orphan and freed by the logger
+ * thread once empty.
+ *****************************************************************************/
+
+class log_ring
+{
+public:
+  log_ring() : head(0), cached_tail(0), tail(0), cached_head(0), orphan(false), dropped(0) {
+    buf     = new uint8_t[LOG_RING_SIZE];
+    scratch = new uint8_t[LOG_MAX_RECORD];
+  }
+  ~log_ring() {
+    delete [] buf;
+    delete [] scratch;
+  }
+
+  /* Producer side */
+  bool try_push(const uint8_t *rec, uint32_t len) {
+    uint32_t pos = head & (LOG_RING_SIZE - 1);
+    uint32_t pad = (pos + len > LOG_RING_SIZE) ? LOG_RING_SIZE - pos : 0;
+    if (LOG_RING_SIZE - (head - cached_tail) < pad + len) {
+      cached_tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+      if (LOG_RING_SIZE - (head - cached_tail) < pad + len) {
+        return false;
+      }
+    }
+    if (pad) {
+      rec_hdr_t *h = (rec_hdr_t*) &buf[pos];
+      h->len  = pad;
+      h->kind = REC_PAD;
+      pos     = 0;
+    }
+    memcpy(&buf[pos], rec, len);
+    __atomic_store_n(&head, head + pad + len, __ATOMIC_RELEASE);
+    return true;
+  }
+  // Refreshes the consumer index only when the ring looks filled above threshold
+  bool above(uint32_t threshold) {
+    if (head - cached_tail > threshold) {
+      cached_tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    }
+    return head - cached_tail > threshold;
+  }
+
+  /* Consumer side */
+  rec_hdr_t* front() {
+    while (true) {
+      if (tail == cached_head) {
+        cached_head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        if (tail == cached_head) {
+          return NULL;
+        }
+      }
+      rec_hdr_t *h = (rec_hdr_t*) &buf[tail & (LOG_RING_SIZE - 1)];
+      if (h->kind != REC_PAD) {
+        return h;
+      }
+      __atomic_store_n(&tail, tail + h->len, __ATOMIC_RELEASE);
+    }
+  }
+  void pop(rec_hdr_t *h) {
+    __atomic_store_n(&tail, tail + h->len, __ATOMIC_RELEASE);
+  }
+
+  uint8_t   *scratch;
+  bool       orphan;
+  uint32_t   dropped;   // incremented by the producer, reset by the logger thread
+
+private:
+  uint8_t   *buf;
+  uint8_t    pad0[SRSLTE_RING_CACHE_LINE];
+  uint32_t   head;
+  uint32_t   cached_tail;
+  uint8_t    pad1[SRSLTE_RING_CACHE_LINE - 2*sizeof(uint32_t)];
+  uint32_t   tail;
+  uint32_t   cached_head;
+  uint8_t    pad2[SRSLTE_RING_CACHE_LINE - 2*sizeof(uint32_t)];
+};
+
+/******************************************************************************
+ * Logger
+ *****************************************************************************/
+
 logger::logger()
-  :inited(false)
+  :logfile(NULL)
+  ,inited(false)
   ,not_done(true)
-{}
+  ,block_when_full(false)
+  ,line_sec(0)
+{
+  pthread_mutex_init(&mutex, NULL);
+  pthread_key_create(&ring_key, ring_orphan);
+  use_tsc     = tsc_is_invariant();
+  ref_ts      = log_timestamp(use_tsc);
+  ref_mono_ns = clock_ns(CLOCK_MONOTONIC);
+  cal_mono_ns = ref_mono_ns;
+  ns_per_tick = 1.0;
+  // Wall clock steps after this point (NTP, settimeofday) do not move the log timestamps
+  realtime_offset_ns = (int64_t) (clock_ns(CLOCK_REALTIME) - ref_mono_ns);
+}
 
 logger::~logger() {
-  not_done = false;
   log("Closing log");
   if(inited) {
+    __atomic_store_n(&not_done, false, __ATOMIC_RELEASE);
+    wakeup.notify();
     wait_thread_finish();
-    flush();
-    fclose(logfile);
+    if(logfile)
+      fclose(logfile);
+  }
+  pthread_key_delete(ring_key);
+  for (uint32_t i=0;i<rings.size();i++) {
+    delete rings[i];
   }
+  pthread_mutex_destroy(&mutex);
 }
 
 void logger::init(std::string file) {
-  pthread_mutex_init(&mutex, NULL); 
-  pthread_cond_init(&not_empty, NULL);
-  pthread_cond_init(&not_full, NULL);
   filename = file;
   logfile = fopen(filename.c_str(), "w");
   if(logfile==NULL) {
     printf("Error: could not create log file, no messages will be logged");
   }
+  if (use_tsc) {
+    usleep(LOG_CALIBRATION_US);
+    calibrate();
+  }
   start();
-  inited = true;
+  __atomic_store_n(&inited, true, __ATOMIC_RELEASE);
+}
+
+void logger::set_block_when_full(bool block) {
+  __atomic_store_n(&block_when_full, block, __ATOMIC_RELEASE);
+}
+
+void logger::ring_orphan(void *ring) {
+  __atomic_store_n(&((log_ring*) ring)->orphan, true, __ATOMIC_RELEASE);
+}
+
+log_ring* logger::get_ring() {
+  log_ring *ring = (log_ring*) pthread_getspecific(ring_key);
+  if (ring == NULL) {
+    ring = new log_ring;
+    pthread_setspecific(ring_key, ring);
+    pthread_mutex_lock(&mutex);
+    rings.push_back(ring);
+    pthread_mutex_unlock(&mutex);
+  }
+  return ring;
+}
+
+void logger::push(log_ring *ring, uint8_t *rec, uint32_t len) {
+  while (!ring->try_push(rec, len)) {
+    // Drop the message unless asked to wait, or if nobody is going to drain the ring
+    if (!__atomic_load_n(&block_when_full, __ATOMIC_ACQUIRE) ||
+        !__atomic_load_n(&inited, __ATOMIC_ACQUIRE) || !__atomic_load_n(&not_done, __ATOMIC_ACQUIRE)) {
+      __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELEASE);
+      wakeup.notify();
+      return;
+    }
+    wakeup.notify();
+    usleep(LOG_FULL_WAIT_US);
+  }
+  // The logger thread polls, it is only woken up before a burst fills the ring
+  if (ring->above(LOG_RING_SIZE/4)) {
+    wakeup.notify();
+  }
 }
 
 void logger::log(const char *msg) {
-  str_ptr s_ptr(new std::string(msg));
-  log(s_ptr);
+  log_ring  *ring = get_ring();
+  rec_hdr_t *h    = (rec_hdr_t*) ring->scratch;
+  uint32_t   len  = strlen(msg);
+
+  if (len > LOG_MAX_RECORD - sizeof(rec_hdr_t) - 1) {
+    len = LOG_MAX_RECORD - sizeof(rec_hdr_t) - 1;
+  }
+  h->kind        = REC_RAW;
+  h->ts          = log_timestamp(use_tsc);
+  h->service_len = 0;
+  h->text_len    = len;
+  h->hex_len     = -1;
+  memcpy(&ring->scratch[sizeof(rec_hdr_t)], msg, len);
+  ring->scratch[sizeof(rec_hdr_t) + len] = '\0';
+  h->len = rec_align(sizeof(rec_hdr_t) + len + 1);
+  push(ring, ring->scratch, h->len);
 }
 
 void logger::log(str_ptr msg) {
-  pthread_mutex_lock(&mutex);
-  buffer.push_back(msg);
-  pthread_cond_signal(&not_empty);
-  pthread_mutex_unlock(&mutex);
+  log(msg->c_str());
+  delete msg;
+}
+
+void logger::log_fmt(const std::string &service, LOG_LEVEL_ENUM level, bool do_tti, uint32_t tti,
+                     const char *fmt, va_list args, const uint8_t *hex, int hex_len)
+{
+  log_ring   *ring = get_ring();
+  rec_hdr_t  *h    = (rec_hdr_t*) ring->scratch;
+  rec_writer  w(&ring->scratch[sizeof(rec_hdr_t)], LOG_MAX_RECORD - sizeof(rec_hdr_t));
+  uint32_t    service_len = service.size() < LOG_MAX_SERVICE ? service.size() : LOG_MAX_SERVICE;
+  uint32_t    fmt_len     = strlen(fmt);
+  va_list     args_copy;
+
+  h->ts          = log_timestamp(use_tsc);
+  h->kind        = REC_FMT;
+  h->level       = level;
+  h->do_tti      = do_tti;
+  h->tti         = tti;
+  h->service_len = service_len;
+  h->text_len    = fmt_len;
+  w.put(service.data(), service_len);
+  w.put(fmt, fmt_len + 1);
+
+  __va_copy(args_copy, args);
+  bool deferred = capture_args(&w, fmt, args_copy);
+  va_end(args_copy);
+
+  if (!deferred || w.overflow) {
+    w.n        = service_len;
+    w.overflow = false;
+    int n = vsnprintf((char*) &w.buf[w.n], w.cap - w.n, fmt, args);
+    if (n < 0) {
+      n = 0;
+    } else if ((uint32_t) n >= w.cap - w.n) {
+      n = w.cap - w.n - 1;
+    }
+    w.n        += n + 1;
+    h->kind     = REC_TEXT;
+    h->text_len = n;
+  }
+
+  h->hex_len = hex_len;
+  h->hex_off = sizeof(rec_hdr_t) + w.n;
+  if (hex_len > 0) {
+    if ((uint32_t) hex_len > w.cap - w.n) {
+      h->hex_len = w.cap - w.n;
+    }
+    w.put(hex, h->hex_len);
+  }
+  h->len = rec_align(sizeof(rec_hdr_t) + w.n);
+  push(ring, ring->scratch, h->len);
 }
 
 void logger::run_thread() {
-  while(not_done) {
+  while(__atomic_load_n(&not_done, __ATOMIC_ACQUIRE)) {
+    if (!drain()) {
+      int32_t key = wakeup.prepare_wait();
+      if (__atomic_load_n(&not_done, __ATOMIC_ACQUIRE) && !drain()) {
+        struct timespec timeout = {0, LOG_POLL_US*1000};
+        wakeup.wait(key, &timeout);
+      }
+    }
+  }
+  drain();
+}
+
+// Writes all the published records, oldest first across the rings
+bool logger::drain() {
+  std::vector<log_ring*> r;
+  bool                   written = false;
+
   pthread_mutex_lock(&mutex);
-    while(buffer.empty()) {
-      pthread_cond_wait(&not_empty, &mutex);
+  r = rings;
+  pthread_mutex_unlock(&mutex);
+
+  if (use_tsc && clock_ns(CLOCK_MONOTONIC) - cal_mono_ns > 1000000000) {
+    calibrate();
+  }
+
+  while (true) {
+    log_ring  *next   = NULL;
+    rec_hdr_t *next_h = NULL;
+    for (uint32_t i=0;i<r.size();i++) {
+      rec_hdr_t *h = r[i]->front();
+      if (h && (next_h == NULL || (int64_t) (h->ts - next_h->ts) < 0)) {
+        next   = r[i];
+        next_h = h;
+      }
+    }
+    if (next == NULL) {
+      break;
+    }
+    write_record((uint8_t*) next_h);
+    next->pop(next_h);
+    written = true;
+  }
+  for (uint32_t i=0;i<r.size();i++) {
+    if (__atomic_load_n(&r[i]->dropped, __ATOMIC_ACQUIRE)) {
+      report_dropped(r[i]);
+      written = true;
     }
-    str_ptr s = buffer.front();
-    pthread_cond_signal(&not_full);
-    if(logfile)
-      fprintf(logfile, "%s", s->c_str());
-    delete s; 
-    buffer.pop_front();
-    pthread_mutex_unlock(&mutex);
   }
+  if (written && logfile) {
+    fflush(logfile);
+  }
+
+  // Rings of exited threads, orphan is set after their last record
+  pthread_mutex_lock(&mutex);
+  for (uint32_t i=0;i<rings.size();) {
+    if (__atomic_load_n(&rings[i]->orphan, __ATOMIC_ACQUIRE) && rings[i]->front() == NULL) {
+      report_dropped(rings[i]);
+      delete rings[i];
+      rings.erase(rings.begin() + i);
+    } else {
+      i++;
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+  return written;
 }
 
-void logger::flush() {
-  std::deque<str_ptr>::iterator it;
-  for(it=buffer.begin();it!=buffer.end();it++)
-  {
-    str_ptr s = *it; 
-    if(logfile)
-      fprintf(logfile, "%s", s->c_str());
-    delete s; 
+void logger::write_record(uint8_t *rec) {
+  rec_hdr_t  *h       = (rec_hdr_t*) rec;
+  const char *service = (const char*) &rec[sizeof(rec_hdr_t)];
+  const char *text    = service + h->service_len;
+  char        tmp[32];
+
+  line.clear();
+  if (h->kind != REC_RAW) {
+    uint64_t ns  = to_wall_ns(h->ts);
+    time_t   sec = ns/1000000000;
+    if (sec != line_sec) {
+      struct tm t;
+      localtime_r(&sec, &t);
+      strftime(line_hms, sizeof(line_hms), "%H:%M:%S", &t);
+      line_sec = sec;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.%06u [", line_hms, (uint32_t) (ns%1000000000)/1000);
+    line.append(tmp);
+    line.append(service, h->service_len);
+    line.append("] ");
+    line.append(log_level_text[h->level]);
+    line.append(" ");
+    if (h->do_tti) {
+      snprintf(tmp, sizeof(tmp), "[%05u] ", h->tti);
+      line.append(tmp);
+    }
+  }
+  if (h->kind == REC_FMT) {
+    format_args(&line, text, (const uint8_t*) &text[h->text_len + 1]);
+  } else {
+    line.append(text, h->text_len);
   }
+  if (h->hex_len >= 0) {
+    if (line[line.size()-1] != '\n') {
+      line.push_back('\n');
+    }
+    hex_string(&line, &rec[h->hex_off], h->hex_len);
+  }
+  if (logfile) {
+    fwrite(line.data(), 1, line.size(), logfile);
+  }
+}
+
+// Writes how many messages of the ring were dropped since the last report
+void logger::report_dropped(log_ring *ring) {
+  uint32_t n = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_ACQ_REL);
+  if (n && logfile) {
+    fprintf(logfile, "Logger: %u messages dropped, log ring full\n", n);
+  }
+}
+
+void logger::calibrate() {
+  if (!use_tsc) {
+    return;
+  }
+  uint64_t ts   = log_timestamp(use_tsc);
+  uint64_t mono = clock_ns(CLOCK_MONOTONIC);
+  if (ts != ref_ts) {
+    ns_per_tick = (double) (int64_t) (mono - ref_mono_ns)/(double) (int64_t) (ts - ref_ts);
+  }
+  cal_mono_ns = mono;
+}
+
+uint64_t logger::to_wall_ns(uint64_t ts) {
+  return ref_mono_ns + realtime_offset_ns + (int64_t) ((double) (int64_t) (ts - ref_ts)*ns_per_tick);
 }
 
 } // namespace srsue
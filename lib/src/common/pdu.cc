@@ -111,6 +111,36 @@ void sch_pdu::parse_packet(uint8_t *ptr)
   }
 }
 
+void sch_pdu::init_tx(uint8_t *payload, uint32_t pdu_len_bytes, bool is_ulsch)
+{
+  chain = NULL;
+  pdu::init_tx(payload, pdu_len_bytes, is_ulsch);
+}
+
+void sch_pdu::init_tx_chain(uint8_t *payload, uint32_t pdu_len_bytes, buffer_chain *chain_)
+{
+  pdu::init_tx(payload, pdu_len_bytes, false);
+  chain = chain_;
+  chain->reset();
+  // First slice is for the subheaders and CEs, written at the end
+  chain->append(NULL, 0);
+}
+
+buffer_chain* sch_pdu::get_chain()
+{
+  return chain;
+}
+
+/* Makes room for nof_slices more slices by copying the SDUs referenced so far
+ * to their place in the payload buffer, as in a contiguous PDU 
+ */
+void sch_pdu::reserve_slices(uint32_t nof_slices)
+{
+  if (chain && chain->free_slices() < nof_slices) {
+    chain->collapse(&buffer_tx[sdu_offset_start], 1);
+  }
+}
+
 uint8_t* sch_pdu::write_packet() {
   return write_packet(NULL);
 }
@@ -249,6 +279,14 @@ uint8_t* sch_pdu::write_packet(srslte::log *log_h)
             header_sz+ce_payload_sz,(int) (ptr - pdu_start_ptr));
     return NULL;
   }
+
+  if (chain) {
+    chain->set(0, pdu_start_ptr, header_sz + ce_payload_sz);
+    if (rem_len > 0) {
+      reserve_slices(1);
+      chain->append(&pdu_start_ptr[pdu_len-rem_len], rem_len);
+    }
+  }
   
   return pdu_start_ptr; 
 }
@@ -574,10 +612,22 @@ int sch_subh::set_sdu(uint32_t lcid_, uint32_t requested_bytes, read_pdu_interfa
     lcid = lcid_;
     
     payload = ((sch_pdu*)parent)->get_current_sdu_ptr();
-    // Copy data and get final number of bytes written to the MAC PDU 
-    uint32_t sdu_sz = sdu_itf->read_pdu(lcid, payload, requested_bytes);
+    int sdu_sz = -1; 
+    buffer_chain *chain = ((sch_pdu*)parent)->get_chain();
+    if (chain) {
+      // Reference the RLC buffers if the bearer supports it 
+      ((sch_pdu*)parent)->reserve_slices(2);
+      sdu_sz = sdu_itf->read_pdu_chain(lcid, chain, requested_bytes);
+    }
+    if (sdu_sz < 0) {
+      // Copy data and get final number of bytes written to the MAC PDU 
+      sdu_sz = sdu_itf->read_pdu(lcid, payload, requested_bytes);
+      if (chain && sdu_sz > 0) {
+        chain->append(payload, sdu_sz);
+      }
+    }
     
-    if (sdu_sz < 0 || sdu_sz > requested_bytes) {
+    if (sdu_sz < 0 || sdu_sz > (int) requested_bytes) {
       return -1;
     } 
     if (sdu_sz == 0) {
@@ -601,6 +651,11 @@ int sch_subh::set_sdu(uint32_t lcid_, uint32_t nof_bytes_, uint8_t *payload)
     lcid = lcid_;
     
     memcpy(((sch_pdu*)parent)->get_current_sdu_ptr(), payload, nof_bytes_);
+    buffer_chain *chain = ((sch_pdu*)parent)->get_chain();
+    if (chain) {
+      ((sch_pdu*)parent)->reserve_slices(1);
+      chain->append(((sch_pdu*)parent)->get_current_sdu_ptr(), nof_bytes_);
+    }
     
     ((sch_pdu*)parent)->add_sdu(nof_bytes_);
     ((sch_pdu*)parent)->update_space_sdu(nof_bytes_);
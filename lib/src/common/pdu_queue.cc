@@ -79,7 +79,12 @@ void pdu_queue::push(uint8_t *ptr, uint32_t len, uint32_t tstamp)
   pdu_t *pdu  = (pdu_t*) ptr; 
   pdu->len    = len; 
   pdu->tstamp = tstamp; 
-  pdu_q.push(pdu);    
+  if (!pdu_q.try_push(pdu)) {
+    if (log_h) {
+      log_h->error("PDU queue full\n");
+    }
+    deallocate(ptr);
+  }
 }
 
 bool pdu_queue::process_pdus()
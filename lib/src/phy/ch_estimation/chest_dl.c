@@ -39,6 +39,9 @@
 #include "srslte/phy/utils/vector.h"
 #include "srslte/phy/utils/convolution.h"
 
+#define WIENER_SNR_MIN_DB   -5.0
+#define WIENER_SNR_STEP_DB   5.0
+
 //#define DEFAULT_FILTER_LEN 3
 
 #ifdef DEFAULT_FILTER_LEN 
@@ -64,6 +67,203 @@ static void set_default_filter(srslte_chest_dl_t *q, int filter_len) {
 }
 #endif
 
+/* Precomputes, for every symbol of the subframe, the pilot symbols used by the time interpolation */
+static void init_time_interp(srslte_chest_dl_t *q) 
+{
+  for (uint32_t c=0;c<2;c++) {
+    uint32_t port_id  = 2*c; 
+    uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(port_id); 
+    for (uint32_t n=0;n<2*SRSLTE_CP_NSYMB(q->cell.cp);n++) {
+      uint32_t seg = 0; 
+      q->time_pilot[c][n] = -1; 
+      for (uint32_t l=0;l<nsymbols;l++) {
+        uint32_t t = srslte_refsignal_cs_nsymbol(l, q->cell.cp, port_id); 
+        if (t == n) {
+          q->time_pilot[c][n] = l; 
+        }
+        if (t < n && l < nsymbols-1) {
+          seg = l; 
+        }
+      }
+      float t0 = srslte_refsignal_cs_nsymbol(seg,   q->cell.cp, port_id); 
+      float t1 = srslte_refsignal_cs_nsymbol(seg+1, q->cell.cp, port_id); 
+      q->time_seg[c][n] = seg; 
+      q->time_w[c][n]   = ((float) n-t0)/(t1-t0); 
+    }
+  }
+}
+
+/* Channel correlation between two RE separated dk subcarriers and dn symbols. Uses a uniform 
+ * power delay profile centered at the FFT window and the Jakes Doppler spectrum */
+static double wiener_corr(srslte_chest_dl_t *q, int dk, int dn) 
+{
+  double x  = 2*q->wiener_delay_us*1e-6*15000*dk; 
+  double rf = x==0?1:sin(M_PI*x)/(M_PI*x); 
+  double rt = j0(2*M_PI*q->wiener_doppler_hz*dn*1e-3/(2*SRSLTE_CP_NSYMB(q->cell.cp))); 
+  return rf*rt; 
+}
+
+/* Jacobi eigenvalue decomposition of the symmetric n x n matrix a. On return the diagonal of a 
+ * holds the eigenvalues and the columns of v the eigenvectors */
+static void wiener_eig(double *a, double *v, uint32_t n) 
+{
+  for (uint32_t i=0;i<n;i++) {
+    for (uint32_t j=0;j<n;j++) {
+      v[i*n+j] = i==j?1:0; 
+    }
+  }
+  for (int sweep=0;sweep<50;sweep++) {
+    double off = 0; 
+    for (uint32_t i=0;i<n;i++) {
+      for (uint32_t j=i+1;j<n;j++) {
+        off += a[i*n+j]*a[i*n+j];
+      }
+    }
+    if (off < 1e-24) {
+      break; 
+    }
+    for (uint32_t p=0;p<n;p++) {
+      for (uint32_t r=p+1;r<n;r++) {
+        double apr = a[p*n+r]; 
+        if (fabs(apr) < 1e-300) {
+          continue; 
+        }
+        double theta = (a[r*n+r]-a[p*n+p])/(2*apr); 
+        double t = (theta>=0?1:-1)/(fabs(theta)+sqrt(theta*theta+1)); 
+        double c = 1/sqrt(t*t+1); 
+        double s = t*c; 
+        for (uint32_t k=0;k<n;k++) {
+          double akp = a[k*n+p], akr = a[k*n+r]; 
+          a[k*n+p] = c*akp-s*akr; 
+          a[k*n+r] = s*akp+c*akr; 
+        }
+        for (uint32_t k=0;k<n;k++) {
+          double apk = a[p*n+k], ark = a[r*n+k]; 
+          a[p*n+k] = c*apk-s*ark; 
+          a[r*n+k] = s*apk+c*ark; 
+        }
+        for (uint32_t k=0;k<n;k++) {
+          double vkp = v[k*n+p], vkr = v[k*n+r]; 
+          v[k*n+p] = c*vkp-s*vkr; 
+          v[k*n+r] = s*vkp+c*vkr; 
+        }
+      }
+    }
+  }
+}
+
+/* Designs the interpolator of the PRB at position pos of a SRSLTE_CHEST_DL_WIENER_PRB wide pilot window */
+static int wiener_design(srslte_chest_dl_t *q, srslte_chest_dl_wiener_t *w, uint32_t port_id, uint32_t pos) 
+{
+  uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(port_id); 
+  uint32_t npilots  = 2*SRSLTE_CHEST_DL_WIENER_PRB; 
+  uint32_t n        = nsymbols*npilots; 
+  uint32_t nof_re   = 2*SRSLTE_CP_NSYMB(q->cell.cp)*SRSLTE_NRE; 
+  int pk[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS], pn[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS]; 
+  double a[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS*SRSLTE_CHEST_DL_WIENER_MAX_PILOTS]; 
+  double v[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS*SRSLTE_CHEST_DL_WIENER_MAX_PILOTS]; 
+  uint32_t order[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS]; 
+
+  for (uint32_t l=0;l<nsymbols;l++) {
+    for (uint32_t k=0;k<npilots;k++) {
+      pk[l*npilots+k] = srslte_refsignal_cs_fidx(q->cell, l, port_id, k); 
+      pn[l*npilots+k] = srslte_refsignal_cs_nsymbol(l, q->cell.cp, port_id); 
+    }
+  }
+  for (uint32_t i=0;i<n;i++) {
+    for (uint32_t j=0;j<n;j++) {
+      a[i*n+j] = wiener_corr(q, pk[i]-pk[j], pn[i]-pn[j]); 
+    }
+  }
+  wiener_eig(a, v, n); 
+
+  /* Sort eigenvalues in decreasing order and keep the dominant ones */
+  for (uint32_t i=0;i<n;i++) {
+    order[i] = i; 
+  }
+  for (uint32_t i=0;i<n;i++) {
+    for (uint32_t j=i+1;j<n;j++) {
+      if (a[order[j]*n+order[j]] > a[order[i]*n+order[i]]) {
+        uint32_t t = order[i]; 
+        order[i] = order[j]; 
+        order[j] = t; 
+      }
+    }
+  }
+  double lmax = a[order[0]*n+order[0]]; 
+  w->rank = 0; 
+  while (w->rank < n && w->rank < SRSLTE_CHEST_DL_WIENER_MAX_RANK && 
+         a[order[w->rank]*n+order[w->rank]] > 1e-4*lmax) 
+  {
+    w->rank++; 
+  }
+  w->nof_pilots = n; 
+
+  w->proj   = srslte_vec_malloc(sizeof(float) * w->rank * n); 
+  w->interp = srslte_vec_malloc(sizeof(float) * nof_re * w->rank); 
+  if (!w->proj || !w->interp) {
+    perror("malloc");
+    return SRSLTE_ERROR; 
+  }
+
+  for (uint32_t r=0;r<w->rank;r++) {
+    uint32_t e = order[r]; 
+    for (uint32_t j=0;j<n;j++) {
+      w->proj[r*n+j] = v[j*n+e]; 
+    }
+    for (uint32_t b=0;b<SRSLTE_CHEST_DL_WIENER_NOF_BINS;b++) {
+      double noise = pow(10, -(WIENER_SNR_MIN_DB+b*WIENER_SNR_STEP_DB)/10); 
+      w->gain[b][r] = 1/(a[e*n+e]+noise); 
+    }
+  }
+  for (uint32_t x=0;x<nof_re;x++) {
+    int k = pos*SRSLTE_NRE + x%SRSLTE_NRE; 
+    int t = x/SRSLTE_NRE; 
+    for (uint32_t r=0;r<w->rank;r++) {
+      double acc = 0; 
+      for (uint32_t j=0;j<n;j++) {
+        acc += wiener_corr(q, k-pk[j], t-pn[j])*v[j*n+order[r]]; 
+      }
+      w->interp[(t*w->rank+r)*SRSLTE_NRE+x%SRSLTE_NRE] = acc; 
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+static void free_wiener(srslte_chest_dl_t *q) 
+{
+  for (uint32_t p=0;p<SRSLTE_MAX_PORTS;p++) {
+    for (uint32_t i=0;i<SRSLTE_CHEST_DL_WIENER_PRB;i++) {
+      if (q->wiener[p][i].proj) {
+        free(q->wiener[p][i].proj);
+      }
+      if (q->wiener[p][i].interp) {
+        free(q->wiener[p][i].interp);
+      }
+    }
+  }
+  bzero(q->wiener, sizeof(q->wiener));
+  q->wiener_ready = false; 
+}
+
+static int init_wiener(srslte_chest_dl_t *q) 
+{
+  free_wiener(q);
+  if (q->cell.nof_prb < SRSLTE_CHEST_DL_WIENER_PRB) {
+    return SRSLTE_ERROR; 
+  }
+  for (uint32_t p=0;p<q->cell.nof_ports;p++) {
+    for (uint32_t i=0;i<SRSLTE_CHEST_DL_WIENER_PRB;i++) {
+      if (wiener_design(q, &q->wiener[p][i], p, i)) {
+        free_wiener(q);
+        return SRSLTE_ERROR; 
+      }
+    }
+  }
+  q->wiener_ready = true; 
+  return SRSLTE_SUCCESS; 
+}
+
 /** 3GPP LTE Downlink channel estimator and equalizer. 
  * Estimates the channel in the resource elements transmitting references and interpolates for the rest
  * of the resource grid. 
@@ -123,12 +323,22 @@ int srslte_chest_dl_init(srslte_chest_dl_t *q, srslte_cell_t cell)
       goto clean_exit;
     }
     
+    q->block = srslte_vec_malloc(sizeof(cf_t) * 4 * SRSLTE_NRE * SRSLTE_CHEST_DL_GROUP_PRB);
+    if (!q->block) {
+      perror("malloc");
+      goto clean_exit;
+    }
+
     q->noise_alg = SRSLTE_NOISE_ALG_REFS; 
     
     q->smooth_filter_len = 3; 
     srslte_chest_dl_set_smooth_filter3_coeff(q, 0.1);
     
     q->cell = cell; 
+
+    init_time_interp(q);
+    q->wiener_delay_us   = 2.5; 
+    q->wiener_doppler_hz = 70; 
   }
   
   ret = SRSLTE_SUCCESS;
@@ -159,6 +369,17 @@ void srslte_chest_dl_free(srslte_chest_dl_t *q)
   if (q->pilot_recv_signal) {
     free(q->pilot_recv_signal);
   }
+  if (q->block) {
+    free(q->block);
+  }
+  free_wiener(q);
+  for (int i=0;i<SRSLTE_MAX_PORTS;i++) {
+    for (int j=0;j<SRSLTE_MAX_PORTS;j++) {
+      if (q->lazy_pilots[i][j]) {
+        free(q->lazy_pilots[i][j]);
+      }
+    }
+  }
   bzero(q, sizeof(srslte_chest_dl_t));
 }
 
@@ -247,7 +468,7 @@ static void interpolate_pilots(srslte_chest_dl_t *q, cf_t *pilot_estimates, cf_t
     } else {
       srslte_interp_linear_vector2(&q->srslte_interp_linvec, &cesymb(8), &cesymb(1), &cesymb(1), &cesymb(0), 7, 1);
       srslte_interp_linear_vector(&q->srslte_interp_linvec, &cesymb(1), &cesymb(8), &cesymb(2), 7, 6);
-      srslte_interp_linear_vector(&q->srslte_interp_linvec, &cesymb(1), &cesymb(8), &cesymb(9), 7, 5);
+      srslte_interp_linear_vector2(&q->srslte_interp_linvec, &cesymb(1), &cesymb(8), &cesymb(8), &cesymb(9), 7, 5);
     }    
   } else {
     if (nsymbols == 4) {
@@ -258,7 +479,7 @@ static void interpolate_pilots(srslte_chest_dl_t *q, cf_t *pilot_estimates, cf_t
     } else {
       srslte_interp_linear_vector2(&q->srslte_interp_linvec, &cesymb(7), &cesymb(1), &cesymb(1), &cesymb(0), 6, 1);
       srslte_interp_linear_vector(&q->srslte_interp_linvec, &cesymb(1), &cesymb(7), &cesymb(2), 6, 5);
-      srslte_interp_linear_vector(&q->srslte_interp_linvec, &cesymb(1), &cesymb(7), &cesymb(8), 6, 4);
+      srslte_interp_linear_vector2(&q->srslte_interp_linvec, &cesymb(1), &cesymb(7), &cesymb(7), &cesymb(8), 6, 4);
     }    
   }
 }
@@ -281,6 +502,55 @@ void srslte_chest_dl_set_noise_alg(srslte_chest_dl_t *q, srslte_chest_dl_noise_a
   q->noise_alg = noise_estimation_alg; 
 }
 
+int srslte_chest_dl_set_interp(srslte_chest_dl_t *q, srslte_chest_dl_interp_t interp) 
+{
+  if (interp == SRSLTE_CHEST_DL_INTERP_WIENER && !q->wiener_ready) {
+    if (init_wiener(q)) {
+      fprintf(stderr, "Error designing Wiener interpolator\n");
+      return SRSLTE_ERROR; 
+    }
+  }
+  q->interp = interp; 
+  return SRSLTE_SUCCESS; 
+}
+
+/* Sets the delay spread (half-width of the power delay profile) and the maximum Doppler assumed by 
+ * the Wiener interpolator */
+int srslte_chest_dl_set_wiener_model(srslte_chest_dl_t *q, float delay_spread_us, float doppler_hz) 
+{
+  q->wiener_delay_us   = delay_spread_us; 
+  q->wiener_doppler_hz = doppler_hz; 
+  if (q->wiener_ready) {
+    if (init_wiener(q)) {
+      fprintf(stderr, "Error designing Wiener interpolator\n");
+      q->interp = SRSLTE_CHEST_DL_INTERP_FUSED; 
+      return SRSLTE_ERROR; 
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+/* In lazy mode srslte_chest_dl_estimate_port() only estimates the pilots, the noise and the RSRP. 
+ * The grid is filled by srslte_chest_dl_interpolate() for the symbols and PRB actually demodulated. */
+int srslte_chest_dl_set_lazy(srslte_chest_dl_t *q, bool enable) 
+{
+  if (enable) {
+    for (int i=0;i<SRSLTE_MAX_PORTS;i++) {
+      for (int j=0;j<SRSLTE_MAX_PORTS;j++) {
+        if (!q->lazy_pilots[i][j]) {
+          q->lazy_pilots[i][j] = srslte_vec_malloc(sizeof(cf_t) * SRSLTE_REFSIGNAL_MAX_NUM_SF(q->cell.nof_prb));
+          if (!q->lazy_pilots[i][j]) {
+            perror("malloc");
+            return SRSLTE_ERROR; 
+          }
+        }
+      }
+    }
+  }
+  q->lazy = enable; 
+  return SRSLTE_SUCCESS; 
+}
+
 void srslte_chest_dl_set_smooth_filter3_coeff(srslte_chest_dl_t* q, float w)
 {
   q->smooth_filter_len = 3;
@@ -299,6 +569,197 @@ static void average_pilots(srslte_chest_dl_t *q, cf_t *input, cf_t *output, uint
   }
 }
 
+static bool smooth_enabled(srslte_chest_dl_t *q) 
+{
+  return !(q->smooth_filter_len == 0 || (q->smooth_filter_len == 3 && q->smooth_filter[0] == 0));
+}
+
+/* Computes the least-squares estimates of the pilots [k0-M/2, k1+M/2) and the smoothed estimates of 
+ * the pilots [k0, k1) of every pilot symbol, reading the references directly from the resource grid. 
+ * The band edges are extrapolated as srslte_conv_same_cf() does. */
+static void estimate_pilots(srslte_chest_dl_t *q, cf_t *input, uint32_t sf_idx, uint32_t port_id, 
+                            uint32_t k0, uint32_t k1) 
+{
+  uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(port_id); 
+  int nref = 2*q->cell.nof_prb;
+  int M = q->smooth_filter_len; 
+  int h = M/2; 
+  int a = SRSLTE_MAX((int) k0-h, 0); 
+  int b = SRSLTE_MIN((int) k1+h, nref); 
+
+  for (uint32_t l=0;l<nsymbols;l++) {
+    cf_t *ls  = &q->pilot_estimates[l*nref]; 
+    cf_t *avg = &q->pilot_estimates_average[l*nref]; 
+    cf_t *ref = &q->csr_signal.pilots[port_id/2][sf_idx][l*nref]; 
+    cf_t *x   = &input[SRSLTE_RE_IDX(q->cell.nof_prb, srslte_refsignal_cs_nsymbol(l, q->cell.cp, port_id), 
+                                     srslte_refsignal_cs_fidx(q->cell, l, port_id, 0))]; 
+    for (int k=a;k<b;k++) {
+      ls[k] = x[SRSLTE_NRE/2*k]*conjf(ref[k]); 
+    }
+    for (int k=(int) k0;k<(int) k1;k++) {
+      cf_t y = 0; 
+      for (int m=0;m<M;m++) {
+        int i = k-h+m; 
+        cf_t v; 
+        if (i < 0) {
+          v = (2-i)*ls[1]-(1-i)*ls[0]; 
+        } else if (i >= nref) {
+          v = (i-nref+M+1-h)*ls[nref-1]-(i-nref+M-h)*ls[nref-2]; 
+        } else {
+          v = ls[i]; 
+        }
+        y += q->smooth_filter[m]*v; 
+      }
+      avg[k] = y; 
+    }
+  }
+}
+
+/* Linear interpolation of one pilot symbol to the subcarriers [s0, s1) */
+static void interp_freq(cf_t *pilots, uint32_t nref, uint32_t offset, cf_t *output, uint32_t s0, uint32_t s1) 
+{
+  uint32_t s = s0; 
+  while (s < s1) {
+    int u = (int) s-(int) offset; 
+    int i = u<0?0:u/(SRSLTE_NRE/2); 
+    if (i > (int) nref-2) {
+      i = nref-2; 
+    }
+    uint32_t end = i==(int) nref-2?s1:SRSLTE_MIN(s1, SRSLTE_NRE/2*(i+1)+offset); 
+    cf_t diff = (pilots[i+1]-pilots[i])/(SRSLTE_NRE/2); 
+    for (;s<end;s++) {
+      output[s-s0] = pilots[i]+diff*(float) ((int) s-(int) offset-SRSLTE_NRE/2*i);
+    }
+  }
+}
+
+/* Interpolates the PRB [prb0, prb1) of the symbols [sym0, sym1) from the pilot estimates. The pilot 
+ * symbols are interpolated in frequency into a block that stays in cache for the time interpolation */
+static void interp_group(srslte_chest_dl_t *q, cf_t *pilots, cf_t *ce, uint32_t port_id, 
+                         uint32_t prb0, uint32_t prb1, uint32_t sym0, uint32_t sym1) 
+{
+  uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(port_id); 
+  uint32_t nref = 2*q->cell.nof_prb; 
+  uint32_t s0 = prb0*SRSLTE_NRE; 
+  uint32_t w  = (prb1-prb0)*SRSLTE_NRE; 
+  uint32_t c  = port_id/2; 
+
+  for (uint32_t l=0;l<nsymbols;l++) {
+    interp_freq(&pilots[l*nref], nref, srslte_refsignal_cs_fidx(q->cell, l, port_id, 0), &q->block[l*w], s0, s0+w);
+  }
+  for (uint32_t n=sym0;n<sym1;n++) {
+    cf_t *out = &ce[SRSLTE_RE_IDX(q->cell.nof_prb, n, s0)]; 
+    if (q->time_pilot[c][n] >= 0) {
+      memcpy(out, &q->block[q->time_pilot[c][n]*w], sizeof(cf_t)*w); 
+    } else {
+      cf_t *x0 = &q->block[q->time_seg[c][n]*w]; 
+      cf_t *x1 = &x0[w]; 
+      float a = q->time_w[c][n]; 
+      for (uint32_t s=0;s<w;s++) {
+        out[s] = x0[s]+a*(x1[s]-x0[s]); 
+      }
+    }
+  }
+}
+
+static void interp_wiener_prb(srslte_chest_dl_t *q, cf_t *pilots, cf_t *ce, uint32_t port_id, uint32_t bin, 
+                              uint32_t prb, uint32_t sym0, uint32_t sym1) 
+{
+  uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(port_id); 
+  uint32_t nref = 2*q->cell.nof_prb; 
+  uint32_t npilots = 2*SRSLTE_CHEST_DL_WIENER_PRB; 
+  uint32_t w0 = prb<SRSLTE_CHEST_DL_WIENER_PRB/2?0:prb-SRSLTE_CHEST_DL_WIENER_PRB/2; 
+  if (w0+SRSLTE_CHEST_DL_WIENER_PRB > q->cell.nof_prb) {
+    w0 = q->cell.nof_prb-SRSLTE_CHEST_DL_WIENER_PRB; 
+  }
+  srslte_chest_dl_wiener_t *w = &q->wiener[port_id][prb-w0]; 
+  cf_t p[SRSLTE_CHEST_DL_WIENER_MAX_PILOTS]; 
+  cf_t z[SRSLTE_CHEST_DL_WIENER_MAX_RANK]; 
+
+  for (uint32_t l=0;l<nsymbols;l++) {
+    memcpy(&p[l*npilots], &pilots[l*nref+2*w0], sizeof(cf_t)*npilots); 
+  }
+  for (uint32_t r=0;r<w->rank;r++) {
+    z[r] = w->gain[bin][r]*srslte_vec_dot_prod_cfc(p, &w->proj[r*w->nof_pilots], w->nof_pilots); 
+  }
+  for (uint32_t n=sym0;n<sym1;n++) {
+    float re[SRSLTE_NRE] = {0}, im[SRSLTE_NRE] = {0}; 
+    float *b = &w->interp[n*w->rank*SRSLTE_NRE]; 
+    for (uint32_t r=0;r<w->rank;r++) {
+      float zr = crealf(z[r]), zi = cimagf(z[r]); 
+      for (uint32_t s=0;s<SRSLTE_NRE;s++) {
+        re[s] += b[r*SRSLTE_NRE+s]*zr; 
+        im[s] += b[r*SRSLTE_NRE+s]*zi; 
+      }
+    }
+    cf_t *out = &ce[SRSLTE_RE_IDX(q->cell.nof_prb, n, prb*SRSLTE_NRE)]; 
+    for (uint32_t s=0;s<SRSLTE_NRE;s++) {
+      out[s] = re[s]+_Complex_I*im[s]; 
+    }
+  }
+}
+
+/* Interpolates the PRB selected by prb_mask (all if NULL) of the symbols [sym0, sym1) */
+static void interp_prbs(srslte_chest_dl_t *q, cf_t *pilots, cf_t *ce, uint32_t port_id, uint32_t bin, 
+                        uint32_t sym0, uint32_t sym1, bool *prb_mask) 
+{
+  uint32_t prb = 0; 
+  while (prb < q->cell.nof_prb) {
+    if (prb_mask && !prb_mask[prb]) {
+      prb++; 
+    } else if (q->interp == SRSLTE_CHEST_DL_INTERP_WIENER) {
+      interp_wiener_prb(q, pilots, ce, port_id, bin, prb, sym0, sym1);
+      prb++; 
+    } else {
+      uint32_t end = prb+1; 
+      while (end < q->cell.nof_prb && end-prb < SRSLTE_CHEST_DL_GROUP_PRB && (!prb_mask || prb_mask[end])) {
+        end++; 
+      }
+      interp_group(q, pilots, ce, port_id, prb, end, sym0, sym1);
+      prb = end; 
+    }
+  }
+}
+
+/* Estimates and interpolates one PRB group at a time so that the pilots and the interpolated block 
+ * stay in cache between the smoothing, frequency and time interpolation */
+static void estimate_fused(srslte_chest_dl_t *q, cf_t *input, cf_t *ce, uint32_t sf_idx, uint32_t port_id) 
+{
+  uint32_t nref = 2*q->cell.nof_prb; 
+  cf_t *pilots = smooth_enabled(q)?q->pilot_estimates_average:q->pilot_estimates; 
+
+  for (uint32_t prb0=0;prb0<q->cell.nof_prb;prb0+=SRSLTE_CHEST_DL_GROUP_PRB) {
+    uint32_t prb1 = SRSLTE_MIN(prb0+SRSLTE_CHEST_DL_GROUP_PRB, q->cell.nof_prb); 
+    /* Frequency interpolation of the group needs one pilot at each side */
+    estimate_pilots(q, input, sf_idx, port_id, prb0>0?2*prb0-1:0, SRSLTE_MIN(2*prb1+1, nref));
+    interp_group(q, pilots, ce, port_id, prb0, prb1, 0, 2*SRSLTE_CP_NSYMB(q->cell.cp));
+  }
+}
+
+static uint32_t wiener_bin(srslte_chest_dl_t *q, uint32_t port_id, uint32_t rxant_id) 
+{
+  float noise = q->noise_estimate[rxant_id][port_id]/q->cell.nof_ports; 
+  if (noise <= 0) {
+    return SRSLTE_CHEST_DL_WIENER_NOF_BINS-1; 
+  }
+  float snr = q->rsrp[rxant_id][port_id]/noise-1; 
+  if (snr <= 0) {
+    return 0; 
+  }
+  int bin = (int) roundf((10*log10f(snr)-WIENER_SNR_MIN_DB)/WIENER_SNR_STEP_DB); 
+  return SRSLTE_MAX(0, SRSLTE_MIN(bin, SRSLTE_CHEST_DL_WIENER_NOF_BINS-1)); 
+}
+
+/* Central PRB carrying the PSS, used by the PSS noise estimation in lazy mode */
+static void pss_prb_mask(srslte_chest_dl_t *q, bool *prb_mask) 
+{
+  uint32_t k0 = q->cell.nof_prb*SRSLTE_NRE/2-SRSLTE_PSS_LEN/2; 
+  bzero(prb_mask, sizeof(bool)*q->cell.nof_prb);
+  for (uint32_t k=k0;k<k0+SRSLTE_PSS_LEN;k++) {
+    prb_mask[k/SRSLTE_NRE] = true; 
+  }
+}
+
 float srslte_chest_dl_rssi(srslte_chest_dl_t *q, cf_t *input, uint32_t port_id) {
   uint32_t l;
   
@@ -311,24 +772,63 @@ float srslte_chest_dl_rssi(srslte_chest_dl_t *q, cf_t *input, uint32_t port_id)
   return rssi/nsymbols; 
 }
 
-int srslte_chest_dl_estimate_port(srslte_chest_dl_t *q, cf_t *input, cf_t *ce, uint32_t sf_idx, uint32_t port_id, uint32_t rxant_id) 
+/* Pilot-domain estimation for the fused, Wiener and lazy modes */
+static void estimate_port_pilots(srslte_chest_dl_t *q, cf_t *input, cf_t *ce, uint32_t sf_idx, uint32_t port_id, uint32_t rxant_id) 
 {
-  /* Get references from the input signal */
-  srslte_refsignal_cs_get_sf(q->cell, port_id, input, q->pilot_recv_signal);
-  
-  /* Use the known CSR signal to compute Least-squares estimates */
-  srslte_vec_prod_conj_ccc(q->pilot_recv_signal, q->csr_signal.pilots[port_id/2][sf_idx], 
-              q->pilot_estimates, SRSLTE_REFSIGNAL_NUM_SF(q->cell.nof_prb, port_id)); 
-  if (ce != NULL) {
-    
-    /* Smooth estimates (if applicable) and interpolate */
-    if (q->smooth_filter_len == 0 || (q->smooth_filter_len == 3 && q->smooth_filter[0] == 0)) {
-      interpolate_pilots(q, q->pilot_estimates, ce, port_id);            
+  uint32_t nref = SRSLTE_REFSIGNAL_NUM_SF(q->cell.nof_prb, port_id); 
+
+  if (q->interp == SRSLTE_CHEST_DL_INTERP_FUSED && !q->lazy && ce != NULL) {
+    estimate_fused(q, input, ce, sf_idx, port_id);
+  } else {
+    estimate_pilots(q, input, sf_idx, port_id, 0, 2*q->cell.nof_prb);
+  }
+  q->rsrp[rxant_id][port_id] = srslte_vec_avg_power_cf(q->pilot_estimates, nref); 
+
+  if (ce != NULL && (q->lazy || q->interp == SRSLTE_CHEST_DL_INTERP_WIENER)) {
+    cf_t *pilots = q->pilot_estimates; 
+    if (q->interp != SRSLTE_CHEST_DL_INTERP_WIENER && smooth_enabled(q)) {
+      pilots = q->pilot_estimates_average; 
+    }
+    q->wiener_bin[rxant_id][port_id] = wiener_bin(q, port_id, rxant_id); 
+    if (q->lazy) {
+      memcpy(q->lazy_pilots[rxant_id][port_id], pilots, sizeof(cf_t)*nref); 
+      if (q->noise_alg == SRSLTE_NOISE_ALG_PSS && (sf_idx == 0 || sf_idx == 5)) {
+        bool prb_mask[SRSLTE_MAX_PRB]; 
+        pss_prb_mask(q, prb_mask);
+        srslte_chest_dl_interpolate_port(q, ce, port_id, rxant_id, SRSLTE_CP_NSYMB(q->cell.cp)-1, 1, prb_mask);
+      }
     } else {
-      average_pilots(q, q->pilot_estimates, q->pilot_estimates_average, port_id);
-      interpolate_pilots(q, q->pilot_estimates_average, ce, port_id);              
+      interp_prbs(q, pilots, ce, port_id, q->wiener_bin[rxant_id][port_id], 0, 2*SRSLTE_CP_NSYMB(q->cell.cp), NULL);
     }
+  }
+}
+
+int srslte_chest_dl_estimate_port(srslte_chest_dl_t *q, cf_t *input, cf_t *ce, uint32_t sf_idx, uint32_t port_id, uint32_t rxant_id) 
+{
+  if (q->interp != SRSLTE_CHEST_DL_INTERP_LINEAR || q->lazy) {
+    estimate_port_pilots(q, input, ce, sf_idx, port_id, rxant_id);
+  } else {
+    /* Get references from the input signal */
+    srslte_refsignal_cs_get_sf(q->cell, port_id, input, q->pilot_recv_signal);
     
+    /* Use the known CSR signal to compute Least-squares estimates */
+    srslte_vec_prod_conj_ccc(q->pilot_recv_signal, q->csr_signal.pilots[port_id/2][sf_idx], 
+                q->pilot_estimates, SRSLTE_REFSIGNAL_NUM_SF(q->cell.nof_prb, port_id)); 
+    if (ce != NULL) {
+      /* Smooth estimates (if applicable) and interpolate */
+      if (!smooth_enabled(q)) {
+        interpolate_pilots(q, q->pilot_estimates, ce, port_id);            
+      } else {
+        average_pilots(q, q->pilot_estimates, q->pilot_estimates_average, port_id);
+        interpolate_pilots(q, q->pilot_estimates_average, ce, port_id);              
+      }
+    }
+
+    /* Compute RSRP for the channel estimates in this port */
+    q->rsrp[rxant_id][port_id] = srslte_vec_avg_power_cf(q->pilot_recv_signal, SRSLTE_REFSIGNAL_NUM_SF(q->cell.nof_prb, port_id));     
+  }
+
+  if (ce != NULL) {
     /* Estimate noise power */
     if (q->noise_alg == SRSLTE_NOISE_ALG_REFS && q->smooth_filter_len > 0) {
       q->noise_estimate[rxant_id][port_id] = estimate_noise_pilots(q, port_id);                  
@@ -341,11 +841,8 @@ int srslte_chest_dl_estimate_port(srslte_chest_dl_t *q, cf_t *input, cf_t *ce, u
         q->noise_estimate[rxant_id][port_id] = estimate_noise_empty_sc(q, input);        
       }
     }
-    
   }
     
-  /* Compute RSRP for the channel estimates in this port */
-  q->rsrp[rxant_id][port_id] = srslte_vec_avg_power_cf(q->pilot_recv_signal, SRSLTE_REFSIGNAL_NUM_SF(q->cell.nof_prb, port_id));     
   if (port_id == 0) {
     /* compute rssi only for port 0 */
     q->rssi[rxant_id][port_id] = srslte_chest_dl_rssi(q, input, port_id);     
@@ -380,6 +877,39 @@ int srslte_chest_dl_estimate(srslte_chest_dl_t *q, cf_t *input, cf_t *ce[SRSLTE_
   return SRSLTE_SUCCESS;
 }
 
+int srslte_chest_dl_interpolate_port(srslte_chest_dl_t *q, cf_t *ce, uint32_t port_id, uint32_t rxant_id, 
+                                     uint32_t first_symbol, uint32_t nof_symbols, bool *prb_mask) 
+{
+  if (!q->lazy                                                  || 
+      ce == NULL                                                || 
+      port_id >= q->cell.nof_ports                              || 
+      rxant_id >= SRSLTE_MAX_PORTS                              || 
+      first_symbol+nof_symbols > 2*SRSLTE_CP_NSYMB(q->cell.cp)) 
+  {
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  interp_prbs(q, q->lazy_pilots[rxant_id][port_id], ce, port_id, q->wiener_bin[rxant_id][port_id], 
+              first_symbol, first_symbol+nof_symbols, prb_mask);
+  return SRSLTE_SUCCESS; 
+}
+
+/* Interpolates the pilots estimated in lazy mode by the last call to srslte_chest_dl_estimate_multi() 
+ * to the symbols [first_symbol, first_symbol+nof_symbols) of the PRB selected by prb_mask (all if NULL) */
+int srslte_chest_dl_interpolate(srslte_chest_dl_t *q, cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                uint32_t first_symbol, uint32_t nof_symbols, bool *prb_mask) 
+{
+  for (uint32_t rxant_id=0;rxant_id<q->last_nof_antennas;rxant_id++) {
+    for (uint32_t port_id=0;port_id<q->cell.nof_ports;port_id++) {
+      int ret = srslte_chest_dl_interpolate_port(q, ce[port_id][rxant_id], port_id, rxant_id, 
+                                                 first_symbol, nof_symbols, prb_mask); 
+      if (ret) {
+        return ret; 
+      }
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 float srslte_chest_dl_get_noise_estimate(srslte_chest_dl_t *q) {
   float n = 0; 
   for (int i=0;i<q->last_nof_antennas;i++) {
@@ -120,9 +120,6 @@ clean_exit:
 
 void srslte_chest_ul_free(srslte_chest_ul_t *q) 
 {
-  if (q->dmrs_signal_configured) {
-    srslte_refsignal_dmrs_pusch_pregen_free(&q->dmrs_signal, &q->dmrs_pregen);
-  }
   srslte_refsignal_ul_free(&q->dmrs_signal);
   if (q->tmp_noise) {
     free(q->tmp_noise);
@@ -152,7 +149,6 @@ void srslte_chest_ul_set_cfg(srslte_chest_ul_t *q,
                              srslte_refsignal_srs_cfg_t *srs_cfg)
 {
   srslte_refsignal_ul_set_cfg(&q->dmrs_signal, pusch_cfg, pucch_cfg, srs_cfg);
-  srslte_refsignal_dmrs_pusch_pregen(&q->dmrs_signal, &q->dmrs_pregen);
   q->dmrs_signal_configured = true; 
 }
 
@@ -245,8 +241,14 @@ int srslte_chest_ul_estimate(srslte_chest_ul_t *q, cf_t *input, cf_t *ce,
   /* Get references from the input signal */
   srslte_refsignal_dmrs_pusch_get(&q->dmrs_signal, input, nof_prb, n_prb, q->pilot_recv_signal);
   
+  /* Generate the known DMRS signal from the cached base sequences */
+  if (srslte_refsignal_dmrs_pusch_gen(&q->dmrs_signal, nof_prb, sf_idx, cyclic_shift_for_dmrs, q->pilot_known_signal)) {
+    fprintf(stderr, "Error generating PUSCH DMRS\n");
+    return SRSLTE_ERROR; 
+  }
+  
   /* Use the known DMRS signal to compute Least-squares estimates */
-  srslte_vec_prod_conj_ccc(q->pilot_recv_signal, q->dmrs_pregen.r[cyclic_shift_for_dmrs][sf_idx][nof_prb], 
+  srslte_vec_prod_conj_ccc(q->pilot_recv_signal, q->pilot_known_signal, 
                            q->pilot_estimates, nrefs_sf);
   
   if (n_prb[0] != n_prb[1]) {
@@ -209,6 +209,16 @@ int srslte_refsignal_ul_init(srslte_refsignal_ul_t * q, srslte_cell_t cell)
     if (srslte_pucch_n_cs_cell(q->cell, q->n_cs_cell)) {
       goto free_and_exit;
     }
+    
+    if (srslte_refsignal_ul_cache_init(&q->cache, q->cell.nof_prb, SRSLTE_REFSIGNAL_UL_CACHE_SIZE)) {
+      goto free_and_exit;
+    }
+    
+    for (uint32_t n_cs=0;n_cs<SRSLTE_NRE;n_cs++) {
+      for (uint32_t n=0;n<SRSLTE_NRE;n++) {
+        q->cshift_ramp[n_cs][n] = cexpf(I*2*M_PI*((n_cs*n)%SRSLTE_NRE)/SRSLTE_NRE);
+      }
+    }
 
     ret = SRSLTE_SUCCESS;
   }
@@ -223,6 +233,7 @@ void srslte_refsignal_ul_free(srslte_refsignal_ul_t * q) {
   if (q->tmp_arg) {
     free(q->tmp_arg);
   }
+  srslte_refsignal_ul_cache_free(&q->cache);
   bzero(q, sizeof(srslte_refsignal_ul_t));
 }
 
@@ -256,12 +267,6 @@ uint32_t largest_prime_lower_than(uint32_t x) {
   return 0;
 }
 
-static void arg_r_uv_2prb(float *arg, uint32_t u) {
-  for (int i = 0; i < 2*SRSLTE_NRE; i++) {
-    arg[i] = phi_M_sc_24[u][i] * M_PI / 4;
-  }  
-}
-
 static uint32_t get_q(uint32_t u, uint32_t v, uint32_t N_sz) {
   float q;
   float q_hat;
@@ -276,39 +281,137 @@ static uint32_t get_q(uint32_t u, uint32_t v, uint32_t N_sz) {
   return (uint32_t) q; 
 }
 
-static void arg_r_uv_mprb(float *arg, uint32_t M_sc, uint32_t u, uint32_t v) {
+#define R_UV_ROOTS_STEP 16
 
-  uint32_t N_sz = largest_prime_lower_than(M_sc);
-  if (N_sz > 0) {
-    float q = get_q(u,v,N_sz);
-    float n_sz = (float) N_sz;
-    for (uint32_t i = 0; i < M_sc; i++) {
-      float m = (float) (i%N_sz);
-      arg[i] =  -M_PI * q * m * (m + 1) / n_sz;
+/* Generates the base sequence r_uv of 5.5.1 of 36.211 for nof_prb PRB. 
+ * For 3 PRB or more the Zadoff-Chu phase q*m*(m+1)/2 is tracked modulo N_zc with integers, 
+ * so the sequence is exact for any length. The N_zc roots of unity it indexes are expanded 
+ * with vector products from one anchor every R_UV_ROOTS_STEP roots. 
+ */
+void srslte_refsignal_r_uv_gen(cf_t *r_uv, uint32_t nof_prb, uint32_t u, uint32_t v) 
+{
+  uint32_t M_sc = nof_prb*SRSLTE_NRE; 
+  if (nof_prb == 1) {
+    for (uint32_t i=0;i<M_sc;i++) {
+      r_uv[i] = cexpf(I*phi_M_sc_12[u][i]*M_PI/4);
+    }
+  } else if (nof_prb == 2) {
+    for (uint32_t i=0;i<M_sc;i++) {
+      r_uv[i] = cexpf(I*phi_M_sc_24[u][i]*M_PI/4);
+    }
+  } else {
+    uint32_t N_sz = largest_prime_lower_than(M_sc);
+    uint32_t q = get_q(u, v, N_sz)%N_sz;
+    cf_t roots[SRSLTE_NRE*SRSLTE_MAX_PRB];
+    cf_t step[R_UV_ROOTS_STEP];
+    
+    /* roots[k] = exp(-j*2*pi*k/N_zc) */
+    for (uint32_t i=0;i<R_UV_ROOTS_STEP;i++) {
+      step[i] = cexpf(-I*2*M_PI*i/N_sz);
+    }
+    for (uint32_t k=0;k<N_sz;k+=R_UV_ROOTS_STEP) {
+      srslte_vec_sc_prod_ccc(step, cexpf(-I*2*M_PI*k/N_sz), &roots[k], SRSLTE_MIN(R_UV_ROOTS_STEP, N_sz-k));
+    }
+    
+    /* x_q(m) = exp(-j*pi*q*m*(m+1)/N_zc) = roots[k_m] with k_m+1 = k_m + q*(m+1) mod N_zc */
+    uint32_t k = 0, d = 0; 
+    for (uint32_t m=0;m<N_sz;m++) {
+      r_uv[m] = roots[k]; 
+      d += q; 
+      if (d >= N_sz) {
+        d -= N_sz; 
+      }
+      k += d; 
+      if (k >= N_sz) {
+        k -= N_sz; 
+      }
+    }
+    /* Cyclic extension */
+    for (uint32_t m=N_sz;m<M_sc;m++) {
+      r_uv[m] = r_uv[m-N_sz];
     }
   }
 }
 
-/* Computes argument of r_u_v signal */
-static void compute_r_uv_arg(srslte_refsignal_ul_t *q, uint32_t nof_prb, uint32_t u, uint32_t v) {
-  if (nof_prb == 1) {
-    srslte_refsignal_r_uv_arg_1prb(q->tmp_arg, u);
-  } else if (nof_prb == 2) {
-    arg_r_uv_2prb(q->tmp_arg, u);
-  } else {
-    arg_r_uv_mprb(q->tmp_arg, SRSLTE_NRE*nof_prb, u, v);
+int srslte_refsignal_ul_cache_init(srslte_refsignal_ul_cache_t *q, uint32_t max_prb, uint32_t nof_entries) 
+{
+  int ret = SRSLTE_ERROR_INVALID_INPUTS; 
+  if (q && max_prb <= SRSLTE_MAX_PRB && nof_entries > 1) {
+    ret = SRSLTE_ERROR; 
+    bzero(q, sizeof(srslte_refsignal_ul_cache_t));
+    
+    q->entries = calloc(sizeof(srslte_refsignal_ul_cache_entry_t), nof_entries); 
+    if (!q->entries) {
+      perror("calloc");
+      goto clean_exit; 
+    }
+    q->nof_entries = nof_entries; 
+    for (uint32_t i=0;i<nof_entries;i++) {
+      q->entries[i].r_uv = srslte_vec_malloc(sizeof(cf_t)*SRSLTE_NRE*max_prb); 
+      if (!q->entries[i].r_uv) {
+        perror("malloc");
+        goto clean_exit; 
+      }
+    }
+    q->max_prb = max_prb; 
+    ret = SRSLTE_SUCCESS; 
   }
+clean_exit:
+  if (ret == SRSLTE_ERROR) {
+    srslte_refsignal_ul_cache_free(q);
+  }
+  return ret; 
 }
 
-/* Calculates alpha according to 5.5.2.1.1 of 36.211 */
-static float pusch_alpha(srslte_refsignal_ul_t *q, srslte_refsignal_dmrs_pusch_cfg_t *cfg, 
+void srslte_refsignal_ul_cache_free(srslte_refsignal_ul_cache_t *q) 
+{
+  if (q->entries) {
+    for (uint32_t i=0;i<q->nof_entries;i++) {
+      if (q->entries[i].r_uv) {
+        free(q->entries[i].r_uv);
+      }
+    }
+    free(q->entries);
+  }
+  bzero(q, sizeof(srslte_refsignal_ul_cache_t));
+}
+
+/* Returns the base sequence for (nof_prb, u, v), generating it in place of the least 
+ * recently used entry if it is not cached. The returned buffer is valid until 
+ * nof_entries-1 other sequences have been requested. 
+ */
+cf_t* srslte_refsignal_ul_cache_get(srslte_refsignal_ul_cache_t *q, uint32_t nof_prb, uint32_t u, uint32_t v) 
+{
+  if (nof_prb == 0 || nof_prb > q->max_prb || u >= SRSLTE_NOF_GROUPS_U || v >= SRSLTE_NOF_SEQUENCES_U) {
+    return NULL; 
+  }
+  srslte_refsignal_ul_cache_entry_t *lru = &q->entries[0]; 
+  for (uint32_t i=0;i<q->nof_entries;i++) {
+    srslte_refsignal_ul_cache_entry_t *e = &q->entries[i]; 
+    if (e->last_used && e->nof_prb == nof_prb && e->u == u && e->v == v) {
+      e->last_used = ++q->clock; 
+      q->nof_hits++; 
+      return e->r_uv; 
+    }
+    if (e->last_used < lru->last_used) {
+      lru = e; 
+    }
+  }
+  srslte_refsignal_r_uv_gen(lru->r_uv, nof_prb, u, v);
+  lru->nof_prb   = nof_prb; 
+  lru->u         = u; 
+  lru->v         = v; 
+  lru->last_used = ++q->clock; 
+  q->nof_misses++; 
+  return lru->r_uv; 
+}
+
+/* Calculates n_cs for alpha=2*pi*n_cs/12 according to 5.5.2.1.1 of 36.211 */
+static uint32_t pusch_n_cs(srslte_refsignal_ul_t *q, srslte_refsignal_dmrs_pusch_cfg_t *cfg, 
                            uint32_t cyclic_shift_for_dmrs, uint32_t ns) 
 {
   uint32_t n_dmrs_2_val = n_dmrs_2[cyclic_shift_for_dmrs];  
-  uint32_t n_cs = (n_dmrs_1[cfg->cyclic_shift] + n_dmrs_2_val + q->n_prs_pusch[cfg->delta_ss][ns]) % 12;
-  
-  return 2 * M_PI * (n_cs) / 12;
-
+  return (n_dmrs_1[cfg->cyclic_shift] + n_dmrs_2_val + q->n_prs_pusch[cfg->delta_ss][ns]) % 12;
 }
 
 bool srslte_refsignal_dmrs_pusch_cfg_isvalid(srslte_refsignal_ul_t *q, srslte_refsignal_dmrs_pusch_cfg_t *cfg, 
@@ -343,8 +446,8 @@ void srslte_refsignal_dmrs_pusch_get(srslte_refsignal_ul_t *q, cf_t *sf_symbols,
   }
 }
 
-/* Computes r sequence */
-void compute_r(srslte_refsignal_ul_t *q, uint32_t nof_prb, uint32_t ns, uint32_t delta_ss) {
+/* Returns the base sequence r_uv of slot ns from the cache */
+static cf_t* compute_r(srslte_refsignal_ul_t *q, uint32_t nof_prb, uint32_t ns, uint32_t delta_ss) {
   // Get group hopping number u 
   uint32_t f_gh=0; 
   if (q->pusch_cfg.group_hopping_en) {
@@ -358,9 +461,7 @@ void compute_r(srslte_refsignal_ul_t *q, uint32_t nof_prb, uint32_t ns, uint32_t
     v = q->v_pusch[ns][q->pusch_cfg.delta_ss];
   }
 
-  // Compute signal argument 
-  compute_r_uv_arg(q, nof_prb, u, v);
-
+  return srslte_refsignal_ul_cache_get(&q->cache, nof_prb, u, v);
 }
 
 int srslte_refsignal_dmrs_pusch_pregen(srslte_refsignal_ul_t *q, srslte_refsignal_ul_dmrs_pregen_t *pregen)
@@ -438,14 +539,16 @@ int srslte_refsignal_dmrs_pusch_gen(srslte_refsignal_ul_t *q, uint32_t nof_prb,
     
     for (uint32_t ns=2*sf_idx;ns<2*(sf_idx+1);ns++) {
       
-      compute_r(q, nof_prb, ns, q->pusch_cfg.delta_ss);
+      cf_t *r_uv = compute_r(q, nof_prb, ns, q->pusch_cfg.delta_ss);
+      if (!r_uv) {
+        return SRSLTE_ERROR; 
+      }
       
-      // Add cyclic prefix alpha
-      float alpha = pusch_alpha(q, &q->pusch_cfg, cyclic_shift_for_dmrs, ns);
-
-      // Do complex exponential and adjust amplitude
-      for (int i=0;i<SRSLTE_NRE*nof_prb;i++) {
-        r_pusch[(ns%2)*SRSLTE_NRE*nof_prb+i] = cexpf(I*(q->tmp_arg[i] + alpha*i));
+      // Add cyclic shift alpha. The phase ramp has period SRSLTE_NRE so it is applied PRB by PRB
+      uint32_t n_cs = pusch_n_cs(q, &q->pusch_cfg, cyclic_shift_for_dmrs, ns);
+      cf_t *r = &r_pusch[(ns%2)*SRSLTE_NRE*nof_prb]; 
+      for (uint32_t i=0;i<nof_prb;i++) {
+        srslte_vec_prod_ccc(&r_uv[i*SRSLTE_NRE], q->cshift_ramp[n_cs], &r[i*SRSLTE_NRE], SRSLTE_NRE);
       }      
     }
     ret = 0; 
@@ -520,6 +623,31 @@ uint32_t srslte_refsignal_dmrs_pucch_symbol(uint32_t m, srslte_pucch_format_t fo
   return 0; 
 }
 
+/* Argument of the orthogonal sequence of DMRS symbol m, Tables 5.5.2.2.1-2 and -3 of 36.211 */
+float srslte_refsignal_dmrs_pucch_w_arg(uint32_t m, uint32_t n_oc, srslte_pucch_format_t format, srslte_cp_t cp) {
+  switch (format) {
+    case SRSLTE_PUCCH_FORMAT_1:
+    case SRSLTE_PUCCH_FORMAT_1A:
+    case SRSLTE_PUCCH_FORMAT_1B:
+      if (SRSLTE_CP_ISNORM(cp)) {
+        return w_arg_pucch_format1_cpnorm[n_oc%3][m%3];
+      } else {
+        return w_arg_pucch_format1_cpext[n_oc%3][m%2];
+      }
+    case SRSLTE_PUCCH_FORMAT_2:
+      if (SRSLTE_CP_ISNORM(cp)) {
+        return w_arg_pucch_format2_cpnorm[m%2];
+      } else {
+        return w_arg_pucch_format2_cpext[0];
+      }
+    case SRSLTE_PUCCH_FORMAT_2A:
+    case SRSLTE_PUCCH_FORMAT_2B:
+      return w_arg_pucch_format2_cpnorm[m%2];
+    default:
+      return 0; 
+  }
+}
+
 /* Generates DMRS for PUCCH according to 5.5.2.2 in 36.211 */
 int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t *q, srslte_pucch_format_t format, uint32_t n_pucch, 
                                     uint32_t sf_idx, uint8_t pucch_bits[2], cf_t *r_pucch) 
@@ -529,6 +657,9 @@ int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t *q, srslte_pucch_forma
     ret = SRSLTE_ERROR;
     
     uint32_t N_rs=srslte_refsignal_dmrs_N_rs(format, q->cell.cp); 
+    if (!N_rs) {
+      return SRSLTE_ERROR; 
+    }
     
     cf_t z_m_1 = 1.0;     
     if (format == SRSLTE_PUCCH_FORMAT_2A || format == SRSLTE_PUCCH_FORMAT_2B) {
@@ -557,39 +688,13 @@ int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t *q, srslte_pucch_forma
           alpha = srslte_pucch_alpha_format2(q->n_cs_cell, &q->pucch_cfg, n_pucch, ns, l);
         }
 
-        // Choose number of symbols and orthogonal sequence from Tables 5.5.2.2.1-1 to -3 
-        float *w=NULL;
-        switch (format) {
-          case SRSLTE_PUCCH_FORMAT_1:
-          case SRSLTE_PUCCH_FORMAT_1A:
-          case SRSLTE_PUCCH_FORMAT_1B:
-            if (SRSLTE_CP_ISNORM(q->cell.cp)) {
-              w=w_arg_pucch_format1_cpnorm[n_oc];
-            } else {
-              w=w_arg_pucch_format1_cpext[n_oc];
-            }
-            break;
-          case SRSLTE_PUCCH_FORMAT_2:
-            if (SRSLTE_CP_ISNORM(q->cell.cp)) {
-              w=w_arg_pucch_format2_cpnorm;
-            } else {
-              w=w_arg_pucch_format2_cpext;
-            }
-            break;
-          case SRSLTE_PUCCH_FORMAT_2A:
-          case SRSLTE_PUCCH_FORMAT_2B:
-            w=w_arg_pucch_format2_cpnorm;
-            break;
-          default:
-            fprintf(stderr, "Unsupported format %d\n", format);
-            return SRSLTE_ERROR; 
-        }
+        float w = srslte_refsignal_dmrs_pucch_w_arg(m, n_oc, format, q->cell.cp);
         cf_t z_m = 1.0; 
         if (m == 1) {
           z_m = z_m_1; 
         }
         for (uint32_t n=0;n<SRSLTE_NRE;n++) {
-          r_pucch[(ns%2)*SRSLTE_NRE*N_rs+m*SRSLTE_NRE+n] = z_m*cexpf(I*(w[m]+q->tmp_arg[n]+alpha*n));
+          r_pucch[(ns%2)*SRSLTE_NRE*N_rs+m*SRSLTE_NRE+n] = z_m*cexpf(I*(w+q->tmp_arg[n]+alpha*n));
         }                                 
       }
     }
@@ -875,12 +980,14 @@ int srslte_refsignal_srs_gen(srslte_refsignal_ul_t *q, uint32_t sf_idx, cf_t *r_
     uint32_t M_sc = srslte_refsignal_srs_M_sc(q); 
     for (uint32_t ns=2*sf_idx;ns<2*(sf_idx+1);ns++) {
       
-      compute_r(q, M_sc/SRSLTE_NRE, ns, 0);
-      float alpha = 2*M_PI*q->srs_cfg.n_srs/8; 
+      cf_t *r_uv = compute_r(q, M_sc/SRSLTE_NRE, ns, 0);
+      if (!r_uv) {
+        return SRSLTE_ERROR; 
+      }
 
-      // Do complex exponential and adjust amplitude
+      // Add cyclic shift alpha=2*pi*n_srs/8
       for (int i=0;i<M_sc;i++) {
-        r_srs[(ns%2)*M_sc+i] = cexpf(I*(q->tmp_arg[i] + alpha*i));
+        r_srs[(ns%2)*M_sc+i] = r_uv[i]*cexpf(I*2*M_PI*((q->srs_cfg.n_srs*i)%8)/8);
       }     
     }
     ret = SRSLTE_SUCCESS; 
@@ -46,6 +46,7 @@ void usage(char *prog) {
 
   printf("\t-r nof_prb [Default %d]\n", cell.nof_prb);
   printf("\t-e extended cyclic prefix [Default normal]\n");
+  printf("\t-p nof_ports [Default %d]\n", cell.nof_ports);
 
   printf("\t-c cell_id (1000 tests all). [Default %d]\n", cell.id);
 
@@ -55,7 +56,7 @@ void usage(char *prog) {
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "recov")) != -1) {
+  while ((opt = getopt(argc, argv, "recovp")) != -1) {
     switch(opt) {
     case 'r':
       cell.nof_prb = atoi(argv[optind]);
@@ -63,6 +64,9 @@ void parse_args(int argc, char **argv) {
     case 'e':
       cell.cp = SRSLTE_CP_EXT;
       break;
+    case 'p':
+      cell.nof_ports = atoi(argv[optind]);
+      break;
     case 'c':
       cell.id = atoi(argv[optind]);
       break;
@@ -80,9 +84,88 @@ void parse_args(int argc, char **argv) {
 }
 
 
+static float max_error(cf_t *x, cf_t *y, uint32_t len) {
+  float err = 0; 
+  for (uint32_t i=0;i<len;i++) {
+    err = SRSLTE_MAX(err, cabsf(x[i]-y[i])); 
+  }
+  return err; 
+}
+
+/* The fused and the lazy estimation must produce the estimates of the separate passes */
+static int test_fused(srslte_chest_dl_t *est, cf_t *input, cf_t *ce, cf_t *ce2, uint32_t sf_idx, uint32_t port_id) {
+  uint32_t nre = cell.nof_prb * SRSLTE_NRE; 
+  uint32_t nsymb = 2*SRSLTE_CP_NSYMB(cell.cp); 
+  bool prb_mask[SRSLTE_MAX_PRB]; 
+
+  srslte_chest_dl_set_interp(est, SRSLTE_CHEST_DL_INTERP_FUSED);
+  srslte_chest_dl_estimate_port(est, input, ce2, sf_idx, port_id, 0);
+  float err = max_error(ce, ce2, nre*nsymb); 
+  printf("FUSED max error: %e\n", err);
+  if (err > 1e-4) {
+    return -1; 
+  }
+
+  for (uint32_t i=0;i<cell.nof_prb;i++) {
+    prb_mask[i] = (i%3) != 1; 
+  }
+  bzero(ce2, sizeof(cf_t) * nre*nsymb);
+  srslte_chest_dl_set_lazy(est, true);
+  srslte_chest_dl_estimate_port(est, input, ce2, sf_idx, port_id, 0);
+  srslte_chest_dl_interpolate_port(est, ce2, port_id, 0, 2, nsymb-2, prb_mask);
+  srslte_chest_dl_set_lazy(est, false);
+  srslte_chest_dl_set_interp(est, SRSLTE_CHEST_DL_INTERP_LINEAR);
+  for (uint32_t n=2;n<nsymb;n++) {
+    for (uint32_t i=0;i<cell.nof_prb;i++) {
+      float e = max_error(&ce[n*nre+i*SRSLTE_NRE], &ce2[n*nre+i*SRSLTE_NRE], SRSLTE_NRE); 
+      if ((prb_mask[i] && e > 1e-4) || (!prb_mask[i] && cabsf(ce2[n*nre+i*SRSLTE_NRE]) != 0)) {
+        printf("LAZY error at symbol %d, prb %d\n", n, i);
+        return -1; 
+      }
+    }
+  }
+  return 0; 
+}
+
+/* On a noisy multipath channel the Wiener interpolator must improve the linear estimates */
+static int test_wiener(srslte_chest_dl_t *est, cf_t *input, cf_t *ce, cf_t *h, uint32_t num_re) {
+  const float delay_us[4] = {-0.5, 0.0, 0.3, 1.0}; 
+  const float gain[4]     = {0.4, 0.8, 0.35, 0.2}; 
+  uint32_t nre = cell.nof_prb * SRSLTE_NRE; 
+  float mse[2]; 
+
+  for (uint32_t i=0;i<num_re;i++) {
+    h[i] = 0; 
+    for (uint32_t t=0;t<4;t++) {
+      h[i] += gain[t] * cexpf(I * (t - 2 * M_PI * 15e3 * delay_us[t] * 1e-6 * (i%nre))); 
+    }
+  }
+  bzero(input, sizeof(cf_t) * num_re);
+  srslte_refsignal_cs_put_sf(cell, 0, est->csr_signal.pilots[0][0], input);
+  srslte_vec_prod_ccc(input, h, input, num_re);
+  srslte_ch_awgn_c(input, input, 0.05, num_re);
+
+  for (int m=0;m<2;m++) {
+    if (srslte_chest_dl_set_interp(est, m?SRSLTE_CHEST_DL_INTERP_WIENER:SRSLTE_CHEST_DL_INTERP_LINEAR)) {
+      return -1; 
+    }
+    /* Second estimation uses the noise estimate of the first */
+    srslte_chest_dl_estimate_port(est, input, ce, 0, 0, 0);
+    srslte_chest_dl_estimate_port(est, input, ce, 0, 0, 0);
+    mse[m] = 0; 
+    for (uint32_t i=0;i<num_re;i++) {
+      mse[m] += crealf((ce[i]-h[i])*conjf(ce[i]-h[i])); 
+    }
+    mse[m] /= num_re; 
+  }
+  srslte_chest_dl_set_interp(est, SRSLTE_CHEST_DL_INTERP_LINEAR);
+  printf("LINEAR MSE: %f, WIENER MSE: %f\n", mse[0], mse[1]);
+  return mse[1] < mse[0]?0:-1; 
+}
+
 int main(int argc, char **argv) {
   srslte_chest_dl_t est;
-  cf_t *input = NULL, *ce = NULL, *h = NULL, *output = NULL;
+  cf_t *input = NULL, *ce = NULL, *ce2 = NULL, *h = NULL, *output = NULL;
   int i, j, n_port=0, sf_idx=0, cid=0, num_re;
   int ret = -1;
   int max_cid;
@@ -120,6 +203,11 @@ int main(int argc, char **argv) {
     perror("srslte_vec_malloc");
     goto do_exit;
   }
+  ce2 = srslte_vec_malloc(num_re * sizeof(cf_t));
+  if (!ce2) {
+    perror("srslte_vec_malloc");
+    goto do_exit;
+  }
 
   if (cell.id == 1000) {
     cid = 0;
@@ -200,6 +288,10 @@ int main(int argc, char **argv) {
         if (mse > 2.0) {
           goto do_exit;
         }
+
+        if (test_fused(&est, input, ce, ce2, sf_idx, n_port)) {
+          goto do_exit;
+        }
         
         if (fmatlab) {
           fprintf(fmatlab, "input=");
@@ -214,6 +306,9 @@ int main(int argc, char **argv) {
         }
       }
     }
+    if (test_wiener(&est, input, ce, h, num_re)) {
+      goto do_exit;
+    }
     srslte_chest_dl_free(&est);
     cid+=10;
     INFO("cid=%d\n", cid);
@@ -230,6 +325,9 @@ do_exit:
   if (ce) {
     free(ce);
   }
+  if (ce2) {
+    free(ce2);
+  }
   if (input) {
     free(input);
   }
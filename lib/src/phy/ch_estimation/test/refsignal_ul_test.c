@@ -29,6 +29,8 @@
 #include <strings.h>
 #include <unistd.h>
 #include <complex.h>
+#include <math.h>
+#include <sys/time.h>
 
 #include "srslte/srslte.h"
 
@@ -39,20 +41,23 @@ srslte_cell_t cell = {
   SRSLTE_CP_NORM        // cyclic prefix
 };
 
+bool sequences_only = false; 
+
 void usage(char *prog) {
-  printf("Usage: %s [recv]\n", prog);
+  printf("Usage: %s [recsv]\n", prog);
 
   printf("\t-r nof_prb [Default %d]\n", cell.nof_prb);
   printf("\t-e extended cyclic prefix [Default normal]\n");
 
   printf("\t-c cell_id (1000 tests all). [Default %d]\n", cell.id);
+  printf("\t-s only check the base sequences and the sequence cache [Default %s]\n", sequences_only?"yes":"no");
 
   printf("\t-v increase verbosity\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "recv")) != -1) {
+  while ((opt = getopt(argc, argv, "recsv")) != -1) {
     switch(opt) {
     case 'r':
       cell.nof_prb = atoi(argv[optind]);
@@ -63,6 +68,9 @@ void parse_args(int argc, char **argv) {
     case 'c':
       cell.id = atoi(argv[optind]);
       break;
+    case 's':
+      sequences_only = true;
+      break;
     case 'v':
       srslte_verbose++;
       break;
@@ -73,6 +81,118 @@ void parse_args(int argc, char **argv) {
   }
 }
 
+static bool is_prime(uint32_t n) {
+  for (uint32_t i=2;i*i<=n;i++) {
+    if (n%i == 0) {
+      return false; 
+    }
+  }
+  return n > 1; 
+}
+
+/* Compares the base sequences of 3 or more PRB against 5.5.1.1 of 36.211 in double precision */
+static int test_base_sequences(cf_t *r_uv) {
+  double max_err = 0; 
+  for (uint32_t nof_prb=3;nof_prb<=cell.nof_prb;nof_prb++) {
+    uint32_t M_sc = nof_prb*SRSLTE_NRE; 
+    uint32_t N_zc = M_sc-1; 
+    while (!is_prime(N_zc)) {
+      N_zc--;
+    }
+    for (uint32_t u=0;u<SRSLTE_NOF_GROUPS_U;u++) {
+      for (uint32_t v=0;v<(nof_prb<6?1:SRSLTE_NOF_SEQUENCES_U);v++) {
+        double q_hat = (double) N_zc*(u+1)/31; 
+        uint32_t q = (uint32_t) floor(q_hat+0.5); 
+        if (((uint32_t) floor(2*q_hat))%2) {
+          q -= v; 
+        } else {
+          q += v; 
+        }
+        srslte_refsignal_r_uv_gen(r_uv, nof_prb, u, v);
+        for (uint32_t n=0;n<M_sc;n++) {
+          double m = n%N_zc; 
+          double complex x = cexp(-I*M_PI*q*m*(m+1)/N_zc); 
+          double err = cabs(r_uv[n] - x); 
+          if (err > max_err) {
+            max_err = err; 
+          }
+        }
+      }
+    }
+  }
+  printf("Base sequences 3-%d PRB: max error %.2e\n", cell.nof_prb, max_err);
+  return max_err < 1e-5?0:-1; 
+}
+
+/* Checks the least-recently-used replacement of the sequence cache */
+static int test_cache() {
+  srslte_refsignal_ul_cache_t cache; 
+  uint32_t nof_prb[6] = {3, 4, 5, 6, 8, 9}; 
+  int ret = -1; 
+  
+  if (srslte_refsignal_ul_cache_init(&cache, 9, 4)) {
+    fprintf(stderr, "Error initializing sequence cache\n");
+    return -1; 
+  }
+  for (int i=0;i<4;i++) {
+    srslte_refsignal_ul_cache_get(&cache, nof_prb[i], 0, 0);
+  }
+  cf_t *r = srslte_refsignal_ul_cache_get(&cache, nof_prb[0], 0, 0);  // hit 
+  srslte_refsignal_ul_cache_get(&cache, nof_prb[4], 0, 0);             // evicts nof_prb[1]
+  if (srslte_refsignal_ul_cache_get(&cache, nof_prb[0], 0, 0) != r) {  // hit 
+    fprintf(stderr, "Most recently used sequence was evicted\n");
+    goto clean_exit; 
+  }
+  srslte_refsignal_ul_cache_get(&cache, nof_prb[1], 0, 0);             // miss 
+  srslte_refsignal_ul_cache_get(&cache, nof_prb[1], 0, 1);             // miss, other v
+  srslte_refsignal_ul_cache_get(&cache, nof_prb[1], 1, 0);             // miss, other u
+  if (cache.nof_hits != 2 || cache.nof_misses != 8) {
+    fprintf(stderr, "Cache hits=%d misses=%d, expected 2 and 8\n", cache.nof_hits, cache.nof_misses);
+    goto clean_exit; 
+  }
+  printf("Sequence cache: hits=%d, misses=%d\n", cache.nof_hits, cache.nof_misses);
+  ret = 0; 
+  
+clean_exit:
+  srslte_refsignal_ul_cache_free(&cache);
+  return ret; 
+}
+
+/* DMRS generation time for a full-band allocation, with the base sequences cached and without */
+static void time_dmrs(srslte_refsignal_ul_t *refs, cf_t *signal) {
+  srslte_refsignal_dmrs_pusch_cfg_t pusch_cfg; 
+  struct timeval t[3]; 
+  uint32_t nof_prb = cell.nof_prb; 
+  int nof_reps = 1000; 
+  
+  while (!srslte_dft_precoding_valid_prb(nof_prb)) {
+    nof_prb--; 
+  }
+  bzero(&pusch_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  pusch_cfg.group_hopping_en = true; 
+  srslte_refsignal_ul_set_cfg(refs, &pusch_cfg, NULL, NULL);
+  
+  gettimeofday(&t[1], NULL);
+  for (int i=0;i<nof_reps;i++) {
+    srslte_refsignal_dmrs_pusch_gen(refs, nof_prb, i%SRSLTE_NSUBFRAMES_X_FRAME, i%SRSLTE_NOF_CSHIFT, signal);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  float t_cached = (float) (t[0].tv_sec*1000000+t[0].tv_usec)/nof_reps; 
+  
+  gettimeofday(&t[1], NULL);
+  for (int i=0;i<nof_reps;i++) {
+    srslte_refsignal_r_uv_gen(signal, nof_prb, i%SRSLTE_NOF_GROUPS_U, 0);
+    srslte_refsignal_r_uv_gen(&signal[nof_prb*SRSLTE_NRE], nof_prb, (i+1)%SRSLTE_NOF_GROUPS_U, 0);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  float t_gen = (float) (t[0].tv_sec*1000000+t[0].tv_usec)/nof_reps; 
+  
+  printf("DMRS %d PRB: %.2f us/subframe from the cache, %.2f us/subframe generating the base sequences\n", 
+         nof_prb, t_cached, t_gen);
+}
+
 int main(int argc, char **argv) {
   srslte_refsignal_ul_t refs;
   srslte_refsignal_dmrs_pusch_cfg_t pusch_cfg;
@@ -92,6 +212,15 @@ int main(int argc, char **argv) {
     goto do_exit;
   }
   printf("Running tests for %d PRB\n", cell.nof_prb);
+  
+  if (test_base_sequences(signal) || test_cache()) {
+    goto do_exit; 
+  }
+  time_dmrs(&refs, signal);
+  if (sequences_only) {
+    ret = 0; 
+    goto do_exit; 
+  }
     
   for (int n=6;n<cell.nof_prb;n++) {
     for (int delta_ss=29;delta_ss<SRSLTE_NOF_DELTA_SS;delta_ss++) {
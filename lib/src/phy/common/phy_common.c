@@ -425,6 +425,8 @@ int srslte_str2mimotype(char *mimo_type_str, srslte_mimo_type_t *type) {
     *type = SRSLTE_MIMO_TYPE_TX_DIVERSITY;
   } else if (!strcmp(mimo_type_str, "multiplex")) {
     *type = SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX;
+  } else if (!strcmp(mimo_type_str, "cdd")) {
+    *type = SRSLTE_MIMO_TYPE_CDD;
   } else {
     return SRSLTE_ERROR;
   }
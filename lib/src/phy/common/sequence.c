@@ -40,39 +40,82 @@
  * Pseudo Random Sequence generation.
  * It follows the 3GPP Release 8 (LTE) 36.211
  * Section 7.2
+ *
+ * Each register holds 62 consecutive bits x(n)...x(n+61) of its m-sequence, x(n) in the MSB. 
+ * Squaring the generator polynomials gives x1(n+62) = x1(n+6) + x1(n) and 
+ * x2(n+62) = x2(n+6) + x2(n+4) + x2(n+2) + x2(n), so each step computes 32 new bits of both 
+ * registers with a few shifts and returns c(n)...c(n+31), c(n) in the MSB.
  */
-void srslte_sequence_set_LTE_pr(srslte_sequence_t *q, uint32_t seed) {
-  int n;
-  uint32_t *x1, *x2;
+#define SEQUENCE_WORD_MASK 0xffffffff00000000ULL
 
-  x1 = calloc(Nc + q->len + 31, sizeof(uint32_t));
-  if (!x1) {
-    perror("calloc");
-    return;
-  }
-  x2 = calloc(Nc + q->len + 31, sizeof(uint32_t));
-  if (!x2) {
-    free(x1);
-    perror("calloc");
-    return;
-  }
+static inline uint32_t sequence_gen_step(uint64_t *x1, uint64_t *x2) {
+  uint32_t c = (uint32_t) ((*x1 ^ *x2) >> 32);
+  uint64_t n1 = *x1 ^ (*x1 << 6);
+  uint64_t n2 = *x2 ^ (*x2 << 2) ^ (*x2 << 4) ^ (*x2 << 6);
+  *x1 = (*x1 << 32) | ((n1 & SEQUENCE_WORD_MASK) >> 30);
+  *x2 = (*x2 << 32) | ((n2 & SEQUENCE_WORD_MASK) >> 30);
+  return c;
+}
 
-  for (n = 0; n < 31; n++) {
+void srslte_sequence_gen_init(srslte_sequence_gen_t *g, uint32_t seed) {
+  uint8_t x1[62], x2[62];
+
+  for (int n = 0; n < 31; n++) {
+    x1[n] = n == 0;
     x2[n] = (seed >> n) & 0x1;
   }
-  x1[0] = 1;
-
-  for (n = 0; n < Nc + q->len; n++) {
+  for (int n = 0; n < 31; n++) {
     x1[n + 31] = (x1[n + 3] + x1[n]) & 0x1;
-    x2[n + 31] = (x2[n + 3] + x2[n + 2] + +x2[n+1] + x2[n]) & 0x1;
+    x2[n + 31] = (x2[n + 3] + x2[n + 2] + x2[n + 1] + x2[n]) & 0x1;
+  }
+  g->x1 = 0;
+  g->x2 = 0;
+  for (int n = 0; n < 62; n++) {
+    g->x1 |= (uint64_t) x1[n] << (63 - n);
+    g->x2 |= (uint64_t) x2[n] << (63 - n);
+  }
+  /* Advance Nc positions (Nc is a multiple of 32) */
+  for (int n = 0; n < Nc / 32; n++) {
+    sequence_gen_step(&g->x1, &g->x2);
+  }
+}
+
+uint32_t srslte_sequence_gen_next(srslte_sequence_gen_t *g) {
+  return sequence_gen_step(&g->x1, &g->x2);
+}
+
+/* Writes the next 32*nof_words bits of the sequence, one word per 32 bits, first bit in the MSB */
+void srslte_sequence_gen_words(srslte_sequence_gen_t *g, uint32_t *c, uint32_t nof_words) {
+  uint64_t x1 = g->x1, x2 = g->x2;
+  for (uint32_t i = 0; i < nof_words; i++) {
+    c[i] = sequence_gen_step(&x1, &x2);
   }
+  g->x1 = x1;
+  g->x2 = x2;
+}
 
-  for (n = 0; n < q->len; n++) {
-    q->c[n] = (x1[n + Nc] + x2[n + Nc]) & 0x1;
+/* Writes len bits of the sequence packed in bytes, first bit in the MSB */
+void srslte_sequence_LTE_pr_bytes(uint8_t *c_bytes, uint32_t len, uint32_t seed) {
+  srslte_sequence_gen_t g;
+  srslte_sequence_gen_init(&g, seed);
+  uint64_t x1 = g.x1, x2 = g.x2;
+  for (uint32_t i = 0; i < (len + 7) / 8; i += 4) {
+    uint32_t c = sequence_gen_step(&x1, &x2);
+    for (uint32_t j = 0; j < 4 && i + j < (len + 7) / 8; j++) {
+      c_bytes[i + j] = (uint8_t) (c >> (24 - 8 * j));
+    }
   }
+}
 
-  free(x1);
-  free(x2);
+void srslte_sequence_set_LTE_pr(srslte_sequence_t *q, uint32_t seed) {
+  srslte_sequence_gen_t g;
+  srslte_sequence_gen_init(&g, seed);
+  for (uint32_t n = 0; n < q->len; n += 32) {
+    uint32_t c = srslte_sequence_gen_next(&g);
+    for (uint32_t j = 0; j < 32 && n + j < q->len; j++) {
+      q->c[n + j] = (c >> (31 - j)) & 0x1;
+    }
+  }
 }
 
 int srslte_sequence_LTE_pr(srslte_sequence_t *q, uint32_t len, uint32_t seed) {
@@ -89,6 +89,31 @@ int srslte_dft_plan_r(srslte_dft_plan_t *plan, const int dft_points, srslte_dft_
   return 0;
 }
 
+/* Batched complex transform: nof_dft transforms whose inputs and outputs are in_dist and out_dist 
+ * samples apart, for instance the symbols of a slot read in place after their cyclic prefix. The 
+ * plan runs on the buffers passed to srslte_dft_run_batch_c(), which must have the same layout and
+ * alignment as in and out. Options (mirror, norm, dc...) are not applied.
+ */
+int srslte_dft_plan_batch_c(srslte_dft_plan_t *plan, const int dft_points, srslte_dft_dir_t dir, 
+                            int nof_dft, int in_dist, int out_dist, cf_t *in, cf_t *out) {
+  bzero(plan, sizeof(srslte_dft_plan_t));
+  int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
+  plan->p = fftwf_plan_many_dft(1, &dft_points, nof_dft, in, NULL, 1, in_dist, 
+                                out, NULL, 1, out_dist, sign, 0U);
+  if (!plan->p) {
+    return -1;
+  }
+  plan->size = dft_points;
+  plan->mode = SRSLTE_DFT_COMPLEX;
+  plan->dir = dir;
+  plan->forward = (dir==SRSLTE_DFT_FORWARD)?true:false;
+  plan->batch = true;
+  plan->in_align = fftwf_alignment_of((float*) in);
+  plan->out_align = fftwf_alignment_of((float*) out);
+  
+  return 0;
+}
+
 void srslte_dft_plan_set_mirror(srslte_dft_plan_t *plan, bool val){
   plan->mirror = val;
 }
@@ -160,6 +185,16 @@ void srslte_dft_run_c(srslte_dft_plan_t *plan, cf_t *in, cf_t *out) {
             plan->forward, plan->mirror, plan->dc);
 }
 
+/* Runs a batched plan. Returns -1 without transforming if the buffers do not have the alignment 
+ * of the ones used to create the plan */
+int srslte_dft_run_batch_c(srslte_dft_plan_t *plan, cf_t *in, cf_t *out) {
+  if (fftwf_alignment_of((float*) in) != plan->in_align || fftwf_alignment_of((float*) out) != plan->out_align) {
+    return -1;
+  }
+  fftwf_execute_dft(plan->p, in, out);
+  return 0;
+}
+
 void srslte_dft_run_r(srslte_dft_plan_t *plan, float *in, float *out) {
   float norm;
   int i;
@@ -80,8 +80,19 @@ void srslte_dft_precoding_free(srslte_dft_precoding_t  *q)
     if(srslte_dft_precoding_valid_prb(i)) {      
       srslte_dft_plan_free(&q->dft_plan[i]);
       srslte_dft_plan_free(&q->idft_plan[i]);        
+      for (uint32_t j=0;j<SRSLTE_DFT_PRECODING_NOF_BATCH;j++) {
+        if (q->idft_batch_nsymb[i][j]) {
+          srslte_dft_plan_free(&q->idft_batch[i][j]);
+        }
+      }
     }
   }  
+  if (q->batch_in) {
+    free(q->batch_in);
+  }
+  if (q->batch_out) {
+    free(q->batch_out);
+  }
   bzero(q, sizeof(srslte_dft_precoding_t));
 }
 
@@ -128,3 +139,61 @@ int srslte_dft_predecoding(srslte_dft_precoding_t *q, cf_t *input, cf_t *output,
   return SRSLTE_SUCCESS;
   
 }
+
+/* Returns the batched inverse plan for nof_prb PRB and nof_symbols symbols, creating it on first 
+ * use. Plans are created on the object's own buffers because FFTW overwrites them while planning. 
+ * Returns NULL if all the slots of this size are taken or the plan can not be created */
+static srslte_dft_plan_t *get_batch_plan(srslte_dft_precoding_t *q, uint32_t nof_prb, uint32_t nof_symbols) 
+{
+  for (uint32_t j=0;j<SRSLTE_DFT_PRECODING_NOF_BATCH;j++) {
+    if (q->idft_batch_nsymb[nof_prb][j] == nof_symbols) {
+      return &q->idft_batch[nof_prb][j];
+    }
+  }
+  for (uint32_t j=0;j<SRSLTE_DFT_PRECODING_NOF_BATCH;j++) {
+    if (!q->idft_batch_nsymb[nof_prb][j]) {
+      uint32_t max_len = q->max_prb*SRSLTE_NRE*SRSLTE_CP_NORM_NSYMB*2;
+      if (nof_symbols > 2*SRSLTE_CP_NORM_NSYMB) {
+        return NULL;
+      }
+      if (!q->batch_in) {
+        q->batch_in  = srslte_vec_malloc(sizeof(cf_t)*max_len);
+        q->batch_out = srslte_vec_malloc(sizeof(cf_t)*max_len);
+        if (!q->batch_in || !q->batch_out) {
+          perror("malloc");
+          return NULL;
+        }
+      }
+      uint32_t M = nof_prb*SRSLTE_NRE;
+      DEBUG("Initiating batched DFT predecoding plan for %d PRBs, %d symbols\n", nof_prb, nof_symbols);
+      if (srslte_dft_plan_batch_c(&q->idft_batch[nof_prb][j], M, SRSLTE_DFT_BACKWARD, nof_symbols, 
+                                  M, M, q->batch_in, q->batch_out)) {
+        return NULL; 
+      }
+      q->idft_batch_nsymb[nof_prb][j] = nof_symbols;
+      return &q->idft_batch[nof_prb][j];
+    }
+  }
+  return NULL;
+}
+
+/* Inverse transform of all the symbols with a single batched plan. Unlike srslte_dft_predecoding() 
+ * the output is not normalized, the caller shall scale it by 1/sqrt(nof_prb*SRSLTE_NRE). If the 
+ * batched plan can not be used the symbols are transformed one by one */
+int srslte_dft_predecoding_batch(srslte_dft_precoding_t *q, cf_t *input, cf_t *output, 
+                                 uint32_t nof_prb, uint32_t nof_symbols)
+{
+  if (!srslte_dft_precoding_valid_prb(nof_prb) || nof_prb > q->max_prb) {
+    fprintf(stderr, "Error invalid number of PRB (%d)\n", nof_prb);
+    return SRSLTE_ERROR; 
+  }
+  
+  srslte_dft_plan_t *plan = get_batch_plan(q, nof_prb, nof_symbols);
+  if (!plan || srslte_dft_run_batch_c(plan, input, output)) {
+    uint32_t M = nof_prb*SRSLTE_NRE;
+    srslte_dft_predecoding(q, input, output, nof_prb, nof_symbols);
+    srslte_vec_sc_prod_cfc(output, sqrtf(M), output, M*nof_symbols);
+  }
+  
+  return SRSLTE_SUCCESS;
+}
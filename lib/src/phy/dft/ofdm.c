@@ -36,6 +36,58 @@
 #include "srslte/phy/utils/debug.h"
 #include "srslte/phy/utils/vector.h"
 
+/* Creates the batched plan of the subframe engine. In the time domain, symbol l of a slot starts 
+ * cp0_len + l*(symbol_sz+cp_len) samples after the beginning of the slot, so the transform reads 
+ * (or writes) the symbols in place skipping the CP. In the frequency domain the symbols are 
+ * contiguous in sf_buffer. With extended CP the symbols of both slots are equally spaced and one 
+ * run covers the subframe, otherwise the plan covers a slot and runs twice. If the plan can not 
+ * be created the slot by slot path is used.
+ */
+static void ofdm_init_sf_engine(srslte_ofdm_t *q, srslte_dft_dir_t dir) {
+  uint32_t N = q->symbol_sz;
+  
+  q->cp0_len = SRSLTE_CP_ISNORM(q->cp)?SRSLTE_CP_LEN_NORM(0, N):SRSLTE_CP_LEN_EXT(N);
+  q->cp_len  = SRSLTE_CP_ISNORM(q->cp)?SRSLTE_CP_LEN_NORM(1, N):SRSLTE_CP_LEN_EXT(N);
+  if (q->cp0_len + q->nof_symbols*N + (q->nof_symbols-1)*q->cp_len != q->slot_sz) {
+    return; 
+  }
+  
+  q->sf_buffer = srslte_vec_malloc(sizeof(cf_t) * 2 * q->nof_symbols * N);
+  cf_t *time_buffer = srslte_vec_malloc(sizeof(cf_t) * 2 * q->slot_sz);
+  if (!q->sf_buffer || !time_buffer) {
+    perror("malloc");
+    goto clean_exit;
+  }
+  
+  int ret; 
+  q->sf_nof_runs = (q->cp0_len == q->cp_len)?1:2;
+  int nof_dft = 2*q->nof_symbols/q->sf_nof_runs; 
+  if (dir == SRSLTE_DFT_FORWARD) {
+    ret = srslte_dft_plan_batch_c(&q->sf_plan, N, dir, nof_dft, N+q->cp_len, N, 
+                                  &time_buffer[q->cp0_len], q->sf_buffer);
+  } else {
+    ret = srslte_dft_plan_batch_c(&q->sf_plan, N, dir, nof_dft, N, N+q->cp_len, 
+                                  q->sf_buffer, &time_buffer[q->cp0_len]);
+  }
+  if (ret) {
+    fprintf(stderr, "Warning: Creating subframe DFT plan, using slot by slot transforms\n");
+    goto clean_exit;
+  }
+  
+  /* Guard bands are never written */
+  bzero(q->sf_buffer, sizeof(cf_t) * 2 * q->nof_symbols * N);
+  q->sf_enabled = true;
+  
+clean_exit:
+  if (time_buffer) {
+    free(time_buffer);
+  }
+  if (!q->sf_enabled && q->sf_buffer) {
+    free(q->sf_buffer);
+    q->sf_buffer = NULL; 
+  }
+}
+
 int srslte_ofdm_init_(srslte_ofdm_t *q, srslte_cp_t cp, int symbol_sz, int nof_prb, srslte_dft_dir_t dir) {
 
   if (srslte_dft_plan_c(&q->fft_plan, symbol_sz, dir)) {
@@ -59,6 +111,10 @@ int srslte_ofdm_init_(srslte_ofdm_t *q, srslte_cp_t cp, int symbol_sz, int nof_p
   q->nof_re = nof_prb * SRSLTE_NRE;
   q->nof_guards = ((symbol_sz - q->nof_re) / 2);
   q->slot_sz = SRSLTE_SLOT_LEN(symbol_sz);
+  q->sf_enabled = false;
+  q->sf_buffer = NULL;
+  
+  ofdm_init_sf_engine(q, dir);
   
   DEBUG("Init %s symbol_sz=%d, nof_symbols=%d, cp=%s, nof_re=%d, nof_guards=%d\n",
       dir==SRSLTE_DFT_FORWARD?"FFT":"iFFT", q->symbol_sz, q->nof_symbols,
@@ -75,6 +131,10 @@ void srslte_ofdm_free_(srslte_ofdm_t *q) {
   if (q->shift_buffer) {
     free(q->shift_buffer);
   }
+  if (q->sf_buffer) {
+    free(q->sf_buffer);
+    srslte_dft_plan_free(&q->sf_plan);
+  }
   bzero(q, sizeof(srslte_ofdm_t));
 }
 
@@ -174,11 +234,44 @@ void srslte_ofdm_rx_slot_zerocopy(srslte_ofdm_t *q, cf_t *input, cf_t *output) {
   }  
 }
 
+/* Subframe engine receiver. The DC carrier (if any) and the guards are skipped while copying to the 
+ * resource grid, applying the normalization in the same pass. 
+ */
+static int ofdm_rx_sf_batch(srslte_ofdm_t *q, cf_t *input, cf_t *output) {
+  uint32_t N = q->symbol_sz; 
+  uint32_t half = q->nof_re/2; 
+  uint32_t offset = q->fft_plan.dc?1:0; 
+  float norm = 1.0/sqrtf(N);
+  
+  for (uint32_t n=0;n<q->sf_nof_runs;n++) {
+    if (srslte_dft_run_batch_c(&q->sf_plan, &input[n*q->slot_sz + q->cp0_len], 
+                               &q->sf_buffer[n*q->nof_symbols*N])) {
+      return -1; 
+    }
+  }
+  cf_t *symbol = q->sf_buffer; 
+  for (uint32_t l=0;l<2*q->nof_symbols;l++) {
+    if (q->fft_plan.norm) {
+      srslte_vec_sc_prod_cfc(&symbol[N-half], norm, output, half);
+      srslte_vec_sc_prod_cfc(&symbol[offset], norm, &output[half], half);
+    } else {
+      memcpy(output, &symbol[N-half], sizeof(cf_t)*half);
+      memcpy(&output[half], &symbol[offset], sizeof(cf_t)*half);
+    }
+    symbol += N; 
+    output += q->nof_re; 
+  }
+  return 0;
+}
+
 void srslte_ofdm_rx_sf(srslte_ofdm_t *q, cf_t *input, cf_t *output) {
   uint32_t n; 
   if (q->freq_shift) {
     srslte_vec_prod_ccc(input, q->shift_buffer, input, 2*q->slot_sz);
   }
+  if (q->sf_enabled && !ofdm_rx_sf_batch(q, input, output)) {
+    return; 
+  }
   for (n=0;n<2;n++) {
     srslte_ofdm_rx_slot(q, &input[n*q->slot_sz], &output[n*q->nof_re*q->nof_symbols]);
   }
@@ -204,10 +297,61 @@ void srslte_ofdm_set_normalize(srslte_ofdm_t *q, bool normalize_enable) {
   srslte_dft_plan_set_norm(&q->fft_plan, normalize_enable);
 }
 
+/* Enables or disables the subframe engine in srslte_ofdm_rx_sf() and srslte_ofdm_tx_sf(). It is 
+ * enabled by default when its plan could be created. 
+ */
+void srslte_ofdm_set_sf_engine(srslte_ofdm_t *q, bool enable) {
+  q->sf_enabled = enable && q->sf_buffer != NULL; 
+}
+
+/* Subframe engine transmitter. The resource grid is mapped to the carriers with the normalization
+ * in the same pass, all the symbols are transformed in place after their CP and then the CPs are 
+ * copied.  
+ */
+static int ofdm_tx_sf_batch(srslte_ofdm_t *q, cf_t *input, cf_t *output) {
+  uint32_t N = q->symbol_sz; 
+  uint32_t half = q->nof_re/2; 
+  uint32_t offset = q->fft_plan.dc?1:0; 
+  float norm = 1.0/sqrtf(N);
+  
+  cf_t *symbol = q->sf_buffer; 
+  for (uint32_t l=0;l<2*q->nof_symbols;l++) {
+    if (q->fft_plan.norm) {
+      srslte_vec_sc_prod_cfc(input, norm, &symbol[N-half], half);
+      srslte_vec_sc_prod_cfc(&input[half], norm, &symbol[offset], half);
+    } else {
+      memcpy(&symbol[N-half], input, sizeof(cf_t)*half);
+      memcpy(&symbol[offset], &input[half], sizeof(cf_t)*half);
+    }
+    /* The carrier not written depends on the DC mode, which may change after init */
+    symbol[offset?0:half] = 0; 
+    symbol += N; 
+    input += q->nof_re; 
+  }
+  for (uint32_t n=0;n<q->sf_nof_runs;n++) {
+    if (srslte_dft_run_batch_c(&q->sf_plan, &q->sf_buffer[n*q->nof_symbols*N], 
+                               &output[n*q->slot_sz + q->cp0_len])) {
+      return -1; 
+    }
+  }
+  
+  for (uint32_t n=0;n<2;n++) {
+    cf_t *ptr = &output[n*q->slot_sz];
+    for (uint32_t l=0;l<q->nof_symbols;l++) {
+      uint32_t cp_len = l?q->cp_len:q->cp0_len; 
+      memcpy(ptr, &ptr[N], cp_len * sizeof(cf_t));
+      ptr += N + cp_len; 
+    }
+  }
+  return 0; 
+}
+
 void srslte_ofdm_tx_sf(srslte_ofdm_t *q, cf_t *input, cf_t *output) {
   uint32_t n; 
-  for (n=0;n<2;n++) {
-    srslte_ofdm_tx_slot(q, &input[n*q->nof_re*q->nof_symbols], &output[n*q->slot_sz]);
+  if (!q->sf_enabled || ofdm_tx_sf_batch(q, input, output)) {
+    for (n=0;n<2;n++) {
+      srslte_ofdm_tx_slot(q, &input[n*q->nof_re*q->nof_symbols], &output[n*q->slot_sz]);
+    }
   }
   if (q->freq_shift) {
     srslte_vec_prod_ccc(output, q->shift_buffer, output, 2*q->slot_sz);
@@ -30,21 +30,24 @@
 #include <strings.h>
 #include <unistd.h>
 #include <math.h>
+#include <sys/time.h>
 
 #include "srslte/srslte.h"
 
 int nof_prb = -1;
 srslte_cp_t cp = SRSLTE_CP_NORM;
+int nof_repetitions = 0; 
 
 void usage(char *prog) {
   printf("Usage: %s\n", prog);
   printf("\t-n nof_prb [Default All]\n");
   printf("\t-e extended cyclic prefix [Default Normal]\n");
+  printf("\t-t nof_repetitions to report the subframe latency [Default %d]\n", nof_repetitions);
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "ne")) != -1) {
+  while ((opt = getopt(argc, argv, "net")) != -1) {
     switch (opt) {
     case 'n':
       nof_prb = atoi(argv[optind]);
@@ -52,6 +55,9 @@ void parse_args(int argc, char **argv) {
     case 'e':
       cp = SRSLTE_CP_EXT;
       break;
+    case 't':
+      nof_repetitions = atoi(argv[optind]);
+      break;
     default:
       usage(argv[0]);
       exit(-1);
@@ -59,6 +65,108 @@ void parse_args(int argc, char **argv) {
   }
 }
 
+/* Returns the largest difference between two vectors */
+float max_diff(cf_t *x, cf_t *y, int len) {
+  float max = 0; 
+  for (int i=0;i<len;i++) {
+    if (cabsf(x[i]-y[i]) > max) {
+      max = cabsf(x[i]-y[i]);
+    }
+  }
+  return max; 
+}
+
+/* Average time in microseconds of a subframe modulation and demodulation */
+void sf_latency(srslte_ofdm_t *fft, srslte_ofdm_t *ifft, cf_t *grid, cf_t *signal, bool engine) {
+  struct timeval t[3];
+  
+  srslte_ofdm_set_sf_engine(fft, engine);
+  srslte_ofdm_set_sf_engine(ifft, engine);
+  
+  gettimeofday(&t[1], NULL);
+  for (int i=0;i<nof_repetitions;i++) {
+    srslte_ofdm_tx_sf(ifft, grid, signal);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  float tx_us = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_repetitions;
+  
+  gettimeofday(&t[1], NULL);
+  for (int i=0;i<nof_repetitions;i++) {
+    srslte_ofdm_rx_sf(fft, signal, grid);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  float rx_us = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_repetitions;
+  
+  printf("  %s: tx_sf %.1f us, rx_sf %.1f us\n", engine?"subframe engine":"slot by slot   ", tx_us, rx_us);
+  
+  srslte_ofdm_set_sf_engine(fft, true);
+  srslte_ofdm_set_sf_engine(ifft, true);
+}
+
+/* Checks the subframe engine against the slot by slot transforms and a full subframe loopback */
+int test_sf(srslte_ofdm_t *fft, srslte_ofdm_t *ifft, int n_prb) {
+  int sf_re = SRSLTE_SF_LEN_RE(n_prb, cp);
+  int sf_len = SRSLTE_SF_LEN(srslte_symbol_sz(n_prb));
+  int ret = -1; 
+  
+  cf_t *grid = srslte_vec_malloc(sizeof(cf_t) * sf_re);
+  cf_t *grid_sf = srslte_vec_malloc(sizeof(cf_t) * sf_re);
+  cf_t *grid_slot = srslte_vec_malloc(sizeof(cf_t) * sf_re);
+  cf_t *signal_sf = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  cf_t *signal_slot = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  if (!grid || !grid_sf || !grid_slot || !signal_sf || !signal_slot) {
+    perror("malloc");
+    exit(-1);
+  }
+  if (!fft->sf_enabled || !ifft->sf_enabled) {
+    printf("Subframe engine not available\n");
+    goto clean_exit;
+  }
+  
+  for (int i=0;i<sf_re;i++) {
+    grid[i] = 100 * ((float) rand()/RAND_MAX + (float) I*rand()/RAND_MAX);
+  }
+  
+  srslte_ofdm_tx_sf(ifft, grid, signal_sf);
+  srslte_ofdm_set_sf_engine(ifft, false);
+  srslte_ofdm_tx_sf(ifft, grid, signal_slot);
+  srslte_ofdm_set_sf_engine(ifft, true);
+  float tx_diff = max_diff(signal_sf, signal_slot, sf_len);
+  
+  srslte_ofdm_rx_sf(fft, signal_sf, grid_sf);
+  srslte_ofdm_set_sf_engine(fft, false);
+  srslte_ofdm_rx_sf(fft, signal_sf, grid_slot);
+  srslte_ofdm_set_sf_engine(fft, true);
+  float rx_diff = max_diff(grid_sf, grid_slot, sf_re);
+  
+  float mse = 0;
+  for (int i=0;i<sf_re;i++) {
+    mse += cabsf(grid[i] - grid_sf[i]);
+  }
+  mse /= 2; 
+  printf("Subframe: MSE=%f, tx diff=%f, rx diff=%f\n", mse, tx_diff, rx_diff);
+  
+  if (mse >= 0.07 || tx_diff > 1e-3 || rx_diff > 1e-3) {
+    printf("Subframe engine mismatch\n");
+    goto clean_exit;
+  }
+  
+  if (nof_repetitions > 0) {
+    sf_latency(fft, ifft, grid, signal_sf, false);
+    sf_latency(fft, ifft, grid, signal_sf, true);
+  }
+  ret = 0; 
+  
+clean_exit:
+  free(grid);
+  free(grid_sf);
+  free(grid_slot);
+  free(signal_sf);
+  free(signal_slot);
+  return ret; 
+}
 
 int main(int argc, char **argv) {
   srslte_ofdm_t fft, ifft;
@@ -129,6 +237,10 @@ int main(int argc, char **argv) {
       exit(-1);
     }
 
+    if (test_sf(&fft, &ifft, n_prb)) {
+      exit(-1);
+    }
+
     srslte_ofdm_rx_free(&fft);
     srslte_ofdm_tx_free(&ifft);
 
@@ -279,3 +279,19 @@ int srslte_enb_dl_put_pdsch(srslte_enb_dl_t *q, srslte_ra_dl_grant_t *grant, srs
   }        
   return SRSLTE_SUCCESS; 
 }
+
+/* Same as srslte_enb_dl_put_pdsch() with the transport block given as a list of segments */
+int srslte_enb_dl_put_pdsch_iov(srslte_enb_dl_t *q, srslte_ra_dl_grant_t *grant, srslte_softbuffer_tx_t *softbuffer,
+                                uint16_t rnti, uint32_t rv_idx, uint32_t sf_idx, 
+                                srslte_tb_iov_t *tb) 
+{  
+  if (srslte_pdsch_cfg(&q->pdsch_cfg, q->cell, grant, q->cfi, sf_idx, rv_idx)) {
+    fprintf(stderr, "Error configuring PDSCH\n");
+    return SRSLTE_ERROR;
+  }
+  if (srslte_pdsch_encode_iov(&q->pdsch, &q->pdsch_cfg, softbuffer, tb, rnti, q->sf_symbols)) {
+    fprintf(stderr, "Error encoding PDSCH\n");
+    return SRSLTE_ERROR;
+  }        
+  return SRSLTE_SUCCESS; 
+}
@@ -115,6 +115,17 @@ int srslte_enb_ul_init(srslte_enb_ul_t *q, srslte_cell_t cell,
       perror("malloc");
       goto clean_exit; 
     }
+    
+    q->batch_cfg     = calloc(sizeof(srslte_pusch_cfg_t), q->cell.nof_prb);
+    q->batch_offset  = calloc(sizeof(uint32_t), q->cell.nof_prb);
+    q->batch_noise   = calloc(sizeof(float), q->cell.nof_prb);
+    q->batch_tb      = calloc(sizeof(int), q->cell.nof_prb);
+    q->batch_symbols = srslte_vec_malloc(CURRENT_SFLEN_RE * sizeof(cf_t));
+    q->batch_ce      = srslte_vec_malloc(CURRENT_SFLEN_RE * sizeof(cf_t));
+    if (!q->batch_cfg || !q->batch_offset || !q->batch_noise || !q->batch_tb || !q->batch_symbols || !q->batch_ce) {
+      perror("malloc");
+      goto clean_exit; 
+    }
         
     ret = SRSLTE_SUCCESS;
     
@@ -154,6 +165,27 @@ void srslte_enb_ul_free(srslte_enb_ul_t *q)
     if (q->ce) {
       free(q->ce);
     }
+    if (q->batch_cfg) {
+      free(q->batch_cfg);
+    }
+    if (q->batch_offset) {
+      free(q->batch_offset);
+    }
+    if (q->batch_noise) {
+      free(q->batch_noise);
+    }
+    if (q->batch_tb) {
+      free(q->batch_tb);
+    }
+    if (q->batch_symbols) {
+      free(q->batch_symbols);
+    }
+    if (q->batch_ce) {
+      free(q->batch_ce);
+    }
+    if (q->pucch_rx) {
+      free(q->pucch_rx);
+    }
     bzero(q, sizeof(srslte_enb_ul_t));
   }  
 }
@@ -288,13 +320,97 @@ int srslte_enb_ul_get_pucch(srslte_enb_ul_t *q, uint16_t rnti,
   }
 }
 
-int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srslte_softbuffer_rx_t *softbuffer, 
-                            uint16_t rnti, uint32_t rv_idx, uint32_t current_tx_nb, 
-                            uint8_t *data, srslte_uci_data_t *uci_data, uint32_t tti)
+/* Receives the PUCCH of several users at once with srslte_pucch_decode_multi(). Each user has 2 
+ * hypotheses: the resource given by its UCI and, when both SR and HARQ-ACK are expected, the 
+ * HARQ-ACK resource, which is used if no SR is detected (like in srslte_enb_ul_get_pucch()) */
+int srslte_enb_ul_get_pucch_multi(srslte_enb_ul_t *q, srslte_enb_ul_pucch_rx_t *rx, uint32_t nof_rx, uint32_t sf_rx)
+{
+  if (q == NULL || (rx == NULL && nof_rx > 0)) {
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  
+  if (2*nof_rx > q->max_pucch_rx) {
+    srslte_pucch_rx_t *tmp = realloc(q->pucch_rx, 2*nof_rx*sizeof(srslte_pucch_rx_t));
+    if (!tmp) {
+      perror("realloc");
+      return SRSLTE_ERROR; 
+    }
+    q->pucch_rx     = tmp; 
+    q->max_pucch_rx = 2*nof_rx; 
+  }
+  
+  for (uint32_t i=0;i<nof_rx;i++) {
+    srslte_pucch_rx_t *h = &q->pucch_rx[2*i];
+    srslte_uci_data_t *uci_data = rx[i].uci_data; 
+    h[0].format = SRSLTE_PUCCH_FORMAT_ERROR; 
+    h[1].format = SRSLTE_PUCCH_FORMAT_ERROR; 
+    if (!q->users[rx[i].rnti]) {
+      fprintf(stderr, "Error getting PUCCH: rnti=0x%x not found\n", rx[i].rnti);
+      continue; 
+    }
+    srslte_pucch_sched_t *pucch_sched = &q->users[rx[i].rnti]->pucch_sched; 
+    h[0].rnti    = rx[i].rnti; 
+    h[0].format  = srslte_pucch_get_format(uci_data, q->cell.cp);
+    h[0].n_pucch = srslte_pucch_get_npucch(rx[i].pdcch_n_cce, h[0].format, uci_data->scheduling_request, pucch_sched);
+    if (uci_data->scheduling_request && uci_data->uci_ack_len) {
+      h[1].rnti    = rx[i].rnti; 
+      h[1].format  = h[0].format; 
+      h[1].n_pucch = srslte_pucch_get_npucch(rx[i].pdcch_n_cce, h[1].format, false, pucch_sched);
+    }
+  }
+  
+  float noise_power = srslte_chest_ul_get_noise_estimate(&q->chest); 
+  if (srslte_pucch_decode_multi(&q->pucch, q->pucch_rx, 2*nof_rx, sf_rx, q->sf_symbols, noise_power)) {
+    fprintf(stderr,"Error decoding PUCCH\n");
+    return SRSLTE_ERROR; 
+  }
+  
+  for (uint32_t i=0;i<nof_rx;i++) {
+    srslte_pucch_rx_t *h = &q->pucch_rx[2*i];
+    srslte_uci_data_t *uci_data = rx[i].uci_data; 
+    
+    // If there is no SR, the HARQ-ACK is in its own resource 
+    if (h[1].format != SRSLTE_PUCCH_FORMAT_ERROR && h[0].ret != 1) {
+      uci_data->scheduling_request = false; 
+      h = &h[1];
+    }
+    rx[i].corr    = h->corr; 
+    rx[i].n_pucch = h->n_pucch; 
+    rx[i].n_prb   = h->n_prb; 
+    if (h->format == SRSLTE_PUCCH_FORMAT_ERROR || h->ret < 0) {
+      rx[i].ret = SRSLTE_ERROR; 
+      continue; 
+    }
+    
+    if (uci_data->scheduling_request) {
+      uci_data->scheduling_request = (h->ret==1); 
+    }
+    if (uci_data->uci_ack_len > 0) {
+      uci_data->uci_ack = h->bits[0];            
+      if (uci_data->uci_ack_len == 2) {
+        uci_data->uci_ack_2 = h->bits[1];
+      }
+    }
+    if (uci_data->uci_cqi_len) {
+      memcpy(uci_data->uci_cqi, h->bits, uci_data->uci_cqi_len*sizeof(uint8_t));
+      if (uci_data->uci_ack_len >= 1) {
+        uci_data->uci_ack = h->bits[20];
+      }
+      if (uci_data->uci_ack_len == 2) {
+        uci_data->uci_ack_2 = h->bits[21];
+      }
+    }
+    rx[i].ret = SRSLTE_SUCCESS; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+static int pusch_cfg_user(srslte_enb_ul_t *q, srslte_pusch_cfg_t *cfg, srslte_ra_ul_grant_t *grant, 
+                          uint16_t rnti, uint32_t rv_idx, uint32_t current_tx_nb, uint32_t tti) 
 {
   if (q->users[rnti]) {
     if (srslte_pusch_cfg(&q->pusch, 
-                        &q->pusch_cfg, 
+                        cfg, 
                         grant, 
                         q->users[rnti]->uci_cfg_en?&q->users[rnti]->uci_cfg:NULL, 
                         &q->hopping_cfg, 
@@ -305,7 +421,7 @@ int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srs
     }
   } else {
       if (srslte_pusch_cfg(&q->pusch, 
-                        &q->pusch_cfg, 
+                        cfg, 
                         grant, 
                         NULL, 
                         &q->hopping_cfg, 
@@ -315,6 +431,16 @@ int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srs
       return SRSLTE_ERROR;
     }
   }
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srslte_softbuffer_rx_t *softbuffer, 
+                            uint16_t rnti, uint32_t rv_idx, uint32_t current_tx_nb, 
+                            uint8_t *data, srslte_uci_data_t *uci_data, uint32_t tti)
+{
+  if (pusch_cfg_user(q, &q->pusch_cfg, grant, rnti, rv_idx, current_tx_nb, tti)) {
+    return SRSLTE_ERROR;
+  }
   
   uint32_t cyclic_shift_for_dmrs = 0; 
   
@@ -322,6 +448,8 @@ int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srs
   
   float noise_power = srslte_chest_ul_get_noise_estimate(&q->chest); 
   
+  srslte_sch_set_snr(&q->pusch.ul_sch, srslte_chest_ul_get_snr(&q->chest));
+  
   return srslte_pusch_decode(&q->pusch, &q->pusch_cfg, 
                               softbuffer, q->sf_symbols, 
                               q->ce, noise_power, 
@@ -329,6 +457,97 @@ int srslte_enb_ul_get_pusch(srslte_enb_ul_t *q, srslte_ra_ul_grant_t *grant, srs
                               uci_data);
 }
 
+/* Copies the data symbols and channel estimates of all the configured grants to batch_symbols and 
+ * batch_ce in a single pass over the resource grid. Each grant gets nbits.nof_re contiguous symbols 
+ * starting at batch_offset[i], in the same order as pusch_get(). Grants with an error (ret < 0) 
+ * are skipped */
+static void pusch_extract_multi(srslte_enb_ul_t *q, srslte_enb_ul_pusch_rx_t *rx, uint32_t nof_rx) 
+{
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  uint32_t L_ref = SRSLTE_CP_ISEXT(q->cell.cp)?2:3;
+  
+  for (uint32_t l=0;l<2*nsymb;l++) {
+    uint32_t slot = l/nsymb; 
+    uint32_t ls   = l%nsymb; 
+    if (ls == L_ref) {
+      continue; 
+    }
+    // Index of this symbol among the PUSCH data symbols
+    uint32_t k = slot*(nsymb-1) + ls - (ls > L_ref?1:0);
+    for (uint32_t i=0;i<nof_rx;i++) {
+      srslte_pusch_cfg_t *cfg = &q->batch_cfg[i];
+      if (rx[i].ret < 0 || k >= cfg->nbits.nof_symb) {
+        continue; 
+      }
+      uint32_t M   = cfg->grant.L_prb*SRSLTE_NRE;
+      uint32_t idx = SRSLTE_RE_IDX(q->cell.nof_prb, l, cfg->grant.n_prb_tilde[slot]*SRSLTE_NRE);
+      memcpy(&q->batch_symbols[q->batch_offset[i] + k*M], &q->sf_symbols[idx], M*sizeof(cf_t));
+      memcpy(&q->batch_ce[q->batch_offset[i] + k*M], &q->ce[idx], M*sizeof(cf_t));
+    }
+  }
+}
+
+/* Receives the PUSCH transmissions of several users in the same subframe. The channel of each grant 
+ * is estimated first, then the symbols of all of them are extracted in one pass over the grid and 
+ * each one is equalized, despread and rate-unmatched. The code blocks of all the grants are then 
+ * turbo decoded in one batch, see srslte_sch_batch_start(). Grants must not overlap. The result of 
+ * each grant is written to rx[i].ret, the function only fails on invalid inputs */
+int srslte_enb_ul_get_pusch_multi(srslte_enb_ul_t *q, srslte_enb_ul_pusch_rx_t *rx, uint32_t nof_rx, uint32_t tti)
+{
+  if (q == NULL || rx == NULL || nof_rx > q->cell.nof_prb) {
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  
+  uint32_t cyclic_shift_for_dmrs = 0; 
+  uint32_t offset = 0; 
+  for (uint32_t i=0;i<nof_rx;i++) {
+    rx[i].ret = SRSLTE_SUCCESS;
+    if (pusch_cfg_user(q, &q->batch_cfg[i], rx[i].grant, rx[i].rnti, rx[i].rv_idx, rx[i].current_tx_nb, tti) || 
+        offset + q->batch_cfg[i].nbits.nof_re > CURRENT_SFLEN_RE) 
+    {
+      rx[i].ret = SRSLTE_ERROR; 
+      continue; 
+    }
+    srslte_chest_ul_estimate(&q->chest, q->sf_symbols, q->ce, rx[i].grant->L_prb, tti%10, 
+                             cyclic_shift_for_dmrs, rx[i].grant->n_prb);
+    q->batch_noise[i]  = srslte_chest_ul_get_noise_estimate(&q->chest); 
+    rx[i].snr          = srslte_chest_ul_get_snr(&q->chest);
+    rx[i].n_prb_lowest = q->batch_cfg[i].grant.n_prb_tilde[0];
+    q->batch_offset[i] = offset; 
+    offset += q->batch_cfg[i].nbits.nof_re; 
+  }
+  
+  pusch_extract_multi(q, rx, nof_rx);
+  
+  srslte_sch_t *sch = &q->pusch.ul_sch; 
+  srslte_sch_batch_start(sch);
+  for (uint32_t i=0;i<nof_rx;i++) {
+    q->batch_tb[i] = -1; 
+    if (rx[i].ret == SRSLTE_SUCCESS) {
+      uint32_t nof_tb = srslte_sch_batch_nof_tb(sch); 
+      srslte_sch_set_snr(sch, rx[i].snr);
+      rx[i].ret = srslte_pusch_decode_symbols(&q->pusch, &q->batch_cfg[i], rx[i].softbuffer, 
+                                              &q->batch_symbols[q->batch_offset[i]], 
+                                              &q->batch_ce[q->batch_offset[i]], 
+                                              q->batch_noise[i], rx[i].rnti, rx[i].data, rx[i].uci_data);
+      if (srslte_sch_batch_nof_tb(sch) > nof_tb) {
+        q->batch_tb[i] = (int) nof_tb; 
+      } else {
+        // No data, an error or no room in the batch: already decoded
+        rx[i].nof_iterations = srslte_pusch_last_noi(&q->pusch);
+      }
+    }
+  }
+  
+  srslte_sch_batch_run(sch); 
+  for (uint32_t i=0;i<nof_rx;i++) {
+    if (q->batch_tb[i] >= 0) {
+      rx[i].ret            = srslte_sch_batch_result(sch, (uint32_t) q->batch_tb[i]);
+      rx[i].nof_iterations = srslte_pusch_last_noi(&q->pusch);
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
 
 int srslte_enb_ul_detect_prach(srslte_enb_ul_t *q, uint32_t tti, 
                                uint32_t freq_offset, cf_t *signal, 
@@ -31,6 +31,18 @@
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/fec/crc.h"
 
+/* The PCLMUL engine is built with its own target attribute, whatever the compiler flags are, and 
+ * only runs if CPUID reports PCLMUL and SSE4.1 (see srslte_crc_impl_available()) */
+#if defined(LV_HAVE_SSE) && defined(__GNUC__)
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#define CRC_HAVE_PCLMUL
+#define CRC_PCLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#endif
+
+// Buffers shorter than this are not worth the PCLMUL setup and go through slicing-by-8
+#define CRC_PCLMUL_MIN_BYTES 64
+
 void gen_crc_table(srslte_crc_t *h) {
 
   int i, j, ord = (h->order - 8);
@@ -48,6 +60,157 @@ void gen_crc_table(srslte_crc_t *h) {
   }
 }
 
+/* Slicing-by-8 tables for the CRC register left-aligned to 32 bits. table8[0] is the 
+ * byte-wise table, table8[k][i] advances table8[k-1][i] by one more zero byte. 
+ */
+static void gen_crc_table8(srslte_crc_t *h) {
+  uint32_t poly32 = ((uint32_t) h->polynom) << (32 - h->order);
+
+  for (int i = 0; i < 256; i++) {
+    uint32_t crc = ((uint32_t) i) << 24;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc & 0x80000000) ? (crc << 1) ^ poly32 : (crc << 1);
+    }
+    h->table8[0][i] = crc;
+  }
+  for (int k = 1; k < 8; k++) {
+    for (int i = 0; i < 256; i++) {
+      uint32_t crc = h->table8[k - 1][i];
+      h->table8[k][i] = (crc << 8) ^ h->table8[0][crc >> 24];
+    }
+  }
+}
+
+/* Returns x^n mod (polynom * x^(32-order)), used as PCLMUL folding constant */
+static uint64_t xpow_mod(srslte_crc_t *h, int n) {
+  uint32_t poly32 = ((uint32_t) h->polynom) << (32 - h->order);
+  uint64_t r = 1;
+  for (int i = 0; i < n; i++) {
+    r <<= 1;
+    if (r & 0x100000000) {
+      r = (r ^ poly32) & 0xffffffff;
+    }
+  }
+  return r;
+}
+
+static uint32_t crc_slice8(srslte_crc_t *h, uint32_t crc, const uint8_t *data, int nbytes) {
+  while (nbytes >= 8) {
+    uint32_t hi = crc ^ (((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | 
+                         ((uint32_t) data[2] << 8)  |  (uint32_t) data[3]);
+    uint32_t lo =        ((uint32_t) data[4] << 24) | ((uint32_t) data[5] << 16) | 
+                         ((uint32_t) data[6] << 8)  |  (uint32_t) data[7];
+    crc = h->table8[7][hi >> 24] ^ h->table8[6][(hi >> 16) & 0xff] ^ 
+          h->table8[5][(hi >> 8) & 0xff] ^ h->table8[4][hi & 0xff] ^ 
+          h->table8[3][lo >> 24] ^ h->table8[2][(lo >> 16) & 0xff] ^ 
+          h->table8[1][(lo >> 8) & 0xff] ^ h->table8[0][lo & 0xff];
+    data += 8;
+    nbytes -= 8;
+  }
+  while (nbytes--) {
+    crc = (crc << 8) ^ h->table8[0][(crc >> 24) ^ *data++];
+  }
+  return crc;
+}
+
+#ifdef CRC_HAVE_PCLMUL
+
+/* Carry-less multiply folding. The message is loaded as big-endian 128-bit polynomials, 
+ * four blocks are folded in parallel over 512 bits, then into a single block. The 
+ * remaining 128-bit value is congruent to the message modulo the polynomial and is 
+ * reduced together with the tail bytes using slicing-by-8. The initial register is 
+ * added to the first 32 message bits. Requires nbytes >= 64. 
+ */
+CRC_PCLMUL_TARGET static uint32_t crc_pclmul(srslte_crc_t *h, uint32_t crc, const uint8_t *data, int nbytes) {
+  const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const __m128i k512 = _mm_set_epi64x(h->fold_k[0], h->fold_k[1]);
+  const __m128i k128 = _mm_set_epi64x(h->fold_k[2], h->fold_k[3]);
+  __m128i x0, x1, x2, x3;
+
+#define CRC_LOAD(p)        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (p)), bswap)
+#define CRC_FOLD(x, k, b)  _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), \
+                                                       _mm_clmulepi64_si128(x, k, 0x00)), b)
+
+  x0 = _mm_xor_si128(CRC_LOAD(data), _mm_set_epi32(crc, 0, 0, 0));
+  x1 = CRC_LOAD(data + 16);
+  x2 = CRC_LOAD(data + 32);
+  x3 = CRC_LOAD(data + 48);
+  data += 64;
+  nbytes -= 64;
+
+  while (nbytes >= 64) {
+    x0 = CRC_FOLD(x0, k512, CRC_LOAD(data));
+    x1 = CRC_FOLD(x1, k512, CRC_LOAD(data + 16));
+    x2 = CRC_FOLD(x2, k512, CRC_LOAD(data + 32));
+    x3 = CRC_FOLD(x3, k512, CRC_LOAD(data + 48));
+    data += 64;
+    nbytes -= 64;
+  }
+
+  x0 = CRC_FOLD(x0, k128, x1);
+  x0 = CRC_FOLD(x0, k128, x2);
+  x0 = CRC_FOLD(x0, k128, x3);
+
+  while (nbytes >= 16) {
+    x0 = CRC_FOLD(x0, k128, CRC_LOAD(data));
+    data += 16;
+    nbytes -= 16;
+  }
+
+#undef CRC_LOAD
+#undef CRC_FOLD
+
+  uint8_t rem[16];
+  _mm_storeu_si128((__m128i*) rem, _mm_shuffle_epi8(x0, bswap));
+
+  crc = crc_slice8(h, 0, rem, 16);
+  return crc_slice8(h, crc, data, nbytes);
+}
+
+#endif /* CRC_HAVE_PCLMUL */
+
+bool srslte_crc_impl_available(srslte_crc_impl_t impl) {
+  switch (impl) {
+    case SRSLTE_CRC_AUTO:
+    case SRSLTE_CRC_TABLE:
+    case SRSLTE_CRC_SLICE8:
+      return true;
+#ifdef CRC_HAVE_PCLMUL
+    case SRSLTE_CRC_PCLMUL:
+      return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* srslte_crc_impl_string(srslte_crc_impl_t impl) {
+  switch (impl) {
+    case SRSLTE_CRC_AUTO:
+      return "Auto";
+    case SRSLTE_CRC_TABLE:
+      return "Table";
+    case SRSLTE_CRC_SLICE8:
+      return "Slice-by-8";
+    case SRSLTE_CRC_PCLMUL:
+      return "PCLMUL";
+    default:
+      return "Unknown";
+  }
+}
+
+int srslte_crc_set_impl(srslte_crc_t *h, srslte_crc_impl_t impl) {
+  if (!srslte_crc_impl_available(impl)) {
+    fprintf(stderr, "CRC implementation %s not available\n", srslte_crc_impl_string(impl));
+    return -1;
+  }
+  if (impl == SRSLTE_CRC_AUTO) {
+    impl = srslte_crc_impl_available(SRSLTE_CRC_PCLMUL) ? SRSLTE_CRC_PCLMUL : SRSLTE_CRC_SLICE8;
+  }
+  h->impl = impl;
+  return 0;
+}
+
 uint64_t crctable(srslte_crc_t *h, uint8_t byte) {
 
   // Polynom order 8, 16, 24 or 32 only.
@@ -105,8 +268,17 @@ int srslte_crc_init(srslte_crc_t *h, uint32_t crc_poly, int crc_order) {
     return -1;
   }
 
-  // generate lookup table
+  // generate lookup tables
   gen_crc_table(h);
+  gen_crc_table8(h);
+
+  // Folding constants for 512-bit and 128-bit strides
+  h->fold_k[0] = xpow_mod(h, 512 + 64);
+  h->fold_k[1] = xpow_mod(h, 512);
+  h->fold_k[2] = xpow_mod(h, 128 + 64);
+  h->fold_k[3] = xpow_mod(h, 128);
+
+  srslte_crc_set_impl(h, SRSLTE_CRC_AUTO);
 
   return 0;
 }
@@ -154,18 +326,54 @@ uint32_t srslte_crc_checksum(srslte_crc_t *h, uint8_t *data, int len) {
 uint32_t srslte_crc_checksum_byte(srslte_crc_t *h, uint8_t *data, int len) {
   int i;
   uint32_t crc = 0;
+  int nbytes = len / 8;
 
   srslte_crc_set_init(h, 0);
 
-  // Calculate CRC
-  for (i = 0; i < len/8; i++) {
-    crc = crctable(h, data[i]);
+  switch (h->impl) {
+#ifdef CRC_HAVE_PCLMUL
+    case SRSLTE_CRC_PCLMUL:
+      if (nbytes >= CRC_PCLMUL_MIN_BYTES) {
+        crc = crc_pclmul(h, 0, data, nbytes);
+      } else {
+        crc = crc_slice8(h, 0, data, nbytes);
+      }
+      break;
+#endif
+    case SRSLTE_CRC_SLICE8:
+      crc = crc_slice8(h, 0, data, nbytes);
+      break;
+    default:
+      for (i = 0; i < nbytes; i++) {
+        crc = crctable(h, data[i]);
+      }
+      return crc;
   }
 
+  // Keep the register in the same state the byte-wise update would leave it
+  crc >>= 32 - h->order;
+  h->crcinit = crc;
   return crc;
 
 }
 
+/* Incremental version of srslte_crc_checksum_byte() over nbytes packed bytes. crc is the 
+ * register returned by the previous call (0 for the first one), srslte_crc_final() 
+ * converts it to the checksum. Does not modify the state of h. 
+ */
+uint32_t srslte_crc_update_byte(srslte_crc_t *h, uint32_t crc, uint8_t *data, int nbytes) {
+#ifdef CRC_HAVE_PCLMUL
+  if (h->impl == SRSLTE_CRC_PCLMUL && nbytes >= CRC_PCLMUL_MIN_BYTES) {
+    return crc_pclmul(h, crc, data, nbytes);
+  }
+#endif
+  return crc_slice8(h, crc, data, nbytes);
+}
+
+uint32_t srslte_crc_final(srslte_crc_t *h, uint32_t crc) {
+  return crc >> (32 - h->order);
+}
+
 uint32_t srslte_crc_attach_byte(srslte_crc_t *h, uint8_t *data, int len) {
   uint32_t checksum = srslte_crc_checksum_byte(h, data, len);
 
@@ -121,13 +121,13 @@ int srslte_rm_conv_rx(float *input, uint32_t in_len, float *output, uint32_t out
     tmp[i] = SRSLTE_RX_NULL;
   }
 
-  /* Undo bit collection. Account for dummy bits */
+  /* Undo bit collection. Account for dummy bits. d_i and d_j are the column and row of 
+   * j % K_p, advanced incrementally to avoid two divisions per bit */
   k = 0;
   j = 0;
+  d_i = 0;
+  d_j = 0;
   while (k < in_len) {
-    d_i = (j % K_p) / nrows;
-    d_j = (j % K_p) % nrows;
-
     if (d_j * NCOLS + RM_PERM_CC[d_i] >= ndummy) {
       if (tmp[j] == SRSLTE_RX_NULL) {
         tmp[j] = input[k];
@@ -140,6 +140,14 @@ int srslte_rm_conv_rx(float *input, uint32_t in_len, float *output, uint32_t out
     if (j == 3 * K_p) {
       j = 0;
     }
+    d_j++;
+    if (d_j == nrows) {
+      d_j = 0;
+      d_i++;
+      if (d_i == NCOLS) {
+        d_i = 0;
+      }
+    }
   }
 
   /* interleaving and bit selection */
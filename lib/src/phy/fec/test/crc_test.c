@@ -31,6 +31,7 @@
 #include <unistd.h>
 #include <math.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "srslte/srslte.h"
 #include "crc_test.h"
@@ -38,18 +39,20 @@
 int num_bits = 5001, crc_length = 24;
 uint32_t crc_poly = 0x1864CFB;
 uint32_t seed = 1;
+bool bench = false; 
 
 void usage(char *prog) {
-  printf("Usage: %s [nlps]\n", prog);
+  printf("Usage: %s [nlpsb]\n", prog);
   printf("\t-n num_bits [Default %d]\n", num_bits);
   printf("\t-l crc_length [Default %d]\n", crc_length);
   printf("\t-p crc_poly (Hex) [Default 0x%x]\n", crc_poly);
   printf("\t-s seed [Default 0=time]\n");
+  printf("\t-b check all CRC implementations against each other and report throughput\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "nlps")) != -1) {
+  while ((opt = getopt(argc, argv, "nlpsb")) != -1) {
     switch (opt) {
     case 'n':
       num_bits = atoi(argv[optind]);
@@ -63,6 +66,9 @@ void parse_args(int argc, char **argv) {
     case 's':
       seed = (uint32_t) strtoul(argv[optind], NULL, 0);
       break;
+    case 'b':
+      bench = true;
+      break;
     default:
       usage(argv[0]);
       exit(-1);
@@ -70,6 +76,93 @@ void parse_args(int argc, char **argv) {
   }
 }
 
+#define BENCH_NOF_BYTES 6144
+#define BENCH_LOOPS     20000
+
+/* Compares the packed-byte checksum of every available implementation with the 
+ * byte-wise table for all lengths up to BENCH_NOF_BYTES, then measures throughput. 
+ */
+int run_bench() {
+  srslte_crc_t crc_p;
+  uint8_t *buffer = malloc(BENCH_NOF_BYTES);
+  int ret = -1;
+
+  if (!buffer) {
+    perror("malloc");
+    return -1;
+  }
+  for (int i = 0; i < BENCH_NOF_BYTES; i++) {
+    buffer[i] = rand() & 0xff;
+  }
+
+  if (srslte_crc_init(&crc_p, crc_poly, crc_length)) {
+    goto clean_exit;
+  }
+  printf("CRC%d poly=0x%x, default implementation: %s\n", crc_length, crc_poly, 
+         srslte_crc_impl_string(crc_p.impl));
+
+#if defined(__x86_64__) || defined(__i386__)
+  // The PCLMUL engine must be built and compared below on any CPU that can run it
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1") && 
+      !srslte_crc_impl_available(SRSLTE_CRC_PCLMUL)) {
+    fprintf(stderr, "PCLMUL supported by the CPU but not available\n");
+    goto clean_exit;
+  }
+#endif
+
+  for (srslte_crc_impl_t impl = SRSLTE_CRC_SLICE8; impl <= SRSLTE_CRC_PCLMUL; impl++) {
+    if (!srslte_crc_impl_available(impl)) {
+      continue;
+    }
+    for (int n = 0; n <= BENCH_NOF_BYTES; n += (n < 256) ? 1 : 97) {
+      srslte_crc_set_impl(&crc_p, SRSLTE_CRC_TABLE);
+      uint32_t expected = srslte_crc_checksum_byte(&crc_p, buffer, 8 * n);
+      srslte_crc_set_impl(&crc_p, impl);
+      uint32_t crc_word = srslte_crc_checksum_byte(&crc_p, buffer, 8 * n);
+      if (crc_word != expected) {
+        fprintf(stderr, "%s: mismatch for %d bytes 0x%x != 0x%x\n", 
+                srslte_crc_impl_string(impl), n, crc_word, expected);
+        goto clean_exit;
+      }
+      // Same checksum computed incrementally in two pieces
+      uint32_t reg = srslte_crc_update_byte(&crc_p, 0, buffer, n/3);
+      reg = srslte_crc_update_byte(&crc_p, reg, &buffer[n/3], n - n/3);
+      if (srslte_crc_final(&crc_p, reg) != expected) {
+        fprintf(stderr, "%s: incremental mismatch for %d bytes 0x%x != 0x%x\n", 
+                srslte_crc_impl_string(impl), n, srslte_crc_final(&crc_p, reg), expected);
+        goto clean_exit;
+      }
+    }
+  }
+
+  for (srslte_crc_impl_t impl = SRSLTE_CRC_TABLE; impl <= SRSLTE_CRC_PCLMUL; impl++) {
+    if (!srslte_crc_impl_available(impl)) {
+      continue;
+    }
+    srslte_crc_set_impl(&crc_p, impl);
+    int nbytes = num_bits / 8;
+    if (nbytes > BENCH_NOF_BYTES) {
+      nbytes = BENCH_NOF_BYTES;
+    }
+    volatile uint32_t acc = 0;
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    for (int l = 0; l < BENCH_LOOPS; l++) {
+      acc ^= srslte_crc_checksum_byte(&crc_p, buffer, 8 * nbytes);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    double secs = t[0].tv_sec + 1e-6 * t[0].tv_usec;
+    printf("%12s: %5d bytes, %7.1f ns/call, %6.2f GB/s\n", srslte_crc_impl_string(impl), nbytes, 
+           1e9 * secs / BENCH_LOOPS, (double) nbytes * BENCH_LOOPS / secs / 1e9);
+  }
+  ret = 0;
+
+clean_exit:
+  free(buffer);
+  return ret;
+}
+
 int main(int argc, char **argv) {
   int i;
   uint8_t *data;
@@ -104,6 +197,10 @@ int main(int argc, char **argv) {
 
   free(data);
 
+  if (bench && run_bench()) {
+    exit(-1);
+  }
+
   // check if generated word is as expected
   if (get_expected_word(num_bits, crc_length, crc_poly, seed,
       &expected_word)) {
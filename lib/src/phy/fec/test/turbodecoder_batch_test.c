@@ -0,0 +1,306 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "srslte/srslte.h"
+
+/* Decodes a batch of code blocks of random lengths, as the UEs scheduled in a TTI would produce,
+ * with srslte_tdec_run_batch() and one at a time, and compares CRC status and throughput */
+
+uint32_t nof_cb = 40;
+uint32_t max_long_cb = 1024;
+uint32_t nof_batches = 50;
+uint32_t nof_iterations = 8;
+float ebno_db = 5.0;
+uint32_t seed = 0;
+srslte_tdec_impl_t tdec_impl = SRSLTE_TDEC_AUTO;
+
+void usage(char *prog) {
+  printf("Usage: %s [cLnieps]\n", prog);
+  printf("\t-c number of code blocks per batch [Default %d]\n", nof_cb);
+  printf("\t-L maximum code block length [Default %d]\n", max_long_cb);
+  printf("\t-n number of batches [Default %d]\n", nof_batches);
+  printf("\t-i maximum number of iterations [Default %d]\n", nof_iterations);
+  printf("\t-e ebno in dB [Default %.1f]\n", ebno_db);
+  printf("\t-p implementation: 0 auto, 1 generic, 2 sse, 3 avx2, 4 avx512 [Default auto]\n");
+  printf("\t-s seed [Default 0=time]\n");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "cLniepsv")) != -1) {
+    switch (opt) {
+    case 'c':
+      nof_cb = atoi(argv[optind]);
+      break;
+    case 'L':
+      max_long_cb = atoi(argv[optind]);
+      break;
+    case 'n':
+      nof_batches = atoi(argv[optind]);
+      break;
+    case 'i':
+      nof_iterations = atoi(argv[optind]);
+      break;
+    case 'e':
+      ebno_db = atof(argv[optind]);
+      break;
+    case 'p':
+      tdec_impl = (srslte_tdec_impl_t) atoi(argv[optind]);
+      break;
+    case 's':
+      seed = (uint32_t) strtoul(argv[optind], NULL, 0);
+      break;
+    case 'v':
+      srslte_verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+/* Hands out the hard decisions of test_decision_crc_chunks(). Every call also flips the last byte 
+ * of the previous chunk: the CRC only ignores it if it was already updated over that chunk */
+typedef struct {
+  uint8_t *decision;
+  uint32_t next;
+  uint32_t nof_calls;
+  bool error;
+} chunk_decision_t;
+
+static uint32_t chunk_byte_diff(void *h, uint8_t *output, uint32_t first, uint32_t nbytes) {
+  chunk_decision_t *q = (chunk_decision_t*) h;
+  if (first != q->next || nbytes == 0 || nbytes > SRSLTE_TDEC_CRC_CHUNK) {
+    q->error = true;
+  }
+  if (first > 0) {
+    output[first-1] ^= 0xff;
+  }
+  memcpy(&output[first], &q->decision[first], nbytes);
+  q->next = first + nbytes;
+  q->nof_calls++;
+  return 0;
+}
+
+/* Checks that the fused decision and CRC updates the CRC chunk by chunk, as soon as each chunk is 
+ * decided, and that the result equals the CRC of the whole decision */
+static int test_decision_crc_chunks(srslte_crc_t *crc) {
+  uint8_t decision[SRSLTE_TCOD_MAX_LEN_CB/8];
+  uint8_t output[SRSLTE_TCOD_MAX_LEN_CB/8];
+  uint32_t long_cb = SRSLTE_TCOD_MAX_LEN_CB;
+  uint32_t len_crc[2] = {long_cb, long_cb - 8*(SRSLTE_TDEC_CRC_CHUNK + 3)};
+
+  for (uint32_t i = 0; i < long_cb/8; i++) {
+    decision[i] = rand() % 256;
+  }
+  for (uint32_t n = 0; n < 2; n++) {
+    chunk_decision_t q = {decision, 0, 0, false};
+    uint32_t nof_chunks = (long_cb/8 + SRSLTE_TDEC_CRC_CHUNK - 1)/SRSLTE_TDEC_CRC_CHUNK;
+    uint32_t c = srslte_tdec_decision_crc_chunks(chunk_byte_diff, &q, output, long_cb, crc, len_crc[n], NULL);
+    uint32_t expected = srslte_crc_checksum_byte(crc, decision, len_crc[n]);
+    if (q.error || q.nof_calls != nof_chunks || q.nof_calls < 2 || c != expected) {
+      printf("Error CRC over %d bits in %d chunks (expected %d): 0x%x != 0x%x\n",
+             len_crc[n], q.nof_calls, nof_chunks, c, expected);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  srslte_tdec_t tdec;
+  srslte_tcod_t tcod;
+  srslte_crc_t crc;
+  struct timeval t[3];
+  int ret = -1;
+
+  parse_args(argc, argv);
+
+  if (!seed) {
+    seed = time(NULL);
+  }
+  srand(seed);
+
+  if (nof_cb > SRSLTE_TDEC_MAX_BATCH || max_long_cb > SRSLTE_TCOD_MAX_LEN_CB) {
+    usage(argv[0]);
+    exit(-1);
+  }
+  uint32_t max_idx = srslte_cbsegm_cbindex(srslte_cbsegm_cbsize(srslte_cbsegm_cbindex(max_long_cb)));
+
+  srslte_tdec_cb_t *cb     = calloc(nof_cb, sizeof(srslte_tdec_cb_t));
+  uint8_t **data_tx        = calloc(nof_cb, sizeof(uint8_t*));
+  uint8_t **output_serial  = calloc(nof_cb, sizeof(uint8_t*));
+  uint8_t *bits            = srslte_vec_malloc(SRSLTE_TCOD_MAX_LEN_CB);
+  uint8_t *symbols         = srslte_vec_malloc(SRSLTE_TCOD_MAX_LEN_CODED);
+  float *llr               = srslte_vec_malloc(sizeof(float) * SRSLTE_TCOD_MAX_LEN_CODED);
+  if (!cb || !data_tx || !output_serial || !bits || !symbols || !llr) {
+    perror("malloc");
+    exit(-1);
+  }
+  for (uint32_t i = 0; i < nof_cb; i++) {
+    cb[i].input      = srslte_vec_malloc(sizeof(int16_t) * SRSLTE_TCOD_MAX_LEN_CODED);
+    cb[i].output     = srslte_vec_malloc(SRSLTE_TCOD_MAX_LEN_CB/8);
+    data_tx[i]       = srslte_vec_malloc(SRSLTE_TCOD_MAX_LEN_CB/8);
+    output_serial[i] = srslte_vec_malloc(SRSLTE_TCOD_MAX_LEN_CB/8);
+    if (!cb[i].input || !cb[i].output || !data_tx[i] || !output_serial[i]) {
+      perror("malloc");
+      exit(-1);
+    }
+  }
+
+  if (srslte_tcod_init(&tcod, SRSLTE_TCOD_MAX_LEN_CB)) {
+    fprintf(stderr, "Error initiating Turbo coder\n");
+    exit(-1);
+  }
+  if (srslte_tdec_init_impl(&tdec, SRSLTE_TCOD_MAX_LEN_CB, tdec_impl)) {
+    fprintf(stderr, "Error initiating Turbo decoder\n");
+    exit(-1);
+  }
+  if (srslte_crc_init(&crc, SRSLTE_LTE_CRC24B, 24)) {
+    fprintf(stderr, "Error initiating CRC\n");
+    exit(-1);
+  }
+
+  if (test_decision_crc_chunks(&crc)) {
+    goto clean_exit;
+  }
+
+  float esno_db = ebno_db + 10 * log10((double) 1 / 3);
+  float var = sqrt(1 / (pow(10, esno_db / 10)));
+
+  printf("  Decoder: %s, %d code blocks per batch up to %d bits, EbNo: %.2f\n",
+         srslte_tdec_impl_string(tdec.impl), nof_cb, srslte_cbsegm_cbsize(max_idx), ebno_db);
+
+  uint64_t nof_bits = 0, usec_batch = 0, usec_serial = 0;
+  uint32_t crc_batch = 0, crc_serial = 0, errors = 0, total = 0;
+
+  for (uint32_t n = 0; n < nof_batches; n++) {
+    /* Generate, attach CRC and encode the code blocks */
+    for (uint32_t i = 0; i < nof_cb; i++) {
+      cb[i].long_cb = srslte_cbsegm_cbsize(rand() % (max_idx + 1));
+      cb[i].crc     = &crc;
+      cb[i].len_crc = cb[i].long_cb;
+
+      for (uint32_t j = 0; j < cb[i].long_cb - 24; j++) {
+        bits[j] = rand() % 2;
+      }
+      srslte_crc_attach(&crc, bits, cb[i].long_cb - 24);
+      srslte_bit_pack_vector(bits, data_tx[i], cb[i].long_cb);
+
+      uint32_t coded_length = 3 * cb[i].long_cb + SRSLTE_TCOD_TOTALTAIL;
+      srslte_tcod_encode(&tcod, bits, symbols, cb[i].long_cb);
+      for (uint32_t j = 0; j < coded_length; j++) {
+        llr[j] = symbols[j] ? 1 : -1;
+      }
+      srslte_ch_awgn_f(llr, llr, var, coded_length);
+      for (uint32_t j = 0; j < coded_length; j++) {
+        cb[i].input[j] = (int16_t) (100*llr[j]);
+      }
+      nof_bits += cb[i].long_cb;
+    }
+
+    /* One code block at a time */
+    gettimeofday(&t[1], NULL);
+    for (uint32_t i = 0; i < nof_cb; i++) {
+      srslte_tdec_reset(&tdec, cb[i].long_cb);
+      uint32_t it = 0;
+      bool crc_ok = false;
+      do {
+        srslte_tdec_iteration(&tdec, cb[i].input, cb[i].long_cb);
+        srslte_tdec_decision_byte(&tdec, output_serial[i], cb[i].long_cb);
+        crc_ok = !srslte_crc_checksum_byte(&crc, output_serial[i], cb[i].long_cb);
+        it++;
+      } while (it < nof_iterations && !crc_ok);
+      crc_serial += crc_ok ? 1 : 0;
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec_serial += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+    /* Batch */
+    gettimeofday(&t[1], NULL);
+    if (srslte_tdec_run_batch(&tdec, cb, nof_cb, nof_iterations, false)) {
+      fprintf(stderr, "Error running batch\n");
+      goto clean_exit;
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    usec_batch += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+    for (uint32_t i = 0; i < nof_cb; i++) {
+      if (cb[i].crc_ok) {
+        crc_batch++;
+        /* A correct CRC must come with the transmitted data */
+        if (memcmp(cb[i].output, data_tx[i], cb[i].long_cb/8)) {
+          errors++;
+        }
+      }
+      total++;
+    }
+  }
+
+  printf("  Serial: %4d/%d CRC OK, %6.1f Mbps\n", crc_serial, total, (float) nof_bits / usec_serial);
+  printf("  Batch:  %4d/%d CRC OK, %6.1f Mbps\n", crc_batch, total, (float) nof_bits / usec_batch);
+
+  /* Lanes decode whole code blocks, so the batch must do at least as well as the serial decoder
+   * up to a few code blocks near the waterfall */
+  if (errors) {
+    printf("Error: %d code blocks with correct CRC and wrong data\n", errors);
+  } else if (crc_batch + total/100 < crc_serial) {
+    printf("Error: batch decoded %d code blocks less than serial\n", crc_serial - crc_batch);
+  } else {
+    ret = 0;
+  }
+
+clean_exit:
+  for (uint32_t i = 0; i < nof_cb; i++) {
+    free(cb[i].input);
+    free(cb[i].output);
+    free(data_tx[i]);
+    free(output_serial[i]);
+  }
+  free(cb);
+  free(data_tx);
+  free(output_serial);
+  free(bits);
+  free(symbols);
+  free(llr);
+  srslte_tdec_free(&tdec);
+  srslte_tcod_free(&tcod);
+
+  printf("%s\n", ret ? "Error" : "Ok");
+  exit(ret);
+}
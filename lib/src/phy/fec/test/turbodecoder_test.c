@@ -50,6 +50,9 @@ int nof_iterations = MAX_ITERATIONS;
 int test_known_data = 0;
 int test_errors = 0;
 int nof_repetitions = 1; 
+float llr_scale = 100; 
+srslte_tdec_impl_t tdec_impl = SRSLTE_TDEC_AUTO;
+bool test_all_impl = false;
 
 #define SNR_POINTS      4
 #define SNR_MIN         1.0
@@ -64,13 +67,16 @@ void usage(char *prog) {
   printf("\t-N nof_repetitions [Default %d]\n", nof_repetitions);
   printf("\t-l frame_length [Default %d]\n", frame_length);
   printf("\t-e ebno in dB [Default scan]\n");
+  printf("\t-x scale of the int16 LLR [Default %.0f]\n", llr_scale);
   printf("\t-t test: check errors on exit [Default disabled]\n");
   printf("\t-s seed [Default 0=time]\n");
+  printf("\t-p implementation: 0 auto, 1 generic, 2 sse, 3 avx2, 4 avx512 [Default auto]\n");
+  printf("\t-a run all available implementations and compare throughput [Default disabled]\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "inNlstvekt")) != -1) {
+  while ((opt = getopt(argc, argv, "inNlstvektpax")) != -1) {
     switch (opt) {
     case 'n':
       nof_frames = atoi(argv[optind]);
@@ -93,9 +99,18 @@ void parse_args(int argc, char **argv) {
     case 'e':
       ebno_db = atof(argv[optind]);
       break;
+    case 'x':
+      llr_scale = atof(argv[optind]);
+      break;
     case 's':
       seed = (uint32_t) strtoul(argv[optind], NULL, 0);
       break;
+    case 'p':
+      tdec_impl = (srslte_tdec_impl_t) atoi(argv[optind]);
+      break;
+    case 'a':
+      test_all_impl = true;
+      break;
     case 'v':
       srslte_verbose++;
       break;
@@ -112,7 +127,7 @@ int main(int argc, char **argv) {
   float *llr;
   short *llr_s;
   uint8_t *llr_c;
-  uint8_t *data_tx, *data_rx, *data_rx_bytes, *symbols;
+  uint8_t *data_tx, *data_rx, *data_rx_bytes, *data_rx_fused, *symbols;
   uint32_t i, j;
   float var[SNR_POINTS];
   uint32_t snr_points;
@@ -122,6 +137,7 @@ int main(int argc, char **argv) {
   float mean_usec;
   srslte_tdec_t tdec;
   srslte_tcod_t tcod;
+  srslte_crc_t crc;
   
   parse_args(argc, argv);
 
@@ -159,6 +175,14 @@ int main(int argc, char **argv) {
     perror("malloc");
     exit(-1);
   }
+  data_rx_fused = srslte_vec_malloc(frame_length * sizeof(uint8_t));
+  if (!data_rx_fused) {
+    perror("malloc");
+    exit(-1);
+  }
+  if (srslte_crc_init(&crc, SRSLTE_LTE_CRC24B, 24)) {
+    exit(-1);
+  }
 
   symbols = srslte_vec_malloc(coded_length * sizeof(uint8_t));
   if (!symbols) {
@@ -186,11 +210,6 @@ int main(int argc, char **argv) {
     exit(-1);
   }
 
-  if (srslte_tdec_init(&tdec, frame_length)) {
-    fprintf(stderr, "Error initiating Turbo decoder\n");
-    exit(-1);
-  }
-
   float ebno_inc, esno_db;
   ebno_inc = (SNR_MAX - SNR_MIN) / SNR_POINTS;
   if (ebno_db == 100.0) {
@@ -205,77 +224,128 @@ int main(int argc, char **argv) {
     var[0] = sqrt(1 / (pow(10, esno_db / 10)));
     snr_points = 1;
   }
-  for (i = 0; i < snr_points; i++) {
-
-    mean_usec = 0;
-    errors = 0; 
-    frame_cnt = 0;
-    while (frame_cnt < nof_frames) {
-      /* generate data_tx */
-      for (j = 0; j < frame_length; j++) {
+  srslte_tdec_impl_t impl_list[] = {SRSLTE_TDEC_GEN, SRSLTE_TDEC_SSE, SRSLTE_TDEC_AVX2, SRSLTE_TDEC_AVX512};
+  uint32_t nof_impl = sizeof(impl_list)/sizeof(srslte_tdec_impl_t);
+  float impl_mbps[sizeof(impl_list)/sizeof(srslte_tdec_impl_t)];
+  uint32_t impl_errors[sizeof(impl_list)/sizeof(srslte_tdec_impl_t)];
+  if (!test_all_impl) {
+    impl_list[0] = tdec_impl;
+    nof_impl = 1;
+  }
+
+  for (uint32_t n = 0; n < nof_impl; n++) {
+    impl_mbps[n] = 0;
+    if (!srslte_tdec_impl_available(impl_list[n])) {
+      continue;
+    }
+    if (srslte_tdec_init_impl(&tdec, frame_length, impl_list[n])) {
+      fprintf(stderr, "Error initiating Turbo decoder\n");
+      exit(-1);
+    }
+    printf("  Decoder: %s\n", srslte_tdec_impl_string(tdec.impl));
+
+    /* Same data for all implementations */
+    srand(seed);
+
+    for (i = 0; i < snr_points; i++) {
+
+      mean_usec = 0;
+      errors = 0; 
+      frame_cnt = 0;
+      while (frame_cnt < nof_frames) {
+        /* generate data_tx */
+        for (j = 0; j < frame_length; j++) {
+          if (test_known_data) {
+            data_tx[j] = known_data[j];
+          } else {
+            data_tx[j] = rand() % 2;
+          }
+        }
+
+        /* coded BER */
         if (test_known_data) {
-          data_tx[j] = known_data[j];
+          for (j = 0; j < coded_length; j++) {
+            symbols[j] = known_data_encoded[j];
+          }
         } else {
-          data_tx[j] = rand() % 2;
+          srslte_tcod_encode(&tcod, data_tx, symbols, frame_length);
         }
-      }
 
-      /* coded BER */
-      if (test_known_data) {
         for (j = 0; j < coded_length; j++) {
-          symbols[j] = known_data_encoded[j];
+          llr[j] = symbols[j] ? 1 : -1;
         }
-      } else {
-        srslte_tcod_encode(&tcod, data_tx, symbols, frame_length);
-      }
 
-      for (j = 0; j < coded_length; j++) {
-        llr[j] = symbols[j] ? 1 : -1;
-      }
+        srslte_ch_awgn_f(llr, llr, var[i], coded_length);
 
-      srslte_ch_awgn_f(llr, llr, var[i], coded_length);
+        for (j=0;j<coded_length;j++) {
+          float v = llr_scale*llr[j];
+          llr_s[j] = (int16_t) (v > 32767 ? 32767 : (v < -32767 ? -32767 : v));
+        }
+        /* decoder */
+        srslte_tdec_reset(&tdec, frame_length);
 
-      for (j=0;j<coded_length;j++) {
-        llr_s[j] = (int16_t) (100*llr[j]);
-      }
-      /* decoder */
-      srslte_tdec_reset(&tdec, frame_length);
-
-      uint32_t t;
-      if (nof_iterations == -1) {
-        t = MAX_ITERATIONS;
-      } else {
-        t = nof_iterations;
-      }
+        uint32_t t;
+        if (nof_iterations == -1) {
+          t = MAX_ITERATIONS;
+        } else {
+          t = nof_iterations;
+        }
 
-      gettimeofday(&tdata[1], NULL); 
-      for (int k=0;k<nof_repetitions;k++) {     
-        srslte_tdec_run_all(&tdec, llr_s, data_rx_bytes, t, frame_length);        
-      }
-      gettimeofday(&tdata[2], NULL);
-      get_time_interval(tdata);
-      mean_usec = (float) mean_usec * 0.9 + (float) (tdata[0].tv_usec/nof_repetitions) * 0.1;
+        gettimeofday(&tdata[1], NULL); 
+        for (int k=0;k<nof_repetitions;k++) {     
+          srslte_tdec_run_all(&tdec, llr_s, data_rx_bytes, t, frame_length);        
+        }
+        gettimeofday(&tdata[2], NULL);
+        get_time_interval(tdata);
+        mean_usec = (float) mean_usec * 0.9 + (float) (tdata[0].tv_usec/nof_repetitions) * 0.1;
       
-      srslte_bit_unpack_vector(data_rx_bytes, data_rx, frame_length);
+        /* Fused decision and CRC must match the separate ones and count the bits that changed */
+        uint32_t nof_changes, expected_changes = 0;
+        for (j = 0; j < frame_length/8; j++) {
+          data_rx_fused[j] = (uint8_t) (37*j + frame_cnt);
+          expected_changes += __builtin_popcount(data_rx_fused[j] ^ data_rx_bytes[j]);
+        }
+        uint32_t crc_rem = srslte_tdec_decision_crc(&tdec, data_rx_fused, frame_length, &crc, frame_length, &nof_changes);
+        if (memcmp(data_rx_fused, data_rx_bytes, frame_length/8) || nof_changes != expected_changes ||
+            crc_rem != srslte_crc_checksum_byte(&crc, data_rx_bytes, frame_length)) {
+          fprintf(stderr, "Error fused decision and CRC does not match (changes %d/%d)\n", nof_changes, expected_changes);
+          exit(-1);
+        }
+
+        srslte_bit_unpack_vector(data_rx_bytes, data_rx, frame_length);
 
-      errors += srslte_bit_diff(data_tx, data_rx, frame_length);
+        errors += srslte_bit_diff(data_tx, data_rx, frame_length);
       
-      frame_cnt++;
-      printf("Eb/No: %2.2f %10d/%d   ", SNR_MIN + i * ebno_inc, frame_cnt, nof_frames);
-      printf("BER: %.2e  ", (float) errors / (frame_cnt * frame_length));
-      printf("%3.1f Mbps (%6.2f usec)", (float) frame_length / mean_usec, mean_usec);
-      printf("\r");
+        frame_cnt++;
+        printf("Eb/No: %2.2f %10d/%d   ", SNR_MIN + i * ebno_inc, frame_cnt, nof_frames);
+        printf("BER: %.2e  ", (float) errors / (frame_cnt * frame_length));
+        printf("%3.1f Mbps (%6.2f usec)", (float) frame_length / mean_usec, mean_usec);
+        printf("\r");
+
+      }    
+      printf("\n");
+    }
+    impl_mbps[n] = (float) frame_length / mean_usec;
+    impl_errors[n] = errors;
 
-    }    
     printf("\n");
+    if (snr_points == 1) {
+      if (errors) {
+        printf("%d Errors\n", errors);
+      }
+    }    
+
+    srslte_tdec_free(&tdec);
   }
 
-  printf("\n");
-  if (snr_points == 1) {
-    if (errors) {
-      printf("%d Errors\n", errors);
+  if (test_all_impl) {
+    printf("\n");
+    for (uint32_t n = 0; n < nof_impl; n++) {
+      if (srslte_tdec_impl_available(impl_list[n])) {
+        printf("  %-8s %8.1f Mbps\n", srslte_tdec_impl_string(impl_list[n]), impl_mbps[n]);
+      }
     }
-  }    
+  }
 
 
   free(data_tx);
@@ -283,10 +353,28 @@ int main(int argc, char **argv) {
   free(llr);
   free(llr_c);
   free(data_rx);
+  free(data_rx_bytes);
+  free(data_rx_fused);
 
-  srslte_tdec_free(&tdec);
   srslte_tcod_free(&tcod);
 
+  if (test_errors && snr_points == 1 && !test_known_data) {
+    uint32_t t = (nof_iterations == -1) ? MAX_ITERATIONS : nof_iterations;
+    int expected_errors = get_expected_errors(nof_frames, seed, t, frame_length, ebno_db);
+    if (expected_errors == -1) {
+      fprintf(stderr, "Test parameters not defined in turbodecoder_test.h\n");
+      exit(-1);
+    }
+    bool failed = false;
+    for (uint32_t n = 0; n < nof_impl; n++) {
+      if (srslte_tdec_impl_available(impl_list[n])) {
+        printf("%s errors =%d, expected =%d\n", srslte_tdec_impl_string(impl_list[n]), impl_errors[n], expected_errors);
+        failed |= impl_errors[n] > (uint32_t) expected_errors;
+      }
+    }
+    exit(failed);
+  }
+
   printf("\n");
   printf("Done\n");
   exit(0);
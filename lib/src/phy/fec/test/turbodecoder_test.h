@@ -50,6 +50,13 @@ static expected_errors_t expected_errors[] = {
     { 100, 1, 2, 6144, 1.5, 897 },
     { 100, 1, 3, 6144, 1.5, 2 },
     { 100, 1, 4, 6144, 1.5, 0 },
+
+    /* Operating points run by ctest with -t, where all implementations decode without errors */
+    { 100, 1, 4, 504, 5.0, 0 },
+    { 100, 1, 10, 504, 4.5, 0 },
+    { 100, 1, 10, 504, 5.0, 0 },
+    { 100, 1, 4, 6144, 4.5, 0 },
+    { 100, 1, 10, 6144, 4.5, 0 },
     { -1, 0, -1, -1, -1.0, -1}
 };
 
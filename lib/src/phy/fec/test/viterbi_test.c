@@ -41,23 +41,30 @@ int frame_length = 1000, nof_frames = 128;
 float ebno_db = 100.0;
 uint32_t seed = 0;
 bool tail_biting = false;
+bool test_batch = false;
 
 #define SNR_POINTS  10
 #define SNR_MIN    0.0
 #define SNR_MAX    5.0
 
+uint8_t *batch_llr[SRSLTE_VITERBI_MAX_BATCH];
+uint8_t *batch_tx[SRSLTE_VITERBI_MAX_BATCH];
+uint8_t *batch_rx[SRSLTE_VITERBI_MAX_BATCH];
+uint8_t *batch_rx2[SRSLTE_VITERBI_MAX_BATCH];
+
 void usage(char *prog) {
-  printf("Usage: %s [nlest]\n", prog);
+  printf("Usage: %s [nlestb]\n", prog);
   printf("\t-n nof_frames [Default %d]\n", nof_frames);
   printf("\t-l frame_length [Default %d]\n", frame_length);
   printf("\t-e ebno in dB [Default scan]\n");
   printf("\t-s seed [Default 0=time]\n");
   printf("\t-t tail_bitting [Default %s]\n", tail_biting ? "yes" : "no");
+  printf("\t-b compare batched decoding against single decoding [Default %s]\n", test_batch ? "yes" : "no");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "nlste")) != -1) {
+  while ((opt = getopt(argc, argv, "nlsteb")) != -1) {
     switch (opt) {
     case 'n':
       nof_frames = atoi(argv[optind]);
@@ -74,6 +81,9 @@ void parse_args(int argc, char **argv) {
     case 't':
       tail_biting = true;
       break;
+    case 'b':
+      test_batch = true;
+      break;
     default:
       usage(argv[0]);
       exit(-1);
@@ -81,6 +91,38 @@ void parse_args(int argc, char **argv) {
   }
 }
 
+/* An all-zero codeword must be quantized to erasures, not divided by its zero peak */
+bool test_zero_llr(srslte_viterbi_t *dec, uint32_t coded_length) {
+  float   *zeros = calloc(coded_length, sizeof(float));
+  uint8_t *data  = malloc(frame_length * sizeof(uint8_t));
+  bool     valid;
+  bool     ret   = zeros && data && srslte_viterbi_decode_f_batch(dec, &zeros, &data, &valid, 1, frame_length) >= 0;
+  for (uint32_t j = 0; ret && j < coded_length; j++) {
+    ret = dec->symbols_uc[j] == 127;
+  }
+  free(zeros);
+  free(data);
+  return ret;
+}
+
+/* Decodes the last n frames with the batched decoder */
+int run_batch(srslte_viterbi_t *dec, uint32_t n, uint8_t **data, double *elapsed_us) {
+  bool valid[SRSLTE_VITERBI_MAX_BATCH];
+  struct timeval t[3];
+
+  gettimeofday(&t[1], NULL);
+  if (srslte_viterbi_decode_uc_batch(dec, batch_llr, data, valid, n, frame_length) != n) {
+    fprintf(stderr, "Error in batched decoder\n");
+    exit(-1);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  if (elapsed_us) {
+    *elapsed_us += t[0].tv_sec * 1e6 + t[0].tv_usec;
+  }
+  return 0;
+}
+
 int main(int argc, char **argv) {
   int frame_cnt;
   float *llr;
@@ -95,6 +137,11 @@ int main(int argc, char **argv) {
   srslte_viterbi_t dec_sse;
 #endif
   srslte_viterbi_t dec; 
+#ifdef LV_HAVE_AVX2
+  srslte_viterbi_t dec_gen;
+#endif
+  uint32_t errors_batch = 0, batch_mismatches = 0;
+  double single_us = 0, batch_us = 0;
   srslte_convcoder_t cod;
   int coded_length;
 
@@ -121,6 +168,27 @@ int main(int argc, char **argv) {
   srslte_viterbi_init_sse(&dec_sse, SRSLTE_VITERBI_37, cod.poly, frame_length, cod.tail_biting);
 #endif  
   
+  if (test_batch) {
+#ifdef LV_HAVE_AVX2
+    /* The SSE decoder runs the portable batched kernel */
+    srslte_viterbi_init_sse(&dec_gen, SRSLTE_VITERBI_37, cod.poly, frame_length, cod.tail_biting);
+#endif
+    for (i = 0; i < SRSLTE_VITERBI_MAX_BATCH; i++) {
+      batch_llr[i] = malloc(2 * coded_length * sizeof(uint8_t));
+      batch_tx[i] = malloc(frame_length * sizeof(uint8_t));
+      batch_rx[i] = malloc(frame_length * sizeof(uint8_t));
+      batch_rx2[i] = malloc(frame_length * sizeof(uint8_t));
+      if (!batch_llr[i] || !batch_tx[i] || !batch_rx[i] || !batch_rx2[i]) {
+        perror("malloc");
+        exit(-1);
+      }
+    }
+    if (!test_zero_llr(&dec, coded_length)) {
+      fprintf(stderr, "Error all-zero codeword not quantized to erasures\n");
+      exit(-1);
+    }
+  }
+
   printf("  Frame length: %d\n", frame_length);
   if (ebno_db < 100.0) {
     printf("  EbNo: %.2f\n", ebno_db);
@@ -218,6 +286,11 @@ int main(int argc, char **argv) {
       for (int i=0;i<M;i++) {
         srslte_viterbi_decode_uc(&dec, llr_c, data_rx, frame_length);      
       }
+      if (test_batch) {
+        gettimeofday(&t[2], NULL);
+        get_time_interval(t);
+        single_us += t[0].tv_sec * 1e6 + t[0].tv_usec;
+      }
             
 #ifdef TEST_SSE
       gettimeofday(&t[2], NULL);
@@ -234,6 +307,23 @@ int main(int argc, char **argv) {
 
       /* check errors */
       errors += srslte_bit_diff(data_tx, data_rx, frame_length);
+      if (test_batch) {
+        uint32_t b = frame_cnt % SRSLTE_VITERBI_MAX_BATCH;
+        memcpy(batch_llr[b], llr_c, coded_length * sizeof(uint8_t));
+        memcpy(batch_tx[b], data_tx, frame_length * sizeof(uint8_t));
+        if (b == SRSLTE_VITERBI_MAX_BATCH - 1 || frame_cnt == nof_frames - 1) {
+          run_batch(&dec, b + 1, batch_rx, &batch_us);
+#ifdef LV_HAVE_AVX2
+          run_batch(&dec_gen, b + 1, batch_rx2, NULL);
+          for (j = 0; j <= b; j++) {
+            batch_mismatches += memcmp(batch_rx[j], batch_rx2[j], frame_length) != 0;
+          }
+#endif
+          for (j = 0; j <= b; j++) {
+            errors_batch += srslte_bit_diff(batch_tx[j], batch_rx[j], frame_length);
+          }
+        }
+      }
 #ifdef TEST_SSE
       errors2 += srslte_bit_diff(data_tx, data_rx2, frame_length);
 #endif      
@@ -247,6 +337,12 @@ int main(int argc, char **argv) {
     }
     printf("\n");
     
+    if (test_batch) {
+      printf("BER batch: %g\t%u errors, single %.2f us/cw, batched %.2f us/cw\n", 
+             (float) errors_batch / (frame_cnt * frame_length), errors_batch, single_us / nof_frames, batch_us / nof_frames);
+      single_us = 0;
+      batch_us = 0;
+    }
     if (snr_points == 1) {
       printf("BER    :    %g\t%u errors\n", (float) errors / (frame_cnt * frame_length), errors);      
 #ifdef TEST_SSE
@@ -256,6 +352,21 @@ int main(int argc, char **argv) {
     }
   }
   srslte_viterbi_free(&dec);
+  if (test_batch) {
+#ifdef LV_HAVE_AVX2
+    srslte_viterbi_free(&dec_gen);
+#endif
+    for (i = 0; i < SRSLTE_VITERBI_MAX_BATCH; i++) {
+      free(batch_llr[i]);
+      free(batch_tx[i]);
+      free(batch_rx[i]);
+      free(batch_rx2[i]);
+    }
+    if (batch_mismatches) {
+      printf("%d codewords differ between the SIMD and the generic batched decoders\n", batch_mismatches);
+      exit(-1);
+    }
+  }
 #ifdef TEST_SSE  
   srslte_viterbi_free(&dec_sse);
 #endif
@@ -273,6 +384,10 @@ int main(int argc, char **argv) {
       exit(-1);
     } else {
       printf("errors =%d, expected =%d\n", errors, expected_errors);
+      if (test_batch) {
+        printf("errors batch =%d, expected =%d\n", errors_batch, expected_errors);
+        exit(errors > expected_errors || errors_batch > expected_errors);
+      }
       exit(errors > expected_errors);
     }
   } else {
@@ -190,23 +190,20 @@ int srslte_tcod_encode_lut(srslte_tcod_t *h, uint8_t *input, uint8_t *parity, ui
       return -1; 
     }
     
-    /* Parity bits for the 1st constituent encoders */
-    uint8_t state0 = 0;   
-    for (uint32_t i=0;i<long_cb/8;i++) {
-      parity[i] = tcod_lut_output[cblen_idx][state0][input[i]];    
-      state0 = tcod_lut_next_state[cblen_idx][state0][input[i]] % 8;
-    }
-    parity[long_cb/8] = 0;  // will put tail here later
-    
     /* Interleave input */  
     srslte_bit_interleave(input, h->temp, tcod_per_fw[cblen_idx], long_cb);
 
-    /* Parity bits for the 2nd constituent encoders */
+    /* Parity bits for the 1st and 2nd constituent encoders. Both state recursions run 
+     * in the same loop so that their table lookups overlap */
+    uint8_t state0 = 0;   
     uint8_t state1 = 0;
+    parity[long_cb/8] = 0;  // will put tail here later
     for (uint32_t i=0;i<long_cb/8;i++) {
       uint8_t out = tcod_lut_output[cblen_idx][state1][h->temp[i]];    
+      parity[i] = tcod_lut_output[cblen_idx][state0][input[i]];    
       parity[long_cb/8+i] |= (out&0xf0)>>4;
       parity[long_cb/8+i+1] = (out&0xf)<<4; 
+      state0 = tcod_lut_next_state[cblen_idx][state0][input[i]] % 8;
       state1 = tcod_lut_next_state[cblen_idx][state1][h->temp[i]] % 8;
     }
 
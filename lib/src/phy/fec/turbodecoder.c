@@ -38,75 +38,314 @@
 #include "srslte/phy/fec/turbodecoder_sse.h"
 #endif
 
+#ifdef LV_HAVE_AVX2
+#include "srslte/phy/fec/turbodecoder_avx.h"
+#endif
+
 #include "srslte/phy/utils/vector.h"
 
 
-int srslte_tdec_init(srslte_tdec_t * h, uint32_t max_long_cb) {
+bool srslte_tdec_impl_available(srslte_tdec_impl_t impl) {
+  switch(impl) {
+    case SRSLTE_TDEC_AUTO:
+      return true;
 #ifdef LV_HAVE_SSE
-  return srslte_tdec_sse_init(&h->tdec_sse, max_long_cb);
+    case SRSLTE_TDEC_SSE:
+      return true;
 #else
-  h->input_conv = srslte_vec_malloc(sizeof(float) * (3*max_long_cb+12));
-  if (!h->input_conv) {
-    perror("malloc");
+    case SRSLTE_TDEC_GEN:
+      return true;
+#endif
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+#ifdef LV_HAVE_AVX512
+    case SRSLTE_TDEC_AVX512:
+      return __builtin_cpu_supports("avx512bw");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* srslte_tdec_impl_string(srslte_tdec_impl_t impl) {
+  switch(impl) {
+    case SRSLTE_TDEC_AUTO:
+      return "Auto";
+    case SRSLTE_TDEC_GEN:
+      return "Generic";
+    case SRSLTE_TDEC_SSE:
+      return "SSE";
+    case SRSLTE_TDEC_AVX2:
+      return "AVX2";
+    case SRSLTE_TDEC_AVX512:
+      return "AVX512";
+    default:
+      return "Unknown";
+  }
+}
+
+/* Selects the widest implementation that was compiled in and the CPU supports */
+static srslte_tdec_impl_t tdec_impl_auto() {
+  if (srslte_tdec_impl_available(SRSLTE_TDEC_AVX512)) {
+    return SRSLTE_TDEC_AVX512;
+  } else if (srslte_tdec_impl_available(SRSLTE_TDEC_AVX2)) {
+    return SRSLTE_TDEC_AVX2;
+  } else if (srslte_tdec_impl_available(SRSLTE_TDEC_SSE)) {
+    return SRSLTE_TDEC_SSE;
+  } else {
+    return SRSLTE_TDEC_GEN;
+  }
+}
+
+int srslte_tdec_init(srslte_tdec_t * h, uint32_t max_long_cb) {
+  return srslte_tdec_init_impl(h, max_long_cb, SRSLTE_TDEC_AUTO);
+}
+
+int srslte_tdec_init_impl(srslte_tdec_t * h, uint32_t max_long_cb, srslte_tdec_impl_t impl) {
+  if (impl == SRSLTE_TDEC_AUTO) {
+    impl = tdec_impl_auto();
+  }
+  if (!srslte_tdec_impl_available(impl)) {
+    fprintf(stderr, "Turbo decoder implementation %s not available\n", srslte_tdec_impl_string(impl));
     return -1;
   }
-  return srslte_tdec_gen_init(&h->tdec_gen, max_long_cb);
+  h->impl = impl;
+
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+      return srslte_tdec_avx_init(&h->tdec_avx, max_long_cb, 2);
+    case SRSLTE_TDEC_AVX512:
+      return srslte_tdec_avx_init(&h->tdec_avx, max_long_cb, 4);
 #endif
+    default:
+#ifdef LV_HAVE_SSE
+      return srslte_tdec_sse_init(&h->tdec_sse, max_long_cb);
+#else
+      h->input_conv = srslte_vec_malloc(sizeof(float) * (3*max_long_cb+12));
+      if (!h->input_conv) {
+        perror("malloc");
+        return -1;
+      }
+      return srslte_tdec_gen_init(&h->tdec_gen, max_long_cb);
+#endif
+  }
 }
 
 void srslte_tdec_free(srslte_tdec_t * h) {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      srslte_tdec_avx_free(&h->tdec_avx);
+      break;
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  srslte_tdec_sse_free(&h->tdec_sse);
+      srslte_tdec_sse_free(&h->tdec_sse);
 #else
-  if (h->input_conv) {
-    free(h->input_conv);
-  }
-  srslte_tdec_gen_free(&h->tdec_gen);
+      if (h->input_conv) {
+        free(h->input_conv);
+      }
+      srslte_tdec_gen_free(&h->tdec_gen);
 #endif
-
+      break;
+  }
 }
 
 int srslte_tdec_reset(srslte_tdec_t * h, uint32_t long_cb) {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      return srslte_tdec_avx_reset(&h->tdec_avx, long_cb);
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  return srslte_tdec_sse_reset(&h->tdec_sse, long_cb);
+      return srslte_tdec_sse_reset(&h->tdec_sse, long_cb);
 #else
-  return srslte_tdec_gen_reset(&h->tdec_gen, long_cb);
+      return srslte_tdec_gen_reset(&h->tdec_gen, long_cb);
 #endif
+  }
 }
 
 void srslte_tdec_iteration(srslte_tdec_t * h, int16_t* input, uint32_t long_cb) {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      srslte_tdec_avx_iteration(&h->tdec_avx, input, long_cb);
+      break;
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  srslte_tdec_sse_iteration(&h->tdec_sse, input, long_cb);
+      srslte_tdec_sse_iteration(&h->tdec_sse, input, long_cb);
 #else
-  srslte_vec_convert_if(input, h->input_conv, 0.01, 3*long_cb+12);
-  srslte_tdec_gen_iteration(&h->tdec_gen, h->input_conv, long_cb);
+      srslte_vec_convert_if(input, h->input_conv, 0.01, 3*long_cb+12);
+      srslte_tdec_gen_iteration(&h->tdec_gen, h->input_conv, long_cb);
 #endif
+      break;
+  }
 }
 
 void srslte_tdec_decision(srslte_tdec_t * h, uint8_t *output, uint32_t long_cb) {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      srslte_tdec_avx_decision(&h->tdec_avx, output, long_cb);
+      break;
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  return srslte_tdec_sse_decision(&h->tdec_sse, output, long_cb);
+      srslte_tdec_sse_decision(&h->tdec_sse, output, long_cb);
 #else
-  return srslte_tdec_gen_decision(&h->tdec_gen, output, long_cb);
+      srslte_tdec_gen_decision(&h->tdec_gen, output, long_cb);
 #endif
-
+      break;
+  }
 }
 
 void srslte_tdec_decision_byte(srslte_tdec_t * h, uint8_t *output, uint32_t long_cb) {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      srslte_tdec_avx_decision_byte(&h->tdec_avx, output, long_cb);
+      break;
+#endif
+    default:
+#ifdef LV_HAVE_SSE
+      srslte_tdec_sse_decision_byte(&h->tdec_sse, output, long_cb);
+#else
+      srslte_tdec_gen_decision_byte(&h->tdec_gen, output, long_cb);
+#endif
+      break;
+  }
+}
+
+static uint32_t tdec_decision_byte_diff(void *_h, uint8_t *output, uint32_t first, uint32_t nbytes) {
+  srslte_tdec_t *h = (srslte_tdec_t*) _h;
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      return srslte_tdec_avx_decision_byte_diff(&h->tdec_avx, output, first, nbytes);
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  return srslte_tdec_sse_decision_byte(&h->tdec_sse, output, long_cb);
+      return srslte_tdec_sse_decision_byte_diff(&h->tdec_sse, output, first, nbytes);
 #else
-  return srslte_tdec_gen_decision_byte(&h->tdec_gen, output, long_cb);
+      return srslte_tdec_gen_decision_byte_diff(&h->tdec_gen, output, first, nbytes);
 #endif
-  
+  }
+}
+
+/* Hard decision packed in bytes and CRC of the first len_crc bits in a single pass. Each chunk of
+ * the output is checked while it is still in cache. Returns the CRC remainder (0 if correct, or
+ * always 0 if crc is NULL). If nof_changes is not NULL it is set to the number of decisions that
+ * differ from the ones that were in output, which is only meaningful if output holds the decision
+ * of the previous iteration of the same code block.
+ */
+uint32_t srslte_tdec_decision_crc(srslte_tdec_t * h, uint8_t *output, uint32_t long_cb,
+                                  srslte_crc_t *crc, uint32_t len_crc, uint32_t *nof_changes)
+{
+  return srslte_tdec_decision_crc_chunks(tdec_decision_byte_diff, h, output, long_cb, crc, len_crc, nof_changes);
+}
+
+uint32_t srslte_tdec_decision_crc_chunks(srslte_tdec_byte_diff_t byte_diff, void *h, uint8_t *output,
+                                         uint32_t long_cb, srslte_crc_t *crc, uint32_t len_crc,
+                                         uint32_t *nof_changes)
+{
+  uint32_t nbytes = long_cb/8, crc_bytes = len_crc/8;
+  uint32_t changes = 0, reg = 0;
+
+  for (uint32_t b = 0; b < nbytes; b += SRSLTE_TDEC_CRC_CHUNK) {
+    uint32_t n = SRSLTE_MIN(SRSLTE_TDEC_CRC_CHUNK, nbytes - b);
+    changes += byte_diff(h, output, b, n);
+    if (crc && b < crc_bytes) {
+      reg = srslte_crc_update_byte(crc, reg, &output[b], SRSLTE_MIN(n, crc_bytes - b));
+    }
+  }
+  if (nof_changes) {
+    *nof_changes = changes;
+  }
+  return crc ? srslte_crc_final(crc, reg) : 0;
 }
 
 int srslte_tdec_run_all(srslte_tdec_t * h, int16_t * input, uint8_t *output, uint32_t nof_iterations, uint32_t long_cb)
 {
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      return srslte_tdec_avx_run_all(&h->tdec_avx, input, output, nof_iterations, long_cb);
+#endif
+    default:
 #ifdef LV_HAVE_SSE
-  return srslte_tdec_sse_run_all(&h->tdec_sse, input, output, nof_iterations, long_cb);
+      return srslte_tdec_sse_run_all(&h->tdec_sse, input, output, nof_iterations, long_cb);
 #else
-  srslte_vec_convert_if(input, h->input_conv, 0.01, 3*long_cb+12);
-  return srslte_tdec_gen_run_all(&h->tdec_gen, h->input_conv, output, nof_iterations, long_cb);
+      srslte_vec_convert_if(input, h->input_conv, 0.01, 3*long_cb+12);
+      return srslte_tdec_gen_run_all(&h->tdec_gen, h->input_conv, output, nof_iterations, long_cb);
 #endif
+  }
+}
+
+/* Decodes a batch of code blocks, for instance of all the UEs in a TTI. Implementations with
+ * several SIMD lanes decode one code block per lane, the others decode them one after another.
+ * Each code block stops when its CRC is correct, after max_iterations or, if it sets max_stall, when its 
+ * decisions stall. Code blocks may set their own iteration cap in max_iterations. With stop_on_error, 
+ * a code block that stops with a wrong CRC also stops the code blocks of the same transport block 
+ * (tb_idx), whose crc_ok is left false.
+ */
+int srslte_tdec_run_batch(srslte_tdec_t * h, srslte_tdec_cb_t *cb, uint32_t nof_cb, uint32_t max_iterations, 
+                          bool stop_on_error)
+{
+  bool failed[SRSLTE_TDEC_MAX_BATCH];
+  switch(h->impl) {
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_TDEC_AVX2:
+    case SRSLTE_TDEC_AVX512:
+      return srslte_tdec_avx_run_batch(&h->tdec_avx, cb, nof_cb, max_iterations, stop_on_error);
+#endif
+    default:
+      if (nof_cb > SRSLTE_TDEC_MAX_BATCH) {
+        fprintf(stderr, "Error batch of %d code blocks exceeds maximum (%d)\n", nof_cb, SRSLTE_TDEC_MAX_BATCH);
+        return SRSLTE_ERROR;
+      }
+      for (uint32_t i = 0; i < nof_cb; i++) {
+        if (cb[i].tb_idx >= SRSLTE_TDEC_MAX_BATCH) {
+          fprintf(stderr, "Invalid TB index %d\n", cb[i].tb_idx);
+          return SRSLTE_ERROR;
+        }
+        cb[i].crc_ok = false;
+        cb[i].nof_iterations = 0;
+        failed[cb[i].tb_idx] = false;
+      }
+      for (uint32_t i = 0; i < nof_cb; i++) {
+        uint32_t n_stall = 0;
+        uint32_t cb_max_iterations = cb[i].max_iterations ? cb[i].max_iterations : max_iterations;
+        if (failed[cb[i].tb_idx]) {
+          continue;
+        }
+        if (srslte_tdec_reset(h, cb[i].long_cb)) {
+          return SRSLTE_ERROR;
+        }
+        do {
+          srslte_tdec_iteration(h, cb[i].input, cb[i].long_cb);
+          cb[i].nof_iterations++;
+          if (cb[i].crc) {
+            cb[i].crc_ok = !srslte_tdec_decision_crc(h, cb[i].output, cb[i].long_cb, cb[i].crc, cb[i].len_crc,
+                                                     &cb[i].nof_changes);
+            n_stall = (cb[i].nof_iterations > 1 && cb[i].nof_changes == 0) ? n_stall + 1 : 0;
+          } else if (cb[i].nof_iterations >= cb_max_iterations) {
+            srslte_tdec_decision_byte(h, cb[i].output, cb[i].long_cb);
+          }
+        } while (cb[i].nof_iterations < cb_max_iterations && !cb[i].crc_ok && (!cb[i].max_stall || n_stall < cb[i].max_stall));
+        failed[cb[i].tb_idx] = stop_on_error && cb[i].crc && !cb[i].crc_ok;
+      }
+      return SRSLTE_SUCCESS;
+  }
 }
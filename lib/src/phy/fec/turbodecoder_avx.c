@@ -0,0 +1,969 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#include "srslte/phy/fec/turbodecoder_avx.h"
+#include "srslte/phy/utils/vector.h"
+#include "turbodecoder_avx512.h"
+
+#include <inttypes.h>
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+
+#define NUMSTATES       8
+#define NINPUTS         2
+#define TAIL            3
+#define TOTALTAIL       12
+
+#define INF 10000
+#define ZERO 0
+
+
+#ifdef LV_HAVE_AVX2
+
+/* Number of windows for a code block: as many as lanes as long as each window is a
+ * multiple of 8 bits and not shorter than SRSLTE_TDEC_AVX_MIN_WINLEN */
+static uint32_t nof_windows_cb(uint32_t nof_lanes, uint32_t long_cb)
+{
+  uint32_t nw = nof_lanes;
+  while (nw > 1 && ((long_cb % (8*nw)) || (long_cb/nw < SRSLTE_TDEC_AVX_MIN_WINLEN))) {
+    nw /= 2;
+  }
+  return nw;
+}
+
+/* Initial alpha metrics: the trellis starts at state 0 */
+const int16_t srslte_tdec_avx_alpha_start[8] = {0, -INF, -INF, -INF, -INF, -INF, -INF, -INF};
+
+/* Builds the initial state metrics of each lane. The first alpha window starts from state 0, the
+ * last beta window ends where the tail leaves it. Boundaries in between use the metrics saved
+ * in the previous iteration. Unused lanes replicate the first one.
+ */
+static void map_avx_init_metrics(int16_t *init, int16_t *saved, const int16_t *edge,
+                                 uint32_t edge_lane, uint32_t nof_windows, uint32_t nof_lanes)
+{
+  for (uint32_t l = 0; l < nof_lanes; l++) {
+    uint32_t w = l < nof_windows ? l : 0;
+    if (w == edge_lane) {
+      memcpy(&init[8*l], edge, sizeof(int16_t)*8);
+    } else {
+      memcpy(&init[8*l], &saved[8*w], sizeof(int16_t)*8);
+    }
+  }
+}
+
+/* Computes the branch metrics (gamma) of len trellis steps into one 128-bit lane, starting at
+ * step offset. Lanes are interleaved so that one wide load returns the branch metrics of 4
+ * trellis steps for all lanes */
+static void map_avx_gamma_lane(map_avx_t * h, int16_t *input, int16_t *app, int16_t *parity,
+                               uint32_t len, uint32_t offset, uint32_t lane, uint32_t nof_lanes)
+{
+  __m128i res10, res20, res11, res21, res1, res2;
+  __m128i in, ap, pa, g1, g0;
+
+  __m128i res10_mask = _mm_set_epi8(0xff,0xff,7,6,0xff,0xff,5,4,0xff,0xff,3,2,0xff,0xff,1,0);
+  __m128i res20_mask = _mm_set_epi8(0xff,0xff,15,14,0xff,0xff,13,12,0xff,0xff,11,10,0xff,0xff,9,8);
+  __m128i res11_mask = _mm_set_epi8(7,6,0xff,0xff,5,4,0xff,0xff,3,2,0xff,0xff,1,0,0xff,0xff);
+  __m128i res21_mask = _mm_set_epi8(15,14,0xff,0xff,13,12,0xff,0xff,11,10,0xff,0xff,9,8,0xff,0xff);
+
+  __m128i *inPtr  = (__m128i*) input;
+  __m128i *appPtr = (__m128i*) app;
+  __m128i *paPtr  = (__m128i*) parity;
+  __m128i *resPtr = (__m128i*) h->branch + 2*nof_lanes*(offset/8) + lane;
+
+  for (int i=0;i<len/8;i++) {
+    in = _mm_load_si128(inPtr);
+    inPtr++;
+    pa = _mm_load_si128(paPtr);
+    paPtr++;
+
+    if (appPtr) {
+      ap = _mm_load_si128(appPtr);
+      appPtr++;
+      in = _mm_add_epi16(ap, in);
+    }
+
+    g1 = _mm_add_epi16(in, pa);
+    g0 = _mm_sub_epi16(in, pa);
+
+    g1 = _mm_srai_epi16(g1, 1);
+    g0 = _mm_srai_epi16(g0, 1);
+
+    res10 = _mm_shuffle_epi8(g0, res10_mask);
+    res20 = _mm_shuffle_epi8(g0, res20_mask);
+    res11 = _mm_shuffle_epi8(g1, res11_mask);
+    res21 = _mm_shuffle_epi8(g1, res21_mask);
+
+    res1  = _mm_or_si128(res10, res11);
+    res2  = _mm_or_si128(res20, res21);
+
+    _mm_store_si128(resPtr, res1);
+    resPtr += nof_lanes;
+    _mm_store_si128(resPtr, res2);
+    resPtr += nof_lanes;
+  }
+}
+
+/* Clears the branch metrics of the first len trellis steps of one lane */
+static void map_avx_gamma_zero(map_avx_t * h, uint32_t len, uint32_t lane, uint32_t nof_lanes)
+{
+  __m128i *resPtr = (__m128i*) h->branch + lane;
+  for (int i=0;i<len/4;i++) {
+    _mm_store_si128(resPtr, _mm_setzero_si128());
+    resPtr += nof_lanes;
+  }
+}
+
+/* Compute branch metrics (gamma) of a code block split in windows, one per lane */
+static void map_avx_gamma(map_avx_t * h, int16_t *input, int16_t *app, int16_t *parity,
+                          uint32_t long_cb, uint32_t nof_windows, uint32_t nof_lanes)
+{
+  uint32_t win_len = long_cb/nof_windows;
+
+  for (uint32_t l = 0; l < nof_lanes; l++) {
+    uint32_t w = l < nof_windows ? l : 0;
+    map_avx_gamma_lane(h, &input[w*win_len], app ? &app[w*win_len] : NULL, &parity[w*win_len],
+                       win_len, 0, l, nof_lanes);
+  }
+}
+
+/* Runs the beta recursion over the tail bits of a code block */
+static void map_avx_beta_tail(int16_t *input, int16_t *parity, uint32_t long_cb, int16_t *beta_tail)
+{
+  __m128i shuf_bp = _mm_set_epi8(SHUF_BP);
+  __m128i shuf_bn = _mm_set_epi8(SHUF_BN);
+  __m128i beta_k  = _mm_set_epi16(-INF, -INF, -INF, -INF, -INF, -INF, -INF, 0);
+  __m128i g, bp, bn;
+
+  for (int k=TAIL-1;k>=0;k--) {
+    int16_t g0 = (input[long_cb+k] - parity[long_cb+k])/2;
+    int16_t g1 = (input[long_cb+k] + parity[long_cb+k])/2;
+    g = _mm_set_epi16(g1, g0, g0, g1, g1, g0, g0, g1);
+    bp = _mm_add_epi16(beta_k, g);
+    bn = _mm_sub_epi16(beta_k, g);
+    bp = _mm_shuffle_epi8(bp, shuf_bp);
+    bn = _mm_shuffle_epi8(bn, shuf_bn);
+    beta_k = _mm_max_epi16(bp, bn);
+  }
+  _mm_storeu_si128((__m128i*) beta_tail, beta_k);
+}
+
+static inline void map_avx_save_alpha(map_avx_t *s, int dec, int16_t *alpha_k, uint32_t nof_windows)
+{
+  for (uint32_t l = 0; l + 1 < nof_windows; l++) {
+    memcpy(&s->alpha_init[dec][8*(l+1)], &alpha_k[8*l], sizeof(int16_t)*8);
+  }
+}
+
+static inline void map_avx_save_beta(map_avx_t *s, int dec, int16_t *beta_k, uint32_t nof_windows)
+{
+  for (uint32_t l = 1; l < nof_windows; l++) {
+    memcpy(&s->beta_init[dec][8*(l-1)], &beta_k[8*l], sizeof(int16_t)*8);
+  }
+}
+
+/* Computes max(bp)-max(bn) for each lane. The result is left in the 1st 16-bit word of the lane */
+static inline __m256i hMaxDiff_avx2(__m256i bn, __m256i bp)
+{
+  __m256i m = _mm256_max_epi16(_mm256_unpacklo_epi64(bn, bp), _mm256_unpackhi_epi64(bn, bp));
+  m = _mm256_max_epi16(m, _mm256_shuffle_epi32(m, 0xB1));
+  m = _mm256_max_epi16(m, _mm256_srli_epi32(m, 16));
+  return _mm256_sub_epi16(_mm256_srli_si256(m, 8), m);
+}
+
+/* Computes alpha metrics of 2 lanes in parallel. init has the initial metrics of each lane and
+ * returns the last ones. If lane_start is not NULL, the metrics of lane l are reset to state 0
+ * before trellis step lane_start[l] */
+static void map_avx2_alpha(map_avx_t * s, int16_t *init, uint32_t len, const uint32_t *lane_start)
+{
+  uint32_t k;
+
+  __m256i shuf_ap = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_AP));
+  __m256i shuf_an = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_AN));
+  __m256i shuf_norm = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_NORM));
+  __m256i start = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*) srslte_tdec_avx_alpha_start));
+
+  __m256i shuf_g[4];
+  shuf_g[0] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_ALPHA_G0));
+  shuf_g[1] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_ALPHA_G1));
+  shuf_g[2] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_ALPHA_G2));
+  shuf_g[3] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_ALPHA_G3));
+
+  __m256i *alphaPtr = (__m256i*) s->alpha;
+  __m256i *gPtr = (__m256i*) s->branch;
+  __m256i gv, g, ap, an, norm;
+
+  __m256i alpha_k = _mm256_load_si256((__m256i*) init);
+  _mm256_store_si256(alphaPtr, alpha_k);
+  alphaPtr++;
+
+#define ALPHA_STEP_AVX2(c)  g = _mm256_shuffle_epi8(gv, shuf_g[c]); \
+  ap = _mm256_add_epi16(alpha_k, g);\
+  an = _mm256_sub_epi16(alpha_k, g);\
+  ap = _mm256_shuffle_epi8(ap, shuf_ap);\
+  an = _mm256_shuffle_epi8(an, shuf_an);\
+  alpha_k = _mm256_max_epi16(ap, an);\
+  _mm256_store_si256(alphaPtr, alpha_k);\
+  alphaPtr++;
+
+  for (k = 0; k < len/8; k++) {
+    if (lane_start && (lane_start[0] == 8*k || lane_start[1] == 8*k)) {
+      __m256i mask = _mm256_set_m128i(_mm_set1_epi16(lane_start[1] == 8*k ? -1 : 0),
+                                      _mm_set1_epi16(lane_start[0] == 8*k ? -1 : 0));
+      alpha_k = _mm256_blendv_epi8(alpha_k, start, mask);
+      _mm256_store_si256(alphaPtr - 1, alpha_k);
+    }
+    gv = _mm256_load_si256(gPtr);
+    gPtr++;
+    ALPHA_STEP_AVX2(0);
+    ALPHA_STEP_AVX2(1);
+    ALPHA_STEP_AVX2(2);
+    ALPHA_STEP_AVX2(3);
+    norm = _mm256_shuffle_epi8(alpha_k, shuf_norm);
+    alpha_k = _mm256_sub_epi16(alpha_k, norm);
+    gv = _mm256_load_si256(gPtr);
+    gPtr++;
+    ALPHA_STEP_AVX2(0);
+    ALPHA_STEP_AVX2(1);
+    ALPHA_STEP_AVX2(2);
+    ALPHA_STEP_AVX2(3);
+    norm = _mm256_shuffle_epi8(alpha_k, shuf_norm);
+    alpha_k = _mm256_sub_epi16(alpha_k, norm);
+  }
+
+  _mm256_store_si256((__m256i*) init, alpha_k);
+}
+
+/* Computes beta metrics and the output LLR of 2 lanes in parallel. init has the initial metrics
+ * of each lane and returns the last ones. The LLR of lane l are written to output[l], l < nof_out */
+static void map_avx2_beta(map_avx_t * s, int16_t *init, int16_t **output, uint32_t nof_out, uint32_t len)
+{
+  int k;
+
+  __m256i shuf_bp = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BP));
+  __m256i shuf_bn = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BN));
+  __m256i shuf_norm = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_NORM));
+
+  __m256i shuf_g[4];
+  shuf_g[0] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BETA_G0));
+  shuf_g[1] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BETA_G1));
+  shuf_g[2] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BETA_G2));
+  shuf_g[3] = _mm256_broadcastsi128_si256(_mm_set_epi8(SHUF_BETA_G3));
+
+  const __m256i *alphaPtr = (const __m256i*) s->alpha + len - 1;
+  __m256i *gPtr = (__m256i*) s->branch + len/4 - 1;
+  __m256i gv, g, bp, bn, alpha_k, out, norm;
+
+  int16_t *output0 = output[0];
+  int16_t *output1 = nof_out > 1 ? output[1] : NULL;
+
+  __m256i beta_k = _mm256_load_si256((__m256i*) init);
+
+#define BETA_STEP_AVX2(g)     bp = _mm256_add_epi16(beta_k, g);\
+    bn = _mm256_sub_epi16(beta_k, g);\
+    bp = _mm256_shuffle_epi8(bp, shuf_bp);\
+    bn = _mm256_shuffle_epi8(bn, shuf_bn);\
+    beta_k = _mm256_max_epi16(bp, bn);
+
+#define BETA_STEP_CNT_AVX2(c,d) g = _mm256_shuffle_epi8(gv, shuf_g[c]);\
+    BETA_STEP_AVX2(g)\
+    alpha_k = _mm256_load_si256(alphaPtr);\
+    alphaPtr--;\
+    bp = _mm256_add_epi16(bp, alpha_k);\
+    bn = _mm256_add_epi16(bn, alpha_k);\
+    out = hMaxDiff_avx2(bn, bp);\
+    output0[k-d] = _mm256_extract_epi16(out, 0);\
+    if (output1) {\
+      output1[k-d] = _mm256_extract_epi16(out, 8);\
+    }
+
+  for (k = len-1; k >= 0; k-=8) {
+    gv = _mm256_load_si256(gPtr);
+    gPtr--;
+    BETA_STEP_CNT_AVX2(0,0);
+    BETA_STEP_CNT_AVX2(1,1);
+    BETA_STEP_CNT_AVX2(2,2);
+    BETA_STEP_CNT_AVX2(3,3);
+    norm = _mm256_shuffle_epi8(beta_k, shuf_norm);
+    beta_k = _mm256_sub_epi16(beta_k, norm);
+    gv = _mm256_load_si256(gPtr);
+    gPtr--;
+    BETA_STEP_CNT_AVX2(0,4);
+    BETA_STEP_CNT_AVX2(1,5);
+    BETA_STEP_CNT_AVX2(2,6);
+    BETA_STEP_CNT_AVX2(3,7);
+    norm = _mm256_shuffle_epi8(beta_k, shuf_norm);
+    beta_k = _mm256_sub_epi16(beta_k, norm);
+  }
+
+  _mm256_store_si256((__m256i*) init, beta_k);
+}
+
+
+/* Runs the forward and backward recursions on all lanes */
+static void map_avx_alpha_beta(srslte_tdec_avx_t * h, int16_t *alpha_init, int16_t *beta_init,
+                               const uint32_t *lane_start, int16_t **output, uint32_t nof_out, uint32_t len)
+{
+#ifdef LV_HAVE_AVX512
+  if (h->nof_lanes == 4) {
+    srslte_tdec_avx512_alpha(&h->dec, alpha_init, len, lane_start);
+    srslte_tdec_avx512_beta(&h->dec, beta_init, output, nof_out, len);
+    return;
+  }
+#endif
+  map_avx2_alpha(&h->dec, alpha_init, len, lane_start);
+  map_avx2_beta(&h->dec, beta_init, output, nof_out, len);
+}
+
+/* Inititalizes constituent decoder object */
+static int map_avx_init(map_avx_t * h, int max_long_cb, uint32_t nof_lanes)
+{
+  bzero(h, sizeof(map_avx_t));
+  h->alpha = srslte_vec_malloc(sizeof(int16_t) * (max_long_cb + SRSLTE_TCOD_TOTALTAIL + 1) * NUMSTATES * nof_lanes);
+  if (!h->alpha) {
+    perror("srslte_vec_malloc");
+    return -1;
+  }
+  h->branch = srslte_vec_malloc(sizeof(int16_t) * (max_long_cb + SRSLTE_TCOD_TOTALTAIL + 1) * NINPUTS * nof_lanes);
+  if (!h->branch) {
+    perror("srslte_vec_malloc");
+    return -1;
+  }
+  h->max_long_cb = max_long_cb;
+
+  h->sse.alpha = h->alpha;
+  h->sse.branch = h->branch;
+  h->sse.max_long_cb = max_long_cb;
+  return 0;
+}
+
+static void map_avx_free(map_avx_t * h)
+{
+  if (h->alpha) {
+    free(h->alpha);
+  }
+  if (h->branch) {
+    free(h->branch);
+  }
+  bzero(h, sizeof(map_avx_t));
+}
+
+/* Runs one instance of a decoder. dec selects the window boundary metrics of constituent decoder 1 or 2 */
+static void map_avx_dec(srslte_tdec_avx_t * h, int dec, int16_t * input, int16_t *app, int16_t * parity,
+                        int16_t * output, uint32_t long_cb)
+{
+  int16_t alpha_init[8*SRSLTE_TDEC_AVX_MAX_WINDOWS] __attribute__((aligned(64)));
+  int16_t beta_init[8*SRSLTE_TDEC_AVX_MAX_WINDOWS] __attribute__((aligned(64)));
+  int16_t *out[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t tail[8];
+
+  if (h->nof_windows == 1) {
+    srslte_tdec_sse_map_dec(&h->dec.sse, input, app, parity, output, long_cb);
+    return;
+  }
+
+  uint32_t win_len = long_cb/h->nof_windows;
+  for (uint32_t l = 0; l < h->nof_windows; l++) {
+    out[l] = &output[l*win_len];
+  }
+
+  // Compute branch metrics
+  map_avx_gamma(&h->dec, input, app, parity, long_cb, h->nof_windows, h->nof_lanes);
+  map_avx_beta_tail(input, parity, long_cb, tail);
+
+  map_avx_init_metrics(alpha_init, h->dec.alpha_init[dec], srslte_tdec_avx_alpha_start, 0, h->nof_windows, h->nof_lanes);
+  map_avx_init_metrics(beta_init, h->dec.beta_init[dec], tail, h->nof_windows-1, h->nof_windows, h->nof_lanes);
+
+  // Forward recursion, backwards recursion + LLR computation
+  map_avx_alpha_beta(h, alpha_init, beta_init, NULL, out, h->nof_windows, win_len);
+
+  map_avx_save_alpha(&h->dec, dec, alpha_init, h->nof_windows);
+  map_avx_save_beta(&h->dec, dec, beta_init, h->nof_windows);
+}
+
+/* Initializes the turbo decoder object */
+int srslte_tdec_avx_init(srslte_tdec_avx_t * h, uint32_t max_long_cb, uint32_t nof_lanes)
+{
+  int ret = -1;
+  bzero(h, sizeof(srslte_tdec_avx_t));
+  uint32_t len = max_long_cb + SRSLTE_TCOD_TOTALTAIL;
+
+#ifdef LV_HAVE_AVX512
+  if (nof_lanes != 2 && nof_lanes != 4) {
+#else
+  if (nof_lanes != 2) {
+#endif
+    fprintf(stderr, "Invalid number of lanes %d for AVX turbo decoder\n", nof_lanes);
+    return -1;
+  }
+
+  h->max_long_cb = max_long_cb;
+  h->nof_lanes   = nof_lanes;
+
+  h->app1 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->app1) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->app2 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->app2) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->ext1 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->ext1) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->ext2 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->ext2) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->syst = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->syst) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->parity0 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->parity0) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->parity1 = srslte_vec_malloc(sizeof(int16_t) * len);
+  if (!h->parity1) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+
+  if (map_avx_init(&h->dec, h->max_long_cb, h->nof_lanes)) {
+    goto clean_and_exit;
+  }
+
+  for (uint32_t l = 0; l < h->nof_lanes; l++) {
+    srslte_tdec_avx_lane_t *lane = &h->lane[l];
+    int16_t **buffers[7] = {&lane->app1, &lane->app2, &lane->ext1, &lane->ext2,
+                            &lane->syst, &lane->parity0, &lane->parity1};
+    for (int i = 0; i < 7; i++) {
+      *buffers[i] = srslte_vec_malloc(sizeof(int16_t) * len);
+      if (!*buffers[i]) {
+        perror("srslte_vec_malloc");
+        goto clean_and_exit;
+      }
+    }
+  }
+  h->llr = srslte_vec_malloc(sizeof(int16_t) * max_long_cb * nof_lanes);
+  if (!h->llr) {
+    perror("srslte_vec_malloc");
+    goto clean_and_exit;
+  }
+
+  for (int i=0;i<SRSLTE_NOF_TC_CB_SIZES;i++) {
+    if (srslte_tc_interl_init(&h->interleaver[i], srslte_cbsegm_cbsize(i)) < 0) {
+      goto clean_and_exit;
+    }
+    srslte_tc_interl_LTE_gen(&h->interleaver[i], srslte_cbsegm_cbsize(i));
+  }
+  h->current_cbidx = -1;
+  ret = 0;
+clean_and_exit:if (ret == -1) {
+    srslte_tdec_avx_free(h);
+  }
+  return ret;
+}
+
+void srslte_tdec_avx_free(srslte_tdec_avx_t * h)
+{
+  if (h->app1) {
+    free(h->app1);
+  }
+  if (h->app2) {
+    free(h->app2);
+  }
+  if (h->ext1) {
+    free(h->ext1);
+  }
+  if (h->ext2) {
+    free(h->ext2);
+  }
+  if (h->syst) {
+    free(h->syst);
+  }
+  if (h->parity0) {
+    free(h->parity0);
+  }
+  if (h->parity1) {
+    free(h->parity1);
+  }
+
+  for (uint32_t l = 0; l < SRSLTE_TDEC_AVX_MAX_WINDOWS; l++) {
+    srslte_tdec_avx_lane_t *lane = &h->lane[l];
+    int16_t *buffers[7] = {lane->app1, lane->app2, lane->ext1, lane->ext2,
+                           lane->syst, lane->parity0, lane->parity1};
+    for (int i = 0; i < 7; i++) {
+      if (buffers[i]) {
+        free(buffers[i]);
+      }
+    }
+  }
+  if (h->llr) {
+    free(h->llr);
+  }
+
+  map_avx_free(&h->dec);
+
+  for (int i=0;i<SRSLTE_NOF_TC_CB_SIZES;i++) {
+    srslte_tc_interl_free(&h->interleaver[i]);
+  }
+
+  bzero(h, sizeof(srslte_tdec_avx_t));
+}
+
+/* Runs 1 turbo decoder iteration */
+void srslte_tdec_avx_iteration(srslte_tdec_avx_t * h, int16_t * input, uint32_t long_cb)
+{
+
+  if (h->current_cbidx >= 0) {
+    uint16_t *inter   = h->interleaver[h->current_cbidx].forward;
+    uint16_t *deinter = h->interleaver[h->current_cbidx].reverse;
+
+    if (h->n_iter == 0) {
+      srslte_tdec_sse_deinterleave_input(input, h->syst, h->parity0, h->parity1, h->app2, long_cb);
+      srslte_tdec_sse_normalize_input(h->syst, h->parity0, h->parity1, h->app2, long_cb);
+    }
+
+    // Add apriori information to decoder 1
+    if (h->n_iter > 0) {
+      srslte_vec_sub_sss(h->app1, h->ext1, h->app1, long_cb);
+      srslte_tdec_sse_scale_extrinsic(h->app1, long_cb);
+    }
+
+    // Run MAP DEC #1
+    if (h->n_iter == 0) {
+      map_avx_dec(h, 0, h->syst, NULL, h->parity0, h->ext1, long_cb);
+    } else {
+      map_avx_dec(h, 0, h->syst, h->app1, h->parity0, h->ext1, long_cb);
+    }
+
+    // Convert aposteriori information into extrinsic information
+    if (h->n_iter > 0) {
+      srslte_vec_sub_sss(h->ext1, h->app1, h->ext1, long_cb);
+    }
+
+    // Interleave extrinsic output of DEC1 to form apriori info for decoder 2
+    srslte_vec_lut_sss(h->ext1, deinter, h->app2, long_cb);
+
+    // Run MAP DEC #2. 2nd decoder uses apriori information as systematic bits
+    map_avx_dec(h, 1, h->app2, NULL, h->parity1, h->ext2, long_cb);
+
+    // Deinterleaved extrinsic bits become apriori info for decoder 1
+    srslte_vec_lut_sss(h->ext2, inter, h->app1, long_cb);
+
+    h->n_iter++;
+  } else {
+    fprintf(stderr, "Error CB index not set (call srslte_tdec_avx_reset() first\n");
+  }
+}
+
+/* Resets the decoder and sets the codeblock length */
+int srslte_tdec_avx_reset(srslte_tdec_avx_t * h, uint32_t long_cb)
+{
+  if (long_cb > h->max_long_cb) {
+    fprintf(stderr, "TDEC was initialized for max_long_cb=%d\n",
+            h->max_long_cb);
+    return -1;
+  }
+  h->n_iter = 0;
+  h->current_cbidx = srslte_cbsegm_cbindex(long_cb);
+  if (h->current_cbidx < 0) {
+    fprintf(stderr, "Invalid CB length %d\n", long_cb);
+    return -1;
+  }
+  h->nof_windows = nof_windows_cb(h->nof_lanes, long_cb);
+
+  /* First iteration starts all window boundaries as equiprobable */
+  bzero(h->dec.alpha_init, sizeof(h->dec.alpha_init));
+  bzero(h->dec.beta_init, sizeof(h->dec.beta_init));
+  return 0;
+}
+
+void srslte_tdec_avx_decision(srslte_tdec_avx_t * h, uint8_t *output, uint32_t long_cb)
+{
+  __m256i zero     = _mm256_set1_epi16(0);
+  __m256i lsb_mask = _mm256_set1_epi16(1);
+
+  __m256i *appPtr = (__m256i*) h->app1;
+  __m256i *outPtr = (__m256i*) output;
+  __m256i ap, out, out0, out1;
+
+  for (uint32_t i = 0; i < long_cb/32; i++) {
+    ap   = _mm256_load_si256(appPtr); appPtr++;
+    out0 = _mm256_and_si256(_mm256_cmpgt_epi16(ap, zero), lsb_mask);
+    ap   = _mm256_load_si256(appPtr); appPtr++;
+    out1 = _mm256_and_si256(_mm256_cmpgt_epi16(ap, zero), lsb_mask);
+
+    out  = _mm256_permute4x64_epi64(_mm256_packs_epi16(out0, out1), 0xD8);
+    _mm256_storeu_si256(outPtr, out);
+    outPtr++;
+  }
+  for (uint32_t i = 32*(long_cb/32); i < long_cb; i++) {
+    output[i] = h->app1[i]>0?1:0;
+  }
+}
+
+/* Packs the hard decision of 32 bits per step using movemask. Bytes are reversed within each
+ * 64-bit word before so that the 1st bit ends up in the MSB of the output byte */
+static void tdec_avx_decision_byte(int16_t *app, uint8_t *output, uint32_t long_cb)
+{
+  uint8_t mask[8] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
+  __m256i zero    = _mm256_set1_epi16(0);
+  __m256i rev     = _mm256_broadcastsi128_si256(_mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7));
+
+  __m256i *appPtr = (__m256i*) app;
+  __m256i ap0, ap1, out;
+  uint32_t i;
+
+  for (i = 0; i < long_cb/32; i++) {
+    ap0 = _mm256_cmpgt_epi16(_mm256_load_si256(appPtr), zero); appPtr++;
+    ap1 = _mm256_cmpgt_epi16(_mm256_load_si256(appPtr), zero); appPtr++;
+    out = _mm256_permute4x64_epi64(_mm256_packs_epi16(ap0, ap1), 0xD8);
+    out = _mm256_shuffle_epi8(out, rev);
+    uint32_t bits = (uint32_t) _mm256_movemask_epi8(out);
+    memcpy(&output[4*i], &bits, sizeof(uint32_t));
+  }
+
+  // long_cb is always byte aligned
+  for (i = 4*i; i < long_cb/8; i++) {
+    uint8_t out_byte = 0;
+    for (int j = 0; j < 8; j++) {
+      out_byte |= app[8*i+j]>0?mask[j]:0;
+    }
+    output[i] = out_byte;
+  }
+}
+
+void srslte_tdec_avx_decision_byte(srslte_tdec_avx_t * h, uint8_t *output, uint32_t long_cb)
+{
+  tdec_avx_decision_byte(h->app1, output, long_cb);
+}
+
+/* Same as tdec_avx_decision_byte() over nbytes, returning how many bits differ from the ones that
+ * were in output, i.e. the sign changes since the previous decision */
+static uint32_t tdec_avx_decision_byte_diff(int16_t *app, uint8_t *output, uint32_t nbytes)
+{
+  uint8_t mask[8] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
+  __m256i zero    = _mm256_set1_epi16(0);
+  __m256i rev     = _mm256_broadcastsi128_si256(_mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7));
+  uint32_t changes = 0, i;
+
+  for (i = 0; i < nbytes/8; i++) {
+    __m256i ap0 = _mm256_cmpgt_epi16(_mm256_loadu_si256((__m256i*) &app[64*i]), zero);
+    __m256i ap1 = _mm256_cmpgt_epi16(_mm256_loadu_si256((__m256i*) &app[64*i+16]), zero);
+    __m256i ap2 = _mm256_cmpgt_epi16(_mm256_loadu_si256((__m256i*) &app[64*i+32]), zero);
+    __m256i ap3 = _mm256_cmpgt_epi16(_mm256_loadu_si256((__m256i*) &app[64*i+48]), zero);
+    __m256i out0 = _mm256_permute4x64_epi64(_mm256_packs_epi16(ap0, ap1), 0xD8);
+    __m256i out1 = _mm256_permute4x64_epi64(_mm256_packs_epi16(ap2, ap3), 0xD8);
+    uint64_t bits = (uint32_t) _mm256_movemask_epi8(_mm256_shuffle_epi8(out0, rev)) |
+                    ((uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_shuffle_epi8(out1, rev)) << 32);
+    uint64_t prev;
+    memcpy(&prev, &output[8*i], sizeof(uint64_t));
+    changes += __builtin_popcountll(bits ^ prev);
+    memcpy(&output[8*i], &bits, sizeof(uint64_t));
+  }
+  for (i = 8*i; i < nbytes; i++) {
+    uint8_t out_byte = 0;
+    for (int j = 0; j < 8; j++) {
+      out_byte |= app[8*i+j]>0?mask[j]:0;
+    }
+    changes += __builtin_popcount(out_byte ^ output[i]);
+    output[i] = out_byte;
+  }
+  return changes;
+}
+
+uint32_t srslte_tdec_avx_decision_byte_diff(srslte_tdec_avx_t * h, uint8_t *output, uint32_t first, uint32_t nbytes)
+{
+  return tdec_avx_decision_byte_diff(&h->app1[8*first], &output[first], nbytes);
+}
+
+/* Decisions of an app buffer, which is per lane in batch mode */
+static uint32_t tdec_avx_app_byte_diff(void *app, uint8_t *output, uint32_t first, uint32_t nbytes)
+{
+  return tdec_avx_decision_byte_diff(&((int16_t*) app)[8*first], &output[first], nbytes);
+}
+
+static uint32_t tdec_avx_decision_crc(int16_t *app, uint8_t *output, uint32_t long_cb,
+                                      srslte_crc_t *crc, uint32_t len_crc, uint32_t *nof_changes)
+{
+  return srslte_tdec_decision_crc_chunks(tdec_avx_app_byte_diff, app, output, long_cb, crc, len_crc, nof_changes);
+}
+
+/* Runs nof_iterations iterations and decides the output bits */
+int srslte_tdec_avx_run_all(srslte_tdec_avx_t * h, int16_t * input, uint8_t *output,
+                            uint32_t nof_iterations, uint32_t long_cb)
+{
+  if (srslte_tdec_avx_reset(h, long_cb)) {
+    return SRSLTE_ERROR;
+  }
+
+  do {
+    srslte_tdec_avx_iteration(h, input, long_cb);
+  } while (h->n_iter < nof_iterations);
+
+  srslte_tdec_avx_decision_byte(h, output, long_cb);
+
+  return SRSLTE_SUCCESS;
+}
+
+/* Loads a code block into a lane. NULL leaves the lane idle */
+static void batch_lane_load(srslte_tdec_avx_t * h, uint32_t l, srslte_tdec_cb_t *cb)
+{
+  srslte_tdec_avx_lane_t *lane = &h->lane[l];
+  lane->cb      = cb;
+  lane->n_iter  = 0;
+  lane->n_stall = 0;
+  lane->done    = false;
+  if (cb) {
+    lane->cbidx = srslte_cbsegm_cbindex(cb->long_cb);
+  }
+}
+
+/* Runs one constituent decoder on the code blocks of all lanes. Lanes run as many trellis steps
+ * as the longest code block; shorter code blocks are aligned to the end so that all lanes start
+ * the backward recursion from their own tail. Their forward recursion is reset where they start */
+static void batch_map_dec(srslte_tdec_avx_t * h, int16_t **input, int16_t **app, int16_t **parity,
+                          int16_t **output)
+{
+  int16_t alpha_init[8*SRSLTE_TDEC_AVX_MAX_WINDOWS] __attribute__((aligned(64)));
+  int16_t beta_init[8*SRSLTE_TDEC_AVX_MAX_WINDOWS] __attribute__((aligned(64)));
+  int16_t *llr[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  uint32_t lane_start[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  uint32_t len = 0;
+
+  for (uint32_t l = 0; l < h->nof_lanes; l++) {
+    if (h->lane[l].cb && h->lane[l].cb->long_cb > len) {
+      len = h->lane[l].cb->long_cb;
+    }
+  }
+
+  for (uint32_t l = 0; l < h->nof_lanes; l++) {
+    srslte_tdec_cb_t *cb = h->lane[l].cb;
+    llr[l] = &h->llr[l*h->max_long_cb];
+    memcpy(&alpha_init[8*l], srslte_tdec_avx_alpha_start, sizeof(int16_t)*8);
+    if (cb) {
+      lane_start[l] = len - cb->long_cb;
+      map_avx_gamma_zero(&h->dec, lane_start[l], l, h->nof_lanes);
+      map_avx_gamma_lane(&h->dec, input[l], app[l], parity[l], cb->long_cb, lane_start[l], l, h->nof_lanes);
+      map_avx_beta_tail(input[l], parity[l], cb->long_cb, &beta_init[8*l]);
+    } else {
+      lane_start[l] = len;
+      map_avx_gamma_zero(&h->dec, len, l, h->nof_lanes);
+      memcpy(&beta_init[8*l], srslte_tdec_avx_alpha_start, sizeof(int16_t)*8);
+    }
+  }
+
+  map_avx_alpha_beta(h, alpha_init, beta_init, lane_start, llr, h->nof_lanes, len);
+
+  for (uint32_t l = 0; l < h->nof_lanes; l++) {
+    if (h->lane[l].cb) {
+      memcpy(output[l], &llr[l][lane_start[l]], sizeof(int16_t)*h->lane[l].cb->long_cb);
+    }
+  }
+}
+
+/* Decodes a code block with the windowed decoder, stopping when the CRC is correct or, if enabled, 
+ * the decisions have stalled */
+static void batch_run_windowed(srslte_tdec_avx_t * h, srslte_tdec_cb_t *cb, uint32_t max_iterations)
+{
+  uint32_t n_stall = 0;
+  srslte_tdec_avx_reset(h, cb->long_cb);
+  do {
+    srslte_tdec_avx_iteration(h, cb->input, cb->long_cb);
+    cb->nof_iterations++;
+    if (cb->crc) {
+      cb->crc_ok = !tdec_avx_decision_crc(h->app1, cb->output, cb->long_cb, cb->crc, cb->len_crc, &cb->nof_changes);
+      n_stall = (cb->nof_iterations > 1 && cb->nof_changes == 0) ? n_stall + 1 : 0;
+    } else if (cb->nof_iterations >= max_iterations) {
+      tdec_avx_decision_byte(h->app1, cb->output, cb->long_cb);
+    }
+  } while (cb->nof_iterations < max_iterations && !cb->crc_ok && (!cb->max_stall || n_stall < cb->max_stall));
+}
+
+/* Decodes a batch of code blocks, possibly of different lengths and transport blocks. Code blocks
+ * long enough to be split in as many windows as lanes already fill the register and are decoded
+ * one at a time. The rest are decoded with one code block per lane, longest first, and a lane gets
+ * the next one as soon as the CRC of its code block is correct or it reaches its maximum iterations.
+ * With stop_on_error, a code block that stops with a wrong CRC retires the lanes and the queued
+ * code blocks of its transport block.
+ */
+int srslte_tdec_avx_run_batch(srslte_tdec_avx_t * h, srslte_tdec_cb_t *cb, uint32_t nof_cb,
+                              uint32_t max_iterations, bool stop_on_error)
+{
+  uint16_t order[SRSLTE_TDEC_MAX_BATCH];
+  bool failed[SRSLTE_TDEC_MAX_BATCH];
+  int16_t *in[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t *ap[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t *pa[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  int16_t *out[SRSLTE_TDEC_AVX_MAX_WINDOWS];
+  uint32_t nof_short = 0, next = 0, nof_active = 0;
+
+  if (nof_cb > SRSLTE_TDEC_MAX_BATCH) {
+    fprintf(stderr, "Error batch of %d code blocks exceeds maximum (%d)\n", nof_cb, SRSLTE_TDEC_MAX_BATCH);
+    return SRSLTE_ERROR;
+  }
+
+  if (max_iterations == 0) {
+    max_iterations = 1;
+  }
+
+  for (uint32_t i = 0; i < nof_cb; i++) {
+    if (cb[i].long_cb > h->max_long_cb || srslte_cbsegm_cbindex(cb[i].long_cb) < 0 ||
+        cb[i].tb_idx >= SRSLTE_TDEC_MAX_BATCH) {
+      fprintf(stderr, "Invalid CB length %d or TB index %d\n", cb[i].long_cb, cb[i].tb_idx);
+      return SRSLTE_ERROR;
+    }
+    cb[i].crc_ok = false;
+    cb[i].nof_iterations = 0;
+    failed[cb[i].tb_idx] = false;
+  }
+
+  for (uint32_t i = 0; i < nof_cb; i++) {
+    if (nof_windows_cb(h->nof_lanes, cb[i].long_cb) == h->nof_lanes) {
+      if (!failed[cb[i].tb_idx]) {
+        batch_run_windowed(h, &cb[i], cb[i].max_iterations ? cb[i].max_iterations : max_iterations);
+        failed[cb[i].tb_idx] = stop_on_error && cb[i].crc && !cb[i].crc_ok;
+      }
+    } else {
+      /* Longest first, so that code blocks running together have similar lengths */
+      uint32_t j = nof_short++;
+      while (j > 0 && cb[order[j-1]].long_cb < cb[i].long_cb) {
+        order[j] = order[j-1];
+        j--;
+      }
+      order[j] = i;
+    }
+  }
+  nof_cb = nof_short;
+
+  for (uint32_t l = 0; l < h->nof_lanes; l++) {
+    while (next < nof_cb && failed[cb[order[next]].tb_idx]) {
+      next++;
+    }
+    batch_lane_load(h, l, next < nof_cb ? &cb[order[next++]] : NULL);
+    if (h->lane[l].cb) {
+      nof_active++;
+    }
+  }
+
+  while (nof_active) {
+    // Run MAP DEC #1
+    for (uint32_t l = 0; l < h->nof_lanes; l++) {
+      srslte_tdec_avx_lane_t *lane = &h->lane[l];
+      if (lane->cb) {
+        if (lane->n_iter == 0) {
+          srslte_tdec_sse_deinterleave_input(lane->cb->input, lane->syst, lane->parity0, lane->parity1,
+                                             lane->app2, lane->cb->long_cb);
+          srslte_tdec_sse_normalize_input(lane->syst, lane->parity0, lane->parity1, lane->app2, lane->cb->long_cb);
+        } else {
+          srslte_vec_sub_sss(lane->app1, lane->ext1, lane->app1, lane->cb->long_cb);
+          srslte_tdec_sse_scale_extrinsic(lane->app1, lane->cb->long_cb);
+        }
+        in[l]  = lane->syst;
+        ap[l]  = lane->n_iter ? lane->app1 : NULL;
+        pa[l]  = lane->parity0;
+        out[l] = lane->ext1;
+      }
+    }
+    batch_map_dec(h, in, ap, pa, out);
+
+    // Run MAP DEC #2 with the interleaved extrinsic information of DEC #1
+    for (uint32_t l = 0; l < h->nof_lanes; l++) {
+      srslte_tdec_avx_lane_t *lane = &h->lane[l];
+      if (lane->cb) {
+        if (lane->n_iter > 0) {
+          srslte_vec_sub_sss(lane->ext1, lane->app1, lane->ext1, lane->cb->long_cb);
+        }
+        srslte_vec_lut_sss(lane->ext1, h->interleaver[lane->cbidx].reverse, lane->app2, lane->cb->long_cb);
+        in[l]  = lane->app2;
+        ap[l]  = NULL;
+        pa[l]  = lane->parity1;
+        out[l] = lane->ext2;
+      }
+    }
+    batch_map_dec(h, in, ap, pa, out);
+
+    // Decide and check CRC
+    for (uint32_t l = 0; l < h->nof_lanes; l++) {
+      srslte_tdec_avx_lane_t *lane = &h->lane[l];
+      srslte_tdec_cb_t *c = lane->cb;
+      if (c) {
+        uint32_t cb_max_iterations = c->max_iterations ? c->max_iterations : max_iterations;
+        srslte_vec_lut_sss(lane->ext2, h->interleaver[lane->cbidx].forward, lane->app1, c->long_cb);
+        lane->n_iter++;
+        c->nof_iterations = lane->n_iter;
+
+        if (c->crc) {
+          c->crc_ok = !tdec_avx_decision_crc(lane->app1, c->output, c->long_cb, c->crc, c->len_crc, &c->nof_changes);
+          lane->n_stall = (lane->n_iter > 1 && c->nof_changes == 0) ? lane->n_stall + 1 : 0;
+        } else if (lane->n_iter >= cb_max_iterations) {
+          tdec_avx_decision_byte(lane->app1, c->output, c->long_cb);
+        }
+
+        lane->done = c->crc_ok || lane->n_iter >= cb_max_iterations || (c->max_stall && lane->n_stall >= c->max_stall);
+        if (lane->done && stop_on_error && c->crc && !c->crc_ok) {
+          failed[c->tb_idx] = true;
+        }
+      }
+    }
+
+    // Refill the lanes that finished or whose transport block failed
+    for (uint32_t l = 0; l < h->nof_lanes; l++) {
+      srslte_tdec_avx_lane_t *lane = &h->lane[l];
+      if (lane->cb && (lane->done || failed[lane->cb->tb_idx])) {
+        while (next < nof_cb && failed[cb[order[next]].tb_idx]) {
+          next++;
+        }
+        batch_lane_load(h, l, next < nof_cb ? &cb[order[next++]] : NULL);
+        if (!lane->cb) {
+          nof_active--;
+        }
+      }
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+#endif /* LV_HAVE_AVX2 */
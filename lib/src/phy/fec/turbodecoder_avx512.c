@@ -0,0 +1,176 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdint.h>
+
+#include "srslte/phy/fec/turbodecoder_avx.h"
+#include "turbodecoder_avx512.h"
+
+#ifdef LV_HAVE_AVX512
+#include <immintrin.h>
+#endif
+
+#ifdef LV_HAVE_AVX512
+
+/* Computes max(bp)-max(bn) for each lane. The result is left in the 1st 16-bit word of the lane */
+static inline __m512i hMaxDiff_avx512(__m512i bn, __m512i bp)
+{
+  __m512i m = _mm512_max_epi16(_mm512_unpacklo_epi64(bn, bp), _mm512_unpackhi_epi64(bn, bp));
+  m = _mm512_max_epi16(m, _mm512_shuffle_epi32(m, (_MM_PERM_ENUM) 0xB1));
+  m = _mm512_max_epi16(m, _mm512_srli_epi32(m, 16));
+  return _mm512_sub_epi16(_mm512_bsrli_epi128(m, 8), m);
+}
+
+/* Computes alpha metrics of 4 lanes in parallel. See map_avx2_alpha() in turbodecoder_avx.c */
+void srslte_tdec_avx512_alpha(map_avx_t * s, int16_t *init, uint32_t len, const uint32_t *lane_start)
+{
+  uint32_t k;
+
+  __m512i shuf_ap = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_AP));
+  __m512i shuf_an = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_AN));
+  __m512i shuf_norm = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_NORM));
+  __m512i start = _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i*) srslte_tdec_avx_alpha_start));
+
+  __m512i shuf_g[4];
+  shuf_g[0] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_ALPHA_G0));
+  shuf_g[1] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_ALPHA_G1));
+  shuf_g[2] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_ALPHA_G2));
+  shuf_g[3] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_ALPHA_G3));
+
+  __m512i *alphaPtr = (__m512i*) s->alpha;
+  __m512i *gPtr = (__m512i*) s->branch;
+  __m512i gv, g, ap, an, norm;
+
+  __m512i alpha_k = _mm512_load_si512(init);
+  _mm512_store_si512(alphaPtr, alpha_k);
+  alphaPtr++;
+
+#define ALPHA_STEP_AVX512(c)  g = _mm512_shuffle_epi8(gv, shuf_g[c]); \
+  ap = _mm512_add_epi16(alpha_k, g);\
+  an = _mm512_sub_epi16(alpha_k, g);\
+  ap = _mm512_shuffle_epi8(ap, shuf_ap);\
+  an = _mm512_shuffle_epi8(an, shuf_an);\
+  alpha_k = _mm512_max_epi16(ap, an);\
+  _mm512_store_si512(alphaPtr, alpha_k);\
+  alphaPtr++;
+
+  for (k = 0; k < len/8; k++) {
+    if (lane_start) {
+      __mmask32 mask = 0;
+      for (uint32_t l = 0; l < 4; l++) {
+        if (lane_start[l] == 8*k) {
+          mask |= 0xFFu<<(8*l);
+        }
+      }
+      if (mask) {
+        alpha_k = _mm512_mask_blend_epi16(mask, alpha_k, start);
+        _mm512_store_si512(alphaPtr - 1, alpha_k);
+      }
+    }
+    gv = _mm512_load_si512(gPtr);
+    gPtr++;
+    ALPHA_STEP_AVX512(0);
+    ALPHA_STEP_AVX512(1);
+    ALPHA_STEP_AVX512(2);
+    ALPHA_STEP_AVX512(3);
+    norm = _mm512_shuffle_epi8(alpha_k, shuf_norm);
+    alpha_k = _mm512_sub_epi16(alpha_k, norm);
+    gv = _mm512_load_si512(gPtr);
+    gPtr++;
+    ALPHA_STEP_AVX512(0);
+    ALPHA_STEP_AVX512(1);
+    ALPHA_STEP_AVX512(2);
+    ALPHA_STEP_AVX512(3);
+    norm = _mm512_shuffle_epi8(alpha_k, shuf_norm);
+    alpha_k = _mm512_sub_epi16(alpha_k, norm);
+  }
+
+  _mm512_store_si512(init, alpha_k);
+}
+
+/* Computes beta metrics and the output LLR of 4 lanes in parallel. See map_avx2_beta() in turbodecoder_avx.c */
+void srslte_tdec_avx512_beta(map_avx_t * s, int16_t *init, int16_t **output, uint32_t nof_out, uint32_t len)
+{
+  int k;
+  int16_t llr[32] __attribute__((aligned(64)));
+
+  __m512i shuf_bp = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BP));
+  __m512i shuf_bn = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BN));
+  __m512i shuf_norm = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_NORM));
+
+  __m512i shuf_g[4];
+  shuf_g[0] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BETA_G0));
+  shuf_g[1] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BETA_G1));
+  shuf_g[2] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BETA_G2));
+  shuf_g[3] = _mm512_broadcast_i32x4(_mm_set_epi8(SHUF_BETA_G3));
+
+  const __m512i *alphaPtr = (const __m512i*) s->alpha + len - 1;
+  __m512i *gPtr = (__m512i*) s->branch + len/4 - 1;
+  __m512i gv, g, bp, bn, alpha_k, out, norm;
+
+  __m512i beta_k = _mm512_load_si512(init);
+
+#define BETA_STEP_AVX512(g)     bp = _mm512_add_epi16(beta_k, g);\
+    bn = _mm512_sub_epi16(beta_k, g);\
+    bp = _mm512_shuffle_epi8(bp, shuf_bp);\
+    bn = _mm512_shuffle_epi8(bn, shuf_bn);\
+    beta_k = _mm512_max_epi16(bp, bn);
+
+#define BETA_STEP_CNT_AVX512(c,d) g = _mm512_shuffle_epi8(gv, shuf_g[c]);\
+    BETA_STEP_AVX512(g)\
+    alpha_k = _mm512_load_si512(alphaPtr);\
+    alphaPtr--;\
+    bp = _mm512_add_epi16(bp, alpha_k);\
+    bn = _mm512_add_epi16(bn, alpha_k);\
+    out = hMaxDiff_avx512(bn, bp);\
+    _mm512_store_si512(llr, out);\
+    for (uint32_t l = 0; l < nof_out; l++) {\
+      output[l][k-d] = llr[8*l];\
+    }
+
+  for (k = len-1; k >= 0; k-=8) {
+    gv = _mm512_load_si512(gPtr);
+    gPtr--;
+    BETA_STEP_CNT_AVX512(0,0);
+    BETA_STEP_CNT_AVX512(1,1);
+    BETA_STEP_CNT_AVX512(2,2);
+    BETA_STEP_CNT_AVX512(3,3);
+    norm = _mm512_shuffle_epi8(beta_k, shuf_norm);
+    beta_k = _mm512_sub_epi16(beta_k, norm);
+    gv = _mm512_load_si512(gPtr);
+    gPtr--;
+    BETA_STEP_CNT_AVX512(0,4);
+    BETA_STEP_CNT_AVX512(1,5);
+    BETA_STEP_CNT_AVX512(2,6);
+    BETA_STEP_CNT_AVX512(3,7);
+    norm = _mm512_shuffle_epi8(beta_k, shuf_norm);
+    beta_k = _mm512_sub_epi16(beta_k, norm);
+  }
+
+  _mm512_store_si512(init, beta_k);
+}
+
+#endif /* LV_HAVE_AVX512 */
@@ -0,0 +1,67 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef TURBODECODER_AVX512_
+#define TURBODECODER_AVX512_
+
+#include <stdint.h>
+#include "srslte/phy/fec/turbodecoder_avx.h"
+
+/* Trellis shuffles. They are the same used by the SSE decoder and are applied to each 128-bit
+ * lane (one window) independently */
+#define SHUF_BP   15, 14, 7, 6, 5, 4, 13, 12, 11, 10, 3, 2, 1, 0, 9, 8
+#define SHUF_BN   7, 6, 15, 14, 13, 12, 5, 4, 3, 2, 11, 10, 9, 8, 1, 0
+#define SHUF_AP   15, 14, 9, 8, 7, 6, 1, 0, 13, 12, 11, 10, 5, 4, 3, 2
+#define SHUF_AN   13, 12, 11, 10, 5, 4, 3, 2, 15, 14, 9, 8, 7, 6, 1, 0
+#define SHUF_NORM 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0
+
+#define SHUF_BETA_G0  15,14,13,12,13,12,15,14,15,14,13,12,13,12,15,14
+#define SHUF_BETA_G1  11,10,9,8,9,8,11,10,11,10,9,8,9,8,11,10
+#define SHUF_BETA_G2  7,6,5,4,5,4,7,6,7,6,5,4,5,4,7,6
+#define SHUF_BETA_G3  3,2,1,0,1,0,3,2,3,2,1,0,1,0,3,2
+
+#define SHUF_ALPHA_G0 3,2,3,2,1,0,1,0,1,0,1,0,3,2,3,2
+#define SHUF_ALPHA_G1 7,6,7,6,5,4,5,4,5,4,5,4,7,6,7,6
+#define SHUF_ALPHA_G2 11,10,11,10,9,8,9,8,9,8,9,8,11,10,11,10
+#define SHUF_ALPHA_G3 15,14,15,14,13,12,13,12,13,12,13,12,15,14,15,14
+
+/* Initial alpha metrics: the trellis starts at state 0 */
+extern const int16_t srslte_tdec_avx_alpha_start[8];
+
+/* AVX-512 kernels of the sliding window decoder. They live in turbodecoder_avx512.c, the only file 
+ * built with the AVX-512 instruction set, and run only if the CPU supports it */
+void srslte_tdec_avx512_alpha(map_avx_t * s, 
+                              int16_t *init, 
+                              uint32_t len, 
+                              const uint32_t *lane_start);
+
+void srslte_tdec_avx512_beta(map_avx_t * s, 
+                             int16_t *init, 
+                             int16_t **output, 
+                             uint32_t nof_out, 
+                             uint32_t len);
+
+#endif
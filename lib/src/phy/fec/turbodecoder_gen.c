@@ -376,6 +376,24 @@ void srslte_tdec_gen_decision_byte(srslte_tdec_gen_t * h, uint8_t *output, uint3
   }
 }
 
+/* Decides bytes [first, first+nbytes) of the output and returns how many bits differ from the 
+ * ones that were in output */
+uint32_t srslte_tdec_gen_decision_byte_diff(srslte_tdec_gen_t * h, uint8_t *output, uint32_t first, uint32_t nbytes)
+{
+  uint16_t *deinter = h->interleaver[h->current_cbidx].reverse;
+  uint32_t changes = 0;
+
+  for (uint32_t i = first; i < first + nbytes; i++) {
+    uint8_t out_byte = 0;
+    for (int j = 0; j < 8; j++) {
+      out_byte |= (h->llr2[deinter[8*i+j]] > 0) << (7-j);
+    }
+    changes += __builtin_popcount(out_byte ^ output[i]);
+    output[i] = out_byte;
+  }
+  return changes;
+}
+
 int srslte_tdec_gen_run_all(srslte_tdec_gen_t * h, float * input, uint8_t *output,
                   uint32_t nof_iterations, uint32_t long_cb)
 {
@@ -333,8 +333,8 @@ void map_gen_free(map_gen_t * h)
 }
 
 /* Runs one instance of a decoder */
-void map_gen_dec(map_gen_t * h, int16_t * input, int16_t *app, int16_t * parity, int16_t * output,
-                 uint32_t long_cb)
+void srslte_tdec_sse_map_dec(map_gen_t * h, int16_t * input, int16_t *app, int16_t * parity, int16_t * output,
+                             uint32_t long_cb)
 {
  
   // Compute branch metrics
@@ -348,6 +348,74 @@ void map_gen_dec(map_gen_t * h, int16_t * input, int16_t *app, int16_t * parity,
   
 }
 
+/* Scales the deinterleaved soft bits of a code block down, if needed, so that none exceeds 
+ * SRSLTE_TDEC_SSE_INPUT_MAX. The max-log-MAP decision does not depend on the scale of the input, 
+ * but the int16 branch and state metrics computed from it would wrap around for large inputs. 
+ */
+void srslte_tdec_sse_normalize_input(int16_t *syst, int16_t *parity0, int16_t *parity1, int16_t *app2, 
+                                     uint32_t long_cb)
+{
+  int16_t *streams[3] = {syst, parity0, parity1};
+  __m128i m = _mm_setzero_si128(); 
+  uint32_t max = 0; 
+
+  for (int s = 0; s < 3; s++) {
+    __m128i *xPtr = (__m128i*) streams[s]; 
+    for (uint32_t i = 0; i < long_cb/8; i++) {
+      m = _mm_max_epu16(m, _mm_abs_epi16(_mm_load_si128(xPtr)));
+      xPtr++;
+    }
+  }
+  // The horizontal maximum of unsigned values is the complement of the minimum of their complements
+  m = _mm_minpos_epu16(_mm_xor_si128(m, _mm_set1_epi16(-1)));
+  max = 0xFFFF & ~_mm_cvtsi128_si32(m); 
+  for (uint32_t i = long_cb; i < long_cb + 3; i++) {
+    max = SRSLTE_MAX(max, (uint32_t) abs(syst[i]));
+    max = SRSLTE_MAX(max, (uint32_t) abs(parity0[i]));
+    max = SRSLTE_MAX(max, (uint32_t) abs(parity1[i]));
+    max = SRSLTE_MAX(max, (uint32_t) abs(app2[i]));
+  }
+
+  if (max > SRSLTE_TDEC_SSE_INPUT_MAX) {
+    int16_t f = (int16_t) ((SRSLTE_TDEC_SSE_INPUT_MAX << 15) / max);
+    __m128i fv = _mm_set1_epi16(f);
+    for (int s = 0; s < 3; s++) {
+      __m128i *xPtr = (__m128i*) streams[s]; 
+      for (uint32_t i = 0; i < long_cb/8; i++) {
+        _mm_store_si128(xPtr, _mm_mulhrs_epi16(_mm_load_si128(xPtr), fv));
+        xPtr++;
+      }
+      for (uint32_t i = long_cb; i < long_cb + 3; i++) {
+        streams[s][i] = (int16_t) ((streams[s][i] * f + (1 << 14)) >> 15);
+      }
+    }
+    for (uint32_t i = long_cb; i < long_cb + 3; i++) {
+      app2[i] = (int16_t) ((app2[i] * f + (1 << 14)) >> 15);
+    }
+  }
+}
+
+/* Scales the extrinsic information by 3/4 and saturates it to +-SRSLTE_TDEC_SSE_EXT_MAX. The 
+ * extrinsic information is fed back as a priori information in every iteration and would otherwise 
+ * grow until the int16 branch and state metrics wrap around. 
+ */
+void srslte_tdec_sse_scale_extrinsic(int16_t *ext, uint32_t long_cb)
+{
+  __m128i *extPtr = (__m128i*) ext; 
+  __m128i max = _mm_set1_epi16(SRSLTE_TDEC_SSE_EXT_MAX); 
+  __m128i min = _mm_set1_epi16(-SRSLTE_TDEC_SSE_EXT_MAX); 
+  __m128i e; 
+  
+  // long_cb is always a multiple of 8
+  for (uint32_t i = 0; i < long_cb/8; i++) {
+    e = _mm_load_si128(extPtr);
+    e = _mm_sub_epi16(e, _mm_srai_epi16(e, 2));
+    e = _mm_min_epi16(_mm_max_epi16(e, min), max);
+    _mm_store_si128(extPtr, e);
+    extPtr++;
+  }
+}
+
 /* Initializes the turbo decoder object */
 int srslte_tdec_sse_init(srslte_tdec_sse_t * h, uint32_t max_long_cb)
 {
@@ -445,9 +513,11 @@ void srslte_tdec_sse_free(srslte_tdec_sse_t * h)
 }
 
 /* Deinterleaves the 3 streams from the input (systematic and 2 parity bits) into 
- * 3 buffers ready to be used by compute_gamma() 
+ * 3 buffers ready to be used by compute_gamma(). The tail of the 2nd decoder systematic 
+ * stream is written into app2
  */
-void deinterleave_input(srslte_tdec_sse_t *h, int16_t *input, uint32_t long_cb) {
+void srslte_tdec_sse_deinterleave_input(int16_t *input, int16_t *syst, int16_t *parity0, int16_t *parity1, 
+                                        int16_t *app2, uint32_t long_cb) {
   uint32_t i;
  
   __m128i *inputPtr = (__m128i*) input; 
@@ -456,9 +526,9 @@ void deinterleave_input(srslte_tdec_sse_t *h, int16_t *input, uint32_t long_cb)
   __m128i p00, p01, p02, p0;
   __m128i p10, p11, p12, p1;
   
-  __m128i *sysPtr = (__m128i*) h->syst; 
-  __m128i *pa0Ptr = (__m128i*) h->parity0; 
-  __m128i *pa1Ptr = (__m128i*) h->parity1; 
+  __m128i *sysPtr = (__m128i*) syst; 
+  __m128i *pa0Ptr = (__m128i*) parity0; 
+  __m128i *pa1Ptr = (__m128i*) parity1; 
   
   // pick bits 0, 3, 6 from 1st word
   __m128i s0_mask = _mm_set_epi8(0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,13,12,7,6,1,0);
@@ -521,12 +591,12 @@ void deinterleave_input(srslte_tdec_sse_t *h, int16_t *input, uint32_t long_cb)
   }
   
   for (i = 0; i < 3; i++) {
-    h->syst[i+long_cb]    = input[3*long_cb + 2*i];
-    h->parity0[i+long_cb] = input[3*long_cb + 2*i + 1];
+    syst[i+long_cb]    = input[3*long_cb + 2*i];
+    parity0[i+long_cb] = input[3*long_cb + 2*i + 1];
   }
   for (i = 0; i < 3; i++) {
-    h->app2[i+long_cb]    = input[3*long_cb + 6 + 2*i];
-    h->parity1[i+long_cb] = input[3*long_cb + 6 + 2*i + 1];
+    app2[i+long_cb]    = input[3*long_cb + 6 + 2*i];
+    parity1[i+long_cb] = input[3*long_cb + 6 + 2*i + 1];
   }
 
 }
@@ -540,19 +610,21 @@ void srslte_tdec_sse_iteration(srslte_tdec_sse_t * h, int16_t * input, uint32_t
     uint16_t *deinter = h->interleaver[h->current_cbidx].reverse;
     
     if (h->n_iter == 0) {
-      deinterleave_input(h, input, long_cb);
+      srslte_tdec_sse_deinterleave_input(input, h->syst, h->parity0, h->parity1, h->app2, long_cb);
+      srslte_tdec_sse_normalize_input(h->syst, h->parity0, h->parity1, h->app2, long_cb);
     }
     
     // Add apriori information to decoder 1 
     if (h->n_iter > 0) {
       srslte_vec_sub_sss(h->app1, h->ext1, h->app1, long_cb);
+      srslte_tdec_sse_scale_extrinsic(h->app1, long_cb);
     }
         
     // Run MAP DEC #1
     if (h->n_iter == 0) {
-      map_gen_dec(&h->dec, h->syst, NULL, h->parity0, h->ext1, long_cb);            
+      srslte_tdec_sse_map_dec(&h->dec, h->syst, NULL, h->parity0, h->ext1, long_cb);            
     } else {
-      map_gen_dec(&h->dec, h->syst, h->app1, h->parity0, h->ext1, long_cb);      
+      srslte_tdec_sse_map_dec(&h->dec, h->syst, h->app1, h->parity0, h->ext1, long_cb);      
     }
 
     // Convert aposteriori information into extrinsic information    
@@ -564,7 +636,7 @@ void srslte_tdec_sse_iteration(srslte_tdec_sse_t * h, int16_t * input, uint32_t
     srslte_vec_lut_sss(h->ext1, deinter, h->app2, long_cb);
 
     // Run MAP DEC #2. 2nd decoder uses apriori information as systematic bits
-    map_gen_dec(&h->dec, h->app2, NULL, h->parity1, h->ext2, long_cb);
+    srslte_tdec_sse_map_dec(&h->dec, h->app2, NULL, h->parity1, h->ext2, long_cb);
 
     // Deinterleaved extrinsic bits become apriori info for decoder 1 
     srslte_vec_lut_sss(h->ext2, inter, h->app1, long_cb);
@@ -637,6 +709,37 @@ void srslte_tdec_sse_decision_byte(srslte_tdec_sse_t * h, uint8_t *output, uint3
   }
 }
 
+/* Decides bytes [first, first+nbytes) of the output with 16 bits per step and returns how many
+ * bits differ from the ones that were in output, i.e. the sign changes since the previous decision */
+uint32_t srslte_tdec_sse_decision_byte_diff(srslte_tdec_sse_t * h, uint8_t *output, uint32_t first, uint32_t nbytes)
+{
+  uint8_t mask[8] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
+  __m128i zero = _mm_setzero_si128();
+  __m128i rev  = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+  int16_t *app = &h->app1[8*first];
+  uint32_t changes = 0, i;
+
+  output = &output[first];
+  for (i = 0; i < nbytes/2; i++) {
+    __m128i d0 = _mm_cmpgt_epi16(_mm_loadu_si128((__m128i*) &app[16*i]), zero);
+    __m128i d1 = _mm_cmpgt_epi16(_mm_loadu_si128((__m128i*) &app[16*i+8]), zero);
+    uint16_t bits = (uint16_t) _mm_movemask_epi8(_mm_shuffle_epi8(_mm_packs_epi16(d0, d1), rev));
+    uint16_t prev;
+    memcpy(&prev, &output[2*i], sizeof(uint16_t));
+    changes += __builtin_popcount(bits ^ prev);
+    memcpy(&output[2*i], &bits, sizeof(uint16_t));
+  }
+  for (i = 2*i; i < nbytes; i++) {
+    uint8_t out_byte = 0;
+    for (int j = 0; j < 8; j++) {
+      out_byte |= app[8*i+j]>0?mask[j]:0;
+    }
+    changes += __builtin_popcount(out_byte ^ output[i]);
+    output[i] = out_byte;
+  }
+  return changes;
+}
+
 /* Runs nof_iterations iterations and decides the output bits */
 int srslte_tdec_sse_run_all(srslte_tdec_sse_t * h, int16_t * input, uint8_t *output,
                   uint32_t nof_iterations, uint32_t long_cb)
@@ -76,6 +76,52 @@ int decode37(void *o, uint8_t *symbols, uint8_t *data, uint32_t frame_length) {
 }
 
 
+/* The batched decoder normalizes the metrics after each pass through the trellis and compares them 
+ * as signed 16-bit words, which bounds the number of steps per pass */
+#define BATCH_MAX_STEPS 1024
+
+static void free37_batch(srslte_viterbi_t *q) {
+  if (q->batch_symbols) {
+    free(q->batch_symbols);
+  }
+  if (q->batch_decisions) {
+    free(q->batch_decisions);
+  }
+  q->batch_symbols = NULL;
+  q->batch_decisions = NULL;
+}
+
+static int init37_batch(srslte_viterbi_t *q, int poly[3], void (*update)(uint16_t*, uint8_t*, uint8_t*, uint32_t*, uint32_t)) {
+  q->update_batch = NULL;
+  q->batch_symbols = NULL;
+  q->batch_decisions = NULL;
+  q->reject_threshold = 0;
+  if (q->framebits + q->K - 1 > BATCH_MAX_STEPS) {
+    return 0;
+  }
+  for (int i = 0; i < 32; i++) {
+    q->batch_branch[i] = 0;
+    for (int k = 0; k < 3; k++) {
+      if ((poly[k] < 0) ^ parity((2 * i) & abs(poly[k]))) {
+        q->batch_branch[i] |= 1 << k;
+      }
+    }
+  }
+  q->batch_symbols = srslte_vec_malloc(3 * (q->framebits + q->K - 1) * SRSLTE_VITERBI_MAX_BATCH * sizeof(uint8_t));
+  if (!q->batch_symbols) {
+    perror("malloc");
+    return -1;
+  }
+  q->batch_decisions = srslte_vec_malloc(TB_ITER * (q->framebits + q->K - 1) * 32 * sizeof(uint32_t));
+  if (!q->batch_decisions) {
+    perror("malloc");
+    free37_batch(q);
+    return -1;
+  }
+  q->update_batch = update;
+  return 0;
+}
+
 #ifdef LV_HAVE_SSE
 int decode37_sse(void *o, uint8_t *symbols, uint8_t *data, uint32_t frame_length) {
   srslte_viterbi_t *q = o;
@@ -109,6 +155,7 @@ int decode37_sse(void *o, uint8_t *symbols, uint8_t *data, uint32_t frame_length
 
 void free37_sse(void *o) {
   srslte_viterbi_t *q = o;
+  free37_batch(q);
   if (q->symbols_uc) {
     free(q->symbols_uc);
   }
@@ -155,6 +202,7 @@ int decode37_avx2(void *o, uint8_t *symbols, uint8_t *data, uint32_t frame_lengt
 
 void free37_avx2(void *o) {
   srslte_viterbi_t *q = o;
+  free37_batch(q);
   if (q->symbols_uc) {
     free(q->symbols_uc);
   }
@@ -199,6 +247,7 @@ int decode37_neon(void *o, uint8_t *symbols, uint8_t *data, uint32_t frame_lengt
 
 void free37_neon(void *o) {
   srslte_viterbi_t *q = o;
+  free37_batch(q);
   if (q->symbols_uc) {
     free(q->symbols_uc);
   }
@@ -212,6 +261,7 @@ void free37_neon(void *o) {
 
 void free37(void *o) {
   srslte_viterbi_t *q = o;
+  free37_batch(q);
   if (q->symbols_uc) {
     free(q->symbols_uc);
   }
@@ -231,9 +281,13 @@ int init37(srslte_viterbi_t *q, int poly[3], uint32_t framebits, bool tail_bitin
   q->decode = decode37;
   q->free = free37;
   q->decode_f = NULL;
+  if (init37_batch(q, poly, update_viterbi37_batch_port)) {
+    return -1;
+  }
   q->symbols_uc = srslte_vec_malloc(3 * (q->framebits + q->K - 1) * sizeof(uint8_t));
   if (!q->symbols_uc) {
     perror("malloc");
+    free37_batch(q);
     return -1;
   }
   if (q->tail_biting) {
@@ -268,9 +322,13 @@ int init37_sse(srslte_viterbi_t *q, int poly[3], uint32_t framebits, bool tail_b
   q->decode = decode37_sse;
   q->free = free37_sse;
   q->decode_f = NULL;
+  if (init37_batch(q, poly, update_viterbi37_batch_port)) {
+    return -1;
+  }
   q->symbols_uc = srslte_vec_malloc(3 * (q->framebits + q->K - 1) * sizeof(uint8_t));
   if (!q->symbols_uc) {
     perror("malloc");
+    free37_batch(q);
     return -1;
   }
   if (q->tail_biting) {
@@ -306,9 +364,13 @@ int init37_neon(srslte_viterbi_t *q, int poly[3], uint32_t framebits, bool tail_
   q->free = free37_neon;
   q->decode_f = NULL;
   printf("USING NEON VITERBI***************\n");
+  if (init37_batch(q, poly, update_viterbi37_batch_port)) {
+    return -1;
+  }
   q->symbols_uc = srslte_vec_malloc(3 * (q->framebits + q->K - 1) * sizeof(uint8_t));
   if (!q->symbols_uc) {
     perror("malloc");
+    free37_batch(q);
     return -1;
   }
   if (q->tail_biting) {
@@ -344,9 +406,13 @@ int init37_avx2(srslte_viterbi_t *q, int poly[3], uint32_t framebits, bool tail_
   q->decode = decode37_avx2;
   q->free = free37_avx2;
   q->decode_f = NULL;
+  if (init37_batch(q, poly, update_viterbi37_batch_avx2)) {
+    return -1;
+  }
   q->symbols_uc = srslte_vec_malloc(3 * (q->framebits + q->K - 1) * sizeof(uint8_t));
   if (!q->symbols_uc) {
     perror("malloc");
+    free37_batch(q);
     return -1;
   }
   if (q->tail_biting) {
@@ -481,3 +547,175 @@ int srslte_viterbi_decode_uc(srslte_viterbi_t *q, uint8_t *symbols, uint8_t *dat
 {
   return q->decode(q, symbols, data, frame_length);
 }
+
+void srslte_viterbi_set_reject_threshold(srslte_viterbi_t *q, float threshold) {
+  q->reject_threshold = threshold;
+}
+
+/* Decodes up to SRSLTE_VITERBI_MAX_BATCH codewords already interleaved in q->batch_symbols. 
+ * Tail-biting codewords are run TB_ITER times through the trellis, like in the single decoder. 
+ * After every pass, the best path metric of each lane is placed between the metric of the 
+ * hard-decided symbols (0, a valid noiseless codeword) and that of their complement (1). Lanes 
+ * above reject_threshold are dropped and the remaining passes are skipped if all lanes are dropped. 
+ */
+static int decode37_batch(srslte_viterbi_t *q, uint8_t **data, bool *valid, uint32_t nof_cw, uint32_t frame_length) {
+  const uint32_t B = SRSLTE_VITERBI_MAX_BATCH;
+  uint16_t metrics[64 * SRSLTE_VITERBI_MAX_BATCH];
+  uint32_t best_metric[SRSLTE_VITERBI_MAX_BATCH];
+  uint32_t hard_metric[SRSLTE_VITERBI_MAX_BATCH];
+  uint32_t nof_valid = nof_cw;
+
+  uint32_t nof_steps = q->tail_biting ? frame_length : frame_length + q->K - 1;
+  uint32_t nof_passes = q->tail_biting ? TB_ITER : 1;
+
+  for (uint32_t i = 0; i < 64 * B; i++) {
+    metrics[i] = (q->tail_biting || i < B) ? 0 : 63;
+  }
+  for (uint32_t l = 0; l < nof_cw; l++) {
+    valid[l] = true;
+    best_metric[l] = 0;
+    hard_metric[l] = 0;
+  }
+  if (q->reject_threshold > 0) {
+    uint8_t *x = q->batch_symbols;
+    for (uint32_t i = 0; i < nof_steps; i++) {
+      for (uint32_t l = 0; l < nof_cw; l++) {
+        uint32_t s0 = SRSLTE_MIN(x[l], 255 - x[l]);
+        uint32_t s1 = SRSLTE_MIN(x[B + l], 255 - x[B + l]);
+        uint32_t s2 = SRSLTE_MIN(x[2 * B + l], 255 - x[2 * B + l]);
+        hard_metric[l] += ((((s0 + s1 + 1) >> 1) + s2 + 1) >> 1) >> 3;
+      }
+      x += 3 * B;
+    }
+  }
+
+  uint32_t *d = q->batch_decisions;
+  uint32_t p = 0;
+  while (p < nof_passes && nof_valid > 0) {
+    q->update_batch(metrics, q->batch_branch, q->batch_symbols, d, nof_steps);
+    d += 32 * nof_steps;
+    p++;
+
+    for (uint32_t l = 0; l < B; l++) {
+      uint16_t min = UINT16_MAX;
+      for (uint32_t s = 0; s < 64; s++) {
+        if (metrics[s * B + l] < min) {
+          min = metrics[s * B + l];
+        }
+      }
+      for (uint32_t s = 0; s < 64; s++) {
+        metrics[s * B + l] -= min;
+      }
+      if (l < nof_cw) {
+        best_metric[l] += min;
+        uint32_t lower = p * hard_metric[l];
+        uint32_t upper = p * (31 * nof_steps - hard_metric[l]);
+        if (valid[l] && q->reject_threshold > 0 && best_metric[l] > lower + q->reject_threshold * (upper - lower)) {
+          valid[l] = false;
+          nof_valid--;
+        }
+      }
+    }
+  }
+
+  /* Chainback the surviving lanes. Tail-biting codewords start from the best state and output 
+   * the middle pass, terminated codewords start from state 0. All lanes are traced together so 
+   * that their dependency chains overlap. */
+  if (nof_valid > 0) {
+    uint32_t state[SRSLTE_VITERBI_MAX_BATCH];
+    uint32_t out_start = q->tail_biting ? frame_length : 0;
+    for (uint32_t l = 0; l < nof_cw; l++) {
+      state[l] = 0;
+      if (q->tail_biting) {
+        for (uint32_t s = 0; s < 64; s++) {
+          if (metrics[s * B + l] <= metrics[state[l] * B + l]) {
+            state[l] = s;
+          }
+        }
+      }
+    }
+    for (uint32_t t = p * nof_steps - 1; t >= out_start; t--) {
+      uint32_t *dt = &q->batch_decisions[t * 32];
+      if (t < out_start + frame_length) {
+        for (uint32_t l = 0; l < nof_cw; l++) {
+          if (valid[l]) {
+            data[l][t - out_start] = state[l] & 1;
+          }
+        }
+      }
+      if (t == out_start) {
+        break;
+      }
+      for (uint32_t l = 0; l < nof_cw; l++) {
+        uint32_t k = (dt[state[l] / 2] >> VITERBI37_BATCH_BIT(state[l], l)) & 1;
+        state[l] = (state[l] >> 1) | (k << 5);
+      }
+    }
+  }
+  return nof_valid;
+}
+
+int srslte_viterbi_decode_uc_batch(srslte_viterbi_t *q, uint8_t **symbols, uint8_t **data, bool *valid, uint32_t nof_cw, uint32_t frame_length)
+{
+  if (frame_length > q->framebits || !q->update_batch) {
+    fprintf(stderr, "Batched decoder not available for frame length %d bits (initialized for %d)\n",
+        frame_length, q->framebits);
+    return -1;
+  }
+  uint32_t len = q->tail_biting ? 3 * frame_length : 3 * (frame_length + q->K - 1);
+  int nof_valid = 0;
+  for (uint32_t i = 0; i < nof_cw; i += SRSLTE_VITERBI_MAX_BATCH) {
+    uint32_t n = SRSLTE_MIN(SRSLTE_VITERBI_MAX_BATCH, nof_cw - i);
+    for (uint32_t l = 0; l < SRSLTE_VITERBI_MAX_BATCH; l++) {
+      uint8_t *x = &q->batch_symbols[l];
+      if (l < n) {
+        for (uint32_t j = 0; j < len; j++) {
+          x[j * SRSLTE_VITERBI_MAX_BATCH] = symbols[i + l][j];
+        }
+      } else {
+        for (uint32_t j = 0; j < len; j++) {
+          x[j * SRSLTE_VITERBI_MAX_BATCH] = 127;
+        }
+      }
+    }
+    nof_valid += decode37_batch(q, &data[i], &valid[i], n, frame_length);
+  }
+  return nof_valid;
+}
+
+/* Each codeword is quantized with its own gain, as srslte_viterbi_decode_f() does. An all-zero 
+ * codeword (e.g. a candidate over empty REs) is not scaled and decodes from erasures */
+int srslte_viterbi_decode_f_batch(srslte_viterbi_t *q, float **symbols, uint8_t **data, bool *valid, uint32_t nof_cw, uint32_t frame_length)
+{
+  if (frame_length > q->framebits || !q->update_batch) {
+    fprintf(stderr, "Batched decoder not available for frame length %d bits (initialized for %d)\n",
+        frame_length, q->framebits);
+    return -1;
+  }
+  uint32_t len = q->tail_biting ? 3 * frame_length : 3 * (frame_length + q->K - 1);
+  int nof_valid = 0;
+  for (uint32_t i = 0; i < nof_cw; i += SRSLTE_VITERBI_MAX_BATCH) {
+    uint32_t n = SRSLTE_MIN(SRSLTE_VITERBI_MAX_BATCH, nof_cw - i);
+    for (uint32_t l = 0; l < SRSLTE_VITERBI_MAX_BATCH; l++) {
+      uint8_t *x = &q->batch_symbols[l];
+      if (l < n) {
+        float max = -9e9;
+        for (uint32_t j = 0; j < len; j++) {
+          if (fabs(symbols[i + l][j]) > max) {
+            max = fabs(symbols[i + l][j]);
+          }
+        }
+        srslte_vec_quant_fuc(symbols[i + l], q->symbols_uc, max > 0 ? q->gain_quant / max : 1.0, 127.5, 255, len);
+        for (uint32_t j = 0; j < len; j++) {
+          x[j * SRSLTE_VITERBI_MAX_BATCH] = q->symbols_uc[j];
+        }
+      } else {
+        for (uint32_t j = 0; j < len; j++) {
+          x[j * SRSLTE_VITERBI_MAX_BATCH] = 127;
+        }
+      }
+    }
+    nof_valid += decode37_batch(q, &data[i], &valid[i], n, frame_length);
+  }
+  return nof_valid;
+}
@@ -25,6 +25,13 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
+
+/* Batched decoders keep 64 states x SRSLTE_VITERBI_MAX_BATCH lanes of 16-bit path metrics. 
+ * Each trellis step writes one 32-bit decision word per butterfly i, holding the decisions of 
+ * states 2i and 2i+1 for all lanes in the bit order produced by the AVX2 pack+movemask.
+ */
+#define VITERBI37_BATCH_BIT(state, lane) (((lane) & 7) | (((state) & 1) << 3) | (((lane) >> 3) << 4))
 
 void *create_viterbi37_port(int polys[3], 
                             uint32_t len);
@@ -109,4 +116,15 @@ int update_viterbi37_blk_avx2(void *p,
                               uint32_t nbits, 
                               uint32_t *best_state);
 
+void update_viterbi37_batch_port(uint16_t *metrics, 
+                                 uint8_t *branch, 
+                                 uint8_t *syms, 
+                                 uint32_t *decisions, 
+                                 uint32_t nbits);
+
+void update_viterbi37_batch_avx2(uint16_t *metrics, 
+                                 uint8_t *branch, 
+                                 uint8_t *syms, 
+                                 uint32_t *decisions, 
+                                 uint32_t nbits);
 
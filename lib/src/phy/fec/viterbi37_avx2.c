@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <memory.h>
 #include <limits.h>
+#include "srslte/phy/fec/viterbi.h"
 #include "parity.h"
 
 //#define DEBUG
@@ -333,7 +334,66 @@ void update_viterbi37_blk_avx2(void *p,unsigned char *syms,int nbits, uint32_t *
   vp->dp = d;
 }
 
-#endif
+/* Batched update: each 256-bit register holds the 16-bit metric of one state for the 16 lanes, 
+ * so the 32 butterflies of a step are computed for all codewords at once. Only 8 different 
+ * branch metrics exist per step (one per combination of the 3 code bits) and they are formed 
+ * once and indexed by branch[i]. Metrics grow by at most 31 per step and the caller normalizes 
+ * them between calls, so unsigned 16-bit arithmetic never wraps.
+ */
+void update_viterbi37_batch_avx2(uint16_t *metrics, uint8_t *branch, uint8_t *syms, uint32_t *decisions, uint32_t nbits) {
+  __m256i metrics1[64], metrics2[64];
+  __m256i *old_metrics = metrics1, *new_metrics = metrics2, *tmp;
+  __m256i bm[16];
+
+  for (int i = 0; i < 64; i++) {
+    metrics1[i] = _mm256_loadu_si256((__m256i*) &metrics[i * SRSLTE_VITERBI_MAX_BATCH]);
+  }
+
+  const __m256i c255 = _mm256_set1_epi16(255);
+  const __m256i c31  = _mm256_set1_epi16(31);
+
+  while (nbits--) {
+    __m256i s[3], n[3];
+    for (int k = 0; k < 3; k++) {
+      s[k] = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) &syms[k * SRSLTE_VITERBI_MAX_BATCH]));
+      n[k] = _mm256_sub_epi16(c255, s[k]);
+    }
+    syms += 3 * SRSLTE_VITERBI_MAX_BATCH;
+
+    for (int c = 0; c < 8; c++) {
+      __m256i m = _mm256_avg_epu16((c & 1) ? n[0] : s[0], (c & 2) ? n[1] : s[1]);
+      m = _mm256_srli_epi16(_mm256_avg_epu16(m, (c & 4) ? n[2] : s[2]), 3);
+      bm[c]     = m;
+      bm[c + 8] = _mm256_sub_epi16(c31, m);
+    }
+
+    for (int i = 0; i < 32; i++) {
+      __m256i metric   = bm[branch[i]];
+      __m256i m_metric = bm[branch[i] + 8];
 
+      __m256i m0 = _mm256_add_epi16(old_metrics[i], metric);
+      __m256i m1 = _mm256_add_epi16(old_metrics[i + 32], m_metric);
+      __m256i m2 = _mm256_add_epi16(old_metrics[i], m_metric);
+      __m256i m3 = _mm256_add_epi16(old_metrics[i + 32], metric);
 
+      __m256i decision0 = _mm256_cmpgt_epi16(m0, m1);
+      __m256i decision1 = _mm256_cmpgt_epi16(m2, m3);
 
+      new_metrics[2 * i]     = _mm256_min_epu16(m0, m1);
+      new_metrics[2 * i + 1] = _mm256_min_epu16(m2, m3);
+
+      decisions[i] = (uint32_t) _mm256_movemask_epi8(_mm256_packs_epi16(decision0, decision1));
+    }
+    decisions += 32;
+
+    tmp = old_metrics;
+    old_metrics = new_metrics;
+    new_metrics = tmp;
+  }
+
+  for (int i = 0; i < 64; i++) {
+    _mm256_storeu_si256((__m256i*) &metrics[i * SRSLTE_VITERBI_MAX_BATCH], old_metrics[i]);
+  }
+}
+
+#endif
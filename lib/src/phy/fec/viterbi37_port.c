@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <memory.h>
+#include "srslte/phy/fec/viterbi.h"
 #include "viterbi37.h"
 #include "parity.h"
 #include <limits.h>
@@ -233,3 +234,43 @@ int update_viterbi37_blk_port(void *p, uint8_t *syms, uint32_t nbits, uint32_t *
 
   return 0;
 }
+
+/* Batched update of SRSLTE_VITERBI_MAX_BATCH independent trellises with the same code. 
+ * Metrics are stored as metrics[state*B+lane] and symbols as syms[(3*n+k)*B+lane]. Branch 
+ * metrics use the same 5-bit scale as the SIMD decoders so all implementations take the same 
+ * decisions.
+ */
+void update_viterbi37_batch_port(uint16_t *metrics, uint8_t *branch, uint8_t *syms, uint32_t *decisions, uint32_t nbits) {
+  const uint32_t B = SRSLTE_VITERBI_MAX_BATCH;
+  uint16_t tmp_metrics[64*SRSLTE_VITERBI_MAX_BATCH];
+  uint16_t *old_metrics = metrics, *new_metrics = tmp_metrics, *tmp;
+
+  while (nbits--) {
+    for (uint32_t i = 0; i < 32; i++) {
+      uint32_t d = 0;
+      for (uint32_t l = 0; l < B; l++) {
+        uint32_t s0 = (branch[i] & 1) ? 255 - syms[l] : syms[l];
+        uint32_t s1 = (branch[i] & 2) ? 255 - syms[B + l] : syms[B + l];
+        uint32_t s2 = (branch[i] & 4) ? 255 - syms[2 * B + l] : syms[2 * B + l];
+        uint16_t metric = (((((s0 + s1 + 1) >> 1) + s2 + 1) >> 1) >> 3);
+        uint16_t m0 = old_metrics[i * B + l] + metric;
+        uint16_t m1 = old_metrics[(i + 32) * B + l] + (31 - metric);
+        uint16_t m2 = old_metrics[i * B + l] + (31 - metric);
+        uint16_t m3 = old_metrics[(i + 32) * B + l] + metric;
+        new_metrics[2 * i * B + l] = m0 > m1 ? m1 : m0;
+        new_metrics[(2 * i + 1) * B + l] = m2 > m3 ? m3 : m2;
+        d |= (uint32_t) (m0 > m1) << VITERBI37_BATCH_BIT(0, l);
+        d |= (uint32_t) (m2 > m3) << VITERBI37_BATCH_BIT(1, l);
+      }
+      decisions[i] = d;
+    }
+    decisions += 32;
+    syms += 3 * B;
+    tmp = old_metrics;
+    old_metrics = new_metrics;
+    new_metrics = tmp;
+  }
+  if (old_metrics != metrics) {
+    memcpy(metrics, old_metrics, sizeof(uint16_t) * 64 * B);
+  }
+}
@@ -46,6 +46,124 @@ int srslte_predecoding_diversity2_sse(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_
 int srslte_predecoding_single_avx(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS], cf_t *x, int nof_rxant, int nof_symbols, float noise_estimate);
 #endif
 
+/************************************************
+ * 
+ * CODEBOOK AND PRECODING MATRICES
+ * 
+ **************************************************/
+
+/* Maximum number of matrices in a large delay CDD precoding cycle (4 ports, 4 layers) */
+#define PRECODING_MAX_CYCLE   16
+
+/* Channel samples used for PMI/RI selection */
+#define PMI_SELECT_NOF_SAMPLES 64
+
+/* Precoding matrix of each RE i is w[i%len] */
+typedef struct {
+  uint32_t len; 
+  cf_t w[PRECODING_MAX_CYCLE][SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+} precoding_cycle_t; 
+
+/* 36.211 Table 6.3.4.2.3-2: Householder vectors u_n and columns of W_n for each number of layers */
+static const float sqrt_half = 0.70710678; 
+static const uint8_t codebook4_cols[16][4][4] = {
+  {{0}, {0,3}, {0,1,3}, {0,1,2,3}}, {{0}, {0,1}, {0,1,2}, {0,1,2,3}}, 
+  {{0}, {0,1}, {0,1,2}, {2,1,0,3}}, {{0}, {0,1}, {0,1,2}, {2,1,0,3}}, 
+  {{0}, {0,3}, {0,1,3}, {0,1,2,3}}, {{0}, {0,3}, {0,1,3}, {0,1,2,3}}, 
+  {{0}, {0,2}, {0,2,3}, {0,2,1,3}}, {{0}, {0,2}, {0,2,3}, {0,2,1,3}}, 
+  {{0}, {0,1}, {0,1,3}, {0,1,2,3}}, {{0}, {0,3}, {0,2,3}, {0,1,2,3}}, 
+  {{0}, {0,2}, {0,1,2}, {0,2,1,3}}, {{0}, {0,2}, {0,2,3}, {0,2,1,3}}, 
+  {{0}, {0,1}, {0,1,2}, {0,1,2,3}}, {{0}, {0,2}, {0,1,2}, {0,2,1,3}}, 
+  {{0}, {0,2}, {0,1,2}, {2,1,0,3}}, {{0}, {0,1}, {0,1,2}, {0,1,2,3}}, 
+};
+
+static void codebook4_u(uint32_t n, cf_t u[4]) 
+{
+  const float s = sqrt_half; 
+  const cf_t j = _Complex_I; 
+  const cf_t table[16][4] = {
+    {1, -1, -1, -1}, {1, -j, 1, j}, {1, 1, -1, 1}, {1, j, 1, -j}, 
+    {1, (-1-j)*s, -j, (1-j)*s}, {1, (1-j)*s, j, (-1-j)*s}, {1, (1+j)*s, -j, (-1+j)*s}, {1, (-1+j)*s, j, (1+j)*s}, 
+    {1, -1, 1, 1}, {1, -j, -1, -j}, {1, 1, 1, -1}, {1, j, -1, j}, 
+    {1, -1, -1, 1}, {1, -1, 1, -1}, {1, 1, -1, -1}, {1, 1, 1, 1}
+  };
+  memcpy(u, table[n], sizeof(cf_t)*4);
+}
+
+/* Returns in W the precoding matrix (nof_ports x nof_layers) of the given codebook index as 
+ * defined in 36.211 Section 6.3.4.2.3 */
+int srslte_precoding_codebook(int nof_ports, int nof_layers, uint32_t codebook_idx, 
+                              cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]) 
+{
+  bzero(W, sizeof(cf_t)*SRSLTE_MAX_PORTS*SRSLTE_MAX_LAYERS);
+  if (nof_ports == 2 && nof_layers == 1 && codebook_idx < 4) {
+    const cf_t w1[4] = {1, -1, _Complex_I, -_Complex_I}; 
+    W[0][0] = sqrt_half; 
+    W[1][0] = sqrt_half*w1[codebook_idx]; 
+  } else if (nof_ports == 2 && nof_layers == 2 && codebook_idx < 3) {
+    if (codebook_idx == 0) {
+      W[0][0] = sqrt_half; 
+      W[1][1] = sqrt_half; 
+    } else {
+      cf_t w = codebook_idx==1?1:_Complex_I; 
+      W[0][0] = 0.5;   W[0][1] = 0.5; 
+      W[1][0] = 0.5*w; W[1][1] = -0.5*w; 
+    }
+  } else if (nof_ports == 4 && nof_layers >= 1 && nof_layers <= 4 && codebook_idx < 16) {
+    cf_t u[4]; 
+    codebook4_u(codebook_idx, u);
+    float uu = 0; 
+    for (int i=0;i<4;i++) {
+      uu += crealf(u[i]*conjf(u[i])); 
+    }
+    for (int l=0;l<nof_layers;l++) {
+      int c = codebook4_cols[codebook_idx][nof_layers-1][l]; 
+      for (int p=0;p<4;p++) {
+        W[p][l] = ((p==c?1:0) - 2*u[p]*conjf(u[c])/uu)/sqrtf(nof_layers); 
+      }
+    }
+  } else {
+    fprintf(stderr, "Invalid codebook index %d for %d ports and %d layers\n", codebook_idx, nof_ports, nof_layers);
+    return SRSLTE_ERROR; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+static int precoding_cycle_multiplex(int nof_ports, int nof_layers, uint32_t codebook_idx, precoding_cycle_t *c) 
+{
+  c->len = 1; 
+  return srslte_precoding_codebook(nof_ports, nof_layers, codebook_idx, c->w[0]);
+}
+
+/* Large delay CDD, 36.211 Section 6.3.4.2.2: y(i) = W(i)D(i)Ux(i) */
+static int precoding_cycle_cdd(int nof_ports, int nof_layers, precoding_cycle_t *c) 
+{
+  cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]; 
+  if (nof_layers < 2 || nof_layers > nof_ports || (nof_ports != 2 && nof_ports != 4)) {
+    fprintf(stderr, "Invalid number of layers %d for CDD with %d ports\n", nof_layers, nof_ports);
+    return SRSLTE_ERROR; 
+  }
+  c->len = nof_ports==2?nof_layers:4*nof_layers; 
+  bzero(c->w, sizeof(c->w));
+  for (uint32_t i=0;i<c->len;i++) {
+    if (nof_ports == 2) {
+      srslte_precoding_codebook(2, nof_layers, 0, W);
+    } else {
+      srslte_precoding_codebook(4, nof_layers, 12+(i/nof_layers)%4, W);
+    }
+    for (int l=0;l<nof_layers;l++) {
+      /* (D(i)U)[m][l] = exp(-j2*pi*i*m/v)*exp(-j2*pi*m*l/v)/sqrt(v) */
+      for (int m=0;m<nof_layers;m++) {
+        cf_t du = cexpf(-_Complex_I*2*M_PI*(float) ((i*m+m*l)%nof_layers)/nof_layers)/sqrtf(nof_layers); 
+        for (int p=0;p<nof_ports;p++) {
+          c->w[i][p][l] += W[p][m]*du; 
+        }
+      }
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
 
 
 /************************************************
@@ -228,6 +346,32 @@ int srslte_predecoding_single_avx(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_
   return nof_symbols;
 }
 
+/* Single antenna equalizer with the output multiplied by scale, 4 RE per register. Buffers do not 
+ * need to be aligned */
+static int predecoding_single_scale_avx(cf_t *y, cf_t *h, cf_t *x, int nof_symbols, float noise_estimate, float scale) {
+  __m256 conjugator = _mm256_setr_ps(0, -0.f, 0, -0.f, 0, -0.f, 0, -0.f);
+  __m256 noise = _mm256_set1_ps(noise_estimate);
+  __m256 sc    = _mm256_set1_ps(scale);
+  
+  int i = 0; 
+  for (;i<nof_symbols-3;i+=4) {
+    __m256 yVal = _mm256_loadu_ps((float*) &y[i]);
+    __m256 hVal = _mm256_loadu_ps((float*) &h[i]);
+    
+    /* |h|^2 on both the real and imaginary lanes */
+    __m256 hsq = _mm256_mul_ps(hVal, hVal);
+    hsq = _mm256_add_ps(hsq, _mm256_permute_ps(hsq, 0xB1));
+    
+    __m256 xVal = PROD_AVX(yVal, _mm256_xor_ps(hVal, conjugator));
+    xVal = _mm256_mul_ps(xVal, _mm256_div_ps(sc, _mm256_add_ps(hsq, noise)));
+    _mm256_storeu_ps((float*) &x[i], xVal);
+  }
+  for (;i<nof_symbols;i++) {
+    x[i] = scale*y[i]*conjf(h[i])/(crealf(h[i]*conjf(h[i]))+noise_estimate);
+  }
+  return nof_symbols;
+}
+
 #endif
 
 int srslte_predecoding_single_gen(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS], cf_t *x, int nof_rxant, int nof_symbols, float noise_estimate) {
@@ -271,6 +415,19 @@ int srslte_predecoding_single(cf_t *y_, cf_t *h_, cf_t *x, int nof_symbols, floa
 #endif
 }
 
+/* Same as srslte_predecoding_single() with the output multiplied by scale, which allows fusing a 
+ * normalization of the following stage (e.g. the DFT despreading) into the equalizer */
+int srslte_predecoding_single_scale(cf_t *y, cf_t *h, cf_t *x, int nof_symbols, float noise_estimate, float scale) {
+#ifdef LV_HAVE_AVX
+  return predecoding_single_scale_avx(y, h, x, nof_symbols, noise_estimate, scale);
+#else
+  for (int i=0;i<nof_symbols;i++) {
+    x[i] = scale*y[i]*conjf(h[i])/(crealf(h[i]*conjf(h[i]))+noise_estimate);
+  }
+  return nof_symbols;
+#endif
+}
+
 /* ZF/MMSE SISO equalizer x=y(h'h+no)^(-1)h' (ZF if n0=0.0)*/
 int srslte_predecoding_single_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS], cf_t *x, int nof_rxant, int nof_symbols, float noise_estimate) {
 #ifdef LV_HAVE_AVX
@@ -515,9 +672,524 @@ int srslte_predecoding_diversity_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE
 #endif   
 }
 
+/* Spatial multiplexing and large delay CDD receiver. For each RE the effective channel G=H*W(i) is
+ * inverted with the ZF/MMSE solution x=(G'G+n0*I)^(-1)G'y (ZF if n0=0.0).
+ * The generic implementation processes MIMO_BLOCK RE at a time with the real and imaginary parts in
+ * separate arrays so that every operation of the LDL' solver is vectorised across RE */
+#define MIMO_BLOCK 8
+
+static inline void load_block(const cf_t *ptr, int n, float *re, float *im) 
+{
+  int k; 
+  for (k=0;k<n;k++) {
+    re[k] = crealf(ptr[k]); 
+    im[k] = cimagf(ptr[k]); 
+  }
+  for (;k<MIMO_BLOCK;k++) {
+    re[k] = 0; 
+    im[k] = 0; 
+  }
+}
+
+static int predecoding_cycle_gen(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                 cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, int nof_layers, 
+                                 const precoding_cycle_t *c, int symbol_start, int nof_symbols, float noise_estimate) 
+{
+  float gr[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS][MIMO_BLOCK], gi[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS][MIMO_BLOCK]; 
+  float ar[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS][MIMO_BLOCK], ai[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS][MIMO_BLOCK]; 
+  float br[SRSLTE_MAX_LAYERS][MIMO_BLOCK], bi[SRSLTE_MAX_LAYERS][MIMO_BLOCK]; 
+  float d[SRSLTE_MAX_LAYERS][MIMO_BLOCK], id[SRSLTE_MAX_LAYERS][MIMO_BLOCK]; 
+  float hr[MIMO_BLOCK], hi[MIMO_BLOCK], yr[MIMO_BLOCK], yi[MIMO_BLOCK]; 
+  float wr[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS][MIMO_BLOCK], wi[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS][MIMO_BLOCK]; 
+  int i, k, l, m, p, r; 
+  int phase = -1; 
+
+  for (i=symbol_start;i<nof_symbols;i+=MIMO_BLOCK) {
+    int n = SRSLTE_MIN(MIMO_BLOCK, nof_symbols-i); 
+
+    /* Precoding matrix of each lane, only changes if the cycle length does not divide MIMO_BLOCK */
+    if (i%c->len != phase) {
+      phase = i%c->len; 
+      for (p=0;p<nof_ports;p++) {
+        for (l=0;l<nof_layers;l++) {
+          for (k=0;k<MIMO_BLOCK;k++) {
+            cf_t w = c->w[(phase+k)%c->len][p][l]; 
+            wr[p][l][k] = crealf(w); 
+            wi[p][l][k] = cimagf(w); 
+          }
+        }
+      }
+    }
+
+    /* Effective channel G=H*W(i) */
+    for (r=0;r<nof_rxant;r++) {
+      for (l=0;l<nof_layers;l++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          gr[r][l][k] = 0; 
+          gi[r][l][k] = 0; 
+        }
+      }
+      for (p=0;p<nof_ports;p++) {
+        load_block(&h[p][r][i], n, hr, hi);
+        for (l=0;l<nof_layers;l++) {
+          for (k=0;k<MIMO_BLOCK;k++) {
+            gr[r][l][k] += hr[k]*wr[p][l][k]-hi[k]*wi[p][l][k]; 
+            gi[r][l][k] += hr[k]*wi[p][l][k]+hi[k]*wr[p][l][k]; 
+          }
+        }
+      }
+    }
+
+    /* A=G'G+n0*I (lower triangle) and b=G'y */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<=l;m++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          ar[l][m][k] = l==m?noise_estimate:0; 
+          ai[l][m][k] = 0; 
+        }
+        for (r=0;r<nof_rxant;r++) {
+          for (k=0;k<MIMO_BLOCK;k++) {
+            ar[l][m][k] += gr[r][l][k]*gr[r][m][k]+gi[r][l][k]*gi[r][m][k]; 
+            ai[l][m][k] += gr[r][l][k]*gi[r][m][k]-gi[r][l][k]*gr[r][m][k]; 
+          }
+        }
+      }
+      for (k=0;k<MIMO_BLOCK;k++) {
+        br[l][k] = 0; 
+        bi[l][k] = 0; 
+      }
+    }
+    for (r=0;r<nof_rxant;r++) {
+      load_block(&y[r][i], n, yr, yi);
+      for (l=0;l<nof_layers;l++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          br[l][k] += gr[r][l][k]*yr[k]+gi[r][l][k]*yi[k]; 
+          bi[l][k] += gr[r][l][k]*yi[k]-gi[r][l][k]*yr[k]; 
+        }
+      }
+    }
+
+    /* LDL' decomposition of A, stored in place */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<l;m++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          ar[l][l][k] -= (ar[l][m][k]*ar[l][m][k]+ai[l][m][k]*ai[l][m][k])*d[m][k]; 
+        }
+      }
+      for (k=0;k<MIMO_BLOCK;k++) {
+        d[l][k] = ar[l][l][k]>1e-9?ar[l][l][k]:1e-9; 
+        id[l][k] = 1/d[l][k]; 
+      }
+      for (int j=l+1;j<nof_layers;j++) {
+        for (m=0;m<l;m++) {
+          /* L[j][m]*conj(L[l][m])*d[m] */
+          for (k=0;k<MIMO_BLOCK;k++) {
+            ar[j][l][k] -= (ar[j][m][k]*ar[l][m][k]+ai[j][m][k]*ai[l][m][k])*d[m][k]; 
+            ai[j][l][k] -= (ai[j][m][k]*ar[l][m][k]-ar[j][m][k]*ai[l][m][k])*d[m][k]; 
+          }
+        }
+        for (k=0;k<MIMO_BLOCK;k++) {
+          ar[j][l][k] *= id[l][k]; 
+          ai[j][l][k] *= id[l][k]; 
+        }
+      }
+    }
+
+    /* Forward substitution L*z=b and scaling by D^(-1) */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<l;m++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          float zr = br[m][k]*d[m][k], zi = bi[m][k]*d[m][k]; 
+          br[l][k] -= ar[l][m][k]*zr-ai[l][m][k]*zi; 
+          bi[l][k] -= ar[l][m][k]*zi+ai[l][m][k]*zr; 
+        }
+      }
+      for (k=0;k<MIMO_BLOCK;k++) {
+        br[l][k] *= id[l][k]; 
+        bi[l][k] *= id[l][k]; 
+      }
+    }
+    /* Backward substitution L'x=D^(-1)z */
+    for (l=nof_layers-1;l>=0;l--) {
+      for (m=l+1;m<nof_layers;m++) {
+        for (k=0;k<MIMO_BLOCK;k++) {
+          br[l][k] -= ar[m][l][k]*br[m][k]+ai[m][l][k]*bi[m][k]; 
+          bi[l][k] -= ar[m][l][k]*bi[m][k]-ai[m][l][k]*br[m][k]; 
+        }
+      }
+      for (k=0;k<n;k++) {
+        x[l][i+k] = br[l][k]+_Complex_I*bi[l][k]; 
+      }
+    }
+  }
+  return nof_symbols; 
+}
+
+#ifdef LV_HAVE_AVX
+
+/* Loads 8 consecutive complex samples into separate real and imaginary registers. The samples are 
+ * stored in the order 0 1 4 5 2 3 6 7, which is undone by the unpack instructions in store_avx() */
+static inline void load_avx(const cf_t *ptr, __m256 *re, __m256 *im) 
+{
+  __m256 a = _mm256_loadu_ps((float*) ptr); 
+  __m256 b = _mm256_loadu_ps((float*) (ptr + 4)); 
+  *re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)); 
+  *im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)); 
+}
+
+static inline void store_avx(cf_t *ptr, __m256 re, __m256 im) 
+{
+  _mm256_storeu_ps((float*) ptr, _mm256_unpacklo_ps(re, im)); 
+  _mm256_storeu_ps((float*) (ptr + 4), _mm256_unpackhi_ps(re, im)); 
+}
+
+/* 2 layer ZF/MMSE detector with closed-form 2x2 inverse. The precoding cycle length must divide 8 
+ * (all 2 layer cases) so that each register lane always sees the same precoding matrix */
+static int predecoding_cycle2_avx(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                  cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, 
+                                  const precoding_cycle_t *c, int nof_symbols, float noise_estimate) 
+{
+  const int lane2re[8] = {0, 1, 4, 5, 2, 3, 6, 7}; 
+  __m256 wr[SRSLTE_MAX_PORTS][2], wi[SRSLTE_MAX_PORTS][2]; 
+  float tr[8], ti[8]; 
+  int i; 
+
+  for (int p=0;p<nof_ports;p++) {
+    for (int l=0;l<2;l++) {
+      for (int k=0;k<8;k++) {
+        cf_t w = c->w[lane2re[k]%c->len][p][l]; 
+        tr[k] = crealf(w); 
+        ti[k] = cimagf(w); 
+      }
+      wr[p][l] = _mm256_loadu_ps(tr); 
+      wi[p][l] = _mm256_loadu_ps(ti); 
+    }
+  }
+  __m256 noise = _mm256_set1_ps(noise_estimate); 
+  __m256 eps = _mm256_set1_ps(1e-9); 
+
+  for (i=0;i<nof_symbols-7;i+=8) {
+    __m256 a00 = noise, a11 = noise, a01r = _mm256_setzero_ps(), a01i = _mm256_setzero_ps(); 
+    __m256 b0r = _mm256_setzero_ps(), b0i = _mm256_setzero_ps(); 
+    __m256 b1r = _mm256_setzero_ps(), b1i = _mm256_setzero_ps(); 
+
+    for (int r=0;r<nof_rxant;r++) {
+      __m256 g0r = _mm256_setzero_ps(), g0i = _mm256_setzero_ps(); 
+      __m256 g1r = _mm256_setzero_ps(), g1i = _mm256_setzero_ps(); 
+      __m256 hr, hi, yr, yi; 
+
+      /* G = H*W */
+      for (int p=0;p<nof_ports;p++) {
+        load_avx(&h[p][r][i], &hr, &hi); 
+        g0r = _mm256_add_ps(g0r, _mm256_sub_ps(_mm256_mul_ps(hr, wr[p][0]), _mm256_mul_ps(hi, wi[p][0]))); 
+        g0i = _mm256_add_ps(g0i, _mm256_add_ps(_mm256_mul_ps(hr, wi[p][0]), _mm256_mul_ps(hi, wr[p][0]))); 
+        g1r = _mm256_add_ps(g1r, _mm256_sub_ps(_mm256_mul_ps(hr, wr[p][1]), _mm256_mul_ps(hi, wi[p][1]))); 
+        g1i = _mm256_add_ps(g1i, _mm256_add_ps(_mm256_mul_ps(hr, wi[p][1]), _mm256_mul_ps(hi, wr[p][1]))); 
+      }
+
+      /* A = G'G + n0*I, b = G'y */
+      a00 = _mm256_add_ps(a00, _mm256_add_ps(_mm256_mul_ps(g0r, g0r), _mm256_mul_ps(g0i, g0i))); 
+      a11 = _mm256_add_ps(a11, _mm256_add_ps(_mm256_mul_ps(g1r, g1r), _mm256_mul_ps(g1i, g1i))); 
+      a01r = _mm256_add_ps(a01r, _mm256_add_ps(_mm256_mul_ps(g0r, g1r), _mm256_mul_ps(g0i, g1i))); 
+      a01i = _mm256_add_ps(a01i, _mm256_sub_ps(_mm256_mul_ps(g0r, g1i), _mm256_mul_ps(g0i, g1r))); 
+
+      load_avx(&y[r][i], &yr, &yi); 
+      b0r = _mm256_add_ps(b0r, _mm256_add_ps(_mm256_mul_ps(g0r, yr), _mm256_mul_ps(g0i, yi))); 
+      b0i = _mm256_add_ps(b0i, _mm256_sub_ps(_mm256_mul_ps(g0r, yi), _mm256_mul_ps(g0i, yr))); 
+      b1r = _mm256_add_ps(b1r, _mm256_add_ps(_mm256_mul_ps(g1r, yr), _mm256_mul_ps(g1i, yi))); 
+      b1i = _mm256_add_ps(b1i, _mm256_sub_ps(_mm256_mul_ps(g1r, yi), _mm256_mul_ps(g1i, yr))); 
+    }
+
+    /* x = A^(-1)b with A^(-1) = [a11 -a01; -conj(a01) a00]/det */
+    __m256 det = _mm256_sub_ps(_mm256_mul_ps(a00, a11), 
+                               _mm256_add_ps(_mm256_mul_ps(a01r, a01r), _mm256_mul_ps(a01i, a01i))); 
+    __m256 idet = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(det, eps)); 
+
+    __m256 x0r = _mm256_sub_ps(_mm256_mul_ps(a11, b0r), 
+                               _mm256_sub_ps(_mm256_mul_ps(a01r, b1r), _mm256_mul_ps(a01i, b1i))); 
+    __m256 x0i = _mm256_sub_ps(_mm256_mul_ps(a11, b0i), 
+                               _mm256_add_ps(_mm256_mul_ps(a01r, b1i), _mm256_mul_ps(a01i, b1r))); 
+    __m256 x1r = _mm256_sub_ps(_mm256_mul_ps(a00, b1r), 
+                               _mm256_add_ps(_mm256_mul_ps(a01r, b0r), _mm256_mul_ps(a01i, b0i))); 
+    __m256 x1i = _mm256_sub_ps(_mm256_mul_ps(a00, b1i), 
+                               _mm256_sub_ps(_mm256_mul_ps(a01r, b0i), _mm256_mul_ps(a01i, b0r))); 
+
+    store_avx(&x[0][i], _mm256_mul_ps(x0r, idet), _mm256_mul_ps(x0i, idet)); 
+    store_avx(&x[1][i], _mm256_mul_ps(x1r, idet), _mm256_mul_ps(x1i, idet)); 
+  }
+  return i; 
+}
+
+/* Same LDL' solver as predecoding_cycle_gen() for 3 and 4 layers, keeping 8 RE per register */
+static int predecoding_cyclen_avx(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                  cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, int nof_layers, 
+                                  const precoding_cycle_t *c, int nof_symbols, float noise_estimate) 
+{
+  const int lane2re[8] = {0, 1, 4, 5, 2, 3, 6, 7}; 
+  /* The cycle length (1, 12 or 16 for more than 2 layers) repeats every 1, 3 or 2 blocks of 8 RE */
+  __m256 wr[3][SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS], wi[3][SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]; 
+  __m256 gr[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS], gi[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]; 
+  __m256 ar[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS], ai[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS]; 
+  __m256 br[SRSLTE_MAX_LAYERS], bi[SRSLTE_MAX_LAYERS], d[SRSLTE_MAX_LAYERS], id[SRSLTE_MAX_LAYERS]; 
+  __m256 hr, hi, yr, yi; 
+  float tr[8], ti[8]; 
+  int i, l, m, p, r; 
+  int nof_phases = 1; 
+
+  while ((8*nof_phases)%c->len) {
+    nof_phases++; 
+  }
+  if (nof_phases > 3) {
+    return 0; 
+  }
+  for (int n=0;n<nof_phases;n++) {
+    for (p=0;p<nof_ports;p++) {
+      for (l=0;l<nof_layers;l++) {
+        for (int k=0;k<8;k++) {
+          cf_t w = c->w[(8*n+lane2re[k])%c->len][p][l]; 
+          tr[k] = crealf(w); 
+          ti[k] = cimagf(w); 
+        }
+        wr[n][p][l] = _mm256_loadu_ps(tr); 
+        wi[n][p][l] = _mm256_loadu_ps(ti); 
+      }
+    }
+  }
+
+  __m256 noise = _mm256_set1_ps(noise_estimate); 
+  __m256 eps = _mm256_set1_ps(1e-9); 
+  __m256 one = _mm256_set1_ps(1.0f); 
+  int phase = 0; 
+
+  for (i=0;i<nof_symbols-7;i+=8) {
+
+    /* G = H*W */
+    for (r=0;r<nof_rxant;r++) {
+      for (l=0;l<nof_layers;l++) {
+        gr[r][l] = _mm256_setzero_ps(); 
+        gi[r][l] = _mm256_setzero_ps(); 
+      }
+      for (p=0;p<nof_ports;p++) {
+        load_avx(&h[p][r][i], &hr, &hi); 
+        for (l=0;l<nof_layers;l++) {
+          __m256 w_r = wr[phase][p][l], w_i = wi[phase][p][l]; 
+          gr[r][l] = _mm256_add_ps(gr[r][l], _mm256_sub_ps(_mm256_mul_ps(hr, w_r), _mm256_mul_ps(hi, w_i))); 
+          gi[r][l] = _mm256_add_ps(gi[r][l], _mm256_add_ps(_mm256_mul_ps(hr, w_i), _mm256_mul_ps(hi, w_r))); 
+        }
+      }
+    }
+
+    /* A = G'G + n0*I (lower triangle), b = G'y */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<=l;m++) {
+        ar[l][m] = l==m?noise:_mm256_setzero_ps(); 
+        ai[l][m] = _mm256_setzero_ps(); 
+        for (r=0;r<nof_rxant;r++) {
+          ar[l][m] = _mm256_add_ps(ar[l][m], _mm256_add_ps(_mm256_mul_ps(gr[r][l], gr[r][m]), _mm256_mul_ps(gi[r][l], gi[r][m]))); 
+          ai[l][m] = _mm256_add_ps(ai[l][m], _mm256_sub_ps(_mm256_mul_ps(gr[r][l], gi[r][m]), _mm256_mul_ps(gi[r][l], gr[r][m]))); 
+        }
+      }
+      br[l] = _mm256_setzero_ps(); 
+      bi[l] = _mm256_setzero_ps(); 
+    }
+    for (r=0;r<nof_rxant;r++) {
+      load_avx(&y[r][i], &yr, &yi); 
+      for (l=0;l<nof_layers;l++) {
+        br[l] = _mm256_add_ps(br[l], _mm256_add_ps(_mm256_mul_ps(gr[r][l], yr), _mm256_mul_ps(gi[r][l], yi))); 
+        bi[l] = _mm256_add_ps(bi[l], _mm256_sub_ps(_mm256_mul_ps(gr[r][l], yi), _mm256_mul_ps(gi[r][l], yr))); 
+      }
+    }
+
+    /* LDL' decomposition */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<l;m++) {
+        __m256 n2 = _mm256_add_ps(_mm256_mul_ps(ar[l][m], ar[l][m]), _mm256_mul_ps(ai[l][m], ai[l][m])); 
+        ar[l][l] = _mm256_sub_ps(ar[l][l], _mm256_mul_ps(n2, d[m])); 
+      }
+      d[l] = _mm256_max_ps(ar[l][l], eps); 
+      id[l] = _mm256_div_ps(one, d[l]); 
+      for (int j=l+1;j<nof_layers;j++) {
+        for (m=0;m<l;m++) {
+          __m256 pr = _mm256_add_ps(_mm256_mul_ps(ar[j][m], ar[l][m]), _mm256_mul_ps(ai[j][m], ai[l][m])); 
+          __m256 pi = _mm256_sub_ps(_mm256_mul_ps(ai[j][m], ar[l][m]), _mm256_mul_ps(ar[j][m], ai[l][m])); 
+          ar[j][l] = _mm256_sub_ps(ar[j][l], _mm256_mul_ps(pr, d[m])); 
+          ai[j][l] = _mm256_sub_ps(ai[j][l], _mm256_mul_ps(pi, d[m])); 
+        }
+        ar[j][l] = _mm256_mul_ps(ar[j][l], id[l]); 
+        ai[j][l] = _mm256_mul_ps(ai[j][l], id[l]); 
+      }
+    }
+
+    /* Forward substitution and scaling by D^(-1) */
+    for (l=0;l<nof_layers;l++) {
+      for (m=0;m<l;m++) {
+        __m256 zr = _mm256_mul_ps(br[m], d[m]), zi = _mm256_mul_ps(bi[m], d[m]); 
+        br[l] = _mm256_sub_ps(br[l], _mm256_sub_ps(_mm256_mul_ps(ar[l][m], zr), _mm256_mul_ps(ai[l][m], zi))); 
+        bi[l] = _mm256_sub_ps(bi[l], _mm256_add_ps(_mm256_mul_ps(ar[l][m], zi), _mm256_mul_ps(ai[l][m], zr))); 
+      }
+      br[l] = _mm256_mul_ps(br[l], id[l]); 
+      bi[l] = _mm256_mul_ps(bi[l], id[l]); 
+    }
+    /* Backward substitution */
+    for (l=nof_layers-1;l>=0;l--) {
+      for (m=l+1;m<nof_layers;m++) {
+        br[l] = _mm256_sub_ps(br[l], _mm256_add_ps(_mm256_mul_ps(ar[m][l], br[m]), _mm256_mul_ps(ai[m][l], bi[m]))); 
+        bi[l] = _mm256_sub_ps(bi[l], _mm256_sub_ps(_mm256_mul_ps(ar[m][l], bi[m]), _mm256_mul_ps(ai[m][l], br[m]))); 
+      }
+      store_avx(&x[l][i], br[l], bi[l]); 
+    }
+    if (++phase == nof_phases) {
+      phase = 0; 
+    }
+  }
+  return i; 
+}
+
+#endif
+
+static int predecoding_cycle(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                             cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, int nof_layers, 
+                             const precoding_cycle_t *c, int nof_symbols, float noise_estimate) 
+{
+  int i = 0; 
+  if (nof_rxant < nof_layers) {
+    fprintf(stderr, "Number of receive antennas (%d) must be at least the number of layers (%d)\n", nof_rxant, nof_layers);
+    return -1; 
+  }
+  if (noise_estimate < 0) {
+    noise_estimate = 0; 
+  }
+#ifdef LV_HAVE_AVX
+  if (nof_layers == 2 && 8%c->len == 0) {
+    i = predecoding_cycle2_avx(y, h, x, nof_rxant, nof_ports, c, nof_symbols, noise_estimate);
+  } else if (nof_layers > 2) {
+    i = predecoding_cyclen_avx(y, h, x, nof_rxant, nof_ports, nof_layers, c, nof_symbols, noise_estimate);
+  }
+#endif
+  predecoding_cycle_gen(y, h, x, nof_rxant, nof_ports, nof_layers, c, i, nof_symbols, noise_estimate);
+  return nof_symbols; 
+}
+
+/* Closed-loop spatial multiplexing (TM4) receiver for the given codebook index */
+int srslte_predecoding_multiplex_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                       cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, int nof_layers, 
+                                       uint32_t codebook_idx, int nof_symbols, float noise_estimate) 
+{
+  precoding_cycle_t c; 
+  if (precoding_cycle_multiplex(nof_ports, nof_layers, codebook_idx, &c)) {
+    return -1; 
+  }
+  return predecoding_cycle(y, h, x, nof_rxant, nof_ports, nof_layers, &c, nof_symbols, noise_estimate);
+}
+
+/* Open-loop spatial multiplexing with large delay CDD (TM3) receiver */
+int srslte_predecoding_cdd_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], 
+                                 cf_t *x[SRSLTE_MAX_LAYERS], int nof_rxant, int nof_ports, int nof_layers, 
+                                 int nof_symbols, float noise_estimate) 
+{
+  precoding_cycle_t c; 
+  if (precoding_cycle_cdd(nof_ports, nof_layers, &c)) {
+    return -1; 
+  }
+  return predecoding_cycle(y, h, x, nof_rxant, nof_ports, nof_layers, &c, nof_symbols, noise_estimate);
+}
+
+/* Returns log2(det(I+G'G/n0)) for the nof_rxant x nof_layers channel G */
+static float capacity_mimo(cf_t G[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS], int nof_rxant, int nof_layers, float noise_estimate) 
+{
+  cf_t A[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS]; 
+  float d[SRSLTE_MAX_LAYERS]; 
+  float c = 0; 
+
+  for (int l=0;l<nof_layers;l++) {
+    for (int m=0;m<=l;m++) {
+      cf_t a = 0; 
+      for (int r=0;r<nof_rxant;r++) {
+        a += conjf(G[r][l])*G[r][m]; 
+      }
+      A[l][m] = a/noise_estimate + (l==m?1:0); 
+    }
+  }
+  /* det(A) is the product of the LDL' pivots */
+  for (int l=0;l<nof_layers;l++) {
+    float v = crealf(A[l][l]); 
+    for (int m=0;m<l;m++) {
+      v -= crealf(A[l][m]*conjf(A[l][m]))*d[m]; 
+    }
+    d[l] = v>1.0f?v:1.0f; 
+    for (int j=l+1;j<nof_layers;j++) {
+      cf_t v = A[j][l]; 
+      for (int m=0;m<l;m++) {
+        v -= A[j][m]*conjf(A[l][m])*d[m]; 
+      }
+      A[j][l] = v/d[l]; 
+    }
+    c += log2f(d[l]); 
+  }
+  return c; 
+}
+
+/* Selects the rank indicator (number of layers, up to max_layers) and precoding matrix indicator (codebook 
+ * index) which maximise the mean capacity over PMI_SELECT_NOF_SAMPLES channel samples, 36.213 Section 7.2.4. 
+ * Returns the number of layers and codebook index in ri and pmi and, if not NULL, the mean capacity 
+ * in bits/RE */
+int srslte_precoding_ri_pmi_select(cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], int nof_rxant, int nof_ports, 
+                                   int max_layers, int nof_symbols, float noise_estimate, uint32_t *ri, uint32_t *pmi, 
+                                   float *capacity) 
+{
+  cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]; 
+  cf_t G[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS]; 
+  float best = -1; 
+
+  if ((nof_ports != 2 && nof_ports != 4) || nof_rxant < 1 || nof_rxant > SRSLTE_MAX_PORTS || 
+      max_layers < 1 || nof_symbols < 1 || !ri || !pmi) 
+  {
+    fprintf(stderr, "Invalid parameters for PMI selection (nof_ports=%d, nof_rxant=%d)\n", nof_ports, nof_rxant);
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  if (noise_estimate < 1e-6) {
+    noise_estimate = 1e-6; 
+  }
+  int nof_samples = SRSLTE_MIN(PMI_SELECT_NOF_SAMPLES, nof_symbols); 
+  int step = nof_symbols/nof_samples; 
+  max_layers = SRSLTE_MIN(max_layers, SRSLTE_MIN(nof_rxant, nof_ports)); 
+
+  for (int v=1;v<=max_layers;v++) {
+    uint32_t nof_cb = nof_ports==4?16:(v==1?4:3); 
+    /* Codebook index 0 with 2 ports and 2 layers is reserved for open-loop multiplexing */
+    for (uint32_t cb=(nof_ports==2 && v==2)?1:0;cb<nof_cb;cb++) {
+      srslte_precoding_codebook(nof_ports, v, cb, W);
+      float c = 0; 
+      for (int s=0;s<nof_samples;s++) {
+        int i = s*step; 
+        for (int r=0;r<nof_rxant;r++) {
+          for (int l=0;l<v;l++) {
+            cf_t g = 0; 
+            for (int p=0;p<nof_ports;p++) {
+              g += h[p][r][i]*W[p][l]; 
+            }
+            G[r][l] = g; 
+          }
+        }
+        c += capacity_mimo(G, nof_rxant, v, noise_estimate); 
+      }
+      c /= nof_samples; 
+      if (c > best) {
+        best = c; 
+        *ri = v; 
+        *pmi = cb; 
+      }
+    }
+  }
+  if (capacity) {
+    *capacity = best; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
 
 int srslte_predecoding_type(cf_t *y_, cf_t *h_[SRSLTE_MAX_PORTS], cf_t *x[SRSLTE_MAX_LAYERS],
-    int nof_ports, int nof_layers, int nof_symbols, srslte_mimo_type_t type, float noise_estimate) 
+    int nof_ports, int nof_layers, uint32_t codebook_idx, int nof_symbols, srslte_mimo_type_t type, float noise_estimate) 
 {
   cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS]; 
   cf_t *y[SRSLTE_MAX_PORTS]; 
@@ -527,12 +1199,13 @@ int srslte_predecoding_type(cf_t *y_, cf_t *h_[SRSLTE_MAX_PORTS], cf_t *x[SRSLTE
     h[i][0] = h_[i];
   }
   y[0] = y_; 
-  return srslte_predecoding_type_multi(y, h, x, nof_rxant, nof_ports, nof_layers, nof_symbols, type, noise_estimate);  
+  return srslte_predecoding_type_multi(y, h, x, nof_rxant, nof_ports, nof_layers, codebook_idx, nof_symbols, type, noise_estimate);  
 }
 
 /* 36.211 v10.3.0 Section 6.3.4 */
 int srslte_predecoding_type_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], cf_t *x[SRSLTE_MAX_LAYERS],
-    int nof_rxant, int nof_ports, int nof_layers, int nof_symbols, srslte_mimo_type_t type, float noise_estimate) {
+    int nof_rxant, int nof_ports, int nof_layers, uint32_t codebook_idx, int nof_symbols, srslte_mimo_type_t type, 
+    float noise_estimate) {
 
   if (nof_ports > SRSLTE_MAX_PORTS) {
     fprintf(stderr, "Maximum number of ports is %d (nof_ports=%d)\n", SRSLTE_MAX_PORTS,
@@ -547,8 +1220,7 @@ int srslte_predecoding_type_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_
 
   switch (type) {
   case SRSLTE_MIMO_TYPE_CDD:
-    fprintf(stderr, "CCD not supported\n");
-    return -1; 
+    return srslte_predecoding_cdd_multi(y, h, x, nof_rxant, nof_ports, nof_layers, nof_symbols, noise_estimate);
   case SRSLTE_MIMO_TYPE_SINGLE_ANTENNA:
     if (nof_ports == 1 && nof_layers == 1) {
       return srslte_predecoding_single_multi(y, h[0], x[0], nof_rxant, nof_symbols, noise_estimate);              
@@ -568,8 +1240,8 @@ int srslte_predecoding_type_multi(cf_t *y[SRSLTE_MAX_PORTS], cf_t *h[SRSLTE_MAX_
     }
     break;
   case SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX:
-    fprintf(stderr, "Spatial multiplexing not supported\n");
-    return -1;
+    return srslte_predecoding_multiplex_multi(y, h, x, nof_rxant, nof_ports, nof_layers, codebook_idx, nof_symbols, 
+                                              noise_estimate);
   }
   return 0;
 }
@@ -634,6 +1306,33 @@ int srslte_precoding_diversity(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PO
   }
 }
 
+static int precoding_cycle(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS], int nof_layers, int nof_ports, 
+                           const precoding_cycle_t *c, int nof_symbols) 
+{
+  for (int p=0;p<nof_ports;p++) {
+    for (int i=0;i<nof_symbols;i++) {
+      const cf_t *w = c->w[i%c->len][p]; 
+      cf_t v = 0; 
+      for (int l=0;l<nof_layers;l++) {
+        v += w[l]*x[l][i]; 
+      }
+      y[p][i] = v; 
+    }
+  }
+  return nof_symbols; 
+}
+
+/* Closed-loop spatial multiplexing precoding, 36.211 Section 6.3.4.2.1 */
+int srslte_precoding_multiplex(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS], int nof_layers, int nof_ports, 
+                               uint32_t codebook_idx, int nof_symbols) 
+{
+  precoding_cycle_t c; 
+  if (precoding_cycle_multiplex(nof_ports, nof_layers, codebook_idx, &c)) {
+    return -1; 
+  }
+  return precoding_cycle(x, y, nof_layers, nof_ports, &c, nof_symbols);
+}
+
 int srslte_precoding_cdd(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS], int nof_layers, int nof_ports, int nof_symbols) 
 {
   int i;
@@ -651,8 +1350,11 @@ int srslte_precoding_cdd(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS],
     }
     return 2 * i;
   } else if (nof_ports == 4) {
-    fprintf(stderr, "Not implemented\n");
-    return -1;
+    precoding_cycle_t c; 
+    if (precoding_cycle_cdd(nof_ports, nof_layers, &c)) {
+      return -1; 
+    }
+    return precoding_cycle(x, y, nof_layers, nof_ports, &c, nof_symbols);
   } else {
     fprintf(stderr, "Number of ports must be 2 or 4 for transmit diversity (nof_ports=%d)\n", nof_ports);
     return -1;
@@ -661,7 +1363,7 @@ int srslte_precoding_cdd(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS],
 
 /* 36.211 v10.3.0 Section 6.3.4 */
 int srslte_precoding_type(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS], int nof_layers,
-    int nof_ports, int nof_symbols, srslte_mimo_type_t type) {
+    int nof_ports, uint32_t codebook_idx, int nof_symbols, srslte_mimo_type_t type) {
 
   if (nof_ports > SRSLTE_MAX_PORTS) {
     fprintf(stderr, "Maximum number of ports is %d (nof_ports=%d)\n", SRSLTE_MAX_PORTS,
@@ -695,8 +1397,7 @@ int srslte_precoding_type(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *y[SRSLTE_MAX_PORTS],
       return -1;
     }
   case SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX:
-    fprintf(stderr, "Spatial multiplexing not supported\n");
-    return -1;
+    return srslte_precoding_multiplex(x, y, nof_layers, nof_ports, codebook_idx, nof_symbols);
   }
   return 0;
 }
@@ -105,7 +105,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     symbols_layers[i] = nof_symbols/nof_layers; 
   }
   srslte_layermap_type(d, x, nof_codewords, nof_layers, symbols_layers, type);
-  srslte_precoding_type(x, y, nof_layers, nof_tx_ports, nof_symbols/nof_layers, type);
+  srslte_precoding_type(x, y, nof_layers, nof_tx_ports, 0, nof_symbols/nof_layers, type);
   
   if (nlhs >= 1) { 
     mexutils_write_cf(output, &plhs[0], nof_symbols/nof_layers, nof_tx_ports);  
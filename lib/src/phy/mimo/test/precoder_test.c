@@ -38,19 +38,26 @@
 #define MSE_THRESHOLD	0.00001
 
 int nof_symbols = 1000;
-int nof_layers = 1, nof_ports = 1;
+int nof_layers = 1, nof_ports = 1, nof_rxant = 1;
+uint32_t codebook_idx = 0; 
+int nof_repetitions = 1; 
+float snr_db = -1; 
 char *mimo_type_name = NULL;
 
 void usage(char *prog) {
   printf(
-      "Usage: %s -m [single|diversity|multiplex] -l [nof_layers] -p [nof_ports]\n",
+      "Usage: %s -m [single|diversity|multiplex|cdd] -l [nof_layers] -p [nof_ports]\n",
       prog);
   printf("\t-n num_symbols [Default %d]\n", nof_symbols);
+  printf("\t-r nof_rxant [Default %d]\n", nof_rxant);
+  printf("\t-c codebook_idx for spatial multiplexing [Default %d]\n", codebook_idx);
+  printf("\t-s SNR in dB, compares MMSE against ZF detection [Default noiseless ZF]\n");
+  printf("\t-b nof_repetitions of the predecoder for the throughput benchmark [Default %d]\n", nof_repetitions);
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "mpln")) != -1) {
+  while ((opt = getopt(argc, argv, "mplnrcsb")) != -1) {
     switch (opt) {
     case 'n':
       nof_symbols = atoi(argv[optind]);
@@ -61,6 +68,18 @@ void parse_args(int argc, char **argv) {
     case 'l':
       nof_layers = atoi(argv[optind]);
       break;
+    case 'r':
+      nof_rxant = atoi(argv[optind]);
+      break;
+    case 'c':
+      codebook_idx = atoi(argv[optind]);
+      break;
+    case 's':
+      snr_db = atof(argv[optind]);
+      break;
+    case 'b':
+      nof_repetitions = atoi(argv[optind]);
+      break;
     case 'm':
       mimo_type_name = argv[optind];
       break;
@@ -75,17 +94,28 @@ void parse_args(int argc, char **argv) {
   }
 }
 
+/* Mean squared error between the transmitted and the estimated layers */
+float compute_mse(cf_t *x[SRSLTE_MAX_LAYERS], cf_t *xr[SRSLTE_MAX_LAYERS]) {
+  float mse = 0;
+  for (int i = 0; i < nof_layers; i++) {
+    for (int j = 0; j < nof_symbols; j++) {
+      mse += crealf((xr[i][j] - x[i][j])*conjf(xr[i][j] - x[i][j]));
+    }
+  }
+  return mse / nof_layers / nof_symbols;
+}
+
 int main(int argc, char **argv) {
-  int i, j;
+  int i, j, k;
   float mse;
-  cf_t *x[SRSLTE_MAX_LAYERS], *r[SRSLTE_MAX_PORTS], *y[SRSLTE_MAX_PORTS], *h[SRSLTE_MAX_PORTS],
+  cf_t *x[SRSLTE_MAX_LAYERS], *r[SRSLTE_MAX_PORTS], *y[SRSLTE_MAX_PORTS], *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
       *xr[SRSLTE_MAX_LAYERS];
   srslte_mimo_type_t type;
   
   parse_args(argc, argv);
 
-  if (nof_ports > SRSLTE_MAX_PORTS || nof_layers > SRSLTE_MAX_LAYERS) {
-    fprintf(stderr, "Invalid number of layers or ports\n");
+  if (nof_ports > SRSLTE_MAX_PORTS || nof_layers > SRSLTE_MAX_LAYERS || nof_rxant > SRSLTE_MAX_PORTS) {
+    fprintf(stderr, "Invalid number of layers, ports or receive antennas\n");
     exit(-1);
   }
 
@@ -94,6 +124,10 @@ int main(int argc, char **argv) {
     exit(-1);
   }
 
+  /* In transmit diversity each layer symbol is spread over nof_layers RE, in spatial multiplexing there is 
+   * one RE per layer symbol */
+  int nof_re = (type == SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX || type == SRSLTE_MIMO_TYPE_CDD)?nof_symbols:nof_symbols*nof_layers; 
+
   for (i = 0; i < nof_layers; i++) {
     x[i] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols);
     if (!x[i]) {
@@ -108,23 +142,25 @@ int main(int argc, char **argv) {
   }
   for (i = 0; i < nof_ports; i++) {
     y[i] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols * nof_layers);
-    // TODO: The number of symbols per port is different in spatial multiplexing.
     if (!y[i]) {
       perror("srslte_vec_malloc");
       exit(-1);
     }
-    h[i] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols * nof_layers);
-    if (!h[i]) {
-      perror("srslte_vec_malloc");
-      exit(-1);
+    for (k = 0; k < nof_rxant; k++) {
+      h[i][k] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols * nof_layers);
+      if (!h[i][k]) {
+        perror("srslte_vec_malloc");
+        exit(-1);
+      }
     }
   }
 
-  /* only 1 receiver antenna supported now */
-  r[0] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols * nof_layers);
-  if (!r[0]) {
-    perror("srslte_vec_malloc");
-    exit(-1);
+  for (k = 0; k < nof_rxant; k++) {
+    r[k] = srslte_vec_malloc(sizeof(cf_t) * nof_symbols * nof_layers);
+    if (!r[k]) {
+      perror("srslte_vec_malloc");
+      exit(-1);
+    }
   }
 
   /* generate random data */
@@ -135,57 +171,82 @@ int main(int argc, char **argv) {
   }
   
   /* precoding */
-  if (srslte_precoding_type(x, y, nof_layers, nof_ports, nof_symbols, type) < 0) {
+  if (srslte_precoding_type(x, y, nof_layers, nof_ports, codebook_idx, nof_symbols, type) < 0) {
     fprintf(stderr, "Error layer mapper encoder\n");
     exit(-1);
   }
 
-  /* generate channel */
+  /* generate channel. Spatial multiplexing needs uncorrelated (zero mean) paths to resolve the layers */
+  float h_mean = nof_re == nof_symbols && nof_layers > 1?0.5:0; 
   for (i = 0; i < nof_ports; i++) {
-    for (j = 0; j < nof_symbols; j++) {
-      h[i][nof_layers*j] = (float) rand()/RAND_MAX+((float) rand()/RAND_MAX)*_Complex_I;
-      // assume the channel is time-invariant in nlayer consecutive symbols
-      for (int k=0;k<nof_layers;k++) {
-        h[i][nof_layers*j+k] = h[i][nof_layers*j];              
+    for (k = 0; k < nof_rxant; k++) {
+      for (j = 0; j < nof_symbols; j++) {
+        h[i][k][nof_layers*j] = (float) rand()/RAND_MAX-h_mean+((float) rand()/RAND_MAX-h_mean)*_Complex_I;
+        // assume the channel is time-invariant in nlayer consecutive symbols
+        for (int l=0;l<nof_layers;l++) {
+          h[i][k][nof_layers*j+l] = h[i][k][nof_layers*j];              
+        }
       }
     }
   }
 
   /* pass signal through channel
    (we are in the frequency domain so it's a multiplication) */
-  /* there's only one receiver antenna, signals from different transmitter
-   * ports are simply combined at the receiver
-   */
-  for (j = 0; j < nof_symbols * nof_layers; j++) {
-    r[0][j] = 0;
-    for (i = 0; i < nof_ports; i++) {
-      r[0][j] += y[i][j] * h[i][j];
+  /* signals from different transmitter ports are combined at each receiver antenna */
+  float noise_estimate = 0; 
+  if (snr_db >= 0) {
+    noise_estimate = powf(10, -snr_db/10); 
+  }
+  for (k = 0; k < nof_rxant; k++) {
+    for (j = 0; j < nof_re; j++) {
+      r[k][j] = 0;
+      for (i = 0; i < nof_ports; i++) {
+        r[k][j] += y[i][j] * h[i][k][j];
+      }
+    }
+    if (noise_estimate > 0) {
+      srslte_ch_awgn_c(r[k], r[k], sqrtf(noise_estimate/2), nof_re);
     }
   }
     
   /* predecoding / equalization */
   struct timeval t[3];
   gettimeofday(&t[1], NULL);
-  if (srslte_predecoding_type(r[0], h, xr, nof_ports, nof_layers,
-      nof_symbols * nof_layers, type, 0) < 0) {
-    fprintf(stderr, "Error layer mapper encoder\n");
-    exit(-1);
+  for (int n = 0; n < nof_repetitions; n++) {
+    if (srslte_predecoding_type_multi(r, h, xr, nof_rxant, nof_ports, nof_layers, codebook_idx,
+        nof_re, type, noise_estimate) < 0) {
+      fprintf(stderr, "Error layer mapper encoder\n");
+      exit(-1);
+    }
   }
   gettimeofday(&t[2], NULL);
   get_time_interval(t);
-  printf("Execution Time: %ld us\n", t[0].tv_usec);
+  long usec = t[0].tv_sec*1000000+t[0].tv_usec; 
+  printf("Execution Time: %ld us, %.1f MRE/s\n", usec/nof_repetitions, 
+         usec?(float) nof_re*nof_repetitions/usec:0);
   
   /* check errors */
-  mse = 0;
-  for (i = 0; i < nof_layers; i++) {
-    for (j = 0; j < nof_symbols; j++) {
-      mse += cabsf(xr[i][j] - x[i][j]);
+  if (noise_estimate > 0) {
+    /* MMSE must not be worse than ZF */
+    float mse_mmse = compute_mse(x, xr); 
+    srslte_predecoding_type_multi(r, h, xr, nof_rxant, nof_ports, nof_layers, codebook_idx, nof_re, type, 0);
+    mse = compute_mse(x, xr); 
+    printf("MSE: MMSE=%f, ZF=%f\n", mse_mmse, mse);
+    if (!(mse_mmse <= mse)) {
+      exit(-1);
+    }
+  } else {
+    mse = 0;
+    for (i = 0; i < nof_layers; i++) {
+      for (j = 0; j < nof_symbols; j++) {
+        mse += cabsf(xr[i][j] - x[i][j]);
+      }
     }
+    printf("MSE: %f\n", mse/ nof_layers / nof_symbols );
+    if (mse / nof_layers / nof_symbols > MSE_THRESHOLD) {
+      exit(-1);
+    } 
   }
-  printf("MSE: %f\n", mse/ nof_layers / nof_symbols );
-  if (mse / nof_layers / nof_symbols > MSE_THRESHOLD) {
-    exit(-1);
-  } 
 
   for (i = 0; i < nof_layers; i++) {
     free(x[i]);
@@ -193,10 +254,13 @@ int main(int argc, char **argv) {
   }
   for (i = 0; i < nof_ports; i++) {
     free(y[i]);
-    free(h[i]);
+    for (k = 0; k < nof_rxant; k++) {
+      free(h[i][k]);
+    }
+  }
+  for (k = 0; k < nof_rxant; k++) {
+    free(r[k]);
   }
-
-  free(r[0]);
   
   printf("Ok\n");
   exit(0); 
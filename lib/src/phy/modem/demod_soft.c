@@ -27,16 +27,18 @@
 
 #include <stdlib.h>
 #include <strings.h>
+#include <limits.h>
 
 #include "srslte/phy/utils/vector.h"
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/modem/demod_soft.h"
 
-// AVX implementation not useful for integers. Wait for AVX2
-
 #ifdef LV_HAVE_SSE
 #include <smmintrin.h>
-void demod_16qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols);
+#endif
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
 #endif
 
 
@@ -44,9 +46,21 @@ void demod_16qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols);
 #define SCALE_SHORT_CONV_QAM16 400
 #define SCALE_SHORT_CONV_QAM64 700
 
-void demod_bpsk_lte_s(const cf_t *symbols, short *llr, int nsymbols) {
+/* Converts to int16 saturating instead of wrapping around, so that a symbol far 
+ * outside the constellation never flips the sign of its LLR */
+static inline short demod_sat_s(float x) {
+  if (x > SHRT_MAX) {
+    return SHRT_MAX;
+  } else if (x < -SHRT_MAX) {
+    return -SHRT_MAX;
+  } else {
+    return (short) x;
+  }
+}
+
+void demod_bpsk_lte_s(const cf_t *symbols, short *llr, int nsymbols, float scale) {
   for (int i=0;i<nsymbols;i++) {
-    llr[i] = (short) -SCALE_SHORT_CONV_QPSK*(crealf(symbols[i]) + cimagf(symbols[i]))/sqrt(2);
+    llr[i] = demod_sat_s(-SCALE_SHORT_CONV_QPSK*scale*(crealf(symbols[i]) + cimagf(symbols[i]))/sqrt(2));
   }
 }
 
@@ -56,8 +70,11 @@ void demod_bpsk_lte(const cf_t *symbols, float *llr, int nsymbols) {
   }
 }
 
-void demod_qpsk_lte_s(const cf_t *symbols, short *llr, int nsymbols) {
-  srslte_vec_convert_fi((float*) symbols, llr, -SCALE_SHORT_CONV_QPSK*sqrt(2), nsymbols*2);
+void demod_qpsk_lte_s(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  const float *x = (const float*) symbols;
+  for (int i=0;i<2*nsymbols;i++) {
+    llr[i] = demod_sat_s(-SCALE_SHORT_CONV_QPSK*sqrt(2)*scale*x[i]);
+  }
 }
 
 void demod_qpsk_lte(const cf_t *symbols, float *llr, int nsymbols) {
@@ -76,29 +93,75 @@ void demod_16qam_lte(const cf_t *symbols, float *llr, int nsymbols) {
   }
 }
 
+void demod_16qam_lte_s(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  short offset = (short) (2*SCALE_SHORT_CONV_QAM16*scale/sqrt(10));
+  for (int i=0;i<nsymbols;i++) {
+    short yre = demod_sat_s(SCALE_SHORT_CONV_QAM16*scale*crealf(symbols[i]));
+    short yim = demod_sat_s(SCALE_SHORT_CONV_QAM16*scale*cimagf(symbols[i]));
+        
+    llr[4*i+0] = demod_sat_s(-yre);
+    llr[4*i+1] = demod_sat_s(-yim);
+    llr[4*i+2] = demod_sat_s(abs(yre)-offset);
+    llr[4*i+3] = demod_sat_s(abs(yim)-offset);    
+  }
+}
+
+void demod_64qam_lte(const cf_t *symbols, float *llr, int nsymbols) 
+{
+  for (int i=0;i<nsymbols;i++) {
+    float yre = crealf(symbols[i]);
+    float yim = cimagf(symbols[i]);
+
+    llr[6*i+0] = -yre;
+    llr[6*i+1] = -yim;
+    llr[6*i+2] = fabsf(yre)-4/sqrt(42);
+    llr[6*i+3] = fabsf(yim)-4/sqrt(42);
+    llr[6*i+4] = fabsf(llr[6*i+2])-2/sqrt(42);
+    llr[6*i+5] = fabsf(llr[6*i+3])-2/sqrt(42);        
+  }
+  
+}
+
+void demod_64qam_lte_s(const cf_t *symbols, short *llr, int nsymbols, float scale) 
+{
+  short offset1 = (short) (4*SCALE_SHORT_CONV_QAM64*scale/sqrt(42));
+  short offset2 = (short) (2*SCALE_SHORT_CONV_QAM64*scale/sqrt(42));
+  for (int i=0;i<nsymbols;i++) {
+    short yre = demod_sat_s(SCALE_SHORT_CONV_QAM64*scale*crealf(symbols[i]));
+    short yim = demod_sat_s(SCALE_SHORT_CONV_QAM64*scale*cimagf(symbols[i]));
+
+    llr[6*i+0] = demod_sat_s(-yre);
+    llr[6*i+1] = demod_sat_s(-yim);
+    llr[6*i+2] = demod_sat_s(abs(yre)-offset1);
+    llr[6*i+3] = demod_sat_s(abs(yim)-offset1);
+    llr[6*i+4] = demod_sat_s(abs(llr[6*i+2])-offset2);
+    llr[6*i+5] = demod_sat_s(abs(llr[6*i+3])-offset2);        
+  }
+}
+
 #ifdef LV_HAVE_SSE
 
-void demod_16qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols) {
-    float *symbolsPtr = (float*) symbols;
+void demod_16qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  float *symbolsPtr = (float*) symbols;
   __m128i *resultPtr = (__m128i*) llr;
   __m128 symbol1, symbol2; 
   __m128i symbol_i1, symbol_i2, symbol_i, symbol_abs;
-  __m128i offset = _mm_set1_epi16(2*SCALE_SHORT_CONV_QAM16/sqrt(10));
+  __m128i offset = _mm_set1_epi16((short) (2*SCALE_SHORT_CONV_QAM16*scale/sqrt(10)));
   __m128i result11, result12, result22, result21; 
-  __m128 scale_v = _mm_set1_ps(-SCALE_SHORT_CONV_QAM16);
+  __m128 scale_v = _mm_set1_ps(-SCALE_SHORT_CONV_QAM16*scale);
   __m128i shuffle_negated_1 = _mm_set_epi8(0xff,0xff,0xff,0xff,7,6,5,4,0xff,0xff,0xff,0xff,3,2,1,0);
   __m128i shuffle_negated_2 = _mm_set_epi8(0xff,0xff,0xff,0xff,15,14,13,12,0xff,0xff,0xff,0xff,11,10,9,8);
   __m128i shuffle_abs_1 = _mm_set_epi8(7,6,5,4,0xff,0xff,0xff,0xff,3,2,1,0,0xff,0xff,0xff,0xff);
   __m128i shuffle_abs_2 = _mm_set_epi8(15,14,13,12,0xff,0xff,0xff,0xff,11,10,9,8,0xff,0xff,0xff,0xff);
   for (int i=0;i<nsymbols/4;i++) {
-    symbol1   = _mm_load_ps(symbolsPtr); symbolsPtr+=4;
-    symbol2   = _mm_load_ps(symbolsPtr); symbolsPtr+=4;
+    symbol1   = _mm_loadu_ps(symbolsPtr); symbolsPtr+=4;
+    symbol2   = _mm_loadu_ps(symbolsPtr); symbolsPtr+=4;
     symbol_i1 = _mm_cvtps_epi32(_mm_mul_ps(symbol1, scale_v));
     symbol_i2 = _mm_cvtps_epi32(_mm_mul_ps(symbol2, scale_v));
-    symbol_i  = _mm_packs_epi32(symbol_i1, symbol_i2);
+    symbol_i  = _mm_max_epi16(_mm_packs_epi32(symbol_i1, symbol_i2), _mm_set1_epi16(-SHRT_MAX));
     
     symbol_abs  = _mm_abs_epi16(symbol_i);
-    symbol_abs  = _mm_sub_epi16(symbol_abs, offset);
+    symbol_abs  = _mm_subs_epi16(symbol_abs, offset);
     
     result11 = _mm_shuffle_epi8(symbol_i, shuffle_negated_1);  
     result12 = _mm_shuffle_epi8(symbol_abs, shuffle_abs_1);  
@@ -106,65 +169,23 @@ void demod_16qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols) {
     result21 = _mm_shuffle_epi8(symbol_i, shuffle_negated_2);  
     result22 = _mm_shuffle_epi8(symbol_abs, shuffle_abs_2);  
 
-    _mm_store_si128(resultPtr, _mm_or_si128(result11, result12)); resultPtr++;
-    _mm_store_si128(resultPtr, _mm_or_si128(result21, result22)); resultPtr++;
+    _mm_storeu_si128(resultPtr, _mm_or_si128(result11, result12)); resultPtr++;
+    _mm_storeu_si128(resultPtr, _mm_or_si128(result21, result22)); resultPtr++;
   }
   // Demodulate last symbols 
-  for (int i=4*(nsymbols/4);i<nsymbols;i++) {
-    short yre = (short) (SCALE_SHORT_CONV_QAM16*crealf(symbols[i]));
-    short yim = (short) (SCALE_SHORT_CONV_QAM16*cimagf(symbols[i]));
-        
-    llr[4*i+0] = -yre;
-    llr[4*i+1] = -yim;
-    llr[4*i+2] = abs(yre)-2*SCALE_SHORT_CONV_QAM16/sqrt(10);
-    llr[4*i+3] = abs(yim)-2*SCALE_SHORT_CONV_QAM16/sqrt(10);    
-  }
-}
-#endif
-
-void demod_16qam_lte_s(const cf_t *symbols, short *llr, int nsymbols) {
-#ifdef LV_HAVE_SSE
-  demod_16qam_lte_s_sse(symbols, llr, nsymbols);
-#else
-  for (int i=0;i<nsymbols;i++) {
-    short yre = (short) (SCALE_SHORT_CONV_QAM16*crealf(symbols[i]));
-    short yim = (short) (SCALE_SHORT_CONV_QAM16*cimagf(symbols[i]));
-        
-    llr[4*i+0] = -yre;
-    llr[4*i+1] = -yim;
-    llr[4*i+2] = abs(yre)-2*SCALE_SHORT_CONV_QAM16/sqrt(10);
-    llr[4*i+3] = abs(yim)-2*SCALE_SHORT_CONV_QAM16/sqrt(10);    
-  }
-#endif
-}
-
-void demod_64qam_lte(const cf_t *symbols, float *llr, int nsymbols) 
-{
-  for (int i=0;i<nsymbols;i++) {
-    float yre = crealf(symbols[i]);
-    float yim = cimagf(symbols[i]);
-
-    llr[6*i+0] = -yre;
-    llr[6*i+1] = -yim;
-    llr[6*i+2] = fabsf(yre)-4/sqrt(42);
-    llr[6*i+3] = fabsf(yim)-4/sqrt(42);
-    llr[6*i+4] = fabsf(llr[6*i+2])-2/sqrt(42);
-    llr[6*i+5] = fabsf(llr[6*i+3])-2/sqrt(42);        
-  }
-  
+  int i=4*(nsymbols/4);
+  demod_16qam_lte_s(&symbols[i], &llr[4*i], nsymbols-i, scale);
 }
 
-#ifdef LV_HAVE_SSE
-
-void demod_64qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols) 
+void demod_64qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols, float scale) 
 {
   float *symbolsPtr = (float*) symbols;
   __m128i *resultPtr = (__m128i*) llr;
   __m128 symbol1, symbol2; 
   __m128i symbol_i1, symbol_i2, symbol_i, symbol_abs, symbol_abs2;
-  __m128i offset1 = _mm_set1_epi16(4*SCALE_SHORT_CONV_QAM64/sqrt(42));
-  __m128i offset2 = _mm_set1_epi16(2*SCALE_SHORT_CONV_QAM64/sqrt(42));
-  __m128 scale_v = _mm_set1_ps(-SCALE_SHORT_CONV_QAM64);
+  __m128i offset1 = _mm_set1_epi16((short) (4*SCALE_SHORT_CONV_QAM64*scale/sqrt(42)));
+  __m128i offset2 = _mm_set1_epi16((short) (2*SCALE_SHORT_CONV_QAM64*scale/sqrt(42)));
+  __m128 scale_v = _mm_set1_ps(-SCALE_SHORT_CONV_QAM64*scale);
   __m128i result11, result12, result13, result22, result21,result23, result31, result32, result33; 
 
   __m128i shuffle_negated_1 = _mm_set_epi8(7,6,5,4,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,3,2,1,0);
@@ -180,15 +201,15 @@ void demod_64qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols)
   __m128i shuffle_abs2_3 = _mm_set_epi8(15,14,13,12,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,11,10,9,8);
 
   for (int i=0;i<nsymbols/4;i++) {
-    symbol1   = _mm_load_ps(symbolsPtr); symbolsPtr+=4;
-    symbol2   = _mm_load_ps(symbolsPtr); symbolsPtr+=4;
+    symbol1   = _mm_loadu_ps(symbolsPtr); symbolsPtr+=4;
+    symbol2   = _mm_loadu_ps(symbolsPtr); symbolsPtr+=4;
     symbol_i1 = _mm_cvtps_epi32(_mm_mul_ps(symbol1, scale_v));
     symbol_i2 = _mm_cvtps_epi32(_mm_mul_ps(symbol2, scale_v));
-    symbol_i  = _mm_packs_epi32(symbol_i1, symbol_i2);
+    symbol_i  = _mm_max_epi16(_mm_packs_epi32(symbol_i1, symbol_i2), _mm_set1_epi16(-SHRT_MAX));
     
     symbol_abs  = _mm_abs_epi16(symbol_i);
-    symbol_abs  = _mm_sub_epi16(symbol_abs, offset1);
-    symbol_abs2 = _mm_sub_epi16(_mm_abs_epi16(symbol_abs), offset2);
+    symbol_abs  = _mm_subs_epi16(symbol_abs, offset1);
+    symbol_abs2 = _mm_subs_epi16(_mm_abs_epi16(symbol_abs), offset2);
     
     result11 = _mm_shuffle_epi8(symbol_i, shuffle_negated_1);  
     result12 = _mm_shuffle_epi8(symbol_abs, shuffle_abs_1);  
@@ -202,42 +223,152 @@ void demod_64qam_lte_s_sse(const cf_t *symbols, short *llr, int nsymbols)
     result32 = _mm_shuffle_epi8(symbol_abs, shuffle_abs_3);  
     result33 = _mm_shuffle_epi8(symbol_abs2, shuffle_abs2_3);  
 
-    _mm_store_si128(resultPtr, _mm_or_si128(_mm_or_si128(result11, result12),result13)); resultPtr++;
-    _mm_store_si128(resultPtr, _mm_or_si128(_mm_or_si128(result21, result22),result23)); resultPtr++;
-    _mm_store_si128(resultPtr, _mm_or_si128(_mm_or_si128(result31, result32),result33)); resultPtr++;
-  }
-  for (int i=4*(nsymbols/4);i<nsymbols;i++) {
-    float yre = (short) (SCALE_SHORT_CONV_QAM64*crealf(symbols[i]));
-    float yim = (short) (SCALE_SHORT_CONV_QAM64*cimagf(symbols[i]));
-
-    llr[6*i+0] = -yre;
-    llr[6*i+1] = -yim;
-    llr[6*i+2] = abs(yre)-4*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+3] = abs(yim)-4*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+4] = abs(llr[6*i+2])-2*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+5] = abs(llr[6*i+3])-2*SCALE_SHORT_CONV_QAM64/sqrt(42);        
+    _mm_storeu_si128(resultPtr, _mm_or_si128(_mm_or_si128(result11, result12),result13)); resultPtr++;
+    _mm_storeu_si128(resultPtr, _mm_or_si128(_mm_or_si128(result21, result22),result23)); resultPtr++;
+    _mm_storeu_si128(resultPtr, _mm_or_si128(_mm_or_si128(result31, result32),result33)); resultPtr++;
   }
+  int i=4*(nsymbols/4);
+  demod_64qam_lte_s(&symbols[i], &llr[6*i], nsymbols-i, scale);
 }
   
 #endif
 
-void demod_64qam_lte_s(const cf_t *symbols, short *llr, int nsymbols) 
-{
-#ifdef LV_HAVE_SSE
-  demod_64qam_lte_s_sse(symbols, llr, nsymbols);
-#else
-  for (int i=0;i<nsymbols;i++) {
-    float yre = (short) (SCALE_SHORT_CONV_QAM64*crealf(symbols[i]));
-    float yim = (short) (SCALE_SHORT_CONV_QAM64*cimagf(symbols[i]));
+#ifdef LV_HAVE_AVX2
+
+/* All AVX2 kernels process 8 symbols per iteration. The scaling is applied on the floats and 
+ * the conversion to int16 saturates (packs), so no further pass over the LLRs is needed */
+
+void demod_bpsk_lte_s_avx2(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  const float *symbolsPtr = (const float*) symbols;
+  __m256 scale_v = _mm256_set1_ps(-SCALE_SHORT_CONV_QPSK*scale/sqrt(2));
+  // hadd leaves the sums of symbols 0,1,4,5 in the low lane and 2,3,6,7 in the high lane
+  __m256i reorder = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+  for (int i=0;i<nsymbols/8;i++) {
+    __m256 symbol1 = _mm256_loadu_ps(symbolsPtr); symbolsPtr+=8;
+    __m256 symbol2 = _mm256_loadu_ps(symbolsPtr); symbolsPtr+=8;
+    __m256i sum_i  = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_hadd_ps(symbol1, symbol2), scale_v));
+    sum_i = _mm256_permutevar8x32_epi32(sum_i, reorder);
+    _mm_storeu_si128((__m128i*) &llr[8*i], _mm_packs_epi32(_mm256_castsi256_si128(sum_i), 
+                                                           _mm256_extracti128_si256(sum_i, 1)));
+  }
+  int i=8*(nsymbols/8);
+  demod_bpsk_lte_s(&symbols[i], &llr[i], nsymbols-i, scale);
+}
 
-    llr[6*i+0] = -yre;
-    llr[6*i+1] = -yim;
-    llr[6*i+2] = abs(yre)-4*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+3] = abs(yim)-4*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+4] = abs(llr[6*i+2])-2*SCALE_SHORT_CONV_QAM64/sqrt(42);
-    llr[6*i+5] = abs(llr[6*i+3])-2*SCALE_SHORT_CONV_QAM64/sqrt(42);        
+/* Converts 8 symbols to saturated int16 scaled by scale_v. packs interleaves the two 128-bit 
+ * lanes so the output holds, as 32-bit (re,im) pairs, symbols 0,1,4,5 in the low lane and 
+ * 2,3,6,7 in the high lane. The output is clamped at -SHRT_MAX so that abs() does not overflow */
+static inline __m256i demod_avx2_load_s(const float *symbolsPtr, __m256 scale_v) {
+  __m256i symbol_i1 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr), scale_v));
+  __m256i symbol_i2 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr+8), scale_v));
+  return _mm256_max_epi16(_mm256_packs_epi32(symbol_i1, symbol_i2), _mm256_set1_epi16(-SHRT_MAX));
+}
+
+void demod_qpsk_lte_s_avx2(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  const float *symbolsPtr = (const float*) symbols;
+  __m256 scale_v = _mm256_set1_ps(-SCALE_SHORT_CONV_QPSK*sqrt(2)*scale);
+  for (int i=0;i<nsymbols/8;i++) {
+    __m256i symbol_i = demod_avx2_load_s(symbolsPtr, scale_v); symbolsPtr+=16;
+    _mm256_storeu_si256((__m256i*) &llr[16*i], _mm256_permute4x64_epi64(symbol_i, 0xd8));
+  }
+  int i=8*(nsymbols/8);
+  demod_qpsk_lte_s(&symbols[i], &llr[2*i], nsymbols-i, scale);
+}
+
+void demod_16qam_lte_s_avx2(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  const float *symbolsPtr = (const float*) symbols;
+  __m256 scale_v = _mm256_set1_ps(-SCALE_SHORT_CONV_QAM16*scale);
+  __m256i offset = _mm256_set1_epi16((short) (2*SCALE_SHORT_CONV_QAM16*scale/sqrt(10)));
+  for (int i=0;i<nsymbols/8;i++) {
+    __m256i symbol_i   = demod_avx2_load_s(symbolsPtr, scale_v); symbolsPtr+=16;
+    __m256i symbol_abs = _mm256_subs_epi16(_mm256_abs_epi16(symbol_i), offset);
+    // Per lane unpack of the (re,im) pairs yields symbols 0-3 and 4-7 in order
+    _mm256_storeu_si256((__m256i*) &llr[32*i],    _mm256_unpacklo_epi32(symbol_i, symbol_abs));
+    _mm256_storeu_si256((__m256i*) &llr[32*i+16], _mm256_unpackhi_epi32(symbol_i, symbol_abs));
+  }
+  int i=8*(nsymbols/8);
+  demod_16qam_lte_s(&symbols[i], &llr[4*i], nsymbols-i, scale);
+}
+
+void demod_64qam_lte_s_avx2(const cf_t *symbols, short *llr, int nsymbols, float scale) {
+  const float *symbolsPtr = (const float*) symbols;
+  __m256 scale_v = _mm256_set1_ps(-SCALE_SHORT_CONV_QAM64*scale);
+  __m256i offset1 = _mm256_set1_epi16((short) (4*SCALE_SHORT_CONV_QAM64*scale/sqrt(42)));
+  __m256i offset2 = _mm256_set1_epi16((short) (2*SCALE_SHORT_CONV_QAM64*scale/sqrt(42)));
+  /* Output words are (re,im) pairs from symbol_i (s), symbol_abs (a) and symbol_abs2 (b) in the 
+   * order s0 a0 b0 s1 a1 b1 ... Each output vector gathers the pairs of the symbols it needs and 
+   * blends the three sources. Symbol n is at pair position 0,1,4,5,2,3,6,7 of the packed vectors */
+  __m256i perm1 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 4, 4);
+  __m256i perm2 = _mm256_setr_epi32(4, 5, 5, 5, 2, 2, 2, 3);
+  __m256i perm3 = _mm256_setr_epi32(3, 3, 6, 6, 6, 7, 7, 7);
+  for (int i=0;i<nsymbols/8;i++) {
+    __m256i symbol_i    = demod_avx2_load_s(symbolsPtr, scale_v); symbolsPtr+=16;
+    __m256i symbol_abs  = _mm256_subs_epi16(_mm256_abs_epi16(symbol_i), offset1);
+    __m256i symbol_abs2 = _mm256_subs_epi16(_mm256_abs_epi16(symbol_abs), offset2);
+
+    __m256i result1 = _mm256_permutevar8x32_epi32(symbol_i, perm1);
+    result1 = _mm256_blend_epi32(result1, _mm256_permutevar8x32_epi32(symbol_abs,  perm1), 0x92);
+    result1 = _mm256_blend_epi32(result1, _mm256_permutevar8x32_epi32(symbol_abs2, perm1), 0x24);
+
+    __m256i result2 = _mm256_permutevar8x32_epi32(symbol_i, perm2);
+    result2 = _mm256_blend_epi32(result2, _mm256_permutevar8x32_epi32(symbol_abs,  perm2), 0x24);
+    result2 = _mm256_blend_epi32(result2, _mm256_permutevar8x32_epi32(symbol_abs2, perm2), 0x49);
+
+    __m256i result3 = _mm256_permutevar8x32_epi32(symbol_i, perm3);
+    result3 = _mm256_blend_epi32(result3, _mm256_permutevar8x32_epi32(symbol_abs,  perm3), 0x49);
+    result3 = _mm256_blend_epi32(result3, _mm256_permutevar8x32_epi32(symbol_abs2, perm3), 0x92);
+
+    _mm256_storeu_si256((__m256i*) &llr[48*i],    result1);
+    _mm256_storeu_si256((__m256i*) &llr[48*i+16], result2);
+    _mm256_storeu_si256((__m256i*) &llr[48*i+32], result3);
   }
+  int i=8*(nsymbols/8);
+  demod_64qam_lte_s(&symbols[i], &llr[6*i], nsymbols-i, scale);
+}
+
+#endif /* LV_HAVE_AVX2 */
+
+bool srslte_demod_soft_impl_available(srslte_demod_soft_impl_t impl) {
+  switch(impl) {
+    case SRSLTE_DEMOD_SOFT_AUTO:
+    case SRSLTE_DEMOD_SOFT_GEN:
+      return true;
+#ifdef LV_HAVE_SSE
+    case SRSLTE_DEMOD_SOFT_SSE:
+      return true;
+#endif
+#ifdef LV_HAVE_AVX2
+    case SRSLTE_DEMOD_SOFT_AVX2:
+      return __builtin_cpu_supports("avx2");
 #endif
+    default:
+      return false;
+  }
+}
+
+const char* srslte_demod_soft_impl_string(srslte_demod_soft_impl_t impl) {
+  switch(impl) {
+    case SRSLTE_DEMOD_SOFT_AUTO:
+      return "Auto";
+    case SRSLTE_DEMOD_SOFT_GEN:
+      return "Generic";
+    case SRSLTE_DEMOD_SOFT_SSE:
+      return "SSE";
+    case SRSLTE_DEMOD_SOFT_AVX2:
+      return "AVX2";
+    default:
+      return "Unknown";
+  }
+}
+
+static srslte_demod_soft_impl_t demod_soft_best_impl() {
+  if (srslte_demod_soft_impl_available(SRSLTE_DEMOD_SOFT_AVX2)) {
+    return SRSLTE_DEMOD_SOFT_AVX2;
+  } else if (srslte_demod_soft_impl_available(SRSLTE_DEMOD_SOFT_SSE)) {
+    return SRSLTE_DEMOD_SOFT_SSE;
+  } else {
+    return SRSLTE_DEMOD_SOFT_GEN;
+  }
 }
 
 int srslte_demod_soft_demodulate(srslte_mod_t modulation, const cf_t* symbols, float* llr, int nsymbols) {
@@ -262,18 +393,75 @@ int srslte_demod_soft_demodulate(srslte_mod_t modulation, const cf_t* symbols, f
 }
 
 int srslte_demod_soft_demodulate_s(srslte_mod_t modulation, const cf_t* symbols, short* llr, int nsymbols) {
+  return srslte_demod_soft_demodulate_s_impl(modulation, symbols, llr, nsymbols, 1.0, SRSLTE_DEMOD_SOFT_AUTO);
+}
+
+int srslte_demod_soft_demodulate_s_scale(srslte_mod_t modulation, const cf_t* symbols, short* llr, int nsymbols, float scale) {
+  return srslte_demod_soft_demodulate_s_impl(modulation, symbols, llr, nsymbols, scale, SRSLTE_DEMOD_SOFT_AUTO);
+}
+
+int srslte_demod_soft_demodulate_s_impl(srslte_mod_t modulation, const cf_t* symbols, short* llr, int nsymbols, 
+                                        float scale, srslte_demod_soft_impl_t impl) 
+{
+  if (impl == SRSLTE_DEMOD_SOFT_AUTO) {
+    impl = demod_soft_best_impl();
+  }
+  if (!srslte_demod_soft_impl_available(impl)) {
+    fprintf(stderr, "Soft demodulator implementation %s not available\n", srslte_demod_soft_impl_string(impl));
+    return -1;
+  }
   switch(modulation) {
     case SRSLTE_MOD_BPSK:
-      demod_bpsk_lte_s(symbols, llr, nsymbols);
+#ifdef LV_HAVE_AVX2
+      if (impl == SRSLTE_DEMOD_SOFT_AVX2) {
+        demod_bpsk_lte_s_avx2(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+      demod_bpsk_lte_s(symbols, llr, nsymbols, scale);
       break;
     case SRSLTE_MOD_QPSK:
-      demod_qpsk_lte_s(symbols, llr, nsymbols);
+#ifdef LV_HAVE_AVX2
+      if (impl == SRSLTE_DEMOD_SOFT_AVX2) {
+        demod_qpsk_lte_s_avx2(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+      if (impl == SRSLTE_DEMOD_SOFT_SSE) {
+        srslte_vec_convert_fi((float*) symbols, llr, -SCALE_SHORT_CONV_QPSK*sqrt(2)*scale, nsymbols*2);
+        break;
+      }
+      demod_qpsk_lte_s(symbols, llr, nsymbols, scale);
       break;
     case SRSLTE_MOD_16QAM:
-      demod_16qam_lte_s(symbols, llr, nsymbols);
+#ifdef LV_HAVE_AVX2
+      if (impl == SRSLTE_DEMOD_SOFT_AVX2) {
+        demod_16qam_lte_s_avx2(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+#ifdef LV_HAVE_SSE
+      if (impl == SRSLTE_DEMOD_SOFT_SSE) {
+        demod_16qam_lte_s_sse(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+      demod_16qam_lte_s(symbols, llr, nsymbols, scale);
       break;
     case SRSLTE_MOD_64QAM:
-      demod_64qam_lte_s(symbols, llr, nsymbols);
+#ifdef LV_HAVE_AVX2
+      if (impl == SRSLTE_DEMOD_SOFT_AVX2) {
+        demod_64qam_lte_s_avx2(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+#ifdef LV_HAVE_SSE
+      if (impl == SRSLTE_DEMOD_SOFT_SSE) {
+        demod_64qam_lte_s_sse(symbols, llr, nsymbols, scale);
+        break;
+      }
+#endif
+      demod_64qam_lte_s(symbols, llr, nsymbols, scale);
       break;
     default: 
       fprintf(stderr, "Invalid modulation %d\n", modulation);
@@ -38,17 +38,19 @@
 int nof_frames = 10; 
 int num_bits = 1000;
 srslte_mod_t modulation = 10;
+bool throughput_mode = false; 
 
 void usage(char *prog) {
-  printf("Usage: %s [nfv] -m modulation (1: BPSK, 2: QPSK, 4: QAM16, 6: QAM64)\n", prog);
+  printf("Usage: %s [nftv] -m modulation (1: BPSK, 2: QPSK, 4: QAM16, 6: QAM64)\n", prog);
   printf("\t-n num_bits [Default %d]\n", num_bits);
   printf("\t-f nof_frames [Default %d]\n", nof_frames);
+  printf("\t-t measure symbols/s of every modulation and implementation [Default %s]\n", throughput_mode?"yes":"no");
   printf("\t-v srslte_verbose [Default None]\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "nmvf")) != -1) {
+  while ((opt = getopt(argc, argv, "nmvft")) != -1) {
     switch (opt) {
     case 'n':
       num_bits = atoi(argv[optind]);
@@ -56,6 +58,9 @@ void parse_args(int argc, char **argv) {
     case 'f':
       nof_frames = atoi(argv[optind]);
       break;
+    case 't':
+      throughput_mode = true;
+      break;
     case 'v':
       srslte_verbose++;
       break;
@@ -84,7 +89,7 @@ void parse_args(int argc, char **argv) {
       exit(-1);
     }
   }
-  if (modulation == 10) {
+  if (modulation == 10 && !throughput_mode) {
     usage(argv[0]);
     exit(-1);
   }
@@ -105,6 +110,71 @@ float mse_threshold() {
   }
 }
 
+/* Demodulates nof_frames blocks of num_bits random bits with every modulation and implementation 
+ * and prints the throughput in symbols per second */
+int run_throughput() {
+  srslte_mod_t mods[4] = {SRSLTE_MOD_BPSK, SRSLTE_MOD_QPSK, SRSLTE_MOD_16QAM, SRSLTE_MOD_64QAM};
+  srslte_demod_soft_impl_t impls[3] = {SRSLTE_DEMOD_SOFT_GEN, SRSLTE_DEMOD_SOFT_SSE, SRSLTE_DEMOD_SOFT_AVX2};
+  int ret = -1; 
+
+  uint8_t *input = srslte_vec_malloc(sizeof(uint8_t) * num_bits);
+  cf_t *symbols = srslte_vec_malloc(sizeof(cf_t) * num_bits);
+  short *llr_s = srslte_vec_malloc(sizeof(short) * num_bits);
+  if (!input || !symbols || !llr_s) {
+    perror("malloc");
+    goto clean_exit;
+  }
+  for (int i=0;i<num_bits;i++) {
+    input[i] = rand()%2;
+  }
+
+  printf("%-8s", "");
+  for (int j=0;j<3;j++) {
+    printf("%14s", srslte_demod_soft_impl_string(impls[j]));
+  }
+  printf("   [Msymbols/s]\n");
+  for (int m=0;m<4;m++) {
+    srslte_modem_table_t mod;
+    if (srslte_modem_table_lte(&mod, mods[m])) {
+      fprintf(stderr, "Error initializing modem table\n");
+      goto clean_exit;
+    }
+    int nsymbols = num_bits / mod.nbits_x_symbol; 
+    srslte_mod_modulate(&mod, input, symbols, nsymbols * mod.nbits_x_symbol);
+    printf("%-8s", srslte_mod_string(mods[m]));
+    for (int j=0;j<3;j++) {
+      if (!srslte_demod_soft_impl_available(impls[j])) {
+        printf("%14s", "n/a");
+        continue;
+      }
+      struct timeval t[3]; 
+      gettimeofday(&t[1], NULL);
+      for (int n=0;n<nof_frames;n++) {
+        srslte_demod_soft_demodulate_s_impl(mods[m], symbols, llr_s, nsymbols, 1.0, impls[j]);
+      }
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      float usec = t[0].tv_sec*1e6 + t[0].tv_usec; 
+      printf("%14.1f", (float) nof_frames*nsymbols/usec);
+    }
+    printf("\n");
+    srslte_modem_table_free(&mod);
+  }
+  ret = 0; 
+
+clean_exit:
+  if (input) {
+    free(input);
+  }
+  if (symbols) {
+    free(symbols);
+  }
+  if (llr_s) {
+    free(llr_s);
+  }
+  return ret; 
+}
+
 int main(int argc, char **argv) {
   int i;
   srslte_modem_table_t mod;
@@ -115,6 +185,10 @@ int main(int argc, char **argv) {
 
   parse_args(argc, argv);
 
+  if (throughput_mode) {
+    exit(run_throughput());
+  }
+
   /* initialize objects */
   if (srslte_modem_table_lte(&mod, modulation)) {
     fprintf(stderr, "Error initializing modem table\n");
@@ -209,10 +283,24 @@ int main(int argc, char **argv) {
           goto clean_exit;
       }
     }
+
+    // Check that every implementation of the fixed-point demodulator makes the same decisions
+    for (int j=SRSLTE_DEMOD_SOFT_GEN;j<=SRSLTE_DEMOD_SOFT_AVX2;j++) {
+      if (srslte_demod_soft_impl_available(j)) {
+        srslte_demod_soft_demodulate_s_impl(modulation, symbols, llr_s, num_bits / mod.nbits_x_symbol, 1.0, j);
+        for (int i=0;i<num_bits;i++) {
+          if (input[i] != (llr_s[i]>0?1:0)) {
+            printf("Error in bit %d with %s implementation\n", i, srslte_demod_soft_impl_string(j));
+            goto clean_exit;
+          }
+        }
+      }
+    }
   }
   ret = 0; 
 
 clean_exit:  
+  free(llr_s);
   free(llr);
   free(symbols);
   free(output);
@@ -61,11 +61,36 @@ int srslte_cqi_ue_subband_pack(srslte_cqi_ue_subband_t *msg, uint8_t buff[SRSLTE
   return 4+2+msg->L;
 }
 
+/* Number of PMI bits of a wideband report, 36.212 Table 5.2.3.3.1-2 */
+static uint32_t cqi_format2_wideband_pmi_bits(srslte_cqi_format2_wideband_t *msg) 
+{
+  if (msg->four_antenna_ports) {
+    return 4; 
+  } else {
+    return msg->rank_is_not_one?1:2; 
+  }
+}
+
+static int cqi_format2_wideband_size(srslte_cqi_format2_wideband_t *msg) 
+{
+  if (msg->pmi_present) {
+    return 4 + (msg->rank_is_not_one?3:0) + cqi_format2_wideband_pmi_bits(msg); 
+  } else {
+    return 4; 
+  }
+}
+
 int srslte_cqi_format2_wideband_pack(srslte_cqi_format2_wideband_t *msg, uint8_t buff[SRSLTE_CQI_MAX_BITS]) 
 {
   uint8_t *body_ptr = buff; 
   srslte_bit_unpack(msg->wideband_cqi, &body_ptr, 4);  
-  return 4;  
+  if (msg->pmi_present) {
+    if (msg->rank_is_not_one) {
+      srslte_bit_unpack(msg->spatial_diff_cqi, &body_ptr, 3);  
+    }
+    srslte_bit_unpack(msg->pmi, &body_ptr, cqi_format2_wideband_pmi_bits(msg));  
+  }
+  return cqi_format2_wideband_size(msg);  
 }
 
 int srslte_cqi_format2_subband_pack(srslte_cqi_format2_subband_t *msg, uint8_t buff[SRSLTE_CQI_MAX_BITS]) 
@@ -119,7 +144,13 @@ int srslte_cqi_format2_wideband_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], srslte
 {
   uint8_t *body_ptr = buff; 
   msg->wideband_cqi = srslte_bit_pack(&body_ptr, 4);  
-  return 4;  
+  if (msg->pmi_present) {
+    if (msg->rank_is_not_one) {
+      msg->spatial_diff_cqi = srslte_bit_pack(&body_ptr, 3);  
+    }
+    msg->pmi = srslte_bit_pack(&body_ptr, cqi_format2_wideband_pmi_bits(msg));  
+  }
+  return cqi_format2_wideband_size(msg);  
 }
 
 int srslte_cqi_format2_subband_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], srslte_cqi_format2_subband_t *msg) 
@@ -145,10 +176,41 @@ int srslte_cqi_value_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], srslte_cqi_value_
   return -1; 
 }
 
+/* Rank indication on PUCCH, 36.212 Table 5.2.3.3.1-3: 1 bit for up to 2 layers and 2 bits for 4 layers */
+int srslte_cqi_ri_pack(uint32_t ri, uint32_t max_layers, uint8_t buff[SRSLTE_CQI_MAX_BITS])
+{
+  uint8_t *body_ptr = buff; 
+  uint32_t nof_bits = max_layers>2?2:1; 
+  if (ri < 1 || ri > max_layers) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  srslte_bit_unpack(ri-1, &body_ptr, nof_bits);  
+  return nof_bits; 
+}
+
+int srslte_cqi_ri_unpack(uint8_t buff[SRSLTE_CQI_MAX_BITS], uint32_t max_layers, uint32_t *ri)
+{
+  uint8_t *body_ptr = buff; 
+  uint32_t nof_bits = max_layers>2?2:1; 
+  *ri = srslte_bit_pack(&body_ptr, nof_bits) + 1;  
+  return nof_bits; 
+}
+
+/* Converts a codebook index of 36.211 Table 6.3.4.2.3-1 or 6.3.4.2.3-2 to the reported PMI. With two ports 
+ * and two layers codebook index 0 is not reported and 1, 2 are reported as 0, 1 */
+uint32_t srslte_cqi_pmi_from_codebook(uint32_t nof_ports, uint32_t nof_layers, uint32_t codebook_idx) 
+{
+  if (nof_ports == 2 && nof_layers == 2) {
+    return codebook_idx>0?codebook_idx-1:0; 
+  } else {
+    return codebook_idx; 
+  }
+}
+
 int srslte_cqi_size(srslte_cqi_value_t *value) {
   switch(value->type) {
     case SRSLTE_CQI_TYPE_WIDEBAND:
-      return 4;
+      return cqi_format2_wideband_size(&value->wideband);
     case SRSLTE_CQI_TYPE_SUBBAND:
       return 4+(value->subband.subband_label_2_bits)?2:1;
     case SRSLTE_CQI_TYPE_SUBBAND_UE:
@@ -159,47 +221,53 @@ int srslte_cqi_size(srslte_cqi_value_t *value) {
   return -1;
 }
 
-bool srslte_cqi_send(uint32_t I_cqi_pmi, uint32_t tti) {
-  
-  uint32_t N_p = 0;
-  uint32_t N_offset = 0;
+/* Period N_p and offset N_offset,CQI of the CQI/PMI configuration index, 36.213 Table 7.2.2-1A */
+static bool cqi_get_N(uint32_t I_cqi_pmi, uint32_t *N_p, uint32_t *N_offset) {
   
   if (I_cqi_pmi <= 1) {
-    N_p = 2; 
-    N_offset = I_cqi_pmi; 
+    *N_p = 2; 
+    *N_offset = I_cqi_pmi; 
   } else if (I_cqi_pmi <= 6) {
-    N_p = 5; 
-    N_offset = I_cqi_pmi - 2;     
+    *N_p = 5; 
+    *N_offset = I_cqi_pmi - 2;     
   } else if (I_cqi_pmi <= 16) {
-    N_p = 10; 
-    N_offset = I_cqi_pmi - 7;     
+    *N_p = 10; 
+    *N_offset = I_cqi_pmi - 7;     
   } else if (I_cqi_pmi <= 36) {
-    N_p = 20; 
-    N_offset = I_cqi_pmi - 17;     
+    *N_p = 20; 
+    *N_offset = I_cqi_pmi - 17;     
   } else if (I_cqi_pmi <= 76) {
-    N_p = 40; 
-    N_offset = I_cqi_pmi - 37;     
+    *N_p = 40; 
+    *N_offset = I_cqi_pmi - 37;     
   } else if (I_cqi_pmi <= 156) {
-    N_p = 80; 
-    N_offset = I_cqi_pmi - 77;     
+    *N_p = 80; 
+    *N_offset = I_cqi_pmi - 77;     
   } else if (I_cqi_pmi <= 316) {
-    N_p = 160; 
-    N_offset = I_cqi_pmi - 157;   
+    *N_p = 160; 
+    *N_offset = I_cqi_pmi - 157;   
   } else if (I_cqi_pmi == 317) {
     return false; 
   } else if (I_cqi_pmi <= 349) {
-    N_p = 32; 
-    N_offset = I_cqi_pmi - 318;     
+    *N_p = 32; 
+    *N_offset = I_cqi_pmi - 318;     
   } else if (I_cqi_pmi <= 413) {
-    N_p = 64; 
-    N_offset = I_cqi_pmi - 350;     
+    *N_p = 64; 
+    *N_offset = I_cqi_pmi - 350;     
   } else if (I_cqi_pmi <= 541) {
-    N_p = 128; 
-    N_offset = I_cqi_pmi - 414;     
-  } else if (I_cqi_pmi <= 1023) {
+    *N_p = 128; 
+    *N_offset = I_cqi_pmi - 414;     
+  } else {
     return false; 
   }
-  if (N_p) {
+  return true; 
+}
+
+bool srslte_cqi_send(uint32_t I_cqi_pmi, uint32_t tti) {
+  
+  uint32_t N_p = 0;
+  uint32_t N_offset = 0;
+  
+  if (cqi_get_N(I_cqi_pmi, &N_p, &N_offset)) {
     if ((tti-N_offset)%N_p == 0) {
       return true; 
     } 
@@ -207,6 +275,23 @@ bool srslte_cqi_send(uint32_t I_cqi_pmi, uint32_t tti) {
   return false; 
 }
 
+/* The RI is reported every M_RI CQI/PMI periods with an offset N_offset,RI relative to the CQI/PMI 
+ * offset, 36.213 Section 7.2.2 and Table 7.2.2-1B */
+bool srslte_ri_send(uint32_t I_cqi_pmi, uint32_t I_ri, uint32_t tti) {
+  
+  uint32_t N_p = 0;
+  uint32_t N_offset = 0;
+  
+  if (I_ri <= 965 && cqi_get_N(I_cqi_pmi, &N_p, &N_offset)) {
+    uint32_t M_ri = 1<<(I_ri/161); 
+    uint32_t N_offset_ri = I_ri%161; 
+    if ((tti+N_p*M_ri+N_offset_ri-N_offset)%(N_p*M_ri) == 0) {
+      return true; 
+    }
+  }
+  return false; 
+}
+
 
 // CQI-to-Spectral Efficiency:  36.213 Table 7.2.3-1  */
 static float cqi_to_coderate[16] = {0, 0.1523, 0.2344, 0.3770, 0.6016, 0.8770, 1.1758, 1.4766, 1.9141, 2.4063, 2.7305, 3.3223, 3.9023, 4.5234, 5.1152, 5.5547}; 
@@ -114,6 +114,11 @@ int srslte_pdcch_init_multi(srslte_pdcch_t *q, srslte_regs_t *regs, srslte_cell_
     if (!q->llr) {
       goto clean;
     }
+
+    q->rm_f_batch = srslte_vec_malloc(sizeof(float) * SRSLTE_VITERBI_MAX_BATCH * 3 * (SRSLTE_DCI_MAX_BITS + 16));
+    if (!q->rm_f_batch) {
+      goto clean;
+    }
     
     bzero(q->llr, sizeof(float) * q->max_bits);
 
@@ -158,6 +163,9 @@ void srslte_pdcch_free(srslte_pdcch_t *q) {
   if (q->llr) {
     free(q->llr);
   }
+  if (q->rm_f_batch) {
+    free(q->rm_f_batch);
+  }
   if (q->d) {
     free(q->d);
   }
@@ -285,6 +293,24 @@ uint32_t srslte_pdcch_common_locations_ncce(uint32_t nof_cce, srslte_dci_locatio
 
 
 
+/* Returns XOR between the received parity bits and the CRC of the decoded message */
+static uint16_t dci_crc_rem(srslte_pdcch_t *q, uint8_t *data, uint32_t nof_bits) {
+  uint8_t *x = &data[nof_bits];
+  uint16_t p_bits = (uint16_t) srslte_bit_pack(&x, 16);
+  uint16_t crc_res = ((uint16_t) srslte_crc_checksum(&q->crc, data, nof_bits) & 0xffff);
+  return p_bits ^ crc_res;
+}
+
+static void dci_set_format(srslte_dci_msg_t *msg, srslte_dci_format_t format, uint32_t nof_bits) {
+  msg->nof_bits = nof_bits;
+  // Check format differentiation 
+  if (format == SRSLTE_DCI_FORMAT0 || format == SRSLTE_DCI_FORMAT1A) {
+    msg->format = (msg->data[0] == 0)?SRSLTE_DCI_FORMAT0:SRSLTE_DCI_FORMAT1A;
+  } else {
+    msg->format   = format; 
+  }
+}
+
 /** 36.212 5.3.3.2 to 5.3.3.4
  *
  * Returns XOR between parity and remainder bits
@@ -293,9 +319,6 @@ uint32_t srslte_pdcch_common_locations_ncce(uint32_t nof_cce, srslte_dci_locatio
  */
 int srslte_pdcch_dci_decode(srslte_pdcch_t *q, float *e, uint8_t *data, uint32_t E, uint32_t nof_bits, uint16_t *crc) {
 
-  uint16_t p_bits, crc_res;
-  uint8_t *x;
-
   if (q           != NULL) {
     if (data      != NULL         &&
         E         <= q->max_bits   && 
@@ -311,12 +334,8 @@ int srslte_pdcch_dci_decode(srslte_pdcch_t *q, float *e, uint8_t *data, uint32_t
       /* viterbi decoder */
       srslte_viterbi_decode_f(&q->decoder, q->rm_f, data, nof_bits + 16);
 
-      x = &data[nof_bits];
-      p_bits = (uint16_t) srslte_bit_pack(&x, 16);
-      crc_res = ((uint16_t) srslte_crc_checksum(&q->crc, data, nof_bits) & 0xffff);
-      
       if (crc) {
-        *crc = p_bits ^ crc_res; 
+        *crc = dci_crc_rem(q, data, nof_bits); 
       }
           
       return SRSLTE_SUCCESS;
@@ -364,13 +383,7 @@ int srslte_pdcch_decode_msg(srslte_pdcch_t *q,
         ret = srslte_pdcch_dci_decode(q, &q->llr[location->ncce * 72], 
                         msg->data, e_bits, nof_bits, crc_rem);
         if (ret == SRSLTE_SUCCESS) {
-          msg->nof_bits = nof_bits;
-          // Check format differentiation 
-          if (format == SRSLTE_DCI_FORMAT0 || format == SRSLTE_DCI_FORMAT1A) {
-            msg->format = (msg->data[0] == 0)?SRSLTE_DCI_FORMAT0:SRSLTE_DCI_FORMAT1A;
-          } else {
-            msg->format   = format; 
-          }
+          dci_set_format(msg, format, nof_bits);
         } else {
           fprintf(stderr, "Error calling pdcch_dci_decode\n");
         }
@@ -389,6 +402,84 @@ int srslte_pdcch_decode_msg(srslte_pdcch_t *q,
   return ret;
 }
 
+/** Tries to decode a DCI message of the given format in each of the locations. All the candidates 
+ * are unrate-matched and then decoded together by the batched Viterbi decoder. msg[i] and crc_rem[i] 
+ * hold the result for locations[i]. 
+ */
+int srslte_pdcch_decode_msg_batch(srslte_pdcch_t *q, 
+                                  srslte_dci_msg_t *msg, 
+                                  srslte_dci_location_t *locations, 
+                                  uint32_t nof_locations, 
+                                  srslte_dci_format_t format, 
+                                  uint16_t *crc_rem) 
+{
+  float *rm[SRSLTE_VITERBI_MAX_BATCH];
+  uint8_t *data[SRSLTE_VITERBI_MAX_BATCH];
+  bool valid[SRSLTE_VITERBI_MAX_BATCH];
+  uint32_t idx[SRSLTE_VITERBI_MAX_BATCH];
+
+  if (q       == NULL || 
+      msg     == NULL || 
+      crc_rem == NULL) 
+  {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t nof_bits = srslte_dci_format_sizeof(format, q->cell.nof_prb, q->cell.nof_ports);
+  uint32_t coded_len = 3 * (nof_bits + 16); 
+
+  uint32_t i = 0;
+  while (i < nof_locations) {
+    uint32_t n = 0;
+    while (i < nof_locations && n < SRSLTE_VITERBI_MAX_BATCH) {
+      srslte_dci_location_t *location = &locations[i];
+      if (!srslte_dci_location_isvalid(location) || 
+          location->ncce * 72 + PDCCH_FORMAT_NOF_BITS(location->L) > q->nof_cce*72) 
+      {
+        fprintf(stderr, "Invalid location: nCCE: %d, L: %d, NofCCE: %d\n", 
+          location->ncce, location->L, q->nof_cce);
+        return SRSLTE_ERROR_INVALID_INPUTS;
+      }
+      uint32_t e_bits = PDCCH_FORMAT_NOF_BITS(location->L);
+      float *e = &q->llr[location->ncce * 72];
+
+      crc_rem[i] = 0;
+      double mean = 0; 
+      for (int j=0;j<e_bits;j++) {
+        mean += fabsf(e[j]);
+      }
+      mean /= e_bits; 
+      if (mean > 0.5) {
+        rm[n] = &q->rm_f_batch[n * 3 * (SRSLTE_DCI_MAX_BITS + 16)];
+        bzero(rm[n], sizeof(float) * coded_len);
+        srslte_rm_conv_rx(e, e_bits, rm[n], coded_len);
+        data[n] = msg[i].data;
+        idx[n] = i;
+        n++;
+      } else {
+        DEBUG("Skipping DCI:  nCCE=%d, L=%d, msg_len=%d, mean=%f\n",
+              location->ncce, location->L, nof_bits, mean);        
+      }
+      i++;
+    }
+    if (n > 0) {
+      if (srslte_viterbi_decode_f_batch(&q->decoder, rm, data, valid, n, nof_bits + 16) < 0) {
+        return SRSLTE_ERROR;
+      }
+      for (uint32_t j = 0; j < n; j++) {
+        if (valid[j]) {
+          crc_rem[idx[j]] = dci_crc_rem(q, data[j], nof_bits);
+          dci_set_format(&msg[idx[j]], format, nof_bits);
+        }
+        DEBUG("Decoded DCI: nCCE=%d, L=%d, format=%s, msg_len=%d, valid=%d, crc_rem=0x%x\n", 
+              locations[idx[j]].ncce, locations[idx[j]].L, srslte_dci_format_string(format), 
+              nof_bits, valid[j], crc_rem[idx[j]]);
+      }
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 int cnt=0;
 
 int srslte_pdcch_extract_llr(srslte_pdcch_t *q, cf_t *sf_symbols, cf_t *ce[SRSLTE_MAX_PORTS], float noise_estimate, 
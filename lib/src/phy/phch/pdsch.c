@@ -45,6 +45,9 @@
 
 #define MAX_PDSCH_RE(cp) (2 * SRSLTE_CP_NSYMB(cp) * 12)
 
+/* Maximum number of layers of one codeword, 36.211 Table 6.3.3.2-1 */
+#define PDSCH_MAX_CW_LAYERS(nof_ports) ((nof_ports)>2?2:1)
+
 
 
 const static srslte_mod_t modulations[4] =
@@ -177,6 +180,174 @@ int srslte_pdsch_cp(srslte_pdsch_t *q, cf_t *input, cf_t *output, srslte_ra_dl_g
   return r; 
 }
 
+static uint32_t pdsch_sf_type(uint32_t nsubframe) 
+{
+  return nsubframe == 0?0:(nsubframe == 5?1:2);
+}
+
+static uint8_t *pdsch_re_map(srslte_pdsch_t *q, uint32_t lstart, uint32_t nsubframe) 
+{
+  uint32_t map_len = 2*SRSLTE_CP_NSYMB(q->cell.cp)*q->cell.nof_prb;
+  return &q->re_map[(lstart*SRSLTE_PDSCH_NOF_SF_TYPES + pdsch_sf_type(nsubframe))*map_len];
+}
+
+/* Subcarriers of PRB n in symbol l of slot s carrying PDSCH, following the same rules as srslte_pdsch_cp() */
+static uint16_t pdsch_re_mask(srslte_pdsch_t *q, uint32_t s, uint32_t l, uint32_t n, uint32_t lstart_grant, uint32_t nsubframe) 
+{
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  uint32_t lstart = s == 0?lstart_grant:0;
+  uint32_t lend = nsymb; 
+  bool is_pbch = false, is_sss = false; 
+  bool is_center = n >= q->cell.nof_prb / 2 - 3 && n < q->cell.nof_prb / 2 + 3 + (q->cell.nof_prb%2);
+  
+  if (s == 0 && (nsubframe == 0 || nsubframe == 5) && is_center) {
+    lend = nsymb - 2;
+    is_sss = true; 
+  }
+  if (s == 1 && nsubframe == 0 && is_center) {
+    lstart = 4; 
+    is_pbch = true; 
+  }
+  
+  uint16_t refs = 0; 
+  if (SRSLTE_SYMBOL_HAS_REF(l, q->cell.cp, q->cell.nof_ports)) {
+    uint32_t nof_refs = q->cell.nof_ports == 1?2:4;
+    uint32_t offset; 
+    if (nof_refs == 2) {
+      offset = l == 0?q->cell.id % 6:(q->cell.id + 3) % 6;
+    } else {
+      offset = q->cell.id % 3;
+    }
+    for (uint32_t k=0;k<nof_refs;k++) {
+      refs |= 1<<(offset + k*SRSLTE_NRE/nof_refs);
+    }
+  }
+  
+  uint16_t mask = 0; 
+  if (l >= lstart && l < lend) {
+    mask = 0xfff; 
+  } else if ((q->cell.nof_prb % 2) && ((is_pbch && l < lstart) || (is_sss && l >= lend))) {
+    // With an odd number of PRB, half of the edge PRBs of the PBCH and SS carry PDSCH 
+    if (n == q->cell.nof_prb / 2 - 3) {
+      mask = 0x03f; 
+    } else if (n == q->cell.nof_prb / 2 + 3) {
+      mask = 0xfc0; 
+    }
+  }
+  return mask & ~refs; 
+}
+
+static int pdsch_re_pattern(srslte_pdsch_t *q, uint16_t mask) 
+{
+  for (uint32_t i=0;i<q->nof_re_patterns;i++) {
+    if (q->re_patterns[i].mask == mask) {
+      return i; 
+    }
+  }
+  if (q->nof_re_patterns == SRSLTE_PDSCH_MAX_RE_PATTERNS) {
+    return SRSLTE_ERROR; 
+  }
+  srslte_pdsch_re_pattern_t *p = &q->re_patterns[q->nof_re_patterns];
+  bzero(p, sizeof(srslte_pdsch_re_pattern_t));
+  p->mask = mask; 
+  for (uint32_t k=0;k<SRSLTE_NRE;k++) {
+    if (mask & (1<<k)) {
+      if (k == 0 || !(mask & (1<<(k-1)))) {
+        p->start[p->nof_spans++] = k; 
+      }
+      p->len[p->nof_spans-1]++;
+    }
+  }
+  return q->nof_re_patterns++; 
+}
+
+static int pdsch_re_map_init(srslte_pdsch_t *q) 
+{
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  uint32_t map_len = 2*nsymb*q->cell.nof_prb;
+  const uint32_t sf_types[SRSLTE_PDSCH_NOF_SF_TYPES] = {0, 5, 1};
+  
+  q->re_map = srslte_vec_malloc(sizeof(uint8_t) * map_len * SRSLTE_PDSCH_NOF_LSTART * SRSLTE_PDSCH_NOF_SF_TYPES);
+  if (!q->re_map) {
+    perror("malloc");
+    return SRSLTE_ERROR; 
+  }
+  for (uint32_t lstart=0;lstart<SRSLTE_PDSCH_NOF_LSTART;lstart++) {
+    for (uint32_t t=0;t<SRSLTE_PDSCH_NOF_SF_TYPES;t++) {
+      uint8_t *map = pdsch_re_map(q, lstart, sf_types[t]);
+      for (uint32_t s=0;s<2;s++) {
+        for (uint32_t l=0;l<nsymb;l++) {
+          for (uint32_t n=0;n<q->cell.nof_prb;n++) {
+            int p = pdsch_re_pattern(q, pdsch_re_mask(q, s, l, n, lstart, sf_types[t]));
+            if (p < 0) {
+              fprintf(stderr, "Too many PDSCH RE patterns\n");
+              return SRSLTE_ERROR; 
+            }
+            map[(l + s*nsymb)*q->cell.nof_prb + n] = (uint8_t) p; 
+          }
+        }
+      }
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+static inline void pdsch_cp_span(cf_t *grid, cf_t **seq, uint32_t start, uint32_t len, bool put) 
+{
+  cf_t *dst = put?&grid[start]:*seq; 
+  cf_t *src = put?*seq:&grid[start]; 
+  if (len > SRSLTE_NRE) {
+    memcpy(dst, src, sizeof(cf_t)*len);
+  } else {
+    for (uint32_t i=0;i<len;i++) {
+      dst[i] = src[i];
+    }
+  }
+  *seq += len; 
+}
+
+/* Same as srslte_pdsch_cp() using the precomputed RE map. Spans of adjacent PRBs are merged, so the 
+ * symbols without reference signals are copied with one memcpy per group of contiguous PRBs. */
+static int pdsch_cp_map(srslte_pdsch_t *q, cf_t *input, cf_t *output, srslte_ra_dl_grant_t *grant, uint32_t lstart, uint32_t nsubframe, bool put) 
+{
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  uint32_t nof_prb = q->cell.nof_prb; 
+  uint32_t prb_list[SRSLTE_MAX_PRB];
+  uint8_t *map = pdsch_re_map(q, lstart, nsubframe);
+  cf_t *seq = put?input:output; 
+  
+  for (uint32_t s=0;s<2;s++) {
+    uint32_t nof_alloc = 0; 
+    for (uint32_t n=0;n<nof_prb;n++) {
+      if (grant->prb_idx[s][n]) {
+        prb_list[nof_alloc++] = n; 
+      }
+    }
+    for (uint32_t l=0;l<nsymb && nof_alloc;l++) {
+      uint32_t lp = l + s*nsymb; 
+      cf_t *grid = &(put?output:input)[lp*nof_prb*SRSLTE_NRE];
+      uint8_t *m = &map[lp*nof_prb];
+      uint32_t span_start = 0, span_len = 0; 
+      for (uint32_t i=0;i<nof_alloc;i++) {
+        uint32_t n = prb_list[i];
+        srslte_pdsch_re_pattern_t *p = &q->re_patterns[m[n]];
+        for (uint32_t k=0;k<p->nof_spans;k++) {
+          uint32_t start = n*SRSLTE_NRE + p->start[k];
+          if (start != span_start + span_len) {
+            pdsch_cp_span(grid, &seq, span_start, span_len, put);
+            span_start = start; 
+            span_len = 0; 
+          }
+          span_len += p->len[k];
+        }
+      }
+      pdsch_cp_span(grid, &seq, span_start, span_len, put);
+    }
+  }
+  
+  return (int) (seq - (put?input:output)); 
+}
+
 /**
  * Puts PDSCH in slot number 1
  *
@@ -187,7 +358,11 @@ int srslte_pdsch_cp(srslte_pdsch_t *q, cf_t *input, cf_t *output, srslte_ra_dl_g
 int srslte_pdsch_put(srslte_pdsch_t *q, cf_t *symbols, cf_t *sf_symbols,
     srslte_ra_dl_grant_t *grant, uint32_t lstart, uint32_t subframe) 
 {
-  return srslte_pdsch_cp(q, symbols, sf_symbols, grant, lstart, subframe, true);
+  if (lstart < SRSLTE_PDSCH_NOF_LSTART) {
+    return pdsch_cp_map(q, symbols, sf_symbols, grant, lstart, subframe, true);
+  } else {
+    return srslte_pdsch_cp(q, symbols, sf_symbols, grant, lstart, subframe, true);
+  }
 }
 
 /**
@@ -200,7 +375,11 @@ int srslte_pdsch_put(srslte_pdsch_t *q, cf_t *symbols, cf_t *sf_symbols,
 int srslte_pdsch_get(srslte_pdsch_t *q, cf_t *sf_symbols, cf_t *symbols,
     srslte_ra_dl_grant_t *grant, uint32_t lstart, uint32_t subframe) 
 {
-  return srslte_pdsch_cp(q, sf_symbols, symbols, grant, lstart, subframe, false);
+  if (lstart < SRSLTE_PDSCH_NOF_LSTART) {
+    return pdsch_cp_map(q, sf_symbols, symbols, grant, lstart, subframe, false);
+  } else {
+    return srslte_pdsch_cp(q, sf_symbols, symbols, grant, lstart, subframe, false);
+  }
 }
 
 int srslte_pdsch_init(srslte_pdsch_t *q, srslte_cell_t cell) 
@@ -238,15 +417,21 @@ int srslte_pdsch_init_multi(srslte_pdsch_t *q, srslte_cell_t cell, uint32_t nof_
     
     srslte_sch_init(&q->dl_sch);
     
-    // Allocate int16_t for reception (LLRs)
-    q->e = srslte_vec_malloc(sizeof(int16_t) * q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM));
-    if (!q->e) {
-      goto clean;
-    }
-    
-    q->d = srslte_vec_malloc(sizeof(cf_t) * q->max_re);
-    if (!q->d) {
-      goto clean;
+    /* The second codeword is only used with more than one port. srslte_pdsch_cfg_mimo() maps each 
+     * codeword to at most PDSCH_MAX_CW_LAYERS(nof_ports) layers */
+    uint32_t nof_cw = q->cell.nof_ports>1?SRSLTE_MAX_CODEWORDS:1; 
+    uint32_t cw_re = q->max_re * PDSCH_MAX_CW_LAYERS(q->cell.nof_ports); 
+    for (i = 0; i < nof_cw; i++) {
+      // Allocate int16_t for reception (LLRs)
+      q->e[i] = srslte_vec_malloc(sizeof(int16_t) * cw_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM));
+      if (!q->e[i]) {
+        goto clean;
+      }
+      
+      q->d[i] = srslte_vec_malloc(sizeof(cf_t) * cw_re);
+      if (!q->d[i]) {
+        goto clean;
+      }
     }
 
     for (i = 0; i < q->cell.nof_ports; i++) {
@@ -261,17 +446,16 @@ int srslte_pdsch_init_multi(srslte_pdsch_t *q, srslte_cell_t cell, uint32_t nof_
         }
       }
     }
-    for (int j=0;j<q->nof_rx_antennas;j++) {
+    /* Used for the received symbols of each antenna and for the precoded symbols of each port */
+    for (int j=0;j<SRSLTE_MAX(q->nof_rx_antennas, q->cell.nof_ports);j++) {
       q->symbols[j] = srslte_vec_malloc(sizeof(cf_t) * q->max_re);
       if (!q->symbols[j]) {
         goto clean;
       }              
     }
     
-    q->users = calloc(sizeof(srslte_pdsch_user_t*), 1+SRSLTE_SIRNTI);
-    if (!q->users) {
-      perror("malloc");
-      goto clean;
+    if (pdsch_re_map_init(q)) {
+      goto clean; 
     }
     
     ret = SRSLTE_SUCCESS;
@@ -286,11 +470,13 @@ int srslte_pdsch_init_multi(srslte_pdsch_t *q, srslte_cell_t cell, uint32_t nof_
 void srslte_pdsch_free(srslte_pdsch_t *q) {
   int i;
 
-  if (q->e) {
-    free(q->e);
-  }
-  if (q->d) {
-    free(q->d);
+  for (i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+    if (q->e[i]) {
+      free(q->e[i]);
+    }
+    if (q->d[i]) {
+      free(q->d[i]);
+    }
   }
   for (i = 0; i < q->cell.nof_ports; i++) {
     if (q->x[i]) {
@@ -302,18 +488,13 @@ void srslte_pdsch_free(srslte_pdsch_t *q) {
       }
     }
   }
-  for (int j=0;j<q->nof_rx_antennas;j++) {
+  for (int j=0;j<SRSLTE_MAX_PORTS;j++) {
     if (q->symbols[j]) {
       free(q->symbols[j]);
     }          
   }
-  if (q->users) {
-    for (uint16_t u=0;u<SRSLTE_SIRNTI;u++) {
-      if (q->users[u]) {
-        srslte_pdsch_free_rnti(q, u);
-      }
-    }      
-    free(q->users);
+  if (q->re_map) {
+    free(q->re_map);
   }
   for (i = 0; i < 4; i++) {
     srslte_modem_table_free(&q->mod[i]);
@@ -341,6 +522,12 @@ int srslte_pdsch_cfg(srslte_pdsch_cfg_t *cfg, srslte_cell_t cell, srslte_ra_dl_g
     srslte_ra_dl_grant_to_nbits(&cfg->grant, cfi, cell, sf_idx, &cfg->nbits);
     cfg->sf_idx = sf_idx; 
     cfg->rv = rvidx;  
+    
+    /* Single antenna or transmit diversity, as given by the number of ports */
+    cfg->mimo_type = cell.nof_ports==1?SRSLTE_MIMO_TYPE_SINGLE_ANTENNA:SRSLTE_MIMO_TYPE_TX_DIVERSITY; 
+    cfg->nof_layers = cell.nof_ports; 
+    cfg->codebook_idx = 0; 
+    cfg->nof_cw = 1; 
 
     return SRSLTE_SUCCESS;   
   } else {
@@ -348,36 +535,154 @@ int srslte_pdsch_cfg(srslte_pdsch_cfg_t *cfg, srslte_cell_t cell, srslte_ra_dl_g
   }
 }
 
+static uint32_t cw_nof_layers(srslte_pdsch_cfg_t *cfg, uint32_t cw) 
+{
+  if (cfg->nof_cw == 1) {
+    return cfg->nof_layers; 
+  } else {
+    return cw==0?cfg->nof_layers/2:cfg->nof_layers-cfg->nof_layers/2; 
+  }
+}
 
-/* Precalculate the PDSCH scramble sequences for a given RNTI. This function takes a while 
- * to execute, so shall be called once the final C-RNTI has been allocated for the session.
+/* Configures spatial multiplexing (TM4) or large delay CDD (TM3) for the grant in cfg, which must have been 
+ * configured with srslte_pdsch_cfg() before. Two codewords are transmitted if the grant has two transport 
+ * blocks, in which case rvidx2 is the redundancy version of the second one. 
+ * The codeword to layer mapping must be one of 36.211 Table 6.3.3.2-1: one codeword is mapped to one 
+ * layer, or to two layers with four ports only, and two codewords to 2, 3 or 4 layers. 
  */
-int srslte_pdsch_set_rnti(srslte_pdsch_t *q, uint16_t rnti) {
-  uint32_t i;  
-  if (!q->users[rnti]) {
-    q->users[rnti] = calloc(1, sizeof(srslte_pdsch_user_t));
-    if (q->users[rnti]) {
-      for (i = 0; i < SRSLTE_NSUBFRAMES_X_FRAME; i++) {
-        if (srslte_sequence_pdsch(&q->users[rnti]->seq[i], rnti, 0, 2 * i, q->cell.id,
-            q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM))) {
-          return SRSLTE_ERROR; 
-        }
+int srslte_pdsch_cfg_mimo(srslte_pdsch_cfg_t *cfg, srslte_cell_t cell, srslte_mimo_type_t mimo_type, 
+                          uint32_t nof_layers, uint32_t codebook_idx, uint32_t rvidx2) 
+{
+  if (cfg == NULL || nof_layers < 1 || nof_layers > cell.nof_ports) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  if (mimo_type != SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX && mimo_type != SRSLTE_MIMO_TYPE_CDD) {
+    cfg->mimo_type = mimo_type; 
+    return SRSLTE_SUCCESS; 
+  }
+  uint32_t nof_cw = (cfg->grant.nof_tb > 1 && cfg->grant.mcs2.tbs > 0)?2:1; 
+  if ((nof_cw == 1 && nof_layers > PDSCH_MAX_CW_LAYERS(cell.nof_ports)) || 
+      (nof_cw == 2 && nof_layers < 2)) 
+  {
+    fprintf(stderr, "Invalid mapping of %d codewords to %d layers with %d ports\n", 
+            nof_cw, nof_layers, cell.nof_ports);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  cfg->mimo_type = mimo_type; 
+  cfg->nof_layers = nof_layers; 
+  cfg->codebook_idx = codebook_idx; 
+  cfg->nof_cw = nof_cw; 
+  cfg->rv2 = rvidx2; 
+
+  /* Each layer carries nbits.nof_re symbols */
+  cfg->nbits.nof_bits = cfg->nbits.nof_re * cw_nof_layers(cfg, 0) * cfg->grant.Qm; 
+  if (cfg->nof_cw > 1) {
+    if (srslte_cbsegm(&cfg->cb_segm2, cfg->grant.mcs2.tbs)) {
+      fprintf(stderr, "Error computing Codeblock segmentation for TBS=%d\n", cfg->grant.mcs2.tbs);
+      return SRSLTE_ERROR; 
+    }
+    cfg->nbits2 = cfg->nbits; 
+    cfg->nbits2.nof_bits = cfg->nbits.nof_re * cw_nof_layers(cfg, 1) * cfg->grant.Qm2; 
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+/* Configures the MIMO mode of cfg from the precoding information of a DCI format 2 (closed-loop spatial 
+ * multiplexing, TM4) or format 2A (large delay CDD, TM3) grant, 36.212 Tables 5.3.3.1.5-4, 5.3.3.1.5-5 
+ * and 5.3.3.1.5A-2. pmi is the codebook index of the last PMI report, which is used when the DCI refers 
+ * to it. The other formats keep the configuration of srslte_pdsch_cfg(). 
+ */
+int srslte_pdsch_cfg_mimo_dci(srslte_pdsch_cfg_t *cfg, srslte_cell_t cell, srslte_dci_format_t format, 
+                              srslte_ra_dl_dci_t *dci, uint32_t pmi) 
+{
+  srslte_mimo_type_t type = SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX; 
+  uint32_t nof_layers = 0; 
+  uint32_t cb = 0; 
+  uint32_t pinfo; 
+  
+  if (cfg == NULL || dci == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  if ((format != SRSLTE_DCI_FORMAT2 && format != SRSLTE_DCI_FORMAT2A) || cell.nof_ports < 2) {
+    return SRSLTE_SUCCESS; 
+  }
+  if (!dci->tb_en[0] || (dci->tb_en[1] && dci->tb_cw_swap)) {
+    fprintf(stderr, "Only transport block 1 on codeword 0 is supported\n");
+    return SRSLTE_ERROR; 
+  }
+  bool two_cw = dci->tb_en[1]; 
+  pinfo = dci->pinfo; 
+  
+  if (format == SRSLTE_DCI_FORMAT2A) {
+    type = SRSLTE_MIMO_TYPE_CDD; 
+    if (!two_cw) {
+      /* Transmit diversity, or 2 layers CDD with 4 ports and pinfo=1 */
+      nof_layers = (cell.nof_ports == 4 && pinfo == 1)?2:0; 
+    } else if (cell.nof_ports == 2) {
+      nof_layers = 2; 
+    } else if (pinfo < 3) {
+      nof_layers = pinfo + 2; 
+    } else {
+      fprintf(stderr, "Reserved precoding information %d in Format2A\n", pinfo);
+      return SRSLTE_ERROR; 
+    }
+  } else if (cell.nof_ports == 2) {
+    if (!two_cw) {
+      /* 0 is transmit diversity, 1-4 the 1 layer TPMI and 5-6 the last PMI report */
+      if (pinfo >= 1 && pinfo <= 4) {
+        nof_layers = 1; 
+        cb = pinfo - 1; 
+      } else if (pinfo == 5 || pinfo == 6) {
+        nof_layers = 1; 
+        cb = pmi; 
+      } else if (pinfo != 0) {
+        fprintf(stderr, "Reserved precoding information %d in Format2\n", pinfo);
+        return SRSLTE_ERROR; 
+      }
+    } else {
+      /* Codebook index 0 of 2 layers is used by open-loop multiplexing only */
+      if (pinfo < 2) {
+        cb = pinfo + 1; 
+      } else if (pinfo == 2) {
+        cb = pmi; 
+      } else {
+        fprintf(stderr, "Reserved precoding information %d in Format2\n", pinfo);
+        return SRSLTE_ERROR; 
       }
-      q->users[rnti]->sequence_generated = true;
+      nof_layers = 2; 
     }
+  } else {
+    /* 4 ports: blocks of 16 TPMI followed by one entry for the last PMI report per number of layers */
+    uint32_t first_layers = two_cw?2:1; 
+    if (!two_cw && pinfo == 0) {
+      nof_layers = 0; 
+    } else {
+      uint32_t i = two_cw?pinfo:pinfo-1; 
+      if (i >= 17*(two_cw?3:2)) {
+        fprintf(stderr, "Reserved precoding information %d in Format2\n", pinfo);
+        return SRSLTE_ERROR; 
+      }
+      nof_layers = first_layers + i/17; 
+      cb = i%17 < 16?i%17:pmi; 
+    }
+  }
+  
+  if (nof_layers == 0) {
+    return srslte_pdsch_cfg_mimo(cfg, cell, SRSLTE_MIMO_TYPE_TX_DIVERSITY, cell.nof_ports, 0, 0); 
   }
+  return srslte_pdsch_cfg_mimo(cfg, cell, type, nof_layers, cb, dci->rv_idx_1); 
+}
+
+
+/* The PDSCH scrambling sequence is generated on the fly from the RNTI, so there is nothing to 
+ * precompute and an RNTI costs no memory. Kept for API compatibility. 
+ */
+int srslte_pdsch_set_rnti(srslte_pdsch_t *q, uint16_t rnti) {
   return SRSLTE_SUCCESS;
 }
 
 void srslte_pdsch_free_rnti(srslte_pdsch_t* q, uint16_t rnti)
 {
-  if (q->users[rnti]) {
-    for (int i = 0; i < SRSLTE_NSUBFRAMES_X_FRAME; i++) {
-      srslte_sequence_free(&q->users[rnti]->seq[i]);
-    }
-    free(q->users[rnti]);
-    q->users[rnti] = NULL; 
-  }
 }
 
 int srslte_pdsch_decode(srslte_pdsch_t *q, 
@@ -402,6 +707,25 @@ int srslte_pdsch_decode_multi(srslte_pdsch_t *q,
                               cf_t *sf_symbols[SRSLTE_MAX_PORTS], cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], float noise_estimate, 
                               uint16_t rnti, uint8_t *data) 
 {
+  srslte_softbuffer_rx_t *softbuffers[SRSLTE_MAX_CODEWORDS] = {softbuffer, NULL}; 
+  uint8_t *_data[SRSLTE_MAX_CODEWORDS] = {data, NULL}; 
+  bool acks[SRSLTE_MAX_CODEWORDS]; 
+  
+  if (cfg != NULL && cfg->nof_cw > 1) {
+    fprintf(stderr, "Use srslte_pdsch_decode_multi_cw() to decode two codewords\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  return srslte_pdsch_decode_multi_cw(q, cfg, softbuffers, sf_symbols, ce, noise_estimate, rnti, _data, acks);
+}
+
+/** Decodes the PDSCH codewords from the received symbols. Returns SRSLTE_SUCCESS if all of them 
+ * were decoded correctly and the result of each codeword in acks 
+ */
+int srslte_pdsch_decode_multi_cw(srslte_pdsch_t *q, 
+                                 srslte_pdsch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                                 cf_t *sf_symbols[SRSLTE_MAX_PORTS], cf_t *ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS], float noise_estimate, 
+                                 uint16_t rnti, uint8_t *data[SRSLTE_MAX_CODEWORDS], bool acks[SRSLTE_MAX_CODEWORDS]) 
+{
 
   /* Set pointers for layermapping & precoding */
   uint32_t i, n;
@@ -410,13 +734,22 @@ int srslte_pdsch_decode_multi(srslte_pdsch_t *q,
   if (q            != NULL &&
       sf_symbols   != NULL &&
       data         != NULL && 
-      cfg          != NULL)
+      acks         != NULL && 
+      cfg          != NULL && 
+      cfg->nof_cw  >= 1    && 
+      cfg->nof_cw  <= SRSLTE_MAX_CODEWORDS)
   {
     
     INFO("Decoding PDSCH SF: %d, RNTI: 0x%x, Mod %s, TBS: %d, NofSymbols: %d, NofBitsE: %d, rv_idx: %d, C_prb=%d\n",
         cfg->sf_idx, rnti, srslte_mod_string(cfg->grant.mcs.mod), cfg->grant.mcs.tbs, cfg->nbits.nof_re, 
          cfg->nbits.nof_bits, cfg->rv, cfg->grant.nof_prb);
 
+    for (i = 0; i < cfg->nof_cw; i++) {
+      if (data[i] == NULL || softbuffers[i] == NULL || q->e[i] == NULL) {
+        return SRSLTE_ERROR_INVALID_INPUTS;
+      }
+    }
+
     /* number of layers equals number of ports */
     for (i = 0; i < q->cell.nof_ports; i++) {
       x[i] = q->x[i];
@@ -441,13 +774,24 @@ int srslte_pdsch_decode_multi(srslte_pdsch_t *q,
       }      
     }
     
-    /* TODO: only diversity is supported */
-    if (q->cell.nof_ports == 1) {
+    if (q->ri_pmi_enabled && q->cell.nof_ports > 1) {
+      srslte_precoding_ri_pmi_select(q->ce, q->nof_rx_antennas, q->cell.nof_ports, q->max_ri, cfg->nbits.nof_re, 
+                                     noise_estimate, &q->last_ri, &q->last_pmi, NULL);
+    }
+    
+    if (cfg->mimo_type == SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX || cfg->mimo_type == SRSLTE_MIMO_TYPE_CDD) {
+      int nof_symbols[SRSLTE_MAX_CODEWORDS]; 
+      if (srslte_predecoding_type_multi(q->symbols, q->ce, x, q->nof_rx_antennas, q->cell.nof_ports, cfg->nof_layers, 
+                                        cfg->codebook_idx, cfg->nbits.nof_re, cfg->mimo_type, noise_estimate) < 0) {
+        return SRSLTE_ERROR;
+      }
+      srslte_layerdemap_type(x, q->d, cfg->nof_layers, cfg->nof_cw, cfg->nbits.nof_re, nof_symbols, cfg->mimo_type);
+    } else if (q->cell.nof_ports == 1) {
       /* no need for layer demapping */
-      srslte_predecoding_single_multi(q->symbols, q->ce[0], q->d, q->nof_rx_antennas, cfg->nbits.nof_re, noise_estimate);
+      srslte_predecoding_single_multi(q->symbols, q->ce[0], q->d[0], q->nof_rx_antennas, cfg->nbits.nof_re, noise_estimate);
     } else {
       srslte_predecoding_diversity_multi(q->symbols, q->ce, x, q->nof_rx_antennas, q->cell.nof_ports, cfg->nbits.nof_re);
-      srslte_layerdemap_diversity(x, q->d, q->cell.nof_ports, cfg->nbits.nof_re / q->cell.nof_ports);
+      srslte_layerdemap_diversity(x, q->d[0], q->cell.nof_ports, cfg->nbits.nof_re / q->cell.nof_ports);
     }
     
     if (SRSLTE_VERBOSE_ISDEBUG()) {
@@ -459,33 +803,36 @@ int srslte_pdsch_decode_multi(srslte_pdsch_t *q,
         srslte_vec_save_file("hest1.dat", ce[1][0], SRSLTE_SF_LEN_RE(q->cell.nof_prb, q->cell.cp)*sizeof(cf_t));
       }
       DEBUG("SAVED FILE pdsch_symbols.dat: symbols after equalization\n",0);
-      srslte_vec_save_file("pdsch_symbols.dat", q->d, cfg->nbits.nof_re*sizeof(cf_t));
+      srslte_vec_save_file("pdsch_symbols.dat", q->d[0], cfg->nbits.nof_re*sizeof(cf_t));
     }
     
-    /* demodulate symbols 
-    * The MAX-log-MAP algorithm used in turbo decoding is unsensitive to SNR estimation, 
-    * thus we don't need tot set it in the LLRs normalization
-    */
-    srslte_demod_soft_demodulate_s(cfg->grant.mcs.mod, q->d, q->e, cfg->nbits.nof_re);
-    
-    /* descramble */
-    if (q->users[rnti] && q->users[rnti]->sequence_generated) {
-      srslte_scrambling_s_offset(&q->users[rnti]->seq[cfg->sf_idx], q->e, 0, cfg->nbits.nof_bits);
-    } else {
-      srslte_sequence_t seq;
-      if (srslte_sequence_pdsch(&seq, rnti, 0, 2 * cfg->sf_idx, q->cell.id, cfg->nbits.nof_bits)) {
-        return SRSLTE_ERROR;
+    int ret = SRSLTE_SUCCESS; 
+    for (i = 0; i < cfg->nof_cw; i++) {
+      srslte_mod_t mod = i==0?cfg->grant.mcs.mod:cfg->grant.mcs2.mod; 
+      srslte_ra_nbits_t *nbits = i==0?&cfg->nbits:&cfg->nbits2; 
+      
+      /* demodulate symbols 
+      * The MAX-log-MAP algorithm used in turbo decoding is unsensitive to SNR estimation, 
+      * thus we don't need tot set it in the LLRs normalization
+      */
+      srslte_demod_soft_demodulate_s(mod, q->d[i], q->e[i], nbits->nof_bits/srslte_mod_bits_x_symbol(mod));
+      
+      /* descramble */
+      srslte_scrambling_s_seed(srslte_sequence_pdsch_seed(rnti, i, 2 * cfg->sf_idx, q->cell.id), 
+                               q->e[i], nbits->nof_bits);
+
+      if (SRSLTE_VERBOSE_ISDEBUG() && i == 0) {
+        DEBUG("SAVED FILE llr.dat: LLR estimates after demodulation and descrambling\n",0);
+        srslte_vec_save_file("llr.dat", q->e[0], nbits->nof_bits*sizeof(int16_t));
       }
-      srslte_scrambling_s_offset(&seq, q->e, 0, cfg->nbits.nof_bits);
-      srslte_sequence_free(&seq);
-    }
 
-    if (SRSLTE_VERBOSE_ISDEBUG()) {
-      DEBUG("SAVED FILE llr.dat: LLR estimates after demodulation and descrambling\n",0);
-      srslte_vec_save_file("llr.dat", q->e, cfg->nbits.nof_bits*sizeof(int16_t));
+      int r = srslte_dlsch_decode_cw(&q->dl_sch, cfg, softbuffers[i], q->e[i], data[i], i);
+      acks[i] = r == SRSLTE_SUCCESS; 
+      if (r != SRSLTE_SUCCESS) {
+        ret = r; 
+      }
     }
-
-    return srslte_dlsch_decode(&q->dl_sch, cfg, softbuffer, q->e, data);      
+    return ret; 
     
   } else {
     return SRSLTE_ERROR_INVALID_INPUTS;
@@ -496,6 +843,57 @@ int srslte_pdsch_encode(srslte_pdsch_t *q,
                         srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffer,
                         uint8_t *data, uint16_t rnti, cf_t *sf_symbols[SRSLTE_MAX_PORTS]) 
 {
+  srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS] = {softbuffer, NULL}; 
+  uint8_t *_data[SRSLTE_MAX_CODEWORDS] = {data, NULL}; 
+  
+  if (cfg != NULL && cfg->nof_cw > 1) {
+    fprintf(stderr, "Use srslte_pdsch_encode_multi() to encode two codewords\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  return srslte_pdsch_encode_multi(q, cfg, softbuffers, _data, rnti, sf_symbols);
+}
+
+int srslte_pdsch_encode_multi(srslte_pdsch_t *q, 
+                              srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                              uint8_t *data[SRSLTE_MAX_CODEWORDS], uint16_t rnti, cf_t *sf_symbols[SRSLTE_MAX_PORTS]) 
+{
+  srslte_tb_iov_t  tb[SRSLTE_MAX_CODEWORDS];
+  srslte_tb_iov_t *_tb[SRSLTE_MAX_CODEWORDS] = {NULL, NULL}; 
+  
+  if (q == NULL || cfg == NULL || data == NULL || cfg->nof_cw > SRSLTE_MAX_CODEWORDS) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  for (int i=0;i<cfg->nof_cw;i++) {
+    if (data[i] != NULL) {
+      uint32_t tbs = i==0?cfg->cb_segm.tbs:cfg->cb_segm2.tbs; 
+      srslte_tb_iov_reset(&tb[i]);
+      srslte_tb_iov_add(&tb[i], data[i], tbs/8);
+      _tb[i] = &tb[i];
+    }
+  }
+  return srslte_pdsch_encode_iov_multi(q, cfg, softbuffers, _tb, rnti, sf_symbols);
+}
+
+/* Same as srslte_pdsch_encode() with the transport block given as a list of segments, which 
+ * are gathered by the encoder */
+int srslte_pdsch_encode_iov(srslte_pdsch_t *q, 
+                            srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffer,
+                            srslte_tb_iov_t *tb, uint16_t rnti, cf_t *sf_symbols[SRSLTE_MAX_PORTS]) 
+{
+  srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS] = {softbuffer, NULL}; 
+  srslte_tb_iov_t *_tb[SRSLTE_MAX_CODEWORDS] = {tb, NULL}; 
+  
+  if (cfg != NULL && cfg->nof_cw > 1) {
+    fprintf(stderr, "Use srslte_pdsch_encode_iov_multi() to encode two codewords\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  return srslte_pdsch_encode_iov_multi(q, cfg, softbuffers, _tb, rnti, sf_symbols);
+}
+
+int srslte_pdsch_encode_iov_multi(srslte_pdsch_t *q, 
+                                  srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffers[SRSLTE_MAX_CODEWORDS],
+                                  srslte_tb_iov_t *tb[SRSLTE_MAX_CODEWORDS], uint16_t rnti, cf_t *sf_symbols[SRSLTE_MAX_PORTS]) 
+{
   
   int i;
   /* Set pointers for layermapping & precoding */
@@ -503,7 +901,9 @@ int srslte_pdsch_encode(srslte_pdsch_t *q,
   int ret = SRSLTE_ERROR_INVALID_INPUTS; 
    
    if (q             != NULL &&
-       cfg  != NULL)
+       cfg  != NULL && 
+       cfg->nof_cw >= 1 && 
+       cfg->nof_cw <= SRSLTE_MAX_CODEWORDS)
   {
 
     for (i=0;i<q->cell.nof_ports;i++) {
@@ -511,6 +911,11 @@ int srslte_pdsch_encode(srslte_pdsch_t *q,
         return SRSLTE_ERROR_INVALID_INPUTS;
       }
     }
+    for (i=0;i<cfg->nof_cw;i++) {
+      if (tb[i] == NULL || softbuffers[i] == NULL || q->e[i] == NULL) {
+        return SRSLTE_ERROR_INVALID_INPUTS;
+      }
+    }
     
     if (cfg->grant.mcs.tbs == 0) {
       return SRSLTE_ERROR_INVALID_INPUTS;      
@@ -533,32 +938,36 @@ int srslte_pdsch_encode(srslte_pdsch_t *q,
     }
     memset(&x[q->cell.nof_ports], 0, sizeof(cf_t*) * (SRSLTE_MAX_LAYERS - q->cell.nof_ports));
 
-    if (srslte_dlsch_encode(&q->dl_sch, cfg, softbuffer, data, q->e)) {
-      fprintf(stderr, "Error encoding TB\n");
-      return SRSLTE_ERROR;
-    }
-
-    /* scramble */
-    if (q->users[rnti] && q->users[rnti]->sequence_generated) {
-      srslte_scrambling_bytes(&q->users[rnti]->seq[cfg->sf_idx], (uint8_t*) q->e, cfg->nbits.nof_bits);
-    } else {
-      srslte_sequence_t seq;
-      if (srslte_sequence_pdsch(&seq, rnti, 0, 2 * cfg->sf_idx, q->cell.id, cfg->nbits.nof_bits)) {
+    int nof_symbols[SRSLTE_MAX_CODEWORDS] = {0, 0}; 
+    for (i = 0; i < cfg->nof_cw; i++) {
+      srslte_mod_t mod = i==0?cfg->grant.mcs.mod:cfg->grant.mcs2.mod; 
+      uint32_t nof_bits = i==0?cfg->nbits.nof_bits:cfg->nbits2.nof_bits; 
+      
+      if (srslte_dlsch_encode_iov(&q->dl_sch, cfg, softbuffers[i], tb[i], q->e[i], i)) {
+        fprintf(stderr, "Error encoding TB\n");
         return SRSLTE_ERROR;
       }
-      srslte_scrambling_bytes(&seq, (uint8_t*) q->e, cfg->nbits.nof_bits);
-      srslte_sequence_free(&seq);
+
+      /* scramble */
+      srslte_scrambling_bytes_seed(srslte_sequence_pdsch_seed(rnti, i, 2 * cfg->sf_idx, q->cell.id), 
+                                   (uint8_t*) q->e[i], nof_bits);
+      
+      srslte_mod_modulate_bytes(&q->mod[mod], (uint8_t*) q->e[i], q->d[i], nof_bits);
+      nof_symbols[i] = nof_bits/srslte_mod_bits_x_symbol(mod); 
     }
     
-    srslte_mod_modulate_bytes(&q->mod[cfg->grant.mcs.mod], (uint8_t*) q->e, q->d, cfg->nbits.nof_bits);
-    
-    /* TODO: only diversity supported */
-    if (q->cell.nof_ports > 1) {
-      srslte_layermap_diversity(q->d, x, q->cell.nof_ports, cfg->nbits.nof_re);
+    if (cfg->mimo_type == SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX || cfg->mimo_type == SRSLTE_MIMO_TYPE_CDD) {
+      srslte_layermap_type(q->d, x, cfg->nof_cw, cfg->nof_layers, nof_symbols, cfg->mimo_type);
+      if (srslte_precoding_type(x, q->symbols, cfg->nof_layers, q->cell.nof_ports, cfg->codebook_idx, 
+                                cfg->nbits.nof_re, cfg->mimo_type) < 0) {
+        return SRSLTE_ERROR;
+      }
+    } else if (q->cell.nof_ports > 1) {
+      srslte_layermap_diversity(q->d[0], x, q->cell.nof_ports, cfg->nbits.nof_re);
       srslte_precoding_diversity(x, q->symbols, q->cell.nof_ports,
           cfg->nbits.nof_re / q->cell.nof_ports);
     } else {
-      memcpy(q->symbols[0], q->d, cfg->nbits.nof_re * sizeof(cf_t));
+      memcpy(q->symbols[0], q->d[0], cfg->nbits.nof_re * sizeof(cf_t));
     }
 
     /* mapping to resource elements */
@@ -571,6 +980,32 @@ int srslte_pdsch_encode(srslte_pdsch_t *q,
   return ret; 
 }
 
+/* Enables the RI/PMI selection in srslte_pdsch_decode_multi() with rank up to max_ri. Only used with more 
+ * than one port. The rank is also limited by the number of receive antennas 
+ */
+void srslte_pdsch_set_ri_pmi_report(srslte_pdsch_t *q, bool enabled, uint32_t max_ri) 
+{
+  q->ri_pmi_enabled = enabled; 
+  q->max_ri = max_ri; 
+}
+
+/* Returns the rank indicator (number of layers) and precoding matrix indicator (codebook index) that 
+ * maximise the capacity of the channel of the last decoded subframe 
+ */
+int srslte_pdsch_last_ri_pmi(srslte_pdsch_t *q, uint32_t *ri, uint32_t *pmi) 
+{
+  if (q == NULL || !q->ri_pmi_enabled || q->last_ri == 0) {
+    return SRSLTE_ERROR;
+  }
+  if (ri) {
+    *ri = q->last_ri; 
+  }
+  if (pmi) {
+    *pmi = q->last_pmi; 
+  }
+  return SRSLTE_SUCCESS;
+}
+
 float srslte_pdsch_average_noi(srslte_pdsch_t *q) 
 {
   return q->dl_sch.average_nof_iterations;
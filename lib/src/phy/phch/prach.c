@@ -48,6 +48,9 @@ float save_corr[4096];
 
 #define PRACH_AMP       1.0
 
+#define PRACH_DEC_MIN_FFT     1536  // Minimum size of the FFT after decimation
+#define PRACH_DEC_TRANSITION  5.5   // Transition width times length of a Blackman FIR
+
 /******************************************************
  * Reference tables from 3GPP TS 36.211 v10.7.0
  *****************************************************/
@@ -326,6 +329,161 @@ int srslte_prach_gen_seqs(srslte_prach_t *p)
   return 0;
 }
 
+/* Designs the decimation chain of the detection front-end. The decimation factor is the largest 
+ * one leaving at least PRACH_DEC_MIN_FFT samples, split in stages of 2 first and then 3, so that 
+ * the cheapest stages run at the highest rates. Each stage only protects the PRACH band from the 
+ * aliases it folds into it, which allows very short filters in the first stages. 
+ */
+static int prach_init_frontend(srslte_prach_t *p)
+{
+  uint32_t N = p->N_ifft_prach; 
+  uint32_t D = 1; 
+  
+  p->dec_phasor_shift = (int) N; 
+  if (4 == p->f) {
+    return SRSLTE_SUCCESS; 
+  }
+  for (uint32_t d2=1;d2<=N;d2*=2) {
+    for (uint32_t d=d2;d<=N;d*=3) {
+      if ((N%d) == 0 && N/d >= PRACH_DEC_MIN_FFT && d > D) {
+        D = d; 
+      }
+    }
+  }
+  if (D == 1) {
+    return SRSLTE_SUCCESS;
+  }
+  
+  uint32_t R = N; 
+  p->dec_nof_stages = 0; 
+  for (uint32_t d=2;d<=3;d++) {
+    while ((D%d) == 0 && p->dec_nof_stages < SRSLTE_PRACH_DEC_MAX_STAGES) {
+      srslte_prach_dec_stage_t *s = &p->dec_stages[p->dec_nof_stages];
+      
+      float pass  = (float) (p->N_zc/2+1)/R; 
+      float delta = 1.0/d - 2*pass; 
+      if (delta <= 0) {
+        return SRSLTE_SUCCESS;
+      }
+      s->factor   = d; 
+      s->half_len = (uint32_t) ceilf((PRACH_DEC_TRANSITION/delta-1)/2); 
+      s->input_len = R; 
+      s->nof_taps = 0; 
+      
+      // Blackman windowed sinc with cutoff at the output Nyquist frequency and gain d
+      float h[s->half_len+1];
+      float sum = 0; 
+      for (int t=0;t<=s->half_len;t++) {
+        float x = (float) t/d; 
+        float w = 0.42 + 0.5*cos(M_PI*t/(s->half_len+1)) + 0.08*cos(2*M_PI*t/(s->half_len+1)); 
+        h[t] = (t?sin(M_PI*x)/(M_PI*x):1)*w; 
+        sum += t?2*h[t]:h[t];
+      }
+      s->center = h[0]*d/sum; 
+      for (int t=1;t<=s->half_len;t++) {
+        if (t%d) {
+          if (s->nof_taps == SRSLTE_PRACH_DEC_MAX_TAPS) {
+            return SRSLTE_SUCCESS; 
+          }
+          s->offset[s->nof_taps] = t; 
+          s->tap[s->nof_taps] = h[t]*d/sum; 
+          s->nof_taps++;
+        }
+      }
+      
+      s->input = srslte_vec_malloc(sizeof(cf_t)*(R+2*s->half_len));
+      if (!s->input) {
+        perror("malloc");
+        return SRSLTE_ERROR; 
+      }
+      p->dec_nof_stages++;
+      D /= d; 
+      R /= d; 
+    }
+  }
+  
+  p->N_dec = R; 
+  p->dec_fft_in  = srslte_vec_malloc(sizeof(cf_t)*p->N_dec);
+  p->dec_fft_out = srslte_vec_malloc(sizeof(cf_t)*p->N_dec);
+  p->dec_phasor  = srslte_vec_malloc(sizeof(cf_t)*N);
+  p->dec_fft = (srslte_dft_plan_t*)srslte_vec_malloc(sizeof(srslte_dft_plan_t));
+  if (!p->dec_fft_in || !p->dec_fft_out || !p->dec_phasor || !p->dec_fft) {
+    perror("malloc");
+    return SRSLTE_ERROR; 
+  }
+  if (srslte_dft_plan(p->dec_fft, p->N_dec, SRSLTE_DFT_FORWARD, SRSLTE_DFT_COMPLEX)) {
+    fprintf(stderr, "Error creating DFT plan\n");
+    return SRSLTE_ERROR;
+  }
+  srslte_dft_plan_set_mirror(p->dec_fft, false);
+  srslte_dft_plan_set_norm(p->dec_fft, false);
+  
+  p->dec_available = true; 
+  p->dec_enabled = true; 
+  DEBUG("PRACH front-end: N_ifft_prach=%d, N_dec=%d, nof_stages=%d\n", N, p->N_dec, p->dec_nof_stages);
+  
+  return SRSLTE_SUCCESS; 
+}
+
+static void prach_dec_pad(srslte_prach_dec_stage_t *s) 
+{
+  cf_t *x = &s->input[s->half_len];
+  memcpy(s->input, &x[s->input_len-s->half_len], sizeof(cf_t)*s->half_len);
+  memcpy(&x[s->input_len], x, sizeof(cf_t)*s->half_len);
+}
+
+static void prach_dec_stage(srslte_prach_dec_stage_t *s, cf_t *output) 
+{
+  cf_t *x = &s->input[s->half_len];
+  uint32_t out_len = s->input_len/s->factor; 
+  for (uint32_t m=0;m<out_len;m++) {
+    cf_t y = s->center*x[0]; 
+    for (uint32_t k=0;k<s->nof_taps;k++) {
+      int t = (int) s->offset[k]; 
+      y += s->tap[k]*(x[-t] + x[t]);
+    }
+    output[m] = y; 
+    x += s->factor; 
+  }
+}
+
+/* Extracts the PRACH bins with the decimating front-end. The first N_ifft_prach samples of the 
+ * signal are taken as one period, as the full size FFT does.  
+ */
+static void prach_frontend(srslte_prach_t *p, uint32_t begin, cf_t *signal) 
+{
+  uint32_t N = p->N_ifft_prach; 
+  int shift = (int) begin + p->N_zc/2 - N/2; // PRACH band center
+  
+  if (shift != p->dec_phasor_shift) {
+    for (uint32_t n=0;n<N;n++) {
+      uint32_t idx = (uint32_t) (((int64_t) shift*n%N + N)%N);
+      p->dec_phasor[n] = cexpf(-I*2*M_PI*idx/N);
+    }
+    p->dec_phasor_shift = shift; 
+  }
+  
+  srslte_prach_dec_stage_t *s = &p->dec_stages[0];
+  srslte_vec_prod_ccc(signal, p->dec_phasor, &s->input[s->half_len], N);
+  prach_dec_pad(s);
+  for (uint32_t i=0;i<p->dec_nof_stages;i++) {
+    s = &p->dec_stages[i];
+    if (i+1 < p->dec_nof_stages) {
+      srslte_prach_dec_stage_t *next = &p->dec_stages[i+1];
+      prach_dec_stage(s, &next->input[next->half_len]);
+      prach_dec_pad(next);
+    } else {
+      prach_dec_stage(s, p->dec_fft_in);
+    }
+  }
+  
+  srslte_dft_run(p->dec_fft, p->dec_fft_in, p->dec_fft_out);
+  
+  uint32_t half = p->N_zc/2; 
+  memcpy(p->prach_bins, &p->dec_fft_out[p->N_dec-half], half*sizeof(cf_t));
+  memcpy(&p->prach_bins[half], p->dec_fft_out, (p->N_zc-half)*sizeof(cf_t));
+}
+
 int srslte_prach_init_cfg(srslte_prach_t *p, srslte_prach_cfg_t *cfg, uint32_t nof_prb)
 {
   return srslte_prach_init(p, 
@@ -356,6 +514,11 @@ int srslte_prach_init(srslte_prach_t *p,
     p->hs = high_speed_flag;
     p->zczc = zero_corr_zone_config;
     p->detect_factor = PRACH_DETECT_FACTOR; 
+    p->dec_available = false;
+    p->dec_enabled = false;
+    p->dec_nof_stages = 0; 
+    p->corr_batch = false;
+    p->corr_specs = NULL;
     
     
     // Determine N_zc and N_cs
@@ -388,7 +551,6 @@ int srslte_prach_init(srslte_prach_t *p,
     
     // Set up containers
     p->prach_bins = srslte_vec_malloc(sizeof(cf_t)*p->N_zc);
-    p->corr_spec = srslte_vec_malloc(sizeof(cf_t)*p->N_zc);
     p->corr = srslte_vec_malloc(sizeof(float)*p->N_zc);
 
     // Set up ZC FFTS
@@ -415,6 +577,15 @@ int srslte_prach_init(srslte_prach_t *p,
       srslte_dft_run(p->zc_fft, p->seqs[i], p->dft_seqs[i]);
     }
     
+    // Batched IFFT of the root correlations
+    p->corr_specs = srslte_vec_malloc(sizeof(cf_t)*p->N_zc*p->N_roots);
+    if (!p->corr_specs) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    p->corr_batch = !srslte_dft_plan_batch_c(&p->corr_ifft, p->N_zc, SRSLTE_DFT_BACKWARD, p->N_roots, 
+                                             p->N_zc, p->N_zc, p->corr_specs, p->corr_specs);
+    
     // Create our FFT objects and buffers
     p->N_ifft_ul = N_ifft_ul;
     if(4 == preamble_format){
@@ -463,6 +634,10 @@ int srslte_prach_init(srslte_prach_t *p,
     p->T_seq = prach_Tseq[p->f]*SRSLTE_LTE_TS;
     p->T_tot = (prach_Tseq[p->f]+prach_Tcp[p->f])*SRSLTE_LTE_TS;
     
+    if (prach_init_frontend(p)) {
+      return SRSLTE_ERROR;
+    }
+    
     ret = SRSLTE_SUCCESS;
   } else {
     fprintf(stderr, "Invalid parameters\n");
@@ -520,6 +695,12 @@ void srslte_prach_set_detect_factor(srslte_prach_t *p, float ratio) {
   p->detect_factor = ratio; 
 }
 
+/* Enables or disables the decimating detection front-end. It is enabled by default when the 
+ * configuration allows decimating, otherwise the full N_ifft_prach FFT is always used */
+void srslte_prach_set_frontend(srslte_prach_t *p, bool enabled) {
+  p->dec_enabled = enabled && p->dec_available; 
+}
+
 int srslte_prach_detect(srslte_prach_t *p,
                         uint32_t freq_offset,
                         cf_t *signal,
@@ -551,9 +732,6 @@ int srslte_prach_detect_offset(srslte_prach_t *p,
       return SRSLTE_ERROR_INVALID_INPUTS;
     }
     
-    // FFT incoming signal
-    srslte_dft_run(p->fft, signal, p->signal_fft);
-
     *n_indices = 0;
 
     // Extract bins of interest
@@ -562,16 +740,27 @@ int srslte_prach_detect_offset(srslte_prach_t *p,
     uint32_t K = DELTA_F/DELTA_F_RA;
     uint32_t begin = PHI + (K*k_0) + (K/2);
 
-    memcpy(p->prach_bins, &p->signal_fft[begin], p->N_zc*sizeof(cf_t));
+    if (p->dec_enabled) {
+      prach_frontend(p, begin, signal);
+    } else {
+      // FFT incoming signal
+      srslte_dft_run(p->fft, signal, p->signal_fft);
+      memcpy(p->prach_bins, &p->signal_fft[begin], p->N_zc*sizeof(cf_t));
+    }
     
+    // Correlate with all the roots
     for(int i=0;i<p->N_roots;i++){
       cf_t *root_spec = p->dft_seqs[p->root_seqs_idx[i]];
-     
-      srslte_vec_prod_conj_ccc(p->prach_bins, root_spec, p->corr_spec, p->N_zc);
-
-      srslte_dft_run(p->zc_ifft, p->corr_spec, p->corr_spec);
-      
-      srslte_vec_abs_square_cf(p->corr_spec, p->corr, p->N_zc);
+      srslte_vec_prod_conj_ccc(p->prach_bins, root_spec, &p->corr_specs[i*p->N_zc], p->N_zc);
+    }
+    if (!p->corr_batch || srslte_dft_run_batch_c(&p->corr_ifft, p->corr_specs, p->corr_specs)) {
+      for(int i=0;i<p->N_roots;i++){
+        srslte_dft_run(p->zc_ifft, &p->corr_specs[i*p->N_zc], &p->corr_specs[i*p->N_zc]);
+      }
+    }
+    
+    for(int i=0;i<p->N_roots;i++){
+      srslte_vec_abs_square_cf(&p->corr_specs[i*p->N_zc], p->corr, p->N_zc);
 
       float corr_ave = srslte_vec_acc_ff(p->corr, p->N_zc)/p->N_zc;
       
@@ -630,7 +819,6 @@ int srslte_prach_detect_offset(srslte_prach_t *p,
 
 int srslte_prach_free(srslte_prach_t *p) {
   free(p->prach_bins);
-  free(p->corr_spec);
   free(p->corr);
   srslte_dft_plan_free(p->ifft);
   free(p->ifft);
@@ -646,6 +834,22 @@ int srslte_prach_free(srslte_prach_t *p) {
   if (p->signal_fft) {
     free(p->signal_fft); 
   }
+  if (p->corr_specs) {
+    free(p->corr_specs);
+  }
+  if (p->corr_batch) {
+    srslte_dft_plan_free(&p->corr_ifft);
+  }
+  for (int i=0;i<p->dec_nof_stages;i++) {
+    free(p->dec_stages[i].input);
+  }
+  if (p->dec_available) {
+    srslte_dft_plan_free(p->dec_fft);
+    free(p->dec_fft);
+    free(p->dec_fft_in);
+    free(p->dec_fft_out);
+    free(p->dec_phasor);
+  }
   
   bzero(p, sizeof(srslte_prach_t));
 
@@ -451,6 +451,19 @@ int srslte_pucch_init(srslte_pucch_t *q, srslte_cell_t cell) {
     q->z = srslte_vec_malloc(sizeof(cf_t)*SRSLTE_PUCCH_MAX_SYMBOLS);
     q->z_tmp = srslte_vec_malloc(sizeof(cf_t)*SRSLTE_PUCCH_MAX_SYMBOLS);
     q->ce = srslte_vec_malloc(sizeof(cf_t)*SRSLTE_PUCCH_MAX_SYMBOLS);
+    
+    uint32_t nof_cs = 2*SRSLTE_CP_NSYMB(q->cell.cp);
+    q->cs_in   = srslte_vec_malloc(sizeof(cf_t)*nof_cs*SRSLTE_NRE);
+    q->cs_corr = srslte_vec_malloc(sizeof(cf_t)*nof_cs*SRSLTE_NRE);
+    if (!q->cs_in || !q->cs_corr) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    if (srslte_dft_plan_batch_c(&q->cs_plan, SRSLTE_NRE, SRSLTE_DFT_FORWARD, nof_cs, 
+                                SRSLTE_NRE, SRSLTE_NRE, q->cs_in, q->cs_corr)) {
+      fprintf(stderr, "Error creating PUCCH cyclic shift DFT plan\n");
+      return SRSLTE_ERROR;
+    }
 
     ret = SRSLTE_SUCCESS;
   }
@@ -473,6 +486,13 @@ void srslte_pucch_free(srslte_pucch_t *q) {
   if (q->ce) {
     free(q->ce);
   }
+  if (q->cs_in) {
+    free(q->cs_in);
+  }
+  if (q->cs_corr) {
+    free(q->cs_corr);
+  }
+  srslte_dft_plan_free(&q->cs_plan);
   
   srslte_modem_table_free(&q->mod);
   bzero(q, sizeof(srslte_pucch_t));
@@ -825,5 +845,239 @@ int srslte_pucch_decode(srslte_pucch_t* q, srslte_pucch_format_t format,
   return ret;     
 }
 
+/* Shortened PUCCH happen in every cell-specific SRS subframes for Format 1/1a/1b */
+static bool pucch_is_shortened(srslte_pucch_t *q, srslte_pucch_format_t format, uint32_t sf_idx) 
+{
+  return q->pucch_cfg.srs_configured && format < SRSLTE_PUCCH_FORMAT_2 && q->pucch_cfg.srs_simul_ack && 
+         srslte_refsignal_srs_send_cs(q->pucch_cfg.srs_cs_subf_cfg, sf_idx) == 1; 
+}
+
+/* Index of the cyclic shift with argument alpha */
+static uint32_t cs_index(float alpha) 
+{
+  return ((uint32_t) roundf(alpha*SRSLTE_NRE/(2*M_PI)))%SRSLTE_NRE;
+}
+
+/* Correlates every symbol of the PRB pair n_prb with the base sequence and all the cyclic shifts at 
+ * once: after removing the base sequence, the cyclic shifts are the bins of a 12 point DFT. Then 
+ * q->cs_corr[(ns*nsymb+l)*SRSLTE_NRE+k] is SRSLTE_NRE times the coefficient of cyclic shift k in 
+ * symbol l of slot ns */
+static void pucch_cs_correlate(srslte_pucch_t *q, cf_t *sf_symbols, uint32_t n_prb[2], cf_t r_conj[2][SRSLTE_NRE]) 
+{
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  for (uint32_t ns=0;ns<2;ns++) {
+    for (uint32_t l=0;l<nsymb;l++) {
+      srslte_vec_prod_ccc(&sf_symbols[SRSLTE_RE_IDX(q->cell.nof_prb, l+ns*nsymb, n_prb[ns]*SRSLTE_NRE)], 
+                          r_conj[ns], &q->cs_in[(ns*nsymb+l)*SRSLTE_NRE], SRSLTE_NRE);
+    }
+  }
+  srslte_dft_run_batch_c(&q->cs_plan, q->cs_in, q->cs_corr);
+}
 
-  
\ No newline at end of file
+/* Detects one transmission from the cyclic shift correlation of its PRB pair. The channel of each 
+ * slot is the average of its DMRS coefficients, and the decisions are the same as in 
+ * srslte_pucch_decode() */
+static int pucch_detect(srslte_pucch_t *q, srslte_pucch_rx_t *rx, uint32_t sf_idx, float noise_estimate) 
+{
+  srslte_pucch_format_t format = rx->format; 
+  srslte_cp_t cp = q->cell.cp; 
+  uint32_t nsymb = SRSLTE_CP_NSYMB(cp);
+  uint32_t N_rs  = srslte_refsignal_dmrs_N_rs(format, cp);
+  cf_t p[2][3]; 
+  cf_t h[2]; 
+  
+  bzero(rx->bits, SRSLTE_PUCCH_MAX_BITS*sizeof(uint8_t));
+  rx->corr = 0; 
+  
+  if (format >= SRSLTE_PUCCH_FORMAT_2 && !(q->users[rx->rnti] && q->users[rx->rnti]->sequence_generated)) {
+    fprintf(stderr, "Decoding PUCCH2: rnti not set\n");
+    return SRSLTE_ERROR; 
+  }
+  
+  /* DMRS coefficients */
+  for (uint32_t ns=0;ns<2;ns++) {
+    cf_t *c = &q->cs_corr[ns*nsymb*SRSLTE_NRE];
+    for (uint32_t m=0;m<N_rs;m++) {
+      uint32_t l = srslte_refsignal_dmrs_pucch_symbol(m, format, cp);
+      uint32_t n_oc = 0; 
+      float alpha = 0; 
+      if (format < SRSLTE_PUCCH_FORMAT_2) {
+        alpha = srslte_pucch_alpha_format1(q->n_cs_cell, &q->pucch_cfg, rx->n_pucch, cp, true, 2*sf_idx+ns, l, &n_oc, NULL);
+      } else {
+        alpha = srslte_pucch_alpha_format2(q->n_cs_cell, &q->pucch_cfg, rx->n_pucch, 2*sf_idx+ns, l);
+      }
+      p[ns][m] = c[l*SRSLTE_NRE+cs_index(alpha)]*cexpf(-I*srslte_refsignal_dmrs_pucch_w_arg(m, n_oc, format, cp))/SRSLTE_NRE;
+    }
+  }
+  
+  /* Format 2a/2b HARQ-ACK bits modulate the second DMRS symbol of each slot */
+  cf_t z_m_1 = 1.0; 
+  if (format == SRSLTE_PUCCH_FORMAT_2A || format == SRSLTE_PUCCH_FORMAT_2B) {
+    float max = -1; 
+    for (uint32_t i=0;i<(format == SRSLTE_PUCCH_FORMAT_2A?2:4);i++) {
+      uint8_t b[2] = {i%2, i/2}; 
+      cf_t z = 1.0; 
+      srslte_pucch_format2ab_mod_bits(format, b, &z);
+      float x = cabsf(p[0][0]+p[0][1]*conjf(z)) + cabsf(p[1][0]+p[1][1]*conjf(z));
+      if (x >= max) {
+        max = x; 
+        z_m_1 = z; 
+        rx->bits[20] = b[0];
+        rx->bits[21] = b[1];
+      }
+    }
+  }
+  for (uint32_t ns=0;ns<2;ns++) {
+    h[ns] = 0; 
+    for (uint32_t m=0;m<N_rs;m++) {
+      h[ns] += (m == 1)?p[ns][m]*conjf(z_m_1):p[ns][m];
+    }
+    h[ns] /= N_rs; 
+  }
+  
+  if (format < SRSLTE_PUCCH_FORMAT_2) {
+    /* Despread the orthogonal cover and combine both slots, MMSE weighted */
+    bool shortened = pucch_is_shortened(q, format, sf_idx);
+    cf_t  num = 0; 
+    float den = 0; 
+    for (uint32_t ns=0;ns<2;ns++) {
+      cf_t *c = &q->cs_corr[ns*nsymb*SRSLTE_NRE];
+      uint32_t N_sf = get_N_sf(format, ns, shortened);
+      uint32_t N_sf_widx = N_sf==3?1:0;
+      cf_t acc = 0; 
+      for (uint32_t m=0;m<N_sf;m++) {
+        uint32_t l = get_pucch_symbol(m, format, cp);
+        uint32_t n_oc = 0, n_prime_ns = 0; 
+        float alpha = srslte_pucch_alpha_format1(q->n_cs_cell, &q->pucch_cfg, rx->n_pucch, cp, true, 2*sf_idx+ns, l, &n_oc, &n_prime_ns);
+        float S_ns = (n_prime_ns%2)?M_PI/2:0; 
+        acc += c[l*SRSLTE_NRE+cs_index(alpha)]*cexpf(-I*(w_n_oc[N_sf_widx][n_oc%3][m]+S_ns));
+      }
+      num += acc/SRSLTE_NRE*conjf(h[ns]); 
+      den += N_sf*(crealf(h[ns]*conjf(h[ns]))+noise_estimate); 
+    }
+    cf_t d = den>0?num/den:0; 
+    
+    int ret = 0; 
+    switch(format) {
+      case SRSLTE_PUCCH_FORMAT_1:
+        rx->corr = crealf(d); 
+        ret = (rx->corr >= q->threshold_format1)?1:0; 
+        break;
+      case SRSLTE_PUCCH_FORMAT_1A:
+        rx->corr = fabsf(crealf(d)); 
+        rx->bits[0] = crealf(d)<0?1:0; 
+        ret = (rx->corr > q->threshold_format1)?1:0; 
+        break;
+      case SRSLTE_PUCCH_FORMAT_1B:
+        rx->corr = -1e9; 
+        for (uint32_t i=0;i<4;i++) {
+          uint8_t b[2] = {i/2, i%2}; 
+          float x = crealf(d*conjf(uci_encode_format1b(b)));
+          if (x > rx->corr) {
+            rx->corr = x; 
+            rx->bits[0] = b[0]; 
+            rx->bits[1] = b[1]; 
+          }
+        }
+        ret = (rx->corr > q->threshold_format1)?1:0; 
+        break;
+      default:
+        break;
+    }
+    DEBUG("PUCCH multi: format=%d, n_pucch=%d, corr=%f\n", format, rx->n_pucch, rx->corr);
+    return ret; 
+  } else {
+    /* One QPSK symbol per data symbol, equalized with the slot channel */
+    cf_t z[SRSLTE_PUCCH2_NOF_BITS/2]; 
+    int16_t llr_pucch2[32];
+    for (uint32_t ns=0;ns<2;ns++) {
+      cf_t *c = &q->cs_corr[ns*nsymb*SRSLTE_NRE];
+      for (uint32_t m=0;m<SRSLTE_PUCCH2_NOF_BITS/4;m++) {
+        uint32_t l = get_pucch_symbol(m, format, cp);
+        float alpha = srslte_pucch_alpha_format2(q->n_cs_cell, &q->pucch_cfg, rx->n_pucch, 2*sf_idx+ns, l);
+        z[ns*SRSLTE_PUCCH2_NOF_BITS/4+m] = c[l*SRSLTE_NRE+cs_index(alpha)]/SRSLTE_NRE*conjf(h[ns])/
+                                          (crealf(h[ns]*conjf(h[ns]))+noise_estimate);
+      }
+    }
+    srslte_demod_soft_demodulate_s(SRSLTE_MOD_QPSK, z, llr_pucch2, SRSLTE_PUCCH2_NOF_BITS/2);
+    srslte_scrambling_s(&q->users[rx->rnti]->seq_f2[sf_idx], llr_pucch2);  
+    rx->corr = (float) srslte_uci_decode_cqi_pucch(&q->cqi, llr_pucch2, rx->bits, 4)/2000;
+    return 1; 
+  }
+}
+
+static bool pucch_rx_isvalid(srslte_pucch_rx_t *rx) 
+{
+  return rx->format < SRSLTE_PUCCH_FORMAT_ERROR; 
+}
+
+/* Joint detector of all the PUCCH transmissions expected in a subframe. Each PRB pair is correlated 
+ * once with the base sequence and all the cyclic shifts, then every (format, n_pucch) hypothesis 
+ * that maps to it only combines a few of the correlation coefficients, so the cost per UE is 
+ * marginal. The channel is estimated from the DMRS of each transmission (no srslte_chest_ul_t is 
+ * needed). The result of each hypothesis is written to rx[i].ret */
+int srslte_pucch_decode_multi(srslte_pucch_t *q, srslte_pucch_rx_t *rx, uint32_t nof_rx, 
+                              uint32_t sf_idx, cf_t *sf_symbols, float noise_estimate)
+{
+  if (q == NULL || sf_symbols == NULL || (rx == NULL && nof_rx > 0) || sf_idx >= SRSLTE_NSUBFRAMES_X_FRAME) {
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  
+  /* Conjugated base sequence of each slot */
+  cf_t r_conj[2][SRSLTE_NRE]; 
+  for (uint32_t ns=0;ns<2;ns++) {
+    uint32_t f_gh=0; 
+    if (q->group_hopping_en) {
+      f_gh = q->f_gh[2*sf_idx+ns];
+    }
+    uint32_t u = (f_gh + (q->cell.id%30))%30;
+    srslte_refsignal_r_uv_arg_1prb(q->tmp_arg, u); 
+    for (uint32_t n=0;n<SRSLTE_NRE;n++) {
+      r_conj[ns][n] = cexpf(-I*q->tmp_arg[n]);
+    }
+  }
+  
+  for (uint32_t i=0;i<nof_rx;i++) {
+    if (!pucch_rx_isvalid(&rx[i])) {
+      rx[i].ret = SRSLTE_ERROR_INVALID_INPUTS; 
+    }
+  }
+  
+  for (uint32_t i=0;i<nof_rx;i++) {
+    if (!pucch_rx_isvalid(&rx[i])) {
+      continue; 
+    }
+    uint32_t m = srslte_pucch_m(&q->pucch_cfg, rx[i].format, rx[i].n_pucch, q->cell.cp);
+    
+    // Each PRB pair is processed with the first hypothesis that maps to it 
+    bool done = false; 
+    for (uint32_t j=0;j<i && !done;j++) {
+      done = pucch_rx_isvalid(&rx[j]) && 
+             srslte_pucch_m(&q->pucch_cfg, rx[j].format, rx[j].n_pucch, q->cell.cp) == m;
+    }
+    if (done) {
+      continue; 
+    }
+    
+    uint32_t n_prb[2]; 
+    for (uint32_t ns=0;ns<2;ns++) {
+      n_prb[ns] = srslte_pucch_n_prb(&q->pucch_cfg, rx[i].format, rx[i].n_pucch, q->cell.nof_prb, q->cell.cp, ns);
+    }
+    bool prb_valid = n_prb[0] < q->cell.nof_prb && n_prb[1] < q->cell.nof_prb; 
+    if (prb_valid) {
+      pucch_cs_correlate(q, sf_symbols, n_prb, r_conj);
+    } else {
+      fprintf(stderr, "Error getting PUCCH symbols\n");
+    }
+    
+    for (uint32_t j=i;j<nof_rx;j++) {
+      if (pucch_rx_isvalid(&rx[j]) && 
+          srslte_pucch_m(&q->pucch_cfg, rx[j].format, rx[j].n_pucch, q->cell.cp) == m) 
+      {
+        rx[j].n_prb = n_prb[0]; 
+        rx[j].ret   = prb_valid?pucch_detect(q, &rx[j], sf_idx, noise_estimate):SRSLTE_ERROR; 
+      }
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
@@ -209,12 +209,6 @@ int srslte_pusch_init(srslte_pusch_t *q, srslte_cell_t cell) {
       srslte_modem_table_bytes(&q->mod[i]);
     }
     
-    q->users = calloc(sizeof(srslte_pusch_user_t*), 1+SRSLTE_SIRNTI);
-    if (!q->users) {
-      perror("malloc");
-      goto clean;
-    }
-
     /* Precompute sequence for type2 frequency hopping */
     if (srslte_sequence_LTE_pr(&q->seq_type2_fo, 210, q->cell.id)) {
       fprintf(stderr, "Error initiating type2 frequency hopping sequence\n");
@@ -253,6 +247,12 @@ int srslte_pusch_init(srslte_pusch_t *q, srslte_cell_t cell) {
       goto clean;
     }
 
+    // Scrambling sequence of the subframe being decoded, packed in bytes
+    q->seq_bytes = srslte_vec_malloc(q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM) / 8 + 8);
+    if (!q->seq_bytes) {
+      goto clean;
+    }
+
     ret = SRSLTE_SUCCESS;
   }
   clean: 
@@ -280,15 +280,12 @@ void srslte_pusch_free(srslte_pusch_t *q) {
   if (q->z) {
     free(q->z);
   }
+  if (q->seq_bytes) {
+    free(q->seq_bytes);
+  }
   
   srslte_dft_precoding_free(&q->dft_precoding);
 
-  if (q->users) {
-    for (int rnti=0;rnti<SRSLTE_SIRNTI;rnti++) {      
-      srslte_pusch_clear_rnti(q, rnti);
-    }
-    free(q->users);
-  }
   srslte_sequence_free(&q->seq_type2_fo);
   
   for (i = 0; i < 4; i++) {
@@ -386,35 +383,14 @@ int srslte_pusch_cfg(srslte_pusch_t             *q,
   }
 }
 
-/* Precalculate the PUSCH scramble sequences for a given RNTI. This function takes a while 
- * to execute, so shall be called once the final C-RNTI has been allocated for the session.
- * For the connection procedure, use srslte_pusch_encode() functions */
+/* The PUSCH scrambling sequence is generated on the fly from the RNTI, so there is nothing to 
+ * precompute and an RNTI costs no memory. Kept for API compatibility. 
+ */
 int srslte_pusch_set_rnti(srslte_pusch_t *q, uint16_t rnti) {
-  uint32_t i;
-  
-  if (!q->users[rnti]) {
-    q->users[rnti] = calloc(1, sizeof(srslte_pusch_user_t));
-    if (q->users[rnti]) {
-      for (i = 0; i < SRSLTE_NSUBFRAMES_X_FRAME; i++) {
-        if (srslte_sequence_pusch(&q->users[rnti]->seq[i], rnti, 2 * i, q->cell.id,
-            q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM))) {
-          return SRSLTE_ERROR; 
-        }
-      }
-      q->users[rnti]->sequences_generated = true;
-    }
-  }
   return SRSLTE_SUCCESS;
 }
 
 void srslte_pusch_clear_rnti(srslte_pusch_t *q, uint16_t rnti) {
-  if (q->users[rnti]) {
-    for (int i = 0; i < SRSLTE_NSUBFRAMES_X_FRAME; i++) {
-      srslte_sequence_free(&q->users[rnti]->seq[i]);
-    }    
-    free(q->users[rnti]);
-    q->users[rnti] = NULL; 
-  }
 }
 
 /** Converts the PUSCH data bits to symbols mapped to the slot ready for transmission
@@ -445,16 +421,8 @@ int srslte_pusch_encode(srslte_pusch_t *q, srslte_pusch_cfg_t *cfg, srslte_softb
       return SRSLTE_ERROR;
     }
 
-    if (q->users[rnti] && q->users[rnti]->sequences_generated) {
-      srslte_scrambling_bytes(&q->users[rnti]->seq[cfg->sf_idx], (uint8_t*) q->q, cfg->nbits.nof_bits);
-    } else {
-      srslte_sequence_t seq;
-      if (srslte_sequence_pusch(&seq, rnti, 2 * cfg->sf_idx, q->cell.id, cfg->nbits.nof_bits)) {
-        return SRSLTE_ERROR;
-      }
-      srslte_scrambling_bytes(&seq, (uint8_t*) q->q, cfg->nbits.nof_bits);
-      srslte_sequence_free(&seq);
-    }
+    srslte_scrambling_bytes_seed(srslte_sequence_pusch_seed(rnti, 2 * cfg->sf_idx, q->cell.id), 
+                                 (uint8_t*) q->q, cfg->nbits.nof_bits);
     
     // Correct UCI placeholder/repetition bits    
     uint8_t *d = q->q; 
@@ -524,39 +492,49 @@ int srslte_pusch_decode(srslte_pusch_t *q,
       return SRSLTE_ERROR;
     }
 
-    // Equalization
-    srslte_predecoding_single(q->d, q->ce, q->z, cfg->nbits.nof_re, noise_estimate);
+    return srslte_pusch_decode_symbols(q, cfg, softbuffer, q->d, q->ce, noise_estimate, rnti, data, uci_data);
+  } else {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+}
+
+/* Decodes a PUSCH transmission from its data symbols and channel estimates, already extracted from 
+ * the resource grid in transmission order (cfg->nbits.nof_re symbols each). symbols can be q->d */
+int srslte_pusch_decode_symbols(srslte_pusch_t *q, 
+                                srslte_pusch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffer, 
+                                cf_t *symbols, cf_t *ce, float noise_estimate, uint16_t rnti,                        
+                                uint8_t *data, srslte_uci_data_t *uci_data) 
+{
+  if (q           != NULL &&
+      symbols     != NULL &&
+      ce          != NULL &&
+      data        != NULL &&
+      cfg         != NULL)
+  {
+    // Equalization, with the normalization of the DFT despreading 
+    srslte_predecoding_single_scale(symbols, ce, q->z, cfg->nbits.nof_re, noise_estimate, 
+                                    1/sqrtf(cfg->grant.L_prb*SRSLTE_NRE));
     
     // DFT predecoding
-    srslte_dft_predecoding(&q->dft_precoding, q->z, q->d, cfg->grant.L_prb, cfg->nbits.nof_symb);
+    if (srslte_dft_predecoding_batch(&q->dft_precoding, q->z, q->d, cfg->grant.L_prb, cfg->nbits.nof_symb)) {
+      return SRSLTE_ERROR; 
+    }
     
     // Soft demodulation
     srslte_demod_soft_demodulate_s(cfg->grant.mcs.mod, q->d, q->q, cfg->nbits.nof_re);
 
-    srslte_sequence_t *seq = NULL;
-
-    // Create sequence if does not exist
-    if (q->users[rnti] && q->users[rnti]->sequences_generated) {
-      seq = &q->users[rnti]->seq[cfg->sf_idx];
-    } else {
-      seq = &q->tmp_seq;
-      if (srslte_sequence_pusch(seq, rnti, 2 * cfg->sf_idx, q->cell.id, cfg->nbits.nof_bits)) {
-        return SRSLTE_ERROR;
-      }
-    }
+    // Generate the scrambling sequence, the RI/HARQ decoder needs it before descrambling
+    srslte_sequence_LTE_pr_bytes(q->seq_bytes, cfg->nbits.nof_bits, 
+                                 srslte_sequence_pusch_seed(rnti, 2 * cfg->sf_idx, q->cell.id));
     
     // Decode RI/HARQ bits before descrambling 
-    if (srslte_ulsch_uci_decode_ri_ack(&q->ul_sch, cfg, softbuffer, q->q, seq->c, uci_data)) {
+    if (srslte_ulsch_uci_decode_ri_ack(&q->ul_sch, cfg, softbuffer, q->q, q->seq_bytes, uci_data)) {
       fprintf(stderr, "Error decoding RI/HARQ bits\n");
       return SRSLTE_ERROR; 
     }
     
     // Descrambling
-    srslte_scrambling_s_offset(seq, q->q, 0, cfg->nbits.nof_bits);
-        
-    if (!(q->users[rnti] && q->users[rnti]->sequences_generated)) {
-      srslte_sequence_free(seq);
-    }
+    srslte_scrambling_s_bytes(q->seq_bytes, q->q, cfg->nbits.nof_bits);
     
     return srslte_ulsch_uci_decode(&q->ul_sch, cfg, softbuffer, q->q, q->g, data, uci_data);      
   } else {
@@ -32,6 +32,7 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "srslte/phy/phch/pdsch.h"
 #include "srslte/phy/phch/pusch.h"
@@ -44,6 +45,20 @@
 
 #define SRSLTE_PDSCH_MAX_TDEC_ITERS         4
 
+/* Fraction of the Shannon capacity achieved by the turbo decoder, used to compute the SINR that a 
+ * given spectral efficiency requires */
+#define SCH_ADAPT_SHANNON_EFFICIENCY        0.75
+
+#define SCH_ADAPT_DEFAULT_MIN_ITERS         1
+
+static void adapt_clock_monotonic(struct timespec *now) {
+  clock_gettime(CLOCK_MONOTONIC, now);
+}
+
+static double adapt_usec_diff(struct timespec *end, struct timespec *start) {
+  return (double) (end->tv_sec - start->tv_sec)*1e6 + (double) (end->tv_nsec - start->tv_nsec)/1e3;
+}
+
 /* 36.213 Table 8.6.3-1: Mapping of HARQ-ACK offset values and the index signalled by higher layers */
 float beta_harq_offset[16] = {2.0, 2.5, 3.125, 4.0, 5.0, 6.250, 8.0, 10.0, 
                            12.625, 15.875, 20.0, 31.0, 50.0, 80.0, 126.0, -1.0};
@@ -116,6 +131,10 @@ int srslte_sch_init(srslte_sch_t *q) {
     }
 
     q->max_iterations = SRSLTE_PDSCH_MAX_TDEC_ITERS;
+    q->adapt.min_iterations = SCH_ADAPT_DEFAULT_MIN_ITERS;
+    q->adapt.sinr_margin_db = SRSLTE_SCH_ADAPT_DEFAULT_MARGIN_DB;
+    q->adapt.sinr_db = NAN;
+    q->adapt.clock = adapt_clock_monotonic;
     
     srslte_rm_turbo_gentables();
     
@@ -125,6 +144,11 @@ int srslte_sch_init(srslte_sch_t *q) {
       goto clean;
     }
     
+    q->dec_batch_out = srslte_vec_malloc(sizeof(uint8_t) * SRSLTE_TDEC_MAX_BATCH * SRSLTE_TCOD_MAX_LEN_CB/8);
+    if (!q->dec_batch_out) {
+      goto clean;
+    }
+    
     q->parity_bits = srslte_vec_malloc(sizeof(uint8_t) * (3 * SRSLTE_TCOD_MAX_LEN_CB + 16) / 8);
     if (!q->parity_bits) {
       goto clean;
@@ -141,6 +165,9 @@ int srslte_sch_init(srslte_sch_t *q) {
     if (srslte_uci_cqi_init(&q->uci_cqi)) {
       goto clean;
     }
+    pthread_mutex_init(&q->dec_mutex, NULL);
+    pthread_cond_init(&q->dec_cvar_start, NULL);
+    pthread_cond_init(&q->dec_cvar_done, NULL);
     
     ret = SRSLTE_SUCCESS;
   }
@@ -151,10 +178,19 @@ clean:
   return ret; 
 }
 
+static void stop_decoder_threads(srslte_sch_t *q);
+
 void srslte_sch_free(srslte_sch_t *q) {
+  stop_decoder_threads(q);
+  pthread_mutex_destroy(&q->dec_mutex);
+  pthread_cond_destroy(&q->dec_cvar_start);
+  pthread_cond_destroy(&q->dec_cvar_done);
   if (q->cb_in) {
     free(q->cb_in);
   }
+  if (q->dec_batch_out) {
+    free(q->dec_batch_out);
+  }
   if (q->parity_bits) {
     free(q->parity_bits);
   }
@@ -174,6 +210,57 @@ void srslte_sch_set_max_noi(srslte_sch_t *q, uint32_t max_iterations) {
   q->max_iterations = max_iterations;
 }
 
+/* Stops decoding a code block whose hard decisions did not change during max_stall consecutive 
+ * iterations, even if max_iterations were not reached. 0 (the default) disables it */
+void srslte_sch_set_stall_iterations(srslte_sch_t *q, uint32_t max_stall) {
+  q->max_stall = max_stall;
+}
+
+/* Enables the adaptive iteration policy. Code blocks of first transmissions whose SINR is more 
+ * than sinr_margin_db below the one required by their code rate are given min_iterations */
+void srslte_sch_set_adaptive_noi(srslte_sch_t *q, bool enabled, uint32_t min_iterations, float sinr_margin_db) {
+  q->adapt.enabled = enabled;
+  q->adapt.min_iterations = min_iterations;
+  q->adapt.sinr_margin_db = sinr_margin_db;
+}
+
+/* SINR of the next transport block to decode, NAN if unknown */
+void srslte_sch_set_sinr(srslte_sch_t *q, float sinr_db) {
+  q->adapt.sinr_db = sinr_db;
+}
+
+/* As srslte_sch_set_sinr() with a linear SNR from the channel estimator. A non-positive SNR is 
+ * no estimate at all and would read as -inf dB, so the SINR is set unknown instead */
+void srslte_sch_set_snr(srslte_sch_t *q, float snr) {
+  q->adapt.sinr_db = (snr > 0) ? 10*log10f(snr) : NAN;
+}
+
+/* Time by which the next transport blocks must be decoded, NULL to remove it. It is read from the 
+ * clock of srslte_sch_set_adaptive_clock(), CLOCK_MONOTONIC by default. Code blocks that would not 
+ * finish in time get fewer iterations or are not decoded at all */
+void srslte_sch_set_deadline(srslte_sch_t *q, struct timespec *deadline) {
+  if (deadline) {
+    q->adapt.deadline = *deadline;
+    q->adapt.has_deadline = true;
+  } else {
+    q->adapt.has_deadline = false;
+  }
+}
+
+/* Replaces CLOCK_MONOTONIC as the time source of the deadline, NULL restores it */
+void srslte_sch_set_adaptive_clock(srslte_sch_t *q, srslte_sch_clock_t clock) {
+  q->adapt.clock = clock ? clock : adapt_clock_monotonic;
+}
+
+/* Counters are updated while decoding, read them from the thread calling the decode functions */
+void srslte_sch_adaptive_stats(srslte_sch_t *q, srslte_sch_adapt_stats_t *stats) {
+  *stats = q->adapt.stats;
+}
+
+void srslte_sch_reset_adaptive_stats(srslte_sch_t *q) {
+  bzero(&q->adapt.stats, sizeof(srslte_sch_adapt_stats_t));
+}
+
 float srslte_sch_average_noi(srslte_sch_t *q) {
   return q->average_nof_iterations; 
 }
@@ -182,17 +269,85 @@ uint32_t srslte_sch_last_noi(srslte_sch_t *q) {
   return q->nof_iterations;
 }
 
+uint64_t srslte_sch_last_cb_crc(srslte_sch_t *q) {
+  return q->cb_crc;
+}
+
+void srslte_tb_iov_reset(srslte_tb_iov_t *tb) {
+  tb->nof_segments = 0; 
+}
+
+/* Appends a segment of len bytes to the transport block. Returns SRSLTE_ERROR if there is no 
+ * room for more segments */
+int srslte_tb_iov_add(srslte_tb_iov_t *tb, uint8_t *ptr, uint32_t len) {
+  if (tb->nof_segments >= SRSLTE_TB_IOV_MAX_SEGMENTS) {
+    return SRSLTE_ERROR; 
+  }
+  if (len > 0) {
+    tb->ptr[tb->nof_segments] = ptr; 
+    tb->len[tb->nof_segments] = len; 
+    tb->nof_segments++;
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+uint32_t srslte_tb_iov_len(srslte_tb_iov_t *tb) {
+  uint32_t len = 0; 
+  for (uint32_t i=0;i<tb->nof_segments;i++) {
+    len += tb->len[i];
+  }
+  return len; 
+}
+
+/* Copies the whole transport block to a contiguous buffer */
+void srslte_tb_iov_gather(srslte_tb_iov_t *tb, uint8_t *data) {
+  for (uint32_t i=0;i<tb->nof_segments;i++) {
+    memcpy(data, tb->ptr[i], tb->len[i]);
+    data += tb->len[i];
+  }
+}
+
+/* Copies the next nbytes of the transport block starting at segment *seg, offset *off */
+static void tb_iov_read(srslte_tb_iov_t *tb, uint32_t *seg, uint32_t *off, uint8_t *dst, uint32_t nbytes) {
+  while (nbytes > 0 && *seg < tb->nof_segments) {
+    uint32_t n = SRSLTE_MIN(nbytes, tb->len[*seg] - *off);
+    memcpy(dst, &tb->ptr[*seg][*off], n);
+    dst    += n; 
+    nbytes -= n;
+    *off   += n; 
+    if (*off == tb->len[*seg]) {
+      (*seg)++;
+      *off = 0; 
+    }
+  }
+}
+
+static srslte_tb_iov_t* tb_iov_single(srslte_tb_iov_t *tb, uint8_t *data, uint32_t nbytes) {
+  if (!data) {
+    return NULL; 
+  }
+  tb->ptr[0] = data; 
+  tb->len[0] = nbytes; 
+  tb->nof_segments = 1; 
+  return tb; 
+}
+
 
 /* Encode a transport block according to 36.212 5.3.2
  *
+ * The transport block is read from the segments of tb while filling each code block, and 
+ * the TB CRC is computed incrementally over the gathered bytes. If tb is NULL the code 
+ * blocks already in the softbuffer are rate matched again (retransmission).
  */
 static int encode_tb_off(srslte_sch_t *q, 
                      srslte_softbuffer_tx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
                      uint32_t Qm, uint32_t rv, uint32_t nof_e_bits,  
-                     uint8_t *data, uint8_t *e_bits, uint32_t w_offset) 
+                     srslte_tb_iov_t *tb, uint8_t *e_bits, uint32_t w_offset) 
 {
   uint8_t parity[3] = {0, 0, 0};
   uint32_t par;
+  uint32_t tb_crc = 0; 
+  uint32_t seg = 0, off = 0; 
   uint32_t i;
   uint32_t cb_len=0, rp=0, wp=0, rlen=0, n_e=0;
   int ret = SRSLTE_ERROR_INVALID_INPUTS; 
@@ -220,15 +375,10 @@ static int encode_tb_off(srslte_sch_t *q,
       gamma = Gp%cb_segm->C;
     }
 
-    if (data) {
-
-      /* Compute transport block CRC */
-      par = srslte_crc_checksum_byte(&q->crc_tb, data, cb_segm->tbs);
-
-      /* parity bits will be appended later */
-      parity[0] = (par&(0xff<<16))>>16;
-      parity[1] = (par&(0xff<<8))>>8;
-      parity[2] = par&0xff;
+    if (tb && srslte_tb_iov_len(tb) != cb_segm->tbs/8) {
+      fprintf(stderr, "Error transport block segments have %d bytes, expected %d\n", 
+              srslte_tb_iov_len(tb), cb_segm->tbs/8);
+      return SRSLTE_ERROR; 
     }
     
     wp = 0;
@@ -258,19 +408,24 @@ static int encode_tb_off(srslte_sch_t *q,
       INFO("CB#%d: cb_len: %d, rlen: %d, wp: %d, rp: %d, E: %d\n", i,
           cb_len, rlen, wp, rp, n_e);
 
-      if (data) {
+      if (tb) {
 
-        /* Copy data to another buffer, making space for the Codeblock CRC */
-        if (i < cb_segm->C - 1) {
-          // Copy data 
-          memcpy(q->cb_in, &data[rp/8], rlen * sizeof(uint8_t)/8);
-        } else {
+        /* Gather data to another buffer, making space for the Codeblock CRC, and update the 
+         * transport block CRC with it */
+        uint32_t nbytes = (i < cb_segm->C - 1) ? rlen/8 : (rlen - 24)/8;
+        tb_iov_read(tb, &seg, &off, q->cb_in, nbytes);
+        tb_crc = srslte_crc_update_byte(&q->crc_tb, tb_crc, q->cb_in, nbytes);
+        
+        if (i == cb_segm->C - 1) {
           INFO("Last CB, appending parity: %d from %d and 24 to %d\n",
               rlen - 24, rp, rlen - 24);
           
           /* Append Transport Block parity bits to the last CB */
-          memcpy(q->cb_in, &data[rp/8], (rlen - 24) * sizeof(uint8_t)/8);
-          memcpy(&q->cb_in[(rlen - 24)/8], parity, 3 * sizeof(uint8_t));
+          par = srslte_crc_final(&q->crc_tb, tb_crc);
+          parity[0] = (par&(0xff<<16))>>16;
+          parity[1] = (par&(0xff<<8))>>8;
+          parity[2] = par&0xff;
+          memcpy(&q->cb_in[nbytes], parity, 3 * sizeof(uint8_t));
         }        
         
         /* Attach Codeblock CRC */
@@ -308,11 +463,591 @@ static int encode_tb(srslte_sch_t *q,
                      uint32_t Qm, uint32_t rv, uint32_t nof_e_bits,  
                      uint8_t *data, uint8_t *e_bits) 
 {
-  return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, data, e_bits, 0);
+  srslte_tb_iov_t tb; 
+  return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, 
+                       tb_iov_single(&tb, data, cb_segm->tbs/8), e_bits, 0);
+}
+
+  
+
+
+/* Computes read/write lengths and pointers of every code block in the transport block */
+static void cb_params(srslte_cbsegm_t *cb_segm, uint32_t Qm, uint32_t nof_e_bits, srslte_sch_cb_t *cb, uint32_t max_cb)
+{
+  uint32_t Gp = nof_e_bits / Qm;
+  uint32_t gamma = Gp%cb_segm->C;
+  uint32_t rp = 0, wp = 0; 
+  
+  for (uint32_t i = 0; i < cb_segm->C && i < max_cb; i++) {
+    if (i < cb_segm->C2) {
+      cb[i].cb_len    = cb_segm->K2;
+      cb[i].cblen_idx = cb_segm->K2_idx;
+    } else {
+      cb[i].cb_len    = cb_segm->K1;
+      cb[i].cblen_idx = cb_segm->K1_idx;
+    }
+    
+    if (cb_segm->C == 1) {
+      cb[i].rlen = cb[i].cb_len;
+    } else {
+      cb[i].rlen = cb[i].cb_len - 24;
+    }
+
+    if (i <= cb_segm->C - gamma - 1) {
+      cb[i].n_e = Qm * (Gp/cb_segm->C);
+    } else {
+      cb[i].n_e = Qm * ((uint32_t) ceilf((float) Gp/cb_segm->C));
+    }
+    cb[i].rp = rp; 
+    cb[i].wp = wp; 
+    
+    wp += cb[i].rlen;
+    rp += cb[i].n_e;
+  }
+}
+
+/* Maximum iterations for all the code blocks of a transport block given its SINR. Retransmissions 
+ * are combined in the soft buffer with previous ones, so their SINR understates the decoder input 
+ * and they always get max_iterations */
+static uint32_t adapt_tb_max_iterations(srslte_sch_t *q, uint32_t tbs, uint32_t Qm, uint32_t nof_e_bits, uint32_t rv) 
+{
+  srslte_sch_adapt_t *a = &q->adapt;
+  if (!a->enabled || isnan(a->sinr_db) || rv != 0 || nof_e_bits == 0) {
+    return q->max_iterations;
+  }
+  
+  // Information bits per resource element and SINR needed to carry them
+  float se = (float) tbs * Qm / nof_e_bits;
+  float sinr_req_db = 10*log10f(exp2f(se/SCH_ADAPT_SHANNON_EFFICIENCY) - 1);
+  
+  if (a->sinr_db < sinr_req_db - a->sinr_margin_db) {
+    INFO("SINR %.1f dB too low for SE %.2f (requires %.1f dB)\n", a->sinr_db, se, sinr_req_db);
+    return SRSLTE_MIN(a->min_iterations, q->max_iterations);
+  }
+  return q->max_iterations;
+}
+
+/* Maximum iterations of the next code block: the cap of the transport block, reduced so that this 
+ * and the remaining nof_cb_left code blocks, spread over the decoding threads, finish before the 
+ * deadline. Returns 0 if not even one iteration fits. Updates the counters, so in parallel mode it 
+ * must be called with dec_mutex held */
+static uint32_t adapt_cb_max_iterations(srslte_sch_t *q, uint32_t cb_len, uint32_t nof_cb_left) 
+{
+  srslte_sch_adapt_t *a = &q->adapt;
+  uint32_t max_iterations = q->dec_max_iterations; 
+  
+  a->stats.nof_cb++;
+  if (max_iterations < q->max_iterations) {
+    a->stats.nof_cb_capped_sinr++;
+  }
+  
+  if (a->enabled && a->has_deadline) {
+    struct timespec now; 
+    a->clock(&now);
+    double usec_left = adapt_usec_diff(&a->deadline, &now);
+    
+    uint32_t nof_workers = q->nof_dec_threads + 1; 
+    uint32_t nof_rounds  = (nof_cb_left + nof_workers - 1)/nof_workers;
+    double usec_per_iter = (double) a->usec_per_kbit * cb_len / 1000 * nof_rounds;
+    
+    uint32_t n = max_iterations; 
+    if (usec_left <= 0) {
+      n = 0; 
+    } else if (usec_per_iter > 0 && usec_left < usec_per_iter * max_iterations) {
+      n = (uint32_t) (usec_left / usec_per_iter); 
+    }
+    
+    if (n == 0) {
+      a->stats.nof_cb_abandoned++;
+    } else if (n < max_iterations) {
+      a->stats.nof_cb_capped_deadline++;
+    }
+    max_iterations = n; 
+  }
+  return max_iterations;
+}
+
+/* Rate unmatching of code block i into its soft buffer */
+static int unmatch_cb(srslte_softbuffer_rx_t *softbuffer, srslte_sch_cb_t *cb, uint32_t i, uint32_t rv, int16_t *e_bits) 
+{
+  if (srslte_rm_turbo_rx_lut(&e_bits[cb->rp], softbuffer->buffer_f[i], cb->n_e, cb->cblen_idx, rv)) {
+    fprintf(stderr, "Error in rate matching\n");
+    return SRSLTE_ERROR;
+  }
+
+  if (SRSLTE_VERBOSE_ISDEBUG()) {
+    char tmpstr[64]; 
+    snprintf(tmpstr,64,"rmout_%d.dat",i);
+    DEBUG("SAVED FILE %s: Encoded turbo code block %d\n", tmpstr, i);
+    srslte_vec_save_file(tmpstr, softbuffer->buffer_f[i], (3*cb->cb_len+12)*sizeof(int16_t));
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/* Copies decoded code block i to the output buffer, removing the Codeblock CRC */
+static void copy_cb(srslte_cbsegm_t *cb_segm, srslte_sch_cb_t *cb, uint32_t i, uint8_t *cb_out, 
+                    uint8_t *data, uint8_t *parity) 
+{
+  if (i < cb_segm->C - 1) {
+    memcpy(&data[cb->wp/8], cb_out, cb->rlen/8 * sizeof(uint8_t));
+  } else {        
+    /* Append Transport Block parity bits to the last CB */
+    memcpy(&data[cb->wp/8], cb_out, (cb->rlen - 24)/8 * sizeof(uint8_t));
+    memcpy(parity, &cb_out[(cb->rlen - 24)/8], 3 * sizeof(uint8_t));
+  }
 }
 
+/* Rate unmatching, turbo decoding with CRC-based early stopping and copy of the code block 
+ * to the output buffer. Uses the decoder and byte buffer passed as arguments so that it can be 
+ * called concurrently for different code blocks. 
+ * Returns the number of iterations (negative on error) and sets crc_ok if the CRC was correct. 
+ */
+static int decode_cb(srslte_sch_t *q, srslte_tdec_t *decoder, srslte_crc_t *crc_tb, srslte_crc_t *crc_cb, uint8_t *cb_in, 
+                     srslte_softbuffer_rx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
+                     srslte_sch_cb_t *cb, uint32_t i, uint32_t rv, uint32_t max_iterations, 
+                     int16_t *e_bits, uint8_t *data, uint8_t *parity, bool *crc_ok) 
+{
+  uint32_t nof_iterations = 0; 
+  uint32_t nof_changes = 0, nof_stalled = 0; 
+  uint32_t len_crc; 
+  srslte_crc_t *crc_ptr; 
   
+  /* Rate Unmatching */
+  if (unmatch_cb(softbuffer, cb, i, rv, e_bits)) {
+    return SRSLTE_ERROR;
+  }
 
+  /* Turbo Decoding with CRC-based early stopping */
+  if (cb_segm->C > 1) {
+    len_crc = cb->cb_len; 
+    crc_ptr = crc_cb; 
+  } else {
+    len_crc = cb_segm->tbs+24; 
+    crc_ptr = crc_tb; 
+  }
+  
+  *crc_ok = false; 
+
+  srslte_tdec_reset(decoder, cb->cb_len);
+        
+  do {
+    srslte_tdec_iteration(decoder, softbuffer->buffer_f[i], cb->cb_len); 
+    nof_iterations++;
+
+    /* Decide and check Codeblock CRC in one pass, stop early if correct */
+    if (!srslte_tdec_decision_crc(decoder, cb_in, cb->cb_len, crc_ptr, len_crc, &nof_changes)) {
+      *crc_ok = true;           
+    }
+
+    /* Decisions that no longer change with a wrong CRC are unlikely to converge to the right codeword */
+    nof_stalled = (nof_iterations > 1 && nof_changes == 0) ? nof_stalled + 1 : 0; 
+   
+  } while (nof_iterations < max_iterations && !*crc_ok && (!q->max_stall || nof_stalled < q->max_stall));
+
+  INFO("CB#%d: cb_len: %d, rlen: %d, wp: %d, rp: %d, E: %d, n_iters=%d, changes=%d\n", i,
+      cb->cb_len, cb->rlen, cb->wp, cb->rp, cb->n_e, nof_iterations, nof_changes);
+
+  /* Copy data to another buffer, removing the Codeblock CRC */
+  copy_cb(cb_segm, cb, i, cb_in, data, parity);
+  
+  return nof_iterations; 
+}
+
+/* Takes code blocks of the current transport block until all are decoded or one fails */
+static void decode_cb_parallel(srslte_sch_t *q, srslte_tdec_t *decoder, 
+                               srslte_crc_t *crc_tb, srslte_crc_t *crc_cb, uint8_t *cb_in) 
+{
+  while (1) {
+    pthread_mutex_lock(&q->dec_mutex);
+    uint32_t i = q->dec_next_cb++; 
+    bool cancel = q->dec_cancel; 
+    uint32_t max_iterations = 0; 
+    if (i < q->dec_cb_segm->C && !cancel) {
+      max_iterations = adapt_cb_max_iterations(q, q->dec_cb[i].cb_len, q->dec_cb_segm->C - i);
+      if (!max_iterations) {
+        q->dec_cancel = true; 
+      }
+    }
+    pthread_mutex_unlock(&q->dec_mutex);
+    
+    if (i >= q->dec_cb_segm->C || cancel || !max_iterations) {
+      return; 
+    }
+    
+    bool crc_ok = false; 
+    int n = decode_cb(q, decoder, crc_tb, crc_cb, cb_in, q->dec_softbuffer, q->dec_cb_segm, &q->dec_cb[i], i, q->dec_rv, 
+                      max_iterations, q->dec_e_bits, q->dec_data, q->dec_parity, &crc_ok);
+    
+    pthread_mutex_lock(&q->dec_mutex);
+    if (n > 0) {
+      q->dec_cb_iterations[i] = (uint32_t) n; 
+      q->adapt.stats.nof_iterations += n; 
+    }
+    if (crc_ok) {
+      q->cb_crc |= ((uint64_t) 1)<<i; 
+    } else if (!SRSLTE_VERBOSE_ISDEBUG()) {
+      // If CB CRC is not correct, the code blocks not yet started are not decoded
+      q->dec_cancel = true; 
+    }
+    pthread_mutex_unlock(&q->dec_mutex);
+  }
+}
+
+static void* decoder_thread(void *arg) 
+{
+  srslte_sch_dec_worker_t *w = (srslte_sch_dec_worker_t*) arg; 
+  srslte_sch_t *q = (srslte_sch_t*) w->sch; 
+  uint32_t generation = 0; 
+  
+  pthread_mutex_lock(&q->dec_mutex);
+  while (1) {
+    while (!q->dec_exit && q->dec_generation == generation) {
+      pthread_cond_wait(&q->dec_cvar_start, &q->dec_mutex);
+    }
+    if (q->dec_exit) {
+      break; 
+    }
+    generation = q->dec_generation; 
+    pthread_mutex_unlock(&q->dec_mutex);
+    
+    decode_cb_parallel(q, &w->decoder, &w->crc_tb, &w->crc_cb, w->cb_in);
+    
+    pthread_mutex_lock(&q->dec_mutex);
+    q->dec_pending--; 
+    if (!q->dec_pending) {
+      pthread_cond_signal(&q->dec_cvar_done);
+    }
+  }
+  pthread_mutex_unlock(&q->dec_mutex);
+  return NULL; 
+}
+
+static void stop_decoder_threads(srslte_sch_t *q) 
+{
+  if (q->nof_dec_threads) {
+    pthread_mutex_lock(&q->dec_mutex);
+    q->dec_exit = true; 
+    pthread_cond_broadcast(&q->dec_cvar_start);
+    pthread_mutex_unlock(&q->dec_mutex);
+    
+    for (uint32_t i = 0; i < q->nof_dec_threads; i++) {
+      pthread_join(q->dec_workers[i].thread, NULL);
+      srslte_tdec_free(&q->dec_workers[i].decoder);
+      free(q->dec_workers[i].cb_in);
+    }
+    bzero(q->dec_workers, sizeof(srslte_sch_dec_worker_t)*SRSLTE_SCH_MAX_DEC_THREADS);
+    q->nof_dec_threads = 0; 
+    q->dec_exit = false; 
+  }
+}
+
+/* Sets the number of helper threads used to decode the code blocks of a transport block concurrently. 
+ * The calling thread also decodes code blocks. With 0 (the default) code blocks are decoded serially. 
+ */
+int srslte_sch_set_decoder_threads(srslte_sch_t *q, uint32_t nof_threads) 
+{
+  if (nof_threads > SRSLTE_SCH_MAX_DEC_THREADS) {
+    fprintf(stderr, "Error number of decoder threads (%d) exceeds maximum (%d)\n", 
+            nof_threads, SRSLTE_SCH_MAX_DEC_THREADS);
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  
+  stop_decoder_threads(q);
+  
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    srslte_sch_dec_worker_t *w = &q->dec_workers[i]; 
+    w->sch = q; 
+    if (srslte_crc_init(&w->crc_tb, SRSLTE_LTE_CRC24A, 24) || 
+        srslte_crc_init(&w->crc_cb, SRSLTE_LTE_CRC24B, 24)) {
+      fprintf(stderr, "Error initiating CRC\n");
+      goto clean;
+    }
+    if (srslte_tdec_init(&w->decoder, SRSLTE_TCOD_MAX_LEN_CB)) {
+      fprintf(stderr, "Error initiating Turbo Decoder\n");
+      goto clean;
+    }
+    w->cb_in = srslte_vec_malloc(sizeof(uint8_t) * (SRSLTE_TCOD_MAX_LEN_CB+8)/8);
+    if (!w->cb_in) {
+      srslte_tdec_free(&w->decoder);
+      goto clean;
+    }
+    if (pthread_create(&w->thread, NULL, decoder_thread, w)) {
+      perror("pthread_create");
+      srslte_tdec_free(&w->decoder);
+      free(w->cb_in);
+      goto clean;
+    }
+    q->nof_dec_threads++; 
+  }
+  return SRSLTE_SUCCESS;
+  
+clean: 
+  stop_decoder_threads(q);
+  return SRSLTE_ERROR; 
+}
+
+/* Decodes the code blocks in parallel using the helper threads and the calling thread */
+static bool decode_tb_parallel(srslte_sch_t *q, 
+                               srslte_softbuffer_rx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
+                               uint32_t rv, int16_t *e_bits, uint8_t *data, uint8_t *parity) 
+{
+  pthread_mutex_lock(&q->dec_mutex);
+  q->dec_softbuffer = softbuffer; 
+  q->dec_cb_segm    = cb_segm; 
+  q->dec_rv         = rv; 
+  q->dec_e_bits     = e_bits; 
+  q->dec_data       = data; 
+  q->dec_next_cb    = 0; 
+  q->dec_cancel     = false; 
+  q->dec_pending    = q->nof_dec_threads; 
+  bzero(q->dec_cb_iterations, sizeof(uint32_t)*cb_segm->C);
+  q->dec_generation++; 
+  pthread_cond_broadcast(&q->dec_cvar_start);
+  pthread_mutex_unlock(&q->dec_mutex);
+  
+  decode_cb_parallel(q, &q->decoder, &q->crc_tb, &q->crc_cb, q->cb_in);
+  
+  pthread_mutex_lock(&q->dec_mutex);
+  while (q->dec_pending) {
+    pthread_cond_wait(&q->dec_cvar_done, &q->dec_mutex);
+  }
+  pthread_mutex_unlock(&q->dec_mutex);
+  
+  /* Report the slowest code block, average all of them */
+  q->nof_iterations = 0; 
+  for (uint32_t i = 0; i < cb_segm->C; i++) {
+    if (q->dec_cb_iterations[i]) {
+      q->average_nof_iterations = SRSLTE_VEC_EMA((float) q->dec_cb_iterations[i], q->average_nof_iterations, 0.2);
+      if (q->dec_cb_iterations[i] > q->nof_iterations) {
+        q->nof_iterations = q->dec_cb_iterations[i]; 
+      }
+    }
+  }
+  
+  memcpy(parity, q->dec_parity, 3*sizeof(uint8_t));
+  
+  if (q->dec_cancel) {
+    INFO("CB failed (crc bitmap=0x%llx). TB is erroneous.\n", (unsigned long long) q->cb_crc);
+    return false; 
+  }
+  return true; 
+}
+
+/* Rate-unmatches the code blocks of a transport block and appends them to the batch, with the 
+ * iteration cap of the transport block given its SINR */
+static int batch_add_tb(srslte_sch_t *q, 
+                        srslte_softbuffer_rx_t *softbuffer, srslte_cbsegm_t *cb_segm, 
+                        uint32_t Qm, uint32_t rv, uint32_t nof_e_bits, int16_t *e_bits, uint8_t *data) 
+{
+  uint32_t first = q->batch_nof_cb; 
+  srslte_sch_cb_t *cb = &q->batch_cb[first]; 
+  uint32_t max_iterations = SRSLTE_MAX(adapt_tb_max_iterations(q, cb_segm->tbs, Qm, nof_e_bits, rv), 1); 
+  
+  cb_params(cb_segm, Qm, nof_e_bits, cb, SRSLTE_TDEC_MAX_BATCH - first);
+  
+  for (uint32_t i = 0; i < cb_segm->C; i++) {
+    srslte_tdec_cb_t *b = &q->dec_batch[first + i]; 
+    if (unmatch_cb(softbuffer, &cb[i], i, rv, e_bits)) {
+      return SRSLTE_ERROR;
+    }
+    b->input          = softbuffer->buffer_f[i]; 
+    b->output         = &q->dec_batch_out[(first + i)*SRSLTE_TCOD_MAX_LEN_CB/8]; 
+    b->long_cb        = cb[i].cb_len; 
+    b->crc            = cb_segm->C > 1 ? &q->crc_cb : &q->crc_tb; 
+    b->len_crc        = cb_segm->C > 1 ? cb[i].cb_len : cb_segm->tbs + 24; 
+    b->max_stall      = q->max_stall; 
+    b->max_iterations = max_iterations; 
+    b->tb_idx         = q->batch_nof_tb; 
+    
+    q->adapt.stats.nof_cb++;
+    if (max_iterations < q->max_iterations) {
+      q->adapt.stats.nof_cb_capped_sinr++;
+    }
+  }
+  
+  srslte_sch_batch_tb_t *tb = &q->batch_tb[q->batch_nof_tb++]; 
+  tb->cb_segm  = *cb_segm; 
+  tb->data     = data; 
+  tb->first_cb = first; 
+  q->batch_nof_cb += cb_segm->C; 
+  return SRSLTE_SUCCESS; 
+}
+
+/* Decodes all the code blocks in the batch with srslte_tdec_run_batch(), which packs them in the 
+ * SIMD lanes of the decoder. As in the serial path, the first code block of a transport block that 
+ * fails stops the others of the same transport block unless debug verbosity is set */
+static int batch_decode(srslte_sch_t *q) 
+{
+  q->batch_ret = srslte_tdec_run_batch(&q->decoder, q->dec_batch, q->batch_nof_cb, q->max_iterations, 
+                                       !SRSLTE_VERBOSE_ISDEBUG()); 
+  if (q->batch_ret) {
+    fprintf(stderr, "Error decoding code block batch\n");
+  }
+  return q->batch_ret; 
+}
+
+/* Copies the code blocks of transport block tb_idx of the batch to its output buffer. Reports the 
+ * slowest code block, averages all of them. Returns 1 if all CRC were correct and 0 if not */
+static int batch_copy_tb(srslte_sch_t *q, uint32_t tb_idx, uint8_t *parity) 
+{
+  srslte_sch_batch_tb_t *tb = &q->batch_tb[tb_idx]; 
+  bool crc_ok = true; 
+  
+  q->nof_iterations = 0; 
+  for (uint32_t i = 0; i < tb->cb_segm.C; i++) {
+    srslte_tdec_cb_t *b = &q->dec_batch[tb->first_cb + i]; 
+    srslte_sch_cb_t *cb = &q->batch_cb[tb->first_cb + i]; 
+    if (b->nof_iterations == 0) {
+      crc_ok = false; 
+      continue; 
+    }
+    q->average_nof_iterations = SRSLTE_VEC_EMA((float) b->nof_iterations, q->average_nof_iterations, 0.2);
+    q->nof_iterations = SRSLTE_MAX(q->nof_iterations, b->nof_iterations); 
+    q->adapt.stats.nof_iterations += b->nof_iterations; 
+    
+    INFO("CB#%d: cb_len: %d, rlen: %d, wp: %d, rp: %d, E: %d, n_iters=%d, changes=%d\n", i, 
+         cb->cb_len, cb->rlen, cb->wp, cb->rp, cb->n_e, b->nof_iterations, b->nof_changes);
+    
+    if (b->crc_ok) {
+      q->cb_crc |= ((uint64_t) 1)<<i; 
+    } else {
+      crc_ok = false; 
+    }
+    copy_cb(&tb->cb_segm, cb, i, b->output, tb->data, parity);
+  }
+  
+  if (!crc_ok) {
+    INFO("CB failed (crc bitmap=0x%llx). TB is erroneous.\n", (unsigned long long) q->cb_crc);
+  }
+  return crc_ok ? 1 : 0; 
+}
+
+/* Checks the transport block CRC against the parity bits appended to its last code block */
+static int check_tb_crc(srslte_sch_t *q, srslte_cbsegm_t *cb_segm, uint8_t *data, uint8_t *parity) 
+{
+  INFO("END CB#%d: crc bitmap=0x%llx\n", cb_segm->C, (unsigned long long) q->cb_crc);
+
+  // Compute transport block CRC
+  uint32_t par_rx = srslte_crc_checksum_byte(&q->crc_tb, data, cb_segm->tbs);
+
+  // check parity bits
+  uint32_t par_tx = ((uint32_t) parity[0])<<16 | ((uint32_t) parity[1])<<8 | ((uint32_t) parity[2]);
+  
+  if (!par_rx) {
+    INFO("Warning: Received all-zero transport block\n\n", 0);      
+  }
+
+  if (par_rx == par_tx) {
+    INFO("TB decoded OK\n", 0);
+    return SRSLTE_SUCCESS;
+  } else {
+    INFO("Error in TB parity: par_tx=0x%x, par_rx=0x%x\n", par_tx, par_rx);
+    return SRSLTE_ERROR;
+  }
+}
+
+/* Decoding of the transport blocks of several users with one srslte_tdec_run_batch() call, so that 
+ * their code blocks share the SIMD lanes of the decoder. After srslte_sch_batch_start(), 
+ * srslte_dlsch_decode() and srslte_ulsch_uci_decode() only rate-unmatch the code blocks into the 
+ * soft buffer and return success, and srslte_sch_batch_nof_tb() grows by one. A transport block that 
+ * does not fit in the batch is decoded right away instead. Soft buffers and output buffers must be 
+ * kept until srslte_sch_batch_result() is called after srslte_sch_batch_run() */
+void srslte_sch_batch_start(srslte_sch_t *q) 
+{
+  q->batch_enabled = true; 
+  q->batch_ret     = SRSLTE_SUCCESS; 
+  q->batch_nof_cb  = 0; 
+  q->batch_nof_tb  = 0; 
+}
+
+uint32_t srslte_sch_batch_nof_tb(srslte_sch_t *q) 
+{
+  return q->batch_nof_tb; 
+}
+
+/* Decodes the transport blocks added since srslte_sch_batch_start(). With a deadline, the iterations 
+ * of all code blocks are reduced so that the whole batch fits in the time left */
+int srslte_sch_batch_run(srslte_sch_t *q) 
+{
+  srslte_sch_adapt_t *a = &q->adapt;
+  struct timespec t[2];
+  
+  q->batch_enabled = false; 
+  if (q->batch_nof_cb == 0) {
+    return SRSLTE_SUCCESS; 
+  }
+  
+  if (a->enabled) {
+    a->clock(&t[0]);
+  }
+  
+  if (a->enabled && a->has_deadline) {
+    uint64_t nof_bits = 0; 
+    for (uint32_t i = 0; i < q->batch_nof_cb; i++) {
+      nof_bits += q->dec_batch[i].long_cb; 
+    }
+    double usec_left = adapt_usec_diff(&a->deadline, &t[0]);
+    double usec_per_iter = (double) a->usec_per_kbit * nof_bits / 1000;
+    
+    uint32_t n = q->max_iterations; 
+    if (usec_left <= 0) {
+      n = 0; 
+    } else if (usec_per_iter > 0 && usec_left < usec_per_iter * n) {
+      n = (uint32_t) (usec_left / usec_per_iter); 
+    }
+    
+    for (uint32_t i = 0; i < q->batch_nof_cb; i++) {
+      srslte_tdec_cb_t *b = &q->dec_batch[i]; 
+      if (n == 0) {
+        a->stats.nof_cb_abandoned++;
+        b->crc_ok         = false; 
+        b->nof_iterations = 0; 
+      } else if (n < b->max_iterations) {
+        a->stats.nof_cb_capped_deadline++;
+        b->max_iterations = n; 
+      }
+    }
+    if (n == 0) {
+      return SRSLTE_SUCCESS; 
+    }
+  }
+  
+  if (batch_decode(q)) {
+    return SRSLTE_ERROR; 
+  }
+  
+  /* Decoding cost per iteration and kbit, as in decode_tb() */
+  if (a->enabled) {
+    double kbit_iterations = 0; 
+    for (uint32_t i = 0; i < q->batch_nof_cb; i++) {
+      kbit_iterations += (double) q->dec_batch[i].nof_iterations * q->dec_batch[i].long_cb / 1000; 
+    }
+    a->clock(&t[1]);
+    float usec = (float) adapt_usec_diff(&t[1], &t[0]);
+    if (usec > 0 && kbit_iterations > 0) {
+      float cost = usec / kbit_iterations;
+      a->usec_per_kbit = a->usec_per_kbit > 0 ? SRSLTE_VEC_EMA(cost, a->usec_per_kbit, 0.2) : cost;
+    }
+  }
+  return SRSLTE_SUCCESS; 
+}
+
+/* Result of transport block tb_idx of the last batch, with the same return value as the decode 
+ * function that added it. Sets the values returned by srslte_sch_last_noi() and 
+ * srslte_sch_last_cb_crc() */
+int srslte_sch_batch_result(srslte_sch_t *q, uint32_t tb_idx) 
+{
+  uint8_t parity[3] = {0, 0, 0};
+  
+  if (tb_idx >= q->batch_nof_tb) {
+    return SRSLTE_ERROR_INVALID_INPUTS; 
+  }
+  q->cb_crc = 0; 
+  if (q->batch_ret || batch_copy_tb(q, tb_idx, parity) <= 0) {
+    return SRSLTE_ERROR; 
+  }
+  return check_tb_crc(q, &q->batch_tb[tb_idx].cb_segm, q->batch_tb[tb_idx].data, parity); 
+}
 
 /**
  * Decode a transport block according to 36.212 5.3.2
@@ -333,9 +1068,7 @@ static int decode_tb(srslte_sch_t *q,
                      int16_t *e_bits, uint8_t *data) 
 {
   uint8_t parity[3] = {0, 0, 0};
-  uint32_t par_rx, par_tx;
-  uint32_t i;
-  uint32_t cb_len, rp, wp, rlen, n_e;
+  uint32_t i = 0;
   
   if (q            != NULL && 
       data         != NULL &&       
@@ -344,16 +1077,12 @@ static int decode_tb(srslte_sch_t *q,
       cb_segm      != NULL)
   {
 
+    q->cb_crc = 0; 
+    
     if (cb_segm->tbs == 0 || cb_segm->C == 0) {
       return SRSLTE_SUCCESS;
     }
     
-    rp = 0;
-    rp = 0;
-    wp = 0;
-    uint32_t Gp = nof_e_bits / Qm;
-    uint32_t gamma=Gp;
-
     if (cb_segm->F) {
       fprintf(stderr, "Error filler bits are not supported. Use standard TBS\n");
       return SRSLTE_ERROR;       
@@ -364,127 +1093,90 @@ static int decode_tb(srslte_sch_t *q,
       return SRSLTE_ERROR;
     }
     
-    if (cb_segm->C>0) {
-      gamma = Gp%cb_segm->C;
+    if (cb_segm->C > SRSLTE_SCH_MAX_CB) {
+      fprintf(stderr, "Error number of CB (%d) exceeds maximum (%d CBs)\n", cb_segm->C, SRSLTE_SCH_MAX_CB);
+      return SRSLTE_ERROR;
+    }
+    
+    if (q->batch_enabled && q->batch_nof_tb < SRSLTE_SCH_MAX_BATCH_TB && 
+        q->batch_nof_cb + cb_segm->C <= SRSLTE_TDEC_MAX_BATCH) {
+      return batch_add_tb(q, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, data); 
+    }
+    
+    cb_params(cb_segm, Qm, nof_e_bits, q->dec_cb, SRSLTE_SCH_MAX_CB);
+    
+    q->dec_max_iterations = adapt_tb_max_iterations(q, cb_segm->tbs, Qm, nof_e_bits, rv);
+    
+    struct timespec t[2];
+    uint64_t nof_iterations_start = q->adapt.stats.nof_iterations;
+    if (q->adapt.enabled) {
+      q->adapt.clock(&t[0]);
     }
     
     bool early_stop = true;
-    for (i = 0; i < cb_segm->C && early_stop; i++) {
-
-      /* Get read/write lengths */
-      uint32_t cblen_idx; 
-      if (i < cb_segm->C2) {
-        cb_len = cb_segm->K2;
-        cblen_idx = cb_segm->K2_idx;
-      } else {
-        cb_len = cb_segm->K1;
-        cblen_idx = cb_segm->K1_idx;
+    if (q->nof_dec_threads > 0 && cb_segm->C > 1) {
+      early_stop = decode_tb_parallel(q, softbuffer, cb_segm, rv, e_bits, data, parity);
+    } else if (cb_segm->C > 1 && !q->batch_enabled && !(q->adapt.enabled && q->adapt.has_deadline)) {
+      /* Without a deadline all code blocks get the same cap, so they can share the decoder lanes */
+      q->batch_nof_cb = 0; 
+      q->batch_nof_tb = 0; 
+      if (batch_add_tb(q, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, data) || batch_decode(q)) {
+        return SRSLTE_ERROR; 
       }
-      
-      if (cb_segm->C == 1) {
-        rlen = cb_len;
-      } else {
-        rlen = cb_len - 24;
-      }
-
-      if (i <= cb_segm->C - gamma - 1) {
-        n_e = Qm * (Gp/cb_segm->C);
-      } else {
-        n_e = Qm * ((uint32_t) ceilf((float) Gp/cb_segm->C));
-      }
-
-      /* Rate Unmatching */
-      if (srslte_rm_turbo_rx_lut(&e_bits[rp], softbuffer->buffer_f[i], n_e, cblen_idx, rv)) {
-        fprintf(stderr, "Error in rate matching\n");
-        return SRSLTE_ERROR;
-      }
-
-      if (SRSLTE_VERBOSE_ISDEBUG()) {
-        char tmpstr[64]; 
-        snprintf(tmpstr,64,"rmout_%d.dat",i);
-        DEBUG("SAVED FILE %s: Encoded turbo code block %d\n", tmpstr, i);
-        srslte_vec_save_file(tmpstr, softbuffer->buffer_f[i], (3*cb_len+12)*sizeof(int16_t));
-      }
-
-      /* Turbo Decoding with CRC-based early stopping */
-      q->nof_iterations = 0; 
-      uint32_t len_crc; 
-      srslte_crc_t *crc_ptr; 
-      early_stop = false; 
-
-      srslte_tdec_reset(&q->decoder, cb_len);
-            
-      do {
-        srslte_tdec_iteration(&q->decoder, softbuffer->buffer_f[i], cb_len); 
-        q->nof_iterations++;
+      early_stop = batch_copy_tb(q, 0, parity) > 0; 
+    } else {
+      uint32_t failed_cb = 0; 
+      for (i = 0; i < cb_segm->C && early_stop; i++) {
+        uint32_t max_iterations = adapt_cb_max_iterations(q, q->dec_cb[i].cb_len, cb_segm->C - i);
+        if (!max_iterations) {
+          failed_cb  = i; 
+          early_stop = false; 
+          break; 
+        }
+        int n = decode_cb(q, &q->decoder, &q->crc_tb, &q->crc_cb, q->cb_in, softbuffer, cb_segm, &q->dec_cb[i], i, rv, 
+                          max_iterations, e_bits, data, parity, &early_stop);
+        if (n < 0) {
+          return SRSLTE_ERROR; 
+        }
+        q->nof_iterations = (uint32_t) n; 
+        q->average_nof_iterations = SRSLTE_VEC_EMA((float) q->nof_iterations, q->average_nof_iterations, 0.2);
+        q->adapt.stats.nof_iterations += n; 
         
-        if (cb_segm->C > 1) {
-          len_crc = cb_len; 
-          crc_ptr = &q->crc_cb; 
+        // If CB CRC is not correct, early_stop will be false and wont continue with rest of CBs
+        if (early_stop) {
+          q->cb_crc |= ((uint64_t) 1)<<i; 
         } else {
-          len_crc = cb_segm->tbs+24; 
-          crc_ptr = &q->crc_tb; 
+          failed_cb = i; 
         }
-
-        srslte_tdec_decision_byte(&q->decoder, q->cb_in, cb_len);
-                 
-        /* Check Codeblock CRC and stop early if correct */
-        if (!srslte_crc_checksum_byte(crc_ptr, q->cb_in, len_crc)) {
-          early_stop = true;           
+        
+        if (SRSLTE_VERBOSE_ISDEBUG()) {
+          early_stop = true; 
         }
-       
-      } while (q->nof_iterations < q->max_iterations && !early_stop);
-      q->average_nof_iterations = SRSLTE_VEC_EMA((float) q->nof_iterations, q->average_nof_iterations, 0.2);
-
-      INFO("CB#%d: cb_len: %d, rlen: %d, wp: %d, rp: %d, E: %d, n_iters=%d\n", i,
-          cb_len, rlen, wp, rp, n_e, q->nof_iterations);
-      
-            
-      // If CB CRC is not correct, early_stop will be false and wont continue with rest of CBs
-
-      /* Copy data to another buffer, removing the Codeblock CRC */
-      if (i < cb_segm->C - 1) {
-        memcpy(&data[wp/8], q->cb_in, rlen/8 * sizeof(uint8_t));
-      } else {        
-        /* Append Transport Block parity bits to the last CB */
-        memcpy(&data[wp/8], q->cb_in, (rlen - 24)/8 * sizeof(uint8_t));
-        memcpy(parity, &q->cb_in[(rlen - 24)/8], 3 * sizeof(uint8_t));
       }
-      
-      if (SRSLTE_VERBOSE_ISDEBUG()) {
-        early_stop = true; 
+      if (!early_stop) {
+        INFO("CB %d failed. TB is erroneous.\n", failed_cb);
+      }
+    }
+    
+    /* Decoding cost per iteration and kbit, on one thread, used to meet the deadline */
+    if (q->adapt.enabled) {
+      uint64_t nof_iterations = q->adapt.stats.nof_iterations - nof_iterations_start;
+      if (nof_iterations > 0) {
+        q->adapt.clock(&t[1]);
+        uint32_t nof_workers = SRSLTE_MIN(cb_segm->C, q->nof_dec_threads + 1);
+        float usec = (float) adapt_usec_diff(&t[1], &t[0]) * nof_workers;
+        if (usec > 0) {
+          float cost = usec / ((float) nof_iterations * q->dec_cb[0].cb_len / 1000);
+          q->adapt.usec_per_kbit = q->adapt.usec_per_kbit > 0 ? 
+                                   SRSLTE_VEC_EMA(cost, q->adapt.usec_per_kbit, 0.2) : cost;
+        }
       }
-      
-      /* Set read/write pointers */
-      wp += rlen;
-      rp += n_e;
     }
     
     if (!early_stop) {
-      INFO("CB %d failed. TB is erroneous.\n",i-1);
       return SRSLTE_ERROR; 
-    } else {
-      INFO("END CB#%d: wp: %d, rp: %d\n", i, wp, rp);
-
-      // Compute transport block CRC
-      par_rx = srslte_crc_checksum_byte(&q->crc_tb, data, cb_segm->tbs);
-
-      // check parity bits
-      par_tx = ((uint32_t) parity[0])<<16 | ((uint32_t) parity[1])<<8 | ((uint32_t) parity[2]);
-      
-      if (!par_rx) {
-        INFO("Warning: Received all-zero transport block\n\n", 0);      
-      }
-
-      if (par_rx == par_tx) {
-        INFO("TB decoded OK\n",i);
-        return SRSLTE_SUCCESS;
-      } else {
-        INFO("Error in TB parity: par_tx=0x%x, par_rx=0x%x\n", par_tx, par_rx);
-        return SRSLTE_ERROR;
-      }
-      
     }
+    return check_tb_crc(q, cb_segm, data, parity);
   } else {
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
@@ -518,6 +1210,45 @@ int srslte_dlsch_encode(srslte_sch_t *q, srslte_pdsch_cfg_t *cfg, srslte_softbuf
                    data, e_bits);
 }
 
+/* Same as srslte_dlsch_encode() and srslte_dlsch_decode() for the codeword cw_idx of a spatial 
+ * multiplexing grant 
+ */
+int srslte_dlsch_encode_cw(srslte_sch_t *q, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffer,
+                           uint8_t *data, uint8_t *e_bits, uint32_t cw_idx) 
+{
+  if (cw_idx == 0) {
+    return srslte_dlsch_encode(q, cfg, softbuffer, data, e_bits);
+  }
+  return encode_tb(q, 
+                   softbuffer, &cfg->cb_segm2, 
+                   cfg->grant.Qm2, cfg->rv2, cfg->nbits2.nof_bits, 
+                   data, e_bits);
+}
+
+/* Same as srslte_dlsch_encode_cw() with the transport block given as a list of segments */
+int srslte_dlsch_encode_iov(srslte_sch_t *q, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffer,
+                            srslte_tb_iov_t *tb, uint8_t *e_bits, uint32_t cw_idx) 
+{
+  if (cw_idx == 0) {
+    return encode_tb_off(q, softbuffer, &cfg->cb_segm, 
+                         cfg->grant.Qm, cfg->rv, cfg->nbits.nof_bits, tb, e_bits, 0);
+  }
+  return encode_tb_off(q, softbuffer, &cfg->cb_segm2, 
+                       cfg->grant.Qm2, cfg->rv2, cfg->nbits2.nof_bits, tb, e_bits, 0);
+}
+
+int srslte_dlsch_decode_cw(srslte_sch_t *q, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffer, 
+                           int16_t *e_bits, uint8_t *data, uint32_t cw_idx) 
+{
+  if (cw_idx == 0) {
+    return srslte_dlsch_decode(q, cfg, softbuffer, e_bits, data);
+  }
+  return decode_tb(q,                    
+                   softbuffer, &cfg->cb_segm2, 
+                   cfg->grant.Qm2, cfg->rv2, cfg->nbits2.nof_bits, 
+                   e_bits, data);
+}
+
 /* Compute the interleaving function on-the-fly, because it depends on number of RI bits 
  * Profiling show that the computation of this matrix is neglegible. 
  */
@@ -600,7 +1331,7 @@ int srslte_ulsch_decode(srslte_sch_t *q, srslte_pusch_cfg_t *cfg, srslte_softbuf
 
 /* This is done before scrambling */
 int srslte_ulsch_uci_decode_ri_ack(srslte_sch_t *q, srslte_pusch_cfg_t *cfg, srslte_softbuffer_rx_t *softbuffer,
-                                   int16_t *q_bits, uint8_t *c_seq, srslte_uci_data_t *uci_data) 
+                                   int16_t *q_bits, uint8_t *c_bytes, srslte_uci_data_t *uci_data) 
 {
   int ret = 0; 
 
@@ -618,7 +1349,7 @@ int srslte_ulsch_uci_decode_ri_ack(srslte_sch_t *q, srslte_pusch_cfg_t *cfg, srs
     if (cfg->cb_segm.tbs == 0) {
         beta /= beta_cqi_offset[cfg->uci_cfg.I_offset_cqi];
     }
-    ret = srslte_uci_decode_ack(cfg, q_bits, c_seq, beta, nb_q/Qm, uci_data->uci_cqi_len, q->ack_ri_bits, &uci_data->uci_ack);
+    ret = srslte_uci_decode_ack(cfg, q_bits, c_bytes, beta, nb_q/Qm, uci_data->uci_cqi_len, q->ack_ri_bits, &uci_data->uci_ack);
     if (ret < 0) {
       return ret; 
     }
@@ -636,7 +1367,7 @@ int srslte_ulsch_uci_decode_ri_ack(srslte_sch_t *q, srslte_pusch_cfg_t *cfg, srs
     if (cfg->cb_segm.tbs == 0) {
         beta /= beta_cqi_offset[cfg->uci_cfg.I_offset_cqi];
     }
-    ret = srslte_uci_decode_ri(cfg, q_bits, c_seq, beta, nb_q/Qm, uci_data->uci_cqi_len, q->ack_ri_bits, &uci_data->uci_ri);
+    ret = srslte_uci_decode_ri(cfg, q_bits, c_bytes, beta, nb_q/Qm, uci_data->uci_cqi_len, q->ack_ri_bits, &uci_data->uci_ri);
     if (ret < 0) {
       return ret; 
     }
@@ -748,9 +1479,10 @@ int srslte_ulsch_uci_encode(srslte_sch_t *q,
   // Encode UL-SCH
   if (cfg->cb_segm.tbs > 0) {
     uint32_t G = nb_q/Qm - Q_prime_ri - Q_prime_cqi;     
+    srslte_tb_iov_t tb; 
     ret = encode_tb_off(q, softbuffer, &cfg->cb_segm, 
                     Qm, cfg->rv, G*Qm, 
-                    data, &g_bits[e_offset/8], e_offset%8);
+                    tb_iov_single(&tb, data, cfg->cb_segm.tbs/8), &g_bits[e_offset/8], e_offset%8);
     if (ret) {
       return ret; 
     }    
@@ -65,17 +65,25 @@ int srslte_sequence_pdcch(srslte_sequence_t *seq, uint32_t nslot, uint32_t cell_
 /**
  * 36.211 6.3.1
  */
+uint32_t srslte_sequence_pdsch_seed(uint16_t rnti, int q, uint32_t nslot, uint32_t cell_id) {
+  return (rnti<<14) + (q<<13) + ((nslot/2)<<9) + cell_id;
+}
+
 int srslte_sequence_pdsch(srslte_sequence_t *seq, uint16_t rnti, int q, uint32_t nslot, uint32_t cell_id, uint32_t len) {
   bzero(seq, sizeof(srslte_sequence_t));
-  return srslte_sequence_LTE_pr(seq, len, (rnti<<14) + (q<<13) + ((nslot/2)<<9) + cell_id);
+  return srslte_sequence_LTE_pr(seq, len, srslte_sequence_pdsch_seed(rnti, q, nslot, cell_id));
 }
 
 /**
  * 36.211 5.3.1
  */
+uint32_t srslte_sequence_pusch_seed(uint16_t rnti, uint32_t nslot, uint32_t cell_id) {
+  return (rnti<<14) + ((nslot/2)<<9) + cell_id;
+}
+
 int srslte_sequence_pusch(srslte_sequence_t *seq, uint16_t rnti, uint32_t nslot, uint32_t cell_id, uint32_t len) {
   bzero(seq, sizeof(srslte_sequence_t));
-  return srslte_sequence_LTE_pr(seq, len, (rnti<<14) + ((nslot/2)<<9) + cell_id);
+  return srslte_sequence_LTE_pr(seq, len, srslte_sequence_pusch_seed(rnti, nslot, cell_id));
 }
 
 /**
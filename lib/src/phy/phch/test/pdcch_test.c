@@ -130,7 +130,8 @@ int test_dci_payload_size() {
 
 int main(int argc, char **argv) {
   srslte_pdcch_t pdcch;
-  srslte_dci_msg_t dci_tx[2], dci_rx[2], dci_tmp;
+  srslte_dci_msg_t dci_tx[2], dci_rx[2], dci_tmp, dci_batch[2];
+  uint16_t crc_batch[2];
   srslte_dci_location_t dci_locations[2];
   srslte_ra_dl_dci_t ra_dl;
   srslte_regs_t regs;
@@ -237,6 +238,19 @@ int main(int argc, char **argv) {
       goto quit;
     }
   }
+
+  /* Decode both locations again with the batched decoder and early rejection enabled */
+  srslte_viterbi_set_reject_threshold(&pdcch.decoder, 0.1);
+  if (srslte_pdcch_decode_msg_batch(&pdcch, dci_batch, dci_locations, nof_dcis, SRSLTE_DCI_FORMAT1, crc_batch)) {
+    fprintf(stderr, "Error decoding DCI messages in batch\n");
+    goto quit;
+  }
+  for (i = 0; i < nof_dcis; i++) {
+    if (crc_batch[i] != 1234 + i || memcmp(dci_tx[i].data, dci_batch[i].data, dci_tx[i].nof_bits)) {
+      printf("Error in DCI %d: Batched decoding does not match (CRC 0x%x)\n", i, crc_batch[i]);
+      goto quit;
+    }
+  }
   ret = 0;
 
 quit: 
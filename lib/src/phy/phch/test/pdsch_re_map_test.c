@@ -0,0 +1,201 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "srslte/srslte.h"
+
+uint32_t nof_prb_bench = 100; 
+uint32_t nof_trials = 0; 
+
+void usage(char *prog) {
+  printf("Usage: %s [nt]\n", prog);
+  printf("\t-n number of PRB of the benchmarked cell [Default %d]\n", nof_prb_bench);
+  printf("\t-t number of trials of the benchmark, full allocation in every subframe [Default %d]\n", nof_trials);
+  printf("\t-v [set verbose to debug, default none]\n");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "ntv")) != -1) {
+    switch(opt) {
+    case 'n':
+      nof_prb_bench = atoi(argv[optind]);
+      break;
+    case 't':
+      nof_trials = atoi(argv[optind]);
+      break;
+    case 'v':
+      srslte_verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+cf_t sf_symbols[2][SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM)];
+cf_t symbols[2][SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM)];
+
+/* Compares the precomputed RE map against srslte_pdsch_cp() for random allocations. PRB 0 is always 
+ * allocated because srslte_pdsch_cp() takes the CRS offset of the edge PBCH PRB of odd bandwidths 
+ * from the previous allocated PRB */
+int test_cell(srslte_cell_t cell) 
+{
+  srslte_pdsch_t pdsch; 
+  srslte_ra_dl_grant_t grant; 
+  uint32_t sf_len = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp);
+  int ret = -1; 
+  
+  if (srslte_pdsch_init(&pdsch, cell)) {
+    fprintf(stderr, "Error creating PDSCH object\n");
+    return -1; 
+  }
+  
+  for (uint32_t i=0;i<sf_len;i++) {
+    sf_symbols[0][i] = i; 
+  }
+  for (uint32_t trial=0;trial<4;trial++) {
+    for (uint32_t lstart=1;lstart<SRSLTE_PDSCH_NOF_LSTART;lstart++) {
+      for (uint32_t sf_idx=0;sf_idx<SRSLTE_NSUBFRAMES_X_FRAME;sf_idx++) {
+        bzero(&grant, sizeof(srslte_ra_dl_grant_t));
+        for (uint32_t n=0;n<cell.nof_prb;n++) {
+          grant.prb_idx[0][n] = n == 0 || trial == 0 || rand()%2; 
+          grant.prb_idx[1][n] = n == 0 || trial == 0 || (trial == 1?grant.prb_idx[0][n]:rand()%2); 
+        }
+        
+        int n0 = srslte_pdsch_cp(&pdsch, sf_symbols[0], symbols[0], &grant, lstart, sf_idx, false);
+        int n1 = srslte_pdsch_get(&pdsch, sf_symbols[0], symbols[1], &grant, lstart, sf_idx);
+        if (n0 != n1 || memcmp(symbols[0], symbols[1], sizeof(cf_t)*n0)) {
+          fprintf(stderr, "Get mismatch: nof_prb=%d, nof_ports=%d, id=%d, cp=%s, lstart=%d, sf_idx=%d (%d/%d RE)\n", 
+                  cell.nof_prb, cell.nof_ports, cell.id, SRSLTE_CP_ISNORM(cell.cp)?"norm":"ext", lstart, sf_idx, n0, n1);
+          goto clean_exit; 
+        }
+        
+        bzero(sf_symbols[1], sizeof(cf_t)*sf_len);
+        bzero(symbols[1], sizeof(cf_t)*sf_len);
+        n0 = srslte_pdsch_cp(&pdsch, symbols[0], sf_symbols[1], &grant, lstart, sf_idx, true);
+        n1 = srslte_pdsch_put(&pdsch, symbols[0], symbols[1], &grant, lstart, sf_idx);
+        if (n0 != n1 || memcmp(sf_symbols[1], symbols[1], sizeof(cf_t)*sf_len)) {
+          fprintf(stderr, "Put mismatch: nof_prb=%d, nof_ports=%d, id=%d, cp=%s, lstart=%d, sf_idx=%d (%d/%d RE)\n", 
+                  cell.nof_prb, cell.nof_ports, cell.id, SRSLTE_CP_ISNORM(cell.cp)?"norm":"ext", lstart, sf_idx, n0, n1);
+          goto clean_exit; 
+        }
+      }
+    }
+  }
+  ret = 0; 
+  
+clean_exit:
+  srslte_pdsch_free(&pdsch);
+  return ret; 
+}
+
+/* Average time to get all the PDSCH REs of a subframe, over the 10 subframes of a frame */
+float bench(srslte_pdsch_t *pdsch, srslte_ra_dl_grant_t *grant, bool use_map) 
+{
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  for (uint32_t trial=0;trial<nof_trials;trial++) {
+    for (uint32_t sf_idx=0;sf_idx<SRSLTE_NSUBFRAMES_X_FRAME;sf_idx++) {
+      if (use_map) {
+        srslte_pdsch_get(pdsch, sf_symbols[0], symbols[0], grant, 2, sf_idx);
+      } else {
+        srslte_pdsch_cp(pdsch, sf_symbols[0], symbols[0], grant, 2, sf_idx, false);
+      }
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  return (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_trials/SRSLTE_NSUBFRAMES_X_FRAME;
+}
+
+int main(int argc, char **argv) {
+  const uint32_t nof_prb[6] = {6, 15, 25, 50, 75, 100};
+  const uint32_t nof_ports[3] = {1, 2, 4};
+  srslte_cell_t cell; 
+  
+  parse_args(argc,argv);
+  
+  bzero(&cell, sizeof(srslte_cell_t));
+  for (uint32_t i=0;i<6;i++) {
+    for (uint32_t j=0;j<3;j++) {
+      for (uint32_t cp=0;cp<2;cp++) {
+        cell.nof_prb   = nof_prb[i]; 
+        cell.nof_ports = nof_ports[j];
+        cell.id        = rand()%504; 
+        cell.cp        = cp?SRSLTE_CP_EXT:SRSLTE_CP_NORM; 
+        if (test_cell(cell)) {
+          printf("Error\n");
+          exit(-1);
+        }
+      }
+    }
+  }
+  printf("RE map matches srslte_pdsch_cp() for all cells\n");
+  
+  if (nof_trials) {
+    srslte_pdsch_t pdsch; 
+    srslte_ra_dl_grant_t grant; 
+    
+    cell.nof_prb   = nof_prb_bench; 
+    cell.nof_ports = 2; 
+    cell.id        = 1; 
+    cell.cp        = SRSLTE_CP_NORM; 
+    if (srslte_pdsch_init(&pdsch, cell)) {
+      fprintf(stderr, "Error creating PDSCH object\n");
+      exit(-1);
+    }
+    bzero(&grant, sizeof(srslte_ra_dl_grant_t));
+    for (uint32_t n=0;n<cell.nof_prb;n++) {
+      grant.prb_idx[0][n] = true; 
+      grant.prb_idx[1][n] = true; 
+    }
+    float t_cp  = bench(&pdsch, &grant, false); 
+    float t_map = bench(&pdsch, &grant, true); 
+    printf("Full allocation, %d PRB: srslte_pdsch_cp %.2f us, RE map %.2f us per subframe\n", cell.nof_prb, t_cp, t_map);
+    
+    /* Type 0 allocation of every other RBG */
+    uint32_t P = srslte_ra_type0_P(cell.nof_prb);
+    for (uint32_t n=0;n<cell.nof_prb;n++) {
+      grant.prb_idx[0][n] = (n/P)%2 == 0; 
+      grant.prb_idx[1][n] = (n/P)%2 == 0; 
+    }
+    t_cp  = bench(&pdsch, &grant, false); 
+    t_map = bench(&pdsch, &grant, true); 
+    printf("Every other RBG, %d PRB: srslte_pdsch_cp %.2f us, RE map %.2f us per subframe\n", cell.nof_prb, t_cp, t_map);
+    srslte_pdsch_free(&pdsch);
+  }
+  
+  printf("Ok\n");
+  exit(0);
+}
@@ -50,10 +50,18 @@ uint32_t mcs = 0;
 uint32_t subframe = 1;
 uint32_t rv_idx = 0;
 uint16_t rnti = 1234; 
+uint32_t nof_dec_threads = 0; 
+uint32_t nof_repetitions = 1; 
+bool test_adaptive = false; 
+bool test_iov = false; 
 char *input_file = NULL; 
+char *mimo_type_name = NULL; 
+uint32_t nof_layers = 2; 
+uint32_t codebook_idx = 1; 
+uint32_t nof_cw = 2; 
 
 void usage(char *prog) {
-  printf("Usage: %s [fmcsrRFpnv] \n", prog);
+  printf("Usage: %s [fmcsrRFpntNAIMlxwv] \n", prog);
   printf("\t-f read signal from file [Default generate it with pdsch_encode()]\n");
   printf("\t-m MCS [Default %d]\n", mcs);
   printf("\t-c cell id [Default %d]\n", cell.id);
@@ -63,12 +71,20 @@ void usage(char *prog) {
   printf("\t-F cfi [Default %d]\n", cfi);
   printf("\t-p cell.nof_ports [Default %d]\n", cell.nof_ports);
   printf("\t-n cell.nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-t number of code block decoder threads [Default %d]\n", nof_dec_threads);
+  printf("\t-N number of repetitions to measure encode/decode time [Default %d]\n", nof_repetitions);
+  printf("\t-A test the adaptive turbo iteration policy [Default disabled]\n");
+  printf("\t-I encode the transport block split in random segments [Default disabled]\n");
+  printf("\t-M test spatial multiplexing with [multiplex|cdd] and one receive antenna per port [Default disabled]\n");
+  printf("\t-l number of layers for -M [Default %d]\n", nof_layers);
+  printf("\t-x codebook index for -M multiplex [Default %d]\n", codebook_idx);
+  printf("\t-w number of codewords for -M [Default %d]\n", nof_cw);
   printf("\t-v [set srslte_verbose to debug, default none]\n");
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "fmcsrRFpnv")) != -1) {
+  while ((opt = getopt(argc, argv, "fmcsrRFpntNAIMlxwv")) != -1) {
     switch(opt) {
     case 'f':
       input_file = argv[optind];
@@ -97,6 +113,30 @@ void parse_args(int argc, char **argv) {
     case 'c':
       cell.id = atoi(argv[optind]);
       break;
+    case 't':
+      nof_dec_threads = atoi(argv[optind]);
+      break;
+    case 'N':
+      nof_repetitions = atoi(argv[optind]);
+      break;
+    case 'A':
+      test_adaptive = true;
+      break;
+    case 'I':
+      test_iov = true;
+      break;
+    case 'M':
+      mimo_type_name = argv[optind];
+      break;
+    case 'l':
+      nof_layers = atoi(argv[optind]);
+      break;
+    case 'x':
+      codebook_idx = atoi(argv[optind]);
+      break;
+    case 'w':
+      nof_cw = atoi(argv[optind]);
+      break;
     case 'v':
       srslte_verbose++;
       break;
@@ -108,6 +148,31 @@ void parse_args(int argc, char **argv) {
 }
 
 uint8_t *data = NULL;
+
+/* Splits the transport block in segments of random length, as MAC headers and SDU slices */
+void split_tb(srslte_tb_iov_t *tb, uint8_t *ptr, uint32_t nbytes) {
+  uint32_t min_len = nbytes/(SRSLTE_TB_IOV_MAX_SEGMENTS/2) + 1; 
+  srslte_tb_iov_reset(tb);
+  while (nbytes > 0) {
+    uint32_t n = SRSLTE_MIN(nbytes, min_len + rand()%min_len);
+    if (tb->nof_segments == SRSLTE_TB_IOV_MAX_SEGMENTS - 1) {
+      n = nbytes; 
+    }
+    srslte_tb_iov_add(tb, ptr, n);
+    ptr    += n; 
+    nbytes -= n; 
+  }
+}
+
+int encode(srslte_pdsch_t *q, srslte_pdsch_cfg_t *cfg, srslte_softbuffer_tx_t *softbuffer, 
+           uint8_t *data, cf_t *symbols[SRSLTE_MAX_PORTS]) {
+  if (test_iov) {
+    srslte_tb_iov_t tb; 
+    split_tb(&tb, data, cfg->grant.mcs.tbs/8);
+    return srslte_pdsch_encode_iov(q, cfg, softbuffer, &tb, rnti, symbols);
+  } 
+  return srslte_pdsch_encode(q, cfg, softbuffer, data, rnti, symbols);
+}
 cf_t *ce[SRSLTE_MAX_PORTS];
 srslte_softbuffer_rx_t softbuffer_rx;
 srslte_ra_dl_grant_t grant; 
@@ -117,6 +182,241 @@ cf_t *slot_symbols[SRSLTE_MAX_PORTS];
 srslte_pdsch_t pdsch;
 srslte_ofdm_t ofdm_tx, ofdm_rx; 
 
+/* The adaptive policy runs on a clock that stands still, so that the time left to the deadline 
+ * only depends on the decoding cost set by the test and not on the load of the machine */
+#define ADAPTIVE_COST_USEC_PER_KBIT 10.0
+
+struct timespec adaptive_now = {1000, 0};
+
+void adaptive_clock(struct timespec *now) {
+  *now = adaptive_now;
+}
+
+/* Decodes with the adaptive iteration policy given a linear SNR and the time left to the deadline 
+ * and returns the policy counters */
+int decode_adaptive(float snr, int deadline_usec, srslte_sch_adapt_stats_t *stats) {
+  struct timespec deadline = adaptive_now; 
+  deadline.tv_sec  += deadline_usec/1000000;
+  deadline.tv_nsec += (long) (deadline_usec%1000000)*1000;
+  
+  srslte_sch_set_adaptive_clock(&pdsch.dl_sch, adaptive_clock);
+  srslte_sch_set_snr(&pdsch.dl_sch, snr);
+  srslte_sch_set_deadline(&pdsch.dl_sch, &deadline);
+  srslte_sch_reset_adaptive_stats(&pdsch.dl_sch);
+  pdsch.dl_sch.adapt.usec_per_kbit = ADAPTIVE_COST_USEC_PER_KBIT;
+  srslte_softbuffer_rx_reset_tbs(&softbuffer_rx, grant.mcs.tbs);    
+  int r = srslte_pdsch_decode(&pdsch, &pdsch_cfg, &softbuffer_rx, slot_symbols[0], ce, 0, rnti, data);
+  srslte_sch_adaptive_stats(&pdsch.dl_sch, stats);
+  
+  printf("ADAPTIVE snr=%8.2f, deadline=%7d us: %s, cb=%d, iterations=%d, capped_sinr=%d, "
+         "capped_deadline=%d, abandoned=%d, cost=%.2f us/kbit\n", 
+         snr, deadline_usec, r?"Error":"OK", (int) stats->nof_cb, (int) stats->nof_iterations, 
+         (int) stats->nof_cb_capped_sinr, (int) stats->nof_cb_capped_deadline, (int) stats->nof_cb_abandoned, 
+         pdsch.dl_sch.adapt.usec_per_kbit);
+  return r; 
+}
+
+/* Checks that srslte_pdsch_cfg_mimo() only accepts the codeword to layer mappings of 36.211 Table 6.3.3.2-1 
+ * and that srslte_pdsch_cfg_mimo_dci() maps the DCI precoding information to layers and codebook */
+int test_layer_mapping(srslte_mimo_type_t type) {
+  srslte_pdsch_cfg_t cfg; 
+  srslte_ra_dl_dci_t dci;
+  srslte_ra_dl_grant_t g; 
+  
+  bzero(&dci, sizeof(srslte_ra_dl_dci_t));
+  dci.mcs_idx = mcs;
+  dci.mcs_idx_1 = mcs;
+  dci.type0_alloc.rbg_bitmask = 0xffffffff;
+  for (uint32_t w=1;w<=2;w++) {
+    dci.tb_en[0] = true; 
+    dci.tb_en[1] = w==2; 
+    if (srslte_ra_dl_dci_to_grant(&dci, cell.nof_prb, rnti, &g)) {
+      return -1;
+    }
+    for (uint32_t l=1;l<=cell.nof_ports;l++) {
+      bzero(&cfg, sizeof(srslte_pdsch_cfg_t));
+      bool valid = w==1?(l==1 || (l==2 && cell.nof_ports==4)):l>=2; 
+      if (srslte_pdsch_cfg(&cfg, cell, &g, cfi, subframe, rv_idx)) {
+        return -1; 
+      }
+      if ((srslte_pdsch_cfg_mimo(&cfg, cell, type, l, codebook_idx, rv_idx) == SRSLTE_SUCCESS) != valid) {
+        fprintf(stderr, "%d codewords on %d layers with %d ports should be %s\n", w, l, cell.nof_ports, 
+                valid?"accepted":"rejected");
+        return -1; 
+      }
+    }
+  }
+  
+  /* Format 2 with 2 ports: 1 layer TPMI=3 and 2 layers TPMI=1. With 4 ports: 2 layers TPMI=5 on one 
+   * codeword and 3 layers TPMI=7 on two codewords */
+  for (uint32_t w=1;w<=2;w++) {
+    dci.tb_en[1] = w==2; 
+    dci.pinfo = cell.nof_ports==2?(w==1?4:1):(w==1?23:24); 
+    uint32_t exp_layers = cell.nof_ports==2?w:w+1; 
+    uint32_t exp_cb = cell.nof_ports==2?(w==1?3:2):(w==1?5:7); 
+    bzero(&cfg, sizeof(srslte_pdsch_cfg_t));
+    if (srslte_ra_dl_dci_to_grant(&dci, cell.nof_prb, rnti, &g) || 
+        srslte_pdsch_cfg(&cfg, cell, &g, cfi, subframe, rv_idx) || 
+        srslte_pdsch_cfg_mimo_dci(&cfg, cell, SRSLTE_DCI_FORMAT2, &dci, 0) || 
+        cfg.mimo_type != SRSLTE_MIMO_TYPE_SPATIAL_MULTIPLEX || cfg.nof_cw != w || 
+        cfg.nof_layers != exp_layers || cfg.codebook_idx != exp_cb) 
+    {
+      fprintf(stderr, "Error mapping Format2 pinfo=%d with %d codewords\n", dci.pinfo, w);
+      return -1; 
+    }
+  }
+  return 0; 
+}
+
+/* Encodes one or two codewords with spatial multiplexing or CDD, passes them through a random flat channel 
+ * with one receive antenna per port and checks that all transport blocks are decoded */
+int test_multiplex(srslte_mimo_type_t type) {
+  srslte_pdsch_t pdsch_tx, pdsch_rx; 
+  srslte_pdsch_cfg_t cfg; 
+  srslte_softbuffer_tx_t sb_tx[SRSLTE_MAX_CODEWORDS]; 
+  srslte_softbuffer_rx_t sb_rx[SRSLTE_MAX_CODEWORDS]; 
+  srslte_softbuffer_tx_t *sb_tx_ptr[SRSLTE_MAX_CODEWORDS] = {NULL, NULL}; 
+  srslte_softbuffer_rx_t *sb_rx_ptr[SRSLTE_MAX_CODEWORDS] = {NULL, NULL}; 
+  uint8_t *tx_data[SRSLTE_MAX_CODEWORDS], *rx_data[SRSLTE_MAX_CODEWORDS]; 
+  cf_t *tx_symbols[SRSLTE_MAX_PORTS], *rx_symbols[SRSLTE_MAX_PORTS]; 
+  cf_t *h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS]; 
+  bool acks[SRSLTE_MAX_CODEWORDS] = {false, false}; 
+  uint32_t nof_re = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp); 
+  uint32_t p, r, i, ri = 0, pmi = 0; 
+  int ret = -1; 
+  
+  bzero(&pdsch_tx, sizeof(srslte_pdsch_t));
+  bzero(&pdsch_rx, sizeof(srslte_pdsch_t));
+  bzero(&cfg, sizeof(srslte_pdsch_cfg_t));
+  bzero(sb_tx, sizeof(sb_tx));
+  bzero(sb_rx, sizeof(sb_rx));
+  bzero(tx_data, sizeof(tx_data));
+  bzero(rx_data, sizeof(rx_data));
+  bzero(tx_symbols, sizeof(tx_symbols));
+  bzero(rx_symbols, sizeof(rx_symbols));
+  bzero(h, sizeof(h));
+  
+  srslte_ra_dl_dci_t dci;
+  bzero(&dci, sizeof(srslte_ra_dl_dci_t));
+  dci.mcs_idx = mcs;
+  dci.mcs_idx_1 = mcs;
+  dci.type0_alloc.rbg_bitmask = 0xffffffff;
+  dci.tb_en[0] = true; 
+  dci.tb_en[1] = nof_cw > 1; 
+  if (srslte_ra_dl_dci_to_grant(&dci, cell.nof_prb, rnti, &grant)) {
+    fprintf(stderr, "Error computing resource allocation\n");
+    return ret;
+  }
+  if (test_layer_mapping(type)) {
+    return ret; 
+  }
+  if (srslte_pdsch_cfg(&cfg, cell, &grant, cfi, subframe, rv_idx) || 
+      srslte_pdsch_cfg_mimo(&cfg, cell, type, nof_layers, codebook_idx, rv_idx) || cfg.nof_cw != nof_cw) {
+    fprintf(stderr, "Error configuring PDSCH\n");
+    return ret;
+  }
+  if (srslte_pdsch_init(&pdsch_tx, cell) || srslte_pdsch_init_multi(&pdsch_rx, cell, cell.nof_ports)) {
+    fprintf(stderr, "Error creating PDSCH object\n");
+    goto quit_multiplex;
+  }
+  srslte_pdsch_set_ri_pmi_report(&pdsch_rx, true, cell.nof_ports);
+  
+  for (i=0;i<nof_cw;i++) {
+    uint32_t tbs = i==0?grant.mcs.tbs:grant.mcs2.tbs; 
+    tx_data[i] = srslte_vec_malloc(tbs/8);
+    rx_data[i] = srslte_vec_malloc(tbs/8);
+    if (!tx_data[i] || !rx_data[i] || 
+        srslte_softbuffer_tx_init(&sb_tx[i], cell.nof_prb) || srslte_softbuffer_rx_init(&sb_rx[i], cell.nof_prb)) {
+      fprintf(stderr, "Error allocating codeword %d\n", i);
+      goto quit_multiplex;
+    }
+    for (uint32_t k=0;k<tbs/8;k++) {
+      tx_data[i][k] = rand()%256;
+    }
+    srslte_softbuffer_rx_reset_tbs(&sb_rx[i], tbs);    
+    sb_tx_ptr[i] = &sb_tx[i]; 
+    sb_rx_ptr[i] = &sb_rx[i]; 
+  }
+  for (p=0;p<cell.nof_ports;p++) {
+    tx_symbols[p] = srslte_vec_malloc(sizeof(cf_t)*nof_re);
+    rx_symbols[p] = srslte_vec_malloc(sizeof(cf_t)*nof_re);
+    if (!tx_symbols[p] || !rx_symbols[p]) {
+      perror("srslte_vec_malloc");
+      goto quit_multiplex;
+    }
+    bzero(tx_symbols[p], sizeof(cf_t)*nof_re);
+    for (r=0;r<cell.nof_ports;r++) {
+      h[p][r] = srslte_vec_malloc(sizeof(cf_t)*nof_re);
+      if (!h[p][r]) {
+        perror("srslte_vec_malloc");
+        goto quit_multiplex;
+      }
+      cf_t hpr = ((float) rand()/RAND_MAX-0.5)+((float) rand()/RAND_MAX-0.5)*_Complex_I + (p==r?1:0); 
+      for (i=0;i<nof_re;i++) {
+        h[p][r][i] = hpr; 
+      }
+    }
+  }
+  
+  if (srslte_pdsch_encode_multi(&pdsch_tx, &cfg, sb_tx_ptr, tx_data, rnti, tx_symbols)) {
+    fprintf(stderr, "Error encoding PDSCH\n");
+    goto quit_multiplex;
+  }
+  for (r=0;r<cell.nof_ports;r++) {
+    for (i=0;i<nof_re;i++) {
+      cf_t v = 0; 
+      for (p=0;p<cell.nof_ports;p++) {
+        v += h[p][r][i]*tx_symbols[p][i]; 
+      }
+      rx_symbols[r][i] = v; 
+    }
+  }
+  
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  int res = srslte_pdsch_decode_multi_cw(&pdsch_rx, &cfg, sb_rx_ptr, rx_symbols, h, 0, rnti, rx_data, acks);
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  srslte_pdsch_last_ri_pmi(&pdsch_rx, &ri, &pmi);
+  printf("DECODED %s with %d layers in %d us, TBS=%d+%d, acks=%d,%d, RI=%d, PMI=%d\n", 
+         res?"Error":"OK", cfg.nof_layers, (int) t[0].tv_usec, grant.mcs.tbs, grant.mcs2.tbs, acks[0], acks[1], ri, pmi);
+  
+  if (res || !acks[0] || (nof_cw > 1 && !acks[1]) || ri < 1 || ri > cell.nof_ports ||
+      memcmp(tx_data[0], rx_data[0], grant.mcs.tbs/8) || 
+      (nof_cw > 1 && memcmp(tx_data[1], rx_data[1], grant.mcs2.tbs/8))) {
+    goto quit_multiplex;
+  }
+  ret = 0; 
+  
+quit_multiplex:
+  srslte_pdsch_free(&pdsch_tx);
+  srslte_pdsch_free(&pdsch_rx);
+  for (i=0;i<SRSLTE_MAX_CODEWORDS;i++) {
+    srslte_softbuffer_tx_free(&sb_tx[i]);
+    srslte_softbuffer_rx_free(&sb_rx[i]);
+    if (tx_data[i]) {
+      free(tx_data[i]);
+    }
+    if (rx_data[i]) {
+      free(rx_data[i]);
+    }
+  }
+  for (p=0;p<cell.nof_ports;p++) {
+    if (tx_symbols[p]) {
+      free(tx_symbols[p]);
+    }
+    if (rx_symbols[p]) {
+      free(rx_symbols[p]);
+    }
+    for (r=0;r<cell.nof_ports;r++) {
+      if (h[p][r]) {
+        free(h[p][r]);
+      }
+    }
+  }
+  return ret; 
+}
+
 int main(int argc, char **argv) {
   uint32_t i, j;
   int ret = -1;
@@ -125,6 +425,17 @@ int main(int argc, char **argv) {
   
   parse_args(argc,argv);
 
+  if (mimo_type_name) {
+    srslte_mimo_type_t type; 
+    if (srslte_str2mimotype(mimo_type_name, &type)) {
+      fprintf(stderr, "Invalid MIMO type %s\n", mimo_type_name);
+      exit(-1);
+    }
+    ret = test_multiplex(type); 
+    printf("%s\n", ret?"Error":"Ok");
+    exit(ret);
+  }
+
   bzero(&pdsch, sizeof(srslte_pdsch_t));
   bzero(&pdsch_cfg, sizeof(srslte_pdsch_cfg_t));
   bzero(ce, sizeof(cf_t*)*SRSLTE_MAX_PORTS);
@@ -229,17 +540,25 @@ int main(int argc, char **argv) {
       if (rv_idx) {
         /* Do 1st transmission for rv_idx!=0 */
         pdsch_cfg.rv = 0;
-        if (srslte_pdsch_encode(&pdsch, &pdsch_cfg, &softbuffer_tx, data, rnti, slot_symbols)) {
+        if (encode(&pdsch, &pdsch_cfg, &softbuffer_tx, data, slot_symbols)) {
           fprintf(stderr, "Error encoding PDSCH\n");
           goto quit;
         }
       }
       pdsch_cfg.rv = rv_idx; 
       
-      if (srslte_pdsch_encode(&pdsch, &pdsch_cfg, &softbuffer_tx, data, rnti, slot_symbols)) {
-        fprintf(stderr, "Error encoding PDSCH\n");
-        goto quit;
+      gettimeofday(&t[1], NULL);
+      for (i=0;i<nof_repetitions;i++) {
+        if (encode(&pdsch, &pdsch_cfg, &softbuffer_tx, data, slot_symbols)) {
+          fprintf(stderr, "Error encoding PDSCH\n");
+          goto quit;
+        }
       }
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      float usec = (float) (t[0].tv_sec*1000000 + t[0].tv_usec)/nof_repetitions; 
+      printf("ENCODED in %.2f usec (%.1f kPRB/s, %.2f Mbps)\n", 
+             usec, (float) 1000*cell.nof_prb/usec, (float) grant.mcs.tbs/usec);
     }
     
     /* combine outputs */
@@ -256,9 +575,13 @@ int main(int argc, char **argv) {
     srslte_ofdm_tx_sf(&ofdm_tx, slot_symbols[0], sf_symbols);
   #endif
   } 
-  int M=1;
+  int M=nof_repetitions;
   int r=0; 
   srslte_sch_set_max_noi(&pdsch.dl_sch, 10);
+  if (srslte_sch_set_decoder_threads(&pdsch.dl_sch, nof_dec_threads)) {
+    fprintf(stderr, "Error setting decoder threads\n");
+    goto quit;
+  }
   gettimeofday(&t[1], NULL);
   for (i=0;i<M;i++) {
   #ifdef DO_OFDM
@@ -275,6 +598,57 @@ int main(int argc, char **argv) {
     ret = -1;
     goto quit;
   } 
+  
+  /* All code blocks must have passed the CRC */
+  if (srslte_sch_last_cb_crc(&pdsch.dl_sch) != (((uint64_t) 1)<<pdsch_cfg.cb_segm.C) - 1) {
+    fprintf(stderr, "Error in code block CRC bitmap 0x%llx\n", 
+            (unsigned long long) srslte_sch_last_cb_crc(&pdsch.dl_sch));
+    ret = -1;
+    goto quit;
+  }
+
+  if (test_adaptive) {
+    srslte_sch_adapt_stats_t stats; 
+    uint32_t C = pdsch_cfg.cb_segm.C; 
+    srslte_sch_set_adaptive_noi(&pdsch.dl_sch, true, 1, 3.0);
+    
+    /* Good SINR and plenty of time: all code blocks decoded without limits */
+    if (decode_adaptive(1e4, 1000000, &stats) || stats.nof_cb != C || stats.nof_cb_capped_sinr || 
+        stats.nof_cb_capped_deadline || stats.nof_cb_abandoned) {
+      fprintf(stderr, "Error adaptive decoding with good SINR\n");
+      ret = -1;
+      goto quit;
+    }
+    
+    /* No SNR estimate: the SINR does not limit the iterations */
+    if (decode_adaptive(0.0, 1000000, &stats) || stats.nof_cb != C || stats.nof_cb_capped_sinr) {
+      fprintf(stderr, "Error adaptive decoding without SNR estimate\n");
+      ret = -1;
+      goto quit;
+    }
+    
+    /* Hopeless SINR: code blocks are given a single iteration */
+    decode_adaptive(1e-2, 1000000, &stats);
+    if (stats.nof_cb == 0 || stats.nof_cb_capped_sinr != stats.nof_cb || stats.nof_iterations != stats.nof_cb) {
+      fprintf(stderr, "Error adaptive decoding with low SINR\n");
+      ret = -1;
+      goto quit;
+    }
+    
+    /* Less time left than one iteration of all code blocks takes at the set cost */
+    if (!decode_adaptive(1e4, 50, &stats) || stats.nof_cb_abandoned != 1 || stats.nof_iterations) {
+      fprintf(stderr, "Error adaptive decoding with a short deadline\n");
+      ret = -1;
+      goto quit;
+    }
+    
+    /* Deadline already passed: nothing is decoded */
+    if (!decode_adaptive(1e4, -1000, &stats) || stats.nof_cb_abandoned != 1 || stats.nof_iterations) {
+      fprintf(stderr, "Error adaptive decoding after the deadline\n");
+      ret = -1;
+      goto quit;
+    }
+  }
 
   ret = 0;
 quit:
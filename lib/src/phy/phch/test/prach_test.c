@@ -114,9 +114,23 @@ int main(int argc, char **argv) {
     srslte_prach_detect(p, frequency_offset, &preamble[p->N_cp], prach_len, indices, &n_indices);
     gettimeofday(&t[2], NULL);
     get_time_interval(t);
-    printf("texec=%ld us\n", t[0].tv_usec);
+    printf("texec=%ld us", t[0].tv_usec);
     if(n_indices != 1 || indices[0] != seq_index)
       return -1;
+
+    // Same detection with the full size FFT
+    if (p->dec_enabled) {
+      srslte_prach_set_frontend(p, false);
+      gettimeofday(&t[1], NULL);
+      srslte_prach_detect(p, frequency_offset, &preamble[p->N_cp], prach_len, indices, &n_indices);
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      srslte_prach_set_frontend(p, true);
+      printf(", without front-end texec=%ld us", t[0].tv_usec);
+      if(n_indices != 1 || indices[0] != seq_index)
+        return -1;
+    }
+    printf("\n");
   }
 
   srslte_prach_free(p);
@@ -0,0 +1,328 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <complex.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include "srslte/srslte.h"
+
+srslte_cell_t cell = {
+  25,           // nof_prb
+  1,            // nof_ports
+  1,            // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1_6,          // PHICH resources      
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t subframe = 3;
+uint32_t nof_ue_f1 = 40; 
+uint32_t nof_ue_f2 = 6; 
+uint32_t nof_trials = 0; 
+bool group_hopping_en = false; 
+float noise_var = 0.01; 
+
+#define MAX_UE 128 
+
+void usage(char *prog) {
+  printf("Usage: %s [csnuqgtv]\n", prog);
+  printf("\t-c cell id [Default %d]\n", cell.id);
+  printf("\t-s subframe [Default %d]\n", subframe);
+  printf("\t-n nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-u number of format 1/1a/1b users [Default %d]\n", nof_ue_f1);
+  printf("\t-q number of format 2/2a/2b users [Default %d]\n", nof_ue_f2);
+  printf("\t-g enable group hopping [Default %s]\n", group_hopping_en?"yes":"no");
+  printf("\t-t number of trials to time the serial and joint detectors [Default %d]\n", nof_trials);
+  printf("\t-v [set verbose to debug, default none]\n");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "csnuqgtv")) != -1) {
+    switch(opt) {
+    case 'c':
+      cell.id = atoi(argv[optind]);
+      break;
+    case 's':
+      subframe = atoi(argv[optind]);
+      break;
+    case 'n':
+      cell.nof_prb = atoi(argv[optind]);
+      break;
+    case 'u':
+      nof_ue_f1 = atoi(argv[optind]);
+      break;
+    case 'q':
+      nof_ue_f2 = atoi(argv[optind]);
+      break;
+    case 'g':
+      group_hopping_en = true;
+      break;
+    case 't':
+      nof_trials = atoi(argv[optind]);
+      break;
+    case 'v':
+      srslte_verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+/* Transmitted UCI of each user. Format 1 users with odd index do not send SR */
+typedef struct {
+  srslte_pucch_format_t format; 
+  uint32_t n_pucch; 
+  bool     present; 
+  uint8_t  cqi[4]; 
+  uint8_t  ack[2]; 
+} ue_tx_t; 
+
+ue_tx_t ue_tx[MAX_UE]; 
+srslte_pucch_rx_t rx[MAX_UE]; 
+srslte_pucch_rx_t rx_timed[MAX_UE]; 
+
+static uint16_t ue_rnti(uint32_t i) {
+  return 0x46 + i; 
+}
+
+/* Returns true if the decoded bits of user i match the transmitted ones */
+static bool check_bits(uint32_t i, int ret, uint8_t *bits) {
+  ue_tx_t *ue = &ue_tx[i];
+  switch(ue->format) {
+    case SRSLTE_PUCCH_FORMAT_1:
+      return ret == (ue->present?1:0);
+    case SRSLTE_PUCCH_FORMAT_1A:
+      return ret == 1 && bits[0] == ue->ack[0]; 
+    case SRSLTE_PUCCH_FORMAT_1B:
+      return ret == 1 && bits[0] == ue->ack[0] && bits[1] == ue->ack[1]; 
+    case SRSLTE_PUCCH_FORMAT_2:
+      return ret == 1 && !memcmp(bits, ue->cqi, 4); 
+    case SRSLTE_PUCCH_FORMAT_2A:
+      return ret == 1 && !memcmp(bits, ue->cqi, 4) && bits[20] == ue->ack[0]; 
+    case SRSLTE_PUCCH_FORMAT_2B:
+      return ret == 1 && !memcmp(bits, ue->cqi, 4) && bits[20] == ue->ack[0] && bits[21] == ue->ack[1]; 
+    default:
+      return false; 
+  }
+}
+
+int main(int argc, char **argv) {
+  srslte_pucch_t pucch;
+  srslte_pucch_cfg_t pucch_cfg;
+  srslte_refsignal_ul_t dmrs;
+  srslte_chest_ul_t chest; 
+  cf_t *sf_symbols = NULL;
+  cf_t *ue_symbols = NULL; 
+  cf_t *ce = NULL; 
+  cf_t pucch_dmrs[2*SRSLTE_NRE*3];
+  uint8_t bits[SRSLTE_PUCCH_MAX_BITS];
+  int ret = -1;
+  struct timeval t[3];
+  
+  parse_args(argc,argv);
+  
+  uint32_t nof_ue = nof_ue_f1 + nof_ue_f2; 
+  uint32_t sf_len = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp); 
+  if (nof_ue > MAX_UE) {
+    fprintf(stderr, "Too many users\n");
+    exit(-1);
+  }
+  
+  bzero(&pucch, sizeof(srslte_pucch_t));
+  bzero(&dmrs, sizeof(srslte_refsignal_ul_t));
+  bzero(&chest, sizeof(srslte_chest_ul_t));
+  
+  if (srslte_pucch_init(&pucch, cell)) {
+    fprintf(stderr, "Error creating PUCCH object\n");
+    goto quit; 
+  }
+  if (srslte_refsignal_ul_init(&dmrs, cell)) {
+    fprintf(stderr, "Error creating DMRS object\n");
+    goto quit; 
+  }
+  if (srslte_chest_ul_init(&chest, cell)) {
+    fprintf(stderr, "Error creating UL channel estimator\n");
+    goto quit; 
+  }
+  
+  /* Format 2 resources in the first n_rb_2 PRB pairs, format 1 resources after them */
+  bzero(&pucch_cfg, sizeof(srslte_pucch_cfg_t));
+  pucch_cfg.delta_pucch_shift = 1; 
+  pucch_cfg.N_cs = 0; 
+  pucch_cfg.n_rb_2 = SRSLTE_MAX(1, (2*nof_ue_f2+SRSLTE_NRE-1)/SRSLTE_NRE); 
+  if (!srslte_pucch_set_cfg(&pucch, &pucch_cfg, group_hopping_en)) {
+    fprintf(stderr, "Error setting PUCCH config\n");
+    goto quit; 
+  }
+  srslte_pucch_set_threshold(&pucch, 0.5, 0.5);
+  
+  srslte_refsignal_dmrs_pusch_cfg_t pusch_cfg; 
+  bzero(&pusch_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  pusch_cfg.group_hopping_en = group_hopping_en; 
+  srslte_refsignal_ul_set_cfg(&dmrs, &pusch_cfg, &pucch_cfg, NULL);
+  srslte_chest_ul_set_cfg(&chest, &pusch_cfg, &pucch_cfg, NULL);
+  
+  sf_symbols = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  ue_symbols = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  ce = srslte_vec_malloc(sizeof(cf_t) * sf_len);
+  if (!sf_symbols || !ue_symbols || !ce) {
+    perror("malloc");
+    goto quit; 
+  }
+  bzero(sf_symbols, sizeof(cf_t) * sf_len);
+  
+  /* Each user goes through its own flat channel */
+  for (uint32_t i=0;i<nof_ue;i++) {
+    ue_tx_t *ue = &ue_tx[i]; 
+    if (i < nof_ue_f1) {
+      ue->format  = SRSLTE_PUCCH_FORMAT_1 + i%3; 
+      ue->n_pucch = i; 
+      ue->present = ue->format != SRSLTE_PUCCH_FORMAT_1 || (i/3)%2 == 0; 
+    } else {
+      ue->format  = SRSLTE_PUCCH_FORMAT_2 + (i-nof_ue_f1)%3; 
+      ue->n_pucch = 2*(i-nof_ue_f1); 
+      ue->present = true; 
+    }
+    for (uint32_t j=0;j<4;j++) {
+      ue->cqi[j] = rand()%2; 
+    }
+    ue->ack[0] = rand()%2; 
+    ue->ack[1] = rand()%2; 
+    
+    if (srslte_pucch_set_crnti(&pucch, ue_rnti(i))) {
+      fprintf(stderr, "Error setting C-RNTI\n");
+      goto quit; 
+    }
+    
+    if (!ue->present) {
+      continue; 
+    }
+    bzero(bits, sizeof(bits));
+    if (ue->format < SRSLTE_PUCCH_FORMAT_2) {
+      memcpy(bits, ue->ack, 2);
+    } else {
+      srslte_uci_encode_cqi_pucch(ue->cqi, 4, bits);
+    }
+    bzero(ue_symbols, sizeof(cf_t) * sf_len);
+    if (srslte_pucch_encode(&pucch, ue->format, ue->n_pucch, subframe, ue_rnti(i), bits, ue_symbols)) {
+      fprintf(stderr, "Error encoding PUCCH\n");
+      goto quit; 
+    }
+    if (srslte_refsignal_dmrs_pucch_gen(&dmrs, ue->format, ue->n_pucch, subframe, ue->ack, pucch_dmrs)) {
+      fprintf(stderr, "Error generating PUCCH DMRS\n");
+      goto quit; 
+    }
+    if (srslte_refsignal_dmrs_pucch_put(&dmrs, ue->format, ue->n_pucch, pucch_dmrs, ue_symbols)) {
+      fprintf(stderr, "Error putting PUCCH DMRS\n");
+      goto quit; 
+    }
+    cf_t gain = (0.5 + (float) rand()/RAND_MAX)*cexpf(I*2*M_PI*rand()/RAND_MAX); 
+    srslte_vec_sc_prod_ccc(ue_symbols, gain, ue_symbols, sf_len);
+    srslte_vec_sum_ccc(sf_symbols, ue_symbols, sf_symbols, sf_len);
+  }
+  srslte_ch_awgn_c(sf_symbols, sf_symbols, sqrtf(noise_var), sf_len);
+  
+  /* Joint detector */
+  for (uint32_t i=0;i<nof_ue;i++) {
+    bzero(&rx[i], sizeof(srslte_pucch_rx_t));
+    rx[i].format  = ue_tx[i].format; 
+    rx[i].n_pucch = ue_tx[i].n_pucch; 
+    rx[i].rnti    = ue_rnti(i); 
+  }
+  if (srslte_pucch_decode_multi(&pucch, rx, nof_ue, subframe, sf_symbols, noise_var)) {
+    fprintf(stderr, "Error in joint PUCCH detector\n");
+    goto quit; 
+  }
+  uint32_t nof_errors = 0; 
+  for (uint32_t i=0;i<nof_ue;i++) {
+    if (!check_bits(i, rx[i].ret, rx[i].bits)) {
+      fprintf(stderr, "User %d format %d n_pucch=%d: wrong decision (ret=%d, corr=%.2f)\n", 
+              i, ue_tx[i].format, ue_tx[i].n_pucch, rx[i].ret, rx[i].corr);
+      nof_errors++; 
+    }
+  }
+  printf("Joint detector: %d/%d users correct\n", nof_ue-nof_errors, nof_ue);
+  
+  /* The serial decoder only supports format 1 and 1a, so only those users are timed */
+  if (nof_trials) {
+    uint32_t nof_timed = 0; 
+    for (uint32_t i=0;i<nof_ue;i++) {
+      if (ue_tx[i].format == SRSLTE_PUCCH_FORMAT_1 || ue_tx[i].format == SRSLTE_PUCCH_FORMAT_1A) {
+        rx_timed[nof_timed++] = rx[i]; 
+      }
+    }
+    gettimeofday(&t[1], NULL);
+    for (uint32_t n=0;n<nof_trials;n++) {
+      for (uint32_t i=0;i<nof_timed;i++) {
+        srslte_chest_ul_estimate_pucch(&chest, sf_symbols, ce, rx_timed[i].format, rx_timed[i].n_pucch, subframe, NULL);
+        srslte_pucch_decode(&pucch, rx_timed[i].format, rx_timed[i].n_pucch, subframe, rx_timed[i].rnti, sf_symbols, ce, noise_var, bits);
+      }
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    float t_serial = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_trials; 
+    
+    gettimeofday(&t[1], NULL);
+    for (uint32_t n=0;n<nof_trials;n++) {
+      srslte_pucch_decode_multi(&pucch, rx_timed, nof_timed, subframe, sf_symbols, noise_var);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    float t_multi = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_trials; 
+    
+    printf("Subframe with %d format 1/1a users: serial %.1f us, joint %.1f us\n", nof_timed, t_serial, t_multi);
+  }
+  
+  ret = nof_errors?-1:0;
+quit:
+  srslte_pucch_free(&pucch);
+  srslte_refsignal_ul_free(&dmrs);
+  srslte_chest_ul_free(&chest);
+  if (sf_symbols) {
+    free(sf_symbols);
+  }
+  if (ue_symbols) {
+    free(ue_symbols);
+  }
+  if (ce) {
+    free(ce);
+  }
+  if (ret) {
+    printf("Error\n");
+  } else {
+    printf("Ok\n");
+  }
+  exit(ret);
+}
@@ -0,0 +1,350 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "srslte/srslte.h"
+
+srslte_cell_t cell = {
+  100,          // nof_prb
+  1,            // nof_ports
+  1,            // cell_id
+  SRSLTE_CP_NORM,       // cyclic prefix
+  SRSLTE_PHICH_R_1_6,          // PHICH resources      
+  SRSLTE_PHICH_NORM    // PHICH length
+};
+
+uint32_t subframe = 1;
+uint32_t nof_ue = 33; 
+uint32_t mcs_idx = 10; 
+uint32_t nof_trials = 0; 
+
+#define MAX_UE 100 
+
+void usage(char *prog) {
+  printf("Usage: %s [cnsumtv]\n", prog);
+  printf("\t-c cell id [Default %d]\n", cell.id);
+  printf("\t-n cell.nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-s subframe [Default %d]\n", subframe);
+  printf("\t-u number of UL grants [Default %d]\n", nof_ue);
+  printf("\t-m MCS index [Default %d]\n", mcs_idx);
+  printf("\t-t number of trials to time the serial and multiple receivers [Default %d]\n", nof_trials);
+  printf("\t-v [set srslte_verbose to debug, default none]\n");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "cnsumtv")) != -1) {
+    switch(opt) {
+    case 'c':
+      cell.id = atoi(argv[optind]);
+      break;
+    case 'n':
+      cell.nof_prb = atoi(argv[optind]);
+      break;
+    case 's':
+      subframe = atoi(argv[optind]);
+      break;
+    case 'u':
+      nof_ue = atoi(argv[optind]);
+      break;
+    case 'm':
+      mcs_idx = atoi(argv[optind]);
+      break;
+    case 't':
+      nof_trials = atoi(argv[optind]);
+      break;
+    case 'v':
+      srslte_verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+srslte_ra_ul_grant_t    grants[MAX_UE]; 
+srslte_softbuffer_rx_t  softbuffers[MAX_UE]; 
+srslte_uci_data_t       uci_data[MAX_UE]; 
+uint8_t                *data_tx[MAX_UE]; 
+uint8_t                *data_rx[MAX_UE]; 
+srslte_enb_ul_pusch_rx_t rx[MAX_UE]; 
+
+static uint16_t ue_rnti(uint32_t i) {
+  return 0x46 + i; 
+}
+
+static void reset_rx() {
+  for (uint32_t i=0;i<nof_ue;i++) {
+    srslte_softbuffer_rx_reset(&softbuffers[i]);
+    bzero(&uci_data[i], sizeof(srslte_uci_data_t));
+    bzero(data_rx[i], grants[i].mcs.tbs/8+1);
+  }
+}
+
+static int check_rx(const char *name, int *ret) {
+  for (uint32_t i=0;i<nof_ue;i++) {
+    if (ret[i]) {
+      fprintf(stderr, "%s: error decoding grant %d (ret=%d)\n", name, i, ret[i]);
+      return -1; 
+    }
+    if (memcmp(data_tx[i], data_rx[i], grants[i].mcs.tbs/8)) {
+      fprintf(stderr, "%s: data of grant %d differs\n", name, i);
+      return -1; 
+    }
+  }
+  return 0; 
+}
+
+int main(int argc, char **argv) {
+  srslte_pusch_t pusch_tx; 
+  srslte_refsignal_ul_t dmrs; 
+  srslte_enb_ul_t enb_ul; 
+  srslte_softbuffer_tx_t softbuffer_tx; 
+  cf_t *sf_symbols = NULL; 
+  cf_t *dmrs_pusch = NULL; 
+  int ret = -1; 
+  int ret_serial[MAX_UE]; 
+  int ret_multi[MAX_UE]; 
+  struct timeval t[3];
+  
+  parse_args(argc,argv);
+  
+  bzero(&pusch_tx, sizeof(srslte_pusch_t));
+  bzero(&dmrs, sizeof(srslte_refsignal_ul_t));
+  bzero(&enb_ul, sizeof(srslte_enb_ul_t));
+  bzero(&softbuffer_tx, sizeof(srslte_softbuffer_tx_t));
+  bzero(softbuffers, sizeof(softbuffers));
+  
+  /* Split the bandwidth in nof_ue grants of the same number of PRB */
+  uint32_t L_prb = nof_ue?cell.nof_prb/nof_ue:0; 
+  while (L_prb > 0 && !srslte_dft_precoding_valid_prb(L_prb)) {
+    L_prb--;
+  }
+  if (nof_ue == 0 || nof_ue > MAX_UE || L_prb == 0) {
+    fprintf(stderr, "Invalid number of grants %d for %d PRB\n", nof_ue, cell.nof_prb);
+    exit(-1);
+  }
+  
+  srslte_refsignal_dmrs_pusch_cfg_t pusch_cfg; 
+  bzero(&pusch_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  srslte_pucch_cfg_t pucch_cfg; 
+  bzero(&pucch_cfg, sizeof(srslte_pucch_cfg_t));
+  pucch_cfg.delta_pucch_shift = 1; 
+  srslte_pusch_hopping_cfg_t hopping_cfg; 
+  bzero(&hopping_cfg, sizeof(srslte_pusch_hopping_cfg_t));
+  hopping_cfg.n_sb = 1; 
+  
+  if (srslte_pusch_init(&pusch_tx, cell)) {
+    fprintf(stderr, "Error creating PUSCH object\n");
+    goto quit;
+  }
+  if (srslte_refsignal_ul_init(&dmrs, cell)) {
+    fprintf(stderr, "Error creating DMRS object\n");
+    goto quit;
+  }
+  srslte_refsignal_ul_set_cfg(&dmrs, &pusch_cfg, NULL, NULL);
+  if (srslte_enb_ul_init(&enb_ul, cell, NULL, &pusch_cfg, &hopping_cfg, &pucch_cfg)) {
+    fprintf(stderr, "Error creating eNB UL object\n");
+    goto quit;
+  }
+  if (srslte_softbuffer_tx_init(&softbuffer_tx, cell.nof_prb)) {
+    fprintf(stderr, "Error initiating soft buffer\n");
+    goto quit;
+  }
+  
+  sf_symbols = srslte_vec_malloc(sizeof(cf_t) * SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp));
+  dmrs_pusch = srslte_vec_malloc(sizeof(cf_t) * 2*SRSLTE_NRE*cell.nof_prb);
+  if (!sf_symbols || !dmrs_pusch) {
+    perror("malloc");
+    goto quit;
+  }
+  bzero(sf_symbols, sizeof(cf_t) * SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp));
+  
+  /* Transmit all the grants in the same subframe */
+  for (uint32_t i=0;i<nof_ue;i++) {
+    srslte_ra_ul_dci_t dci; 
+    bzero(&dci, sizeof(srslte_ra_ul_dci_t));
+    dci.freq_hop_fl = SRSLTE_RA_PUSCH_HOP_DISABLED;
+    dci.type2_alloc.L_crb = L_prb; 
+    dci.type2_alloc.RB_start = i*L_prb;
+    dci.mcs_idx = mcs_idx; 
+    if (srslte_ra_ul_dci_to_grant(&dci, cell.nof_prb, 0, &grants[i], 0)) {
+      fprintf(stderr, "Error computing resource allocation\n");
+      goto quit;
+    }
+    
+    data_tx[i] = srslte_vec_malloc(grants[i].mcs.tbs/8+1);
+    data_rx[i] = srslte_vec_malloc(grants[i].mcs.tbs/8+1);
+    if (!data_tx[i] || !data_rx[i]) {
+      perror("malloc");
+      goto quit;
+    }
+    for (uint32_t j=0;j<grants[i].mcs.tbs/8;j++) {
+      data_tx[i][j] = rand()%256;
+    }
+    if (srslte_softbuffer_rx_init(&softbuffers[i], cell.nof_prb)) {
+      fprintf(stderr, "Error initiating soft buffer\n");
+      goto quit;
+    }
+    if (srslte_enb_ul_add_rnti(&enb_ul, ue_rnti(i))) {
+      goto quit;
+    }
+    
+    srslte_pusch_cfg_t cfg; 
+    srslte_uci_data_t uci_tx; 
+    bzero(&uci_tx, sizeof(srslte_uci_data_t));
+    if (srslte_pusch_cfg(&pusch_tx, &cfg, &grants[i], NULL, &hopping_cfg, NULL, subframe, 0, 0)) {
+      fprintf(stderr, "Error configuring PUSCH\n");
+      goto quit;
+    }
+    srslte_softbuffer_tx_reset(&softbuffer_tx);
+    if (srslte_pusch_encode(&pusch_tx, &cfg, &softbuffer_tx, data_tx[i], uci_tx, ue_rnti(i), sf_symbols)) {
+      fprintf(stderr, "Error encoding PUSCH\n");
+      goto quit;
+    }
+    if (srslte_refsignal_dmrs_pusch_gen(&dmrs, L_prb, subframe, 0, dmrs_pusch)) {
+      fprintf(stderr, "Error generating DMRS\n");
+      goto quit;
+    }
+    srslte_refsignal_dmrs_pusch_put(&dmrs, dmrs_pusch, L_prb, cfg.grant.n_prb_tilde, sf_symbols);
+  }
+  memcpy(enb_ul.sf_symbols, sf_symbols, sizeof(cf_t) * SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp));
+  
+  /* Serial receiver */
+  reset_rx();
+  for (uint32_t i=0;i<nof_ue;i++) {
+    ret_serial[i] = srslte_enb_ul_get_pusch(&enb_ul, &grants[i], &softbuffers[i], ue_rnti(i), 0, 0, 
+                                            data_rx[i], &uci_data[i], subframe);
+  }
+  if (check_rx("serial", ret_serial)) {
+    goto quit;
+  }
+  
+  /* Multiple receiver */
+  reset_rx();
+  for (uint32_t i=0;i<nof_ue;i++) {
+    bzero(&rx[i], sizeof(srslte_enb_ul_pusch_rx_t));
+    rx[i].rnti       = ue_rnti(i); 
+    rx[i].grant      = &grants[i]; 
+    rx[i].softbuffer = &softbuffers[i]; 
+    rx[i].data       = data_rx[i];
+    rx[i].uci_data   = &uci_data[i]; 
+  }
+  if (srslte_enb_ul_get_pusch_multi(&enb_ul, rx, nof_ue, subframe)) {
+    fprintf(stderr, "Error in multiple PUSCH receiver\n");
+    goto quit;
+  }
+  for (uint32_t i=0;i<nof_ue;i++) {
+    ret_multi[i] = rx[i].ret; 
+  }
+  if (check_rx("multi", ret_multi)) {
+    goto quit;
+  }
+  
+  /* A grant that fails its CRC must not stop the other grants of the batch */
+  if (nof_ue > 1) {
+    reset_rx();
+    rx[0].rnti = ue_rnti(1); 
+    if (srslte_enb_ul_get_pusch_multi(&enb_ul, rx, nof_ue, subframe)) {
+      fprintf(stderr, "Error in multiple PUSCH receiver\n");
+      goto quit;
+    }
+    rx[0].rnti = ue_rnti(0); 
+    if (!rx[0].ret) {
+      fprintf(stderr, "multi: grant 0 decoded with the wrong RNTI\n");
+      goto quit;
+    }
+    for (uint32_t i=1;i<nof_ue;i++) {
+      if (rx[i].ret || memcmp(data_tx[i], data_rx[i], grants[i].mcs.tbs/8)) {
+        fprintf(stderr, "multi: grant %d lost after grant 0 failed\n", i);
+        goto quit;
+      }
+    }
+  }
+  printf("Decoded %d grants of %d PRB (TBS: %d bits) with the serial and multiple receivers\n", 
+         nof_ue, L_prb, grants[0].mcs.tbs);
+  
+  if (nof_trials) {
+    gettimeofday(&t[1], NULL);
+    for (uint32_t n=0;n<nof_trials;n++) {
+      reset_rx();
+      for (uint32_t i=0;i<nof_ue;i++) {
+        srslte_enb_ul_get_pusch(&enb_ul, &grants[i], &softbuffers[i], ue_rnti(i), 0, 0, 
+                                data_rx[i], &uci_data[i], subframe);
+      }
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    float t_serial = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_trials; 
+    
+    gettimeofday(&t[1], NULL);
+    for (uint32_t n=0;n<nof_trials;n++) {
+      reset_rx();
+      srslte_enb_ul_get_pusch_multi(&enb_ul, rx, nof_ue, subframe);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    float t_multi = (float) (t[0].tv_sec*1e6 + t[0].tv_usec)/nof_trials; 
+    
+    printf("Subframe with %d grants: serial %.1f us, multiple %.1f us\n", nof_ue, t_serial, t_multi);
+  }
+  
+  ret = 0; 
+  
+quit:
+  srslte_pusch_free(&pusch_tx);
+  srslte_refsignal_ul_free(&dmrs);
+  srslte_enb_ul_free(&enb_ul);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  for (uint32_t i=0;i<MAX_UE;i++) {
+    srslte_softbuffer_rx_free(&softbuffers[i]);
+    if (data_tx[i]) {
+      free(data_tx[i]);
+    }
+    if (data_rx[i]) {
+      free(data_rx[i]);
+    }
+  }
+  if (sf_symbols) {
+    free(sf_symbols);
+  }
+  if (dmrs_pusch) {
+    free(dmrs_pusch);
+  }
+  if (ret) {
+    printf("Error\n");
+  } else {
+    printf("Ok\n");
+  }
+  exit(ret);
+}
@@ -545,13 +545,15 @@ static void encode_ri_ack(uint8_t data, srslte_uci_bit_type_t q_encoded_bits[6],
   }
 }
                        
-static int32_t decode_ri_ack(int16_t *q_bits, uint8_t *c_seq, srslte_uci_bit_t *pos) 
+/* c_bytes is the scrambling sequence packed in bytes */
+static int32_t decode_ri_ack(int16_t *q_bits, uint8_t *c_bytes, srslte_uci_bit_t *pos) 
 {
   uint32_t p0 = pos[0].position;
   uint32_t p1 = pos[1].position;
+  uint8_t c0 = (c_bytes[p0/8] >> (7-p0%8)) & 0x1;
   
-  uint32_t q0 = c_seq[p0]?q_bits[p0]:-q_bits[p0];  
-  uint32_t q1 = c_seq[p0]?q_bits[p1]:-q_bits[p1];
+  uint32_t q0 = c0?q_bits[p0]:-q_bits[p0];  
+  uint32_t q1 = c0?q_bits[p1]:-q_bits[p1];
 
   return -(q0+q1);
 }
@@ -560,7 +562,7 @@ static int32_t decode_ri_ack(int16_t *q_bits, uint8_t *c_seq, srslte_uci_bit_t *
 /* Decode UCI HARQ/ACK bits as described in 5.2.2.6 of 36.212 
  *  Currently only supporting 1-bit HARQ
  */
-int srslte_uci_decode_ack(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_seq, 
+int srslte_uci_decode_ack(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_bytes, 
                           float beta, uint32_t H_prime_total, 
                           uint32_t O_cqi, srslte_uci_bit_t *ack_bits, uint8_t *data)
 {
@@ -576,7 +578,7 @@ int srslte_uci_decode_ack(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_s
   // Use the same interleaver function to get the HARQ bit position
   for (uint32_t i=0;i<Qprime;i++) {
     uci_ulsch_interleave_ack_gen(i, cfg->grant.Qm, H_prime_total, cfg->nbits.nof_symb, cfg->cp, &ack_bits[cfg->grant.Qm*i]);
-    rx_ack += (int32_t) decode_ri_ack(q_bits, c_seq, ack_bits);
+    rx_ack += (int32_t) decode_ri_ack(q_bits, c_bytes, ack_bits);
   }
   
   if (data) {
@@ -613,7 +615,7 @@ int srslte_uci_encode_ack(srslte_pusch_cfg_t *cfg, uint8_t data,
 /* Encode UCI RI bits as described in 5.2.2.6 of 36.212 
  *  Currently only supporting 1-bit RI
  */
-int srslte_uci_decode_ri(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_seq, 
+int srslte_uci_decode_ri(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_bytes, 
                           float beta, uint32_t H_prime_total, 
                           uint32_t O_cqi, srslte_uci_bit_t *ri_bits, uint8_t *data)
 {
@@ -629,7 +631,7 @@ int srslte_uci_decode_ri(srslte_pusch_cfg_t *cfg, int16_t *q_bits, uint8_t *c_se
   // Use the same interleaver function to get the HARQ bit position
   for (uint32_t i=0;i<Qprime;i++) {
     uci_ulsch_interleave_ri_gen(i, cfg->grant.Qm, H_prime_total, cfg->nbits.nof_symb, cfg->cp, &ri_bits[cfg->grant.Qm*i]);
-    rx_ri += (int32_t) decode_ri_ack(q_bits, c_seq, ri_bits);
+    rx_ri += (int32_t) decode_ri_ack(q_bits, c_bytes, ri_bits);
   }
 
   if (data) {
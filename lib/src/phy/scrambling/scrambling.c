@@ -32,6 +32,14 @@
 #include "srslte/phy/utils/vector.h"
 #include "srslte/phy/scrambling/scrambling.h"
 
+#ifdef LV_HAVE_SSE
+#include <smmintrin.h>
+#endif
+
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
 void srslte_scrambling_f(srslte_sequence_t *s, float *data) {
   srslte_scrambling_f_offset(s, data, 0, s->len);
 }
@@ -103,3 +111,85 @@ void srslte_scrambling_bytes(srslte_sequence_t *s, uint8_t *data, int len) {
     srslte_bit_pack_vector(tmp_bits, &data[len/8], len%8);
   }    
 }
+
+/* On-the-fly scrambling generates the sequence in chunks of this many 32-bit words */
+#define SCRAMBLING_SEED_WORDS 64
+
+void srslte_scrambling_bytes_seed(uint32_t seed, uint8_t *data, int len) {
+  srslte_sequence_gen_t g;
+  uint32_t c[SCRAMBLING_SEED_WORDS];
+  srslte_sequence_gen_init(&g, seed);
+  for (int i=0;i<len;i+=32*SCRAMBLING_SEED_WORDS) {
+    int n = SRSLTE_MIN(32*SCRAMBLING_SEED_WORDS, len-i);
+    srslte_sequence_gen_words(&g, c, (n+31)/32);
+    uint8_t *x = &data[i/8];
+    int k;
+    for (k=0;k<n/32;k++) {
+      // Sequence words are MSB first, data is packed MSB first: XOR as a big-endian word
+      uint32_t w;
+      memcpy(&w, &x[4*k], sizeof(uint32_t));
+      w ^= __builtin_bswap32(c[k]);
+      memcpy(&x[4*k], &w, sizeof(uint32_t));
+    }
+    // Scramble last bits, leaving the unused bits of the last byte untouched
+    int rem = n%32;
+    if (rem) {
+      uint32_t w = c[k] & (0xffffffff << (32-rem));
+      for (int j=0;j<(rem+7)/8;j++) {
+        x[4*k+j] ^= (uint8_t) (w>>(24-8*j));
+      }
+    }
+  }
+}
+/* Negates data[j] when bit j of c (counting from the MSB) is set */
+static inline void scrambling_s_word(uint32_t c, short *data, int len) {
+  int j=0;
+#ifdef LV_HAVE_AVX2
+  const __m256i bits = _mm256_setr_epi16(0x8000, 0x4000, 0x2000, 0x1000, 0x800, 0x400, 0x200, 0x100, 
+                                         0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1);
+  for (;j+16<=len;j+=16) {
+    __m256i m = _mm256_and_si256(_mm256_set1_epi16((short) (c>>(16-j))), bits);
+    m = _mm256_cmpeq_epi16(m, bits);
+    __m256i x = _mm256_loadu_si256((__m256i*) &data[j]);
+    _mm256_storeu_si256((__m256i*) &data[j], _mm256_sub_epi16(_mm256_xor_si256(x, m), m));
+  }
+#endif
+#ifdef LV_HAVE_SSE
+  const __m128i bits8 = _mm_setr_epi16(0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1);
+  for (;j+8<=len;j+=8) {
+    __m128i m = _mm_and_si128(_mm_set1_epi16((short) (c>>(24-j))), bits8);
+    m = _mm_cmpeq_epi16(m, bits8);
+    __m128i x = _mm_loadu_si128((__m128i*) &data[j]);
+    _mm_storeu_si128((__m128i*) &data[j], _mm_sub_epi16(_mm_xor_si128(x, m), m));
+  }
+#endif
+  for (;j<len;j++) {
+    if ((c>>(31-j)) & 0x1) {
+      data[j] = -data[j];
+    }
+  }
+}
+
+void srslte_scrambling_s_seed(uint32_t seed, short *data, int len) {
+  srslte_sequence_gen_t g;
+  uint32_t c[SCRAMBLING_SEED_WORDS];
+  srslte_sequence_gen_init(&g, seed);
+  for (int i=0;i<len;i+=32*SCRAMBLING_SEED_WORDS) {
+    int n = SRSLTE_MIN(32*SCRAMBLING_SEED_WORDS, len-i);
+    srslte_sequence_gen_words(&g, c, (n+31)/32);
+    for (int k=0;k<n;k+=32) {
+      scrambling_s_word(c[k/32], &data[i+k], SRSLTE_MIN(32, n-k));
+    }
+  }
+}
+
+void srslte_scrambling_s_bytes(uint8_t *c_bytes, short *data, int len) {
+  for (int i=0;i<len;i+=32) {
+    int n = SRSLTE_MIN(32, len-i);
+    uint32_t c = 0;
+    for (int j=0;j<(n+7)/8;j++) {
+      c |= (uint32_t) c_bytes[i/8+j] << (24-8*j);
+    }
+    scrambling_s_word(c, &data[i], n);
+  }
+}
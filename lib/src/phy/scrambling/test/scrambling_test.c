@@ -40,17 +40,19 @@ bool do_floats = false;
 srslte_cp_t cp = SRSLTE_CP_NORM;
 int cell_id = -1;
 int nof_bits = 100; 
+int nof_repetitions = 1000; 
 
 void usage(char *prog) {
   printf("Usage: %s [ef] -c cell_id -s [PBCH, PDSCH, PDCCH, PMCH, PUCCH]\n", prog);
   printf("\t -l nof_bits [Default %d]\n", nof_bits);
   printf("\t -e CP extended [Default CP Normal]\n");
   printf("\t -f scramble floats [Default bits]\n");
+  printf("\t -r nof_repetitions for the PDSCH on-the-fly vs LUT benchmark [Default %d]\n", nof_repetitions);
 }
 
 void parse_args(int argc, char **argv) {
   int opt;
-  while ((opt = getopt(argc, argv, "csefl")) != -1) {
+  while ((opt = getopt(argc, argv, "cseflr")) != -1) {
     switch (opt) {
     case 'c':
       cell_id = atoi(argv[optind]);
@@ -58,6 +60,9 @@ void parse_args(int argc, char **argv) {
     case 'l':
       nof_bits = atoi(argv[optind]);
       break;
+    case 'r':
+      nof_repetitions = atoi(argv[optind]);
+      break;
     case 'e':
       cp = SRSLTE_CP_EXT;
       break;
@@ -94,6 +99,117 @@ int init_sequence(srslte_sequence_t *seq, char *name) {
 }
 
 
+static double elapsed_us(struct timeval *t) {
+  get_time_interval(t);
+  return (double) t[0].tv_sec * 1e6 + t[0].tv_usec;
+}
+
+/* Checks that scrambling with the sequence generated on the fly gives the same result as the 
+ * precomputed (LUT) sequence and compares their execution time */
+int test_pdsch_seed() {
+  uint32_t seed = srslte_sequence_pdsch_seed(1234, 0, 0, cell_id);
+  struct timeval t[3];
+  int ret = -1; 
+  srslte_sequence_t seq; 
+  bzero(&seq, sizeof(srslte_sequence_t));
+
+  uint8_t *bytes_lut  = malloc(nof_bits/8+8);
+  uint8_t *bytes_seed = malloc(nof_bits/8+8);
+  uint8_t *c_bytes    = malloc(nof_bits/8+8);
+  short *llr_lut      = malloc(sizeof(short)*nof_bits);
+  short *llr_seed     = malloc(sizeof(short)*nof_bits);
+  short *llr_bytes    = malloc(sizeof(short)*nof_bits);
+  if (!bytes_lut || !bytes_seed || !c_bytes || !llr_lut || !llr_seed || !llr_bytes) {
+    perror("malloc");
+    goto clean_exit;
+  }
+  for (int i=0;i<nof_bits/8+8;i++) {
+    bytes_lut[i] = rand();
+    bytes_seed[i] = bytes_lut[i];
+  }
+  for (int i=0;i<nof_bits;i++) {
+    llr_lut[i] = rand()%2000-1000;
+    llr_seed[i] = llr_lut[i];
+    llr_bytes[i] = llr_lut[i];
+  }
+
+  gettimeofday(&t[1], NULL);
+  for (int n=0;n<nof_repetitions;n++) {
+    srslte_sequence_pdsch(&seq, 1234, 0, 0, cell_id, nof_bits);
+  }
+  gettimeofday(&t[2], NULL);
+  double t_gen = elapsed_us(t)/nof_repetitions; 
+
+  srslte_scrambling_bytes(&seq, bytes_lut, nof_bits);
+  srslte_scrambling_bytes_seed(seed, bytes_seed, nof_bits);
+  srslte_scrambling_s_offset(&seq, llr_lut, 0, nof_bits);
+  srslte_scrambling_s_seed(seed, llr_seed, nof_bits);
+  srslte_sequence_LTE_pr_bytes(c_bytes, nof_bits, seed);
+  srslte_scrambling_s_bytes(c_bytes, llr_bytes, nof_bits);
+
+  // The LUT path clears the unused bits of the last byte, only compare valid bits
+  uint8_t last_mask = (uint8_t) (0xff << (8-nof_bits%8));
+  if (memcmp(bytes_lut, bytes_seed, nof_bits/8) || 
+      ((bytes_lut[nof_bits/8] ^ bytes_seed[nof_bits/8]) & last_mask)) {
+    printf("Error on-the-fly byte scrambling differs from LUT\n");
+    goto clean_exit;
+  }
+  if (memcmp(llr_lut, llr_seed, sizeof(short)*nof_bits) || memcmp(llr_lut, llr_bytes, sizeof(short)*nof_bits)) {
+    printf("Error on-the-fly LLR scrambling differs from LUT\n");
+    goto clean_exit;
+  }
+
+  double t_exec[4];
+  for (int k=0;k<4;k++) {
+    gettimeofday(&t[1], NULL);
+    for (int n=0;n<nof_repetitions;n++) {
+      switch(k) {
+        case 0:
+          srslte_scrambling_bytes(&seq, bytes_lut, nof_bits);
+          break;
+        case 1:
+          srslte_scrambling_bytes_seed(seed, bytes_seed, nof_bits);
+          break;
+        case 2:
+          srslte_scrambling_s_offset(&seq, llr_lut, 0, nof_bits);
+          break;
+        case 3:
+          srslte_scrambling_s_seed(seed, llr_seed, nof_bits);
+          break;
+      }
+    }
+    gettimeofday(&t[2], NULL);
+    t_exec[k] = elapsed_us(t)/nof_repetitions;
+  }
+  printf("PDSCH %d bits. LUT: generate %.2f us (%d bytes), bytes %.2f us, LLR %.2f us. "
+         "On-the-fly: bytes %.2f us, LLR %.2f us (%d bytes)\n", 
+         nof_bits, t_gen, (int) (nof_bits*(sizeof(uint8_t)+sizeof(float)+sizeof(short))+nof_bits/8), 
+         t_exec[0], t_exec[2], t_exec[1], t_exec[3], (int) sizeof(srslte_sequence_gen_t));
+  ret = 0; 
+
+clean_exit:
+  if (bytes_lut) {
+    free(bytes_lut);
+  }
+  if (bytes_seed) {
+    free(bytes_seed);
+  }
+  if (c_bytes) {
+    free(c_bytes);
+  }
+  if (llr_lut) {
+    free(llr_lut);
+  }
+  if (llr_seed) {
+    free(llr_seed);
+  }
+  if (llr_bytes) {
+    free(llr_bytes);
+  }
+  srslte_sequence_free(&seq);
+  return ret; 
+}
+
 int main(int argc, char **argv) {
   int i;
   srslte_sequence_t seq;
@@ -176,6 +292,11 @@ int main(int argc, char **argv) {
     free(input_f);
     free(scrambled_f);
   }
+  if (!strcmp(srslte_sequence_name, "PDSCH")) {
+    if (test_pdsch_seed()) {
+      exit(-1);
+    }
+  }
   printf("Ok\n");
   srslte_sequence_free(&seq);
   exit(0);
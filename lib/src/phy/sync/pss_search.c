@@ -0,0 +1,263 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "srslte/phy/sync/pss.h"
+#include "srslte/phy/sync/pss_search.h"
+#include "srslte/phy/utils/vector.h"
+#include "srslte/phy/utils/debug.h"
+
+/* Half-width of the main lobe excluded from the side-lobe search, in samples */
+#define PSS_SEARCH_LOBE(fft_size) ((fft_size)/16)
+
+int srslte_pss_search_init(srslte_pss_search_t *q, uint32_t fft_size, uint32_t period)
+{
+  int ret = SRSLTE_ERROR_INVALID_INPUTS;
+
+  if (q != NULL && fft_size <= 2048 && period > SRSLTE_PSS_SEARCH_BLOCK_FACTOR * fft_size) {
+    ret = SRSLTE_ERROR;
+
+    bzero(q, sizeof(srslte_pss_search_t));
+    q->fft_size   = fft_size;
+    q->period     = period;
+    q->block_size = SRSLTE_PSS_SEARCH_BLOCK_FACTOR * fft_size;
+    q->block_step = q->block_size - fft_size;
+
+    if (srslte_dft_plan(&q->dftp_fwd, q->block_size, SRSLTE_DFT_FORWARD, SRSLTE_DFT_COMPLEX)) {
+      fprintf(stderr, "Error creating DFT plan\n");
+      goto clean_exit;
+    }
+    if (srslte_dft_plan(&q->dftp_bwd, q->block_size, SRSLTE_DFT_BACKWARD, SRSLTE_DFT_COMPLEX)) {
+      fprintf(stderr, "Error creating DFT plan\n");
+      goto clean_exit;
+    }
+
+    q->block      = srslte_vec_malloc(sizeof(cf_t) * q->block_size);
+    q->block_freq = srslte_vec_malloc(sizeof(cf_t) * q->block_size);
+    q->corr_freq  = srslte_vec_malloc(sizeof(cf_t) * q->block_size);
+    q->corr       = srslte_vec_malloc(sizeof(cf_t) * q->block_size);
+    q->corr_pow   = srslte_vec_malloc(sizeof(float) * q->block_size);
+    if (!q->block || !q->block_freq || !q->corr_freq || !q->corr || !q->corr_pow) {
+      perror("malloc");
+      goto clean_exit;
+    }
+
+    for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+      cf_t pss_freq[SRSLTE_PSS_LEN];
+      cf_t pss_time[2048];
+
+      q->pss_freq[N_id_2] = srslte_vec_malloc(sizeof(cf_t) * q->block_size);
+      q->acc[N_id_2]      = srslte_vec_malloc(sizeof(float) * period);
+      if (!q->pss_freq[N_id_2] || !q->acc[N_id_2]) {
+        perror("malloc");
+        goto clean_exit;
+      }
+      /* pss_time is already conjugated and scaled by 1/SRSLTE_PSS_LEN */
+      if (srslte_pss_synch_init_N_id_2(pss_freq, pss_time, N_id_2, fft_size, 0)) {
+        fprintf(stderr, "Error initiating PSS sequence\n");
+        goto clean_exit;
+      }
+
+      /* corr[n] = sum_k block[n+k]*pss_time[k] is computed as ifft(fft(block) * H), where
+       * H = conj(fft(conj(pss_time))). The 1/block_size of the inverse DFT goes into H too.
+       */
+      bzero(q->block, sizeof(cf_t) * q->block_size);
+      srslte_vec_conj_cc(pss_time, q->block, fft_size);
+      srslte_dft_run_c(&q->dftp_fwd, q->block, q->pss_freq[N_id_2]);
+      srslte_vec_conj_cc(q->pss_freq[N_id_2], q->pss_freq[N_id_2], q->block_size);
+      srslte_vec_sc_prod_cfc(q->pss_freq[N_id_2], 1.0/q->block_size, q->pss_freq[N_id_2], q->block_size);
+    }
+
+    srslte_pss_search_reset(q);
+
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  if (ret == SRSLTE_ERROR) {
+    srslte_pss_search_free(q);
+  }
+  return ret;
+}
+
+void srslte_pss_search_free(srslte_pss_search_t *q)
+{
+  if (q) {
+    for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+      if (q->pss_freq[N_id_2]) {
+        free(q->pss_freq[N_id_2]);
+      }
+      if (q->acc[N_id_2]) {
+        free(q->acc[N_id_2]);
+      }
+    }
+    if (q->block) {
+      free(q->block);
+    }
+    if (q->block_freq) {
+      free(q->block_freq);
+    }
+    if (q->corr_freq) {
+      free(q->corr_freq);
+    }
+    if (q->corr) {
+      free(q->corr);
+    }
+    if (q->corr_pow) {
+      free(q->corr_pow);
+    }
+    srslte_dft_plan_free(&q->dftp_fwd);
+    srslte_dft_plan_free(&q->dftp_bwd);
+    bzero(q, sizeof(srslte_pss_search_t));
+  }
+}
+
+/* Discards the stored history and the accumulated statistics */
+void srslte_pss_search_reset(srslte_pss_search_t *q)
+{
+  bzero(q->block, sizeof(cf_t) * q->block_size);
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    bzero(q->acc[N_id_2], sizeof(float) * q->period);
+    q->peak_pos[N_id_2]   = 0;
+    q->peak_value[N_id_2] = 0;
+  }
+  q->block_fill  = 0;
+  q->nof_samples = 0;
+}
+
+/* Adds len correlation power values starting at position pos (mod period) and
+ * updates the running peak. The accumulator never decreases, so the maximum over
+ * the updated range and the previous peak is the peak of the whole period.
+ */
+static void accumulate(srslte_pss_search_t *q, uint32_t N_id_2, float *pow, uint32_t pos, uint32_t len)
+{
+  while (len > 0) {
+    uint32_t n = SRSLTE_MIN(len, q->period - pos);
+    float *acc = &q->acc[N_id_2][pos];
+
+    srslte_vec_sum_fff(acc, pow, acc, n);
+    uint32_t i = srslte_vec_max_fi(acc, n);
+    if (acc[i] > q->peak_value[N_id_2]) {
+      q->peak_value[N_id_2] = acc[i];
+      q->peak_pos[N_id_2]   = pos + i;
+    }
+    pow += n;
+    len -= n;
+    pos  = 0;
+  }
+}
+
+/* Runs one overlap-save block: the first fft_size samples of q->block are the tail
+ * of the previous block and the remaining block_step samples are new.
+ */
+static void run_block(srslte_pss_search_t *q)
+{
+  /* corr[n] is the correlation with the PSS starting at block[n]. block[0] is
+   * fft_size samples before the first new sample. */
+  int64_t first = (int64_t) q->nof_samples - q->fft_size;
+  uint32_t skip = first < 0 ? (uint32_t) -first : 0;
+  uint32_t pos  = (uint32_t) ((first + skip) % q->period);
+
+  srslte_dft_run_c(&q->dftp_fwd, q->block, q->block_freq);
+
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    srslte_vec_prod_ccc(q->block_freq, q->pss_freq[N_id_2], q->corr_freq, q->block_size);
+    srslte_dft_run_c(&q->dftp_bwd, q->corr_freq, q->corr);
+    srslte_vec_abs_square_cf(&q->corr[skip], q->corr_pow, q->block_step - skip);
+    accumulate(q, N_id_2, q->corr_pow, pos, q->block_step - skip);
+  }
+
+  memmove(q->block, &q->block[q->block_step], sizeof(cf_t) * q->fft_size);
+  q->nof_samples += q->block_step;
+  q->block_fill   = 0;
+}
+
+/* Pushes nof_samples new samples to the search. Any number of samples can be passed;
+ * the samples that do not complete a block are kept until the next call.
+ * Returns the number of complete PSS periods accumulated so far or -1 on error.
+ */
+int srslte_pss_search_run(srslte_pss_search_t *q, cf_t *input, uint32_t nof_samples)
+{
+  if (q == NULL || (input == NULL && nof_samples > 0)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  while (nof_samples > 0) {
+    uint32_t n = SRSLTE_MIN(nof_samples, q->block_step - q->block_fill);
+    memcpy(&q->block[q->fft_size + q->block_fill], input, sizeof(cf_t) * n);
+    q->block_fill += n;
+    input         += n;
+    nof_samples   -= n;
+    if (q->block_fill == q->block_step) {
+      run_block(q);
+    }
+  }
+  return (int) srslte_pss_search_nof_periods(q);
+}
+
+/* Number of complete periods that have contributed to the accumulated statistics */
+uint32_t srslte_pss_search_nof_periods(srslte_pss_search_t *q)
+{
+  uint64_t nof_corr = q->nof_samples > q->fft_size ? q->nof_samples - q->fft_size : 0;
+  return (uint32_t) (nof_corr / q->period);
+}
+
+/* Returns the accumulated peak for N_id_2. peak_pos is the position, modulo the period,
+ * of the first sample of the PSS symbol after the cyclic prefix. psr is the ratio between
+ * the peak and the largest value outside the main lobe.
+ */
+int srslte_pss_search_result(srslte_pss_search_t *q, uint32_t N_id_2, uint32_t *peak_pos, float *peak_value, float *psr)
+{
+  if (q == NULL || !srslte_N_id_2_isvalid(N_id_2)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t pos  = q->peak_pos[N_id_2];
+  uint32_t lobe = PSS_SEARCH_LOBE(q->fft_size);
+  float *acc    = q->acc[N_id_2];
+
+  /* Side lobes are searched in the circular range [pos+lobe+1, pos-lobe-1] */
+  uint32_t start = (pos + lobe + 1) % q->period;
+  uint32_t len   = q->period - 2 * lobe - 1;
+  uint32_t n     = SRSLTE_MIN(len, q->period - start);
+  float side_lobe = acc[start + srslte_vec_max_fi(&acc[start], n)];
+  if (len > n) {
+    side_lobe = SRSLTE_MAX(side_lobe, acc[srslte_vec_max_fi(acc, len - n)]);
+  }
+
+  if (peak_pos) {
+    *peak_pos = pos;
+  }
+  if (peak_value) {
+    *peak_value = q->peak_value[N_id_2];
+  }
+  if (psr) {
+    *psr = side_lobe > 0 ? q->peak_value[N_id_2] / side_lobe : 0;
+  }
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <stdbool.h>
+
+#include "srslte/srslte.h"
+
+int cell_id = 150, offset = 1234;
+srslte_cp_t cp = SRSLTE_CP_NORM;
+uint32_t nof_frames = 4;
+float noise_db = 0.0;
+float min_psr = 4.0;
+bool noise_only = false;
+
+#define FLEN  SRSLTE_SF_LEN(fft_size)
+#define PERIOD (5*FLEN)
+
+void usage(char *prog) {
+  printf("Usage: %s [coenatzv]\n", prog);
+  printf("\t-c cell_id [Default %d]\n", cell_id);
+  printf("\t-o offset [Default %d]\n", offset);
+  printf("\t-e extended CP [Default normal]\n");
+  printf("\t-n number of 5 ms frames [Default %d]\n", nof_frames);
+  printf("\t-a noise power in dB above the PSS symbol power [Default %.1f]\n", noise_db);
+  printf("\t-t minimum PSR of the detected N_id_2 [Default %.1f]\n", min_psr);
+  printf("\t-z noise only, checks that no PSR reaches the minimum [Default %s]\n", noise_only?"yes":"no");
+  printf("\t-v srslte_verbose\n");
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "coenatzv")) != -1) {
+    switch (opt) {
+    case 'c':
+      cell_id = atoi(argv[optind]);
+      break;
+    case 'o':
+      offset = atoi(argv[optind]);
+      break;
+    case 'e':
+      cp = SRSLTE_CP_EXT;
+      break;
+    case 'n':
+      nof_frames = atoi(argv[optind]);
+      break;
+    case 'a':
+      noise_db = atof(argv[optind]);
+      break;
+    case 't':
+      min_psr = atof(argv[optind]);
+      break;
+    case 'z':
+      noise_only = true;
+      break;
+    case 'v':
+      srslte_verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  cf_t *buffer, *sf_symbols, *input;
+  cf_t pss_signal[SRSLTE_PSS_LEN];
+  float sss_signal0[SRSLTE_SSS_LEN];
+  float sss_signal5[SRSLTE_SSS_LEN];
+  srslte_ofdm_t ifft;
+  srslte_pss_search_t search;
+  srslte_pss_synch_t pss;
+  struct timeval t[3];
+  uint32_t nof_prb = 6;
+  int ret = -1;
+
+  parse_args(argc, argv);
+
+  uint32_t fft_size = srslte_symbol_sz(nof_prb);
+  uint32_t N_id_2 = cell_id%3;
+  uint32_t nof_samples = nof_frames * PERIOD;
+  offset %= PERIOD - FLEN;
+
+  buffer     = malloc(sizeof(cf_t) * FLEN);
+  sf_symbols = malloc(sizeof(cf_t) * FLEN);
+  input      = srslte_vec_malloc(sizeof(cf_t) * nof_samples);
+  if (!buffer || !sf_symbols || !input) {
+    perror("malloc");
+    exit(-1);
+  }
+  if (srslte_ofdm_tx_init(&ifft, cp, nof_prb)) {
+    fprintf(stderr, "Error creating iFFT object\n");
+    exit(-1);
+  }
+  if (srslte_pss_search_init(&search, fft_size, PERIOD)) {
+    fprintf(stderr, "Error initiating PSS search\n");
+    exit(-1);
+  }
+  if (srslte_pss_synch_init_fft(&pss, PERIOD, fft_size)) {
+    fprintf(stderr, "Error initiating PSS\n");
+    exit(-1);
+  }
+
+  /* One subframe with PSS/SSS per 5 ms frame */
+  srslte_pss_generate(pss_signal, N_id_2);
+  srslte_sss_generate(sss_signal0, sss_signal5, cell_id);
+  bzero(buffer, sizeof(cf_t) * FLEN);
+  srslte_pss_put_slot(pss_signal, buffer, nof_prb, cp);
+  srslte_sss_put_slot(sss_signal0, buffer, nof_prb, cp);
+  srslte_ofdm_tx_sf(&ifft, buffer, sf_symbols);
+
+  bzero(input, sizeof(cf_t) * nof_samples);
+  if (!noise_only) {
+    for (uint32_t i = 0; i < nof_frames; i++) {
+      memcpy(&input[i*PERIOD + offset], sf_symbols, sizeof(cf_t) * FLEN);
+    }
+  }
+
+  /* The PSS is the last symbol of the first slot. Noise power is referred to its mean power */
+  uint32_t pss_pos = offset + FLEN/2 - fft_size;
+  float pss_power = srslte_vec_avg_power_cf(&sf_symbols[FLEN/2 - fft_size], fft_size);
+  srslte_ch_awgn_c(input, input, sqrtf(pss_power/2) * powf(10, noise_db/20), nof_samples);
+
+  /* Push the samples in chunks that are not aligned to the blocks */
+  gettimeofday(&t[1], NULL);
+  uint32_t n = 0;
+  for (uint32_t chunk = 1000; n < nof_samples; chunk = chunk*7/5 + 1) {
+    uint32_t len = SRSLTE_MIN(chunk % 4001 + 1, nof_samples - n);
+    srslte_pss_search_run(&search, &input[n], len);
+    n += len;
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  uint64_t t_search = t[0].tv_sec*1000000 + t[0].tv_usec;
+
+  /* Same samples through the frame-based search, one pass per N_id_2 */
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < 3; i++) {
+    srslte_pss_synch_set_N_id_2(&pss, i);
+    srslte_pss_synch_reset(&pss);
+    for (uint32_t j = 0; j < nof_frames; j++) {
+      srslte_pss_synch_find_pss(&pss, &input[j*PERIOD], NULL);
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  uint64_t t_frame = t[0].tv_sec*1000000 + t[0].tv_usec;
+
+  uint32_t best = 0;
+  float best_psr = 0;
+  for (uint32_t i = 0; i < 3; i++) {
+    uint32_t pos;
+    float value, psr;
+    srslte_pss_search_result(&search, i, &pos, &value, &psr);
+    printf("N_id_2=%d: pos=%5d, peak=%.3e, psr=%.2f\n", i, pos, value, psr);
+    if (psr > best_psr) {
+      best_psr = psr;
+      best = i;
+    }
+  }
+  printf("periods=%d, pipelined search: %d us, frame search: %d us\n",
+         srslte_pss_search_nof_periods(&search), (int) t_search, (int) t_frame);
+
+  if (noise_only) {
+    if (best_psr >= min_psr) {
+      printf("Noise reached PSR %.2f >= %.2f\n", best_psr, min_psr);
+      goto clean_exit;
+    }
+  } else {
+    uint32_t pos;
+    srslte_pss_search_result(&search, best, &pos, NULL, NULL);
+    if (best != N_id_2 || best_psr < min_psr) {
+      printf("Detected N_id_2=%d PSR=%.2f, expected N_id_2=%d PSR>=%.2f\n", best, best_psr, N_id_2, min_psr);
+      goto clean_exit;
+    }
+    if (pos != pss_pos) {
+      printf("Detected position %d, expected %d\n", pos, pss_pos);
+      goto clean_exit;
+    }
+  }
+  ret = 0;
+  printf("Ok\n");
+
+clean_exit:
+  free(buffer);
+  free(sf_symbols);
+  free(input);
+  srslte_pss_search_free(&search);
+  srslte_pss_synch_free(&pss);
+  srslte_ofdm_tx_free(&ifft);
+  exit(ret);
+}
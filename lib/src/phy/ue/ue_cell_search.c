@@ -75,8 +75,15 @@ int srslte_ue_cellsearch_init(srslte_ue_cellsearch_t * q, uint32_t max_frames,
       goto clean_exit;  
     }
 
+    if (srslte_pss_search_init(&q->pss_search, srslte_symbol_sz(SRSLTE_CS_NOF_PRB), 
+                               5*SRSLTE_SF_LEN_PRB(SRSLTE_CS_NOF_PRB))) {
+      fprintf(stderr, "Error initiating PSS search\n");
+      goto clean_exit; 
+    }
+
     q->max_frames = max_frames;
     q->nof_valid_frames = max_frames; 
+    q->pss_search_threshold = SRSLTE_CS_PSS_SEARCH_THRESHOLD; 
     
     ret = SRSLTE_SUCCESS;
   }
@@ -131,8 +138,15 @@ int srslte_ue_cellsearch_init_multi(srslte_ue_cellsearch_t * q, uint32_t max_fra
       goto clean_exit;  
     }
 
+    if (srslte_pss_search_init(&q->pss_search, srslte_symbol_sz(SRSLTE_CS_NOF_PRB), 
+                               5*SRSLTE_SF_LEN_PRB(SRSLTE_CS_NOF_PRB))) {
+      fprintf(stderr, "Error initiating PSS search\n");
+      goto clean_exit; 
+    }
+
     q->max_frames = max_frames;
     q->nof_valid_frames = max_frames; 
+    q->pss_search_threshold = SRSLTE_CS_PSS_SEARCH_THRESHOLD; 
     
     ret = SRSLTE_SUCCESS;
   }
@@ -160,6 +174,7 @@ void srslte_ue_cellsearch_free(srslte_ue_cellsearch_t * q)
   if (q->mode_ntimes) {
     free(q->mode_ntimes);
   }
+  srslte_pss_search_free(&q->pss_search);
   srslte_ue_sync_free(&q->ue_sync);
   
   bzero(q, sizeof(srslte_ue_cellsearch_t));
@@ -176,6 +191,46 @@ int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t * q, uint32
   }
 }
 
+/* Sets the minimum PSR of the accumulated PSS correlation for an N_id_2 to be scanned by 
+ * srslte_ue_cellsearch_scan(), e.g. SRSLTE_CS_PSS_SEARCH_THRESHOLD. With 0, the default, the three 
+ * N_id_2 are scanned unconditionally. 
+ */
+void srslte_ue_cellsearch_set_pss_search_threshold(srslte_ue_cellsearch_t * q, float threshold)
+{
+  q->pss_search_threshold = threshold; 
+}
+
+/* Streams nof_valid_frames 5 ms frames through the PSS search, which correlates the 
+ * three PSS at once, and marks the N_id_2 whose accumulated PSR exceeds the threshold. 
+ * Returns the number of marked N_id_2 or -1 on error
+ */
+static int pss_search(srslte_ue_cellsearch_t * q, bool detected[3])
+{
+  uint32_t sf_len = SRSLTE_SF_LEN_PRB(SRSLTE_CS_NOF_PRB);
+  int nof_detected = 0; 
+  
+  srslte_pss_search_reset(&q->pss_search);
+  while (srslte_pss_search_nof_periods(&q->pss_search) < q->nof_valid_frames) {
+    if (q->ue_sync.recv_callback(q->ue_sync.stream, q->sf_buffer, sf_len, NULL) < 0) {
+      fprintf(stderr, "Error receiving samples\n");
+      return SRSLTE_ERROR; 
+    }
+    srslte_pss_search_run(&q->pss_search, q->sf_buffer[0], sf_len);
+  }
+  
+  for (uint32_t N_id_2=0;N_id_2<3;N_id_2++) {
+    uint32_t pos; 
+    float psr; 
+    srslte_pss_search_result(&q->pss_search, N_id_2, &pos, NULL, &psr);
+    detected[N_id_2] = psr >= q->pss_search_threshold; 
+    if (detected[N_id_2]) {
+      nof_detected++; 
+    }
+    DEBUG("CELL SEARCH: N_id_2=%d PSS search pos=%d PSR=%.2f\n", N_id_2, pos, psr);
+  }
+  return nof_detected; 
+}
+
 /* Decide the most likely cell based on the mode */
 static void get_cell(srslte_ue_cellsearch_t * q, uint32_t nof_detected_frames, srslte_ue_cellsearch_result_t *found_cell)
 {
@@ -232,7 +287,8 @@ static void get_cell(srslte_ue_cellsearch_t * q, uint32_t nof_detected_frames, s
 }
 
 /** Finds up to 3 cells, one per each N_id_2=0,1,2 and stores ID and CP in the structure pointed by found_cell.
- * Each position in found_cell corresponds to a different N_id_2. 
+ * Each position in found_cell corresponds to a different N_id_2. A joint PSS search over nof_valid_frames 
+ * selects the N_id_2 to scan, unless the PSS search threshold was set to 0. 
  * Saves in the pointer max_N_id_2 the N_id_2 index of the cell with the highest PSR
  * Returns the number of found cells or a negative number if error
  */
@@ -243,7 +299,20 @@ int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t * q,
   int ret = 0; 
   float max_peak_value = -1.0;
   uint32_t nof_detected_cells = 0; 
+  bool detected[3] = {true, true, true}; 
+  
+  /* Only the N_id_2 with a PSS peak in the joint search go through the SSS/CP scan */
+  if (q->pss_search_threshold > 0) {
+    ret = pss_search(q, detected); 
+    if (ret < 0) {
+      return ret; 
+    }
+  }
   for (uint32_t N_id_2=0;N_id_2<3 && ret >= 0;N_id_2++) {
+    if (!detected[N_id_2]) {
+      bzero(&found_cells[N_id_2], sizeof(srslte_ue_cellsearch_result_t));
+      continue; 
+    }
     ret = srslte_ue_cellsearch_scan_N_id_2(q, N_id_2, &found_cells[N_id_2]);
     if (ret < 0) {
       fprintf(stderr, "Error searching cell\n");
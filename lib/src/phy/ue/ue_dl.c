@@ -38,7 +38,11 @@
 #define CURRENT_SFLEN_RE SRSLTE_SF_LEN_RE(q->cell.nof_prb, q->cell.cp)
 
 
-static srslte_dci_format_t ue_formats[] = {SRSLTE_DCI_FORMAT1A, SRSLTE_DCI_FORMAT1}; // Only TM1 and TM2 are currently supported 
+/* UE-specific search space formats of TM1 to TM4, 36.213 Table 7.1-5 */
+static srslte_dci_format_t ue_formats[4][2] = {{SRSLTE_DCI_FORMAT1A, SRSLTE_DCI_FORMAT1}, 
+                                               {SRSLTE_DCI_FORMAT1A, SRSLTE_DCI_FORMAT1}, 
+                                               {SRSLTE_DCI_FORMAT1A, SRSLTE_DCI_FORMAT2A}, 
+                                               {SRSLTE_DCI_FORMAT1A, SRSLTE_DCI_FORMAT2}}; 
 const uint32_t nof_ue_formats = 2; 
 
 static srslte_dci_format_t common_formats[] = {SRSLTE_DCI_FORMAT1A,SRSLTE_DCI_FORMAT1C};
@@ -70,6 +74,7 @@ int srslte_ue_dl_init_multi(srslte_ue_dl_t *q,
     q->pending_ul_dci_rnti = 0; 
     q->sample_offset = 0; 
     q->nof_rx_antennas = nof_rx_antennas; 
+    q->tm = q->cell.nof_ports>1?2:1; 
     
     if (srslte_ofdm_rx_init(&q->fft, q->cell.cp, q->cell.nof_prb)) {
       fprintf(stderr, "Error initiating FFT\n");
@@ -196,6 +201,17 @@ void srslte_ue_dl_set_sample_offset(srslte_ue_dl_t * q, float sample_offset) {
   q->sample_offset = sample_offset; 
 }
 
+/* Sets the transmission mode (1 to 4) configured by higher layers. TM3 and TM4 search DCI formats 2A and 2 
+ * in the UE-specific search space and enable the RI/PMI selection of the PDSCH receiver */
+int srslte_ue_dl_set_tm(srslte_ue_dl_t *q, uint32_t tm) {
+  if (tm < 1 || tm > 4 || (tm > 2 && q->cell.nof_ports < 2)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+  q->tm = tm; 
+  srslte_pdsch_set_ri_pmi_report(&q->pdsch, tm > 2, q->cell.nof_ports); 
+  return SRSLTE_SUCCESS; 
+}
+
 /** Applies the following operations to a subframe of synchronized samples: 
  *    - OFDM demodulation
  *    - Channel estimation 
@@ -251,6 +267,11 @@ int srslte_ue_dl_decode_estimate(srslte_ue_dl_t *q, uint32_t sf_idx, uint32_t *c
     /* Get channel estimates for each port */
     srslte_chest_dl_estimate_multi(&q->chest, q->sf_symbols_m, q->ce_m, sf_idx, q->nof_rx_antennas);
 
+    /* In lazy mode interpolate the control region now and the data region once the grant is known */
+    if (q->chest.lazy) {
+      srslte_chest_dl_interpolate(&q->chest, q->ce_m, 0, q->cell.nof_prb<=10?4:3, NULL);
+    }
+
     /* First decode PCFICH and obtain CFI */
     if (srslte_pcfich_decode_multi(&q->pcfich, q->sf_symbols_m, q->ce_m, 
                              srslte_chest_dl_get_noise_estimate(&q->chest), 
@@ -273,9 +294,27 @@ int srslte_ue_dl_decode_estimate(srslte_ue_dl_t *q, uint32_t sf_idx, uint32_t *c
 }
 
 
+/* Configures the layers and precoding of the grant configured by srslte_ue_dl_cfg_grant() from the precoding 
+ * information of a DCI format 2 or 2A. Precoding information referring to the last PMI uses the PMI 
+ * selected by the PDSCH receiver */
+int srslte_ue_dl_cfg_grant_mimo(srslte_ue_dl_t *q, srslte_dci_format_t format, srslte_ra_dl_dci_t *dci) 
+{
+  uint32_t ri = 0, pmi = 0; 
+  srslte_pdsch_last_ri_pmi(&q->pdsch, &ri, &pmi);
+  return srslte_pdsch_cfg_mimo_dci(&q->pdsch_cfg, q->cell, format, dci, pmi); 
+}
+
 int srslte_ue_dl_cfg_grant(srslte_ue_dl_t *q, srslte_ra_dl_grant_t *grant, uint32_t cfi, uint32_t sf_idx, uint32_t rvidx) 
 {
-  return srslte_pdsch_cfg(&q->pdsch_cfg, q->cell, grant, cfi, sf_idx, rvidx);
+  int ret = srslte_pdsch_cfg(&q->pdsch_cfg, q->cell, grant, cfi, sf_idx, rvidx);
+  if (ret == SRSLTE_SUCCESS && q->chest.lazy && cfi < SRSLTE_CP_NSYMB(q->cell.cp)) {
+    bool prb_mask[SRSLTE_MAX_PRB]; 
+    for (uint32_t i=0;i<q->cell.nof_prb;i++) {
+      prb_mask[i] = grant->prb_idx[0][i] || grant->prb_idx[1][i]; 
+    }
+    ret = srslte_chest_dl_interpolate(&q->chest, q->ce_m, cfi, 2*SRSLTE_CP_NSYMB(q->cell.cp)-cfi, prb_mask);
+  }
+  return ret; 
 }
 
 int srslte_ue_dl_decode_rnti(srslte_ue_dl_t *q, cf_t *input, uint8_t *data, uint32_t tti, uint16_t rnti) 
@@ -330,7 +369,12 @@ int srslte_ue_dl_decode_rnti_multi(srslte_ue_dl_t *q, cf_t *input[SRSLTE_MAX_POR
       srslte_softbuffer_rx_reset_tbs(&q->softbuffer, grant.mcs.tbs);      
     }
 
-    if (srslte_ue_dl_cfg_grant(q, &grant, cfi, sf_idx, rvidx)) {
+    if (srslte_ue_dl_cfg_grant(q, &grant, cfi, sf_idx, rvidx) || 
+        srslte_ue_dl_cfg_grant_mimo(q, dci_msg.format, &dci_unpacked)) {
+      return SRSLTE_ERROR; 
+    }
+    if (q->pdsch_cfg.nof_cw > 1) {
+      fprintf(stderr, "Two codeword grants are not supported by srslte_ue_dl_decode()\n");
       return SRSLTE_ERROR; 
     }
     
@@ -340,6 +384,7 @@ int srslte_ue_dl_decode_rnti_multi(srslte_ue_dl_t *q, cf_t *input[SRSLTE_MAX_POR
   
     
     if (q->pdsch_cfg.grant.mcs.mod > 0 && q->pdsch_cfg.grant.mcs.tbs >= 0) {
+      srslte_sch_set_snr(&q->pdsch.dl_sch, srslte_chest_dl_get_snr(&q->chest));
       ret = srslte_pdsch_decode_multi(&q->pdsch, &q->pdsch_cfg, &q->softbuffer, 
                                     q->sf_symbols_m, q->ce_m, 
                                     noise_estimate, 
@@ -377,31 +422,34 @@ uint32_t srslte_ue_dl_get_ncce(srslte_ue_dl_t *q) {
 static int dci_blind_search(srslte_ue_dl_t *q, dci_blind_search_t *search_space, uint16_t rnti, srslte_dci_msg_t *dci_msg) 
 {
   int ret = SRSLTE_ERROR; 
-  uint16_t crc_rem = 0; 
+  srslte_dci_msg_t msgs[MAX_CANDIDATES];
+  uint16_t crc_rem[MAX_CANDIDATES]; 
   if (rnti) {
     ret = 0; 
+    DEBUG("Searching format %s in %d locations\n", 
+          srslte_dci_format_string(search_space->format), search_space->nof_locations);
+    
+    // Decode all candidates at once and check them in the same order as they were generated 
+    if (srslte_pdcch_decode_msg_batch(&q->pdcch, msgs, search_space->loc, search_space->nof_locations, 
+                                      search_space->format, crc_rem)) {
+      fprintf(stderr, "Error decoding DCI msg\n");
+      return SRSLTE_ERROR;
+    }
     int i=0;
     while (!ret && i < search_space->nof_locations) {
-      DEBUG("Searching format %s in %d,%d (%d/%d)\n", 
-             srslte_dci_format_string(search_space->format), search_space->loc[i].ncce, search_space->loc[i].L, 
-             i, search_space->nof_locations);
-      
-      if (srslte_pdcch_decode_msg(&q->pdcch, dci_msg, &search_space->loc[i], search_space->format, &crc_rem)) {
-        fprintf(stderr, "Error decoding DCI msg\n");
-        return SRSLTE_ERROR;
-      }
-      if (crc_rem == rnti) {        
+      if (crc_rem[i] == rnti) {        
         // If searching for Format1A but found Format0 save it for later 
-        if (dci_msg->format == SRSLTE_DCI_FORMAT0 && search_space->format == SRSLTE_DCI_FORMAT1A) 
+        if (msgs[i].format == SRSLTE_DCI_FORMAT0 && search_space->format == SRSLTE_DCI_FORMAT1A) 
         {
           if (!q->pending_ul_dci_rnti) {
-            q->pending_ul_dci_rnti = crc_rem; 
-            memcpy(&q->pending_ul_dci_msg, dci_msg, sizeof(srslte_dci_msg_t));          
+            q->pending_ul_dci_rnti = crc_rem[i]; 
+            memcpy(&q->pending_ul_dci_msg, &msgs[i], sizeof(srslte_dci_msg_t));          
             memcpy(&q->last_location_ul, &search_space->loc[i], sizeof(srslte_dci_location_t));          
           }
         // Else if we found it, save location and leave
-        } else if (dci_msg->format == search_space->format) {
+        } else if (msgs[i].format == search_space->format) {
           ret = 1; 
+          memcpy(dci_msg, &msgs[i], sizeof(srslte_dci_msg_t));
           if (dci_msg->format == SRSLTE_DCI_FORMAT0) {
             memcpy(&q->last_location_ul, &search_space->loc[i], sizeof(srslte_dci_location_t));          
           } else {
@@ -501,7 +549,7 @@ static int find_dl_dci_type_crnti(srslte_ue_dl_t *q, uint32_t cfi, uint32_t sf_i
   
   INFO("Searching DL C-RNTI in %d ue locations, %d formats\n", current_ss->nof_locations, nof_ue_formats);
   for (int f=0;f<nof_ue_formats;f++) {
-    current_ss->format = ue_formats[f];   
+    current_ss->format = ue_formats[q->tm-1][f];   
     if ((ret = dci_blind_search(q, current_ss, rnti, dci_msg))) {
       return ret; 
     }
@@ -585,8 +633,8 @@ void srslte_ue_dl_save_signal(srslte_ue_dl_t *q, srslte_softbuffer_rx_t *softbuf
   srslte_vec_save_file("pdcch_llr", q->pdcch.llr, q->pdcch.nof_cce*72*sizeof(float));
   
   
-  srslte_vec_save_file("pdsch_symbols", q->pdsch.d, q->pdsch_cfg.nbits.nof_re*sizeof(cf_t));
-  srslte_vec_save_file("llr", q->pdsch.e, q->pdsch_cfg.nbits.nof_bits*sizeof(cf_t));
+  srslte_vec_save_file("pdsch_symbols", q->pdsch.d[0], q->pdsch_cfg.nbits.nof_re*sizeof(cf_t));
+  srslte_vec_save_file("llr", q->pdsch.e[0], q->pdsch_cfg.nbits.nof_bits*sizeof(cf_t));
   int cb_len = q->pdsch_cfg.cb_segm.K1; 
   for (int i=0;i<q->pdsch_cfg.cb_segm.C;i++) {
     char tmpstr[64]; 
@@ -31,8 +31,53 @@
 #include <string.h>
 #include <stddef.h>
 
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
 #include "srslte/phy/utils/bit.h"
 
+#if defined(LV_HAVE_AVX2) && defined(__GNUC__)
+/* The 16-bit AVX-512 interleaver is built with its own target attribute, whatever the compiler flags are, 
+ * and only runs if CPUID reports AVX512F and AVX512BW */
+#define BIT_HAVE_AVX512
+#define BIT_AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+
+static int bit_avx512_available() {
+  static int available = -1;
+  if (available < 0) {
+    __builtin_cpu_init();
+    available = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+  }
+  return available;
+}
+
+/* Same as the AVX2 loop in srslte_bit_interleave_w_offset() but 16 output bits per iteration. Returns the
+ * index of the first output byte not written */
+BIT_AVX512_TARGET static uint32_t bit_interleave_avx512(uint8_t *input, uint8_t *output, 
+                                                        uint16_t *interleaver, uint32_t i, uint32_t nof_bytes, 
+                                                        uint32_t w_offset_p) 
+{
+  const __m256i rev16 = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                         14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+  const __m512i m3_16 = _mm512_set1_epi32(3);
+  const __m512i m7_16 = _mm512_set1_epi32(7);
+  for (;i+2<=nof_bytes;i+=2) {
+    __m256i p = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*) &interleaver[i*8-w_offset_p]), rev16);
+    __m512i b = _mm512_cvtepu16_epi32(p);
+    __m512i byte = _mm512_srli_epi32(b, 3);
+    __m512i addr = _mm512_max_epi32(_mm512_sub_epi32(byte, m3_16), _mm512_setzero_si512());
+    __m512i w = _mm512_i32gather_epi32(addr, input, 1);
+    w = _mm512_sllv_epi32(w, _mm512_add_epi32(_mm512_and_si512(b, m7_16), 
+                                              _mm512_slli_epi32(_mm512_sub_epi32(_mm512_add_epi32(addr, m3_16), byte), 3)));
+    uint16_t m = (uint16_t) _mm512_cmplt_epi32_mask(w, _mm512_setzero_si512());
+    output[i]   = (uint8_t) m;
+    output[i+1] = (uint8_t) (m>>8);
+  }
+  return i;
+}
+#endif /* LV_HAVE_AVX2 && __GNUC__ */
+
 void srslte_bit_interleave(uint8_t *input, uint8_t *output, uint16_t *interleaver, uint32_t nof_bits) {
   srslte_bit_interleave_w_offset(input, output, interleaver, nof_bits, 0);
 }
@@ -53,7 +98,35 @@ void srslte_bit_interleave_w_offset(uint8_t *input, uint8_t *output, uint16_t *i
     }
     w_offset_p=8-w_offset;
   }
-  for (uint32_t i=st;i<nof_bits/8;i++) {
+  uint32_t i=st;
+#ifdef LV_HAVE_AVX2
+  /* Gather the 4 bytes ending at the byte of each source bit, so that it is the most significant 
+   * byte of the little-endian word, and shift the bit (b & 7) into the sign position. Words of the 
+   * first 3 bytes start at input instead and are shifted one byte more per byte they moved, so no 
+   * byte outside input[0..max(3, last source byte)] is read. The interleavers are permutations, 
+   * so with 32 bits or more the input has those 4 bytes. Indices are reversed so that the first 
+   * bit ends up in the MSB of the movemask output. 
+   */
+#ifdef BIT_HAVE_AVX512
+  if (bit_avx512_available() && nof_bits >= 32) {
+    i = bit_interleave_avx512(input, output, interleaver, i, nof_bits/8, w_offset_p);
+  }
+#endif /* BIT_HAVE_AVX512 */
+  const __m128i rev8 = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+  const __m256i m3_8 = _mm256_set1_epi32(3);
+  const __m256i m7_8 = _mm256_set1_epi32(7);
+  for (;i<nof_bits/8 && nof_bits >= 32;i++) {
+    __m128i p = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*) &interleaver[i*8-w_offset_p]), rev8);
+    __m256i b = _mm256_cvtepu16_epi32(p);
+    __m256i byte = _mm256_srli_epi32(b, 3);
+    __m256i addr = _mm256_max_epi32(_mm256_sub_epi32(byte, m3_8), _mm256_setzero_si256());
+    __m256i w = _mm256_i32gather_epi32((const int*) input, addr, 1);
+    w = _mm256_sllv_epi32(w, _mm256_add_epi32(_mm256_and_si256(b, m7_8), 
+                                              _mm256_slli_epi32(_mm256_sub_epi32(_mm256_add_epi32(addr, m3_8), byte), 3)));
+    output[i] = (uint8_t) _mm256_movemask_ps(_mm256_castsi256_ps(w));
+  }
+#endif /* LV_HAVE_AVX2 */
+  for (;i<nof_bits/8;i++) {
     
     uint16_t i_p0 = interleaver[i*8+0-w_offset_p];
     uint16_t i_p1 = interleaver[i*8+1-w_offset_p];      
@@ -0,0 +1,277 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <math.h>
+#include <complex.h>
+#include <sys/time.h>
+
+#include "srslte/srslte.h"
+
+uint32_t len = 1000;
+uint32_t nof_reps = 10000;
+
+void usage(char *prog) {
+  printf("Usage: %s [nr]\n", prog);
+  printf("\t-n Vector length [Default %d]\n", len);
+  printf("\t-r Number of repetitions to time each kernel [Default %d]\n", nof_reps);
+}
+
+void parse_args(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "nr")) != -1) {
+    switch (opt) {
+    case 'n':
+      len = atoi(argv[optind]);
+      break;
+    case 'r':
+      nof_reps = atoi(argv[optind]);
+      break;
+    default:
+      usage(argv[0]);
+      exit(-1);
+    }
+  }
+}
+
+/* Inputs and outputs shared by all kernels */
+cf_t *cx, *cy, *cz;
+float *fx, *fy, *fz;
+int16_t *sx, *sy, *sz;
+cf_t res_c;
+float res_f;
+int32_t res_i;
+
+typedef enum {
+  OUT_CF = 0, OUT_F, OUT_S, OUT_SCALAR_C, OUT_SCALAR_F, OUT_SCALAR_I
+} out_type_t;
+
+typedef struct {
+  const char *name;
+  void (*run)(uint32_t n);
+  out_type_t out;
+  float tol; 
+} kernel_t;
+
+static void run_acc_ff(uint32_t n)            { res_f = srslte_vec_acc_ff(fx, n); }
+static void run_acc_cc(uint32_t n)            { res_c = srslte_vec_acc_cc(cx, n); }
+static void run_sum_fff(uint32_t n)           { srslte_vec_sum_fff(fx, fy, fz, n); }
+static void run_sub_fff(uint32_t n)           { srslte_vec_sub_fff(fx, fy, fz, n); }
+static void run_sum_sss(uint32_t n)           { srslte_vec_sum_sss(sx, sy, sz, n); }
+static void run_sub_sss(uint32_t n)           { srslte_vec_sub_sss(sx, sy, sz, n); }
+static void run_prod_sss(uint32_t n)          { srslte_vec_prod_sss(sx, sy, sz, n); }
+static void run_sc_div2_sss(uint32_t n)       { srslte_vec_sc_div2_sss(sx, 2, sz, n); }
+static void run_dot_prod_sss(uint32_t n)      { res_i = srslte_vec_dot_prod_sss(sx, sy, n); }
+static void run_sc_prod_fff(uint32_t n)       { srslte_vec_sc_prod_fff(fx, 0.7, fz, n); }
+static void run_sc_prod_cfc(uint32_t n)       { srslte_vec_sc_prod_cfc(cx, 0.7, cz, n); }
+static void run_sc_prod_ccc(uint32_t n)       { srslte_vec_sc_prod_ccc(cx, 0.7-0.2*_Complex_I, cz, n); }
+static void run_convert_fi(uint32_t n)        { srslte_vec_convert_fi(fx, sz, 1000, n); }
+static void run_convert_if(uint32_t n)        { srslte_vec_convert_if(sx, fz, 3, n); }
+static void run_prod_fff(uint32_t n)          { srslte_vec_prod_fff(fx, fy, fz, n); }
+static void run_prod_cfc(uint32_t n)          { srslte_vec_prod_cfc(cx, fy, cz, n); }
+static void run_prod_ccc(uint32_t n)          { srslte_vec_prod_ccc(cx, cy, cz, n); }
+static void run_prod_conj_ccc(uint32_t n)     { srslte_vec_prod_conj_ccc(cx, cy, cz, n); }
+static void run_dot_prod_ccc(uint32_t n)      { res_c = srslte_vec_dot_prod_ccc(cx, cy, n); }
+static void run_dot_prod_cfc(uint32_t n)      { res_c = srslte_vec_dot_prod_cfc(cx, fy, n); }
+static void run_dot_prod_conj_ccc(uint32_t n) { res_c = srslte_vec_dot_prod_conj_ccc(cx, cy, n); }
+static void run_dot_prod_fff(uint32_t n)      { res_f = srslte_vec_dot_prod_fff(fx, fy, n); }
+static void run_abs_cf(uint32_t n)            { srslte_vec_abs_cf(cx, fz, n); }
+static void run_abs_square_cf(uint32_t n)     { srslte_vec_abs_square_cf(cx, fz, n); }
+
+/* Accumulations are summed in a different order by each instruction set. Float to int16 
+ * conversion rounds in the SIMD kernels and truncates in the generic one. 
+ */
+kernel_t kernels[] = {
+  {"acc_ff",            run_acc_ff,            OUT_SCALAR_F, 1e-3},
+  {"acc_cc",            run_acc_cc,            OUT_SCALAR_C, 1e-3},
+  {"sum_fff",           run_sum_fff,           OUT_F,        1e-6},
+  {"sub_fff",           run_sub_fff,           OUT_F,        1e-6},
+  {"sum_sss",           run_sum_sss,           OUT_S,        0},
+  {"sub_sss",           run_sub_sss,           OUT_S,        0},
+  {"prod_sss",          run_prod_sss,          OUT_S,        0},
+  {"sc_div2_sss",       run_sc_div2_sss,       OUT_S,        1},
+  {"dot_prod_sss",      run_dot_prod_sss,      OUT_SCALAR_I, 0},
+  {"sc_prod_fff",       run_sc_prod_fff,       OUT_F,        1e-6},
+  {"sc_prod_cfc",       run_sc_prod_cfc,       OUT_CF,       1e-6},
+  {"sc_prod_ccc",       run_sc_prod_ccc,       OUT_CF,       1e-5},
+  {"convert_fi",        run_convert_fi,        OUT_S,        1},
+  {"convert_if",        run_convert_if,        OUT_F,        1e-5},
+  {"prod_fff",          run_prod_fff,          OUT_F,        1e-6},
+  {"prod_cfc",          run_prod_cfc,          OUT_CF,       1e-6},
+  {"prod_ccc",          run_prod_ccc,          OUT_CF,       1e-5},
+  {"prod_conj_ccc",     run_prod_conj_ccc,     OUT_CF,       1e-5},
+  {"dot_prod_ccc",      run_dot_prod_ccc,      OUT_SCALAR_C, 1e-3},
+  {"dot_prod_cfc",      run_dot_prod_cfc,      OUT_SCALAR_C, 1e-3},
+  {"dot_prod_conj_ccc", run_dot_prod_conj_ccc, OUT_SCALAR_C, 1e-3},
+  {"dot_prod_fff",      run_dot_prod_fff,      OUT_SCALAR_F, 1e-3},
+  {"abs_cf",            run_abs_cf,            OUT_F,        1e-5},
+  {"abs_square_cf",     run_abs_square_cf,     OUT_F,        1e-5},
+};
+#define NOF_KERNELS (sizeof(kernels)/sizeof(kernel_t))
+
+/* Copies the output of a kernel as floats */
+static uint32_t get_output(out_type_t out, float *y) {
+  switch(out) {
+    case OUT_CF:
+      memcpy(y, cz, 2*len*sizeof(float));
+      return 2*len;
+    case OUT_F:
+      memcpy(y, fz, len*sizeof(float));
+      return len;
+    case OUT_S:
+      for (uint32_t i=0;i<len;i++) {
+        y[i] = sz[i];
+      }
+      return len;
+    case OUT_SCALAR_C:
+      y[0] = __real__ res_c;
+      y[1] = __imag__ res_c;
+      return 2;
+    case OUT_SCALAR_F:
+      y[0] = res_f;
+      return 1;
+    case OUT_SCALAR_I:
+      y[0] = res_i;
+      return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  struct timeval t[3];
+  int ret = -1;
+  float *ref = NULL, *out = NULL;
+  float ns[NOF_KERNELS][SRSLTE_VEC_NOF_ISA];
+
+  parse_args(argc, argv);
+
+  cx = srslte_vec_malloc(sizeof(cf_t)*len);
+  cy = srslte_vec_malloc(sizeof(cf_t)*len);
+  cz = srslte_vec_malloc(sizeof(cf_t)*len);
+  fx = srslte_vec_malloc(sizeof(float)*len);
+  fy = srslte_vec_malloc(sizeof(float)*len);
+  fz = srslte_vec_malloc(sizeof(float)*len);
+  sx = srslte_vec_malloc(sizeof(int16_t)*len);
+  sy = srslte_vec_malloc(sizeof(int16_t)*len);
+  sz = srslte_vec_malloc(sizeof(int16_t)*len);
+  ref = srslte_vec_malloc(sizeof(float)*2*len*NOF_KERNELS);
+  out = srslte_vec_malloc(sizeof(float)*2*len);
+  if (!cx || !cy || !cz || !fx || !fy || !fz || !sx || !sy || !sz || !ref || !out) {
+    perror("malloc");
+    goto clean_exit;
+  }
+
+  /* int16 inputs are kept small so that the int16 dot product does not overflow */
+  for (uint32_t i=0;i<len;i++) {
+    cx[i] = (float) rand()/RAND_MAX - 0.5 + _Complex_I*((float) rand()/RAND_MAX - 0.5);
+    cy[i] = (float) rand()/RAND_MAX - 0.5 + _Complex_I*((float) rand()/RAND_MAX - 0.5);
+    fx[i] = (float) rand()/RAND_MAX - 0.5;
+    fy[i] = (float) rand()/RAND_MAX - 0.5;
+    sx[i] = rand()%9 - 4;
+    sy[i] = rand()%9 - 4;
+  }
+
+  srslte_vec_isa_t best_isa = srslte_vec_get_isa();
+  printf("Selected instruction set: %s\n", srslte_vec_isa_string(best_isa));
+
+  /* The generic kernels give the reference outputs */
+  srslte_vec_set_isa(SRSLTE_VEC_ISA_GENERIC);
+  for (uint32_t k=0;k<NOF_KERNELS;k++) {
+    kernels[k].run(len);
+    get_output(kernels[k].out, &ref[2*len*k]);
+  }
+
+  uint32_t nof_errors = 0;
+  for (uint32_t isa=0;isa<SRSLTE_VEC_NOF_ISA;isa++) {
+    if (srslte_vec_set_isa(isa)) {
+      continue;
+    }
+    for (uint32_t k=0;k<NOF_KERNELS;k++) {
+      kernels[k].run(len);
+      uint32_t n = get_output(kernels[k].out, out);
+      for (uint32_t i=0;i<n;i++) {
+        float r = ref[2*len*k+i];
+        if (fabsf(out[i] - r) > kernels[k].tol*(1+fabsf(r))) {
+          fprintf(stderr, "%s %s: output %d is %f, expected %f\n",
+                  srslte_vec_isa_string(isa), kernels[k].name, i, out[i], r);
+          nof_errors++;
+          break;
+        }
+      }
+
+      gettimeofday(&t[1], NULL);
+      for (uint32_t r=0;r<nof_reps;r++) {
+        kernels[k].run(len);
+      }
+      gettimeofday(&t[2], NULL);
+      get_time_interval(t);
+      ns[k][isa] = (float) (t[0].tv_sec*1e9 + t[0].tv_usec*1e3)/nof_reps/len;
+    }
+  }
+  srslte_vec_set_isa(best_isa);
+
+  printf("%-18s", "ns/element");
+  for (uint32_t isa=0;isa<SRSLTE_VEC_NOF_ISA;isa++) {
+    if (srslte_vec_isa_supported(isa)) {
+      printf("%10s", srslte_vec_isa_string(isa));
+    }
+  }
+  printf("\n");
+  for (uint32_t k=0;k<NOF_KERNELS;k++) {
+    printf("%-18s", kernels[k].name);
+    for (uint32_t isa=0;isa<SRSLTE_VEC_NOF_ISA;isa++) {
+      if (srslte_vec_isa_supported(isa)) {
+        printf("%10.3f", ns[k][isa]);
+      }
+    }
+    printf("\n");
+  }
+
+  ret = nof_errors?-1:0;
+
+clean_exit:
+  if (cx) free(cx);
+  if (cy) free(cy);
+  if (cz) free(cz);
+  if (fx) free(fx);
+  if (fy) free(fy);
+  if (fz) free(fz);
+  if (sx) free(sx);
+  if (sy) free(sy);
+  if (sz) free(sz);
+  if (ref) free(ref);
+  if (out) free(out);
+  if (ret) {
+    printf("Error\n");
+  } else {
+    printf("Ok\n");
+  }
+  exit(ret);
+}
@@ -55,7 +55,7 @@ int srslte_vec_acc_ii(int *x, uint32_t len) {
   return z;
 }
 
-float srslte_vec_acc_ff(float *x, uint32_t len) {
+float srslte_vec_acc_ff_gen(float *x, uint32_t len) {
 #ifdef HAVE_VOLK_ACC_FUNCTION
   float result;
   volk_32f_accumulator_s32f(&result,x,len);
@@ -76,7 +76,7 @@ void srslte_vec_ema_filter(cf_t *new_data, cf_t *average, cf_t *output, float co
   srslte_vec_sum_ccc(output, new_data, output, len);
 }
 
-cf_t srslte_vec_acc_cc(cf_t *x, uint32_t len) {
+cf_t srslte_vec_acc_cc_gen(cf_t *x, uint32_t len) {
   int i;
   cf_t z=0;
   for (i=0;i<len;i++) {
@@ -98,7 +98,7 @@ void srslte_vec_square_dist(cf_t symbol, cf_t *points, float *distance, uint32_t
 #endif 
 }
 
-void srslte_vec_sub_fff(float *x, float *y, float *z, uint32_t len) {
+void srslte_vec_sub_fff_gen(float *x, float *y, float *z, uint32_t len) {
 #ifndef HAVE_VOLK_SUB_FLOAT_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -109,26 +109,18 @@ void srslte_vec_sub_fff(float *x, float *y, float *z, uint32_t len) {
 #endif 
 }
 
-void srslte_vec_sub_sss(short *x, short *y, short *z, uint32_t len) {
-#ifdef LV_HAVE_AVX2
-  srslte_vec_sub_sss_avx2(x, y, z, len);
-#else
-#ifdef LV_HAVE_SSE
-  srslte_vec_sub_sss_sse(x, y, z, len);
-#else
-    int i;
+void srslte_vec_sub_sss_gen(short *x, short *y, short *z, uint32_t len) {
+  int i;
   for (i=0;i<len;i++) {
     z[i] = x[i]-y[i];
   }
-#endif
-#endif
 }
 
 void srslte_vec_sub_ccc(cf_t *x, cf_t *y, cf_t *z, uint32_t len) {
   return srslte_vec_sub_fff((float*) x,(float*) y,(float*) z, 2*len);
 }
 
-void srslte_vec_sum_fff(float *x, float *y, float *z, uint32_t len) {
+void srslte_vec_sum_fff_gen(float *x, float *y, float *z, uint32_t len) {
 #ifndef HAVE_VOLK_ADD_FLOAT_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -139,19 +131,11 @@ void srslte_vec_sum_fff(float *x, float *y, float *z, uint32_t len) {
 #endif
 }
 
-void srslte_vec_sum_sss(short *x, short *y, short *z, uint32_t len) {
-#ifdef LV_HAVE_AVX2
-  srslte_vec_sum_sss_avx2(x, y, z, len);
-#else
-#ifdef LV_HAVE_SSE
-  srslte_vec_sum_sss_sse(x, y, z, len);
-#else
+void srslte_vec_sum_sss_gen(short *x, short *y, short *z, uint32_t len) {
   int i;
   for (i=0;i<len;i++) {
     z[i] = x[i]+y[i];
   }
-#endif
-#endif
 }
 
 void srslte_vec_sum_ccc(cf_t *x, cf_t *y, cf_t *z, uint32_t len) {
@@ -193,7 +177,7 @@ void srslte_vec_sc_add_sss(int16_t *x, int16_t h, int16_t *z, uint32_t len) {
   }
 }
 
-void srslte_vec_sc_prod_fff(float *x, float h, float *z, uint32_t len) {
+void srslte_vec_sc_prod_fff_gen(float *x, float h, float *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT_FLOAT_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -211,20 +195,12 @@ void srslte_vec_sc_prod_sfs(short *x, float h, short *z, uint32_t len) {
   }
 }
 
-void srslte_vec_sc_div2_sss(short *x, int n_rightshift, short *z, uint32_t len) {
-#ifdef LV_HAVE_AVX2
-  srslte_vec_sc_div2_sss_avx2(x, n_rightshift, z, len);
-#else
-#ifdef LV_HAVE_SSE
-  srslte_vec_sc_div2_sss_sse(x, n_rightshift, z, len);
-#else
+void srslte_vec_sc_div2_sss_gen(short *x, int n_rightshift, short *z, uint32_t len) {
   int i;
   int pow2_div = 1<<n_rightshift;
   for (i=0;i<len;i++) {
     z[i] = x[i]/pow2_div;
   }
-#endif
-#endif
 }
 
 // TODO: Improve this implementation
@@ -238,19 +214,14 @@ void srslte_vec_norm_cfc(cf_t *x, float amplitude, cf_t *y, uint32_t len) {
   srslte_vec_sc_prod_cfc(x, amplitude/max, y, len);
 }
 
-void srslte_vec_sc_prod_cfc(cf_t *x, float h, cf_t *z, uint32_t len) {
-#ifdef LV_HAVE_AVX
-  srslte_vec_mult_scalar_cf_f_avx(z,x, h, len);  
-#else
+void srslte_vec_sc_prod_cfc_gen(cf_t *x, float h, cf_t *z, uint32_t len) {
   int i;
   for (i=0;i<len;i++) {
     z[i] = x[i]*h;
   }
-
-#endif
 }
 
-void srslte_vec_sc_prod_ccc(cf_t *x, cf_t h, cf_t *z, uint32_t len) {
+void srslte_vec_sc_prod_ccc_gen(cf_t *x, cf_t h, cf_t *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -261,7 +232,7 @@ void srslte_vec_sc_prod_ccc(cf_t *x, cf_t h, cf_t *z, uint32_t len) {
 #endif
 }
 
-void srslte_vec_convert_if(int16_t *x, float *z, float scale, uint32_t len) {
+void srslte_vec_convert_if_gen(int16_t *x, float *z, float scale, uint32_t len) {
 #ifndef HAVE_VOLK_CONVERT_IF_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -284,15 +255,11 @@ void srslte_vec_convert_ci(int8_t *x, int16_t *z, uint32_t len) {
 #endif  
 }
 
-void srslte_vec_convert_fi(float *x, int16_t *z, float scale, uint32_t len) {
-#ifndef LV_HAVE_SSE
+void srslte_vec_convert_fi_gen(float *x, int16_t *z, float scale, uint32_t len) {
   int i;
   for (i=0;i<len;i++) {
     z[i] = (int16_t) (x[i]*scale);
   }
-#else 
-  srslte_vec_convert_fi_sse(x, z, scale, len);
-#endif
 }
 
 void srslte_vec_lut_fuf(float *x, uint32_t *lut, float *y, uint32_t len) {
@@ -497,7 +464,7 @@ void srslte_vec_conj_cc(cf_t *x, cf_t *y, uint32_t len) {
 #endif
 }
 
-void srslte_vec_prod_cfc(cf_t *x, float *y, cf_t *z, uint32_t len) {
+void srslte_vec_prod_cfc_gen(cf_t *x, float *y, cf_t *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT_REAL_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -508,7 +475,7 @@ void srslte_vec_prod_cfc(cf_t *x, float *y, cf_t *z, uint32_t len) {
 #endif
 }
 
-void srslte_vec_prod_fff(float *x, float *y, float *z, uint32_t len) {
+void srslte_vec_prod_fff_gen(float *x, float *y, float *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT_REAL2_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -519,22 +486,14 @@ void srslte_vec_prod_fff(float *x, float *y, float *z, uint32_t len) {
 #endif
 }
 
-void srslte_vec_prod_sss(short *x, short *y, short *z, uint32_t len) {
-#ifdef LV_HAVE_AVX2
-  srslte_vec_prod_sss_avx2(x,y,z,len);
-#else
-#ifdef LV_HAVE_SSE
-  srslte_vec_prod_sss_sse(x,y,z,len);
-#else
+void srslte_vec_prod_sss_gen(short *x, short *y, short *z, uint32_t len) {
   int i;
   for (i=0;i<len;i++) {
     z[i] = x[i]*y[i];
   }
-#endif
-#endif
 }
 
-void srslte_vec_prod_ccc(cf_t *x,cf_t *y, cf_t *z, uint32_t len) {
+void srslte_vec_prod_ccc_gen(cf_t *x,cf_t *y, cf_t *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT2_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -546,7 +505,7 @@ void srslte_vec_prod_ccc(cf_t *x,cf_t *y, cf_t *z, uint32_t len) {
 }
 
 
-void srslte_vec_prod_conj_ccc(cf_t *x,cf_t *y, cf_t *z, uint32_t len) {
+void srslte_vec_prod_conj_ccc_gen(cf_t *x,cf_t *y, cf_t *z, uint32_t len) {
 #ifndef HAVE_VOLK_MULT2_CONJ_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -599,7 +558,7 @@ void srslte_vec_div_fff(float *x, float *y, float *z, uint32_t len) {
 #endif
 }
 
-cf_t srslte_vec_dot_prod_ccc(cf_t *x, cf_t *y, uint32_t len) {
+cf_t srslte_vec_dot_prod_ccc_gen(cf_t *x, cf_t *y, uint32_t len) {
 #ifdef HAVE_VOLK_DOTPROD_FC_FUNCTION
   cf_t res;
   volk_32fc_x2_dot_prod_32fc(&res, x, y, len);
@@ -614,7 +573,7 @@ cf_t srslte_vec_dot_prod_ccc(cf_t *x, cf_t *y, uint32_t len) {
 #endif
 }
 
-cf_t srslte_vec_dot_prod_cfc(cf_t *x, float *y, uint32_t len) {
+cf_t srslte_vec_dot_prod_cfc_gen(cf_t *x, float *y, uint32_t len) {
 #ifdef HAVE_VOLK_DOTPROD_CFC_FUNCTION
   cf_t res;
   volk_32fc_32f_dot_prod_32fc(&res, x, y, len);
@@ -629,7 +588,7 @@ cf_t srslte_vec_dot_prod_cfc(cf_t *x, float *y, uint32_t len) {
 #endif
 }
 
-cf_t srslte_vec_dot_prod_conj_ccc(cf_t *x, cf_t *y, uint32_t len) {
+cf_t srslte_vec_dot_prod_conj_ccc_gen(cf_t *x, cf_t *y, uint32_t len) {
 #ifdef HAVE_VOLK_DOTPROD_CONJ_FC_FUNCTION
   cf_t res;
   volk_32fc_x2_conjugate_dot_prod_32fc(&res, x, y, len);
@@ -645,7 +604,7 @@ cf_t srslte_vec_dot_prod_conj_ccc(cf_t *x, cf_t *y, uint32_t len) {
 }
 
 
-float srslte_vec_dot_prod_fff(float *x, float *y, uint32_t len) {
+float srslte_vec_dot_prod_fff_gen(float *x, float *y, uint32_t len) {
 #ifdef HAVE_VOLK_DOTPROD_F_FUNCTION
   float res;
   volk_32f_x2_dot_prod_32f(&res, x, y, len);
@@ -660,28 +619,20 @@ float srslte_vec_dot_prod_fff(float *x, float *y, uint32_t len) {
 #endif  
 }
 
-int32_t srslte_vec_dot_prod_sss(int16_t *x, int16_t *y, uint32_t len) {
-#ifdef LV_HAVE_AVX2
-  return srslte_vec_dot_prod_sss_avx2(x, y, len);
-#else
-#ifdef LV_HAVE_SSE
-  return srslte_vec_dot_prod_sss_sse(x, y, len);
-#else
+int32_t srslte_vec_dot_prod_sss_gen(int16_t *x, int16_t *y, uint32_t len) {
   uint32_t i;
   int32_t res = 0;
   for (i=0;i<len;i++) {
     res += x[i]*y[i];
   }
   return res;
-#endif
-#endif
 }
 
 float srslte_vec_avg_power_cf(cf_t *x, uint32_t len) {
   return crealf(srslte_vec_dot_prod_conj_ccc(x,x,len)) / len;
 }
 
-void srslte_vec_abs_cf(cf_t *x, float *abs, uint32_t len) {
+void srslte_vec_abs_cf_gen(cf_t *x, float *abs, uint32_t len) {
 #ifndef HAVE_VOLK_MAG_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -691,7 +642,7 @@ void srslte_vec_abs_cf(cf_t *x, float *abs, uint32_t len) {
   volk_32fc_magnitude_32f(abs,x,len);
 #endif
 }
-void srslte_vec_abs_square_cf(cf_t *x, float *abs_square, uint32_t len) {
+void srslte_vec_abs_square_cf_gen(cf_t *x, float *abs_square, uint32_t len) {
 #ifndef HAVE_VOLK_MAG_SQUARE_FUNCTION
   int i;
   for (i=0;i<len;i++) {
@@ -0,0 +1,328 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* AVX2+FMA vector kernels. This file is built with -mavx2 -mfma regardless of the 
+ * target CPU and its functions are only called if vector_dispatch.c detects support. 
+ */
+
+#include <complex.h>
+#include <immintrin.h>
+
+#include "srslte/phy/utils/vector_simd.h"
+
+/* Complex product of 4 interleaved complex values */
+static inline __m256 prod_ccc_avx2(__m256 a, __m256 b) 
+{
+  __m256 b_re = _mm256_moveldup_ps(b);
+  __m256 b_im = _mm256_movehdup_ps(b);
+  __m256 a_sw = _mm256_permute_ps(a, 0xB1);
+  return _mm256_fmaddsub_ps(a, b_re, _mm256_mul_ps(a_sw, b_im));
+}
+
+/* a*conj(b) of 4 interleaved complex values */
+static inline __m256 prod_conj_ccc_avx2(__m256 a, __m256 b) 
+{
+  __m256 b_re = _mm256_moveldup_ps(b);
+  __m256 b_im = _mm256_movehdup_ps(b);
+  __m256 a_sw = _mm256_permute_ps(a, 0xB1);
+  return _mm256_fmsubadd_ps(a, b_re, _mm256_mul_ps(a_sw, b_im));
+}
+
+/* Loads 4 floats and repeats each of them for the real and imaginary part */
+static inline __m256 load_dup_avx2(float *y) 
+{
+  const __m256i idx = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  return _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(y)), idx);
+}
+
+static inline float hsum_avx2(__m256 a) 
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_movehdup_ps(s));
+  return _mm_cvtss_f32(s);
+}
+
+/* Sums the real and imaginary parts of 4 interleaved complex values */
+static inline cf_t hsum_cf_avx2(__m256 a) 
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(s) + _Complex_I * _mm_cvtss_f32(_mm_movehdup_ps(s));
+}
+
+float srslte_vec_acc_ff_avx2(float *x, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc = _mm256_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    acc = _mm256_add_ps(acc, _mm256_loadu_ps(&x[i]));
+  }
+  float z = hsum_avx2(acc);
+  for (;i<len;i++) {
+    z += x[i];
+  }
+  return z;
+}
+
+cf_t srslte_vec_acc_cc_avx2(cf_t *x, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc = _mm256_setzero_ps();
+  for (;i+4<=len;i+=4) {
+    acc = _mm256_add_ps(acc, _mm256_loadu_ps((float*) &x[i]));
+  }
+  cf_t z = hsum_cf_avx2(acc);
+  for (;i<len;i++) {
+    z += x[i];
+  }
+  return z;
+}
+
+void srslte_vec_sum_fff_avx2(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&z[i], _mm256_add_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]+y[i];
+  }
+}
+
+void srslte_vec_sub_fff_avx2(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&z[i], _mm256_sub_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]-y[i];
+  }
+}
+
+void srslte_vec_sc_prod_fff_avx2(float *x, float h, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 hh = _mm256_set1_ps(h);
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&z[i], _mm256_mul_ps(_mm256_loadu_ps(&x[i]), hh));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*h;
+  }
+}
+
+void srslte_vec_sc_prod_cfc_avx2(cf_t *x, float h, cf_t *z, uint32_t len) 
+{
+  srslte_vec_sc_prod_fff_avx2((float*) x, h, (float*) z, 2*len);
+}
+
+void srslte_vec_sc_prod_ccc_avx2(cf_t *x, cf_t h, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 h_re = _mm256_set1_ps(__real__ h);
+  __m256 h_im = _mm256_set1_ps(__imag__ h);
+  for (;i+4<=len;i+=4) {
+    __m256 a    = _mm256_loadu_ps((float*) &x[i]);
+    __m256 a_sw = _mm256_permute_ps(a, 0xB1);
+    _mm256_storeu_ps((float*) &z[i], _mm256_fmaddsub_ps(a, h_re, _mm256_mul_ps(a_sw, h_im)));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*h;
+  }
+}
+
+/* Rounds to the nearest integer and saturates, like srslte_vec_convert_fi_sse() */
+void srslte_vec_convert_fi_avx2(float *x, int16_t *z, float scale, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 s = _mm256_set1_ps(scale);
+  for (;i+16<=len;i+=16) {
+    __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&x[i]), s));
+    __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(&x[i+8]), s));
+    __m256i c = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    _mm256_storeu_si256((__m256i*) &z[i], c);
+  }
+  for (;i<len;i++) {
+    z[i] = (int16_t) (x[i]*scale);
+  }
+}
+
+void srslte_vec_convert_if_avx2(int16_t *x, float *z, float scale, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 s = _mm256_set1_ps(1.0f/scale);
+  for (;i+8<=len;i+=8) {
+    __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*) &x[i]));
+    _mm256_storeu_ps(&z[i], _mm256_mul_ps(_mm256_cvtepi32_ps(a), s));
+  }
+  for (;i<len;i++) {
+    z[i] = ((float) x[i])/scale;
+  }
+}
+
+void srslte_vec_prod_fff_avx2(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&z[i], _mm256_mul_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_cfc_avx2(cf_t *x, float *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+4<=len;i+=4) {
+    _mm256_storeu_ps((float*) &z[i], _mm256_mul_ps(_mm256_loadu_ps((float*) &x[i]), load_dup_avx2(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_ccc_avx2(cf_t *x, cf_t *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+4<=len;i+=4) {
+    __m256 c = prod_ccc_avx2(_mm256_loadu_ps((float*) &x[i]), _mm256_loadu_ps((float*) &y[i]));
+    _mm256_storeu_ps((float*) &z[i], c);
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_conj_ccc_avx2(cf_t *x, cf_t *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+4<=len;i+=4) {
+    __m256 c = prod_conj_ccc_avx2(_mm256_loadu_ps((float*) &x[i]), _mm256_loadu_ps((float*) &y[i]));
+    _mm256_storeu_ps((float*) &z[i], c);
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*conjf(y[i]);
+  }
+}
+
+/* The real and imaginary cross terms are accumulated separately and combined once at the end */
+cf_t srslte_vec_dot_prod_ccc_avx2(cf_t *x, cf_t *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc_re = _mm256_setzero_ps();
+  __m256 acc_im = _mm256_setzero_ps();
+  for (;i+4<=len;i+=4) {
+    __m256 a = _mm256_loadu_ps((float*) &x[i]);
+    __m256 b = _mm256_loadu_ps((float*) &y[i]);
+    acc_re = _mm256_fmadd_ps(a, _mm256_moveldup_ps(b), acc_re);
+    acc_im = _mm256_fmadd_ps(_mm256_permute_ps(a, 0xB1), _mm256_movehdup_ps(b), acc_im);
+  }
+  cf_t res = hsum_cf_avx2(_mm256_addsub_ps(acc_re, acc_im));
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+cf_t srslte_vec_dot_prod_conj_ccc_avx2(cf_t *x, cf_t *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc_re = _mm256_setzero_ps();
+  __m256 acc_im = _mm256_setzero_ps();
+  for (;i+4<=len;i+=4) {
+    __m256 a = _mm256_loadu_ps((float*) &x[i]);
+    __m256 b = _mm256_loadu_ps((float*) &y[i]);
+    acc_re = _mm256_fmadd_ps(a, _mm256_moveldup_ps(b), acc_re);
+    acc_im = _mm256_fmadd_ps(_mm256_permute_ps(a, 0xB1), _mm256_movehdup_ps(b), acc_im);
+  }
+  cf_t res = hsum_cf_avx2(_mm256_addsub_ps(acc_re, _mm256_sub_ps(_mm256_setzero_ps(), acc_im)));
+  for (;i<len;i++) {
+    res += x[i]*conjf(y[i]);
+  }
+  return res;
+}
+
+cf_t srslte_vec_dot_prod_cfc_avx2(cf_t *x, float *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc = _mm256_setzero_ps();
+  for (;i+4<=len;i+=4) {
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps((float*) &x[i]), load_dup_avx2(&y[i]), acc);
+  }
+  cf_t res = hsum_cf_avx2(acc);
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+float srslte_vec_dot_prod_fff_avx2(float *x, float *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m256 acc = _mm256_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps(&x[i]), _mm256_loadu_ps(&y[i]), acc);
+  }
+  float res = hsum_avx2(acc);
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+/* Squares 8 complex values and adds the real and imaginary parts of each one */
+static inline __m256 abs_square_avx2(cf_t *x) 
+{
+  __m256 a = _mm256_loadu_ps((float*) &x[0]);
+  __m256 b = _mm256_loadu_ps((float*) &x[4]);
+  __m256 s = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(s), 0xD8));
+}
+
+void srslte_vec_abs_square_cf_avx2(cf_t *x, float *abs_square, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&abs_square[i], abs_square_avx2(&x[i]));
+  }
+  for (;i<len;i++) {
+    abs_square[i] = crealf(x[i])*crealf(x[i])+cimagf(x[i])*cimagf(x[i]);
+  }
+}
+
+void srslte_vec_abs_cf_avx2(cf_t *x, float *abs, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm256_storeu_ps(&abs[i], _mm256_sqrt_ps(abs_square_avx2(&x[i])));
+  }
+  for (;i<len;i++) {
+    abs[i] = cabsf(x[i]);
+  }
+}
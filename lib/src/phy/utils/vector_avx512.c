@@ -0,0 +1,324 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* AVX-512F vector kernels. This file is built with -mavx512f regardless of the 
+ * target CPU and its functions are only called if vector_dispatch.c detects support. 
+ */
+
+#include <complex.h>
+#include <immintrin.h>
+
+#include "srslte/phy/utils/vector_simd.h"
+
+/* Lanes holding the real part of interleaved complex values */
+#define RE_MASK 0x5555
+#define IM_MASK 0xAAAA
+
+/* Complex product of 8 interleaved complex values */
+static inline __m512 prod_ccc_avx512(__m512 a, __m512 b) 
+{
+  __m512 b_re = _mm512_moveldup_ps(b);
+  __m512 b_im = _mm512_movehdup_ps(b);
+  __m512 a_sw = _mm512_permute_ps(a, 0xB1);
+  return _mm512_fmaddsub_ps(a, b_re, _mm512_mul_ps(a_sw, b_im));
+}
+
+/* a*conj(b) of 8 interleaved complex values */
+static inline __m512 prod_conj_ccc_avx512(__m512 a, __m512 b) 
+{
+  __m512 b_re = _mm512_moveldup_ps(b);
+  __m512 b_im = _mm512_movehdup_ps(b);
+  __m512 a_sw = _mm512_permute_ps(a, 0xB1);
+  return _mm512_fmsubadd_ps(a, b_re, _mm512_mul_ps(a_sw, b_im));
+}
+
+/* Loads 8 floats and repeats each of them for the real and imaginary part */
+static inline __m512 load_dup_avx512(float *y) 
+{
+  const __m512i idx = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+  return _mm512_permutexvar_ps(idx, _mm512_castps256_ps512(_mm256_loadu_ps(y)));
+}
+
+static inline cf_t hsum_cf_avx512(__m512 a) 
+{
+  return _mm512_mask_reduce_add_ps(RE_MASK, a) + _Complex_I * _mm512_mask_reduce_add_ps(IM_MASK, a);
+}
+
+float srslte_vec_acc_ff_avx512(float *x, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc = _mm512_setzero_ps();
+  for (;i+16<=len;i+=16) {
+    acc = _mm512_add_ps(acc, _mm512_loadu_ps(&x[i]));
+  }
+  float z = _mm512_reduce_add_ps(acc);
+  for (;i<len;i++) {
+    z += x[i];
+  }
+  return z;
+}
+
+cf_t srslte_vec_acc_cc_avx512(cf_t *x, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc = _mm512_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    acc = _mm512_add_ps(acc, _mm512_loadu_ps((float*) &x[i]));
+  }
+  cf_t z = hsum_cf_avx512(acc);
+  for (;i<len;i++) {
+    z += x[i];
+  }
+  return z;
+}
+
+void srslte_vec_sum_fff_avx512(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&z[i], _mm512_add_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]+y[i];
+  }
+}
+
+void srslte_vec_sub_fff_avx512(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&z[i], _mm512_sub_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]-y[i];
+  }
+}
+
+void srslte_vec_sc_prod_fff_avx512(float *x, float h, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 hh = _mm512_set1_ps(h);
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&z[i], _mm512_mul_ps(_mm512_loadu_ps(&x[i]), hh));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*h;
+  }
+}
+
+void srslte_vec_sc_prod_cfc_avx512(cf_t *x, float h, cf_t *z, uint32_t len) 
+{
+  srslte_vec_sc_prod_fff_avx512((float*) x, h, (float*) z, 2*len);
+}
+
+void srslte_vec_sc_prod_ccc_avx512(cf_t *x, cf_t h, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 h_re = _mm512_set1_ps(__real__ h);
+  __m512 h_im = _mm512_set1_ps(__imag__ h);
+  for (;i+8<=len;i+=8) {
+    __m512 a    = _mm512_loadu_ps((float*) &x[i]);
+    __m512 a_sw = _mm512_permute_ps(a, 0xB1);
+    _mm512_storeu_ps((float*) &z[i], _mm512_fmaddsub_ps(a, h_re, _mm512_mul_ps(a_sw, h_im)));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*h;
+  }
+}
+
+/* Rounds to the nearest integer and saturates, like srslte_vec_convert_fi_sse() */
+void srslte_vec_convert_fi_avx512(float *x, int16_t *z, float scale, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 s = _mm512_set1_ps(scale);
+  for (;i+16<=len;i+=16) {
+    __m512i a = _mm512_cvtps_epi32(_mm512_mul_ps(_mm512_loadu_ps(&x[i]), s));
+    _mm256_storeu_si256((__m256i*) &z[i], _mm512_cvtsepi32_epi16(a));
+  }
+  for (;i<len;i++) {
+    z[i] = (int16_t) (x[i]*scale);
+  }
+}
+
+void srslte_vec_convert_if_avx512(int16_t *x, float *z, float scale, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 s = _mm512_set1_ps(1.0f/scale);
+  for (;i+16<=len;i+=16) {
+    __m512i a = _mm512_cvtepi16_epi32(_mm256_loadu_si256((__m256i*) &x[i]));
+    _mm512_storeu_ps(&z[i], _mm512_mul_ps(_mm512_cvtepi32_ps(a), s));
+  }
+  for (;i<len;i++) {
+    z[i] = ((float) x[i])/scale;
+  }
+}
+
+void srslte_vec_prod_fff_avx512(float *x, float *y, float *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&z[i], _mm512_mul_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_cfc_avx512(cf_t *x, float *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    _mm512_storeu_ps((float*) &z[i], _mm512_mul_ps(_mm512_loadu_ps((float*) &x[i]), load_dup_avx512(&y[i])));
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_ccc_avx512(cf_t *x, cf_t *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    __m512 c = prod_ccc_avx512(_mm512_loadu_ps((float*) &x[i]), _mm512_loadu_ps((float*) &y[i]));
+    _mm512_storeu_ps((float*) &z[i], c);
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*y[i];
+  }
+}
+
+void srslte_vec_prod_conj_ccc_avx512(cf_t *x, cf_t *y, cf_t *z, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+8<=len;i+=8) {
+    __m512 c = prod_conj_ccc_avx512(_mm512_loadu_ps((float*) &x[i]), _mm512_loadu_ps((float*) &y[i]));
+    _mm512_storeu_ps((float*) &z[i], c);
+  }
+  for (;i<len;i++) {
+    z[i] = x[i]*conjf(y[i]);
+  }
+}
+
+/* The real and imaginary cross terms are accumulated separately and combined once at the end */
+cf_t srslte_vec_dot_prod_ccc_avx512(cf_t *x, cf_t *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc_re = _mm512_setzero_ps();
+  __m512 acc_im = _mm512_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    __m512 a = _mm512_loadu_ps((float*) &x[i]);
+    __m512 b = _mm512_loadu_ps((float*) &y[i]);
+    acc_re = _mm512_fmadd_ps(a, _mm512_moveldup_ps(b), acc_re);
+    acc_im = _mm512_fmadd_ps(_mm512_permute_ps(a, 0xB1), _mm512_movehdup_ps(b), acc_im);
+  }
+  __m512 acc = _mm512_mask_sub_ps(_mm512_add_ps(acc_re, acc_im), RE_MASK, acc_re, acc_im);
+  cf_t res = hsum_cf_avx512(acc);
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+cf_t srslte_vec_dot_prod_conj_ccc_avx512(cf_t *x, cf_t *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc_re = _mm512_setzero_ps();
+  __m512 acc_im = _mm512_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    __m512 a = _mm512_loadu_ps((float*) &x[i]);
+    __m512 b = _mm512_loadu_ps((float*) &y[i]);
+    acc_re = _mm512_fmadd_ps(a, _mm512_moveldup_ps(b), acc_re);
+    acc_im = _mm512_fmadd_ps(_mm512_permute_ps(a, 0xB1), _mm512_movehdup_ps(b), acc_im);
+  }
+  __m512 acc = _mm512_mask_sub_ps(_mm512_add_ps(acc_re, acc_im), IM_MASK, acc_re, acc_im);
+  cf_t res = hsum_cf_avx512(acc);
+  for (;i<len;i++) {
+    res += x[i]*conjf(y[i]);
+  }
+  return res;
+}
+
+cf_t srslte_vec_dot_prod_cfc_avx512(cf_t *x, float *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc = _mm512_setzero_ps();
+  for (;i+8<=len;i+=8) {
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps((float*) &x[i]), load_dup_avx512(&y[i]), acc);
+  }
+  cf_t res = hsum_cf_avx512(acc);
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+float srslte_vec_dot_prod_fff_avx512(float *x, float *y, uint32_t len) 
+{
+  uint32_t i = 0;
+  __m512 acc = _mm512_setzero_ps();
+  for (;i+16<=len;i+=16) {
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(&x[i]), _mm512_loadu_ps(&y[i]), acc);
+  }
+  float res = _mm512_reduce_add_ps(acc);
+  for (;i<len;i++) {
+    res += x[i]*y[i];
+  }
+  return res;
+}
+
+/* Squares 16 complex values and adds the real and imaginary parts of each one */
+static inline __m512 abs_square_avx512(cf_t *x) 
+{
+  const __m512i idx_re = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+  const __m512i idx_im = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+  __m512 a = _mm512_loadu_ps((float*) &x[0]);
+  __m512 b = _mm512_loadu_ps((float*) &x[8]);
+  a = _mm512_mul_ps(a, a);
+  b = _mm512_mul_ps(b, b);
+  return _mm512_add_ps(_mm512_permutex2var_ps(a, idx_re, b), _mm512_permutex2var_ps(a, idx_im, b));
+}
+
+void srslte_vec_abs_square_cf_avx512(cf_t *x, float *abs_square, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&abs_square[i], abs_square_avx512(&x[i]));
+  }
+  for (;i<len;i++) {
+    abs_square[i] = crealf(x[i])*crealf(x[i])+cimagf(x[i])*cimagf(x[i]);
+  }
+}
+
+void srslte_vec_abs_cf_avx512(cf_t *x, float *abs, uint32_t len) 
+{
+  uint32_t i = 0;
+  for (;i+16<=len;i+=16) {
+    _mm512_storeu_ps(&abs[i], _mm512_sqrt_ps(abs_square_avx512(&x[i])));
+  }
+  for (;i<len;i++) {
+    abs[i] = cabsf(x[i]);
+  }
+}
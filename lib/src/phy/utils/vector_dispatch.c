@@ -0,0 +1,324 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsLTE library.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Runtime selection of the vector kernels. Each srslte_vec_* function with a SIMD 
+ * implementation calls through a table of function pointers, so that a binary built for 
+ * the oldest CPU still uses AVX2 or AVX-512 when the host supports them. 
+ */
+
+#include <stdlib.h>
+#include <complex.h>
+
+#include "srslte/phy/utils/vector.h"
+#include "srslte/phy/utils/vector_simd.h"
+
+typedef struct {
+  float (*acc_ff)(float *x, uint32_t len);
+  cf_t (*acc_cc)(cf_t *x, uint32_t len);
+  void (*sum_fff)(float *x, float *y, float *z, uint32_t len);
+  void (*sub_fff)(float *x, float *y, float *z, uint32_t len);
+  void (*sum_sss)(short *x, short *y, short *z, uint32_t len);
+  void (*sub_sss)(short *x, short *y, short *z, uint32_t len);
+  void (*prod_sss)(short *x, short *y, short *z, uint32_t len);
+  void (*sc_div2_sss)(short *x, int n_rightshift, short *z, uint32_t len);
+  int32_t (*dot_prod_sss)(int16_t *x, int16_t *y, uint32_t len);
+  void (*sc_prod_fff)(float *x, float h, float *z, uint32_t len);
+  void (*sc_prod_cfc)(cf_t *x, float h, cf_t *z, uint32_t len);
+  void (*sc_prod_ccc)(cf_t *x, cf_t h, cf_t *z, uint32_t len);
+  void (*convert_fi)(float *x, int16_t *z, float scale, uint32_t len);
+  void (*convert_if)(int16_t *x, float *z, float scale, uint32_t len);
+  void (*prod_fff)(float *x, float *y, float *z, uint32_t len);
+  void (*prod_cfc)(cf_t *x, float *y, cf_t *z, uint32_t len);
+  void (*prod_ccc)(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+  void (*prod_conj_ccc)(cf_t *x, cf_t *y, cf_t *z, uint32_t len);
+  cf_t (*dot_prod_ccc)(cf_t *x, cf_t *y, uint32_t len);
+  cf_t (*dot_prod_cfc)(cf_t *x, float *y, uint32_t len);
+  cf_t (*dot_prod_conj_ccc)(cf_t *x, cf_t *y, uint32_t len);
+  float (*dot_prod_fff)(float *x, float *y, uint32_t len);
+  void (*abs_cf)(cf_t *x, float *abs, uint32_t len);
+  void (*abs_square_cf)(cf_t *x, float *abs_square, uint32_t len);
+} srslte_vec_kernels_t; 
+
+/* Only the generic table is valid before vec_dispatch_init() runs */
+static srslte_vec_kernels_t vec_kernels_isa[SRSLTE_VEC_NOF_ISA] = {
+  [SRSLTE_VEC_ISA_GENERIC] = {
+    .acc_ff = srslte_vec_acc_ff_gen,
+    .acc_cc = srslte_vec_acc_cc_gen,
+    .sum_fff = srslte_vec_sum_fff_gen,
+    .sub_fff = srslte_vec_sub_fff_gen,
+    .sum_sss = srslte_vec_sum_sss_gen,
+    .sub_sss = srslte_vec_sub_sss_gen,
+    .prod_sss = srslte_vec_prod_sss_gen,
+    .sc_div2_sss = srslte_vec_sc_div2_sss_gen,
+    .dot_prod_sss = srslte_vec_dot_prod_sss_gen,
+    .sc_prod_fff = srslte_vec_sc_prod_fff_gen,
+    .sc_prod_cfc = srslte_vec_sc_prod_cfc_gen,
+    .sc_prod_ccc = srslte_vec_sc_prod_ccc_gen,
+    .convert_fi = srslte_vec_convert_fi_gen,
+    .convert_if = srslte_vec_convert_if_gen,
+    .prod_fff = srslte_vec_prod_fff_gen,
+    .prod_cfc = srslte_vec_prod_cfc_gen,
+    .prod_ccc = srslte_vec_prod_ccc_gen,
+    .prod_conj_ccc = srslte_vec_prod_conj_ccc_gen,
+    .dot_prod_ccc = srslte_vec_dot_prod_ccc_gen,
+    .dot_prod_cfc = srslte_vec_dot_prod_cfc_gen,
+    .dot_prod_conj_ccc = srslte_vec_dot_prod_conj_ccc_gen,
+    .dot_prod_fff = srslte_vec_dot_prod_fff_gen,
+    .abs_cf = srslte_vec_abs_cf_gen,
+    .abs_square_cf = srslte_vec_abs_square_cf_gen,
+  }
+};
+
+static bool vec_isa_available[SRSLTE_VEC_NOF_ISA] = {true, false, false, false}; 
+
+static srslte_vec_kernels_t *vec_kernels = &vec_kernels_isa[SRSLTE_VEC_ISA_GENERIC]; 
+
+static const char *vec_isa_names[SRSLTE_VEC_NOF_ISA] = {"generic", "sse", "avx2", "avx512"};
+
+static bool vec_cpu_supports(srslte_vec_isa_t isa) 
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  switch(isa) {
+    case SRSLTE_VEC_ISA_GENERIC:
+      return true; 
+    case SRSLTE_VEC_ISA_SSE:
+      return __builtin_cpu_supports("sse4.1"); 
+    case SRSLTE_VEC_ISA_AVX2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); 
+    case SRSLTE_VEC_ISA_AVX512:
+      return __builtin_cpu_supports("avx512f"); 
+    default:
+      return false; 
+  }
+#else
+  return isa == SRSLTE_VEC_ISA_GENERIC; 
+#endif
+}
+
+/* Each instruction set starts from the kernels of the previous one and replaces those it implements */
+__attribute__((constructor)) 
+static void vec_dispatch_init(void) 
+{
+  srslte_vec_kernels_t *k; 
+  
+  k  = &vec_kernels_isa[SRSLTE_VEC_ISA_SSE];
+  *k = vec_kernels_isa[SRSLTE_VEC_ISA_GENERIC];
+#ifdef LV_HAVE_SSE
+  k->sum_sss      = srslte_vec_sum_sss_sse; 
+  k->sub_sss      = srslte_vec_sub_sss_sse; 
+  k->prod_sss     = srslte_vec_prod_sss_sse; 
+  k->sc_div2_sss  = srslte_vec_sc_div2_sss_sse; 
+  k->dot_prod_sss = srslte_vec_dot_prod_sss_sse; 
+  k->convert_fi   = srslte_vec_convert_fi_sse;
+  vec_isa_available[SRSLTE_VEC_ISA_SSE] = vec_cpu_supports(SRSLTE_VEC_ISA_SSE); 
+#endif
+
+  k  = &vec_kernels_isa[SRSLTE_VEC_ISA_AVX2];
+  *k = vec_kernels_isa[SRSLTE_VEC_ISA_SSE];
+#ifdef LV_HAVE_AVX2
+  k->sum_sss      = srslte_vec_sum_sss_avx2; 
+  k->sub_sss      = srslte_vec_sub_sss_avx2; 
+  k->prod_sss     = srslte_vec_prod_sss_avx2; 
+  k->sc_div2_sss  = srslte_vec_sc_div2_sss_avx2; 
+  k->dot_prod_sss = srslte_vec_dot_prod_sss_avx2; 
+#endif
+#ifdef HAVE_VEC_AVX2
+  k->acc_ff = srslte_vec_acc_ff_avx2;
+  k->acc_cc = srslte_vec_acc_cc_avx2;
+  k->sum_fff = srslte_vec_sum_fff_avx2;
+  k->sub_fff = srslte_vec_sub_fff_avx2;
+  k->sc_prod_fff = srslte_vec_sc_prod_fff_avx2;
+  k->sc_prod_cfc = srslte_vec_sc_prod_cfc_avx2;
+  k->sc_prod_ccc = srslte_vec_sc_prod_ccc_avx2;
+  k->convert_fi = srslte_vec_convert_fi_avx2;
+  k->convert_if = srslte_vec_convert_if_avx2;
+  k->prod_fff = srslte_vec_prod_fff_avx2;
+  k->prod_cfc = srslte_vec_prod_cfc_avx2;
+  k->prod_ccc = srslte_vec_prod_ccc_avx2;
+  k->prod_conj_ccc = srslte_vec_prod_conj_ccc_avx2;
+  k->dot_prod_ccc = srslte_vec_dot_prod_ccc_avx2;
+  k->dot_prod_cfc = srslte_vec_dot_prod_cfc_avx2;
+  k->dot_prod_conj_ccc = srslte_vec_dot_prod_conj_ccc_avx2;
+  k->dot_prod_fff = srslte_vec_dot_prod_fff_avx2;
+  k->abs_cf = srslte_vec_abs_cf_avx2;
+  k->abs_square_cf = srslte_vec_abs_square_cf_avx2;
+  vec_isa_available[SRSLTE_VEC_ISA_AVX2] = vec_cpu_supports(SRSLTE_VEC_ISA_AVX2); 
+#endif
+
+  k  = &vec_kernels_isa[SRSLTE_VEC_ISA_AVX512];
+  *k = vec_kernels_isa[SRSLTE_VEC_ISA_AVX2];
+#ifdef HAVE_VEC_AVX512
+  k->acc_ff = srslte_vec_acc_ff_avx512;
+  k->acc_cc = srslte_vec_acc_cc_avx512;
+  k->sum_fff = srslte_vec_sum_fff_avx512;
+  k->sub_fff = srslte_vec_sub_fff_avx512;
+  k->sc_prod_fff = srslte_vec_sc_prod_fff_avx512;
+  k->sc_prod_cfc = srslte_vec_sc_prod_cfc_avx512;
+  k->sc_prod_ccc = srslte_vec_sc_prod_ccc_avx512;
+  k->convert_fi = srslte_vec_convert_fi_avx512;
+  k->convert_if = srslte_vec_convert_if_avx512;
+  k->prod_fff = srslte_vec_prod_fff_avx512;
+  k->prod_cfc = srslte_vec_prod_cfc_avx512;
+  k->prod_ccc = srslte_vec_prod_ccc_avx512;
+  k->prod_conj_ccc = srslte_vec_prod_conj_ccc_avx512;
+  k->dot_prod_ccc = srslte_vec_dot_prod_ccc_avx512;
+  k->dot_prod_cfc = srslte_vec_dot_prod_cfc_avx512;
+  k->dot_prod_conj_ccc = srslte_vec_dot_prod_conj_ccc_avx512;
+  k->dot_prod_fff = srslte_vec_dot_prod_fff_avx512;
+  k->abs_cf = srslte_vec_abs_cf_avx512;
+  k->abs_square_cf = srslte_vec_abs_square_cf_avx512;
+  vec_isa_available[SRSLTE_VEC_ISA_AVX512] = vec_isa_available[SRSLTE_VEC_ISA_AVX2] && 
+                                              vec_cpu_supports(SRSLTE_VEC_ISA_AVX512); 
+#endif
+  
+  for (int i=SRSLTE_VEC_NOF_ISA-1;i>=0;i--) {
+    if (vec_isa_available[i]) {
+      vec_kernels = &vec_kernels_isa[i];
+      break; 
+    }
+  }
+}
+
+bool srslte_vec_isa_supported(srslte_vec_isa_t isa) 
+{
+  return isa < SRSLTE_VEC_NOF_ISA && vec_isa_available[isa]; 
+}
+
+int srslte_vec_set_isa(srslte_vec_isa_t isa) 
+{
+  if (!srslte_vec_isa_supported(isa)) {
+    return SRSLTE_ERROR; 
+  }
+  vec_kernels = &vec_kernels_isa[isa];
+  return SRSLTE_SUCCESS; 
+}
+
+srslte_vec_isa_t srslte_vec_get_isa() 
+{
+  return (srslte_vec_isa_t) (vec_kernels - vec_kernels_isa); 
+}
+
+const char *srslte_vec_isa_string(srslte_vec_isa_t isa) 
+{
+  return isa < SRSLTE_VEC_NOF_ISA?vec_isa_names[isa]:"unknown"; 
+}
+
+float srslte_vec_acc_ff(float *x, uint32_t len) {
+  return vec_kernels->acc_ff(x, len);
+}
+
+cf_t srslte_vec_acc_cc(cf_t *x, uint32_t len) {
+  return vec_kernels->acc_cc(x, len);
+}
+
+void srslte_vec_sum_fff(float *x, float *y, float *z, uint32_t len) {
+  vec_kernels->sum_fff(x, y, z, len);
+}
+
+void srslte_vec_sub_fff(float *x, float *y, float *z, uint32_t len) {
+  vec_kernels->sub_fff(x, y, z, len);
+}
+
+void srslte_vec_sum_sss(short *x, short *y, short *z, uint32_t len) {
+  vec_kernels->sum_sss(x, y, z, len);
+}
+
+void srslte_vec_sub_sss(short *x, short *y, short *z, uint32_t len) {
+  vec_kernels->sub_sss(x, y, z, len);
+}
+
+void srslte_vec_prod_sss(short *x, short *y, short *z, uint32_t len) {
+  vec_kernels->prod_sss(x, y, z, len);
+}
+
+void srslte_vec_sc_div2_sss(short *x, int n_rightshift, short *z, uint32_t len) {
+  vec_kernels->sc_div2_sss(x, n_rightshift, z, len);
+}
+
+int32_t srslte_vec_dot_prod_sss(int16_t *x, int16_t *y, uint32_t len) {
+  return vec_kernels->dot_prod_sss(x, y, len);
+}
+
+void srslte_vec_sc_prod_fff(float *x, float h, float *z, uint32_t len) {
+  vec_kernels->sc_prod_fff(x, h, z, len);
+}
+
+void srslte_vec_sc_prod_cfc(cf_t *x, float h, cf_t *z, uint32_t len) {
+  vec_kernels->sc_prod_cfc(x, h, z, len);
+}
+
+void srslte_vec_sc_prod_ccc(cf_t *x, cf_t h, cf_t *z, uint32_t len) {
+  vec_kernels->sc_prod_ccc(x, h, z, len);
+}
+
+void srslte_vec_convert_fi(float *x, int16_t *z, float scale, uint32_t len) {
+  vec_kernels->convert_fi(x, z, scale, len);
+}
+
+void srslte_vec_convert_if(int16_t *x, float *z, float scale, uint32_t len) {
+  vec_kernels->convert_if(x, z, scale, len);
+}
+
+void srslte_vec_prod_fff(float *x, float *y, float *z, uint32_t len) {
+  vec_kernels->prod_fff(x, y, z, len);
+}
+
+void srslte_vec_prod_cfc(cf_t *x, float *y, cf_t *z, uint32_t len) {
+  vec_kernels->prod_cfc(x, y, z, len);
+}
+
+void srslte_vec_prod_ccc(cf_t *x, cf_t *y, cf_t *z, uint32_t len) {
+  vec_kernels->prod_ccc(x, y, z, len);
+}
+
+void srslte_vec_prod_conj_ccc(cf_t *x, cf_t *y, cf_t *z, uint32_t len) {
+  vec_kernels->prod_conj_ccc(x, y, z, len);
+}
+
+cf_t srslte_vec_dot_prod_ccc(cf_t *x, cf_t *y, uint32_t len) {
+  return vec_kernels->dot_prod_ccc(x, y, len);
+}
+
+cf_t srslte_vec_dot_prod_cfc(cf_t *x, float *y, uint32_t len) {
+  return vec_kernels->dot_prod_cfc(x, y, len);
+}
+
+cf_t srslte_vec_dot_prod_conj_ccc(cf_t *x, cf_t *y, uint32_t len) {
+  return vec_kernels->dot_prod_conj_ccc(x, y, len);
+}
+
+float srslte_vec_dot_prod_fff(float *x, float *y, uint32_t len) {
+  return vec_kernels->dot_prod_fff(x, y, len);
+}
+
+void srslte_vec_abs_cf(cf_t *x, float *abs, uint32_t len) {
+  vec_kernels->abs_cf(x, abs, len);
+}
+
+void srslte_vec_abs_square_cf(cf_t *x, float *abs_square, uint32_t len) {
+  vec_kernels->abs_square_cf(x, abs_square, len);
+}
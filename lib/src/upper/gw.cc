@@ -222,15 +222,15 @@ void gw::run_thread()
     struct iphdr   *ip_pkt;
     uint32          idx = 0;
     int32           N_bytes;
-    byte_buffer_t  *pdu = pool_allocate;
+    byte_buffer_t  *pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
 
     gw_log->info("GW IP packet receiver thread run_enable\n");
 
     running = true; 
     while(run_enable)
     {
-      if (SRSLTE_MAX_BUFFER_SIZE_BYTES-SRSLTE_BUFFER_HEADER_OFFSET > idx) {
-        N_bytes = read(tun_fd, &pdu->msg[idx], SRSLTE_MAX_BUFFER_SIZE_BYTES-SRSLTE_BUFFER_HEADER_OFFSET - idx);
+      if (pdu->get_tailroom() > idx) {
+        N_bytes = read(tun_fd, &pdu->msg[idx], pdu->get_tailroom() - idx);
       } else {
         gw_log->error("GW pdu buffer full - gw receive thread exiting.\n");
         gw_log->console("GW pdu buffer full - gw receive thread exiting.\n");
@@ -258,18 +258,24 @@ void gw::run_thread()
               break;
             }
             
-            // Send PDU directly to PDCP
-            pdu->set_timestamp();
-            ul_tput_bytes += pdu->N_bytes;
-            pdcp->write_sdu(RB_ID_DRB1, pdu);
+            // Send PDU directly to PDCP, small packets are moved to a
+            // smaller buffer and the read buffer is kept for the next one
+            byte_buffer_t *sdu = pool->fit(pdu, __FUNCTION__);
+            sdu->set_timestamp();
+            ul_tput_bytes += sdu->N_bytes;
+            pdcp->write_sdu(RB_ID_DRB1, sdu);
             
-            do {
-              pdu = pool_allocate;
-              if (!pdu) {
-                printf("Not enough buffers in pool\n");
-                usleep(100000);
-              }
-            } while(!pdu); 
+            if (sdu != pdu) {
+              pdu->reset();
+            } else {
+              do {
+                pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
+                if (!pdu) {
+                  printf("Not enough buffers in pool\n");
+                  usleep(100000);
+                }
+              } while(!pdu); 
+            }
             idx = 0;
           }else{
             idx += N_bytes;
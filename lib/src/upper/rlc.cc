@@ -140,6 +140,15 @@ int rlc::read_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
   return 0;
 }
 
+int rlc::read_pdu_chain(uint32_t lcid, buffer_chain *chain, uint32_t nof_bytes)
+{
+  if(valid_lcid(lcid)) {
+    ul_tput_bytes[lcid] += nof_bytes;
+    return rlc_array[lcid].read_pdu_chain(chain, nof_bytes);
+  }
+  return 0;
+}
+
 void rlc::write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
 {
   if(valid_lcid(lcid)) {
@@ -152,7 +161,7 @@ void rlc::write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes)
 {
   rlc_log->info_hex(payload, nof_bytes, "BCCH BCH message received.");
   dl_tput_bytes[0] += nof_bytes;
-  byte_buffer_t *buf = pool_allocate;
+  byte_buffer_t *buf = pool_allocate_size(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   buf->set_timestamp();
@@ -163,7 +172,7 @@ void rlc::write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes)
 {
   rlc_log->info_hex(payload, nof_bytes, "BCCH TXSCH message received.");
   dl_tput_bytes[0] += nof_bytes;
-  byte_buffer_t *buf = pool_allocate;
+  byte_buffer_t *buf = pool_allocate_size(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   buf->set_timestamp();
@@ -174,7 +183,7 @@ void rlc::write_pdu_pcch(uint8_t *payload, uint32_t nof_bytes)
 {
   rlc_log->info_hex(payload, nof_bytes, "PCCH message received.");
   dl_tput_bytes[0] += nof_bytes;
-  byte_buffer_t *buf = pool_allocate;
+  byte_buffer_t *buf = pool_allocate_size(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   buf->set_timestamp();
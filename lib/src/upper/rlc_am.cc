@@ -94,8 +94,7 @@ void rlc_am::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
 void rlc_am::empty_queue() {
   // Drop all messages in TX SDU queue
   byte_buffer_t *buf;
-  while(tx_sdu_queue.size() > 0) {
-    tx_sdu_queue.read(&buf);
+  while(tx_sdu_queue.try_read(&buf)) {
     pool->deallocate(buf);
   }
 }
@@ -579,7 +578,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     return 0;
   }
 
-  byte_buffer_t *pdu = pool_allocate;
+  byte_buffer_t *pdu = pool_allocate_size(nof_bytes);
   if (!pdu) {
     log->console("Fatal Error: Could not allocate PDU in build_data_pdu()\n");
     exit(-1);
@@ -739,7 +738,7 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_h
 
   // Write to rx window
   rlc_amd_rx_pdu_t pdu;
-  pdu.buf = pool_allocate;
+  pdu.buf = pool_allocate_size(nof_bytes);
   if (!pdu.buf) {
     log->console("Fatal Error: Could not allocate PDU in handle_data_pdu()\n");
     exit(-1);
@@ -825,7 +824,7 @@ void rlc_am::handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_a
   }
 
   rlc_amd_rx_pdu_t segment;
-  segment.buf = pool_allocate;
+  segment.buf = pool_allocate_size(nof_bytes);
   if (!segment.buf) {
     log->console("Fatal Error: Could not allocate PDU in handle_data_pdu_segment()\n");
     exit(-1);
@@ -965,7 +964,7 @@ void rlc_am::handle_control_pdu(uint8_t *payload, uint32_t nof_bytes)
 void rlc_am::reassemble_rx_sdus()
 {
   if(!rx_sdu) {
-    rx_sdu = pool_allocate;
+    rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
     if (!rx_sdu) {
       log->console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (1)\n");
       exit(-1);
@@ -978,6 +977,7 @@ void rlc_am::reassemble_rx_sdus()
     for(uint32_t i=0; i<rx_window[vr_r].header.N_li; i++)
     {
       int len = rx_window[vr_r].header.li[i];
+      reserve_rx_sdu(len);
       memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, len);
       rx_sdu->N_bytes += len;
       rx_window[vr_r].buf->msg += len;
@@ -985,7 +985,7 @@ void rlc_am::reassemble_rx_sdus()
       log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       rx_sdu->set_timestamp();
       pdcp->write_pdu(lcid, rx_sdu);
-      rx_sdu = pool_allocate;
+      rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
       if (!rx_sdu) {
         log->console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (2)\n");
       exit(-1);
@@ -994,6 +994,7 @@ void rlc_am::reassemble_rx_sdus()
     }
 
     // Handle last segment
+    reserve_rx_sdu(rx_window[vr_r].buf->N_bytes);
     memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, rx_window[vr_r].buf->N_bytes);
     rx_sdu->N_bytes += rx_window[vr_r].buf->N_bytes;
     if(rlc_am_end_aligned(rx_window[vr_r].header.fi))
@@ -1001,7 +1002,7 @@ void rlc_am::reassemble_rx_sdus()
       log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       rx_sdu->set_timestamp();
       pdcp->write_pdu(lcid, rx_sdu);
-      rx_sdu = pool_allocate;
+      rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
       if (!rx_sdu) {
         log->console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (3)\n");
       exit(-1);
@@ -1016,6 +1017,16 @@ void rlc_am::reassemble_rx_sdus()
   }
 }
 
+// SDUs are reassembled in a buffer sized for an IP packet and moved to a
+// larger one only when a segment does not fit
+void rlc_am::reserve_rx_sdu(uint32_t nof_bytes)
+{
+  if (!pool->reserve(&rx_sdu, nof_bytes, __FUNCTION__)) {
+    log->console("Fatal Error: Could not grow SDU of %d bytes in reassemble_rx_sdus()\n", rx_sdu->N_bytes + nof_bytes);
+    exit(-1);
+  }
+}
+
 bool rlc_am::inside_tx_window(uint16_t sn)
 {
   if(RX_MOD_BASE(sn) >= RX_MOD_BASE(vt_a) &&
@@ -1103,7 +1114,11 @@ bool rlc_am::add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, rlc_amd_rx_pd
   }
 
   // Copy data
-  byte_buffer_t *full_pdu = pool_allocate;
+  uint32_t full_len = 0;
+  for(it = pdu->segments.begin(); it != pdu->segments.end(); it++) {
+    full_len += it->buf->N_bytes;
+  }
+  byte_buffer_t *full_pdu = pool_allocate_size(full_len);
   if (!full_pdu) {
     log->console("Fatal Error: Could not allocate PDU in add_segment_and_check()\n");
     exit(-1);
@@ -1114,6 +1129,7 @@ bool rlc_am::add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, rlc_amd_rx_pd
   }
 
   handle_data_pdu(full_pdu->msg, full_pdu->N_bytes, header);
+  pool->deallocate(full_pdu);
   return true;
 }
 
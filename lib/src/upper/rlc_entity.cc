@@ -128,6 +128,14 @@ int rlc_entity::read_pdu(uint8_t *payload, uint32_t nof_bytes)
   else
     return 0;
 }
+
+int rlc_entity::read_pdu_chain(buffer_chain *chain, uint32_t nof_bytes)
+{
+  if(rlc)
+    return rlc->read_pdu_chain(chain, nof_bytes);
+  else
+    return 0;
+}
 void rlc_entity::write_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   if(rlc)
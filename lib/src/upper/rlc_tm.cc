@@ -55,8 +55,7 @@ void rlc_tm::empty_queue()
 {
   // Drop all messages in TX queue
   byte_buffer_t *buf;
-  while(ul_queue.size() > 0) {
-    ul_queue.read(&buf);
+  while(ul_queue.try_read(&buf)) {
     pool->deallocate(buf);
   }
 }
@@ -115,7 +114,7 @@ int rlc_tm::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 
 void rlc_tm:: write_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  byte_buffer_t *buf = pool_allocate;
+  byte_buffer_t *buf = pool_allocate_size(nof_bytes);
   memcpy(buf->msg, payload, nof_bytes);
   buf->N_bytes = nof_bytes;
   buf->set_timestamp();
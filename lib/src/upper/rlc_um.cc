@@ -44,6 +44,7 @@ rlc_um::rlc_um() : tx_sdu_queue(16)
   vr_ux    = 0;
   vr_uh    = 0;
   
+  rx_mod          = 0;
   vr_ur_in_rx_sdu = 0; 
   
   mac_timers = NULL; 
@@ -74,6 +75,7 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->dl_um_bi_rlc.sn_field_len;
     rx_window_size      = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 16 : 512;
     rx_mod              = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 32 : 1024;
+    vr_ur_in_rx_sdu     = rx_mod - 1; // SDUs of the first PDU (SN 0) are not a continuation
     tx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->ul_um_bi_rlc.sn_field_len;
     tx_mod              = (RLC_UMD_SN_SIZE_5_BITS == tx_sn_field_length) ? 32 : 1024;
     log->info("%s configured in %s mode: "
@@ -95,6 +97,7 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rx_sn_field_length  = (rlc_umd_sn_size_t)cnfg->dl_um_uni_rlc.sn_field_len;
     rx_window_size      = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 16 : 512;
     rx_mod              = (RLC_UMD_SN_SIZE_5_BITS == rx_sn_field_length) ? 32 : 1024;
+    vr_ur_in_rx_sdu     = rx_mod - 1; // SDUs of the first PDU (SN 0) are not a continuation
     log->info("%s configured in %s mode: "
               "t_reordering=%d ms, rx_sn_field_length=%u bits\n",
               rb_id_text[lcid], liblte_rrc_rlc_mode_text[cnfg->rlc_mode],
@@ -109,8 +112,7 @@ void rlc_um::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
 void rlc_um::empty_queue() {
   // Drop all messages in TX SDU queue
   byte_buffer_t *buf;
-  while(tx_sdu_queue.size() > 0) {
-    tx_sdu_queue.read(&buf);
+  while(tx_sdu_queue.try_read(&buf)) {
     pool->deallocate(buf);
   }
 }
@@ -126,6 +128,7 @@ void rlc_um::reset()
   vr_ur    = 0;
   vr_ux    = 0;
   vr_uh    = 0;
+  vr_ur_in_rx_sdu = rx_mod ? rx_mod - 1 : 0;
   pdu_lost = false;
   if(rx_sdu)
     rx_sdu->reset();
@@ -203,6 +206,15 @@ int rlc_um::read_pdu(uint8_t *payload, uint32_t nof_bytes)
   return r; 
 }
 
+int rlc_um::read_pdu_chain(buffer_chain *chain, uint32_t nof_bytes)
+{
+  log->debug("MAC opportunity - %d bytes\n", nof_bytes);
+  pthread_mutex_lock(&mutex);
+  int r = build_data_pdu(NULL, nof_bytes, chain);
+  pthread_mutex_unlock(&mutex);
+  return r; 
+}
+
 void rlc_um::write_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   pthread_mutex_lock(&mutex);
@@ -256,7 +268,7 @@ bool rlc_um::reordering_timeout_running()
  * Helpers
  ***************************************************************************/
 
-int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
+int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes, buffer_chain *chain)
 {
   if(!tx_sdu && tx_sdu_queue.size() == 0)
   {
@@ -264,7 +276,13 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     return 0;
   }
 
-  byte_buffer_t *pdu = pool_allocate;
+  // A chain needs one slice for the header and at least one for data
+  if(chain && chain->free_slices() < 2)
+  {
+    return -1;
+  }
+
+  byte_buffer_t *pdu = pool_allocate_size(nof_bytes);
   if(!pdu || pdu->N_bytes != 0)
   {
     log->error("Failed to allocate PDU buffer\n");
@@ -278,7 +296,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   uint32_t to_move   = 0;
   uint32_t last_li   = 0;
-  uint8_t *pdu_ptr   = pdu->msg;
+  uint32_t data_len  = 0;
 
   int head_len  = rlc_um_packed_length(&header);
   int pdu_space = nof_bytes;
@@ -287,9 +305,18 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   {
     log->warning("%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
                  rb_id_text[lcid], nof_bytes, head_len);
+    pool->deallocate(pdu);
     return 0;
   }
 
+  // The header is only known at the end, reserve its slice
+  uint32_t head_idx = 0;
+  if(chain)
+  {
+    head_idx = chain->size();
+    chain->append(NULL, 0);
+  }
+
   // Check for SDU segment
   if(tx_sdu)
   {
@@ -297,25 +324,15 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     to_move = space >= tx_sdu->N_bytes ? tx_sdu->N_bytes : space;
     log->debug("%s adding remainder of SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    add_sdu_segment(pdu, to_move, chain);
     last_li          = to_move;
-    pdu_ptr         += to_move;
-    pdu->N_bytes    += to_move;
-    tx_sdu->N_bytes -= to_move;
-    tx_sdu->msg     += to_move;
-    if(tx_sdu->N_bytes == 0)
-    {
-      log->info("%s Complete SDU scheduled for tx. Stack latency: %ld us\n",
-                rb_id_text[lcid], tx_sdu->get_latency_us());
-      pool->deallocate(tx_sdu);
-      tx_sdu = NULL;
-    }
+    data_len        += to_move;
     pdu_space -= to_move;
     header.fi |= RLC_FI_FIELD_NOT_START_ALIGNED; // First byte does not correspond to first byte of SDU
   }
 
   // Pull SDUs from queue
-  while(pdu_space > head_len && tx_sdu_queue.size() > 0)
+  while(pdu_space > head_len && tx_sdu_queue.size() > 0 && (!chain || chain->free_slices() > 0))
   {
     log->debug("pdu_space=%d, head_len=%d\n", pdu_space, head_len);
     if(last_li > 0)
@@ -326,19 +343,9 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     to_move = space >= tx_sdu->N_bytes ? tx_sdu->N_bytes : space;
     log->debug("%s adding new SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    add_sdu_segment(pdu, to_move, chain);
     last_li          = to_move;
-    pdu_ptr         += to_move;
-    pdu->N_bytes    += to_move;
-    tx_sdu->N_bytes -= to_move;
-    tx_sdu->msg     += to_move;
-    if(tx_sdu->N_bytes == 0)
-    {
-      log->info("%s Complete SDU scheduled for tx. Stack latency: %ld us\n",
-                rb_id_text[lcid], tx_sdu->get_latency_us());
-      pool->deallocate(tx_sdu);
-      tx_sdu = NULL;
-    }
+    data_len        += to_move;
     pdu_space -= to_move;
   }
 
@@ -350,17 +357,52 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   vt_us = (vt_us + 1)%tx_mod;
 
   // Add header and TX
-  log->debug("%s packing PDU with length %d\n", rb_id_text[lcid], pdu->N_bytes);
+  log->debug("%s packing PDU with length %d\n", rb_id_text[lcid], data_len);
   rlc_um_write_data_pdu_header(&header, pdu);
-  memcpy(payload, pdu->msg, pdu->N_bytes);
-  uint32_t ret = pdu->N_bytes;
-  log->debug("%sreturning length %d\n", rb_id_text[lcid], pdu->N_bytes);
-  pool->deallocate(pdu);
+  uint32_t ret = rlc_um_packed_length(&header) + data_len;
+  if(chain)
+  {
+    // The header and a copied last segment stay in pdu, owned by the chain
+    chain->set(head_idx, pdu->msg, rlc_um_packed_length(&header), pdu);
+  } else {
+    memcpy(payload, pdu->msg, pdu->N_bytes);
+    pool->deallocate(pdu);
+  }
+  log->debug("%sreturning length %d\n", rb_id_text[lcid], ret);
 
   debug_state();
   return ret;
 }
 
+// Moves the next to_move bytes of tx_sdu into the PDU. With a chain the
+// complete remainder of an SDU is referenced in place and the chain takes the
+// buffer over; the head of an SDU that continues in the next PDU is copied
+// since its buffer is still needed after this PDU is released
+void rlc_um::add_sdu_segment(byte_buffer_t *pdu, uint32_t to_move, buffer_chain *chain)
+{
+  bool handed_over = false;
+  if(chain && to_move == tx_sdu->N_bytes)
+  {
+    chain->append(tx_sdu->msg, to_move, tx_sdu);
+    handed_over = true;
+  } else {
+    memcpy(&pdu->msg[pdu->N_bytes], tx_sdu->msg, to_move);
+    if(chain)
+      chain->append(&pdu->msg[pdu->N_bytes], to_move);
+    pdu->N_bytes += to_move;
+  }
+  tx_sdu->N_bytes -= to_move;
+  tx_sdu->msg     += to_move;
+  if(tx_sdu->N_bytes == 0)
+  {
+    log->info("%s Complete SDU scheduled for tx. Stack latency: %ld us\n",
+              rb_id_text[lcid], tx_sdu->get_latency_us());
+    if(!handed_over)
+      pool->deallocate(tx_sdu);
+    tx_sdu = NULL;
+  }
+}
+
 void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   std::map<uint32_t, rlc_umd_pdu_t>::iterator it;
@@ -387,7 +429,7 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   // Write to rx window
   rlc_umd_pdu_t pdu;
-  pdu.buf = pool_allocate;
+  pdu.buf = pool_allocate_size(nof_bytes);
   if (!pdu.buf) {
     log->error("Discarting packet: no space in buffer pool\n");
     return;
@@ -435,7 +477,7 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
 void rlc_um::reassemble_rx_sdus()
 {
   if(!rx_sdu)
-    rx_sdu = pool_allocate;
+    rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
 
   // First catch up with lower edge of reordering window
   while(!inside_reordering_window(vr_ur))
@@ -448,6 +490,7 @@ void rlc_um::reassemble_rx_sdus()
       for(uint32_t i=0; i<rx_window[vr_ur].header.N_li; i++)
       {
         int len = rx_window[vr_ur].header.li[i];
+        reserve_rx_sdu(len);
         memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
         rx_sdu->N_bytes += len;
         rx_window[vr_ur].buf->msg += len;
@@ -459,12 +502,13 @@ void rlc_um::reassemble_rx_sdus()
           log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU vr_ur=%d, i=%d (lower edge middle segments)", rb_id_text[lcid], vr_ur, i);
           rx_sdu->set_timestamp();
           pdcp->write_pdu(lcid, rx_sdu);
-          rx_sdu = pool_allocate;
+          rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
         }
         pdu_lost = false;
       }
 
       // Handle last segment
+      reserve_rx_sdu(rx_window[vr_ur].buf->N_bytes);
       memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
       rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
       log->debug("Writting last segment in SDU buffer. Lower edge vr_ur=%d, Buffer size=%d, segment size=%d\n", 
@@ -479,7 +523,7 @@ void rlc_um::reassemble_rx_sdus()
           log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU vr_ur=%d (lower edge last segments)", rb_id_text[lcid], vr_ur);
           rx_sdu->set_timestamp();
           pdcp->write_pdu(lcid, rx_sdu);
-          rx_sdu = pool_allocate;
+          rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
         }
         pdu_lost = false;
       }
@@ -500,6 +544,7 @@ void rlc_um::reassemble_rx_sdus()
     for(uint32_t i=0; i<rx_window[vr_ur].header.N_li; i++)
     {
       int len = rx_window[vr_ur].header.li[i];
+      reserve_rx_sdu(len);
       memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
       log->debug("Concatenating %d bytes in to current length %d. rx_window remaining bytes=%d, vr_ur_in_rx_sdu=%d, vr_ur=%d, rx_mod=%d, last_mod=%d\n",
         len, rx_sdu->N_bytes, rx_window[vr_ur].buf->N_bytes, vr_ur_in_rx_sdu, vr_ur, rx_mod, (vr_ur_in_rx_sdu+1)%rx_mod);
@@ -513,12 +558,13 @@ void rlc_um::reassemble_rx_sdus()
         log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU vr_ur=%d, i=%d, (update vr_ur middle segments)", rb_id_text[lcid], vr_ur, i);
         rx_sdu->set_timestamp();
         pdcp->write_pdu(lcid, rx_sdu);
-        rx_sdu = pool_allocate;
+        rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
       }
       pdu_lost = false;
     }
     
     // Handle last segment
+    reserve_rx_sdu(rx_window[vr_ur].buf->N_bytes);
     memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
     rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
     log->debug("Writting last segment in SDU buffer. Updating vr_ur=%d, Buffer size=%d, segment size=%d\n", 
@@ -533,7 +579,7 @@ void rlc_um::reassemble_rx_sdus()
         log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU vr_ur=%d (update vr_ur last segments)", rb_id_text[lcid], vr_ur);
         rx_sdu->set_timestamp();
         pdcp->write_pdu(lcid, rx_sdu);
-        rx_sdu = pool_allocate;
+        rx_sdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
       }
       pdu_lost = false;
     }
@@ -546,6 +592,16 @@ void rlc_um::reassemble_rx_sdus()
   }
 }
 
+// SDUs are reassembled in a buffer sized for an IP packet and moved to a
+// larger one only when a segment does not fit
+void rlc_um::reserve_rx_sdu(uint32_t nof_bytes)
+{
+  if (!pool->reserve(&rx_sdu, nof_bytes, __FUNCTION__)) {
+    log->console("Fatal Error: Could not grow SDU of %d bytes in reassemble_rx_sdus()\n", rx_sdu->N_bytes + nof_bytes);
+    exit(-1);
+  }
+}
+
 bool rlc_um::inside_reordering_window(uint16_t sn)
 {
   if(RX_MOD_BASE(sn) >= RX_MOD_BASE(vr_uh-rx_window_size) &&
@@ -0,0 +1,481 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NOF_THREADS 4
+#define NOF_ITERS   200000
+#define BURST_LEN   16
+
+#define IPERF_PKTS   300000
+#define IPERF_WINDOW 400
+
+#include <stdio.h>
+#include <limits.h>
+#include <sys/time.h>
+#include <sched.h>
+#include "srslte/common/buffer_pool.h"
+#include "srslte/common/block_queue.h"
+#include "srslte/common/buffer_chain.h"
+
+using namespace srslte;
+
+typedef struct {
+  buffer_pool<byte_buffer_t>  *pool;
+  block_queue<byte_buffer_t*> *q;
+  uint32_t                     id;
+  bool                         result;
+}args_t;
+
+static double elapsed_ns(struct timeval *t0, struct timeval *t1) {
+  return (t1->tv_sec - t0->tv_sec)*1e9 + (t1->tv_usec - t0->tv_usec)*1e3;
+}
+
+/* Allocates and deallocates bursts of buffers, checking nobody else owns them */
+void* burst_thread(void *a) {
+  args_t *args = (args_t*)a;
+  byte_buffer_t *b[BURST_LEN];
+  args->result = true;
+  for(uint32_t i=0;i<NOF_ITERS/BURST_LEN;i++) {
+    for (uint32_t j=0;j<BURST_LEN;j++) {
+      b[j] = args->pool->allocate();
+      if (!b[j]) {
+        args->result = false;
+        return NULL;
+      }
+      b[j]->N_bytes = args->id*BURST_LEN+j;
+    }
+    for (uint32_t j=0;j<BURST_LEN;j++) {
+      if (b[j]->N_bytes != args->id*BURST_LEN+j || !args->pool->deallocate(b[j])) {
+        args->result = false;
+      }
+    }
+  }
+  return NULL;
+}
+
+void* new_delete_thread(void *a) {
+  byte_buffer_t *b[BURST_LEN];
+  for(uint32_t i=0;i<NOF_ITERS/BURST_LEN;i++) {
+    for (uint32_t j=0;j<BURST_LEN;j++) {
+      b[j] = new byte_buffer_t;
+    }
+    for (uint32_t j=0;j<BURST_LEN;j++) {
+      delete b[j];
+    }
+  }
+  return NULL;
+}
+
+/* Producer side of a cross-thread test: buffers are freed by another thread */
+void* producer_thread(void *a) {
+  args_t *args = (args_t*)a;
+  args->result = true;
+  for(uint32_t i=0;i<NOF_ITERS;i++) {
+    // Do not let the producer drain the pool
+    while (args->pool->get_nof_used() > args->pool->get_capacity()/2) {
+      sched_yield();
+    }
+    byte_buffer_t *b = args->pool->allocate();
+    if (!b) {
+      args->result = false;
+      return NULL;
+    }
+    b->N_bytes = i;
+    args->q->push(b);
+  }
+  return NULL;
+}
+
+typedef struct {
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+  char     debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+  uint32_t value;
+}small_buffer_t;
+
+typedef std::vector<buffer_pool<small_buffer_t>*> small_pools_t;
+
+/* Takes and returns one buffer of every pool, leaving them in this thread's caches */
+void* touch_pools_thread(void *a) {
+  small_pools_t *pools = (small_pools_t*)a;
+  for (uint32_t i=0;i<pools->size();i++) {
+    small_buffer_t *b = (*pools)[i]->allocate();
+    if (b) {
+      (*pools)[i]->deallocate(b);
+    }
+  }
+  return NULL;
+}
+
+typedef struct {
+  buffer_pool<byte_buffer_t> *pool;
+  block_queue<int>            filled;
+  block_queue<int>            done;
+}stranded_args_t;
+
+/* Leaves freed buffers in this thread's cache and stays alive until told to exit */
+void* strand_thread(void *a) {
+  stranded_args_t *args = (stranded_args_t*)a;
+  byte_buffer_t   *b[BURST_LEN];
+  for (uint32_t j=0;j<BURST_LEN;j++) {
+    b[j] = args->pool->allocate();
+  }
+  for (uint32_t j=0;j<BURST_LEN;j++) {
+    if (b[j]) {
+      args->pool->deallocate(b[j]);
+    }
+  }
+  args->filled.push(0);
+  args->done.wait_pop();
+  return NULL;
+}
+
+double run_threads(void* (*fn)(void*), args_t *args, uint32_t nof_threads) {
+  pthread_t      threads[NOF_THREADS];
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (uint32_t i=0;i<nof_threads;i++) {
+    pthread_create(&threads[i], NULL, fn, &args[i]);
+  }
+  for (uint32_t i=0;i<nof_threads;i++) {
+    pthread_join(threads[i], NULL);
+  }
+  gettimeofday(&t1, NULL);
+  return elapsed_ns(&t0, &t1)/((double) NOF_ITERS*nof_threads);
+}
+
+bool basic_test() {
+  const uint32_t              n = 32;
+  buffer_pool<byte_buffer_t>  pool(n);
+  std::vector<byte_buffer_t*> b(n);
+  bool                        result = true;
+
+  for (uint32_t i=0;i<n;i++) {
+    b[i] = pool.allocate();
+    if (!b[i] || std::count(b.begin(), b.begin()+i, b[i])) {
+      result = false;
+    }
+  }
+  printf("Expect an empty pool error:\n");
+  if (pool.allocate() != NULL || pool.get_nof_exhausted() != 1 || pool.get_high_water() != n) {
+    result = false;
+  }
+  for (uint32_t i=0;i<n;i++) {
+    if (!pool.deallocate(b[i])) {
+      result = false;
+    }
+  }
+  printf("Expect two deallocation errors:\n");
+  byte_buffer_t foreign;
+  if (pool.deallocate(b[0]) || pool.deallocate(&foreign) || pool.get_nof_used() != 0) {
+    result = false;
+  }
+  return result;
+}
+
+/* Buffers cached by another thread that is still running are reclaimed before the pool
+ * reports it is exhausted */
+bool stranded_test() {
+  const uint32_t              n = 512;
+  buffer_pool<byte_buffer_t>  pool(n);
+  stranded_args_t             args;
+  std::vector<byte_buffer_t*> b(n);
+  pthread_t                   thread;
+  bool                        result = true;
+
+  args.pool = &pool;
+  pthread_create(&thread, NULL, strand_thread, &args);
+  args.filled.wait_pop();
+  for (uint32_t i=0;i<n;i++) {
+    b[i] = pool.try_allocate();
+    if (!b[i]) {
+      result = false;
+    }
+  }
+  if (pool.try_allocate() != NULL || pool.get_nof_exhausted() != 1) {
+    result = false;
+  }
+  for (uint32_t i=0;i<n;i++) {
+    if (b[i]) {
+      pool.deallocate(b[i]);
+    }
+  }
+  args.done.push(0);
+  pthread_join(thread, NULL);
+  return result && pool.get_nof_used() == 0;
+}
+
+/* More pools than PTHREAD_KEYS_MAX, as with one pool per UE, all keep their thread caches. 
+ * The caches of an exited thread are back in their pools, and pools created after others 
+ * were destroyed reuse their ids over the orphaned caches. */
+bool many_pools_test() {
+  const uint32_t n     = PTHREAD_KEYS_MAX + 64;
+  const uint32_t len   = 32;
+  small_pools_t  pools(n);
+  bool           result = true;
+
+  for (uint32_t i=0;i<n;i++) {
+    pools[i] = new buffer_pool<small_buffer_t>(len);
+  }
+  for (uint32_t k=0;k<2;k++) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, touch_pools_thread, &pools);
+    pthread_join(thread, NULL);
+    touch_pools_thread(&pools);
+    for (uint32_t i=0;i<n;i++) {
+      std::vector<small_buffer_t*> b(len);
+      for (uint32_t j=0;j<len;j++) {
+        b[j] = pools[i]->try_allocate();
+        if (!b[j]) {
+          result = false;
+        }
+      }
+      for (uint32_t j=0;j<len;j++) {
+        if (b[j]) {
+          pools[i]->deallocate(b[j]);
+        }
+      }
+      if (pools[i]->get_high_water() != len || pools[i]->get_nof_used() != 0) {
+        result = false;
+      }
+    }
+    // Replace every other pool
+    for (uint32_t i=0;i<n;i+=2) {
+      delete pools[i];
+      pools[i] = new buffer_pool<small_buffer_t>(len);
+    }
+  }
+  for (uint32_t i=0;i<n;i++) {
+    delete pools[i];
+  }
+  return result;
+}
+
+/* A chain mixing pool buffers and slices already in place in the destination,
+ * as built by the MAC, is full after MAX_SLICES and collapses into one slice 
+ * returning its buffers to the pool. */
+bool chain_test() {
+  const uint32_t    len = 16;
+  byte_buffer_pool *pool = byte_buffer_pool::get_instance();
+  uint8_t           dst[buffer_chain::MAX_SLICES*len];
+  buffer_chain      chain;
+  bool              result = true;
+  uint32_t          nof_used = pool->get_nof_used();
+
+  for (uint32_t i=0;i<buffer_chain::MAX_SLICES;i++) {
+    if (i%2) {
+      byte_buffer_t *b = pool->allocate(len);
+      memset(b->msg, i, len);
+      result &= chain.append(b->msg, len, b);
+    } else {
+      memset(&dst[i*len], i, len);
+      result &= chain.append(&dst[i*len], len);
+    }
+  }
+  if (chain.append(dst, len) || chain.length() != buffer_chain::MAX_SLICES*len) {
+    result = false;
+  }
+  chain.collapse(&dst[len], 1);
+  if (chain.size() != 2 || chain.free_slices() != buffer_chain::MAX_SLICES-2 ||
+      chain.length() != buffer_chain::MAX_SLICES*len || pool->get_nof_used() != nof_used) {
+    result = false;
+  }
+  for (uint32_t i=0;i<buffer_chain::MAX_SLICES*len;i++) {
+    if (dst[i] != i/len) {
+      result = false;
+    }
+  }
+  chain.release();
+  return result;
+}
+
+bool fit_reserve_test() {
+  byte_buffer_pool *pool = byte_buffer_pool::get_instance();
+  bool              result = true;
+  uint32_t          nof_used = pool->get_nof_used();
+
+  // A 40 B packet read into an IP-sized buffer moves to a small one
+  byte_buffer_t *b = pool->allocate(SRSLTE_MAX_IP_PACKET_BYTES);
+  for (uint32_t i=0;i<40;i++) {
+    b->msg[i] = i;
+  }
+  b->N_bytes = 40;
+  byte_buffer_t *f = pool->fit(b);
+  if (f == b || f->N_bytes != 40 || f->get_buffer_size() != SRSLTE_BUFFER_SMALL_SIZE_BYTES) {
+    result = false;
+  }
+  for (uint32_t i=0;i<40;i++) {
+    if (f->msg[i] != i) {
+      result = false;
+    }
+  }
+  pool->deallocate(f);
+
+  // A full-size packet stays where it was read
+  b->N_bytes = SRSLTE_MAX_IP_PACKET_BYTES;
+  if (pool->fit(b) != b) {
+    result = false;
+  }
+
+  // Growing past the IP-sized buffer moves the payload to a large one
+  b->N_bytes = 40;
+  if (!pool->reserve(&b, 100) || b->get_buffer_size() != SRSLTE_BUFFER_MEDIUM_SIZE_BYTES) {
+    result = false;
+  }
+  if (!pool->reserve(&b, 8000) || b->get_buffer_size() != SRSLTE_MAX_BUFFER_SIZE_BYTES || b->N_bytes != 40) {
+    result = false;
+  }
+  for (uint32_t i=0;i<40;i++) {
+    if (b->msg[i] != i) {
+      result = false;
+    }
+  }
+  if (pool->reserve(&b, SRSLTE_MAX_BUFFER_SIZE_BYTES)) {
+    result = false;
+  }
+  pool->deallocate(b);
+  return result && pool->get_nof_used() == nof_used;
+}
+
+/* iperf-style traffic: every 1500 B data packet is followed by two 40 B TCP
+ * ACKs. Packets are read into an IP-sized buffer, moved to a smaller one if
+ * they fit, get a PDCP header prepended and wait in a FIFO of in-flight SDUs,
+ * as in the RLC transmit queue, before being read and freed. */
+bool iperf_test(byte_buffer_pool *pool, bool use_size_hint) {
+  static uint8_t  data[SRSLTE_MAX_IP_PACKET_BYTES];
+  byte_buffer_t  *window[IPERF_WINDOW];
+  uint64_t        nof_bytes = 0;
+  uint32_t        checksum  = 0;
+  struct timeval  t0, t1;
+
+  for (uint32_t i=0;i<SRSLTE_MAX_IP_PACKET_BYTES;i++) {
+    data[i] = i;
+  }
+  bzero(window, sizeof(window));
+  gettimeofday(&t0, NULL);
+  for (uint32_t i=0;i<IPERF_PKTS+IPERF_WINDOW;i++) {
+    byte_buffer_t *b = window[i%IPERF_WINDOW];
+    if (b) {
+      for (uint32_t j=0;j<b->N_bytes;j+=64) {
+        checksum += b->msg[j];
+      }
+      nof_bytes += b->N_bytes;
+      pool->deallocate(b);
+      window[i%IPERF_WINDOW] = NULL;
+    }
+    if (i < IPERF_PKTS) {
+      uint32_t len = (i%3) ? 40 : SRSLTE_MAX_IP_PACKET_BYTES;
+      b = use_size_hint ? pool->allocate(SRSLTE_MAX_IP_PACKET_BYTES) : pool->allocate();
+      if (!b) {
+        return false;
+      }
+      memcpy(b->msg, data, len);
+      b->N_bytes = len;
+      if (use_size_hint) {
+        byte_buffer_t *f = pool->fit(b);
+        if (f != b) {
+          pool->deallocate(b);
+          b = f;
+        }
+      }
+      if (b->get_headroom() < 2) {
+        return false;
+      }
+      b->msg -= 2;
+      b->N_bytes += 2;
+      window[i%IPERF_WINDOW] = b;
+    }
+  }
+  gettimeofday(&t1, NULL);
+  printf("iperf %s: %.0f Mbps, %d buffers in flight, %.1f MB pooled\n", use_size_hint?"size classes":"full size   ",
+         nof_bytes*8*1e3/elapsed_ns(&t0, &t1), pool->get_high_water(), (float) pool->get_memory()/1e6);
+  pool->print_stats();
+  return checksum != 0;
+}
+
+int main(int argc, char **argv) {
+  bool                        result = true;
+  buffer_pool<byte_buffer_t>  pool;
+  block_queue<byte_buffer_t*> q;
+  args_t                      args[NOF_THREADS];
+
+  result = basic_test();
+  result &= stranded_test();
+  result &= chain_test();
+  result &= fit_reserve_test();
+  result &= many_pools_test();
+  byte_buffer_pool::cleanup();
+
+  for (uint32_t i=0;i<2;i++) {
+    byte_buffer_pool *bpool = new byte_buffer_pool;
+    result &= iperf_test(bpool, i == 1);
+    delete bpool;
+  }
+
+  for (uint32_t i=0;i<NOF_THREADS;i++) {
+    args[i].pool = &pool;
+    args[i].q    = &q;
+    args[i].id   = i;
+  }
+
+  for (uint32_t n=1;n<=NOF_THREADS;n*=2) {
+    double t_pool = run_threads(burst_thread, args, n);
+    double t_new  = run_threads(new_delete_thread, args, n);
+    printf("%d threads: pool %.1f ns, new/delete %.1f ns per alloc+free\n", n, t_pool, t_new);
+    for (uint32_t i=0;i<n;i++) {
+      result &= args[i].result;
+    }
+  }
+
+  // Buffers allocated in one thread and freed in another
+  struct timeval t0, t1;
+  pthread_t      thread;
+  gettimeofday(&t0, NULL);
+  pthread_create(&thread, NULL, producer_thread, &args[0]);
+  for(uint32_t i=0;i<NOF_ITERS;i++) {
+    byte_buffer_t *b = q.wait_pop();
+    if (b->N_bytes != i || !pool.deallocate(b)) {
+      result = false;
+    }
+  }
+  pthread_join(thread, NULL);
+  gettimeofday(&t1, NULL);
+  result &= args[0].result;
+  printf("cross-thread: %.1f ns per alloc+free\n", elapsed_ns(&t0, &t1)/NOF_ITERS);
+
+  printf("high water mark %d/%d buffers, exhausted %d times\n",
+         pool.get_high_water(), pool.get_capacity(), pool.get_nof_exhausted());
+  if (pool.get_nof_used() != 0) {
+    result = false;
+  }
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
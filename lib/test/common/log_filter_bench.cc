@@ -0,0 +1,190 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NOF_BURSTS    200
+#define BURST_LEN     256
+#define BURST_GAP_US  5000
+#define NOF_THREADS   4
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include "srslte/common/log_filter.h"
+
+using namespace srslte;
+
+/* Measures the time a log_filter call takes on the calling thread, in bursts
+ * short enough for the logger thread to catch up in between, and checks that
+ * every message reaches the log file fully formatted */
+
+static const char *filename = "log_filter_bench.txt";
+
+static uint64_t now_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+typedef enum {
+  CASE_DISABLED = 0,
+  CASE_PLAIN,
+  CASE_ARGS,
+  CASE_HEX,
+  CASE_N_ITEMS
+} case_t;
+
+static const char *case_text[CASE_N_ITEMS] = {"debug (disabled)",
+                                              "info, no arguments",
+                                              "info, 5 arguments",
+                                              "info_hex, 64 bytes"};
+
+typedef struct {
+  log_filter *log;
+  case_t      c;
+  uint32_t    id;
+  uint64_t    ns;
+} args_t;
+
+static void* bench_thread(void *a) {
+  args_t  *args = (args_t*) a;
+  uint8_t  hex[64];
+  uint32_t n = 0;
+
+  for (uint32_t i=0;i<sizeof(hex);i++) {
+    hex[i] = i;
+  }
+  args->ns = 0;
+  for (uint32_t b=0;b<NOF_BURSTS;b++) {
+    uint64_t t0 = now_ns();
+    for (uint32_t i=0;i<BURST_LEN;i++,n++) {
+      switch(args->c) {
+        case CASE_DISABLED:
+          args->log->debug("Thread %d: %d\n", args->id, n);
+          break;
+        case CASE_PLAIN:
+          args->log->info("Scheduling PDSCH grant\n");
+          break;
+        case CASE_ARGS:
+          args->log->info("Thread %d: %d rnti=0x%x %s snr=%.2f\n", args->id, n, 0x46, "PDSCH", 12.5);
+          break;
+        case CASE_HEX:
+          args->log->info_hex(hex, sizeof(hex), "Thread %d: %d\n", args->id, n);
+          break;
+        default:
+          break;
+      }
+    }
+    args->ns += now_ns() - t0;
+    usleep(BURST_GAP_US);
+  }
+  return NULL;
+}
+
+// Runs one case on nof_threads threads and returns the number of lines it should have logged
+static uint32_t run_case(logger *l, case_t c, uint32_t nof_threads) {
+  log_filter filter[NOF_THREADS];
+  pthread_t  threads[NOF_THREADS];
+  args_t     args[NOF_THREADS];
+  uint64_t   ns = 0;
+
+  for (uint32_t i=0;i<nof_threads;i++) {
+    filter[i].init("BENCH", l, true);
+    filter[i].set_level(LOG_LEVEL_INFO);
+    filter[i].set_hex_limit(64);
+    filter[i].step(i);
+    args[i].log = &filter[i];
+    args[i].c   = c;
+    args[i].id  = i;
+    pthread_create(&threads[i], NULL, bench_thread, &args[i]);
+  }
+  for (uint32_t i=0;i<nof_threads;i++) {
+    pthread_join(threads[i], NULL);
+    ns += args[i].ns;
+  }
+  printf("%-20s %d thread(s): %6.1f ns/call\n", case_text[c], nof_threads,
+         (double) ns/(nof_threads*NOF_BURSTS*BURST_LEN));
+  return (c == CASE_DISABLED) ? 0 : nof_threads*NOF_BURSTS*BURST_LEN;
+}
+
+// Checks the count and the formatting of the argument lines
+static bool check_file(uint32_t nof_lines) {
+  char     line[256];
+  uint32_t n_args = 0;
+  uint32_t n_info = 0;
+  bool     pass   = true;
+
+  FILE *f = fopen(filename, "r");
+  if (!f) {
+    return false;
+  }
+  while (fgets(line, sizeof(line), f)) {
+    if (strstr(line, "[BENCH] Info    [")) {
+      n_info++;
+      if (strstr(line, "rnti=")) {
+        int id, n;
+        if (sscanf(strstr(line, "Thread"), "Thread %d: %d rnti=0x46 PDSCH snr=12.50", &id, &n) != 2) {
+          printf("Malformed line: %s", line);
+          pass = false;
+        }
+        n_args++;
+      }
+    }
+  }
+  fclose(f);
+  if (n_info != nof_lines || n_args == 0) {
+    printf("Found %d lines, expected %d\n", n_info, nof_lines);
+    pass = false;
+  }
+  return pass;
+}
+
+int main(int argc, char **argv) {
+  uint32_t nof_lines = 0;
+  bool     result;
+
+  {
+    logger l;
+    l.init(filename);
+    for (uint32_t c=0;c<CASE_N_ITEMS;c++) {
+      nof_lines += run_case(&l, (case_t) c, 1);
+      nof_lines += run_case(&l, (case_t) c, NOF_THREADS);
+    }
+  }
+  result = check_file(nof_lines);
+  remove(filename);
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
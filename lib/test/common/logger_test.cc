@@ -26,9 +26,11 @@
 
 #define NTHREADS 100
 #define NMSGS    100
+#define NBURST   20000
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "srslte/common/logger.h"
 
 using namespace srslte;
@@ -90,12 +92,53 @@ bool read(std::string filename) {
   return pass;
 }
 
+// A burst much larger than the ring: every message, including the one logged by the
+// destructor, is either written or counted as dropped
+bool burst(std::string filename, bool block) {
+  char     pad[201];
+  char     buf[300];
+  uint32_t nof_written = 0;
+  uint32_t nof_dropped = 0;
+  uint32_t n;
+  int      msg;
+
+  memset(pad, 'x', 200);
+  pad[200] = '\0';
+  {
+    logger l;
+    l.set_block_when_full(block);
+    l.init(filename);
+    for(int i=0;i<NBURST;i++) {
+      sprintf(buf, "Burst %d %s\n", i, pad);
+      l.log(buf);
+    }
+  }
+
+  FILE *f = fopen(filename.c_str(), "r");
+  if(f!=NULL) {
+    char line[512];
+    while(fgets(line, sizeof(line), f)) {
+      if(sscanf(line, "Burst %d", &msg) == 1 || !strncmp(line, "Closing log", 11)) {
+        nof_written++;
+      } else if(sscanf(line, "Logger: %u messages dropped", &n) == 1) {
+        nof_dropped += n;
+      }
+    }
+    fclose(f);
+  }
+  remove(filename.c_str());
+  printf("Burst %s: %d written, %d dropped\n", block?"blocking":"non-blocking", nof_written, nof_dropped);
+  return nof_written + nof_dropped == NBURST + 1 && (!block || nof_dropped == 0);
+}
+
 int main(int argc, char **argv) {
   bool result;
   std::string f("log.txt");
   write(f);
   result = read(f);
   remove(f.c_str());
+  result = burst(f, false) && result;
+  result = burst(f, true) && result;
   if(result) {
     printf("Passed\n");
     exit(0);
@@ -0,0 +1,192 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define MAX_SUBH     70
+#define MAX_PDU_LEN  2048
+#define CHAIN_LCID   3
+#define COPY_LCID    4
+#define PAYLOAD_LCID 1
+
+#include <stdio.h>
+#include <string.h>
+#include "srslte/common/pdu.h"
+#include "srslte/common/log_stdout.h"
+
+using namespace srslte;
+
+/* Bearer returning an RLC-like PDU made of a 2 byte header and a slice of a
+ * fixed pattern. CHAIN_LCID references both parts in the chain, the other
+ * LCIDs only support read_pdu() */
+class sdu_source : public read_pdu_interface
+{
+public:
+  static const uint32_t HDR_LEN = 2;
+
+  sdu_source() {
+    for (uint32_t i=0;i<sizeof(data);i++) {
+      data[i] = (uint8_t) (i*7 + i/256);
+    }
+    cnt    = 0;
+    offset = 0;
+  }
+
+  int read_pdu(uint32_t lcid, uint8_t *payload, uint32_t requested_bytes) {
+    uint32_t len = next(lcid, requested_bytes);
+    if (len > 0) {
+      memcpy(payload, hdrs[cnt], HDR_LEN);
+      memcpy(&payload[HDR_LEN], &data[offset], len - HDR_LEN);
+      consume(len);
+    }
+    return len;
+  }
+
+  int read_pdu_chain(uint32_t lcid, buffer_chain *chain, uint32_t requested_bytes) {
+    if (lcid != CHAIN_LCID) {
+      return -1;
+    }
+    uint32_t len = next(lcid, requested_bytes);
+    if (len > 0) {
+      chain->append(hdrs[cnt], HDR_LEN);
+      chain->append(&data[offset], len - HDR_LEN);
+      consume(len);
+    }
+    return len;
+  }
+
+private:
+  static const uint32_t MAX_READS = 256;
+
+  // Writes the header of the next PDU and returns its length
+  uint32_t next(uint32_t lcid, uint32_t requested_bytes) {
+    if (requested_bytes <= HDR_LEN || cnt >= MAX_READS) {
+      return 0;
+    }
+    hdrs[cnt][0] = lcid;
+    hdrs[cnt][1] = cnt;
+    return HDR_LEN + SRSLTE_MIN(requested_bytes - HDR_LEN, 5 + (cnt*7)%40);
+  }
+
+  void consume(uint32_t len) {
+    offset = (offset + len - HDR_LEN)%(sizeof(data)/2);
+    cnt++;
+  }
+
+  uint8_t  data[4096];
+  uint8_t  hdrs[MAX_READS][HDR_LEN];
+  uint32_t cnt;
+  uint32_t offset;
+};
+
+typedef struct {
+  uint32_t pdu_len;
+  uint32_t nof_sdu;
+  uint32_t max_req;
+  bool     ce;
+} pdu_test_t;
+
+/* Fills the PDU with CEs, SDUs copied from a payload and SDUs read from the
+ * bearers, in the same order whether it is built flat or as a chain */
+static uint8_t* build_pdu(sch_pdu *mac, sdu_source *src, pdu_test_t *t, srslte::log *log_h)
+{
+  uint8_t payload[64];
+  for (uint32_t i=0;i<sizeof(payload);i++) {
+    payload[i] = 0xA0 + i;
+  }
+  if (t->ce) {
+    if (!mac->new_subh() || !mac->get()->set_con_res_id(0x123456789ABCULL)) {
+      return NULL;
+    }
+    if (!mac->new_subh() || !mac->get()->set_ta_cmd(31)) {
+      return NULL;
+    }
+  }
+  for (uint32_t i=0;i<t->nof_sdu && mac->get_sdu_space() > 0 && mac->new_subh();i++) {
+    uint32_t req = SRSLTE_MIN(t->max_req, (uint32_t) mac->get_sdu_space());
+    int n;
+    if (i%3 == 2) {
+      n = mac->get()->set_sdu(PAYLOAD_LCID, SRSLTE_MIN(req, sizeof(payload)), payload);
+    } else {
+      n = mac->get()->set_sdu(i%3 ? COPY_LCID : CHAIN_LCID, req, src);
+    }
+    if (n <= 0) {
+      mac->del_subh();
+      break;
+    }
+  }
+  return mac->write_packet(log_h);
+}
+
+/* The chain gathered after write_packet() must hold the same bytes as the
+ * PDU built by copying the SDUs into the payload buffer */
+bool chain_test(pdu_test_t *t, srslte::log *log_h)
+{
+  uint8_t      tx_flat[MAX_SUBH*2 + 13 + MAX_PDU_LEN];
+  uint8_t      tx_chain[MAX_SUBH*2 + 13 + MAX_PDU_LEN];
+  uint8_t      gathered[MAX_PDU_LEN];
+  sdu_source   src_flat, src_chain;
+  sch_pdu      mac_flat(MAX_SUBH), mac_chain(MAX_SUBH);
+  buffer_chain chain;
+
+  mac_flat.init_tx(tx_flat, t->pdu_len);
+  uint8_t *pdu_flat = build_pdu(&mac_flat, &src_flat, t, log_h);
+
+  mac_chain.init_tx_chain(tx_chain, t->pdu_len, &chain);
+  uint8_t *pdu_chain = build_pdu(&mac_chain, &src_chain, t, log_h);
+
+  bool result = pdu_flat && pdu_chain &&
+                chain.length() == t->pdu_len &&
+                chain.gather(gathered) == t->pdu_len &&
+                !memcmp(pdu_flat, gathered, t->pdu_len);
+
+  printf("PDU %4d bytes, %2d subheaders, %2d slices: %s\n",
+         t->pdu_len, mac_chain.nof_subh(), chain.size(), result ? "Ok" : "Error");
+  chain.release();
+  return result;
+}
+
+int main(int argc, char **argv) {
+  srslte::log_stdout log("MAC");
+  log.set_level(srslte::LOG_LEVEL_WARNING);
+
+  pdu_test_t tests[] = {
+    {300,  8,  60,  true},   // Multi-byte padding
+    {200,  40, 200, false},  // Last SDU takes the remaining space
+    {2000, 60, 20,  true},   // More slices than the chain holds, collapses
+  };
+
+  bool result = true;
+  for (uint32_t i=0;i<sizeof(tests)/sizeof(pdu_test_t);i++) {
+    result &= chain_test(&tests[i], &log);
+  }
+
+  if (result) {
+    printf("Ok\n");
+    exit(0);
+  } else {
+    printf("Failed\n");
+    exit(1);
+  }
+}
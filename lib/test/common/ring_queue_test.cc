@@ -0,0 +1,199 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define NOF_PRODUCERS 4
+#define NOF_ITEMS     (1<<20)
+#define NOF_SAMPLES   10000
+#define PACING_US     20
+#define RING_LEN      1024
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <algorithm>
+#include <vector>
+#include "srslte/common/ring_queue.h"
+#include "srslte/common/block_queue.h"
+
+using namespace srslte;
+
+/* Compares the lock-free rings with the mutex and condition variable based
+ * block_queue: ordering and loss checks, throughput with one and several
+ * producers and the p99 latency of handing one item to a sleeping consumer */
+
+template<class queue_t>
+struct args_t {
+  queue_t  *q;
+  uint32_t  id;
+  uint32_t  nof_items;
+  bool      paced;
+};
+
+static uint64_t now_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+// Items carry the producer id in the upper bits and a sequence number, or a timestamp if paced
+template<class queue_t>
+void* producer_thread(void *a) {
+  args_t<queue_t> *args = (args_t<queue_t>*) a;
+  for (uint32_t i=0;i<args->nof_items;i++) {
+    if (args->paced) {
+      args->q->push(now_ns());
+      usleep(PACING_US);
+    } else {
+      args->q->push(((uint64_t) args->id << 32) | i);
+    }
+  }
+  return NULL;
+}
+
+template<class queue_t>
+bool run_throughput(const char *name, queue_t *q, uint32_t nof_producers) {
+  pthread_t                threads[NOF_PRODUCERS];
+  args_t<queue_t>          args[NOF_PRODUCERS];
+  std::vector<uint32_t>    next(nof_producers, 0);
+  bool                     result = true;
+  uint32_t                 nof_items = NOF_ITEMS/nof_producers;
+
+  uint64_t t0 = now_ns();
+  for (uint32_t i=0;i<nof_producers;i++) {
+    args[i].q         = q;
+    args[i].id        = i;
+    args[i].nof_items = nof_items;
+    args[i].paced     = false;
+    pthread_create(&threads[i], NULL, producer_thread<queue_t>, &args[i]);
+  }
+  for (uint32_t i=0;i<nof_items*nof_producers;i++) {
+    uint64_t v  = q->wait_pop();
+    uint32_t id = v >> 32;
+    // Items of each producer arrive in order and none is lost
+    if (id >= nof_producers || (uint32_t) v != next[id]++) {
+      result = false;
+    }
+  }
+  for (uint32_t i=0;i<nof_producers;i++) {
+    pthread_join(threads[i], NULL);
+  }
+  uint64_t t1 = now_ns();
+  printf("%-12s %d producer%s: %6.2f Mops/s\n", name, nof_producers, nof_producers>1?"s":" ",
+         (double) nof_items*nof_producers*1e3/(t1-t0));
+  return result && q->empty();
+}
+
+template<class queue_t>
+bool run_latency(const char *name, queue_t *q) {
+  pthread_t             thread;
+  args_t<queue_t>       args;
+  std::vector<uint64_t> lat(NOF_SAMPLES);
+
+  args.q         = q;
+  args.id        = 0;
+  args.nof_items = NOF_SAMPLES;
+  args.paced     = true;
+  pthread_create(&thread, NULL, producer_thread<queue_t>, &args);
+  for (uint32_t i=0;i<NOF_SAMPLES;i++) {
+    uint64_t t = q->wait_pop();
+    lat[i] = now_ns() - t;
+  }
+  pthread_join(thread, NULL);
+  std::sort(lat.begin(), lat.end());
+  printf("%-12s handoff latency: p50 %5.1f us, p99 %5.1f us\n", name,
+         lat[NOF_SAMPLES/2]/1e3, lat[NOF_SAMPLES*99/100]/1e3);
+  return true;
+}
+
+bool batch_test() {
+  spsc_ring<uint32_t> spsc(10);
+  mpsc_ring<uint32_t> mpsc(10);
+  uint32_t            in[20], out[20];
+  bool                result = true;
+
+  for (uint32_t i=0;i<20;i++) {
+    in[i] = i;
+  }
+  // Capacities are rounded up to 16
+  if (spsc.get_capacity() != 16 || mpsc.get_capacity() != 16) {
+    result = false;
+  }
+  if (spsc.try_push(in, 20) != 16 || spsc.try_push(in[0]) || spsc.size() != 16 ||
+      mpsc.try_push(in, 20) != 16 || mpsc.try_push(in[0]) || mpsc.size() != 16) {
+    result = false;
+  }
+  if (spsc.try_pop(out, 5) != 5 || spsc.try_pop(&out[5], 20) != 11 || !spsc.empty() ||
+      mpsc.try_pop(out, 5) != 5 || mpsc.try_pop(&out[5], 20) != 11 || !mpsc.empty()) {
+    result = false;
+  }
+  for (uint32_t i=0;i<16;i++) {
+    if (out[i] != i) {
+      result = false;
+    }
+  }
+  // Indices wrap around the ring
+  for (uint32_t i=0;i<100;i++) {
+    uint32_t v = 0;
+    spsc.try_push(i);
+    mpsc.try_push(i);
+    if (!spsc.front(&v) || v != i || !spsc.try_pop(&v) || v != i || !mpsc.try_pop(&v) || v != i) {
+      result = false;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  bool result = batch_test();
+
+  {
+    block_queue<uint64_t> q;
+    result &= run_throughput("block_queue", &q, 1);
+    result &= run_throughput("block_queue", &q, NOF_PRODUCERS);
+    result &= run_latency("block_queue", &q);
+  }
+  {
+    spsc_ring<uint64_t> q(RING_LEN, true);
+    result &= run_throughput("spsc_ring", &q, 1);
+    result &= run_latency("spsc_ring", &q);
+  }
+  {
+    mpsc_ring<uint64_t> q(RING_LEN, true);
+    result &= run_throughput("mpsc_ring", &q, 1);
+    result &= run_throughput("mpsc_ring", &q, NOF_PRODUCERS);
+    result &= run_latency("mpsc_ring", &q);
+  }
+
+  if(result) {
+    printf("Passed\n");
+    exit(0);
+  }else{
+    printf("Failed\n");
+    exit(1);
+  }
+}
@@ -27,9 +27,12 @@
 #include <iostream>
 #include "srslte/common/log_stdout.h"
 #include "srslte/upper/rlc_um.h"
+#include "srslte/common/pdu.h"
 #include <assert.h>
 
 #define NBUFS 5
+#define NBUFS_CHAIN 200
+#define MAC_PDU_LEN 300
 
 using namespace srslte;
 using namespace srsue;
@@ -72,10 +75,30 @@ public:
   // RRC interface
   void max_retx_attempted(){}
 
-  byte_buffer_t *sdus[5];
+  byte_buffer_t *sdus[NBUFS_CHAIN];
   int n_sdus;
 };
 
+// MAC side of an RLC entity, reading PDUs either by copy or as slices
+class rlc_um_reader
+    :public srslte::read_pdu_interface
+{
+public:
+  rlc_um_reader(rlc_um *rlc_){rlc = rlc_;}
+
+  int read_pdu(uint32_t lcid, uint8_t *payload, uint32_t requested_bytes)
+  {
+    return rlc->read_pdu(payload, requested_bytes);
+  }
+  int read_pdu_chain(uint32_t lcid, buffer_chain *chain, uint32_t requested_bytes)
+  {
+    return rlc->read_pdu_chain(chain, requested_bytes);
+  }
+
+private:
+  rlc_um *rlc;
+};
+
 void basic_test()
 {
   srslte::log_stdout log1("RLC_UM_1");
@@ -210,9 +233,120 @@ void loss_test()
   assert(NBUFS-1 == tester.n_sdus);
 }
 
+void chain_test()
+{
+  srslte::log_stdout log1("RLC_UM_1");
+  srslte::log_stdout log2("RLC_UM_2");
+  log1.set_level(srslte::LOG_LEVEL_WARNING);
+  log2.set_level(srslte::LOG_LEVEL_WARNING);
+  rlc_um_tester    tester;
+  mac_dummy_timers timers;
+  byte_buffer_pool *pool = byte_buffer_pool::get_instance();
+
+  rlc_um rlc1;
+  rlc_um rlc1_flat;
+  rlc_um rlc2;
+  rlc_um_reader reader(&rlc1);
+  rlc_um_reader reader_flat(&rlc1_flat);
+
+  rlc1.init(&log1, 3, &tester, &tester, &timers);
+  rlc1_flat.init(&log1, 3, &tester, &tester, &timers);
+  rlc2.init(&log2, 3, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_UM_BI;
+  cnfg.dl_um_bi_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_um_bi_rlc.sn_field_len = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+  cnfg.ul_um_bi_rlc.sn_field_len = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+
+  rlc1.configure(&cnfg);
+  rlc1_flat.configure(&cnfg);
+  rlc2.configure(&cnfg);
+
+  uint32_t nof_used = pool->get_nof_used();
+
+  // Build MAC PDUs with several RLC PDUs each, the SDUs are segmented 
+  // across RLC and MAC PDUs. RLC1 builds chains and RLC1_FLAT, fed with the 
+  // same SDUs, copies them into a contiguous PDU
+  srslte::sch_pdu mac_tx(20);
+  srslte::sch_pdu mac_tx_flat(20);
+  srslte::sch_pdu mac_rx(20);
+  srslte::buffer_chain chain;
+  uint8_t tx_buffer[2*MAC_PDU_LEN];
+  uint8_t tx_buffer_flat[2*MAC_PDU_LEN];
+  uint8_t pdu[MAC_PDU_LEN];
+  int n_written = 0;
+  while(n_written < NBUFS_CHAIN || rlc1.get_buffer_state() > 0)
+  {
+    // Push SDUs of different sizes into RLC1, the chains take them over
+    for(int i=0;i<8 && n_written < NBUFS_CHAIN;i++)
+    {
+      byte_buffer_t *sdu = pool->allocate();
+      sdu->N_bytes = 10 + n_written%50;
+      memset(sdu->msg, n_written, sdu->N_bytes);
+      rlc1.write_sdu(sdu);
+      byte_buffer_t *sdu_flat = pool->allocate();
+      *sdu_flat = *sdu;
+      rlc1_flat.write_sdu(sdu_flat);
+      n_written++;
+    }
+
+    mac_tx.init_tx_chain(tx_buffer, MAC_PDU_LEN, &chain);
+    int n = 1;
+    while(n > 0 && mac_tx.get_sdu_space() > 0 && mac_tx.new_subh())
+    {
+      n = mac_tx.get()->set_sdu(3, SRSLTE_MIN(100, mac_tx.get_sdu_space()), &reader);
+      if(n <= 0)
+        mac_tx.del_subh();
+    }
+    uint8_t *pdu_chain = mac_tx.write_packet();
+    uint32_t nof_gathered = chain.gather(pdu);
+    assert(pdu_chain);
+    assert(MAC_PDU_LEN == chain.length());
+    assert(MAC_PDU_LEN == nof_gathered);
+    chain.release();
+
+    mac_tx_flat.init_tx(tx_buffer_flat, MAC_PDU_LEN);
+    n = 1;
+    while(n > 0 && mac_tx_flat.get_sdu_space() > 0 && mac_tx_flat.new_subh())
+    {
+      n = mac_tx_flat.get()->set_sdu(3, SRSLTE_MIN(100, mac_tx_flat.get_sdu_space()), &reader_flat);
+      if(n <= 0)
+        mac_tx_flat.del_subh();
+    }
+    uint8_t *pdu_flat = mac_tx_flat.write_packet();
+    assert(pdu_flat);
+    assert(0 == memcmp(pdu, pdu_flat, MAC_PDU_LEN));
+
+    // Deliver the SDUs to RLC2
+    mac_rx.init_rx(MAC_PDU_LEN);
+    mac_rx.parse_packet(pdu);
+    while(mac_rx.next())
+    {
+      if(mac_rx.get()->is_sdu())
+        rlc2.write_pdu(mac_rx.get()->get_sdu_ptr(), mac_rx.get()->get_payload_size());
+    }
+  }
+
+  assert(NBUFS_CHAIN == tester.n_sdus);
+  for(int i=0; i<tester.n_sdus; i++)
+  {
+    assert(tester.sdus[i]->N_bytes == (uint32_t) (10 + i%50));
+    for(uint32_t j=0;j<tester.sdus[i]->N_bytes;j++)
+      assert(tester.sdus[i]->msg[j] == (uint8_t) i);
+    pool->deallocate(tester.sdus[i]);
+  }
+
+  // All transmitted SDUs went back to the pool with the chains, RLC2 only
+  // holds the reassembly buffer it allocated on the first PDU
+  assert(nof_used + 1 == pool->get_nof_used());
+}
+
 int main(int argc, char **argv) {
   basic_test();
   byte_buffer_pool::get_instance()->cleanup();
   loss_test();
   byte_buffer_pool::get_instance()->cleanup();
+  chain_test();
+  byte_buffer_pool::get_instance()->cleanup();
 }
@@ -58,6 +58,9 @@ public:
   }
   
   virtual ~ue() {
+    for (int i=0;i<NOF_HARQ_PROCESSES;i++) {
+      tx_chain[i].release();
+    }
     pthread_mutex_destroy(&mutex);
   }
   
@@ -68,9 +71,10 @@ public:
   
   void     config(uint16_t rnti, uint32_t nof_prb, sched_interface *sched, rrc_interface_mac *rrc_, rlc_interface_mac *rlc, srslte::log *log_h);
   uint8_t* generate_pdu(sched_interface::dl_sched_pdu_t pdu[sched_interface::MAX_RLC_PDU_LIST], 
-                    uint32_t nof_pdu_elems, uint32_t grant_size);
+                    uint32_t nof_pdu_elems, uint32_t grant_size, srslte::buffer_chain *chain = NULL);
   
   srslte_softbuffer_tx_t* get_tx_softbuffer(uint32_t harq_process);
+  srslte::buffer_chain*   get_tx_chain(uint32_t harq_process);
   srslte_softbuffer_rx_t* get_rx_softbuffer(uint32_t tti);
   
   bool     process_pdus(); 
@@ -91,6 +95,7 @@ public:
 
 private: 
   int  read_pdu(uint32_t lcid, uint8_t *payload, uint32_t requested_bytes);   
+  int  read_pdu_chain(uint32_t lcid, srslte::buffer_chain *chain, uint32_t requested_bytes);
   void allocate_sdu(srslte::sch_pdu *pdu, uint32_t lcid, uint32_t sdu_len);   
   bool process_ce(srslte::sch_subh *subh); 
   void allocate_ce(srslte::sch_pdu *pdu, uint32_t lcid);
@@ -120,6 +125,9 @@ private:
   const static int payload_buffer_len = 128*1024; 
   uint8_t          tx_payload_buffer[payload_buffer_len];
   
+  // SDUs of a DL PDU built without copying, released by the PHY once encoded 
+  srslte::buffer_chain tx_chain[NOF_HARQ_PROCESSES];
+  
   // For UL there are multiple buffers per PID and are managed by pdu_queue
   srslte::pdu_queue pdus; 
   srslte::sch_pdu mac_msg_dl, mac_msg_ul;
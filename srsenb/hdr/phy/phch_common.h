@@ -41,6 +41,9 @@ namespace srsenb {
 typedef struct {
   float max_prach_offset_us; 
   int pusch_max_its;
+  int pusch_dec_threads;
+  int pusch_min_its;
+  int pusch_deadline_us;
   float tx_amplitude; 
   int nof_phy_threads;  
   std::string equalizer_mode; 
@@ -28,6 +28,7 @@
 #define ENBPHYWORKER_H
 
 #include <string.h>
+#include <vector>
 
 #include "srslte/srslte.h"
 #include "phy/phch_common.h"
@@ -64,6 +65,7 @@ public:
                             uint32_t I_sr, bool pucch_cqi, uint32_t pmi_idx, bool pucch_cqi_ack);
   
   uint32_t get_metrics(phy_metrics_t metrics[ENB_METRICS_MAX_USERS]);
+  void     get_pusch_dec_metrics(pusch_dec_metrics_t *metrics);
   
 private: 
   
@@ -72,7 +74,7 @@ private:
   
   void work_imp();
   
-  int encode_pdsch(srslte_enb_dl_pdsch_t *grants, uint32_t nof_grants, uint32_t sf_idx);
+  int encode_pdsch(srslte_enb_dl_pdsch_t *grants, srslte::buffer_chain **chains, uint32_t nof_grants, uint32_t sf_idx);
   int decode_pusch(srslte_enb_ul_pusch_t *grants, uint32_t nof_pusch, uint32_t tti_rx);
   int encode_phich(srslte_enb_dl_phich_t *acks, uint32_t nof_acks, uint32_t sf_idx);
   int encode_pdcch_dl(srslte_enb_dl_pdsch_t *grants, uint32_t nof_grants, uint32_t sf_idx);
@@ -92,6 +94,7 @@ private:
   srslte_enb_ul_t enb_ul;
   
   srslte_timestamp_t tx_time; 
+  struct timespec    rx_clock;  // CLOCK_MONOTONIC time at which the subframe was received
 
   // Class to store user information 
   class ue {
@@ -113,6 +116,17 @@ private:
   }; 
   std::map<uint16_t,ue> ue_db;   
   
+  // UCI expected from each user with PUCCH in the current subframe, detected jointly 
+  typedef struct {
+    srslte_uci_data_t  uci_data; 
+    srslte_cqi_value_t cqi_value; 
+    bool               needs_ack; 
+    bool               needs_sr; 
+    bool               needs_cqi; 
+  } pucch_ue_t; 
+  std::vector<pucch_ue_t>               pucch_ue; 
+  std::vector<srslte_enb_ul_pucch_rx_t> pucch_rx; 
+  
   // mutex to protect worker_imp() from configuration interface 
   pthread_mutex_t mutex; 
 };
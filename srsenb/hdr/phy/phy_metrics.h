@@ -27,6 +27,8 @@
 #ifndef ENB_PHY_METRICS_H
 #define ENB_PHY_METRICS_H
 
+#include <stdint.h>
+
 
 namespace srsenb {
 
@@ -54,6 +56,16 @@ struct phy_metrics_t
   ul_metrics_t   ul;
 };
 
+// PUSCH turbo decoder counters of all users since the last read 
+struct pusch_dec_metrics_t
+{
+  uint64_t nof_cb;
+  uint64_t nof_iterations;
+  uint64_t nof_cb_capped_sinr;
+  uint64_t nof_cb_capped_deadline;
+  uint64_t nof_cb_abandoned;
+};
+
 } // namespace srsenb
 
 #endif // ENB_PHY_METRICS_H
@@ -31,6 +31,9 @@
 #include "srslte/common/log.h"
 #include "srslte/common/threads.h"
 
+// Number of PRACH windows that can be pending of processing 
+#define PRACH_WORKER_NOF_BUFFERS 4
+
 namespace srsenb {
   
 class prach_worker : thread
@@ -45,7 +48,7 @@ public:
   
 private:
   void run_thread();
-  int run_tti(uint32_t tti); 
+  int run_tti(uint32_t tti, cf_t *signal_buffer_rx); 
   
   uint32_t prach_nof_det; 
   uint32_t prach_indices[165]; 
@@ -59,14 +62,16 @@ private:
   pthread_mutex_t mutex;
   pthread_cond_t  cvar;
 
-  cf_t *signal_buffer_rx;
+  // Ring of captured PRACH windows, written by new_tti() and processed by the worker thread
+  cf_t     *signal_buffer_rx[PRACH_WORKER_NOF_BUFFERS];
+  uint32_t  buffer_tti[PRACH_WORKER_NOF_BUFFERS];
+  uint32_t  nof_written; 
+  uint32_t  nof_processed; 
   
   srslte::log* log_h;
   mac_interface_phy *mac;
   float max_prach_offset_us;
   bool initiated;
-  uint32_t pending_tti;
-  int processed_tti;
   bool running;
   uint32_t nof_sf;
   uint32_t sf_cnt;
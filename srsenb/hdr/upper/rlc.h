@@ -57,12 +57,15 @@ public:
   
   // rlc_interface_mac
   int  read_pdu(uint16_t rnti, uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
+  int  read_pdu_chain(uint16_t rnti, uint32_t lcid, srslte::buffer_chain *chain, uint32_t nof_bytes);
   void read_pdu_bcch_dlsch(uint32_t sib_index, uint8_t *payload);
   void write_pdu(uint16_t rnti, uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
   void read_pdu_pcch(uint8_t *payload, uint32_t buffer_size); 
   
 private: 
   
+  void update_buffer_state(uint16_t rnti, uint32_t lcid);
+  
   class user_interface : public srsue::pdcp_interface_rlc, 
                          public srsue::rrc_interface_rlc, 
                          public srsue::ue_interface
@@ -249,6 +249,7 @@ bool enb::get_metrics(enb_metrics_t &m)
   rf_metrics.rf_error = false; // Reset error flag
 
   phy.get_metrics(m.phy);
+  phy.get_pusch_dec_metrics(&m.pusch_dec);
   mac.get_metrics(m.mac);
   rrc.get_metrics(m.rrc);
   s1ap.get_metrics(m.s1ap);
@@ -436,6 +436,7 @@ int mac::get_dl_sched(uint32_t tti, dl_sched_t *dl_sched_res)
   }
   
   int n = 0; 
+  bzero(dl_sched_res->chains, sizeof(dl_sched_res->chains));
   
   // Copy data grants 
   for (uint32_t i=0;i<sched_result.nof_data_elems;i++) {
@@ -452,9 +453,14 @@ int mac::get_dl_sched(uint32_t tti, dl_sched_t *dl_sched_res)
     
     // Get PDU if it's a new transmission
     if (sched_result.data[i].nof_pdu_elems > 0) {
+      // The PHY gathers the SDUs while encoding unless pcap needs the PDU in a single buffer 
+      srslte::buffer_chain *chain = pcap ? NULL : ue_db[rnti]->get_tx_chain(sched_result.data[i].dci.harq_process);
       dl_sched_res->sched_grants[n].data     = ue_db[rnti]->generate_pdu(sched_result.data[i].pdu, 
                                                         sched_result.data[i].nof_pdu_elems, 
-                                                        sched_result.data[i].tbs);
+                                                        sched_result.data[i].tbs, chain);
+      if (dl_sched_res->sched_grants[n].data) {
+        dl_sched_res->chains[n] = chain;
+      }
       srslte_softbuffer_tx_reset_tbs(dl_sched_res->sched_grants[n].softbuffer, sched_result.data[i].tbs);
       
       if (pcap) {
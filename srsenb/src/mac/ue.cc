@@ -97,6 +97,11 @@ srslte_softbuffer_tx_t* ue::get_tx_softbuffer(uint32_t harq_process)
   return &softbuffer_tx[harq_process%NOF_HARQ_PROCESSES];
 }
 
+srslte::buffer_chain* ue::get_tx_chain(uint32_t harq_process)
+{
+  return &tx_chain[harq_process%NOF_HARQ_PROCESSES];
+}
+
 uint8_t* ue::request_buffer(uint32_t tti, uint32_t len)
 {
   uint8_t *ret = NULL; 
@@ -275,6 +280,11 @@ int ue::read_pdu(uint32_t lcid, uint8_t *payload, uint32_t requested_bytes)
   return rlc->read_pdu(rnti, lcid, payload, requested_bytes);  
 }
 
+int ue::read_pdu_chain(uint32_t lcid, srslte::buffer_chain *chain, uint32_t requested_bytes) 
+{
+  return rlc->read_pdu_chain(rnti, lcid, chain, requested_bytes);  
+}
+
 void ue::allocate_sdu(srslte::sch_pdu *pdu, uint32_t lcid, uint32_t total_sdu_len) 
 {
   int sdu_space = pdu->get_sdu_space();
@@ -321,13 +331,19 @@ void ue::allocate_ce(srslte::sch_pdu *pdu, uint32_t lcid)
 }
 
 uint8_t* ue::generate_pdu(sched_interface::dl_sched_pdu_t pdu[sched_interface::MAX_RLC_PDU_LIST], 
-                      uint32_t nof_pdu_elems, uint32_t grant_size)
+                      uint32_t nof_pdu_elems, uint32_t grant_size, srslte::buffer_chain *chain)
 {
   uint8_t *ret = NULL; 
   pthread_mutex_lock(&mutex);
   if (rlc) 
   {
-    mac_msg_dl.init_tx(tx_payload_buffer, grant_size, false);
+    if (chain) {
+      // Buffers of a PDU that never reached the PHY 
+      chain->release();
+      mac_msg_dl.init_tx_chain(tx_payload_buffer, grant_size, chain);
+    } else {
+      mac_msg_dl.init_tx(tx_payload_buffer, grant_size, false);
+    }
     for (uint32_t i=0;i<nof_pdu_elems;i++) {
       if (pdu[i].lcid <= srslte::sch_subh::PHR_REPORT) {
         allocate_sdu(&mac_msg_dl, pdu[i].lcid, pdu[i].nbytes);
@@ -337,6 +353,9 @@ uint8_t* ue::generate_pdu(sched_interface::dl_sched_pdu_t pdu[sched_interface::M
     }
     
     ret = mac_msg_dl.write_packet(log_h);   
+    if (!ret && chain) {
+      chain->release();
+    }
     
   } else {
     std::cout << "Error ue not configured (must call config() first" << std::endl; 
@@ -151,6 +151,18 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         bpo::value<int>(&args->expert.phy.pusch_max_its)->default_value(4),
         "Maximum number of turbo decoder iterations")
 
+    ("expert.pusch_dec_threads",
+        bpo::value<int>(&args->expert.phy.pusch_dec_threads)->default_value(0),
+        "Number of helper threads decoding PUSCH code blocks in parallel (0 decodes them serially)")
+
+    ("expert.pusch_min_its",
+        bpo::value<int>(&args->expert.phy.pusch_min_its)->default_value(0),
+        "Turbo decoder iterations for transmissions whose SNR is too low to decode (0 disables)")
+
+    ("expert.pusch_deadline_us",
+        bpo::value<int>(&args->expert.phy.pusch_deadline_us)->default_value(2000),
+        "Time after the reception of a subframe by which its PUSCH must be decoded (0 disables)")
+
     ("expert.tx_amplitude",
         bpo::value<float>(&args->expert.phy.tx_amplitude)->default_value(0.8),
         "Transmit amplitude factor")
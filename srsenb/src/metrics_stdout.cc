@@ -152,6 +152,14 @@ void metrics_stdout::print_metrics()
   } else {
     cout << "--- No users ---" << endl; 
   }
+  if(metrics.pusch_dec.nof_cb_capped_deadline || metrics.pusch_dec.nof_cb_abandoned) {
+    printf("PUSCH decoder: %ld code blocks, %.2f iterations/cb, %ld capped by SNR, %ld capped by deadline, %ld abandoned\n", 
+           (long) metrics.pusch_dec.nof_cb, 
+           metrics.pusch_dec.nof_cb ? (float) metrics.pusch_dec.nof_iterations/metrics.pusch_dec.nof_cb : 0, 
+           (long) metrics.pusch_dec.nof_cb_capped_sinr, 
+           (long) metrics.pusch_dec.nof_cb_capped_deadline, 
+           (long) metrics.pusch_dec.nof_cb_abandoned);
+  }
   if(metrics.rf.rf_error) {
     printf("RF status: O=%d, U=%d, L=%d\n", metrics.rf.rf_o, metrics.rf.rf_u, metrics.rf.rf_l);
   }
@@ -111,6 +111,15 @@ void phch_worker::init(phch_common* phy_, srslte::log *log_h_)
   
   srslte_pucch_set_threshold(&enb_ul.pucch, 0.8, 0.5); 
   srslte_sch_set_max_noi(&enb_ul.pusch.ul_sch, phy->params.pusch_max_its);
+  if (phy->params.pusch_min_its > 0 || phy->params.pusch_deadline_us > 0) {
+    // Without pusch_min_its the SINR cap keeps pusch_max_its and only the deadline limits iterations 
+    uint32_t min_its = phy->params.pusch_min_its > 0 ? phy->params.pusch_min_its : phy->params.pusch_max_its; 
+    srslte_sch_set_adaptive_noi(&enb_ul.pusch.ul_sch, true, min_its, SRSLTE_SCH_ADAPT_DEFAULT_MARGIN_DB);
+  }
+  if (srslte_sch_set_decoder_threads(&enb_ul.pusch.ul_sch, phy->params.pusch_dec_threads)) {
+    fprintf(stderr, "Error setting PUSCH decoder threads\n");
+    return;
+  }
   srslte_enb_dl_set_amp(&enb_dl, phy->params.tx_amplitude);
   
   Info("Worker %d configured cell %d PRB\n", get_id(), phy->cell.nof_prb);
@@ -143,6 +152,7 @@ void phch_worker::set_time(uint32_t tti_, uint32_t tx_mutex_cnt_, srslte_timesta
   sf_sched_ul  = tti_sched_ul%10;
   tx_mutex_cnt = tx_mutex_cnt_;
   memcpy(&tx_time, &tx_time_, sizeof(srslte_timestamp_t));
+  clock_gettime(CLOCK_MONOTONIC, &rx_clock);
 }
 
 int phch_worker::add_rnti(uint16_t rnti)
@@ -245,7 +255,15 @@ void phch_worker::work_imp()
   // Process UL signal 
   srslte_enb_ul_fft(&enb_ul, signal_buffer_rx);
 
-  // Decode pending UL grants for the tti they were scheduled 
+  // Decode pending UL grants for the tti they were scheduled, limiting the turbo iterations so that 
+  // decoding finishes pusch_deadline_us after the subframe was received 
+  if (phy->params.pusch_deadline_us > 0) {
+    struct timespec deadline = rx_clock; 
+    deadline.tv_nsec += (long) phy->params.pusch_deadline_us*1000; 
+    deadline.tv_sec  += deadline.tv_nsec/1000000000;
+    deadline.tv_nsec %= 1000000000;
+    srslte_sch_set_deadline(&enb_ul.pusch.ul_sch, &deadline);
+  }
   decode_pusch(ul_grants[sf_rx].sched_grants, ul_grants[sf_rx].nof_grants, sf_rx);
   
   // Decode remaining PUCCH ACKs not associated with PUSCH transmission and SR signals
@@ -276,7 +294,7 @@ void phch_worker::work_imp()
   // Put UL/DL grants to resource grid. PDSCH data will be encoded as well. 
   encode_pdcch_dl(dl_grants[sf_tx].sched_grants, dl_grants[sf_tx].nof_grants, sf_tx);  
   encode_pdcch_ul(ul_grants[sf_sched_ul].sched_grants, ul_grants[sf_sched_ul].nof_grants, sf_tx);
-  encode_pdsch(dl_grants[sf_tx].sched_grants, dl_grants[sf_tx].nof_grants, sf_tx);  
+  encode_pdsch(dl_grants[sf_tx].sched_grants, dl_grants[sf_tx].chains, dl_grants[sf_tx].nof_grants, sf_tx);  
   
   // Put pending PHICH HARQ ACK/NACK indications into subframe
   encode_phich(ul_grants[sf_sched_ul].phich, ul_grants[sf_sched_ul].nof_phich, sf_tx);
@@ -322,136 +340,143 @@ unlock:
 
 int phch_worker::decode_pusch(srslte_enb_ul_pusch_t *grants, uint32_t nof_pusch, uint32_t tti)
 {
-  srslte_uci_data_t uci_data; 
-  bzero(&uci_data, sizeof(srslte_uci_data_t));
+  srslte_enb_ul_pusch_rx_t rx[mac_interface_phy::MAX_GRANTS]; 
+  srslte_ra_ul_grant_t     phy_grant[mac_interface_phy::MAX_GRANTS]; 
+  srslte_uci_data_t        uci_data[mac_interface_phy::MAX_GRANTS]; 
+  srslte_cqi_value_t       cqi_value[mac_interface_phy::MAX_GRANTS];
+  bool                     cqi_enabled[mac_interface_phy::MAX_GRANTS]; 
+  uint32_t                 grant_rv_idx[mac_interface_phy::MAX_GRANTS]; // RV signalled in the DCI
+  uint32_t                 nof_rx = 0; 
   
   uint32_t wideband_cqi_value = 0; 
   
   uint32_t n_rb_ho = 0; 
-  for (uint32_t i=0;i<nof_pusch;i++) {
+  
+  // Configure all the PUSCH receptions of this TTI, they are decoded at once
+  for (uint32_t i=0;i<nof_pusch && nof_rx < mac_interface_phy::MAX_GRANTS;i++) {
     uint16_t rnti = grants[i].rnti; 
     if (rnti) {
-
-    #ifdef LOG_EXECTIME
-      char timestr[64];
-      struct timeval t[3];
-      gettimeofday(&t[1], NULL);
-    #endif
-
+      bzero(&uci_data[nof_rx], sizeof(srslte_uci_data_t));
+      
       // Get pending ACKs with an associated PUSCH transmission
       if (phy->ack_is_pending(sf_rx, rnti)) {
-        uci_data.uci_ack_len = 1; 
+        uci_data[nof_rx].uci_ack_len = 1; 
       }
       // Configure PUSCH CQI channel 
-      srslte_cqi_value_t cqi_value;
-      bool cqi_enabled = false; 
+      cqi_enabled[nof_rx] = false; 
+      bzero(&cqi_value[nof_rx], sizeof(srslte_cqi_value_t));
       if (ue_db[rnti].cqi_en && srslte_cqi_send(ue_db[rnti].pmi_idx, tti_rx)) {
-        cqi_value.type = SRSLTE_CQI_TYPE_WIDEBAND;
-        cqi_enabled = true; 
+        cqi_value[nof_rx].type = SRSLTE_CQI_TYPE_WIDEBAND;
+        cqi_enabled[nof_rx] = true; 
       } else if (grants[i].grant.cqi_request) {
-        cqi_value.type = SRSLTE_CQI_TYPE_SUBBAND_HL;
-        cqi_value.subband_hl.N = (phy->cell.nof_prb > 7) ? srslte_cqi_hl_get_no_subbands(phy->cell.nof_prb) : 0;
-        cqi_enabled = true; 
+        cqi_value[nof_rx].type = SRSLTE_CQI_TYPE_SUBBAND_HL;
+        cqi_value[nof_rx].subband_hl.N = (phy->cell.nof_prb > 7) ? srslte_cqi_hl_get_no_subbands(phy->cell.nof_prb) : 0;
+        cqi_enabled[nof_rx] = true; 
       }
-      if (cqi_enabled) {
-        uci_data.uci_cqi_len = srslte_cqi_size(&cqi_value);
-        Info("cqi enabled len=%d\n", uci_data.uci_cqi_len);
+      if (cqi_enabled[nof_rx]) {
+        uci_data[nof_rx].uci_cqi_len = srslte_cqi_size(&cqi_value[nof_rx]);
+        Info("cqi enabled len=%d\n", uci_data[nof_rx].uci_cqi_len);
       }
       
       // mark this tti as having an ul grant to avoid pucch 
       ue_db[rnti].has_grant_tti = tti_rx; 
       
-      srslte_ra_ul_grant_t phy_grant; 
-      int res = -1;
-      if (!srslte_ra_ul_dci_to_grant(&grants[i].grant, enb_ul.cell.nof_prb, n_rb_ho, &phy_grant, tti%8)) {
-        res = srslte_enb_ul_get_pusch(&enb_ul, &phy_grant, grants[i].softbuffer, 
-                                                rnti, grants[i].rv_idx, 
-                                                grants[i].current_tx_nb, 
-                                                grants[i].data, 
-                                                &uci_data, 
-                                                tti);     
-      } else {
+      if (srslte_ra_ul_dci_to_grant(&grants[i].grant, enb_ul.cell.nof_prb, n_rb_ho, &phy_grant[nof_rx], tti%8)) {
         Error("Computing PUSCH grant\n");
         return SRSLTE_ERROR; 
       }
       
-    #ifdef LOG_EXECTIME
-      gettimeofday(&t[2], NULL);
-      get_time_interval(t);
-      snprintf(timestr, 64, ", dec_time=%4d us", (int) t[0].tv_usec);
-    #endif
-      
-      bool crc_res = (res == 0); 
-                   
-      // Save PHICH scheduling for this user. Each user can have just 1 PUSCH grant per TTI
-      ue_db[rnti].phich_info.n_prb_lowest = enb_ul.pusch_cfg.grant.n_prb_tilde[0];                                           
-      ue_db[rnti].phich_info.n_dmrs       = phy_grant.ncs_dmrs;                                           
-
-      
-      
-      char cqi_str[64];
-      if (cqi_enabled) {
-        srslte_cqi_value_unpack(uci_data.uci_cqi, &cqi_value);
-        if (ue_db[rnti].cqi_en) {
-          wideband_cqi_value = cqi_value.wideband.wideband_cqi;
-        } else if (grants[i].grant.cqi_request) {
-          wideband_cqi_value = cqi_value.subband_hl.wideband_cqi;
-        }
-        snprintf(cqi_str, 64, ", cqi=%d", wideband_cqi_value);
-      }
-      
-      float snr_db  = 10*log10(srslte_chest_ul_get_snr(&enb_ul.chest)); 
-
-      /*
-      if (!crc_res && enb_ul.pusch_cfg.grant.L_prb == 1 && enb_ul.pusch_cfg.grant.n_prb[0] == 0 && snr_db > 5) {
-        srslte_vec_save_file("sf_symbols", enb_ul.sf_symbols, sizeof(cf_t)*SRSLTE_SF_LEN_RE(25, SRSLTE_CP_NORM));
-        srslte_vec_save_file("ce", enb_ul.ce, sizeof(cf_t)*SRSLTE_SF_LEN_RE(25, SRSLTE_CP_NORM));
-        srslte_vec_save_file("d", enb_ul.pusch.d, sizeof(cf_t)*enb_ul.pusch_cfg.nbits.nof_re);
-        srslte_vec_save_file("ce2", enb_ul.pusch.ce, sizeof(cf_t)*enb_ul.pusch_cfg.nbits.nof_re);
-        srslte_vec_save_file("z", enb_ul.pusch.z, sizeof(cf_t)*enb_ul.pusch_cfg.nbits.nof_re);
-        printf("saved sf_idx=%d, mcs=%d, tbs=%d, rnti=%d, rv=%d, snr=%.1f\n", tti%10, 
-               grants[i].grant.mcs_idx, enb_ul.pusch_cfg.cb_segm.tbs, rnti, grants[i].rv_idx, snr_db); 
-        exit(-1);
-      }
-      */
-      log_h->info_hex(grants[i].data, phy_grant.mcs.tbs/8,
-          "PUSCH: rnti=0x%x, prb=(%d,%d), tbs=%d, mcs=%d, rv=%d, snr=%.1f dB, n_iter=%d, crc=%s%s%s%s\n", 
-          rnti, phy_grant.n_prb[0], phy_grant.n_prb[0]+phy_grant.L_prb,
-          phy_grant.mcs.tbs/8, phy_grant.mcs.idx, grants[i].grant.rv_idx,
-          snr_db, 
-          srslte_pusch_last_noi(&enb_ul.pusch),
-          crc_res?"OK":"KO",
-          uci_data.uci_ack_len>0?(uci_data.uci_ack?", ack=1":", ack=0"):"",
-          uci_data.uci_cqi_len>0?cqi_str:"",         
-          timestr);    
-      
-      // Notify MAC of RL status 
-      if (grants[i].grant.rv_idx == 0) {
-        if (res && snr_db < PUSCH_RL_SNR_DB_TH) {
-          Debug("PUSCH: Radio-Link failure snr=%.1f dB\n", snr_db);
-          phy->mac->rl_failure(rnti);
-        } else {
-          phy->mac->rl_ok(rnti);
-        }        
-      }
-      
-      // Notify MAC new received data and HARQ Indication value
-      phy->mac->crc_info(tti_rx, rnti, phy_grant.mcs.tbs/8, crc_res);    
-      if (uci_data.uci_ack_len) {
-        phy->mac->ack_info(tti_rx, rnti, uci_data.uci_ack && (crc_res || snr_db > PUSCH_RL_SNR_DB_TH));
-      }
-      
-      // Notify MAC of UL SNR and DL CQI 
-      if (snr_db >= PUSCH_RL_SNR_DB_TH) {
-        phy->mac->snr_info(tti_rx, rnti, snr_db);
-      }
-      if (uci_data.uci_cqi_len>0 && crc_res) {
-        phy->mac->cqi_info(tti_rx, rnti, wideband_cqi_value);
+      bzero(&rx[nof_rx], sizeof(srslte_enb_ul_pusch_rx_t));
+      rx[nof_rx].rnti          = rnti; 
+      rx[nof_rx].grant         = &phy_grant[nof_rx]; 
+      rx[nof_rx].softbuffer    = grants[i].softbuffer; 
+      rx[nof_rx].rv_idx        = grants[i].rv_idx; 
+      rx[nof_rx].current_tx_nb = grants[i].current_tx_nb; 
+      rx[nof_rx].data          = grants[i].data; 
+      rx[nof_rx].uci_data      = &uci_data[nof_rx]; 
+      grant_rv_idx[nof_rx]     = grants[i].grant.rv_idx; 
+      nof_rx++;
+    }
+  }
+  
+  char timestr[64];
+  timestr[0] = '\0';
+#ifdef LOG_EXECTIME
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+#endif
+  
+  if (srslte_enb_ul_get_pusch_multi(&enb_ul, rx, nof_rx, tti)) {
+    Error("Decoding PUSCH\n");
+    return SRSLTE_ERROR; 
+  }
+  
+#ifdef LOG_EXECTIME
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  snprintf(timestr, 64, ", dec_time=%4d us/%d", (int) t[0].tv_usec, nof_rx);
+#endif
+  
+  for (uint32_t n=0;n<nof_rx;n++) {
+    uint16_t rnti = rx[n].rnti; 
+    int res = rx[n].ret; 
+    bool crc_res = (res == 0); 
+                 
+    // Save PHICH scheduling for this user. Each user can have just 1 PUSCH grant per TTI
+    ue_db[rnti].phich_info.n_prb_lowest = rx[n].n_prb_lowest;                                           
+    ue_db[rnti].phich_info.n_dmrs       = phy_grant[n].ncs_dmrs;                                           
+    
+    char cqi_str[64];
+    cqi_str[0] = '\0';
+    if (cqi_enabled[n]) {
+      srslte_cqi_value_unpack(uci_data[n].uci_cqi, &cqi_value[n]);
+      if (cqi_value[n].type == SRSLTE_CQI_TYPE_WIDEBAND) {
+        wideband_cqi_value = cqi_value[n].wideband.wideband_cqi;
+      } else {
+        wideband_cqi_value = cqi_value[n].subband_hl.wideband_cqi;
       }
-      
-      // Save metrics stats 
-      ue_db[rnti].metrics_ul(phy_grant.mcs.idx, 0, snr_db, srslte_pusch_last_noi(&enb_ul.pusch));
-    }    
+      snprintf(cqi_str, 64, ", cqi=%d", wideband_cqi_value);
+    }
+    
+    float snr_db  = 10*log10(rx[n].snr); 
+
+    log_h->info_hex(rx[n].data, phy_grant[n].mcs.tbs/8,
+        "PUSCH: rnti=0x%x, prb=(%d,%d), tbs=%d, mcs=%d, rv=%d, snr=%.1f dB, n_iter=%d, crc=%s%s%s%s\n", 
+        rnti, phy_grant[n].n_prb[0], phy_grant[n].n_prb[0]+phy_grant[n].L_prb,
+        phy_grant[n].mcs.tbs/8, phy_grant[n].mcs.idx, grant_rv_idx[n],
+        snr_db, 
+        rx[n].nof_iterations,
+        crc_res?"OK":"KO",
+        uci_data[n].uci_ack_len>0?(uci_data[n].uci_ack?", ack=1":", ack=0"):"",
+        uci_data[n].uci_cqi_len>0?cqi_str:"",         
+        timestr);    
+    
+    // Notify MAC of RL status 
+    if (grant_rv_idx[n] == 0) {
+      if (res && snr_db < PUSCH_RL_SNR_DB_TH) {
+        Debug("PUSCH: Radio-Link failure snr=%.1f dB\n", snr_db);
+        phy->mac->rl_failure(rnti);
+      } else {
+        phy->mac->rl_ok(rnti);
+      }        
+    }
+    
+    // Notify MAC new received data and HARQ Indication value
+    phy->mac->crc_info(tti_rx, rnti, phy_grant[n].mcs.tbs/8, crc_res);    
+    if (uci_data[n].uci_ack_len) {
+      phy->mac->ack_info(tti_rx, rnti, uci_data[n].uci_ack && (crc_res || snr_db > PUSCH_RL_SNR_DB_TH));
+    }
+    
+    // Notify MAC of UL SNR and DL CQI 
+    if (snr_db >= PUSCH_RL_SNR_DB_TH) {
+      phy->mac->snr_info(tti_rx, rnti, snr_db);
+    }
+    if (uci_data[n].uci_cqi_len>0 && crc_res) {
+      phy->mac->cqi_info(tti_rx, rnti, wideband_cqi_value);
+    }
+    
+    // Save metrics stats 
+    ue_db[rnti].metrics_ul(phy_grant[n].mcs.idx, 0, snr_db, rx[n].nof_iterations);
   }
   return SRSLTE_SUCCESS; 
 }
@@ -460,77 +485,107 @@ int phch_worker::decode_pusch(srslte_enb_ul_pusch_t *grants, uint32_t nof_pusch,
 int phch_worker::decode_pucch(uint32_t tti_rx)
 {
   uint32_t sf_rx = tti_rx%10;
-  srslte_uci_data_t uci_data; 
   
+  // Collect the users that need to receive PUCCH in this subframe 
+  pucch_ue.clear();
+  pucch_rx.clear();
   for(std::map<uint16_t, ue>::iterator iter=ue_db.begin(); iter!=ue_db.end(); ++iter) {
     uint16_t rnti = (uint16_t) iter->first;
 
     if (rnti >= SRSLTE_CRNTI_START && rnti <= SRSLTE_CRNTI_END && ue_db[rnti].has_grant_tti != (int) tti_rx) {
       // Check if user needs to receive PUCCH 
-      bool needs_pucch = false, needs_ack=false, needs_sr=false, needs_cqi=false; 
+      bool needs_pucch = false; 
       uint32_t last_n_pdcch = 0;
-      bzero(&uci_data, sizeof(srslte_uci_data_t));
+      pucch_ue_t u; 
+      bzero(&u, sizeof(pucch_ue_t));
       
       if (ue_db[rnti].I_sr_en) {
         if (srslte_ue_ul_sr_send_tti(ue_db[rnti].I_sr, tti_rx)) {
           needs_pucch = true; 
-          needs_sr = true; 
-          uci_data.scheduling_request = true; 
+          u.needs_sr = true; 
+          u.uci_data.scheduling_request = true; 
         }
       }      
       if (phy->ack_is_pending(sf_rx, rnti, &last_n_pdcch)) {
         needs_pucch = true; 
-        needs_ack = true; 
-        uci_data.uci_ack_len = 1; 
+        u.needs_ack = true; 
+        u.uci_data.uci_ack_len = 1; 
       }
-      srslte_cqi_value_t cqi_value;
-      if (ue_db[rnti].cqi_en && (ue_db[rnti].pucch_cqi_ack || !needs_ack)) {
+      if (ue_db[rnti].cqi_en && (ue_db[rnti].pucch_cqi_ack || !u.needs_ack)) {
         if (srslte_cqi_send(ue_db[rnti].pmi_idx, tti_rx)) {
           needs_pucch = true; 
-          needs_cqi = true; 
-          cqi_value.type = SRSLTE_CQI_TYPE_WIDEBAND; 
-          uci_data.uci_cqi_len = srslte_cqi_size(&cqi_value);
+          u.needs_cqi = true; 
+          bzero(&u.cqi_value, sizeof(srslte_cqi_value_t));
+          u.cqi_value.type = SRSLTE_CQI_TYPE_WIDEBAND; 
+          u.uci_data.uci_cqi_len = srslte_cqi_size(&u.cqi_value);
         }
       }
       
       if (needs_pucch) {
-        if (srslte_enb_ul_get_pucch(&enb_ul, rnti, last_n_pdcch, sf_rx, &uci_data)) {
-          fprintf(stderr, "Error getting PUCCH\n");
-          return SRSLTE_ERROR; 
-        }
-        if (uci_data.uci_ack_len > 0) {
-          phy->mac->ack_info(tti_rx, rnti, uci_data.uci_ack && (srslte_pucch_get_last_corr(&enb_ul.pucch) >= PUCCH_RL_CORR_TH));      
-        }
-        if (uci_data.scheduling_request) {
-          phy->mac->sr_detected(tti_rx, rnti);                
-        }
-        
-        char cqi_str[64];
-        if (uci_data.uci_cqi_len) {
-          srslte_cqi_value_unpack(uci_data.uci_cqi, &cqi_value);
-          phy->mac->cqi_info(tti_rx, rnti, cqi_value.wideband.wideband_cqi);
-          sprintf(cqi_str, ", cqi=%d", cqi_value.wideband.wideband_cqi);
-        }
-        log_h->info("PUCCH: rnti=0x%x, corr=%.2f, n_pucch=%d, n_prb=%d%s%s%s\n", 
-                    rnti, 
-                    srslte_pucch_get_last_corr(&enb_ul.pucch),
-                    enb_ul.pucch.last_n_pucch, enb_ul.pucch.last_n_prb,
-                    needs_ack?(uci_data.uci_ack?", ack=1":", ack=0"):"", 
-                    needs_sr?(uci_data.scheduling_request?", sr=yes":", sr=no"):"", 
-                    needs_cqi?cqi_str:"");                
-
-
-        // Notify MAC of RL status 
-        if (!needs_sr) {
-          if (srslte_pucch_get_last_corr(&enb_ul.pucch) < PUCCH_RL_CORR_TH) {
-            Debug("PUCCH: Radio-Link failure corr=%.1f\n", srslte_pucch_get_last_corr(&enb_ul.pucch));
-            phy->mac->rl_failure(rnti);
-          } else {
-            phy->mac->rl_ok(rnti);
-          }          
-        }                
+        srslte_enb_ul_pucch_rx_t rx; 
+        bzero(&rx, sizeof(srslte_enb_ul_pucch_rx_t));
+        rx.rnti        = rnti; 
+        rx.pdcch_n_cce = last_n_pdcch; 
+        pucch_ue.push_back(u);
+        pucch_rx.push_back(rx);
       }
     }
+  }
+  
+  if (pucch_rx.empty()) {
+    return 0; 
+  }
+  for (uint32_t i=0;i<pucch_rx.size();i++) {
+    pucch_rx[i].uci_data = &pucch_ue[i].uci_data; 
+  }
+  
+  // Detect the PUCCH of all users at once 
+  if (srslte_enb_ul_get_pucch_multi(&enb_ul, &pucch_rx[0], pucch_rx.size(), sf_rx)) {
+    fprintf(stderr, "Error getting PUCCH\n");
+    return SRSLTE_ERROR; 
+  }
+  
+  for (uint32_t i=0;i<pucch_rx.size();i++) {
+    srslte_enb_ul_pucch_rx_t *rx = &pucch_rx[i]; 
+    pucch_ue_t *u = &pucch_ue[i]; 
+    uint16_t rnti = rx->rnti; 
+    
+    // A failed user does not prevent reporting the others 
+    if (rx->ret) {
+      Error("Getting PUCCH rnti=0x%x\n", rnti);
+      continue; 
+    }
+    if (u->uci_data.uci_ack_len > 0) {
+      phy->mac->ack_info(tti_rx, rnti, u->uci_data.uci_ack && (rx->corr >= PUCCH_RL_CORR_TH));      
+    }
+    if (u->uci_data.scheduling_request) {
+      phy->mac->sr_detected(tti_rx, rnti);                
+    }
+    
+    char cqi_str[64];
+    if (u->uci_data.uci_cqi_len) {
+      srslte_cqi_value_unpack(u->uci_data.uci_cqi, &u->cqi_value);
+      phy->mac->cqi_info(tti_rx, rnti, u->cqi_value.wideband.wideband_cqi);
+      sprintf(cqi_str, ", cqi=%d", u->cqi_value.wideband.wideband_cqi);
+    }
+    log_h->info("PUCCH: rnti=0x%x, corr=%.2f, n_pucch=%d, n_prb=%d%s%s%s\n", 
+                rnti, 
+                rx->corr,
+                rx->n_pucch, rx->n_prb,
+                u->needs_ack?(u->uci_data.uci_ack?", ack=1":", ack=0"):"", 
+                u->needs_sr?(u->uci_data.scheduling_request?", sr=yes":", sr=no"):"", 
+                u->needs_cqi?cqi_str:"");                
+
+
+    // Notify MAC of RL status 
+    if (!u->needs_sr) {
+      if (rx->corr < PUCCH_RL_CORR_TH) {
+        Debug("PUCCH: Radio-Link failure corr=%.1f\n", rx->corr);
+        phy->mac->rl_failure(rnti);
+      } else {
+        phy->mac->rl_ok(rnti);
+      }          
+    }                
   }    
   return 0; 
 }
@@ -602,7 +657,7 @@ int phch_worker::encode_pdcch_dl(srslte_enb_dl_pdsch_t *grants, uint32_t nof_gra
   return 0; 
 }
 
-int phch_worker::encode_pdsch(srslte_enb_dl_pdsch_t *grants, uint32_t nof_grants, uint32_t sf_idx)
+int phch_worker::encode_pdsch(srslte_enb_dl_pdsch_t *grants, srslte::buffer_chain **chains, uint32_t nof_grants, uint32_t sf_idx)
 {
   for (uint32_t i=0;i<nof_grants;i++) {
     uint16_t rnti = grants[i].rnti;
@@ -633,6 +688,11 @@ int phch_worker::encode_pdsch(srslte_enb_dl_pdsch_t *grants, uint32_t nof_grants
         uint8_t x = 0;
         uint8_t *ptr = grants[i].data;
         uint32_t len = phy_grant.mcs.tbs/8;
+        if (chains[i]) {
+          // Only the MAC headers are contiguous 
+          ptr = chains[i]->get_ptr(0);
+          len = chains[i]->get_len(0);
+        }
         if (!ptr) {          
           ptr = &x;
           len = 1; 
@@ -642,8 +702,23 @@ int phch_worker::encode_pdsch(srslte_enb_dl_pdsch_t *grants, uint32_t nof_grants
                              rnti, phy_grant.nof_prb, grant_str, grants[i].grant.harq_process, 
                              phy_grant.mcs.tbs/8, phy_grant.mcs.idx, grants[i].grant.rv_idx, tti_tx);
       }
-      if (srslte_enb_dl_put_pdsch(&enb_dl, &phy_grant, grants[i].softbuffer, rnti, grants[i].grant.rv_idx, sf_idx, 
-                                  grants[i].data)) 
+      int ret; 
+      if (chains[i]) {
+        // Gather the PDU slices while computing the transport block CRC 
+        srslte_tb_iov_t tb; 
+        srslte_tb_iov_reset(&tb);
+        for (uint32_t j=0;j<chains[i]->size();j++) {
+          srslte_tb_iov_add(&tb, chains[i]->get_ptr(j), chains[i]->get_len(j));
+        }
+        ret = srslte_enb_dl_put_pdsch_iov(&enb_dl, &phy_grant, grants[i].softbuffer, rnti, grants[i].grant.rv_idx, sf_idx, 
+                                          &tb);
+        chains[i]->release();
+        chains[i] = NULL; 
+      } else {
+        ret = srslte_enb_dl_put_pdsch(&enb_dl, &phy_grant, grants[i].softbuffer, rnti, grants[i].grant.rv_idx, sf_idx, 
+                                      grants[i].data);
+      }
+      if (ret) 
       {
         fprintf(stderr, "Error putting PDSCH %d\n",i);
         return SRSLTE_ERROR; 
@@ -673,6 +748,22 @@ uint32_t phch_worker::get_metrics(phy_metrics_t metrics[ENB_METRICS_MAX_USERS])
   return cnt;
 }
 
+void phch_worker::get_pusch_dec_metrics(pusch_dec_metrics_t *metrics)
+{
+  srslte_sch_adapt_stats_t stats; 
+  
+  pthread_mutex_lock(&mutex); 
+  srslte_sch_adaptive_stats(&enb_ul.pusch.ul_sch, &stats);
+  srslte_sch_reset_adaptive_stats(&enb_ul.pusch.ul_sch);
+  pthread_mutex_unlock(&mutex); 
+  
+  metrics->nof_cb                 = stats.nof_cb;
+  metrics->nof_iterations         = stats.nof_iterations;
+  metrics->nof_cb_capped_sinr     = stats.nof_cb_capped_sinr;
+  metrics->nof_cb_capped_deadline = stats.nof_cb_capped_deadline;
+  metrics->nof_cb_abandoned       = stats.nof_cb_abandoned;
+}
+
 void phch_worker::ue::metrics_read(phy_metrics_t* metrics_)
 {
   memcpy(metrics_, &metrics, sizeof(phy_metrics_t));
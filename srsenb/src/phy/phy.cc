@@ -201,6 +201,20 @@ void phy::get_metrics(phy_metrics_t metrics[ENB_METRICS_MAX_USERS])
   }
 }
 
+void phy::get_pusch_dec_metrics(pusch_dec_metrics_t *metrics)
+{
+  pusch_dec_metrics_t metrics_tmp;
+  
+  bzero(metrics, sizeof(pusch_dec_metrics_t));
+  for (uint32_t i=0;i<nof_workers;i++) {
+    workers[i].get_pusch_dec_metrics(&metrics_tmp);
+    metrics->nof_cb                 += metrics_tmp.nof_cb;
+    metrics->nof_iterations         += metrics_tmp.nof_iterations;
+    metrics->nof_cb_capped_sinr     += metrics_tmp.nof_cb_capped_sinr;
+    metrics->nof_cb_capped_deadline += metrics_tmp.nof_cb_capped_deadline;
+    metrics->nof_cb_abandoned       += metrics_tmp.nof_cb_abandoned;
+  }
+}
 
 /***** RRC->PHY interface **********/
 
@@ -49,29 +49,41 @@ int prach_worker::init(srslte_cell_t *cell_, srslte_prach_cfg_t *prach_cfg_, mac
 
   nof_sf = (uint32_t) ceilf(prach.T_tot*1000); 
   
-  signal_buffer_rx = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*nof_sf*SRSLTE_SF_LEN_PRB(cell.nof_prb));
-  if (!signal_buffer_rx) {
-    perror("malloc");
-    return -1;
+  for (uint32_t i=0;i<PRACH_WORKER_NOF_BUFFERS;i++) {
+    signal_buffer_rx[i] = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*nof_sf*SRSLTE_SF_LEN_PRB(cell.nof_prb));
+    if (!signal_buffer_rx[i]) {
+      perror("malloc");
+      return -1;
+    }
   }
   
+  sf_cnt        = 0; 
+  nof_written   = 0; 
+  nof_processed = 0; 
+  running       = true; 
+  
   start(priority);
   initiated = true; 
   
-  pending_tti   = 0; 
-  processed_tti = 0; 
   return 0; 
 }
 
 void prach_worker::stop()
 {
   pthread_mutex_lock(&mutex);
-  processed_tti = 99999; 
   running = false; 
   pthread_cond_signal(&cvar);
   pthread_mutex_unlock(&mutex);
   
   wait_thread_finish();
+  
+  if (initiated) {
+    for (uint32_t i=0;i<PRACH_WORKER_NOF_BUFFERS;i++) {
+      free(signal_buffer_rx[i]);
+    }
+    srslte_prach_free(&prach);
+    initiated = false; 
+  }
 }
 
 void prach_worker::set_max_prach_offset_us(float delay_us)
@@ -79,23 +91,38 @@ void prach_worker::set_max_prach_offset_us(float delay_us)
   max_prach_offset_us = delay_us; 
 }
 
+/* Captures the subframes of each PRACH window in the next free buffer of the ring, so that windows 
+ * of consecutive opportunities (e.g. one every subframe) are not overwritten while the worker 
+ * thread is still processing a previous one. 
+ */
 int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
 {
   // Save buffer only if it's a PRACH TTI
   if (srslte_prach_tti_opportunity(&prach, tti_rx, -1) || sf_cnt) {
-    memcpy(&signal_buffer_rx[sf_cnt*SRSLTE_SF_LEN_PRB(cell.nof_prb)], buffer_rx, sizeof(cf_t)*SRSLTE_SF_LEN_PRB(cell.nof_prb));
+    if (sf_cnt == 0) {
+      // nof_processed is advanced by the worker thread
+      pthread_mutex_lock(&mutex);
+      bool     ring_full  = nof_written - nof_processed == PRACH_WORKER_NOF_BUFFERS; 
+      uint32_t oldest_tti = buffer_tti[nof_processed%PRACH_WORKER_NOF_BUFFERS]; 
+      pthread_mutex_unlock(&mutex);
+      if (ring_full) {
+        log_h->warning("PRACH thread did not finish processing TTI=%d, dropping TTI=%d\n", 
+                       oldest_tti, tti_rx);
+        return 0; 
+      }
+    }
+    cf_t *signal_buffer = signal_buffer_rx[nof_written%PRACH_WORKER_NOF_BUFFERS];
+    memcpy(&signal_buffer[sf_cnt*SRSLTE_SF_LEN_PRB(cell.nof_prb)], buffer_rx, sizeof(cf_t)*SRSLTE_SF_LEN_PRB(cell.nof_prb));
     sf_cnt++;
     if (sf_cnt == nof_sf) {
       sf_cnt = 0; 
-      if ((int) pending_tti != processed_tti) {
-        log_h->warning("PRACH thread did not finish processing TTI=%d\n", pending_tti);
-      }
       pthread_mutex_lock(&mutex);
       if (tti_rx+1 > nof_sf) {
-        pending_tti = tti_rx+1-nof_sf;       
+        buffer_tti[nof_written%PRACH_WORKER_NOF_BUFFERS] = tti_rx+1-nof_sf;       
       } else {
-        pending_tti = 10240+(tti_rx+1-nof_sf);
+        buffer_tti[nof_written%PRACH_WORKER_NOF_BUFFERS] = 10240+(tti_rx+1-nof_sf);
       }
+      nof_written++;
       pthread_cond_signal(&cvar);
       pthread_mutex_unlock(&mutex);
     }
@@ -104,7 +131,7 @@ int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
 }
 
 
-int prach_worker::run_tti(uint32_t tti_rx)
+int prach_worker::run_tti(uint32_t tti_rx, cf_t *signal_buffer_rx)
 {
   if (srslte_prach_tti_opportunity(&prach, tti_rx, -1)) 
   {
@@ -138,19 +165,21 @@ int prach_worker::run_tti(uint32_t tti_rx)
 
 void prach_worker::run_thread()
 {
-  running = true; 
   while(running) {
    pthread_mutex_lock(&mutex);
-   while(processed_tti == (int) pending_tti) {
+   while(nof_processed == nof_written && running) {
     pthread_cond_wait(&cvar, &mutex);
    }
+   uint32_t idx = nof_processed%PRACH_WORKER_NOF_BUFFERS;
    pthread_mutex_unlock(&mutex);
-   log_h->debug("Processing pending_tti=%d\n", pending_tti);
    if (running) {
-    if (run_tti(pending_tti)) {
+    log_h->debug("Processing pending_tti=%d\n", buffer_tti[idx]);
+    if (run_tti(buffer_tti[idx], signal_buffer_rx[idx])) {
       running = false; 
     }
-    processed_tti = pending_tti;
+    pthread_mutex_lock(&mutex);
+    nof_processed++;
+    pthread_mutex_unlock(&mutex);
    }
   }
 }
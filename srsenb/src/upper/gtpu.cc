@@ -141,14 +141,14 @@ void gtpu::rem_user(uint16_t rnti)
 
 void gtpu::run_thread()
 {
-  byte_buffer_t *pdu = pool_allocate;
+  byte_buffer_t *pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
   run_enable = true;
 
   running=true; 
   while(run_enable) {
     pdu->reset();
     gtpu_log->debug("Waiting for read...\n");
-    pdu->N_bytes = srslte_netsource_read(&src, pdu->msg, SRSENB_MAX_BUFFER_SIZE_BYTES - SRSENB_BUFFER_HEADER_OFFSET);
+    pdu->N_bytes = srslte_netsource_read(&src, pdu->msg, pdu->get_tailroom());
 
     
     gtpu_header_t header;
@@ -174,14 +174,18 @@ void gtpu::run_thread()
 
     gtpu_log->info_hex(pdu->msg, pdu->N_bytes, "RX GTPU PDU rnti=0x%x, lcid=%d", rnti, lcid);
 
-    pdcp->write_sdu(rnti, lcid, pdu);
-    do {
-      pdu = pool_allocate;
-      if (!pdu) {
-        gtpu_log->console("GTPU Buffer pool empty. Trying again...\n");
-        usleep(10000);
-      }
-    } while(!pdu); 
+    // Small packets are moved to a smaller buffer, keeping the read buffer
+    byte_buffer_t *sdu = pool->fit(pdu, __FUNCTION__);
+    pdcp->write_sdu(rnti, lcid, sdu);
+    if (sdu == pdu) {
+      do {
+        pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
+        if (!pdu) {
+          gtpu_log->console("GTPU Buffer pool empty. Trying again...\n");
+          usleep(10000);
+        }
+      } while(!pdu); 
+    }
   }
   running=false;
 }
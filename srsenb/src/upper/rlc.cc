@@ -112,15 +112,27 @@ void rlc::read_pdu_pcch(uint8_t* payload, uint32_t buffer_size)
 int rlc::read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
 {
   int ret = users[rnti].rlc->read_pdu(lcid, payload, nof_bytes);
+  update_buffer_state(rnti, lcid);
+  return ret;
+}
+
+int rlc::read_pdu_chain(uint16_t rnti, uint32_t lcid, srslte::buffer_chain *chain, uint32_t nof_bytes)
+{
+  int ret = users[rnti].rlc->read_pdu_chain(lcid, chain, nof_bytes);
+  if (ret >= 0) {
+    update_buffer_state(rnti, lcid);
+  }
+  return ret;
+}
 
+void rlc::update_buffer_state(uint16_t rnti, uint32_t lcid)
+{
   // In the eNodeB, there is no polling for buffer state from the scheduler, thus
   // communicate buffer state every time a PDU is read
   uint32_t tx_queue   = users[rnti].rlc->get_total_buffer_state(lcid);
   uint32_t retx_queue = 0;
   log_h->debug("Buffer state PDCP: rnti=0x%x, lcid=%d, tx_queue=%d\n", rnti, lcid, tx_queue);
   mac->rlc_buffer_state(rnti, lcid, tx_queue, retx_queue);
-
-  return ret;
 }
 
 void rlc::write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
@@ -561,6 +561,9 @@ int main(int argc, char *argv[])
   phy_args.max_prach_offset_us = 50; 
   phy_args.nof_phy_threads = 1; 
   phy_args.pusch_max_its   = 5; 
+  phy_args.pusch_dec_threads = 0; 
+  phy_args.pusch_min_its   = 0; 
+  phy_args.pusch_deadline_us = 0; 
   
   generate_cell_configuration(&mac_cfg, &phy_cfg);
   
@@ -117,6 +117,8 @@ private:
   srslte_ue_dl_t ue_dl; 
   uint32_t       cfi; 
   uint16_t       dl_rnti;
+  srslte_dci_format_t dl_dci_format; 
+  srslte_ra_dl_dci_t  dl_dci_unpacked; 
   
   /* Objects for UL */
   srslte_ue_ul_t     ue_ul; 
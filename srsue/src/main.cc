@@ -160,6 +160,14 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
             bpo::value<int>(&args->expert.phy.pdsch_max_its)->default_value(4), 
             "Maximum number of turbo decoder iterations")
 
+        ("expert.pdsch_dec_threads",         
+            bpo::value<int>(&args->expert.phy.pdsch_dec_threads)->default_value(0), 
+            "Number of helper threads decoding PDSCH code blocks in parallel (0 decodes them serially)")
+
+        ("expert.pdsch_min_its",         
+            bpo::value<int>(&args->expert.phy.pdsch_min_its)->default_value(0), 
+            "Turbo decoder iterations for transmissions whose SNR is too low to decode (0 disables)")
+
         ("expert.attach_enable_64qam",      
             bpo::value<bool>(&args->expert.phy.attach_enable_64qam)->default_value(false), 
             "PUSCH 64QAM modulation before attachment")
@@ -196,6 +204,14 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
             bpo::value<float>(&args->expert.phy.estimator_fil_w)->default_value(0.1), 
             "Chooses the coefficients for the 3-tap channel estimator centered filter.")
         
+        ("expert.estimator_interp",    
+            bpo::value<string>(&args->expert.phy.estimator_interp)->default_value("linear"), 
+            "Channel estimator interpolation: linear, fused or wiener.")
+        
+        ("expert.estimator_lazy",    
+            bpo::value<bool>(&args->expert.phy.estimator_lazy)->default_value(false), 
+            "Interpolates the channel estimates only over the demodulated symbols and PRB.")
+        
         
         ("rf_calibration.tx_corr_dc_gain",  bpo::value<float>(&args->rf_cal.tx_corr_dc_gain)->default_value(0.0),  "TX DC offset gain correction")
         ("rf_calibration.tx_corr_dc_phase", bpo::value<float>(&args->rf_cal.tx_corr_dc_phase)->default_value(0.0), "TX DC offset phase correction")
@@ -105,6 +105,26 @@ bool phch_worker::init_cell(srslte_cell_t cell_)
     return false; 
   }
   
+  if (srslte_sch_set_decoder_threads(&ue_dl.pdsch.dl_sch, phy->args->pdsch_dec_threads)) {
+    Error("Setting PDSCH decoder threads\n");
+    return false; 
+  }
+  
+  srslte_chest_dl_interp_t interp = SRSLTE_CHEST_DL_INTERP_LINEAR; 
+  if (!phy->args->estimator_interp.compare("fused")) {
+    interp = SRSLTE_CHEST_DL_INTERP_FUSED; 
+  } else if (!phy->args->estimator_interp.compare("wiener")) {
+    interp = SRSLTE_CHEST_DL_INTERP_WIENER; 
+  }
+  if (srslte_chest_dl_set_interp(&ue_dl.chest, interp)) {
+    Error("Setting channel estimator interpolation\n");
+    return false; 
+  }
+  if (srslte_chest_dl_set_lazy(&ue_dl.chest, phy->args->estimator_lazy)) {
+    Error("Setting lazy channel estimation\n");
+    return false; 
+  }
+  
   if (srslte_ue_ul_init(&ue_ul, cell)) {  
     Error("Initiating UE UL\n");
     return false; 
@@ -376,6 +396,10 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
       return false;   
     }
     
+    /* Keep the precoding information for decode_pdsch() */
+    dl_dci_format   = dci_msg.format; 
+    dl_dci_unpacked = dci_unpacked; 
+    
     /* Fill MAC grant structure */
     grant->ndi = dci_unpacked.ndi;
     grant->pid = dci_unpacked.harq_process;
@@ -412,8 +436,12 @@ bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload,
 
   /* Setup PDSCH configuration for this CFI, SFIDX and RVIDX */
   if (rv >= 0 && rv <= 3) {
-    if (!srslte_ue_dl_cfg_grant(&ue_dl, grant, cfi, tti%10, rv)) {
-      if (ue_dl.pdsch_cfg.grant.mcs.mod > 0 && ue_dl.pdsch_cfg.grant.mcs.tbs >= 0) {
+    if (!srslte_ue_dl_cfg_grant(&ue_dl, grant, cfi, tti%10, rv) && 
+        !srslte_ue_dl_cfg_grant_mimo(&ue_dl, dl_dci_format, &dl_dci_unpacked)) 
+    {
+      if (ue_dl.pdsch_cfg.nof_cw > 1) {
+        Warning("PDSCH: two codeword grants are not supported by the MAC\n");
+      } else if (ue_dl.pdsch_cfg.grant.mcs.mod > 0 && ue_dl.pdsch_cfg.grant.mcs.tbs >= 0) {
         
         float noise_estimate = srslte_chest_dl_get_noise_estimate(&ue_dl.chest);
         
@@ -425,6 +453,8 @@ bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload,
         if (phy->args->pdsch_max_its > 0) {
           srslte_sch_set_max_noi(&ue_dl.pdsch.dl_sch, phy->args->pdsch_max_its);
         }
+        srslte_sch_set_adaptive_noi(&ue_dl.pdsch.dl_sch, phy->args->pdsch_min_its > 0, 
+                                    phy->args->pdsch_min_its, SRSLTE_SCH_ADAPT_DEFAULT_MARGIN_DB);
 
         
   #ifdef LOG_EXECTIME
@@ -609,8 +639,16 @@ void phch_worker::set_uci_periodic_cqi()
   int cqi_max       = phy->args->cqi_max;
   
   if (period_cqi.configured && rnti_is_set) {
-    if (srslte_cqi_send(period_cqi.pmi_idx, (tti+4)%10240)) {
+    if (ue_dl.tm > 2 && period_cqi.ri_idx_present && 
+        srslte_ri_send(period_cqi.pmi_idx, period_cqi.ri_idx, (tti+4)%10240)) 
+    {
+      /* The RI report has priority over a CQI report in the same subframe. The MAC decodes a single 
+       * transport block, so rank 1 is always reported */
+      uci_data.uci_cqi_len = srslte_cqi_ri_pack(1, cell.nof_ports, uci_data.uci_cqi);
+      Info("PUCCH: Periodic RI=1\n");
+    } else if (srslte_cqi_send(period_cqi.pmi_idx, (tti+4)%10240)) {
       srslte_cqi_value_t cqi_report;
+      bzero(&cqi_report, sizeof(srslte_cqi_value_t));
       if (period_cqi.format_is_subband) {
         // TODO: Implement subband periodic reports
         cqi_report.type = SRSLTE_CQI_TYPE_SUBBAND;
@@ -628,7 +666,15 @@ void phch_worker::set_uci_periodic_cqi()
         if (cqi_max >= 0 && cqi_report.wideband.wideband_cqi > cqi_max) {
           cqi_report.wideband.wideband_cqi = cqi_max; 
         }
-        Info("PUCCH: Periodic CQI=%d, SNR=%.1f dB\n", cqi_report.wideband.wideband_cqi, phy->avg_snr_db);
+        if (ue_dl.tm == 4) {
+          uint32_t ri = 1, pmi = 0; 
+          srslte_pdsch_last_ri_pmi(&ue_dl.pdsch, &ri, &pmi);
+          cqi_report.wideband.pmi_present = true; 
+          cqi_report.wideband.four_antenna_ports = cell.nof_ports == 4; 
+          cqi_report.wideband.pmi = srslte_cqi_pmi_from_codebook(cell.nof_ports, 1, pmi); 
+        }
+        Info("PUCCH: Periodic CQI=%d, PMI=%d, SNR=%.1f dB\n", cqi_report.wideband.wideband_cqi, 
+             cqi_report.wideband.pmi, phy->avg_snr_db);
       }
       uci_data.uci_cqi_len = srslte_cqi_value_pack(&cqi_report, uci_data.uci_cqi);
       rar_cqi_request = false;       
@@ -900,10 +946,20 @@ void phch_worker::set_ul_params(bool pregen_disabled)
   
   srslte_ue_ul_set_cfg(&ue_ul, &dmrs_cfg, &srs_cfg, &pucch_cfg, &pucch_sched, &uci_cfg, &pusch_hopping, &power_ctrl);
 
+  /* Transmission mode. The MAC decodes a single transport block per TTI, so the RI is limited to 1 */
+  uint32_t tm = liblte_rrc_transmission_mode_num[dedicated->antenna_info_explicit_value.tx_mode%LIBLTE_RRC_TRANSMISSION_MODE_N_ITEMS];
+  if (srslte_ue_dl_set_tm(&ue_dl, tm)) {
+    Error("Setting transmission mode TM%d with %d ports\n", tm, cell.nof_ports);
+  } else {
+    srslte_pdsch_set_ri_pmi_report(&ue_dl.pdsch, tm > 2, 1);
+  }
+  
   /* CQI configuration */
   bzero(&period_cqi, sizeof(srslte_cqi_periodic_cfg_t));
   period_cqi.configured        = dedicated->cqi_report_cnfg.report_periodic_setup_present;
   period_cqi.pmi_idx           = dedicated->cqi_report_cnfg.report_periodic.pmi_cnfg_idx; 
+  period_cqi.ri_idx_present    = dedicated->cqi_report_cnfg.report_periodic.ri_cnfg_idx_present; 
+  period_cqi.ri_idx            = dedicated->cqi_report_cnfg.report_periodic.ri_cnfg_idx; 
   period_cqi.simul_cqi_ack     = dedicated->cqi_report_cnfg.report_periodic.simult_ack_nack_and_cqi;
   period_cqi.format_is_subband = dedicated->cqi_report_cnfg.report_periodic.format_ind_periodic ==
                                  LIBLTE_RRC_CQI_FORMAT_INDICATOR_PERIODIC_SUBBAND_CQI;
@@ -964,7 +1020,7 @@ int phch_worker::read_ce_abs(float *ce_abs) {
 
 int phch_worker::read_pdsch_d(cf_t* pdsch_d)
 {
-  memcpy(pdsch_d, ue_dl.pdsch.d, ue_dl.pdsch_cfg.nbits.nof_re*sizeof(cf_t));
+  memcpy(pdsch_d, ue_dl.pdsch.d[0], ue_dl.pdsch_cfg.nbits.nof_re*sizeof(cf_t));
   return ue_dl.pdsch_cfg.nbits.nof_re; 
 }
 
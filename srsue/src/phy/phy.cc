@@ -67,6 +67,8 @@ void phy::set_default_args(phy_args_t *args)
   args->snr_ema_coeff       = 0.1; 
   args->snr_estim_alg       = "refs";
   args->pdsch_max_its       = 4; 
+  args->pdsch_dec_threads   = 0; 
+  args->pdsch_min_its       = 0; 
   args->attach_enable_64qam = false; 
   args->nof_phy_threads     = DEFAULT_WORKERS;
   args->equalizer_mode      = "mmse"; 
@@ -76,6 +78,8 @@ void phy::set_default_args(phy_args_t *args)
   args->sfo_correct_disable = false; 
   args->sss_algorithm       = "full"; 
   args->estimator_fil_w     = 0.1; 
+  args->estimator_interp    = "linear"; 
+  args->estimator_lazy      = false; 
 }
 
 bool phy::check_args(phy_args_t *args) 
@@ -88,6 +92,11 @@ bool phy::check_args(phy_args_t *args)
     log_h->console("Error in PHY args: estimator_fil_w must be 0<=w<=1\n");
     return false; 
   }
+  if (args->estimator_interp.compare("linear") && args->estimator_interp.compare("fused") && 
+      args->estimator_interp.compare("wiener")) {
+    log_h->console("Error in PHY args: estimator_interp must be linear, fused or wiener\n");
+    return false; 
+  }
   if (args->snr_ema_coeff > 1.0) {
     log_h->console("Error in PHY args: snr_ema_coeff must be 0<=w<=1\n");
     return false; 
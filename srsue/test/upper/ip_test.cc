@@ -364,12 +364,12 @@ private:
     struct iphdr   *ip_pkt;
     uint32_t        idx = 0;
     int32_t         N_bytes;
-    srslte::byte_buffer_t  *pdu = pool_allocate;
+    srslte::byte_buffer_t  *pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
 
     log_h->info("TUN/TAP reader thread running\n");
 
     while(running) {
-      N_bytes = read(tun_fd, &pdu->msg[idx], SRSLTE_MAX_BUFFER_SIZE_BYTES-SRSLTE_BUFFER_HEADER_OFFSET - idx);      
+      N_bytes = read(tun_fd, &pdu->msg[idx], pdu->get_tailroom() - idx);      
       if(N_bytes > 0 && read_enable)
       {
         pdu->N_bytes = idx + N_bytes;
@@ -388,7 +388,7 @@ private:
           pdu->set_timestamp();
           rlc->write_sdu(LCID, pdu);
           
-          pdu = pool_allocate;
+          pdu = pool_allocate_size(SRSLTE_MAX_IP_PACKET_BYTES);
           idx = 0;
         } else{
           idx += N_bytes;
@@ -580,6 +580,11 @@ int main(int argc, char *argv[])
   
   my_phy.stop();
   my_mac.stop();
+
+  // Buffer memory and usage of the iperf run, per size class
+  srslte::byte_buffer_pool *pool = srslte::byte_buffer_pool::get_instance();
+  printf("Buffer pool: %.1f MB, high water %d buffers\n", (float) pool->get_memory()/1e6, pool->get_high_water());
+  pool->print_stats();
 }
 
 